@@ -0,0 +1,187 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Defines Diligent::CpuProfiler class and CPU profiling macros
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+#include "../../Primitives/interface/BasicTypes.h"
+#include "Timer.h"
+
+// Profiling scopes are compiled out unless DILIGENT_CPU_PROFILER is defined to 1
+// (see DILIGENT_ENABLE_CPU_PROFILER CMake option)
+#ifndef DILIGENT_CPU_PROFILER
+#   define DILIGENT_CPU_PROFILER 0
+#endif
+
+namespace Diligent
+{
+
+/// Hierarchical CPU profiler
+
+/// Every thread records the profiling scopes into its own fixed-size buffer without any
+/// synchronization with other threads. When the buffer is full, new scopes are dropped.
+/// Recorded events can be exported in Chrome trace-event JSON format (chrome://tracing)
+/// or aggregated into per-scope statistics.
+///
+/// Dumping and aggregation read the buffers of all threads and are intended to be called
+/// while the profiled code is idle (e.g. between frames), or after recording has been disabled.
+///
+/// Scopes should be marked with DILIGENT_PROFILE_SCOPE and DILIGENT_PROFILE_FUNCTION macros
+/// that expand to nothing when the profiler is compiled out.
+class CpuProfiler
+{
+public:
+    /// Single recorded scope
+    struct Event
+    {
+        /// Scope name. Must have static storage duration.
+        const Char* Name  = nullptr;
+
+        /// Scope start and end time, in seconds since the profiler was created
+        double      Start = 0;
+        double      End   = 0;
+
+        /// Nesting level of the scope in the thread
+        Uint32      Depth = 0;
+    };
+
+    /// Aggregated statistics of all scopes with the same name
+    struct ScopeStats
+    {
+        const Char* Name      = nullptr;
+        Uint64      Count     = 0;
+
+        /// Total, minimum and maximum scope duration, in seconds
+        double      TotalTime = 0;
+        double      MinTime   = 0;
+        double      MaxTime   = 0;
+
+        /// Total time spent in the scope itself, excluding nested scopes, in seconds
+        double      SelfTime  = 0;
+    };
+
+    static constexpr const Uint32 DefaultThreadBufferCapacity = 64 << 10;
+
+    /// Returns the global profiler instance
+    static CpuProfiler& Get();
+
+    /// Enables or disables recording. Recording is enabled by default.
+    void SetEnabled(bool Enabled) { m_Enabled.store(Enabled, std::memory_order_relaxed); }
+    bool IsEnabled()const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    /// Sets the maximum number of events in the buffers of the threads that have not recorded any scopes yet
+    void SetThreadBufferCapacity(Uint32 Capacity) { m_ThreadBufferCapacity.store(Capacity); }
+
+    /// Discards all recorded events. Every thread clears its buffer before it records the next scope.
+    void Reset() { m_Generation.fetch_add(1); }
+
+    /// Returns the current time in seconds since the profiler was created
+    double GetTime()const { return m_Timer.GetElapsedTime(); }
+
+    /// Records the scope. The method is called by ScopedMarker.
+    void RecordEvent(const Char* Name, double Start, double End, Uint32 Depth);
+
+    /// Writes the recorded events in Chrome trace-event JSON format
+    void WriteChromeTrace(std::ostream& Stream)const;
+
+    /// Writes the recorded events in Chrome trace-event JSON format to the file
+    bool DumpChromeTrace(const Char* FilePath)const;
+
+    /// Computes statistics of all recorded scopes. Scopes with equal names are aggregated together.
+    void GetSummary(std::vector<ScopeStats>& Stats)const;
+
+    /// Returns the total number of events that did not fit into the thread buffers
+    Uint64 GetNumDroppedEvents()const;
+
+    /// Scoped marker that records the time between its construction and destruction
+    class ScopedMarker
+    {
+    public:
+        explicit ScopedMarker(const Char* Name);
+        ~ScopedMarker();
+
+        ScopedMarker             (const ScopedMarker&) = delete;
+        ScopedMarker& operator = (const ScopedMarker&) = delete;
+
+    private:
+        const Char* const m_Name;
+        double            m_Start = -1;
+    };
+
+private:
+    CpuProfiler(){}
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer(Uint32 _ThreadId, Uint32 Capacity) :
+            ThreadId(_ThreadId),
+            Events  (Capacity)
+        {}
+
+        const Uint32        ThreadId;
+        std::vector<Event>  Events;
+        // The number of events written by the owning thread. Other threads
+        // only read the events below this index.
+        std::atomic<Uint32> NumEvents{0};
+        std::atomic<Uint64> NumDropped{0};
+        std::atomic<Uint64> Generation{0};
+        Uint32              Depth = 0;
+    };
+
+    ThreadBuffer& GetThreadBuffer();
+
+    template<typename HandlerType>
+    void ProcessThreadEvents(HandlerType Handler)const;
+
+    Timer               m_Timer;
+    std::atomic<bool>   m_Enabled{true};
+    std::atomic<Uint32> m_ThreadBufferCapacity{DefaultThreadBufferCapacity};
+    std::atomic<Uint64> m_Generation{0};
+
+    // Buffers are never released, so that the events recorded by the threads
+    // that have exited are still available
+    mutable std::mutex                         m_BuffersMtx;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_ThreadBuffers;
+};
+
+}
+
+#define DILIGENT_PROFILE_CONCAT_IMPL(x, y) x##y
+#define DILIGENT_PROFILE_CONCAT(x, y) DILIGENT_PROFILE_CONCAT_IMPL(x, y)
+
+#if DILIGENT_CPU_PROFILER
+    /// Marks the scope with the given name. The name must have static storage duration.
+#   define DILIGENT_PROFILE_SCOPE(Name) Diligent::CpuProfiler::ScopedMarker DILIGENT_PROFILE_CONCAT(_ProfileScope, __LINE__){Name}
+    /// Marks the enclosing function
+#   define DILIGENT_PROFILE_FUNCTION()  DILIGENT_PROFILE_SCOPE(__FUNCTION__)
+#else
+#   define DILIGENT_PROFILE_SCOPE(Name)
+#   define DILIGENT_PROFILE_FUNCTION()
+#endif
@@ -27,6 +27,7 @@
 #include <memory>
 #include <cstring>
 
+#include "../../Primitives/interface/BasicTypes.h"
 #include "../../Primitives/interface/Errors.h"
 #include "../../Platforms/Basic/interface/DebugUtilities.h"
 
@@ -56,6 +57,70 @@ namespace Diligent
         return Seed;
     }
 
+    // FNV-1a hash does not depend on the platform or the standard library,
+    // so unlike std::hash it can be used for hashes that are stored in files
+    // http://www.isthe.com/chongo/tech/comp/fnv/index.html
+    constexpr Uint64 FNV1aOffsetBasis = 0xcbf29ce484222325ull;
+    constexpr Uint64 FNV1aPrime       = 0x100000001b3ull;
+
+    /// Computes 64-bit FNV-1a hash of the data. Pass the previous hash value as
+    /// Hash to continue hashing the data that spans multiple buffers.
+    inline Uint64 ComputeFNV1aHash(const void* pData, size_t Size, Uint64 Hash = FNV1aOffsetBasis)
+    {
+        const auto* pBytes = reinterpret_cast<const Uint8*>(pData);
+        for (size_t i = 0; i < Size; ++i)
+        {
+            Hash ^= pBytes[i];
+            Hash *= FNV1aPrime;
+        }
+        return Hash;
+    }
+
+    /// Computes 64-bit MurmurHash64A hash of the data. Like FNV-1a, the hash does not depend on the
+    /// platform. The algorithms are unrelated, so the hashes can be combined to reduce the probability
+    /// of collisions. Pass the previous hash value as Seed to continue hashing the data that spans
+    /// multiple buffers.
+    // https://github.com/aappleby/smhasher/blob/master/src/MurmurHash2.cpp
+    inline Uint64 ComputeMurmurHash64A(const void* pData, size_t Size, Uint64 Seed = 0)
+    {
+        constexpr Uint64 m = 0xc6a4a7935bd1e995ull;
+        constexpr int    r = 47;
+
+        const auto* pBytes = reinterpret_cast<const Uint8*>(pData);
+        // Blocks are read as little-endian values on every platform
+        auto ReadBlock = [](const Uint8* pBlock, size_t NumBytes)
+        {
+            Uint64 Block = 0;
+            for (size_t i = 0; i < NumBytes; ++i)
+                Block |= static_cast<Uint64>(pBlock[i]) << (i * 8);
+            return Block;
+        };
+
+        Uint64 h = Seed ^ (static_cast<Uint64>(Size) * m);
+        const size_t NumBlocks = Size / 8;
+        for (size_t i = 0; i < NumBlocks; ++i)
+        {
+            auto k = ReadBlock(pBytes + i * 8, 8);
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h ^= k;
+            h *= m;
+        }
+
+        const size_t TailSize = Size & 7;
+        if (TailSize != 0)
+        {
+            h ^= ReadBlock(pBytes + NumBlocks * 8, TailSize);
+            h *= m;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
     template<typename CharType>
     struct CStringHash
     {
@@ -95,6 +160,9 @@ namespace Diligent
     struct HashMapStringKey
     {
     public:
+        /// Tag that indicates that the string has been interned (see StringInternPool)
+        struct InternedStringTag{};
+
         // This constructor can perform implicit const Char* -> HashMapStringKey
         // conversion without copying the string
         HashMapStringKey(const Char* Str, bool bMakeCopy = false) :
@@ -112,6 +180,16 @@ namespace Diligent
             }
         }
         
+        // Interned strings are equal if and only if their pointers are equal,
+        // so two interned keys are compared without strcmp
+        HashMapStringKey(const Char* InternedStr, InternedStringTag) :
+            StrPtr    (InternedStr),
+            Hash      (0),
+            IsInterned(true)
+        {
+            VERIFY( InternedStr, "String pointer cannot be null" );
+        }
+
         explicit // Make this constructor explicit to avoid unintentional string copies 
         HashMapStringKey(const String& Str) :
             StrPtr( nullptr ),
@@ -123,7 +201,8 @@ namespace Diligent
         HashMapStringKey(HashMapStringKey&& Key)noexcept :
             StringBuff(std::move(Key.StringBuff)),
             StrPtr    (std::move(Key.StrPtr)),
-            Hash      (0)
+            Hash      (0),
+            IsInterned(Key.IsInterned)
         {
             Key.StrPtr = nullptr;
             Key.Hash = 0;
@@ -140,6 +219,9 @@ namespace Diligent
         {
             if( StrPtr == RHS.StrPtr )
                 return true;
+
+            if( IsInterned && RHS.IsInterned )
+                return false;
             
             // Hash member might not have been initialized
             if( (Hash != 0 && RHS.Hash !=0 && Hash != RHS.Hash) || StrPtr == nullptr || RHS.StrPtr == nullptr )
@@ -191,5 +273,6 @@ namespace Diligent
         std::unique_ptr< Char[] > StringBuff; // Must be declared first
         const Char* StrPtr;// Must be declared after StringBuff
         mutable size_t Hash;
+        bool IsInterned = false;
     };
 }
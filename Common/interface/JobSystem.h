@@ -0,0 +1,215 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::JobSystem class
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Primitives/interface/ThreadPool.h"
+#include "../../Platforms/Basic/interface/DebugUtilities.h"
+#include "LockHelper.h"
+
+namespace Diligent
+{
+
+/// Work-stealing job scheduler used for engine-internal parallelism
+
+/// Every worker thread owns a task deque. A worker pushes tasks it spawns to the back of its own
+/// deque and pops them from the back (LIFO), while idle workers steal from the front of other
+/// workers' deques (FIFO). Tasks submitted from threads that are not workers of this job system
+/// are distributed among the deques in a round-robin fashion.
+///
+/// A task may depend on any number of other tasks. It is scheduled for execution only when
+/// all its prerequisites have completed.
+///
+/// If the job system is initialized with an external thread pool (see IThreadPool), it does
+/// not create own threads. Instead, every scheduled task is dispatched to the pool.
+/// If the job system has neither worker threads nor the external pool, tasks are executed
+/// by the thread that makes them ready for execution.
+///
+/// If a task function throws an exception, the exception is stored in the task, and the task
+/// is completed as usual: its continuations are scheduled. Wait() rethrows the exception.
+class JobSystem
+{
+public:
+    class Task;
+    using TaskHandle   = std::shared_ptr<Task>;
+    using TaskFunction = std::function<void()>;
+
+    /// Task object. Applications only access tasks through TaskHandle.
+    class Task
+    {
+    public:
+        explicit Task(TaskFunction&& Func) :
+            m_Func(std::move(Func))
+        {}
+
+        /// Returns true if the task has been executed
+        bool IsComplete()const { return m_IsComplete.load(); }
+
+        /// Returns the exception thrown by the task function, or null if the function did not throw.
+        /// Must only be called after the task is complete.
+        std::exception_ptr GetException()const
+        {
+            VERIFY(IsComplete(), "The task has not been executed yet");
+            return m_Exception;
+        }
+
+    private:
+        friend class JobSystem;
+
+        TaskFunction       m_Func;
+        std::exception_ptr m_Exception;
+
+        // The counter is initialized to 1 to prevent the task from being
+        // executed until it is submitted
+        std::atomic<Int32> m_NumPendingDependencies{1};
+        std::atomic<bool>  m_IsComplete{false};
+
+        // Protects m_Continuations and m_ContinuationsLocked
+        ThreadingTools::LockFlag m_ContinuationsLockFlag;
+        bool                     m_ContinuationsLocked = false;
+        std::vector<TaskHandle>  m_Continuations;
+    };
+
+    /// Counters of a single job system queue
+    struct QueueStats
+    {
+        /// The number of tasks currently waiting in the queue
+        Uint32 QueueDepth       = 0;
+
+        /// The total number of tasks executed by the thread that owns the queue
+        Uint64 NumTasksExecuted = 0;
+
+        /// The total number of tasks the owning thread has stolen from other queues
+        Uint64 NumSteals        = 0;
+    };
+
+    /// \param [in] NumWorkerThreads - the number of worker threads to create. Ignored if pThreadPool is not null.
+    /// \param [in] pThreadPool      - optional external thread pool to execute the tasks.
+    JobSystem(Uint32 NumWorkerThreads, IThreadPool* pThreadPool = nullptr);
+    ~JobSystem();
+
+    JobSystem             (const JobSystem&) = delete;
+    JobSystem             (JobSystem&&)      = delete;
+    JobSystem& operator = (const JobSystem&) = delete;
+    JobSystem& operator = (JobSystem&&)      = delete;
+
+    /// Creates a new task. The task is not executed until it is submitted with Submit().
+    TaskHandle CreateTask(TaskFunction Func);
+
+    /// Makes the Dependent task wait for the Prerequisite task to complete.
+    /// The dependent task must not have been submitted yet.
+    void AddDependency(const TaskHandle& Dependent, const TaskHandle& Prerequisite);
+
+    /// Submits the task for execution. The task is executed as soon as all its prerequisites are complete.
+    void Submit(const TaskHandle& pTask);
+
+    /// Creates and submits a task
+    TaskHandle Run(TaskFunction Func)
+    {
+        auto pTask = CreateTask(std::move(Func));
+        Submit(pTask);
+        return pTask;
+    }
+
+    /// Creates and submits a task that is executed after the Prerequisite task completes
+    TaskHandle ContinueWith(const TaskHandle& Prerequisite, TaskFunction Func)
+    {
+        auto pTask = CreateTask(std::move(Func));
+        AddDependency(pTask, Prerequisite);
+        Submit(pTask);
+        return pTask;
+    }
+
+    /// Blocks until the task is complete. While waiting, the calling thread executes other scheduled tasks.
+    /// If the task function has thrown an exception, the method rethrows it. Exceptions thrown
+    /// by other tasks executed while waiting are stored in those tasks.
+    void Wait(const TaskHandle& pTask);
+
+    /// Splits the [Begin, End) range into chunks of at most GrainSize elements and calls Func(ChunkBegin, ChunkEnd)
+    /// for every chunk in parallel. The method returns when all chunks have been processed.
+    /// If GrainSize is 0, the job system selects the chunk size automatically.
+    /// If Func throws an exception for any chunk, the method rethrows the first exception
+    /// after all chunks have been processed.
+    void ParallelFor(Uint32 Begin, Uint32 End, Uint32 GrainSize, const std::function<void(Uint32, Uint32)>& Func);
+
+    /// Returns the number of threads that execute the tasks, not counting the threads that wait for tasks.
+    Uint32 GetNumThreads()const { return m_pThreadPool != nullptr ? m_pThreadPool->GetNumThreads() : static_cast<Uint32>(m_Workers.size()); }
+
+    /// Returns the number of task queues
+    Uint32 GetNumQueues()const { return static_cast<Uint32>(m_Queues.size()); }
+
+    /// Returns the counters of the given queue
+    QueueStats GetQueueStats(Uint32 Queue)const;
+
+    /// Returns the counters accumulated over all queues
+    QueueStats GetTotalStats()const;
+
+private:
+    struct TaskQueue
+    {
+        mutable ThreadingTools::LockFlag LockFlag;
+        std::deque<TaskHandle>           Tasks;
+        std::atomic<Uint32>              Depth{0};
+        std::atomic<Uint64>              NumTasksExecuted{0};
+        std::atomic<Uint64>              NumSteals{0};
+    };
+
+    void   Schedule(TaskHandle&& pTask);
+    void   Execute(TaskHandle&& pTask, Uint32 QueueIdx);
+    bool   ExecuteNextTask(Uint32 QueueIdx);
+    bool   PopTask(Uint32 QueueIdx, TaskHandle& pTask, bool& Stolen);
+    Uint32 GetCurrentQueueIndex()const;
+    void   WorkerThreadProc(Uint32 WorkerIdx);
+
+    static void ExternalPoolTaskProc(void* pUserData);
+
+    std::vector<std::unique_ptr<TaskQueue>> m_Queues;
+    std::vector<std::thread>                m_Workers;
+    IThreadPool* const                      m_pThreadPool;
+
+    mutable std::atomic<Uint32> m_NextQueue{0};
+    // The total number of tasks in all queues
+    std::atomic<Int32>          m_NumQueuedTasks{0};
+    // The number of tasks dispatched to the external pool that have not been processed yet
+    std::atomic<Int32>          m_NumPendingPoolTasks{0};
+
+    std::mutex              m_WorkersMtx;
+    std::condition_variable m_WorkersCondVar;
+    bool                    m_bStopWorkers = false;
+};
+
+}
@@ -0,0 +1,198 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Implementation of Diligent::LockFreeBoundedQueue class
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Primitives/interface/MemoryAllocator.h"
+#include "../../Platforms/Basic/interface/DebugUtilities.h"
+
+namespace Diligent
+{
+
+/// Fixed-capacity lock-free multi-producer multi-consumer FIFO queue
+
+/// The implementation follows the bounded MPMC queue by Dmitry Vyukov
+/// (http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+/// Every cell holds a sequence number that tells producers and consumers whether the
+/// cell is ready to be written or read. All memory is allocated once at initialization.
+///
+/// \tparam ItemType - type of the items stored in the queue. The type must be move-constructible.
+template<typename ItemType>
+class LockFreeBoundedQueue
+{
+public:
+    /// \param [in] Allocator - allocator that is used to allocate memory for the cells.
+    /// \param [in] Capacity  - maximum number of items in the queue. Must be a power of two.
+    LockFreeBoundedQueue(IMemoryAllocator& Allocator, size_t Capacity) :
+        m_Allocator(Allocator),
+        m_Mask     (Capacity - 1)
+    {
+        VERIFY(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity (", Capacity, ") must be a power of two");
+        m_Cells = reinterpret_cast<Cell*>(m_Allocator.Allocate(sizeof(Cell) * Capacity, "Memory for LockFreeBoundedQueue cells", __FILE__, __LINE__));
+        for (size_t i=0; i < Capacity; ++i)
+            new(m_Cells + i) Cell{i};
+        m_EnqueuePos.store(0, std::memory_order_relaxed);
+        m_DequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    ~LockFreeBoundedQueue()
+    {
+        // Destroy the items that are still in the queue
+        while (TryPop([](ItemType&&){}))
+            ;
+
+        for (size_t i=0; i <= m_Mask; ++i)
+            m_Cells[i].~Cell();
+        m_Allocator.Free(m_Cells);
+    }
+
+    LockFreeBoundedQueue             (const LockFreeBoundedQueue&) = delete;
+    LockFreeBoundedQueue             (LockFreeBoundedQueue&&)      = delete;
+    LockFreeBoundedQueue& operator = (const LockFreeBoundedQueue&) = delete;
+    LockFreeBoundedQueue& operator = (LockFreeBoundedQueue&&)      = delete;
+
+    /// Adds the item to the end of the queue.
+
+    /// \return true if the item was added and false if the queue is full.
+    ///         If the queue is full, the item is left untouched.
+    bool TryPush(ItemType&& Item)
+    {
+        Cell* pCell = nullptr;
+        auto Pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            pCell = &m_Cells[Pos & m_Mask];
+            auto Seq  = pCell->Sequence.load(std::memory_order_acquire);
+            auto Diff = static_cast<std::ptrdiff_t>(Seq) - static_cast<std::ptrdiff_t>(Pos);
+            if (Diff == 0)
+            {
+                // The cell is free. Try to reserve it.
+                if (m_EnqueuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (Diff < 0)
+            {
+                // The cell still holds the item from the previous lap: the queue is full
+                return false;
+            }
+            else
+            {
+                // Another producer has taken the cell
+                Pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new(pCell->GetItemPtr()) ItemType(std::move(Item));
+        pCell->Sequence.store(Pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Removes the item from the front of the queue and passes it to the handler
+
+    /// \param [in] Handler - function that is called as Handler(ItemType&& Item). The item
+    ///                       is destroyed after the handler returns.
+    /// \return true if an item was removed and false if the queue is empty.
+    template<typename HandlerType>
+    bool TryPop(HandlerType Handler)
+    {
+        Cell* pCell = nullptr;
+        auto Pos = m_DequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            pCell = &m_Cells[Pos & m_Mask];
+            auto Seq  = pCell->Sequence.load(std::memory_order_acquire);
+            auto Diff = static_cast<std::ptrdiff_t>(Seq) - static_cast<std::ptrdiff_t>(Pos + 1);
+            if (Diff == 0)
+            {
+                // The cell holds an item. Try to reserve it.
+                if (m_DequeuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (Diff < 0)
+            {
+                // The queue is empty
+                return false;
+            }
+            else
+            {
+                // Another consumer has taken the cell
+                Pos = m_DequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto* pItem = pCell->GetItemPtr();
+        Handler(std::move(*pItem));
+        pItem->~ItemType();
+        // Make the cell available to producers on the next lap
+        pCell->Sequence.store(Pos + m_Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns the approximate number of items in the queue.
+    /// The value may be out of date by the time the function returns.
+    size_t GetSizeApprox()const
+    {
+        auto EnqueuePos = m_EnqueuePos.load(std::memory_order_relaxed);
+        auto DequeuePos = m_DequeuePos.load(std::memory_order_relaxed);
+        return EnqueuePos > DequeuePos ? EnqueuePos - DequeuePos : 0;
+    }
+
+    size_t GetCapacity()const { return m_Mask + 1; }
+
+private:
+    struct Cell
+    {
+        Cell(size_t InitialSequence)
+        {
+            Sequence.store(InitialSequence, std::memory_order_relaxed);
+        }
+
+        ItemType* GetItemPtr() { return reinterpret_cast<ItemType*>(&Storage); }
+
+        std::atomic<size_t> Sequence;
+        typename std::aligned_storage<sizeof(ItemType), alignof(ItemType)>::type Storage;
+    };
+
+    static constexpr size_t CacheLineSize = 64;
+
+    IMemoryAllocator& m_Allocator;
+    Cell*             m_Cells = nullptr;
+    const size_t      m_Mask;
+
+    // Keep producer and consumer positions in different cache lines
+    Uint8               m_Padding0[CacheLineSize];
+    std::atomic<size_t> m_EnqueuePos;
+    Uint8               m_Padding1[CacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_DequeuePos;
+    Uint8               m_Padding2[CacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+}
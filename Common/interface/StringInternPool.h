@@ -0,0 +1,102 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Defines Diligent::StringInternPool class
+
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Primitives/interface/MemoryAllocator.h"
+#include "HashUtils.h"
+
+namespace Diligent
+{
+
+/// Thread-safe pool that keeps a single copy of every distinct string
+
+/// Intern() returns the same pointer for all equal strings, so interned strings can be
+/// compared by pointers. The pointers remain valid until the pool is destroyed.
+/// The global pool returned by GetGlobalPool() is used for shader resource names,
+/// pipeline resource layouts and resource mappings that share the same names.
+class StringInternPool
+{
+public:
+    /// Memory usage counters
+    struct Stats
+    {
+        /// The number of distinct strings in the pool
+        size_t NumStrings     = 0;
+
+        /// The total number of Intern() calls
+        size_t NumRequests    = 0;
+
+        /// The total size of all distinct strings, including null terminators
+        size_t UniqueSize     = 0;
+
+        /// The total size of all strings passed to Intern(), including null terminators.
+        /// RequestedSize - UniqueSize is the amount of memory saved by interning.
+        size_t RequestedSize  = 0;
+
+        /// The total size of memory pages allocated by the pool
+        size_t ReservedSize   = 0;
+    };
+
+    static constexpr const size_t DefaultPageSize = 4096;
+
+    StringInternPool(IMemoryAllocator& Allocator, size_t PageSize = DefaultPageSize);
+    ~StringInternPool();
+
+    StringInternPool             (const StringInternPool&)  = delete;
+    StringInternPool             (      StringInternPool&&) = delete;
+    StringInternPool& operator = (const StringInternPool&)  = delete;
+    StringInternPool& operator = (      StringInternPool&&) = delete;
+
+    /// Returns the pointer to the interned copy of the string
+    const Char* Intern(const Char* Str);
+    const Char* Intern(const String& Str) { return Intern(Str.c_str()); }
+
+    Stats GetStats()const;
+
+    /// Returns the process-wide pool
+    static StringInternPool& GetGlobalPool();
+
+private:
+    Char* AllocateString(size_t Size);
+
+    mutable std::mutex m_Mtx;
+    IMemoryAllocator&  m_Allocator;
+    const size_t       m_PageSize;
+
+    std::unordered_set<HashMapStringKey, HashMapStringKey::Hasher> m_Strings;
+    std::vector<void*> m_Pages;
+    Char*              m_pCurrPtr       = nullptr;
+    size_t             m_RemainingSize  = 0;
+
+    Stats              m_Stats;
+};
+
+}
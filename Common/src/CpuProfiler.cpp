@@ -0,0 +1,263 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
+#include "CpuProfiler.h"
+#include "HashUtils.h"
+#include "DebugUtilities.h"
+
+namespace Diligent
+{
+
+// Buffer of the current thread. There is only one profiler instance, so
+// the pointer does not need to identify the profiler.
+static thread_local void* g_pThreadBuffer = nullptr;
+
+CpuProfiler& CpuProfiler::Get()
+{
+    static CpuProfiler Profiler;
+    return Profiler;
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::GetThreadBuffer()
+{
+    if (g_pThreadBuffer == nullptr)
+    {
+        std::lock_guard<std::mutex> Lock{m_BuffersMtx};
+        const auto ThreadId = static_cast<Uint32>(m_ThreadBuffers.size());
+        m_ThreadBuffers.emplace_back(new ThreadBuffer{ThreadId, m_ThreadBufferCapacity.load()});
+        m_ThreadBuffers.back()->Generation.store(m_Generation.load());
+        g_pThreadBuffer = m_ThreadBuffers.back().get();
+    }
+    return *reinterpret_cast<ThreadBuffer*>(g_pThreadBuffer);
+}
+
+void CpuProfiler::RecordEvent(const Char* Name, double Start, double End, Uint32 Depth)
+{
+    auto& Buffer = GetThreadBuffer();
+
+    const auto Generation = m_Generation.load(std::memory_order_relaxed);
+    if (Buffer.Generation.load(std::memory_order_relaxed) != Generation)
+    {
+        Buffer.NumEvents.store(0);
+        Buffer.NumDropped.store(0);
+        Buffer.Generation.store(Generation);
+    }
+
+    const auto Idx = Buffer.NumEvents.load(std::memory_order_relaxed);
+    if (Idx >= Buffer.Events.size())
+    {
+        Buffer.NumDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& Evt = Buffer.Events[Idx];
+    Evt.Name  = Name;
+    Evt.Start = Start;
+    Evt.End   = End;
+    Evt.Depth = Depth;
+    // Make the event visible to the threads that read the buffer
+    Buffer.NumEvents.store(Idx + 1, std::memory_order_release);
+}
+
+template<typename HandlerType>
+void CpuProfiler::ProcessThreadEvents(HandlerType Handler)const
+{
+    std::lock_guard<std::mutex> Lock{m_BuffersMtx};
+    for (const auto& pBuffer : m_ThreadBuffers)
+    {
+        // Buffers that have not been cleared after Reset() contain stale events
+        if (pBuffer->Generation.load() != m_Generation.load())
+            continue;
+
+        const auto NumEvents = pBuffer->NumEvents.load(std::memory_order_acquire);
+        if (NumEvents > 0)
+            Handler(pBuffer->ThreadId, pBuffer->Events.data(), NumEvents);
+    }
+}
+
+static void WriteJSONString(std::ostream& Stream, const Char* Str)
+{
+    Stream << '"';
+    for (; *Str != 0; ++Str)
+    {
+        if (*Str == '"' || *Str == '\\')
+            Stream << '\\';
+        Stream << *Str;
+    }
+    Stream << '"';
+}
+
+void CpuProfiler::WriteChromeTrace(std::ostream& Stream)const
+{
+    const auto Flags     = Stream.flags();
+    const auto Precision = Stream.precision();
+
+    Stream << "{\"traceEvents\":[";
+    bool IsFirstEvent = true;
+    ProcessThreadEvents(
+        [&](Uint32 ThreadId, const Event* pEvents, Uint32 NumEvents)
+        {
+            for (Uint32 e=0; e < NumEvents; ++e)
+            {
+                const auto& Evt = pEvents[e];
+                Stream << (IsFirstEvent ? "\n" : ",\n") << "{\"name\":";
+                WriteJSONString(Stream, Evt.Name);
+                // Trace event timestamps and durations are in microseconds
+                Stream << ",\"cat\":\"Diligent\",\"ph\":\"X\",\"pid\":0,\"tid\":" << ThreadId
+                       << std::fixed << std::setprecision(3)
+                       << ",\"ts\":"  << Evt.Start * 1e+6
+                       << ",\"dur\":" << (Evt.End - Evt.Start) * 1e+6
+                       << '}';
+                IsFirstEvent = false;
+            }
+        }
+    );
+    Stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    Stream.flags(Flags);
+    Stream.precision(Precision);
+}
+
+bool CpuProfiler::DumpChromeTrace(const Char* FilePath)const
+{
+    VERIFY_EXPR(FilePath != nullptr);
+    std::ofstream File{FilePath};
+    if (!File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open file '", FilePath, "' to write the CPU profiler trace");
+        return false;
+    }
+    WriteChromeTrace(File);
+    return File.good();
+}
+
+void CpuProfiler::GetSummary(std::vector<ScopeStats>& Stats)const
+{
+    Stats.clear();
+    // Names are static strings, so keys do not need to make copies
+    std::unordered_map<HashMapStringKey, ScopeStats, HashMapStringKey::Hasher> ScopeStatsMap;
+
+    std::vector<Event>  SortedEvents;
+    std::vector<double> ChildTime;
+    std::vector<size_t> ParentStack;
+    ProcessThreadEvents(
+        [&](Uint32 /*ThreadId*/, const Event* pEvents, Uint32 NumEvents)
+        {
+            // Events are recorded when scopes end, so nested scopes precede their parents.
+            // Sort events by start time to restore the hierarchy.
+            SortedEvents.assign(pEvents, pEvents + NumEvents);
+            std::sort(SortedEvents.begin(), SortedEvents.end(),
+                [](const Event& E1, const Event& E2)
+                {
+                    return E1.Start < E2.Start || (E1.Start == E2.Start && E1.Depth < E2.Depth);
+                }
+            );
+            ChildTime.assign(SortedEvents.size(), 0.0);
+            ParentStack.clear();
+            for (size_t e=0; e < SortedEvents.size(); ++e)
+            {
+                const auto& Evt = SortedEvents[e];
+                while (!ParentStack.empty() && SortedEvents[ParentStack.back()].Depth >= Evt.Depth)
+                    ParentStack.pop_back();
+                if (!ParentStack.empty())
+                    ChildTime[ParentStack.back()] += Evt.End - Evt.Start;
+                ParentStack.push_back(e);
+            }
+
+            for (size_t e=0; e < SortedEvents.size(); ++e)
+            {
+                const auto& Evt      = SortedEvents[e];
+                const auto  Duration = Evt.End - Evt.Start;
+
+                auto it = ScopeStatsMap.find(HashMapStringKey{Evt.Name});
+                if (it == ScopeStatsMap.end())
+                {
+                    ScopeStats NewStats;
+                    NewStats.Name    = Evt.Name;
+                    NewStats.MinTime = Duration;
+                    NewStats.MaxTime = Duration;
+                    it = ScopeStatsMap.emplace(HashMapStringKey{Evt.Name}, NewStats).first;
+                }
+                auto& Scope = it->second;
+                ++Scope.Count;
+                Scope.TotalTime += Duration;
+                Scope.SelfTime  += Duration - ChildTime[e];
+                Scope.MinTime    = std::min(Scope.MinTime, Duration);
+                Scope.MaxTime    = std::max(Scope.MaxTime, Duration);
+            }
+        }
+    );
+
+    Stats.reserve(ScopeStatsMap.size());
+    for (const auto& it : ScopeStatsMap)
+        Stats.push_back(it.second);
+    std::sort(Stats.begin(), Stats.end(),
+        [](const ScopeStats& S1, const ScopeStats& S2)
+        {
+            return S1.TotalTime > S2.TotalTime;
+        }
+    );
+}
+
+Uint64 CpuProfiler::GetNumDroppedEvents()const
+{
+    Uint64 NumDropped = 0;
+    std::lock_guard<std::mutex> Lock{m_BuffersMtx};
+    for (const auto& pBuffer : m_ThreadBuffers)
+    {
+        if (pBuffer->Generation.load() == m_Generation.load())
+            NumDropped += pBuffer->NumDropped.load();
+    }
+    return NumDropped;
+}
+
+CpuProfiler::ScopedMarker::ScopedMarker(const Char* Name) :
+    m_Name(Name)
+{
+    auto& Profiler = CpuProfiler::Get();
+    if (Profiler.IsEnabled())
+    {
+        ++Profiler.GetThreadBuffer().Depth;
+        m_Start = Profiler.GetTime();
+    }
+}
+
+CpuProfiler::ScopedMarker::~ScopedMarker()
+{
+    if (m_Start < 0)
+        return;
+
+    auto& Profiler = CpuProfiler::Get();
+    const auto End = Profiler.GetTime();
+    auto& Buffer = Profiler.GetThreadBuffer();
+    VERIFY_EXPR(Buffer.Depth > 0);
+    --Buffer.Depth;
+    Profiler.RecordEvent(m_Name, m_Start, End, Buffer.Depth);
+}
+
+}
@@ -0,0 +1,355 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include <algorithm>
+#include "JobSystem.h"
+
+namespace Diligent
+{
+
+// Job system the current thread is a worker of, and the index of the worker
+static thread_local const JobSystem* g_pWorkerJobSystem = nullptr;
+static thread_local Uint32           g_WorkerIdx        = 0;
+
+JobSystem::JobSystem(Uint32 NumWorkerThreads, IThreadPool* pThreadPool) :
+    m_pThreadPool(pThreadPool)
+{
+    if (m_pThreadPool != nullptr)
+        NumWorkerThreads = 0;
+
+    // Tasks dispatched to the external pool are kept in a single queue
+    auto NumQueues = std::max(NumWorkerThreads, 1u);
+    m_Queues.reserve(NumQueues);
+    for (Uint32 q=0; q < NumQueues; ++q)
+        m_Queues.emplace_back(new TaskQueue);
+
+    m_Workers.reserve(NumWorkerThreads);
+    for (Uint32 w=0; w < NumWorkerThreads; ++w)
+        m_Workers.emplace_back(&JobSystem::WorkerThreadProc, this, w);
+}
+
+JobSystem::~JobSystem()
+{
+    if (!m_Workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_WorkersMtx};
+            m_bStopWorkers = true;
+        }
+        m_WorkersCondVar.notify_all();
+        // Workers process all remaining tasks before exiting
+        for (auto& Worker : m_Workers)
+            Worker.join();
+    }
+
+    // The pool may still hold the callbacks that reference this object
+    while (m_NumPendingPoolTasks.load() > 0)
+    {
+        if (!ExecuteNextTask(0))
+            std::this_thread::yield();
+    }
+
+    VERIFY(m_NumQueuedTasks.load() == 0, "Not all tasks have been executed");
+}
+
+JobSystem::TaskHandle JobSystem::CreateTask(TaskFunction Func)
+{
+    VERIFY(Func, "Task function must not be empty");
+    return std::make_shared<Task>(std::move(Func));
+}
+
+void JobSystem::AddDependency(const TaskHandle& Dependent, const TaskHandle& Prerequisite)
+{
+    VERIFY_EXPR(Dependent && Prerequisite);
+    VERIFY(Dependent != Prerequisite, "A task can't depend on itself");
+    VERIFY(Dependent->m_NumPendingDependencies.load() > 0, "Dependencies can only be added to tasks that have not been submitted");
+
+    ThreadingTools::LockHelper Lock{Prerequisite->m_ContinuationsLockFlag};
+    // If the continuations list is locked, the prerequisite task has already been executed
+    if (!Prerequisite->m_ContinuationsLocked)
+    {
+        ++Dependent->m_NumPendingDependencies;
+        Prerequisite->m_Continuations.push_back(Dependent);
+    }
+}
+
+void JobSystem::Submit(const TaskHandle& pTask)
+{
+    VERIFY_EXPR(pTask);
+    if (--pTask->m_NumPendingDependencies == 0)
+    {
+        auto pReadyTask = pTask;
+        Schedule(std::move(pReadyTask));
+    }
+}
+
+Uint32 JobSystem::GetCurrentQueueIndex()const
+{
+    if (g_pWorkerJobSystem == this)
+        return g_WorkerIdx;
+    else
+        return m_NextQueue.fetch_add(1) % static_cast<Uint32>(m_Queues.size());
+}
+
+void JobSystem::Schedule(TaskHandle&& pTask)
+{
+    if (m_Workers.empty() && m_pThreadPool == nullptr)
+    {
+        // There are no threads to run the task
+        Execute(std::move(pTask), 0);
+        return;
+    }
+
+    auto& Queue = *m_Queues[GetCurrentQueueIndex()];
+    {
+        ThreadingTools::LockHelper Lock{Queue.LockFlag};
+        Queue.Tasks.emplace_back(std::move(pTask));
+        ++Queue.Depth;
+        ++m_NumQueuedTasks;
+    }
+
+    if (m_pThreadPool != nullptr)
+    {
+        ++m_NumPendingPoolTasks;
+        m_pThreadPool->EnqueueTask(ExternalPoolTaskProc, this);
+    }
+    else
+    {
+        // Acquire the mutex to make sure that a worker thread is either not
+        // yet checking the predicate or is already waiting on the condition variable.
+        // Otherwise the notification may be lost.
+        {
+            std::lock_guard<std::mutex> Lock{m_WorkersMtx};
+        }
+        m_WorkersCondVar.notify_one();
+    }
+}
+
+bool JobSystem::PopTask(Uint32 QueueIdx, TaskHandle& pTask, bool& Stolen)
+{
+    // Take the most recently added task from the own queue first
+    {
+        auto& Queue = *m_Queues[QueueIdx];
+        if (Queue.Depth.load() > 0)
+        {
+            ThreadingTools::LockHelper Lock{Queue.LockFlag};
+            if (!Queue.Tasks.empty())
+            {
+                pTask = std::move(Queue.Tasks.back());
+                Queue.Tasks.pop_back();
+                --Queue.Depth;
+                --m_NumQueuedTasks;
+                Stolen = false;
+                return true;
+            }
+        }
+    }
+
+    // Steal the oldest task from other queues
+    const auto NumQueues = static_cast<Uint32>(m_Queues.size());
+    for (Uint32 i=1; i < NumQueues; ++i)
+    {
+        auto& Queue = *m_Queues[(QueueIdx + i) % NumQueues];
+        if (Queue.Depth.load() == 0)
+            continue;
+
+        ThreadingTools::LockHelper Lock{Queue.LockFlag};
+        if (!Queue.Tasks.empty())
+        {
+            pTask = std::move(Queue.Tasks.front());
+            Queue.Tasks.pop_front();
+            --Queue.Depth;
+            --m_NumQueuedTasks;
+            Stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(TaskHandle&& pTask, Uint32 QueueIdx)
+{
+    try
+    {
+        pTask->m_Func();
+    }
+    catch (...)
+    {
+        // An exception must not leave the worker thread, and the task must still complete
+        // so that the threads waiting for it and its continuations make progress
+        pTask->m_Exception = std::current_exception();
+    }
+    // Release the resources captured by the function
+    pTask->m_Func = nullptr;
+    ++m_Queues[QueueIdx]->NumTasksExecuted;
+
+    std::vector<TaskHandle> Continuations;
+    {
+        ThreadingTools::LockHelper Lock{pTask->m_ContinuationsLockFlag};
+        pTask->m_ContinuationsLocked = true;
+        Continuations.swap(pTask->m_Continuations);
+    }
+    pTask->m_IsComplete.store(true);
+
+    for (auto& pContinuation : Continuations)
+    {
+        if (--pContinuation->m_NumPendingDependencies == 0)
+            Schedule(std::move(pContinuation));
+    }
+}
+
+bool JobSystem::ExecuteNextTask(Uint32 QueueIdx)
+{
+    TaskHandle pTask;
+    bool Stolen = false;
+    if (!PopTask(QueueIdx, pTask, Stolen))
+        return false;
+
+    if (Stolen)
+        ++m_Queues[QueueIdx]->NumSteals;
+    Execute(std::move(pTask), QueueIdx);
+    return true;
+}
+
+void JobSystem::Wait(const TaskHandle& pTask)
+{
+    VERIFY_EXPR(pTask);
+    const auto QueueIdx = GetCurrentQueueIndex();
+    while (!pTask->IsComplete())
+    {
+        if (!ExecuteNextTask(QueueIdx))
+            std::this_thread::yield();
+    }
+
+    if (pTask->m_Exception)
+        std::rethrow_exception(pTask->m_Exception);
+}
+
+void JobSystem::ParallelFor(Uint32 Begin, Uint32 End, Uint32 GrainSize, const std::function<void(Uint32, Uint32)>& Func)
+{
+    if (End <= Begin)
+        return;
+
+    const auto Count = End - Begin;
+    if (GrainSize == 0)
+    {
+        // Create several chunks per thread to let the work be balanced by stealing
+        const auto NumChunks = std::max(GetNumThreads(), 1u) * 4;
+        GrainSize = std::max((Count + NumChunks - 1) / NumChunks, 1u);
+    }
+
+    std::vector<TaskHandle> Tasks;
+    Tasks.reserve((Count + GrainSize - 1) / GrainSize);
+    auto ChunkBegin = Begin;
+    while (End - ChunkBegin > GrainSize)
+    {
+        const auto ChunkEnd = ChunkBegin + GrainSize;
+        Tasks.emplace_back(Run([&Func, ChunkBegin, ChunkEnd]() { Func(ChunkBegin, ChunkEnd); }));
+        ChunkBegin = ChunkEnd;
+    }
+
+    // Process the last chunk on this thread. The other chunks reference Func, so
+    // all of them must be complete before an exception leaves the method.
+    std::exception_ptr pException;
+    try
+    {
+        Func(ChunkBegin, End);
+    }
+    catch (...)
+    {
+        pException = std::current_exception();
+    }
+
+    for (const auto& pTask : Tasks)
+    {
+        try
+        {
+            Wait(pTask);
+        }
+        catch (...)
+        {
+            if (!pException)
+                pException = std::current_exception();
+        }
+    }
+
+    if (pException)
+        std::rethrow_exception(pException);
+}
+
+JobSystem::QueueStats JobSystem::GetQueueStats(Uint32 Queue)const
+{
+    VERIFY(Queue < m_Queues.size(), "Queue index (", Queue, ") is out of range");
+    const auto& TaskQueue = *m_Queues[Queue];
+
+    QueueStats Stats;
+    Stats.QueueDepth       = TaskQueue.Depth.load();
+    Stats.NumTasksExecuted = TaskQueue.NumTasksExecuted.load();
+    Stats.NumSteals        = TaskQueue.NumSteals.load();
+    return Stats;
+}
+
+JobSystem::QueueStats JobSystem::GetTotalStats()const
+{
+    QueueStats TotalStats;
+    for (Uint32 q=0; q < m_Queues.size(); ++q)
+    {
+        auto Stats = GetQueueStats(q);
+        TotalStats.QueueDepth       += Stats.QueueDepth;
+        TotalStats.NumTasksExecuted += Stats.NumTasksExecuted;
+        TotalStats.NumSteals        += Stats.NumSteals;
+    }
+    return TotalStats;
+}
+
+void JobSystem::WorkerThreadProc(Uint32 WorkerIdx)
+{
+    g_pWorkerJobSystem = this;
+    g_WorkerIdx        = WorkerIdx;
+
+    for (;;)
+    {
+        if (ExecuteNextTask(WorkerIdx))
+            continue;
+
+        std::unique_lock<std::mutex> Lock{m_WorkersMtx};
+        m_WorkersCondVar.wait(Lock, [this] { return m_bStopWorkers || m_NumQueuedTasks.load() > 0; });
+        if (m_bStopWorkers && m_NumQueuedTasks.load() == 0)
+            break;
+    }
+
+    g_pWorkerJobSystem = nullptr;
+}
+
+void JobSystem::ExternalPoolTaskProc(void* pUserData)
+{
+    auto* pJobSystem = reinterpret_cast<JobSystem*>(pUserData);
+    // The task may have already been executed by a thread waiting for another task
+    pJobSystem->ExecuteNextTask(0);
+    // This must be the last access to the job system object
+    --pJobSystem->m_NumPendingPoolTasks;
+}
+
+}
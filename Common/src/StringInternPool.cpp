@@ -0,0 +1,105 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include <cstring>
+#include <algorithm>
+#include "StringInternPool.h"
+#include "DefaultRawMemoryAllocator.h"
+#include "DebugUtilities.h"
+
+namespace Diligent
+{
+
+StringInternPool::StringInternPool(IMemoryAllocator& Allocator, size_t PageSize) :
+    m_Allocator(Allocator),
+    m_PageSize (PageSize)
+{
+    VERIFY_EXPR(PageSize > 0);
+}
+
+StringInternPool::~StringInternPool()
+{
+    // Keys reference the memory in the pages
+    m_Strings.clear();
+    for (auto* pPage : m_Pages)
+        m_Allocator.Free(pPage);
+}
+
+Char* StringInternPool::AllocateString(size_t Size)
+{
+    if (Size > m_RemainingSize)
+    {
+        // Long strings get dedicated pages, so that the rest of the current page is not wasted
+        const auto PageSize = std::max(Size, m_PageSize);
+        auto* pPage = reinterpret_cast<Char*>(m_Allocator.Allocate(PageSize, "Memory page for string intern pool", __FILE__, __LINE__));
+        m_Pages.push_back(pPage);
+        m_Stats.ReservedSize += PageSize;
+        if (PageSize > m_PageSize)
+            return pPage;
+
+        m_pCurrPtr      = pPage;
+        m_RemainingSize = PageSize;
+    }
+
+    auto* Ptr = m_pCurrPtr;
+    m_pCurrPtr      += Size;
+    m_RemainingSize -= Size;
+    return Ptr;
+}
+
+const Char* StringInternPool::Intern(const Char* Str)
+{
+    VERIFY(Str != nullptr, "String pointer cannot be null");
+    const auto Size = strlen(Str) + 1;
+
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    ++m_Stats.NumRequests;
+    m_Stats.RequestedSize += Size;
+
+    // The key does not make a copy of the string
+    auto it = m_Strings.find(HashMapStringKey{Str});
+    if (it != m_Strings.end())
+        return it->GetStr();
+
+    auto* pInternedStr = AllocateString(Size);
+    memcpy(pInternedStr, Str, Size);
+    m_Strings.emplace(pInternedStr, HashMapStringKey::InternedStringTag{});
+    ++m_Stats.NumStrings;
+    m_Stats.UniqueSize += Size;
+    return pInternedStr;
+}
+
+StringInternPool::Stats StringInternPool::GetStats()const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Stats;
+}
+
+StringInternPool& StringInternPool::GetGlobalPool()
+{
+    static StringInternPool GlobalPool{DefaultRawMemoryAllocator::GetAllocator()};
+    return GlobalPool;
+}
+
+}
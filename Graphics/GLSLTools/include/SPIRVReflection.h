@@ -0,0 +1,173 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::SPIRVReflection class
+
+#include <vector>
+
+#include "Shader.h"
+
+namespace Diligent
+{
+
+/// Lightweight SPIR-V reflection
+
+/// The class parses SPIR-V binary in a single pass and extracts the information that is required
+/// to enumerate shader resources: names, array sizes and word offsets of binding, descriptor set
+/// and location decorations. Resources are classified the same way as
+/// spirv_cross::Compiler::get_shader_resources() classifies them. The only memory allocated by the
+/// class is the table of SPIR-V ids. All strings reference the SPIR-V binary, which must outlive
+/// the reflection object.
+class SPIRVReflection
+{
+public:
+    enum RESOURCE_CATEGORY : Uint8
+    {
+        RESOURCE_CATEGORY_NONE = 0,
+        RESOURCE_CATEGORY_UNIFORM_BUFFER,
+        RESOURCE_CATEGORY_STORAGE_BUFFER,
+        RESOURCE_CATEGORY_STORAGE_IMAGE,
+        RESOURCE_CATEGORY_SAMPLED_IMAGE,
+        RESOURCE_CATEGORY_ATOMIC_COUNTER,
+        RESOURCE_CATEGORY_SEPARATE_SAMPLER,
+        RESOURCE_CATEGORY_SEPARATE_IMAGE,
+        RESOURCE_CATEGORY_STAGE_INPUT,
+        RESOURCE_CATEGORY_NUM_CATEGORIES
+    };
+
+    struct ResourceInfo
+    {
+        /// Id of the variable
+        Uint32      Id                            = 0;
+
+        /// Id of the variable type with pointer and array types stripped
+        Uint32      TypeId                        = 0;
+
+        /// Name of the variable. Empty string if the variable has no name.
+        const char* Name                          = "";
+
+        /// Name of the type (e.g. name of the uniform or storage block). Empty string if the type has no name.
+        const char* TypeName                      = "";
+
+        /// HLSL semantic of the stage input. Null if the variable has no HlslSemanticGOOGLE decoration.
+        const char* Semantic                      = nullptr;
+
+        /// The size of the innermost array dimension, 1 if the variable is not an array,
+        /// or 0 if it is a runtime array
+        Uint32      ArraySize                     = 1;
+
+        /// Word offsets of the decoration operands in the SPIR-V binary, or 0 if the decoration is not present
+        Uint32      BindingDecorationOffset       = 0;
+        Uint32      DescriptorSetDecorationOffset = 0;
+        Uint32      LocationDecorationOffset      = 0;
+
+        /// Whether the storage buffer is read-only
+        bool        IsReadOnly                    = false;
+
+        /// Whether the image has Buffer dimension (i.e. it is a texel buffer)
+        bool        IsTexelBuffer                 = false;
+    };
+
+    /// Parses the SPIR-V binary. Throws an exception if the binary is invalid.
+    explicit SPIRVReflection(const std::vector<uint32_t>& SPIRV);
+
+    SPIRVReflection             (const SPIRVReflection&)  = delete;
+    SPIRVReflection             (      SPIRVReflection&&) = delete;
+    SPIRVReflection& operator = (const SPIRVReflection&)  = delete;
+    SPIRVReflection& operator = (      SPIRVReflection&&) = delete;
+
+    /// Returns true if the module was produced from HLSL source
+    bool IsHLSLSource() const { return m_IsHLSLSource; }
+
+    /// Returns true if the module declares the given extension
+    bool HasExtension(const char* Extension) const;
+
+    Uint32      GetNumEntryPoints()                 const { return static_cast<Uint32>(m_EntryPoints.size()); }
+    const char* GetEntryPointName(Uint32 Index)     const;
+    SHADER_TYPE GetEntryPointShaderType(Uint32 Index) const;
+
+    /// Selects the entry point whose interface is used to enumerate stage inputs
+    void SetEntryPoint(Uint32 Index);
+
+    /// Returns the number of resources in the given category. For stage inputs,
+    /// only the inputs of the selected entry point are counted.
+    Uint32 GetNumResources(RESOURCE_CATEGORY Category) const;
+
+    /// Calls Handler(const ResourceInfo&) for every resource in the given category
+    /// in the order of declaration
+    template<typename THandler>
+    void ProcessResources(RESOURCE_CATEGORY Category, THandler Handler) const
+    {
+        for (auto Id = m_FirstResource[Category]; Id != 0; Id = m_Ids[Id].NextResource)
+        {
+            if (Category == RESOURCE_CATEGORY_STAGE_INPUT && !IsEntryPointInterface(Id))
+                continue;
+            Handler(GetResourceInfo(Id));
+        }
+    }
+
+private:
+    struct IdInfo
+    {
+        const char* Name                   = nullptr;
+        const char* Semantic               = nullptr;
+        // Word offset of the instruction that defines the id
+        Uint32      DefOffset              = 0;
+        Uint32      BindingOffset          = 0;
+        Uint32      DescriptorSetOffset    = 0;
+        Uint32      LocationOffset         = 0;
+        // Next resource of the same category
+        Uint32      NextResource           = 0;
+        Uint32      NumNonWritableMembers  = 0;
+        Uint8       Flags                  = 0;
+    };
+
+    ResourceInfo GetResourceInfo(Uint32 Id) const;
+    bool         IsEntryPointInterface(Uint32 Id) const;
+    void         ParseVariable(Uint32 Offset);
+    Uint32       StripPointerAndArrays(Uint32 TypeId, Uint32& ArraySize) const;
+
+    const std::vector<uint32_t>& m_SPIRV;
+
+    std::vector<IdInfo> m_Ids;
+    // Word offsets of OpEntryPoint instructions
+    std::vector<Uint32> m_EntryPoints;
+    // Word offset of the first interface id of the selected entry point
+    Uint32              m_InterfaceStart = 0;
+    Uint32              m_InterfaceEnd   = 0;
+
+    Uint32 m_FirstResource[RESOURCE_CATEGORY_NUM_CATEGORIES] = {};
+    Uint32 m_LastResource [RESOURCE_CATEGORY_NUM_CATEGORIES] = {};
+
+    // Word offsets of the first and the one past last extension instructions
+    Uint32 m_ExtensionsStart = 0;
+    Uint32 m_ExtensionsEnd   = 0;
+
+    bool m_IsHLSLSource = false;
+};
+
+}
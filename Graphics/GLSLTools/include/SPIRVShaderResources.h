@@ -41,12 +41,8 @@
 #include "STDAllocator.h"
 #include "RefCntAutoPtr.h"
 #include "StringPool.h"
-
-namespace spirv_cross
-{
-class Compiler;
-struct Resource;
-}
+#include "StringInternPool.h"
+#include "SPIRVReflection.h"
 
 namespace Diligent
 {
@@ -71,6 +67,8 @@ struct SPIRVShaderResourceAttribs
 
     static constexpr const Uint32   InvalidSepSmplrOrImgInd = static_cast<Uint32>(-1);
 
+      // Name is interned in the global StringInternPool, so names of
+      // the resources of all shaders can be compared by pointers
 /*  0 */const char* const           Name;
 /*  8 */const Uint16                ArraySize;
 /* 10 */const ResourceType          Type;
@@ -85,11 +83,17 @@ public:
 /* 20 */const uint32_t              DescriptorSetDecorationOffset;
 /* 24 */ // End of structure
 
-    SPIRVShaderResourceAttribs(const spirv_cross::Compiler&  Compiler, 
-                               const spirv_cross::Resource&  Res, 
-                               const char*                   _Name,
-                               ResourceType                  _Type, 
-                               Uint32                        _SamplerOrSepImgInd = InvalidSepSmplrOrImgInd) noexcept;
+    SPIRVShaderResourceAttribs(const SPIRVReflection::ResourceInfo& Res, 
+                               const char*                          _Name,
+                               ResourceType                         _Type, 
+                               Uint32                               _SamplerOrSepImgInd = InvalidSepSmplrOrImgInd) noexcept;
+
+    SPIRVShaderResourceAttribs(const char*  _Name,
+                               Uint16       _ArraySize,
+                               ResourceType _Type,
+                               Uint32       _SepSmplrOrImgInd,
+                               uint32_t     _BindingDecorationOffset,
+                               uint32_t     _DescriptorSetDecorationOffset) noexcept;
 
     bool IsValidSepSamplerAssigned() const
     {
@@ -147,6 +151,8 @@ public:
                SepSmplrOrImgInd == Attribs.SepSmplrOrImgInd;
     }
 
+    Uint32 GetSepSmplrOrImgInd()const { return SepSmplrOrImgInd; }
+
     ShaderResourceDesc GetResourceDesc() const;
 };
 static_assert(sizeof(SPIRVShaderResourceAttribs) % sizeof(void*) == 0, "Size of SPIRVShaderResourceAttribs struct must be multiple of sizeof(void*)" );
@@ -168,13 +174,24 @@ static_assert(sizeof(SPIRVShaderStageInputAttribs) % sizeof(void*) == 0, "Size o
 class SPIRVShaderResources
 {
 public:
-    SPIRVShaderResources(IMemoryAllocator&      Allocator,
-                         IRenderDevice*         pRenderDevice,
-                         std::vector<uint32_t>  spirv_binary,
-                         const ShaderDesc&      shaderDesc,
-                         const char*            CombinedSamplerSuffix,
-                         bool                   LoadShaderStageInputs,
-                         std::string&           EntryPoint);
+    SPIRVShaderResources(IMemoryAllocator&            Allocator,
+                         IRenderDevice*               pRenderDevice,
+                         const std::vector<uint32_t>& spirv_binary,
+                         const ShaderDesc&            shaderDesc,
+                         const char*                  CombinedSamplerSuffix,
+                         bool                         LoadShaderStageInputs,
+                         std::string&                 EntryPoint);
+
+    // Loads the resources from the data produced by Serialize(). No SPIRV reflection is performed:
+    // the resources are created in a single allocation directly from the serialized attributes.
+    // spirv_binary must be the byte code the data was serialized for. Throws an exception if the
+    // data is invalid.
+    SPIRVShaderResources(IMemoryAllocator&            Allocator,
+                         const std::vector<uint32_t>& spirv_binary,
+                         const void*                  pSerializedData,
+                         size_t                       SerializedDataSize,
+                         const ShaderDesc&            shaderDesc,
+                         std::string&                 EntryPoint);
 
     SPIRVShaderResources             (const SPIRVShaderResources&)  = delete;
     SPIRVShaderResources             (      SPIRVShaderResources&&) = delete;
@@ -300,6 +317,10 @@ public:
 
     std::string DumpResources();
 
+    // Writes compact binary representation of the resources to Data. Resource names are stored
+    // as offsets in the string pool that follows the attributes.
+    void Serialize(const std::string& EntryPoint, size_t SPIRVWordCount, std::vector<Uint8>& Data)const;
+
     bool IsCompatibleWith(const SPIRVShaderResources& Resources)const;
     
     const char* GetCombinedSamplerSuffix() const { return m_CombinedSamplerSuffix; } 
@@ -30,9 +30,17 @@
 namespace Diligent
 {
 
+// Initialization is reference-counted: glslang is initialized by the first call to InitializeGlslang()
+// and finalized by the matching last call to FinalizeGlslang(). While glslang is initialized,
+// GLSLtoSPIRV(), HLSLtoSPIRV() and OptimizeSPIRV() may be called concurrently from any number of threads.
 void InitializeGlslang();
 void FinalizeGlslang();
+
 std::vector<unsigned int> GLSLtoSPIRV(SHADER_TYPE ShaderType, const char* ShaderSource, int SourceCodeLen, IDataBlob** ppCompilerOutput);
 std::vector<unsigned int> HLSLtoSPIRV(const ShaderCreateInfo& Attribs, IDataBlob** ppCompilerOutput);
 
+// Runs spirv-tools optimizer on the byte code. CustomPasses is a space-separated list of spirv-opt
+// flags that is only used by SPIRV_OPTIMIZATION_LEVEL_CUSTOM. Returns empty vector if optimization failed.
+std::vector<unsigned int> OptimizeSPIRV(const std::vector<unsigned int>& SPIRV, SPIRV_OPTIMIZATION_LEVEL Level, const char* CustomPasses);
+
 }
\ No newline at end of file
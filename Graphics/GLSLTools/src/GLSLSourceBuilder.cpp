@@ -29,6 +29,7 @@
 #include "HLSL2GLSLConverterImpl.h"
 #include "RefCntAutoPtr.h"
 #include "DataBlobImpl.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -38,6 +39,7 @@ String BuildGLSLSourceString(const ShaderCreateInfo& CreationAttribs,
                              TargetGLSLCompiler           TargetCompiler,
                              const char*                  ExtraDefinitions)
 {
+    DILIGENT_PROFILE_SCOPE("BuildGLSLSourceString");
     String GLSLSource;
 
     auto ShaderType = CreationAttribs.Desc.ShaderType;
@@ -240,6 +242,13 @@ String BuildGLSLSourceString(const ShaderCreateInfo& CreationAttribs,
         "layout(std140) uniform;\n"
     );
 
+    // Push constants block must be declared as PUSH_CONSTANTS uniform BlockName { ... };
+    // OpenGL backend emulates push constants with a regular uniform buffer.
+    if (TargetCompiler == TargetGLSLCompiler::glslang)
+        GLSLSource.append("#define PUSH_CONSTANTS layout(std140, push_constant)\n");
+    else
+        GLSLSource.append("#define PUSH_CONSTANTS layout(std140)\n");
+
     if (ShaderType == SHADER_TYPE_VERTEX && TargetCompiler == TargetGLSLCompiler::glslang)
     {
         // https://github.com/KhronosGroup/GLSL/blob/master/extensions/khr/GL_KHR_vulkan_glsl.txt
@@ -0,0 +1,457 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <cstring>
+
+#include "SPIRVReflection.h"
+#include "spirv/unified1/spirv.hpp"
+#include "DebugUtilities.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+enum ID_FLAGS : Uint8
+{
+    ID_FLAG_BLOCK          = 0x01,
+    ID_FLAG_BUFFER_BLOCK   = 0x02,
+    ID_FLAG_BUILT_IN       = 0x04,
+    ID_FLAG_MEMBER_BUILTIN = 0x08,
+    ID_FLAG_NON_WRITABLE   = 0x10
+};
+
+inline spv::Op GetOpCode(uint32_t Word)
+{
+    return static_cast<spv::Op>(Word & spv::OpCodeMask);
+}
+
+inline Uint32 GetWordCount(uint32_t Word)
+{
+    return Word >> spv::WordCountShift;
+}
+
+}
+
+// Returns the number of words occupied by the null-terminated literal string
+// that starts at the given offset, or 0 if the string is not terminated before End.
+static Uint32 GetStringWordCount(const std::vector<uint32_t>& SPIRV, Uint32 Offset, Uint32 End)
+{
+    for (auto w = Offset; w < End; ++w)
+    {
+        // The string is null-terminated and padded with zeros, so it ends
+        // in the first word that contains a zero byte
+        auto Word = SPIRV[w];
+        if ((Word & 0xFF000000u) == 0 || (Word & 0x00FF0000u) == 0 || (Word & 0x0000FF00u) == 0 || (Word & 0x000000FFu) == 0)
+            return w - Offset + 1;
+    }
+    return 0;
+}
+
+SPIRVReflection::SPIRVReflection(const std::vector<uint32_t>& SPIRV) : 
+    m_SPIRV(SPIRV)
+{
+    // Header: magic number, version, generator, bound, schema
+    static constexpr Uint32 HeaderSize = 5;
+    if (SPIRV.size() < HeaderSize || SPIRV[0] != spv::MagicNumber)
+        LOG_ERROR_AND_THROW("Invalid SPIRV magic number");
+
+    const auto Bound = SPIRV[3];
+    m_Ids.resize(Bound);
+
+    auto GetIdInfo = [&](Uint32 Offset) -> IdInfo&
+    {
+        auto Id = SPIRV[Offset];
+        if (Id >= Bound)
+            LOG_ERROR_AND_THROW("SPIRV id ", Id, " at offset ", Offset, " exceeds the id bound (", Bound, ")");
+        return m_Ids[Id];
+    };
+
+    auto GetString = [&](Uint32 Offset, Uint32 InstructionEnd)
+    {
+        if (Offset >= InstructionEnd || GetStringWordCount(SPIRV, Offset, InstructionEnd) == 0)
+            LOG_ERROR_AND_THROW("Literal string at offset ", Offset, " is not null-terminated");
+        return reinterpret_cast<const char*>(&SPIRV[Offset]);
+    };
+
+    const auto Size = static_cast<Uint32>(SPIRV.size());
+    for (Uint32 Offset = HeaderSize; Offset < Size; )
+    {
+        const auto OpCode    = GetOpCode(SPIRV[Offset]);
+        const auto WordCount = GetWordCount(SPIRV[Offset]);
+        if (WordCount == 0 || Offset + WordCount > Size)
+            LOG_ERROR_AND_THROW("Invalid SPIRV instruction at offset ", Offset);
+        const auto End = Offset + WordCount;
+
+        switch (OpCode)
+        {
+            case spv::OpSource:
+                if (WordCount >= 2)
+                    m_IsHLSLSource = SPIRV[Offset + 1] == spv::SourceLanguageHLSL;
+                break;
+
+            case spv::OpExtension:
+                GetString(Offset + 1, End);
+                if (m_ExtensionsStart == 0)
+                    m_ExtensionsStart = Offset;
+                m_ExtensionsEnd = End;
+                break;
+
+            case spv::OpEntryPoint:
+                if (WordCount >= 4)
+                {
+                    GetString(Offset + 3, End);
+                    m_EntryPoints.push_back(Offset);
+                }
+                break;
+
+            case spv::OpName:
+                if (WordCount >= 3)
+                    GetIdInfo(Offset + 1).Name = GetString(Offset + 2, End);
+                break;
+
+            case spv::OpDecorate:
+                if (WordCount >= 3)
+                {
+                    auto& Info = GetIdInfo(Offset + 1);
+                    // The offset of the first decoration operand
+                    const auto OperandOffset = Offset + 3;
+                    switch (static_cast<spv::Decoration>(SPIRV[Offset + 2]))
+                    {
+                        case spv::DecorationBinding:       if (OperandOffset < End) Info.BindingOffset       = OperandOffset; break;
+                        case spv::DecorationDescriptorSet: if (OperandOffset < End) Info.DescriptorSetOffset = OperandOffset; break;
+                        case spv::DecorationLocation:      if (OperandOffset < End) Info.LocationOffset      = OperandOffset; break;
+                        case spv::DecorationBlock:         Info.Flags |= ID_FLAG_BLOCK;        break;
+                        case spv::DecorationBufferBlock:   Info.Flags |= ID_FLAG_BUFFER_BLOCK; break;
+                        case spv::DecorationBuiltIn:       Info.Flags |= ID_FLAG_BUILT_IN;     break;
+                        case spv::DecorationNonWritable:   Info.Flags |= ID_FLAG_NON_WRITABLE; break;
+                        default: break;
+                    }
+                }
+                break;
+
+            case spv::OpDecorateStringGOOGLE:
+                if (WordCount >= 4 && static_cast<spv::Decoration>(SPIRV[Offset + 2]) == spv::DecorationHlslSemanticGOOGLE)
+                    GetIdInfo(Offset + 1).Semantic = GetString(Offset + 3, End);
+                break;
+
+            case spv::OpMemberDecorate:
+                if (WordCount >= 4)
+                {
+                    auto& Info = GetIdInfo(Offset + 1);
+                    switch (static_cast<spv::Decoration>(SPIRV[Offset + 3]))
+                    {
+                        // A struct that has a built-in member is a built-in block (e.g. gl_PerVertex)
+                        case spv::DecorationBuiltIn:     Info.Flags |= ID_FLAG_MEMBER_BUILTIN; break;
+                        case spv::DecorationNonWritable: ++Info.NumNonWritableMembers;          break;
+                        default: break;
+                    }
+                }
+                break;
+
+            case spv::OpTypeImage:
+            case spv::OpTypeSampler:
+            case spv::OpTypeSampledImage:
+            case spv::OpTypeArray:
+            case spv::OpTypeRuntimeArray:
+            case spv::OpTypeStruct:
+            case spv::OpTypePointer:
+                if (WordCount >= 2)
+                    GetIdInfo(Offset + 1).DefOffset = Offset;
+                break;
+
+            case spv::OpConstant:
+            case spv::OpSpecConstant:
+                if (WordCount >= 3)
+                    GetIdInfo(Offset + 2).DefOffset = Offset;
+                break;
+
+            case spv::OpVariable:
+                if (WordCount >= 4)
+                {
+                    GetIdInfo(Offset + 2).DefOffset = Offset;
+                    ParseVariable(Offset);
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        Offset = End;
+    }
+}
+
+Uint32 SPIRVReflection::StripPointerAndArrays(Uint32 TypeId, Uint32& ArraySize) const
+{
+    // Valid SPIR-V defines types before they are used, so the type chain can't be cyclic.
+    // Malformed binaries may reference the types cyclically though, so the walk is bounded.
+    static constexpr Uint32 MaxTypeNestingDepth = 64;
+
+    ArraySize = 1;
+    for (Uint32 Depth = 0; TypeId != 0 && TypeId < m_Ids.size(); ++Depth)
+    {
+        if (Depth == MaxTypeNestingDepth)
+            LOG_ERROR_AND_THROW("Type ", TypeId, " is nested too deeply or references itself");
+
+        const auto DefOffset = m_Ids[TypeId].DefOffset;
+        if (DefOffset == 0)
+            break;
+
+        const auto  OpCode    = GetOpCode(m_SPIRV[DefOffset]);
+        const auto  WordCount = GetWordCount(m_SPIRV[DefOffset]);
+        if (OpCode == spv::OpTypePointer && WordCount >= 4)
+        {
+            TypeId = m_SPIRV[DefOffset + 3];
+        }
+        else if (OpCode == spv::OpTypeArray && WordCount >= 4)
+        {
+            // spirv_cross reports the size of the innermost dimension, so does this function
+            ArraySize = 0;
+            const auto LengthId = m_SPIRV[DefOffset + 3];
+            if (LengthId < m_Ids.size() && m_Ids[LengthId].DefOffset != 0)
+            {
+                const auto ConstOffset = m_Ids[LengthId].DefOffset;
+                if (GetWordCount(m_SPIRV[ConstOffset]) >= 4)
+                    ArraySize = m_SPIRV[ConstOffset + 3];
+            }
+            TypeId = m_SPIRV[DefOffset + 2];
+        }
+        else if (OpCode == spv::OpTypeRuntimeArray)
+        {
+            ArraySize = 0;
+            TypeId = m_SPIRV[DefOffset + 2];
+        }
+        else
+            break;
+    }
+    return TypeId;
+}
+
+void SPIRVReflection::ParseVariable(Uint32 Offset)
+{
+    const auto PointerTypeId = m_SPIRV[Offset + 1];
+    const auto VarId         = m_SPIRV[Offset + 2];
+    const auto StorageClass  = static_cast<spv::StorageClass>(m_SPIRV[Offset + 3]);
+    if (StorageClass == spv::StorageClassFunction)
+        return;
+
+    Uint32 ArraySize = 1;
+    const auto TypeId = StripPointerAndArrays(PointerTypeId, ArraySize);
+    if (TypeId >= m_Ids.size())
+        return;
+
+    const auto& Var  = m_Ids[VarId];
+    const auto& Type = m_Ids[TypeId];
+    if ((Var.Flags & ID_FLAG_BUILT_IN) != 0 || (Type.Flags & ID_FLAG_MEMBER_BUILTIN) != 0)
+        return;
+
+    const auto TypeOpCode = Type.DefOffset != 0 ? GetOpCode(m_SPIRV[Type.DefOffset]) : spv::OpNop;
+
+    auto Category = RESOURCE_CATEGORY_NONE;
+    switch (StorageClass)
+    {
+        case spv::StorageClassInput:
+            Category = RESOURCE_CATEGORY_STAGE_INPUT;
+            break;
+
+        case spv::StorageClassUniform:
+            if (Type.Flags & ID_FLAG_BLOCK)
+                Category = RESOURCE_CATEGORY_UNIFORM_BUFFER;
+            else if (Type.Flags & ID_FLAG_BUFFER_BLOCK)
+                Category = RESOURCE_CATEGORY_STORAGE_BUFFER;
+            break;
+
+        case spv::StorageClassStorageBuffer:
+            Category = RESOURCE_CATEGORY_STORAGE_BUFFER;
+            break;
+
+        case spv::StorageClassAtomicCounter:
+            Category = RESOURCE_CATEGORY_ATOMIC_COUNTER;
+            break;
+
+        case spv::StorageClassUniformConstant:
+            if (TypeOpCode == spv::OpTypeImage && GetWordCount(m_SPIRV[Type.DefOffset]) >= 9)
+            {
+                const auto Dim     = static_cast<spv::Dim>(m_SPIRV[Type.DefOffset + 3]);
+                const auto Sampled = m_SPIRV[Type.DefOffset + 7];
+                // Subpass inputs are not shader resources
+                if (Dim != spv::DimSubpassData)
+                {
+                    // Sampled == 0 means that it is only known at run time whether the image is
+                    // used with a sampler. Such images are reported as separate images as well.
+                    Category = Sampled == 2 ? RESOURCE_CATEGORY_STORAGE_IMAGE : RESOURCE_CATEGORY_SEPARATE_IMAGE;
+                }
+            }
+            else if (TypeOpCode == spv::OpTypeSampler)
+                Category = RESOURCE_CATEGORY_SEPARATE_SAMPLER;
+            else if (TypeOpCode == spv::OpTypeSampledImage)
+                Category = RESOURCE_CATEGORY_SAMPLED_IMAGE;
+            break;
+
+        default:
+            break;
+    }
+
+    if (Category == RESOURCE_CATEGORY_NONE)
+        return;
+
+    // Append the variable to the list of resources of this category
+    if (m_LastResource[Category] != 0)
+        m_Ids[m_LastResource[Category]].NextResource = VarId;
+    else
+        m_FirstResource[Category] = VarId;
+    m_LastResource[Category] = VarId;
+}
+
+SPIRVReflection::ResourceInfo SPIRVReflection::GetResourceInfo(Uint32 Id) const
+{
+    VERIFY_EXPR(Id < m_Ids.size());
+    const auto& Var = m_Ids[Id];
+    VERIFY_EXPR(Var.DefOffset != 0);
+
+    ResourceInfo Res;
+    Res.Id     = Id;
+    Res.TypeId = StripPointerAndArrays(m_SPIRV[Var.DefOffset + 1], Res.ArraySize);
+    if (Var.Name != nullptr)
+        Res.Name = Var.Name;
+    Res.Semantic                      = Var.Semantic;
+    Res.BindingDecorationOffset       = Var.BindingOffset;
+    Res.DescriptorSetDecorationOffset = Var.DescriptorSetOffset;
+    Res.LocationDecorationOffset      = Var.LocationOffset;
+
+    if (Res.TypeId >= m_Ids.size())
+        return Res;
+
+    const auto& Type = m_Ids[Res.TypeId];
+    if (Type.Name != nullptr)
+        Res.TypeName = Type.Name;
+    if (Type.DefOffset == 0)
+        return Res;
+
+    auto TypeOpCode = GetOpCode(m_SPIRV[Type.DefOffset]);
+    switch (TypeOpCode)
+    {
+        case spv::OpTypeStruct:
+        {
+            // The buffer is read-only if either the variable or all members of the block are NonWritable
+            const auto NumMembers = GetWordCount(m_SPIRV[Type.DefOffset]) - 2;
+            Res.IsReadOnly = (Var.Flags & ID_FLAG_NON_WRITABLE) != 0 || (NumMembers > 0 && Type.NumNonWritableMembers >= NumMembers);
+            break;
+        }
+
+        case spv::OpTypeSampledImage:
+        case spv::OpTypeImage:
+        {
+            auto ImageOffset = Type.DefOffset;
+            if (TypeOpCode == spv::OpTypeSampledImage)
+            {
+                const auto ImageTypeId = m_SPIRV[ImageOffset + 2];
+                ImageOffset = ImageTypeId < m_Ids.size() ? m_Ids[ImageTypeId].DefOffset : 0;
+            }
+            if (ImageOffset != 0 && GetOpCode(m_SPIRV[ImageOffset]) == spv::OpTypeImage && GetWordCount(m_SPIRV[ImageOffset]) >= 4)
+                Res.IsTexelBuffer = static_cast<spv::Dim>(m_SPIRV[ImageOffset + 3]) == spv::DimBuffer;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return Res;
+}
+
+bool SPIRVReflection::HasExtension(const char* Extension) const
+{
+    for (auto Offset = m_ExtensionsStart; Offset < m_ExtensionsEnd; Offset += GetWordCount(m_SPIRV[Offset]))
+    {
+        if (GetOpCode(m_SPIRV[Offset]) == spv::OpExtension && GetWordCount(m_SPIRV[Offset]) >= 2 &&
+            strcmp(reinterpret_cast<const char*>(&m_SPIRV[Offset + 1]), Extension) == 0)
+            return true;
+    }
+    return false;
+}
+
+const char* SPIRVReflection::GetEntryPointName(Uint32 Index) const
+{
+    VERIFY_EXPR(Index < m_EntryPoints.size());
+    return reinterpret_cast<const char*>(&m_SPIRV[m_EntryPoints[Index] + 3]);
+}
+
+SHADER_TYPE SPIRVReflection::GetEntryPointShaderType(Uint32 Index) const
+{
+    VERIFY_EXPR(Index < m_EntryPoints.size());
+    switch (static_cast<spv::ExecutionModel>(m_SPIRV[m_EntryPoints[Index] + 1]))
+    {
+        case spv::ExecutionModelVertex:                 return SHADER_TYPE_VERTEX;
+        case spv::ExecutionModelTessellationControl:    return SHADER_TYPE_HULL;
+        case spv::ExecutionModelTessellationEvaluation: return SHADER_TYPE_DOMAIN;
+        case spv::ExecutionModelGeometry:               return SHADER_TYPE_GEOMETRY;
+        case spv::ExecutionModelFragment:               return SHADER_TYPE_PIXEL;
+        case spv::ExecutionModelGLCompute:              return SHADER_TYPE_COMPUTE;
+        default:                                        return SHADER_TYPE_UNKNOWN;
+    }
+}
+
+void SPIRVReflection::SetEntryPoint(Uint32 Index)
+{
+    VERIFY_EXPR(Index < m_EntryPoints.size());
+    const auto Offset    = m_EntryPoints[Index];
+    const auto End       = Offset + GetWordCount(m_SPIRV[Offset]);
+    const auto NameStart = Offset + 3;
+    m_InterfaceStart = NameStart + GetStringWordCount(m_SPIRV, NameStart, End);
+    m_InterfaceEnd   = End;
+}
+
+bool SPIRVReflection::IsEntryPointInterface(Uint32 Id) const
+{
+    // Before SPIR-V 1.4, only input and output variables are listed in the entry point interface.
+    // Very old versions of glslang did not emit the interface properly, so the same assumption
+    // as in spirv_cross is made: if there is only one entry point, all variables belong to it.
+    static constexpr Uint32 SPIRVVersion14 = 0x10400;
+    if (m_SPIRV[1] < SPIRVVersion14 && m_EntryPoints.size() <= 1)
+        return true;
+
+    VERIFY(m_InterfaceEnd != 0, "Entry point is not selected");
+    for (auto Offset = m_InterfaceStart; Offset < m_InterfaceEnd; ++Offset)
+    {
+        if (m_SPIRV[Offset] == Id)
+            return true;
+    }
+    return false;
+}
+
+Uint32 SPIRVReflection::GetNumResources(RESOURCE_CATEGORY Category) const
+{
+    Uint32 NumResources = 0;
+    for (auto Id = m_FirstResource[Category]; Id != 0; Id = m_Ids[Id].NextResource)
+    {
+        if (Category != RESOURCE_CATEGORY_STAGE_INPUT || IsEntryPointInterface(Id))
+            ++NumResources;
+    }
+    return NumResources;
+}
+
+}
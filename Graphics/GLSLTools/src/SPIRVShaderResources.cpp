@@ -23,54 +23,57 @@
 
 #include <iomanip>
 #include "SPIRVShaderResources.h"
-#include "spirv_parser.hpp"
-#include "spirv_cross.hpp"
+#include "SPIRVReflection.h"
 #include "ShaderBase.h"
 #include "GraphicsAccessories.h"
 #include "StringTools.h"
 #include "Align.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
 
 template<typename Type>
-Type GetResourceArraySize(const spirv_cross::Compiler& Compiler,
-                          const spirv_cross::Resource& Res)
+Type GetResourceArraySize(const SPIRVReflection::ResourceInfo& Res)
 {
-    const auto& type = Compiler.get_type(Res.type_id);
-    uint32_t arrSize = 1;
-    if(!type.array.empty())
-    {
-        // https://github.com/KhronosGroup/SPIRV-Cross/wiki/Reflection-API-user-guide#querying-array-types
-        VERIFY(type.array.size() == 1, "Only one-dimensional arrays are currently supported");
-        arrSize = type.array[0];
-    }
-    VERIFY(arrSize <= std::numeric_limits<Type>::max(), "Array size exceeds maximum representable value ", std::numeric_limits<Type>::max());
-    return static_cast<Type>(arrSize);
+    VERIFY(Res.ArraySize <= std::numeric_limits<Type>::max(), "Array size exceeds maximum representable value ", std::numeric_limits<Type>::max());
+    return static_cast<Type>(Res.ArraySize);
 }
 
-static uint32_t GetDecorationOffset(const spirv_cross::Compiler& Compiler,
-                                    const spirv_cross::Resource& Res,
-                                    spv::Decoration              Decoration)
+static uint32_t GetDecorationOffset(const SPIRVReflection::ResourceInfo& Res, uint32_t Offset)
 {
-    VERIFY(Compiler.has_decoration(Res.id, Decoration), "Resource \'", Res.name, "\' has no requested decoration");
-    uint32_t offset = 0;
-    auto declared = Compiler.get_binary_offset_for_decoration(Res.id, Decoration, offset);
-    VERIFY(declared, "Requested decoration is not declared"); (void)declared;
-    return offset;
+    VERIFY(Offset != 0, "Resource \'", Res.Name, "\' has no requested decoration");
+    return Offset;
+}
+
+SPIRVShaderResourceAttribs::SPIRVShaderResourceAttribs(const SPIRVReflection::ResourceInfo& Res, 
+                                                       const char*                          _Name,
+                                                       ResourceType                         _Type, 
+                                                       Uint32                               _SepSmplrOrImgInd)noexcept :
+    Name                         (_Name),
+    ArraySize                    (GetResourceArraySize<decltype(ArraySize)>(Res)),
+    Type                         (_Type),
+    SepSmplrOrImgInd             (_SepSmplrOrImgInd),
+    BindingDecorationOffset      (GetDecorationOffset(Res, Res.BindingDecorationOffset)),
+    DescriptorSetDecorationOffset(GetDecorationOffset(Res, Res.DescriptorSetDecorationOffset))
+{
+    VERIFY(_SepSmplrOrImgInd == SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd ||
+           (_Type == ResourceType::SeparateSampler || _Type == ResourceType::SeparateImage),
+           "Only separate images or separate samplers can be assinged valid SepSmplrOrImgInd value");
 }
 
-SPIRVShaderResourceAttribs::SPIRVShaderResourceAttribs(const spirv_cross::Compiler&  Compiler,
-                                                       const spirv_cross::Resource&  Res, 
-                                                       const char*                   _Name,
-                                                       ResourceType                  _Type, 
-                                                       Uint32                        _SepSmplrOrImgInd)noexcept :
+SPIRVShaderResourceAttribs::SPIRVShaderResourceAttribs(const char*  _Name,
+                                                       Uint16       _ArraySize,
+                                                       ResourceType _Type,
+                                                       Uint32       _SepSmplrOrImgInd,
+                                                       uint32_t     _BindingDecorationOffset,
+                                                       uint32_t     _DescriptorSetDecorationOffset)noexcept :
     Name                         (_Name),
-    ArraySize                    (GetResourceArraySize<decltype(ArraySize)>(Compiler, Res)),
+    ArraySize                    (_ArraySize),
     Type                         (_Type),
     SepSmplrOrImgInd             (_SepSmplrOrImgInd),
-    BindingDecorationOffset      (GetDecorationOffset(Compiler, Res, spv::Decoration::DecorationBinding)),
-    DescriptorSetDecorationOffset(GetDecorationOffset(Compiler, Res, spv::Decoration::DecorationDescriptorSet))
+    BindingDecorationOffset      (_BindingDecorationOffset),
+    DescriptorSetDecorationOffset(_DescriptorSetDecorationOffset)
 {
     VERIFY(_SepSmplrOrImgInd == SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd ||
            (_Type == ResourceType::SeparateSampler || _Type == ResourceType::SeparateImage),
@@ -137,24 +140,23 @@ ShaderResourceDesc SPIRVShaderResourceAttribs::GetResourceDesc() const
 }
 
 
-static spv::ExecutionModel ShaderTypeToExecutionModel(SHADER_TYPE ShaderType)
+// Returns the name of the uniform or storage block as reported by spirv_cross
+static const char* GetBlockName(const SPIRVReflection::ResourceInfo& Block, String& FallbackName)
 {
-    switch(ShaderType)
-    {
-        case SHADER_TYPE_VERTEX:    return spv::ExecutionModelVertex;
-        case SHADER_TYPE_HULL:      return spv::ExecutionModelTessellationControl;
-        case SHADER_TYPE_DOMAIN:    return spv::ExecutionModelTessellationEvaluation;
-        case SHADER_TYPE_GEOMETRY:  return spv::ExecutionModelGeometry;
-        case SHADER_TYPE_PIXEL:     return spv::ExecutionModelFragment;
-        case SHADER_TYPE_COMPUTE:   return spv::ExecutionModelGLCompute;
+    if (*Block.TypeName != 0)
+        return Block.TypeName;
 
-        default:
-            UNEXPECTED("Unexpected shader type");
-            return spv::ExecutionModelVertex;
-    }
+    if (*Block.Name != 0)
+        return Block.Name;
+
+    FallbackName = "_";
+    FallbackName += std::to_string(Block.TypeId);
+    FallbackName += '_';
+    FallbackName += std::to_string(Block.Id);
+    return FallbackName.c_str();
 }
 
-const std::string& GetUBName(spirv_cross::Compiler& Compiler, const spirv_cross::Resource& UB, const spirv_cross::ParsedIR::Source& IRSource)
+static const char* GetUBName(const SPIRVReflection& Reflection, const SPIRVReflection::ResourceInfo& UB, String& FallbackName)
 {
     // Consider the following HLSL constant buffer:
     //
@@ -165,88 +167,80 @@ const std::string& GetUBName(spirv_cross::Compiler& Compiler, const spirv_cross:
     //
     // glslang emits SPIRV as if the following GLSL was written:
     // 
-    //    uniform Constants // UB.name
+    //    uniform Constants // UB.TypeName
     //    {
     //        float4x4 g_WorldViewProj;
     //    }; // no instance name
     //
     // DXC emits the byte code that corresponds to the following GLSL: 
     // 
-    //    uniform type_Constants // UB.name
+    //    uniform type_Constants // UB.TypeName
     //    {
     //        float4x4 g_WorldViewProj;
-    //    }Constants; // get_name(UB.id)
+    //    }Constants; // UB.Name
     //
     //
     //                            |     glslang      |         DXC
     //  -------------------------------------------------------------------
-    //  UB.name                   |   "Constants"    |   "type_Constants"
-    //  Compiler.get_name(UB.id)  |   ""             |   "Constants"
+    //  UB.TypeName               |   "Constants"    |   "type_Constants"
+    //  UB.Name                   |   ""             |   "Constants"
     //
     // Note that for the byte code produced from GLSL, we must always 
-    // use UB.name even if the instance name is present
+    // use UB.TypeName even if the instance name is present
+
+    if (Reflection.IsHLSLSource() && *UB.Name != 0)
+        return UB.Name;
 
-    const auto& instance_name = Compiler.get_name(UB.id);
-    return (IRSource.hlsl && !instance_name.empty()) ? instance_name : UB.name;
+    return GetBlockName(UB, FallbackName);
 }
 
-SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&      Allocator, 
-                                           IRenderDevice*         pRenderDevice,
-                                           std::vector<uint32_t>  spirv_binary,
-                                           const ShaderDesc&      shaderDesc,
-                                           const char*            CombinedSamplerSuffix,
-                                           bool                   LoadShaderStageInputs,
-                                           std::string&           EntryPoint) :
+SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&            Allocator, 
+                                           IRenderDevice*               pRenderDevice,
+                                           const std::vector<uint32_t>& spirv_binary,
+                                           const ShaderDesc&            shaderDesc,
+                                           const char*                  CombinedSamplerSuffix,
+                                           bool                         LoadShaderStageInputs,
+                                           std::string&                 EntryPoint) :
     m_ShaderType(shaderDesc.ShaderType)
 {
-    // https://github.com/KhronosGroup/SPIRV-Cross/wiki/Reflection-API-user-guide
-	spirv_cross::Parser parser(move(spirv_binary));
-	parser.parse();
-    auto ParsedIRSource = parser.get_parsed_ir().source;
-    spirv_cross::Compiler Compiler(std::move(parser.get_parsed_ir()));
-
-    spv::ExecutionModel ExecutionModel = ShaderTypeToExecutionModel(shaderDesc.ShaderType);
-    auto EntryPoints = Compiler.get_entry_points_and_stages();
-    for (const auto& CurrEntryPoint : EntryPoints)
+    DILIGENT_PROFILE_SCOPE("SPIRVShaderResources::SPIRVShaderResources");
+    // SPIR-V binary is scanned once to collect the resources. Unlike spirv_cross::Compiler,
+    // the reflection does not build the intermediate representation of the whole module.
+    SPIRVReflection Reflection(spirv_binary);
+
+    Uint32 EntryPointIndex = ~0u;
+    for (Uint32 i = 0; i < Reflection.GetNumEntryPoints(); ++i)
     {
-        if (CurrEntryPoint.execution_model == ExecutionModel)
+        if (Reflection.GetEntryPointShaderType(i) != shaderDesc.ShaderType)
+            continue;
+
+        if (!EntryPoint.empty())
         {
-            if (!EntryPoint.empty())
-            {
-                LOG_WARNING_MESSAGE("More than one entry point of type ", GetShaderTypeLiteralName(shaderDesc.ShaderType), " found in SPIRV binary for shader '", shaderDesc.Name, "'. The first one ('", EntryPoint, "') will be used.");
-            }
-            else
-            {
-                EntryPoint = CurrEntryPoint.name;
-            }
+            LOG_WARNING_MESSAGE("More than one entry point of type ", GetShaderTypeLiteralName(shaderDesc.ShaderType), " found in SPIRV binary for shader '", shaderDesc.Name, "'. The first one ('", EntryPoint, "') will be used.");
+        }
+        else
+        {
+            EntryPoint = Reflection.GetEntryPointName(i);
         }
+
+        if (EntryPointIndex == ~0u && EntryPoint == Reflection.GetEntryPointName(i))
+            EntryPointIndex = i;
     }
     if (EntryPoint.empty())
     {
         LOG_ERROR_AND_THROW("Unable to find entry point of type ", GetShaderTypeLiteralName(shaderDesc.ShaderType), " in SPIRV binary for shader '", shaderDesc.Name, "'");
     }
-    Compiler.set_entry_point(EntryPoint, ExecutionModel);
-
-    // The SPIR-V is now parsed, and we can perform reflection on it.
-    spirv_cross::ShaderResources resources = Compiler.get_shader_resources();
-    
-    size_t ResourceNamesPoolSize = 0;
-    for (const auto& ub : resources.uniform_buffers)
-        ResourceNamesPoolSize += GetUBName(Compiler, ub, ParsedIRSource).length() + 1;
-    for (auto* pResType : 
-        {
-            &resources.storage_buffers,
-            &resources.storage_images,
-            &resources.sampled_images,
-            &resources.atomic_counters,
-            &resources.separate_images,
-            &resources.separate_samplers
-        })
+    if (EntryPointIndex == ~0u)
     {
-        for(const auto& res : *pResType)
-            ResourceNamesPoolSize += res.name.length() + 1;
+        LOG_ERROR_AND_THROW("Entry point '", EntryPoint, "' of type ", GetShaderTypeLiteralName(shaderDesc.ShaderType), " is not found in SPIRV binary for shader '", shaderDesc.Name, "'");
     }
+    Reflection.SetEntryPoint(EntryPointIndex);
 
+    // Resource names are shared by many shaders, so they are kept in the global intern pool
+    // rather than in the names pool of every shader
+    auto& InternedNames = StringInternPool::GetGlobalPool();
+
+    size_t ResourceNamesPoolSize = 0;
     if (CombinedSamplerSuffix != nullptr)
     {
         ResourceNamesPoolSize += strlen(CombinedSamplerSuffix) + 1;
@@ -257,34 +251,26 @@ SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&      Allocator,
 
     Uint32 NumShaderStageInputs = 0;
 
-    if (resources.stage_inputs.empty())
+    if (Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_STAGE_INPUT) == 0)
         LoadShaderStageInputs = false;
     if (LoadShaderStageInputs)
     {
-        const auto& Extensions = Compiler.get_declared_extensions();
-        bool HlslFunctionality1 = false;
-        for (const auto& ext : Extensions )
+        if (Reflection.HasExtension("SPV_GOOGLE_hlsl_functionality1"))
         {
-            HlslFunctionality1 = (ext == "SPV_GOOGLE_hlsl_functionality1");
-            if (HlslFunctionality1)
-                break;
-        }
-        
-        if (HlslFunctionality1)
-        {
-            for(const auto& Input : resources.stage_inputs)
-            {
-                if (Compiler.has_decoration(Input.id, spv::Decoration::DecorationHlslSemanticGOOGLE))
+            Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_STAGE_INPUT,
+                [&](const SPIRVReflection::ResourceInfo& Input)
                 {
-                    const auto& Semantic = Compiler.get_decoration_string(Input.id, spv::Decoration::DecorationHlslSemanticGOOGLE);
-                    ResourceNamesPoolSize += Semantic.length()+1;
-                    ++NumShaderStageInputs;
-                }
-                else
-                {
-                    LOG_ERROR_MESSAGE("Shader input '", Input.name, "' does not have DecorationHlslSemanticGOOGLE decoration, which is unexpected as the shader declares SPV_GOOGLE_hlsl_functionality1 extension");
+                    if (Input.Semantic != nullptr)
+                    {
+                        ResourceNamesPoolSize += strlen(Input.Semantic) + 1;
+                        ++NumShaderStageInputs;
+                    }
+                    else
+                    {
+                        LOG_ERROR_MESSAGE("Shader input '", Input.Name, "' does not have DecorationHlslSemanticGOOGLE decoration, which is unexpected as the shader declares SPV_GOOGLE_hlsl_functionality1 extension");
+                    }
                 }
-            }
+            );
         }
         else
         {
@@ -297,157 +283,162 @@ SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&      Allocator,
     }
 
     ResourceCounters ResCounters;
-    ResCounters.NumUBs       = static_cast<Uint32>(resources.uniform_buffers.size());
-    ResCounters.NumSBs       = static_cast<Uint32>(resources.storage_buffers.size());
-    ResCounters.NumImgs      = static_cast<Uint32>(resources.storage_images.size());
-    ResCounters.NumSmpldImgs = static_cast<Uint32>(resources.sampled_images.size());
-    ResCounters.NumACs       = static_cast<Uint32>(resources.atomic_counters.size());
-    ResCounters.NumSepSmplrs = static_cast<Uint32>(resources.separate_samplers.size());
-    ResCounters.NumSepImgs   = static_cast<Uint32>(resources.separate_images.size());
+    ResCounters.NumUBs       = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_UNIFORM_BUFFER);
+    ResCounters.NumSBs       = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_STORAGE_BUFFER);
+    ResCounters.NumImgs      = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_STORAGE_IMAGE);
+    ResCounters.NumSmpldImgs = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_SAMPLED_IMAGE);
+    ResCounters.NumACs       = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_ATOMIC_COUNTER);
+    ResCounters.NumSepSmplrs = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_SAMPLER);
+    ResCounters.NumSepImgs   = Reflection.GetNumResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_IMAGE);
     Initialize(Allocator, ResCounters, NumShaderStageInputs, ResourceNamesPoolSize);
 
+    // Only used for blocks that have no names
+    String FallbackName;
+
     {
         Uint32 CurrUB = 0;
-        for (const auto& UB : resources.uniform_buffers)
-        {
-            const auto& name = GetUBName(Compiler, UB, ParsedIRSource);
-            new (&GetUB(CurrUB++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           UB, 
-                                           m_ResourceNames.CopyString(name), 
-                                           SPIRVShaderResourceAttribs::ResourceType::UniformBuffer);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_UNIFORM_BUFFER,
+            [&](const SPIRVReflection::ResourceInfo& UB)
+            {
+                const auto* name = GetUBName(Reflection, UB, FallbackName);
+                new (&GetUB(CurrUB++))
+                    SPIRVShaderResourceAttribs(UB, 
+                                               InternedNames.Intern(name), 
+                                               SPIRVShaderResourceAttribs::ResourceType::UniformBuffer);
+            }
+        );
         VERIFY_EXPR(CurrUB == GetNumUBs());
     }
 
     {
         Uint32 CurrSB = 0;
-        for (const auto& SB : resources.storage_buffers)
-        {
-            auto BufferFlags = Compiler.get_buffer_block_flags(SB.id);
-            auto IsReadOnly = BufferFlags.get(spv::DecorationNonWritable);
-            auto ResType = IsReadOnly ? 
-                SPIRVShaderResourceAttribs::ResourceType::ROStorageBuffer :
-                SPIRVShaderResourceAttribs::ResourceType::RWStorageBuffer;
-            new (&GetSB(CurrSB++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           SB, 
-                                           m_ResourceNames.CopyString(SB.name),
-                                           ResType);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_STORAGE_BUFFER,
+            [&](const SPIRVReflection::ResourceInfo& SB)
+            {
+                auto ResType = SB.IsReadOnly ? 
+                    SPIRVShaderResourceAttribs::ResourceType::ROStorageBuffer :
+                    SPIRVShaderResourceAttribs::ResourceType::RWStorageBuffer;
+                new (&GetSB(CurrSB++))
+                    SPIRVShaderResourceAttribs(SB, 
+                                               InternedNames.Intern(GetBlockName(SB, FallbackName)),
+                                               ResType);
+            }
+        );
         VERIFY_EXPR(CurrSB == GetNumSBs());
     }
 
     {
         Uint32 CurrSmplImg = 0;
-        for (const auto& SmplImg : resources.sampled_images)
-        {
-            const auto& type = Compiler.get_type(SmplImg.type_id);
-            auto ResType = type.image.dim == spv::DimBuffer ?
-                SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer :
-                SPIRVShaderResourceAttribs::ResourceType::SampledImage;
-            new (&GetSmpldImg(CurrSmplImg++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           SmplImg, 
-                                           m_ResourceNames.CopyString(SmplImg.name), 
-                                           ResType);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_SAMPLED_IMAGE,
+            [&](const SPIRVReflection::ResourceInfo& SmplImg)
+            {
+                auto ResType = SmplImg.IsTexelBuffer ?
+                    SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer :
+                    SPIRVShaderResourceAttribs::ResourceType::SampledImage;
+                new (&GetSmpldImg(CurrSmplImg++))
+                    SPIRVShaderResourceAttribs(SmplImg, 
+                                               InternedNames.Intern(SmplImg.Name), 
+                                               ResType);
+            }
+        );
         VERIFY_EXPR(CurrSmplImg == GetNumSmpldImgs()); 
     }
 
     {
         Uint32 CurrImg = 0;
-        for (const auto& Img : resources.storage_images)
-        {
-            const auto& type = Compiler.get_type(Img.type_id);
-            auto ResType = type.image.dim == spv::DimBuffer ?
-                SPIRVShaderResourceAttribs::ResourceType::StorageTexelBuffer :
-                SPIRVShaderResourceAttribs::ResourceType::StorageImage;
-            new (&GetImg(CurrImg++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           Img, 
-                                           m_ResourceNames.CopyString(Img.name), 
-                                           ResType);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_STORAGE_IMAGE,
+            [&](const SPIRVReflection::ResourceInfo& Img)
+            {
+                auto ResType = Img.IsTexelBuffer ?
+                    SPIRVShaderResourceAttribs::ResourceType::StorageTexelBuffer :
+                    SPIRVShaderResourceAttribs::ResourceType::StorageImage;
+                new (&GetImg(CurrImg++))
+                    SPIRVShaderResourceAttribs(Img, 
+                                               InternedNames.Intern(Img.Name), 
+                                               ResType);
+            }
+        );
         VERIFY_EXPR(CurrImg == GetNumImgs());
     }
 
     {
         Uint32 CurrAC = 0;
-        for (const auto& AC : resources.atomic_counters)
-        {
-            new (&GetAC(CurrAC++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           AC, 
-                                           m_ResourceNames.CopyString(AC.name),
-                                           SPIRVShaderResourceAttribs::ResourceType::AtomicCounter);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_ATOMIC_COUNTER,
+            [&](const SPIRVReflection::ResourceInfo& AC)
+            {
+                new (&GetAC(CurrAC++))
+                    SPIRVShaderResourceAttribs(AC, 
+                                               InternedNames.Intern(AC.Name),
+                                               SPIRVShaderResourceAttribs::ResourceType::AtomicCounter);
+            }
+        );
         VERIFY_EXPR(CurrAC == GetNumACs());
     }
 
     {
         Uint32 CurrSepSmpl = 0;
-        for (const auto& SepSam : resources.separate_samplers)
-        {
-            new (&GetSepSmplr(CurrSepSmpl++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           SepSam, 
-                                           m_ResourceNames.CopyString(SepSam.name),
-                                           SPIRVShaderResourceAttribs::ResourceType::SeparateSampler);
-        }
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_SAMPLER,
+            [&](const SPIRVReflection::ResourceInfo& SepSam)
+            {
+                new (&GetSepSmplr(CurrSepSmpl++))
+                    SPIRVShaderResourceAttribs(SepSam, 
+                                               InternedNames.Intern(SepSam.Name),
+                                               SPIRVShaderResourceAttribs::ResourceType::SeparateSampler);
+            }
+        );
         VERIFY_EXPR(CurrSepSmpl == GetNumSepSmplrs());
     }
 
     {
         Uint32 CurrSepImg = 0;
-        for (const auto& SepImg : resources.separate_images)
-        {
-            const auto& type = Compiler.get_type(SepImg.type_id);
-            auto ResType = type.image.dim == spv::DimBuffer ?
-                SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer :
-                SPIRVShaderResourceAttribs::ResourceType::SeparateImage;
-
-            Uint32 SamplerInd = SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd;
-            if (CombinedSamplerSuffix != nullptr)
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_IMAGE,
+            [&](const SPIRVReflection::ResourceInfo& SepImg)
             {
-                auto NumSepSmpls = GetNumSepSmplrs();
-                for (SamplerInd = 0; SamplerInd < NumSepSmpls; ++SamplerInd)
+                auto ResType = SepImg.IsTexelBuffer ?
+                    SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer :
+                    SPIRVShaderResourceAttribs::ResourceType::SeparateImage;
+
+                Uint32 SamplerInd = SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd;
+                if (CombinedSamplerSuffix != nullptr)
                 {
-                    auto& SepSmplr = GetSepSmplr(SamplerInd);
-                    if (StreqSuff(SepSmplr.Name, SepImg.name.c_str(), CombinedSamplerSuffix))
+                    auto NumSepSmpls = GetNumSepSmplrs();
+                    for (SamplerInd = 0; SamplerInd < NumSepSmpls; ++SamplerInd)
                     {
-                        SepSmplr.AssignSeparateImage(CurrSepImg);
-                        break;
+                        auto& SepSmplr = GetSepSmplr(SamplerInd);
+                        if (StreqSuff(SepSmplr.Name, SepImg.Name, CombinedSamplerSuffix))
+                        {
+                            SepSmplr.AssignSeparateImage(CurrSepImg);
+                            break;
+                        }
                     }
-                }
-                if (SamplerInd == NumSepSmpls)
-                    SamplerInd = SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd;
-                else
-                {
-                    if (ResType == SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer)
-                    {
-                        LOG_WARNING_MESSAGE("Combined image sampler assigned to uniform texel buffer '", SepImg.name, "' will be ignored");
+                    if (SamplerInd == NumSepSmpls)
                         SamplerInd = SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd;
+                    else
+                    {
+                        if (ResType == SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer)
+                        {
+                            LOG_WARNING_MESSAGE("Combined image sampler assigned to uniform texel buffer '", SepImg.Name, "' will be ignored");
+                            SamplerInd = SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd;
+                        }
                     }
                 }
-            }
-            auto* pNewSepImg = new (&GetSepImg(CurrSepImg++))
-                SPIRVShaderResourceAttribs(Compiler, 
-                                           SepImg, 
-                                           m_ResourceNames.CopyString(SepImg.name),
-                                           ResType,
-                                           SamplerInd);
-            if (ResType == SPIRVShaderResourceAttribs::ResourceType::SeparateImage && pNewSepImg->IsValidSepSamplerAssigned())
-            {
+                auto* pNewSepImg = new (&GetSepImg(CurrSepImg++))
+                    SPIRVShaderResourceAttribs(SepImg, 
+                                               InternedNames.Intern(SepImg.Name),
+                                               ResType,
+                                               SamplerInd);
+                if (ResType == SPIRVShaderResourceAttribs::ResourceType::SeparateImage && pNewSepImg->IsValidSepSamplerAssigned())
+                {
 #ifdef DEVELOPMENT
-                const auto& SepSmplr = GetSepSmplr(pNewSepImg->GetAssignedSepSamplerInd());
-                DEV_CHECK_ERR(SepSmplr.ArraySize == 1 || SepSmplr.ArraySize == pNewSepImg->ArraySize,
-                              "Array size (", SepSmplr.ArraySize,") of separate sampler variable '",
-                              SepSmplr.Name, "' must be equal to 1 or be the same as the array size (", pNewSepImg->ArraySize,
-                              ") of separate image variable '", pNewSepImg->Name, "' it is assigned to");
+                    const auto& SepSmplr = GetSepSmplr(pNewSepImg->GetAssignedSepSamplerInd());
+                    DEV_CHECK_ERR(SepSmplr.ArraySize == 1 || SepSmplr.ArraySize == pNewSepImg->ArraySize,
+                                  "Array size (", SepSmplr.ArraySize,") of separate sampler variable '",
+                                  SepSmplr.Name, "' must be equal to 1 or be the same as the array size (", pNewSepImg->ArraySize,
+                                  ") of separate image variable '", pNewSepImg->Name, "' it is assigned to");
 #endif
+                }
             }
-        }
+        );
         VERIFY_EXPR(CurrSepImg == GetNumSepImgs());
     }
     
@@ -461,15 +452,16 @@ SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&      Allocator,
     if (LoadShaderStageInputs)
     {
         Uint32 CurrStageInput = 0;
-        for(const auto& Input : resources.stage_inputs)
-        {
-            if (Compiler.has_decoration(Input.id, spv::Decoration::DecorationHlslSemanticGOOGLE))
+        Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_STAGE_INPUT,
+            [&](const SPIRVReflection::ResourceInfo& Input)
             {
-                const auto& Semantic = Compiler.get_decoration_string(Input.id, spv::Decoration::DecorationHlslSemanticGOOGLE);
-                new (&GetShaderStageInputAttribs(CurrStageInput++))
-                    SPIRVShaderStageInputAttribs(m_ResourceNames.CopyString(Semantic), GetDecorationOffset(Compiler, Input, spv::Decoration::DecorationLocation));
+                if (Input.Semantic != nullptr)
+                {
+                    new (&GetShaderStageInputAttribs(CurrStageInput++))
+                        SPIRVShaderStageInputAttribs(m_ResourceNames.CopyString(Input.Semantic), GetDecorationOffset(Input, Input.LocationDecorationOffset));
+                }
             }
-        }
+        );
         VERIFY_EXPR(CurrStageInput == GetNumShaderStageInputs());
     }
 
@@ -651,8 +643,12 @@ std::string SPIRVShaderResources::DumpResources()
         },
         [&](const SPIRVShaderResourceAttribs& SepImg, Uint32)
         {
-            VERIFY(SepImg.Type == SPIRVShaderResourceAttribs::ResourceType::SeparateImage, "Unexpected resource type");
-            ss << std::endl << std::setw(3) << ResNum << " Separate Img     ";
+            if (SepImg.Type == SPIRVShaderResourceAttribs::ResourceType::SeparateImage)
+                ss << std::endl << std::setw(3) << ResNum << " Separate Img     ";
+            else if (SepImg.Type == SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer)
+                ss << std::endl << std::setw(3) << ResNum << " Uniform Txl Buff ";
+            else
+                UNEXPECTED("Unexpected resource type");
             DumpResource(SepImg);
         }
     );
@@ -662,6 +658,290 @@ std::string SPIRVShaderResources::DumpResources()
 }
 
 
+namespace
+{
+
+// Layout of the serialized data:
+// | Header | Resource attribs | Stage input attribs | String pool |
+// All strings are null-terminated and are referenced by their offsets in the string pool.
+
+struct SerializedHeader
+{
+    static constexpr Uint32 Magic   = 0x52565053; // 'SPVR'
+    static constexpr Uint32 Version = 1;
+
+    Uint32 MagicNumber;
+    Uint32 FormatVersion;
+    Uint32 SPIRVWordCount;
+    Uint32 ShaderType;
+    Uint32 EntryPointOffset;
+    // InvalidStringOffset if combined samplers are not used
+    Uint32 CombinedSamplerSuffixOffset;
+    Uint32 StringPoolSize;
+    Uint16 NumUBs;
+    Uint16 NumSBs;
+    Uint16 NumImgs;
+    Uint16 NumSmpldImgs;
+    Uint16 NumACs;
+    Uint16 NumSepSmplrs;
+    Uint16 NumSepImgs;
+    Uint16 NumShaderStageInputs;
+};
+static_assert(sizeof(SerializedHeader) == 44, "Unexpected size of SerializedHeader struct");
+
+struct SerializedResourceAttribs
+{
+    Uint32 NameOffset;
+    Uint16 ArraySize;
+    Uint8  Type;
+    Uint8  Padding;
+    Uint32 SepSmplrOrImgInd;
+    Uint32 BindingDecorationOffset;
+    Uint32 DescriptorSetDecorationOffset;
+};
+static_assert(sizeof(SerializedResourceAttribs) == 20, "Unexpected size of SerializedResourceAttribs struct");
+
+struct SerializedStageInputAttribs
+{
+    Uint32 SemanticOffset;
+    Uint32 LocationDecorationOffset;
+};
+static_assert(sizeof(SerializedStageInputAttribs) == 8, "Unexpected size of SerializedStageInputAttribs struct");
+
+static constexpr Uint32 InvalidStringOffset = static_cast<Uint32>(-1);
+
+// Returns true if the resource type matches the section of the resource with index n.
+// The sections follow each other in the order defined by the counters.
+bool IsResourceTypeValidForSection(Uint32 n, const SPIRVShaderResources::ResourceCounters& Counters, SPIRVShaderResourceAttribs::ResourceType Type)
+{
+    using ResourceType = SPIRVShaderResourceAttribs::ResourceType;
+
+    if (n < Counters.NumUBs)
+        return Type == ResourceType::UniformBuffer;
+    n -= Counters.NumUBs;
+
+    if (n < Counters.NumSBs)
+        return Type == ResourceType::ROStorageBuffer || Type == ResourceType::RWStorageBuffer;
+    n -= Counters.NumSBs;
+
+    if (n < Counters.NumImgs)
+        return Type == ResourceType::StorageImage || Type == ResourceType::StorageTexelBuffer;
+    n -= Counters.NumImgs;
+
+    if (n < Counters.NumSmpldImgs)
+        return Type == ResourceType::SampledImage || Type == ResourceType::UniformTexelBuffer;
+    n -= Counters.NumSmpldImgs;
+
+    if (n < Counters.NumACs)
+        return Type == ResourceType::AtomicCounter;
+    n -= Counters.NumACs;
+
+    if (n < Counters.NumSepSmplrs)
+        return Type == ResourceType::SeparateSampler;
+    n -= Counters.NumSepSmplrs;
+
+    VERIFY_EXPR(n < Counters.NumSepImgs);
+    return Type == ResourceType::SeparateImage || Type == ResourceType::UniformTexelBuffer;
+}
+
+}
+
+void SPIRVShaderResources::Serialize(const std::string& EntryPoint, size_t SPIRVWordCount, std::vector<Uint8>& Data)const
+{
+    std::vector<char> StringPool;
+    auto AddString = [&StringPool](const char* Str)
+    {
+        auto Offset = static_cast<Uint32>(StringPool.size());
+        StringPool.insert(StringPool.end(), Str, Str + strlen(Str) + 1);
+        return Offset;
+    };
+
+    SerializedHeader Header = {};
+    Header.MagicNumber                 = SerializedHeader::Magic;
+    Header.FormatVersion               = SerializedHeader::Version;
+    Header.SPIRVWordCount              = static_cast<Uint32>(SPIRVWordCount);
+    Header.ShaderType                  = static_cast<Uint32>(m_ShaderType);
+    Header.EntryPointOffset            = AddString(EntryPoint.c_str());
+    Header.CombinedSamplerSuffixOffset = m_CombinedSamplerSuffix != nullptr ? AddString(m_CombinedSamplerSuffix) : InvalidStringOffset;
+    Header.NumUBs                      = static_cast<Uint16>(GetNumUBs());
+    Header.NumSBs                      = static_cast<Uint16>(GetNumSBs());
+    Header.NumImgs                     = static_cast<Uint16>(GetNumImgs());
+    Header.NumSmpldImgs                = static_cast<Uint16>(GetNumSmpldImgs());
+    Header.NumACs                      = static_cast<Uint16>(GetNumACs());
+    Header.NumSepSmplrs                = static_cast<Uint16>(GetNumSepSmplrs());
+    Header.NumSepImgs                  = static_cast<Uint16>(GetNumSepImgs());
+    Header.NumShaderStageInputs        = static_cast<Uint16>(GetNumShaderStageInputs());
+
+    std::vector<SerializedResourceAttribs> Resources(GetTotalResources());
+    ProcessResources(
+        [&](const SPIRVShaderResourceAttribs& Res, Uint32 n)
+        {
+            auto& SerializedRes = Resources[n];
+            SerializedRes.NameOffset                    = AddString(Res.Name);
+            SerializedRes.ArraySize                     = Res.ArraySize;
+            SerializedRes.Type                          = static_cast<Uint8>(Res.Type);
+            SerializedRes.Padding                       = 0;
+            SerializedRes.SepSmplrOrImgInd              = Res.GetSepSmplrOrImgInd();
+            SerializedRes.BindingDecorationOffset       = Res.BindingDecorationOffset;
+            SerializedRes.DescriptorSetDecorationOffset = Res.DescriptorSetDecorationOffset;
+        });
+
+    std::vector<SerializedStageInputAttribs> StageInputs(GetNumShaderStageInputs());
+    for (Uint32 i = 0; i < GetNumShaderStageInputs(); ++i)
+    {
+        const auto& Input = GetShaderStageInputAttribs(i);
+        StageInputs[i].SemanticOffset           = AddString(Input.Semantic);
+        StageInputs[i].LocationDecorationOffset = Input.LocationDecorationOffset;
+    }
+    Header.StringPoolSize = static_cast<Uint32>(StringPool.size());
+
+    const auto ResourcesSize   = Resources.size()   * sizeof(SerializedResourceAttribs);
+    const auto StageInputsSize = StageInputs.size() * sizeof(SerializedStageInputAttribs);
+    Data.resize(sizeof(Header) + ResourcesSize + StageInputsSize + StringPool.size());
+    auto* pDst = Data.data();
+    memcpy(pDst, &Header, sizeof(Header));
+    pDst += sizeof(Header);
+    if (ResourcesSize != 0)
+        memcpy(pDst, Resources.data(), ResourcesSize);
+    pDst += ResourcesSize;
+    if (StageInputsSize != 0)
+        memcpy(pDst, StageInputs.data(), StageInputsSize);
+    pDst += StageInputsSize;
+    memcpy(pDst, StringPool.data(), StringPool.size());
+}
+
+SPIRVShaderResources::SPIRVShaderResources(IMemoryAllocator&            Allocator,
+                                           const std::vector<uint32_t>& spirv_binary,
+                                           const void*                  pSerializedData,
+                                           size_t                       SerializedDataSize,
+                                           const ShaderDesc&            shaderDesc,
+                                           std::string&                 EntryPoint) :
+    m_ShaderType(shaderDesc.ShaderType)
+{
+    VERIFY_EXPR(shaderDesc.Name != nullptr);
+    if (pSerializedData == nullptr || SerializedDataSize < sizeof(SerializedHeader))
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are too small");
+
+    SerializedHeader Header;
+    memcpy(&Header, pSerializedData, sizeof(Header));
+    if (Header.MagicNumber != SerializedHeader::Magic || Header.FormatVersion != SerializedHeader::Version)
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' have invalid or unsupported format");
+
+    if (Header.ShaderType != static_cast<Uint32>(shaderDesc.ShaderType))
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' were created for a shader of different type");
+
+    if (Header.SPIRVWordCount != spirv_binary.size())
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' do not match the SPIRV byte code");
+
+    ResourceCounters ResCounters;
+    ResCounters.NumUBs       = Header.NumUBs;
+    ResCounters.NumSBs       = Header.NumSBs;
+    ResCounters.NumImgs      = Header.NumImgs;
+    ResCounters.NumSmpldImgs = Header.NumSmpldImgs;
+    ResCounters.NumACs       = Header.NumACs;
+    ResCounters.NumSepSmplrs = Header.NumSepSmplrs;
+    ResCounters.NumSepImgs   = Header.NumSepImgs;
+    const size_t TotalResources = size_t{ResCounters.NumUBs} + ResCounters.NumSBs + ResCounters.NumImgs + ResCounters.NumSmpldImgs + 
+                                  ResCounters.NumACs + ResCounters.NumSepSmplrs + ResCounters.NumSepImgs;
+    if (TotalResources > std::numeric_limits<OffsetType>::max())
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: too many resources");
+
+    const size_t ResourcesSize   = TotalResources * sizeof(SerializedResourceAttribs);
+    const size_t StageInputsSize = size_t{Header.NumShaderStageInputs} * sizeof(SerializedStageInputAttribs);
+    if (SerializedDataSize != sizeof(SerializedHeader) + ResourcesSize + StageInputsSize + Header.StringPoolSize)
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: unexpected data size");
+
+    const auto* pResources   = reinterpret_cast<const Uint8*>(pSerializedData) + sizeof(SerializedHeader);
+    const auto* pStageInputs = pResources + ResourcesSize;
+    const auto* pStringPool  = reinterpret_cast<const char*>(pStageInputs + StageInputsSize);
+    if (Header.StringPoolSize == 0 || pStringPool[Header.StringPoolSize - 1] != 0)
+        LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: invalid string pool");
+
+    auto GetString = [&](Uint32 Offset)
+    {
+        if (Offset >= Header.StringPoolSize)
+            LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: string offset is out of range");
+        return pStringPool + Offset;
+    };
+    auto CheckDecorationOffset = [&](Uint32 Offset)
+    {
+        if (Offset == 0 || Offset >= spirv_binary.size())
+            LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: decoration offset is out of range");
+        return Offset;
+    };
+
+    EntryPoint = GetString(Header.EntryPointOffset);
+    const char* CombinedSamplerSuffix = Header.CombinedSamplerSuffixOffset != InvalidStringOffset ? GetString(Header.CombinedSamplerSuffixOffset) : nullptr;
+
+    size_t ResourceNamesPoolSize = strlen(shaderDesc.Name) + 1;
+    if (CombinedSamplerSuffix != nullptr)
+        ResourceNamesPoolSize += strlen(CombinedSamplerSuffix) + 1;
+    for (Uint32 i = 0; i < Header.NumShaderStageInputs; ++i)
+    {
+        SerializedStageInputAttribs Input;
+        memcpy(&Input, pStageInputs + i * sizeof(Input), sizeof(Input));
+        ResourceNamesPoolSize += strlen(GetString(Input.SemanticOffset)) + 1;
+        CheckDecorationOffset(Input.LocationDecorationOffset);
+    }
+
+    // All attributes are validated before the memory is allocated, so that no
+    // partially initialized object is left if an exception is thrown
+    for (Uint32 n = 0; n < TotalResources; ++n)
+    {
+        SerializedResourceAttribs Res;
+        memcpy(&Res, pResources + n * sizeof(Res), sizeof(Res));
+        GetString(Res.NameOffset);
+        CheckDecorationOffset(Res.BindingDecorationOffset);
+        CheckDecorationOffset(Res.DescriptorSetDecorationOffset);
+
+        const auto Type = static_cast<SPIRVShaderResourceAttribs::ResourceType>(Res.Type);
+        if (Res.Type >= SPIRVShaderResourceAttribs::ResourceType::NumResourceTypes ||
+            !(Res.SepSmplrOrImgInd == SPIRVShaderResourceAttribs::InvalidSepSmplrOrImgInd ||
+              (Type == SPIRVShaderResourceAttribs::ResourceType::SeparateImage   && Res.SepSmplrOrImgInd < ResCounters.NumSepSmplrs) ||
+              (Type == SPIRVShaderResourceAttribs::ResourceType::SeparateSampler && Res.SepSmplrOrImgInd < ResCounters.NumSepImgs)))
+            LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: invalid resource attributes");
+
+        // The accessors such as GetUB() and GetSepImg() rely on every resource being in the section of its type
+        if (!IsResourceTypeValidForSection(n, ResCounters, Type))
+            LOG_ERROR_AND_THROW("Serialized resources of shader '", shaderDesc.Name, "' are corrupted: resource ", n, " is in the wrong section for its type");
+    }
+
+    Initialize(Allocator, ResCounters, Header.NumShaderStageInputs, ResourceNamesPoolSize);
+
+    // Resource names are interned in the global pool, so that they can be compared by pointers
+    // with the names of the resources loaded from SPIRV
+    auto& InternedNames = StringInternPool::GetGlobalPool();
+    for (Uint32 n = 0; n < TotalResources; ++n)
+    {
+        SerializedResourceAttribs Res;
+        memcpy(&Res, pResources + n * sizeof(Res), sizeof(Res));
+        new (&GetResource(n))
+            SPIRVShaderResourceAttribs(InternedNames.Intern(pStringPool + Res.NameOffset),
+                                       Res.ArraySize,
+                                       static_cast<SPIRVShaderResourceAttribs::ResourceType>(Res.Type),
+                                       Res.SepSmplrOrImgInd,
+                                       Res.BindingDecorationOffset,
+                                       Res.DescriptorSetDecorationOffset);
+    }
+
+    for (Uint32 i = 0; i < Header.NumShaderStageInputs; ++i)
+    {
+        SerializedStageInputAttribs Input;
+        memcpy(&Input, pStageInputs + i * sizeof(Input), sizeof(Input));
+        new (&GetShaderStageInputAttribs(i))
+            SPIRVShaderStageInputAttribs(m_ResourceNames.CopyString(pStringPool + Input.SemanticOffset), Input.LocationDecorationOffset);
+    }
+
+    if (CombinedSamplerSuffix != nullptr)
+    {
+        m_CombinedSamplerSuffix = m_ResourceNames.CopyString(CombinedSamplerSuffix);
+    }
+    m_ShaderName = m_ResourceNames.CopyString(shaderDesc.Name);
+
+    VERIFY(m_ResourceNames.GetRemainingSize() == 0, "Names pool must be empty");
+}
+
+
 
 bool SPIRVShaderResources::IsCompatibleWith(const SPIRVShaderResources& Resources)const
 {
@@ -25,6 +25,7 @@
 #include <unordered_map>
 #include <memory>
 #include <array>
+#include <mutex>
 
 #if (defined(VK_USE_PLATFORM_IOS_MVK) || defined(VK_USE_PLATFORM_MACOS_MVK))
 #	include <MoltenGLSLToSPIRVConverter/GLSLToSPIRVConverter.h>
@@ -37,6 +38,7 @@
 #include "DebugUtilities.h"
 #include "DataBlobImpl.h"
 #include "RefCntAutoPtr.h"
+#include "CpuProfiler.h"
 
 #include "spirv-tools/optimizer.hpp"
 
@@ -48,14 +50,29 @@ static const char g_HLSLDefinitions[] =
 namespace Diligent
 {
 
+namespace
+{
+
+// glslang process state is shared by all users of the library, e.g. every Vulkan instance
+// and every compiler thread, so it is initialized by the first user and finalized by the last one
+std::mutex g_GlslangMtx;
+Uint32     g_GlslangRefCount = 0;
+
+}
+
 void InitializeGlslang()
 {
-    glslang::InitializeProcess();
+    std::lock_guard<std::mutex> Lock{g_GlslangMtx};
+    if (g_GlslangRefCount++ == 0)
+        glslang::InitializeProcess();
 }
 
 void FinalizeGlslang()
 {
-    glslang::FinalizeProcess();
+    std::lock_guard<std::mutex> Lock{g_GlslangMtx};
+    VERIFY(g_GlslangRefCount > 0, "Unbalanced call to FinalizeGlslang()");
+    if (g_GlslangRefCount > 0 && --g_GlslangRefCount == 0)
+        glslang::FinalizeProcess();
 }
 
 EShLanguage ShaderTypeToShLanguage(SHADER_TYPE ShaderType)
@@ -75,7 +92,7 @@ EShLanguage ShaderTypeToShLanguage(SHADER_TYPE ShaderType)
     }
 }
 
-TBuiltInResource InitResources()
+static TBuiltInResource InitResources()
 {
     TBuiltInResource Resources;
 
@@ -185,6 +202,14 @@ TBuiltInResource InitResources()
     return Resources;
 }
 
+// Resource limits are never modified by glslang, so all compiler threads share one instance.
+// Function-local static is initialized exactly once even if several threads get here simultaneously.
+static const TBuiltInResource& GetBuiltInResources()
+{
+    static const TBuiltInResource Resources = InitResources();
+    return Resources;
+}
+
 class IoMapResolver final : public glslang::TIoMapResolver
 {
 public:
@@ -337,7 +362,7 @@ static std::vector<unsigned int> CompileShaderInternal(glslang::TShader&
                                                        IDataBlob**                 ppCompilerOutput)
 {
     Shader.setAutoMapBindings(true);
-    TBuiltInResource Resources = InitResources();
+    const auto& Resources = GetBuiltInResources();
     auto ParseResult = pIncluder != nullptr ?
         Shader.parse(&Resources, 100, false, messages, *pIncluder) : 
         Shader.parse(&Resources, 100, false, messages);
@@ -428,6 +453,7 @@ private:
 
 std::vector<unsigned int> HLSLtoSPIRV(const ShaderCreateInfo& Attribs, IDataBlob** ppCompilerOutput)
 {
+    DILIGENT_PROFILE_SCOPE("HLSLtoSPIRV");
     EShLanguage ShLang = ShaderTypeToShLanguage(Attribs.Desc.ShaderType);
     glslang::TShader Shader(ShLang);
     EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules | EShMsgReadHlsl | EShMsgHlslLegalization);
@@ -462,10 +488,10 @@ std::vector<unsigned int> HLSLtoSPIRV(const ShaderCreateInfo& Attribs, IDataBlob
         SourceCodeLen = static_cast<int>(pFileData->GetSize());
     }
 
-    std::string Defines;
+    std::string Defines = "#define PUSH_CONSTANTS [[vk::push_constant]]\n";
+    Defines += g_HLSLDefinitions;
     if (Attribs.Macros != nullptr)
     {
-        Defines = g_HLSLDefinitions;
         Defines += '\n';
         auto* pMacro = Attribs.Macros;
         while (pMacro->Name != nullptr && pMacro->Definition != nullptr)
@@ -477,12 +503,8 @@ std::vector<unsigned int> HLSLtoSPIRV(const ShaderCreateInfo& Attribs, IDataBlob
             Defines += "\n";
             ++pMacro;
         }
-        Shader.setPreamble(Defines.c_str());
-    }
-    else
-    {
-        Shader.setPreamble(g_HLSLDefinitions);
     }
+    Shader.setPreamble(Defines.c_str());
     const char* ShaderStrings      [] = {SourceCode};
     const int   ShaderStringLenghts[] = {SourceCodeLen};
     const char* Names              [] = {Attribs.FilePath != nullptr ? Attribs.FilePath : ""};
@@ -507,8 +529,65 @@ std::vector<unsigned int> HLSLtoSPIRV(const ShaderCreateInfo& Attribs, IDataBlob
     }
 }
 
+std::vector<unsigned int> OptimizeSPIRV(const std::vector<unsigned int>& SPIRV, SPIRV_OPTIMIZATION_LEVEL Level, const char* CustomPasses)
+{
+    DILIGENT_PROFILE_SCOPE("OptimizeSPIRV");
+    spvtools::Optimizer SpirvOptimizer(SPV_ENV_VULKAN_1_0);
+    switch (Level)
+    {
+        case SPIRV_OPTIMIZATION_LEVEL_NONE:
+            return SPIRV;
+
+        case SPIRV_OPTIMIZATION_LEVEL_SIZE:
+            SpirvOptimizer.RegisterSizePasses();
+            break;
+
+        case SPIRV_OPTIMIZATION_LEVEL_PERFORMANCE:
+            SpirvOptimizer.RegisterPerformancePasses();
+            break;
+
+        case SPIRV_OPTIMIZATION_LEVEL_CUSTOM:
+        {
+            std::vector<std::string> Flags;
+            const char* c = CustomPasses != nullptr ? CustomPasses : "";
+            while (*c != 0)
+            {
+                while (*c == ' ' || *c == '\t')
+                    ++c;
+                const char* FlagStart = c;
+                while (*c != 0 && *c != ' ' && *c != '\t')
+                    ++c;
+                if (c > FlagStart)
+                    Flags.emplace_back(FlagStart, c);
+            }
+            if (Flags.empty())
+            {
+                LOG_ERROR_MESSAGE("Custom SPIRV optimization level requires a non-empty list of optimizer passes");
+                return {};
+            }
+            if (!SpirvOptimizer.RegisterPassesFromFlags(Flags))
+            {
+                LOG_ERROR_MESSAGE("Failed to register SPIRV optimizer passes '", CustomPasses, "'");
+                return {};
+            }
+            break;
+        }
+
+        default:
+            UNEXPECTED("Unknown SPIRV optimization level");
+            return {};
+    }
+
+    std::vector<uint32_t> OptimizedSPIRV;
+    if (!SpirvOptimizer.Run(SPIRV.data(), SPIRV.size(), &OptimizedSPIRV))
+        OptimizedSPIRV.clear();
+
+    return OptimizedSPIRV;
+}
+
 std::vector<unsigned int> GLSLtoSPIRV(const SHADER_TYPE ShaderType, const char* ShaderSource, int SourceCodeLen, IDataBlob** ppCompilerOutput) 
 {
+    DILIGENT_PROFILE_SCOPE("GLSLtoSPIRV");
     EShLanguage ShLang = ShaderTypeToShLanguage(ShaderType);
     glslang::TShader Shader(ShLang);
     
@@ -228,6 +228,9 @@ const Char* GetMapTypeString(MAP_TYPE MapType);
 /// Returns the string containing the usage
 const Char* GetUsageString(USAGE Usage);
 
+/// Returns the string containing the query type
+const Char* GetQueryTypeString(QUERY_TYPE QueryType);
+
 /// Returns the string containing the texture type
 const Char* GetResourceDimString( RESOURCE_DIMENSION TexType );
 
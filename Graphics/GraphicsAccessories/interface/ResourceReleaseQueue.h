@@ -31,9 +31,12 @@
 
 #include <mutex>
 #include <deque>
+#include <new>
+#include <type_traits>
 
 #include "../../../Primitives/interface/MemoryAllocator.h"
 #include "../../../Common/interface/STDAllocator.h"
+#include "../../../Common/interface/LockFreeBoundedQueue.h"
 #include "../../../Platforms/interface/Atomics.h"
 #include "../../../Platforms/Basic/interface/DebugUtilities.h"
 
@@ -59,12 +62,72 @@ public:
     //  |  AtomicLong          m_RefCounter                |         |______________________________________________|
     //  |__________________________________________________|
     //
+    //
+    // Small resources (such as Vulkan object wrappers) that are referenced by a single queue are
+    // constructed directly in the wrapper's inline storage, so that no heap allocation is performed:
+    //
+    //   ________________________________________________
+    //  |DynamicStaleResourceWrapper                     |
+    //  |                                                |
+    //  |   m_pStaleResource ---                         |
+    //  |    ___________________V__________________      |
+    //  |   |SpecificInlineStaleResource<VkSampler>|     |
+    //  |   |                                      |     |
+    //  |   |  VulkanSamplerWrapper m_SpecificRes..|     |
+    //  |   |______________________________________|     |
+    //  |________________________________________________|
+    //
+
+    /// Size of the inline storage, in bytes, including the virtual table pointer
+    static constexpr size_t InlineStorageSize = 8 * sizeof(void*);
 
     template<typename ResourceType, typename = typename std::enable_if<std::is_object<ResourceType>::value>::type>
     static DynamicStaleResourceWrapper Create(ResourceType&& Resource, Atomics::Long NumReferences)
     {
         VERIFY_EXPR(NumReferences >= 1);
 
+        class SpecificInlineStaleResource final : public StaleResourceBase
+        {
+        public:
+            SpecificInlineStaleResource(ResourceType&& SpecificResource) :
+                m_SpecificResource(std::move(SpecificResource))
+            {}
+
+            SpecificInlineStaleResource             (const SpecificInlineStaleResource&) = delete;
+            SpecificInlineStaleResource             (SpecificInlineStaleResource&&)      = delete;
+            SpecificInlineStaleResource& operator = (const SpecificInlineStaleResource&) = delete;
+            SpecificInlineStaleResource& operator = (SpecificInlineStaleResource&&)      = delete;
+
+            virtual void Release() override final
+            {
+                // The memory is owned by the wrapper
+                this->~SpecificInlineStaleResource();
+            }
+
+            virtual StaleResourceBase* MoveInline(void* pDstStorage) override final
+            {
+                auto* pMovedResource = new(pDstStorage) SpecificInlineStaleResource{std::move(m_SpecificResource)};
+                this->~SpecificInlineStaleResource();
+                return pMovedResource;
+            }
+
+        private:
+            ResourceType m_SpecificResource;
+        };
+
+        // The check is performed at compile time, so that the inline storage is never
+        // instantiated for the types that don't fit into it
+        using CanBeInline = std::integral_constant<bool,
+            sizeof(SpecificInlineStaleResource)  <= InlineStorageSize &&
+            alignof(SpecificInlineStaleResource) <= alignof(InlineStorageType) &&
+            std::is_nothrow_move_constructible<ResourceType>::value>;
+        if (NumReferences == 1)
+        {
+            DynamicStaleResourceWrapper Wrapper{nullptr};
+            if (Wrapper.EmplaceInline<SpecificInlineStaleResource>(std::move(Resource), CanBeInline{}))
+                return Wrapper;
+        }
+
         class SpecificStaleResource final : public StaleResourceBase
         {
         public:
@@ -121,14 +184,24 @@ public:
     }
 
     DynamicStaleResourceWrapper(DynamicStaleResourceWrapper&& rhs) noexcept :
-        m_pStaleResource(std::move(rhs.m_pStaleResource))
+        m_pStaleResource(std::move(rhs.m_pStaleResource)),
+        m_IsInline      (rhs.m_IsInline)
     {
+        if (m_IsInline && m_pStaleResource != nullptr)
+        {
+            // Move the resource from the inline storage of the source wrapper to this wrapper's storage
+            m_pStaleResource = m_pStaleResource->MoveInline(&m_InlineStorage);
+        }
         rhs.m_pStaleResource = nullptr;
+        rhs.m_IsInline       = false;
     }
 
+    // Copies of the wrapper share the same stale resource. Only resources
+    // created with more than one reference may be copied.
     DynamicStaleResourceWrapper (const DynamicStaleResourceWrapper& rhs) noexcept :
         m_pStaleResource(rhs.m_pStaleResource)
     {
+        VERIFY(!rhs.m_IsInline, "Inline resources can't be shared between wrappers");
     }
 
     DynamicStaleResourceWrapper& operator = (const DynamicStaleResourceWrapper&)  = delete;
@@ -136,6 +209,7 @@ public:
 
     void GiveUpOwnership()
     {
+        VERIFY(!m_IsInline, "Inline resources can't be shared between wrappers");
         m_pStaleResource = nullptr;
     }
 
@@ -151,13 +225,39 @@ private:
     public:
         virtual ~StaleResourceBase() = 0;
         virtual void Release() = 0;
+
+        // Moves the resource into the inline storage of another wrapper and destroys this object
+        virtual StaleResourceBase* MoveInline(void* pDstStorage)
+        {
+            UNEXPECTED("Only inline resources can be moved");
+            return nullptr;
+        }
     };
 
     DynamicStaleResourceWrapper(StaleResourceBase *pStaleResource) :
         m_pStaleResource(pStaleResource)
     {}
 
+    template<typename InlineResourceType, typename ResourceType>
+    bool EmplaceInline(ResourceType&& Resource, std::true_type)
+    {
+        m_pStaleResource = new(&m_InlineStorage) InlineResourceType{std::move(Resource)};
+        m_IsInline       = true;
+        return true;
+    }
+
+    template<typename InlineResourceType, typename ResourceType>
+    bool EmplaceInline(ResourceType&&, std::false_type)
+    {
+        // The resource is left untouched
+        return false;
+    }
+
+    using InlineStorageType = std::aligned_storage<InlineStorageSize, alignof(void*)>::type;
+
     StaleResourceBase* m_pStaleResource;
+    bool               m_IsInline = false;
+    InlineStorageType  m_InlineStorage;
 };
 
 inline DynamicStaleResourceWrapper::StaleResourceBase::~StaleResourceBase()
@@ -205,20 +305,30 @@ private:
 ///   the command list
 /// * Resources are removed and actually destroyed from the queue when fence is signaled and the queue is Purged
 ///
+/// Resources may be released from multiple threads simultaneously. To avoid contention, producers first
+/// add resources to lock-free staging queues that are drained into the stale object list and the release
+/// queue by DiscardStaleResources() and Purge(). Producers only fall back to locking the mutex when the
+/// staging queue is full.
+///
 /// \tparam ResourceWrapperType -  Type of the resource wrapper used by the release queue.
 template<typename ResourceWrapperType>
 class ResourceReleaseQueue
 {
 public:
-    ResourceReleaseQueue(IMemoryAllocator& Allocator) : 
-        m_ReleaseQueue  (STD_ALLOCATOR_RAW_MEM(ReleaseQueueElemType, Allocator, "Allocator for deque<ReleaseQueueElemType>")),
-        m_StaleResources(STD_ALLOCATOR_RAW_MEM(ReleaseQueueElemType, Allocator, "Allocator for deque<ReleaseQueueElemType>"))
+    /// Default capacity of the staging queues
+    static constexpr size_t DefaultStagingQueueCapacity = 1024;
+
+    ResourceReleaseQueue(IMemoryAllocator& Allocator, size_t StagingQueueCapacity = DefaultStagingQueueCapacity) : 
+        m_ReleaseQueue        (STD_ALLOCATOR_RAW_MEM(ReleaseQueueElemType, Allocator, "Allocator for deque<ReleaseQueueElemType>")),
+        m_StagedReleaseQueue  (Allocator, StagingQueueCapacity),
+        m_StaleResources      (STD_ALLOCATOR_RAW_MEM(ReleaseQueueElemType, Allocator, "Allocator for deque<ReleaseQueueElemType>")),
+        m_StagedStaleResources(Allocator, StagingQueueCapacity)
     {}
 
     ~ResourceReleaseQueue()
     {
-        DEV_CHECK_ERR(m_StaleResources.empty(), "Not all stale objects were destroyed");
-        DEV_CHECK_ERR(m_ReleaseQueue.empty(), "Release queue is not empty");
+        DEV_CHECK_ERR(m_StaleResources.empty() && m_StagedStaleResources.GetSizeApprox() == 0, "Not all stale objects were destroyed");
+        DEV_CHECK_ERR(m_ReleaseQueue.empty() && m_StagedReleaseQueue.GetSizeApprox() == 0, "Release queue is not empty");
     }
 
     /// Creates a resource wrapper for the specific resource type
@@ -244,8 +354,12 @@ public:
     /// \param [in] NextCommandListNumber - Number of the command list that will be submitted to the queue next
     void SafeReleaseResource(ResourceWrapperType&& Wrapper, Uint64 NextCommandListNumber)
     {
-        std::lock_guard<std::mutex> LockGuard(m_StaleObjectsMutex);
-        m_StaleResources.emplace_back(NextCommandListNumber, std::move(Wrapper));
+        ReleaseQueueElemType Elem{NextCommandListNumber, std::move(Wrapper)};
+        if (!m_StagedStaleResources.TryPush(std::move(Elem)))
+        {
+            std::lock_guard<std::mutex> LockGuard(m_StaleObjectsMutex);
+            m_StaleResources.emplace_back(std::move(Elem));
+        }
     }
 
     /// Moves a copy of the resource wrapper to the stale resources queue
@@ -253,8 +367,7 @@ public:
     /// \param [in] NextCommandListNumber - Number of the command list that will be submitted to the queue next
     void SafeReleaseResource(const ResourceWrapperType& Wrapper, Uint64 NextCommandListNumber)
     {
-        std::lock_guard<std::mutex> LockGuard(m_StaleObjectsMutex);
-        m_StaleResources.emplace_back(NextCommandListNumber, Wrapper);
+        SafeReleaseResource(ResourceWrapperType{Wrapper}, NextCommandListNumber);
     }
 
     /// Adds a resource directly to the release queue
@@ -271,8 +384,12 @@ public:
     /// \param [in] FenceValue  - Fence value indicating when the resource was used last time.
     void DiscardResource(ResourceWrapperType&& Wrapper, Uint64 FenceValue)
     {
-        std::lock_guard<std::mutex> ReleaseQueueLock(m_ReleaseQueueMutex);
-        m_ReleaseQueue.emplace_back(FenceValue, std::move(Wrapper) );
+        ReleaseQueueElemType Elem{FenceValue, std::move(Wrapper)};
+        if (!m_StagedReleaseQueue.TryPush(std::move(Elem)))
+        {
+            std::lock_guard<std::mutex> ReleaseQueueLock(m_ReleaseQueueMutex);
+            m_ReleaseQueue.emplace_back(std::move(Elem));
+        }
     }
 
     /// Adds a copy of the resource wrapper directly to the release queue
@@ -280,8 +397,7 @@ public:
     /// \param [in] FenceValue  - Fence value indicating when the resource was used last time.
     void DiscardResource(const ResourceWrapperType& Wrapper, Uint64 FenceValue)
     {
-        std::lock_guard<std::mutex> ReleaseQueueLock(m_ReleaseQueueMutex);
-        m_ReleaseQueue.emplace_back(FenceValue, Wrapper);
+        DiscardResource(ResourceWrapperType{Wrapper}, FenceValue);
     }
 
     /// Adds multiple resources directly to the release queue
@@ -290,11 +406,10 @@ public:
     template<typename ResourceType, typename IteratorType>
     void DiscardResources(Uint64 FenceValue, IteratorType Iterator)
     {
-        std::lock_guard<std::mutex> ReleaseQueueLock(m_ReleaseQueueMutex);
         ResourceType Resource;
         while(Iterator(Resource))
         {
-            m_ReleaseQueue.emplace_back(FenceValue, CreateWrapper(std::move(Resource), 1) );
+            DiscardResource(CreateWrapper(std::move(Resource), 1), FenceValue);
         }
     }
 
@@ -311,6 +426,7 @@ public:
         // was executed
         std::lock_guard<std::mutex> StaleObjectsLock(m_StaleObjectsMutex);
         std::lock_guard<std::mutex> ReleaseQueueLock(m_ReleaseQueueMutex);
+        DrainStagedResources();
         while (!m_StaleResources.empty() )
         {
             auto &FirstStaleObj = m_StaleResources.front();
@@ -331,6 +447,7 @@ public:
     void Purge(Uint64 CompletedFenceValue)
     {
         std::lock_guard<std::mutex> LockGuard(m_ReleaseQueueMutex);
+        DrainStagedReleaseQueue();
 
         // Release all objects whose associated fence value is at most CompletedFenceValue
         // See http://diligentgraphics.com/diligent-engine/architecture/d3d12/managing-resource-lifetimes/
@@ -347,23 +464,40 @@ public:
     /// Returns the number of stale resources
     size_t GetStaleResourceCount()const
     {
-        return m_StaleResources.size();
+        return m_StaleResources.size() + m_StagedStaleResources.GetSizeApprox();
     }
 
     /// Returns the number of resources pending release
     size_t GetPendingReleaseResourceCount()const
     {
-        return m_ReleaseQueue.size();
+        return m_ReleaseQueue.size() + m_StagedReleaseQueue.GetSizeApprox();
     }
 
 private:
+    using ReleaseQueueElemType = std::pair<Uint64, ResourceWrapperType>;
+
+    // m_ReleaseQueueMutex must be locked
+    void DrainStagedReleaseQueue()
+    {
+        while (m_StagedReleaseQueue.TryPop([this](ReleaseQueueElemType&& Elem){ m_ReleaseQueue.emplace_back(std::move(Elem)); }))
+            ;
+    }
+
+    // Both m_StaleObjectsMutex and m_ReleaseQueueMutex must be locked
+    void DrainStagedResources()
+    {
+        while (m_StagedStaleResources.TryPop([this](ReleaseQueueElemType&& Elem){ m_StaleResources.emplace_back(std::move(Elem)); }))
+            ;
+        DrainStagedReleaseQueue();
+    }
 
     std::mutex m_ReleaseQueueMutex;
-    using ReleaseQueueElemType = std::pair<Uint64, ResourceWrapperType>;
     std::deque< ReleaseQueueElemType, STDAllocatorRawMem<ReleaseQueueElemType> > m_ReleaseQueue;
+    LockFreeBoundedQueue<ReleaseQueueElemType> m_StagedReleaseQueue;
 
     std::mutex m_StaleObjectsMutex;
     std::deque< ReleaseQueueElemType, STDAllocatorRawMem<ReleaseQueueElemType> > m_StaleResources;
+    LockFreeBoundedQueue<ReleaseQueueElemType> m_StagedStaleResources;
 };
 
 }
@@ -338,6 +338,9 @@ namespace Diligent
         OffsetType GetMaxSize() const{return m_MaxSize;}
         OffsetType GetFreeSize()const{return m_FreeSize;}
         OffsetType GetUsedSize()const{return m_MaxSize - m_FreeSize;}
+        // Returns the size of the largest free block
+        OffsetType GetMaxFreeBlockSize()const{return m_FreeBlocksBySize.empty() ? 0 : m_FreeBlocksBySize.rbegin()->first;}
+        size_t     GetNumFreeBlocks()   const{return m_FreeBlocksByOffset.size();}
 
 #ifdef _DEBUG
         size_t DbgGetNumFreeBlocks()const{return m_FreeBlocksByOffset.size();}
@@ -554,6 +554,23 @@ const Char* GetMapTypeString(MAP_TYPE MapType)
     }
 }
 
+const Char* GetQueryTypeString(QUERY_TYPE QueryType)
+{
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch(QueryType)
+    {
+        case QUERY_TYPE_UNDEFINED:           return "QUERY_TYPE_UNDEFINED";
+        case QUERY_TYPE_OCCLUSION:           return "QUERY_TYPE_OCCLUSION";
+        case QUERY_TYPE_TIMESTAMP:           return "QUERY_TYPE_TIMESTAMP";
+        case QUERY_TYPE_PIPELINE_STATISTICS: return "QUERY_TYPE_PIPELINE_STATISTICS";
+        case QUERY_TYPE_DURATION:            return "QUERY_TYPE_DURATION";
+
+        default:
+            UNEXPECTED("Unexpected query type");
+            return "Unknown query type";
+    }
+}
+
 /// Returns the string containing the usage
 const Char* GetUsageString( USAGE Usage )
 {
@@ -27,6 +27,7 @@
 /// Implementation of the Diligent::DeviceContextBase template class and related structures
 
 #include <unordered_map>
+#include <cstring>
 
 #include "DeviceContext.h"
 #include "DeviceObjectBase.h"
@@ -188,6 +189,8 @@ protected:
 
     inline bool SetStencilRef(Uint32 StencilRef, int Dummy);
 
+    inline bool SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size, int Dummy);
+
     inline void SetPipelineState(PipelineStateImplType* pPipelineState, int /*Dummy*/);
 
     /// Clears all cached resources
@@ -253,6 +256,9 @@ protected:
 	/// Curent blend factors
     Float32 m_BlendFactors[4] = { -1, -1, -1, -1 };
 
+    /// Current push constants data
+    Uint8 m_PushConstants[MaxPushConstantsSize] = {};
+
 	/// Current viewports
     Viewport m_Viewports[MaxViewports];
     /// Number of current viewports
@@ -451,6 +457,34 @@ inline bool DeviceContextBase<BaseInterface,ImplementationTraits> :: SetStencilR
     return false;
 }
 
+template<typename BaseInterface, typename ImplementationTraits>
+inline bool DeviceContextBase<BaseInterface,ImplementationTraits> :: SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size, int)
+{
+    if (Size == 0)
+        return false;
+
+    if (pData == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Push constants data must not be null");
+        return false;
+    }
+
+    if ((Offset % 4) != 0 || (Size % 4) != 0)
+    {
+        LOG_ERROR_MESSAGE("Push constants offset (", Offset, ") and size (", Size, ") must be multiples of 4");
+        return false;
+    }
+
+    if (Offset + Size > MaxPushConstantsSize)
+    {
+        LOG_ERROR_MESSAGE("Push constants range [", Offset, ", ", Offset + Size, ") exceeds the maximum push constants size (", MaxPushConstantsSize, ")");
+        return false;
+    }
+
+    memcpy(m_PushConstants + Offset, pData, Size);
+    return true;
+}
+
 template<typename BaseInterface, typename ImplementationTraits>
 inline void DeviceContextBase<BaseInterface,ImplementationTraits> :: 
             SetViewports( Uint32 NumViewports, const Viewport* pViewports, Uint32& RTWidth, Uint32& RTHeight )
@@ -34,7 +34,7 @@
 #include "STDAllocator.h"
 #include "EngineMemory.h"
 #include "GraphicsAccessories.h"
-#include "StringPool.h"
+#include "StringInternPool.h"
 
 namespace Diligent
 {
@@ -66,19 +66,9 @@ public:
         m_NumShaders(0)
     {
         const auto& SrcLayout = PSODesc.ResourceLayout;
-        size_t StringPoolSize = 0;
-        if (SrcLayout.Variables != nullptr)
-        {
-            for (Uint32 i=0; i < SrcLayout.NumVariables; ++i)
-                StringPoolSize += strlen(SrcLayout.Variables[i].Name) + 1;
-        }
-        
-        if (SrcLayout.StaticSamplers != nullptr)
-        {
-            for (Uint32 i=0; i < SrcLayout.NumStaticSamplers; ++i)
-                StringPoolSize += strlen(SrcLayout.StaticSamplers[i].SamplerOrTextureName) + 1;
-        }
-        m_StringPool.Reserve(StringPoolSize, GetRawAllocator());
+        // Variable and sampler names are interned so that they can be compared
+        // with the names of shader resources by pointers
+        auto& InternedNames = StringInternPool::GetGlobalPool();
 
         auto& DstLayout = this->m_Desc.ResourceLayout;
         if (SrcLayout.Variables != nullptr)
@@ -90,7 +80,7 @@ public:
             {
                 VERIFY(SrcLayout.Variables[i].Name != nullptr, "Variable name can't be null");
                 Variables[i] = SrcLayout.Variables[i];
-                Variables[i].Name = m_StringPool.CopyString(SrcLayout.Variables[i].Name);
+                Variables[i].Name = InternedNames.Intern(SrcLayout.Variables[i].Name);
             }
         }
 
@@ -115,12 +105,27 @@ public:
 #endif
 
                 StaticSamplers[i] = SrcLayout.StaticSamplers[i];
-                StaticSamplers[i].SamplerOrTextureName = m_StringPool.CopyString(SrcLayout.StaticSamplers[i].SamplerOrTextureName);
+                StaticSamplers[i].SamplerOrTextureName = InternedNames.Intern(SrcLayout.StaticSamplers[i].SamplerOrTextureName);
             }
         }
-        VERIFY_EXPR(m_StringPool.GetRemainingSize() == 0);
 
 
+        const auto& PushConstants = PSODesc.PushConstants;
+        if (PushConstants.Size != 0)
+        {
+            if (PushConstants.Size > MaxPushConstantsSize)
+                LOG_ERROR_AND_THROW("Push constants size (", PushConstants.Size, ") exceeds the maximum allowed value (", MaxPushConstantsSize, ")");
+            if ((PushConstants.Size % 4) != 0)
+                LOG_ERROR_AND_THROW("Push constants size (", PushConstants.Size, ") must be a multiple of 4");
+            if (PushConstants.Name == nullptr)
+                LOG_ERROR_AND_THROW("Push constants block name can't be null");
+            this->m_Desc.PushConstants.Name = InternedNames.Intern(PushConstants.Name);
+        }
+        else
+        {
+            this->m_Desc.PushConstants.Name = nullptr;
+        }
+
         if (this->m_Desc.IsComputePipeline)
         {
             const auto &ComputePipeline = PSODesc.ComputePipeline;
@@ -350,7 +355,6 @@ protected:
     Uint32 m_NumShaders      = 0;      ///< Number of shaders that this PSO uses
     Uint32* m_pStrides       = nullptr;
 
-    StringPool m_StringPool;
     RefCntAutoPtr<IShader> m_pVS; ///< Strong reference to the vertex shader
     RefCntAutoPtr<IShader> m_pPS; ///< Strong reference to the pixel shader
     RefCntAutoPtr<IShader> m_pGS; ///< Strong reference to the geometry shader
@@ -0,0 +1,179 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Implementation of the Diligent::QueryBase template class
+
+#include "Query.h"
+#include "DeviceObjectBase.h"
+#include "GraphicsTypes.h"
+
+namespace Diligent
+{
+
+/// Template class implementing base functionality for a Query object
+
+/// \tparam BaseInterface - base interface that this class will inheret
+///                         (Diligent::IQueryGL or Diligent::IQueryVk).
+/// \tparam RenderDeviceImplType - type of the render device implementation
+template<class BaseInterface, class RenderDeviceImplType>
+class QueryBase : public DeviceObjectBase<BaseInterface, RenderDeviceImplType, QueryDesc>
+{
+public:
+    enum class QueryState
+    {
+        Inactive,
+        Querying,
+        Ended
+    };
+
+    typedef DeviceObjectBase<BaseInterface, RenderDeviceImplType, QueryDesc> TDeviceObjectBase;
+
+    /// \param pRefCounters      - reference counters object that controls the lifetime of this query.
+    /// \param pDevice           - pointer to the device.
+    /// \param Desc              - query description
+    /// \param bIsDeviceInternal - flag indicating if the Query is an internal device object and 
+    ///                            must not keep a strong reference to the device.
+    QueryBase( IReferenceCounters* pRefCounters, RenderDeviceImplType* pDevice, const QueryDesc& Desc, bool bIsDeviceInternal = false ) :
+        TDeviceObjectBase( pRefCounters, pDevice, Desc, bIsDeviceInternal )
+    {
+        const auto& DeviceCaps = pDevice->GetDeviceCaps();
+        static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+        switch (Desc.Type)
+        {
+            case QUERY_TYPE_OCCLUSION:
+                if (!DeviceCaps.bOcclusionQueriesSupported)
+                    LOG_ERROR_AND_THROW("Occlusion queries are not supported by this device");
+                break;
+
+            case QUERY_TYPE_TIMESTAMP:
+            case QUERY_TYPE_DURATION:
+                if (!DeviceCaps.bTimestampQueriesSupported)
+                    LOG_ERROR_AND_THROW("Timestamp and duration queries are not supported by this device");
+                break;
+
+            case QUERY_TYPE_PIPELINE_STATISTICS:
+                if (!DeviceCaps.bPipelineStatisticsQueriesSupported)
+                    LOG_ERROR_AND_THROW("Pipeline statistics queries are not supported by this device");
+                break;
+
+            default:
+                LOG_ERROR_AND_THROW("Unexpected query type");
+        }
+    }
+
+    ~QueryBase()
+    {
+        if (m_State == QueryState::Querying)
+        {
+            LOG_ERROR_MESSAGE("Destroying query '", this->m_Desc.Name, "' that is in querying state. End the query before releasing it.");
+        }
+    }
+
+    IMPLEMENT_QUERY_INTERFACE_IN_PLACE( IID_Query, TDeviceObjectBase )
+
+    /// Validates and updates the query state when the query is begun by the context
+    bool OnBeginQuery(IDeviceContext* pContext)
+    {
+        if (this->m_Desc.Type == QUERY_TYPE_TIMESTAMP)
+        {
+            LOG_ERROR_MESSAGE("BeginQuery cannot be called on timestamp query '", this->m_Desc.Name, "'. Call EndQuery to set the timestamp.");
+            return false;
+        }
+
+        if (m_State == QueryState::Querying)
+        {
+            LOG_ERROR_MESSAGE("Attempting to begin query '", this->m_Desc.Name, "' twice. A query must be ended before it can be begun again.");
+            return false;
+        }
+
+        m_pContext = pContext;
+        m_State    = QueryState::Querying;
+        return true;
+    }
+
+    /// Validates and updates the query state when the query is ended by the context
+    bool OnEndQuery(IDeviceContext* pContext)
+    {
+        if (this->m_Desc.Type != QUERY_TYPE_TIMESTAMP)
+        {
+            if (m_State != QueryState::Querying)
+            {
+                LOG_ERROR_MESSAGE("Attempting to end query '", this->m_Desc.Name, "' that has not been begun");
+                return false;
+            }
+
+            if (m_pContext != pContext)
+            {
+                LOG_ERROR_MESSAGE("Query '", this->m_Desc.Name, "' has been begun by another context");
+                return false;
+            }
+        }
+
+        m_pContext = nullptr;
+        m_State    = QueryState::Ended;
+        return true;
+    }
+
+    QueryState GetState()const
+    {
+        return m_State;
+    }
+
+protected:
+    /// Validates the arguments of IQuery::GetData(). Returns false if the query has not been ended.
+    bool CheckQueryDataPtr(void* pData, Uint32 DataSize)
+    {
+        if (m_State != QueryState::Ended)
+        {
+            LOG_ERROR_MESSAGE("Requesting data from query '", this->m_Desc.Name, "' that has not been ended");
+            return false;
+        }
+
+        if (pData == nullptr)
+            return true;
+
+        Uint32 ExpectedSize = 0;
+        static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+        switch (this->m_Desc.Type)
+        {
+            case QUERY_TYPE_OCCLUSION:           ExpectedSize = sizeof(QueryDataOcclusion);          break;
+            case QUERY_TYPE_TIMESTAMP:           ExpectedSize = sizeof(QueryDataTimestamp);          break;
+            case QUERY_TYPE_PIPELINE_STATISTICS: ExpectedSize = sizeof(QueryDataPipelineStatistics); break;
+            case QUERY_TYPE_DURATION:            ExpectedSize = sizeof(QueryDataDuration);           break;
+            default: UNEXPECTED("Unexpected query type");
+        }
+        DEV_CHECK_ERR(DataSize == ExpectedSize, "The size of query data (", DataSize, ") is incorrect: ", ExpectedSize, " (aka sizeof(QueryData*)) is expected");
+        DEV_CHECK_ERR(*reinterpret_cast<const QUERY_TYPE*>(pData) == this->m_Desc.Type, "Query data structure type does not match the query type");
+        return DataSize == ExpectedSize;
+    }
+
+    // The context that began the query
+    IDeviceContext* m_pContext = nullptr;
+    QueryState      m_State    = QueryState::Inactive;
+};
+
+}
@@ -39,6 +39,8 @@
 #include "FixedBlockMemoryAllocator.h"
 #include "EngineMemory.h"
 #include "STDAllocator.h"
+#include "JobSystem.h"
+#include "StringInternPool.h"
 
 namespace std
 {
@@ -214,11 +216,16 @@ public:
 
         /// Size of the fence object (FenceD3D12Impl, FenceVkImpl, etc.), in bytes
         const size_t FenceSize;
+
+        /// Size of the query object (QueryGLImpl, QueryVkImpl, etc.), in bytes.
+        /// Zero if the device does not support queries.
+        const size_t QuerySize;
     };
 
     /// \param pRefCounters        - reference counters object that controls the lifetime of this render device
     /// \param RawMemAllocator     - allocator that will be used to allocate memory for all device objects (including render device itself)
     /// \param pEngineFactory      - engine factory that was used to create this device
+    /// \param EngineCI            - engine create info that is used to initialize the job system
     /// \param NumDeferredContexts - number of deferred device contexts 
     /// \param ObjectSizes         - device object sizes
     ///
@@ -227,6 +234,7 @@ public:
     RenderDeviceBase(IReferenceCounters*      pRefCounters,
                      IMemoryAllocator&        RawMemAllocator, 
                      IEngineFactory*          pEngineFactory,
+                     const EngineCreateInfo&  EngineCI,
                      Uint32                   NumDeferredContexts,
                      const DeviceObjectSizes& ObjectSizes) :
         TObjectBase             (pRefCounters),
@@ -245,7 +253,9 @@ public:
         m_PSOAllocator          (RawMemAllocator, ObjectSizes.PSOSize,          128),
         m_SRBAllocator          (RawMemAllocator, ObjectSizes.SRBSize,          1024),
         m_ResMappingAllocator   (RawMemAllocator, sizeof(ResourceMappingImpl),  16),
-        m_FenceAllocator        (RawMemAllocator, ObjectSizes.FenceSize,        16)
+        m_FenceAllocator        (RawMemAllocator, ObjectSizes.FenceSize,        16),
+        m_QueryAllocator        (RawMemAllocator, ObjectSizes.QuerySize,        16),
+        m_JobSystem             (EngineCI.NumWorkerThreads, EngineCI.pThreadPool)
     {
         // Initialize texture format info
         for( Uint32 Fmt = TEX_FORMAT_UNKNOWN; Fmt < TEX_FORMAT_NUM_FORMATS; ++Fmt )
@@ -299,6 +309,14 @@ public:
 
     ~RenderDeviceBase()
     {
+        const auto Stats = StringInternPool::GetGlobalPool().GetStats();
+        if (Stats.NumRequests != 0)
+        {
+            LOG_INFO_MESSAGE("Interned string pool stats:\n"
+                             "                       Distinct strings: ", Stats.NumStrings, " (", Stats.NumRequests, " requests)",
+                             ". Unique/requested size: ", FormatMemorySize(Stats.UniqueSize, 2), " / ", FormatMemorySize(Stats.RequestedSize, 2),
+                             ". Memory saved: ", FormatMemorySize(Stats.RequestedSize - Stats.UniqueSize, 2));
+        }
     }
 
     IMPLEMENT_QUERY_INTERFACE_IN_PLACE( IID_RenderDevice, ObjectBase<BaseInterface> )
@@ -381,6 +399,11 @@ public:
     FixedBlockMemoryAllocator& GetBuffViewObjAllocator(){return m_BuffViewObjAllocator;}
     FixedBlockMemoryAllocator& GetSRBAllocator(){return m_SRBAllocator;}
 
+    /// Returns the job system that is configured by EngineCreateInfo::NumWorkerThreads and
+    /// EngineCreateInfo::pThreadPool. Derived classes that schedule tasks must wait
+    /// for them in their destructors, since their members are destroyed before the job system.
+    JobSystem& GetJobSystem(){return m_JobSystem;}
+
 protected:
     
     virtual void TestTextureFormat(TEXTURE_FORMAT TexFormat) = 0;
@@ -418,6 +441,11 @@ protected:
     FixedBlockMemoryAllocator m_SRBAllocator;            ///< Allocator for shader resource binding objects
     FixedBlockMemoryAllocator m_ResMappingAllocator;     ///< Allocator for resource mapping objects
     FixedBlockMemoryAllocator m_FenceAllocator;          ///< Allocator for fence objects
+    FixedBlockMemoryAllocator m_QueryAllocator;          ///< Allocator for query objects
+
+    /// Job system is declared last so that worker threads are stopped before other members
+    /// of this class are destroyed. Members of derived classes are destroyed earlier.
+    JobSystem                 m_JobSystem;
 };
 
 
@@ -42,6 +42,12 @@ namespace Diligent
         {
         }
 
+        ResMappingHashKey(const Char* InternedStr, HashMapStringKey::InternedStringTag Tag, Uint32 ArrInd):
+            StrKey(InternedStr, Tag),
+            ArrayIndex(ArrInd)
+        {
+        }
+
         ResMappingHashKey(ResMappingHashKey&& rhs) : 
             StrKey(std::move(rhs.StrKey)),
             ArrayIndex(rhs.ArrayIndex)
@@ -63,7 +63,8 @@ inline SHADER_RESOURCE_VARIABLE_TYPE GetShaderVariableType(SHADER_TYPE
     return GetShaderVariableType(ShaderStage, DefaultVariableType, Variables, NumVars, 
         [&](const char* VarName)
         {
-            return strcmp(VarName, Name) == 0;
+            // Interned names are equal only if the pointers are equal
+            return VarName == Name || strcmp(VarName, Name) == 0;
         }
     );
 }
@@ -0,0 +1,73 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Defines Diligent::ShaderSourceFileCache class
+
+#include <mutex>
+#include <unordered_map>
+
+#include "../../../Primitives/interface/DataBlob.h"
+#include "../../../Common/interface/RefCntAutoPtr.h"
+
+namespace Diligent
+{
+
+/// Thread-safe process-wide cache of shader source files
+
+/// Shader source stream factories created by CreateDefaultShaderSourceStreamFactory() read
+/// shader sources and includes through this cache, so HLSL->GLSL converter, GLSL source builder
+/// and glslang includer load every file from disk only once per session. Cached files are 
+/// validated against the file modification time and size every time they are requested,
+/// so modified files are reloaded. Files whose modification time is not available on the
+/// platform (e.g. Android assets) are not cached.
+class ShaderSourceFileCache
+{
+public:
+    static ShaderSourceFileCache& GetInstance();
+
+    /// Returns the contents of the file, or null if the file can't be read.
+    /// The returned data blob is shared and must not be modified.
+    RefCntAutoPtr<IDataBlob> GetFile(const Char* Path);
+
+    /// Releases all cached files
+    void Clear();
+
+private:
+    ShaderSourceFileCache() {}
+
+    struct CachedFile
+    {
+        Uint64                   ModificationTime = 0;
+        Uint64                   Size             = 0;
+        RefCntAutoPtr<IDataBlob> pData;
+    };
+
+    std::mutex                             m_Mtx;
+    std::unordered_map<String, CachedFile> m_Files;
+};
+
+}
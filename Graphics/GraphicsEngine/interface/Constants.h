@@ -37,6 +37,10 @@ namespace Diligent
     /// Maximum number of simultaneous render targets.
     static constexpr Uint32 MaxRenderTargets        = 8;
 
+    /// Maximum size of the push constants block, in bytes.
+    /// Vulkan guarantees that maxPushConstantsSize is at least 128 bytes.
+    static constexpr Uint32 MaxPushConstantsSize    = 128;
+
     /// Maximum number of viewports.
     static constexpr Uint32 MaxViewports            = 16;
 
@@ -117,6 +117,16 @@ namespace Diligent
         /// Indicates if device supports bindless resources
         Bool bBindlessSupported = False;
 
+        /// Indicates if device supports occlusion queries (see Diligent::QUERY_TYPE_OCCLUSION)
+        Bool bOcclusionQueriesSupported = False;
+
+        /// Indicates if device supports timestamp and duration queries 
+        /// (see Diligent::QUERY_TYPE_TIMESTAMP and Diligent::QUERY_TYPE_DURATION)
+        Bool bTimestampQueriesSupported = False;
+
+        /// Indicates if device supports pipeline statistics queries (see Diligent::QUERY_TYPE_PIPELINE_STATISTICS)
+        Bool bPipelineStatisticsQueriesSupported = False;
+
         /// Texture sampling capabilities. See Diligent::SamplerCaps.
         SamplerCaps SamCaps;
 
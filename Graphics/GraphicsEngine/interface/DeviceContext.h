@@ -42,6 +42,7 @@
 #include "BlendState.h"
 #include "PipelineState.h"
 #include "Fence.h"
+#include "Query.h"
 #include "CommandList.h"
 #include "SwapChain.h"
 
@@ -634,6 +635,20 @@ public:
     virtual void SetBlendFactors(const float* pBlendFactors = nullptr) = 0;
 
 
+    /// Sets push constants data.
+
+    /// \param [in] pData  - Pointer to the data to copy to the push constants block.
+    /// \param [in] Offset - Offset in the push constants block, in bytes. Must be a multiple of 4.
+    /// \param [in] Size   - Size of the data, in bytes. Must be a multiple of 4.
+    ///
+    /// \remarks The data is copied into the context and is committed to the pipeline by the next
+    ///          draw or dispatch command, so the method may be called either before or after
+    ///          SetPipelineState(). The values remain valid across pipeline state changes until
+    ///          they are overwritten. Offset + Size must not exceed the push constants size declared
+    ///          in the description of the pipeline state used for drawing (see PushConstantsDesc).
+    virtual void SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size) = 0;
+
+
     /// Binds vertex buffers to the pipeline.
 
     /// \param [in] StartSlot           - The first input slot for binding. The first vertex buffer is 
@@ -931,6 +946,18 @@ public:
     virtual void ExecuteCommandList(ICommandList* pCommandList) = 0;
 
 
+    /// Executes recorded commands in multiple command lists.
+
+    /// \param [in] NumCommandLists - Number of command lists to execute.
+    /// \param [in] ppCommandLists  - Pointer to the array of NumCommandLists command lists to execute.
+    /// \remarks The command lists are executed in the order they appear in the array.
+    ///          In Vulkan backend, all command lists are submitted to the queue with a single submit 
+    ///          operation that signals one fence value, which is considerably more efficient than executing
+    ///          the lists one by one. Other backends execute the command lists one by one.
+    ///          After command lists are executed, they are no longer valid and should be released.
+    virtual void ExecuteCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists) = 0;
+
+
     /// Tells the GPU to set a fence to a specified value after all previous work has completed.
 
     /// \note The method does not flush the context (an application can do this explcitly if needed)
@@ -966,6 +993,32 @@ public:
     virtual void WaitForFence(IFence* pFence, Uint64 Value, bool FlushContext) = 0;
 
 
+    /// Begins a query.
+
+    /// \param [in] pQuery - A pointer to a query object.
+    ///
+    /// \remarks   Only immediate contexts support queries.\n
+    ///            Timestamp queries must not be begun. For other query types, the query must
+    ///            be ended by IDeviceContext::EndQuery() before it is begun again.
+    ///            Only one query of every type may be active at a time.\n
+    ///            A query that is begun inside a render pass must be ended before the render targets
+    ///            are changed or any command that ends the render pass is executed. A query that is
+    ///            begun outside of a render pass may span multiple render passes; in Vulkan backend,
+    ///            ending such query ends the current render pass.
+    virtual void BeginQuery(IQuery* pQuery) = 0;
+
+
+    /// Ends a query.
+
+    /// \param [in] pQuery - A pointer to a query object.
+    ///
+    /// \remarks   For timestamp queries, the method writes the GPU timestamp to the query.
+    ///            For other query types, the query must have been begun by IDeviceContext::BeginQuery()
+    ///            on the same context.\n
+    ///            Use IQuery::GetData() to retrieve the query data once the GPU has executed the commands.
+    virtual void EndQuery(IQuery* pQuery) = 0;
+
+
     /// Submits all outstanding commands for execution to the GPU and waits until they are complete.
 
     /// \note The method blocks the execution of the calling thread until the wait is complete.
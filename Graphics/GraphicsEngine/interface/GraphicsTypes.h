@@ -1269,6 +1269,36 @@ namespace Diligent
         DisplayModeAttribs::SCANLINE_ORDER ScanlineOrder = DisplayModeAttribs::SCANLINE_ORDER_UNSPECIFIED;
     };
 
+    /// Query type
+
+    /// This enumeration is used by QueryDesc structure to define the type of the query object
+    enum QUERY_TYPE : Uint8
+    {
+        /// Query type is undefined
+        QUERY_TYPE_UNDEFINED = 0,
+
+        /// Gets the number of samples that passed the depth and stencil tests between
+        /// IDeviceContext::BeginQuery() and IDeviceContext::EndQuery(). 
+        /// The result is returned in QueryDataOcclusion structure.
+        QUERY_TYPE_OCCLUSION,
+
+        /// Gets the GPU timestamp corresponding to IDeviceContext::EndQuery() call.
+        /// Timestamp queries must not be begun. The result is returned in QueryDataTimestamp structure.
+        QUERY_TYPE_TIMESTAMP,
+
+        /// Gets pipeline statistics, such as the number of shader invocations, between
+        /// IDeviceContext::BeginQuery() and IDeviceContext::EndQuery().
+        /// The result is returned in QueryDataPipelineStatistics structure.
+        QUERY_TYPE_PIPELINE_STATISTICS,
+
+        /// Gets the GPU time elapsed between IDeviceContext::BeginQuery() and IDeviceContext::EndQuery().
+        /// The result is returned in QueryDataDuration structure.
+        QUERY_TYPE_DURATION,
+
+        /// Helper value that stores the total number of query types in the enumeration
+        QUERY_TYPE_NUM_TYPES
+    };
+
     /// Engine creation attibutes
     struct EngineCreateInfo
     {
@@ -1285,6 +1315,18 @@ namespace Diligent
         /// IEngineFactoryD3D12::CreateDeviceAndContextsD3D12, and IEngineFactoryVk::CreateDeviceAndContextsVk)
         /// starting at position 1.
         Uint32                   NumDeferredContexts  = 0;
+
+        /// Number of worker threads of the job system that the render device creates for
+        /// engine-internal parallel work. If zero, the jobs are executed by the calling thread.
+        /// This member is ignored if pThreadPool is not null.
+        /// \note No engine operation currently schedules jobs, so the worker threads remain
+        ///       idle. Shader compilation and reflection run on the thread that creates the object.
+        Uint32                   NumWorkerThreads     = 0;
+
+        /// Optional pointer to the application-provided thread pool. If not null, the engine
+        /// does not create its own worker threads and executes its internal jobs in this pool.
+        /// The pool must outlive the render device.
+        class IThreadPool*       pThreadPool          = nullptr;
     };
 
 
@@ -1481,6 +1523,8 @@ namespace Diligent
             bool vertexPipelineStoresAndAtomics    = false;
             bool fragmentStoresAndAtomics          = false;
             bool shaderStorageImageExtendedFormats = false;
+            bool occlusionQueryPrecise             = false;
+            bool pipelineStatisticsQuery           = false;
         }EnabledFeatures;
 
         /// Descriptor pool size
@@ -1551,6 +1595,20 @@ namespace Diligent
         /// pages when resources are released
         Uint32 HostVisibleMemoryReserveSize = 256 << 20;
 
+        /// Resources that require at least this amount of memory are allocated in
+        /// dedicated device memory objects rather than suballocated from memory pages.
+        /// If VK_KHR_dedicated_allocation extension is supported, the memory is bound
+        /// to the resource through the extension. 0 disables dedicated allocations.
+        Uint32 DedicatedMemoryAllocationThreshold = 8 << 20;
+
+        /// Memory budget of every device-local heap that is used when VK_EXT_memory_budget extension
+        /// is not supported. 0 sets the budget to 80% of the heap size. The budget never exceeds the heap size.
+        Uint64 DeviceLocalMemoryBudget = 0;
+
+        /// Memory budget of every heap that is not device-local (system memory) that is used when 
+        /// VK_EXT_memory_budget extension is not supported. 0 sets the budget to 50% of the heap size.
+        Uint64 HostMemoryBudget = 0;
+
         /// Page size of the upload heap that is allocated by immediate/deferred
         /// contexts from the global memory manager to perform lock-free dynamic
         /// suballocations.
@@ -1564,6 +1622,11 @@ namespace Diligent
         /// Size of the memory chunk suballocated by immediate/deferred context from
         /// the global dynamic heap to perform lock-free dynamic suballocations
         Uint32 DynamicHeapPageSize = 256 << 10;
+
+        /// The number of queries of every type in the query pools. Duration queries
+        /// use two timestamp queries of the QUERY_TYPE_DURATION pool.
+        //                                             Undef  Occlusion  Timestamp  PipelineStats  Duration
+        Uint32 QueryPoolSizes[QUERY_TYPE_NUM_TYPES] = {    0,       128,       512,            64,      512};
     };
 
 
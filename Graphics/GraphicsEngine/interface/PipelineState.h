@@ -206,6 +206,28 @@ struct ComputePipelineDesc
     IShader* pCS = nullptr;
 };
 
+/// Push constants description
+
+/// Push constants are a small block of data that is set directly through the device context
+/// (see IDeviceContext::SetPushConstants()) and is visible to all shader stages of the pipeline.
+/// In Vulkan the block maps to push constants, in OpenGL it is emulated with a uniform buffer
+/// that the context sub-allocates from a ring buffer.
+struct PushConstantsDesc
+{
+    /// Name of the uniform block that the shaders use to access push constants.
+    /// The block must be declared with PUSH_CONSTANTS qualifier, for example:
+    ///
+    ///     PUSH_CONSTANTS uniform cbPushConstants { float4 g_Color; };
+    ///
+    /// The name is only used by OpenGL backend to identify the block.
+    const Char* Name = nullptr;
+
+    /// Size of the push constants block, in bytes. Must be a multiple of 4 and
+    /// must not exceed MaxPushConstantsSize. Zero size indicates that the pipeline
+    /// does not use push constants.
+    Uint32 Size      = 0;
+};
+
 /// Pipeline state description
 struct PipelineStateDesc : DeviceObjectAttribs
 {
@@ -224,6 +246,9 @@ struct PipelineStateDesc : DeviceObjectAttribs
     /// Pipeline layout description
     PipelineResourceLayoutDesc ResourceLayout;
 
+    /// Push constants description
+    PushConstantsDesc PushConstants;
+
     /// Graphics pipeline state description. This memeber is ignored if IsComputePipeline == True
     GraphicsPipelineDesc GraphicsPipeline;
 
@@ -0,0 +1,165 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Defines Diligent::IQuery interface and related data structures
+
+#include "DeviceObject.h"
+
+namespace Diligent
+{
+
+// {70F2A88A-F8BE-4901-8F05-2F72FA695BA0}
+static constexpr INTERFACE_ID IID_Query =
+{ 0x70f2a88a, 0xf8be, 0x4901, { 0x8f, 0x5, 0x2f, 0x72, 0xfa, 0x69, 0x5b, 0xa0 } };
+
+/// Occlusion query data.
+/// This structure is filled by IQuery::GetData() for Diligent::QUERY_TYPE_OCCLUSION query type.
+struct QueryDataOcclusion
+{
+    /// Query type - must be Diligent::QUERY_TYPE_OCCLUSION
+    const QUERY_TYPE Type = QUERY_TYPE_OCCLUSION;
+
+    /// The number of samples that passed the depth and stencil tests in between
+    /// IDeviceContext::BeginQuery and IDeviceContext::EndQuery.
+    Uint64 NumSamples = 0;
+};
+
+/// Timestamp query data.
+/// This structure is filled by IQuery::GetData() for Diligent::QUERY_TYPE_TIMESTAMP query type.
+struct QueryDataTimestamp
+{
+    /// Query type - must be Diligent::QUERY_TYPE_TIMESTAMP
+    const QUERY_TYPE Type = QUERY_TYPE_TIMESTAMP;
+
+    /// The value of a high-frequency counter.
+    Uint64 Counter   = 0;
+
+    /// The counter frequency, in Hz (ticks/second).
+    Uint64 Frequency = 0;
+};
+
+/// Pipeline statistics query data.
+/// This structure is filled by IQuery::GetData() for Diligent::QUERY_TYPE_PIPELINE_STATISTICS query type.
+struct QueryDataPipelineStatistics
+{
+    /// Query type - must be Diligent::QUERY_TYPE_PIPELINE_STATISTICS
+    const QUERY_TYPE Type = QUERY_TYPE_PIPELINE_STATISTICS;
+
+    /// Number of vertices processed by the input assembler stage.
+    Uint64 InputVertices       = 0;
+
+    /// Number of primitives processed by the input assembler stage.
+    Uint64 InputPrimitives     = 0;
+
+    /// Number of primitives output by a geometry shader.
+    Uint64 GSPrimitives        = 0;
+
+    /// Number of primitives that were sent to the clipping stage.
+    Uint64 ClippingInvocations = 0;
+
+    /// Number of primitives that were output by the clipping stage and were rendered.
+    /// This may be larger or smaller than ClippingInvocations because after a primitive is
+    /// clipped sometimes it is either broken up into more than one primitive or completely culled.
+    Uint64 ClippingPrimitives  = 0;
+
+    /// Number of times a vertex shader was invoked.
+    Uint64 VSInvocations       = 0;
+
+    /// Number of times a geometry shader was invoked.
+    Uint64 GSInvocations       = 0;
+
+    /// Number of times a pixel shader shader was invoked.
+    Uint64 PSInvocations       = 0;
+
+    /// Number of times a hull shader shader was invoked.
+    Uint64 HSInvocations       = 0;
+
+    /// Number of times a domain shader shader was invoked.
+    Uint64 DSInvocations       = 0;
+
+    /// Number of times a compute shader was invoked.
+    Uint64 CSInvocations       = 0;
+};
+
+/// Duration query data.
+/// This structure is filled by IQuery::GetData() for Diligent::QUERY_TYPE_DURATION query type.
+struct QueryDataDuration
+{
+    /// Query type - must be Diligent::QUERY_TYPE_DURATION
+    const QUERY_TYPE Type = QUERY_TYPE_DURATION;
+
+    /// The number of high-frequency counter ticks between 
+    /// BeginQuery and EndQuery calls.
+    Uint64 Duration  = 0;
+
+    /// The counter frequency, in Hz (ticks/second).
+    Uint64 Frequency = 0;
+};
+
+/// Query description.
+struct QueryDesc : DeviceObjectAttribs
+{
+    /// Query type, see Diligent::QUERY_TYPE.
+    QUERY_TYPE Type = QUERY_TYPE_UNDEFINED;
+};
+
+/// Query interface.
+
+/// Defines the methods to manipulate a Query object
+///
+/// \remarks A query is started by IDeviceContext::BeginQuery() and ended by IDeviceContext::EndQuery().
+///          Timestamp queries are only ended. The data is available when the GPU has finished executing
+///          the commands recorded between the two calls, which typically happens several frames later. 
+///          A query can be begun again before its data has been read, in which case the previous
+///          results are lost.
+class IQuery : public IDeviceObject
+{
+public:
+    /// Queries the specific interface, see IObject::QueryInterface() for details
+    virtual void QueryInterface(const INTERFACE_ID& IID, IObject** ppInterface)override = 0;
+
+    /// Returns the Query description used to create the object
+    virtual const QueryDesc& GetDesc()const override = 0;
+
+    /// Gets the query data.
+
+    /// \param [in] pData    - pointer to the query data structure. Depending on the type of the query,
+    ///                        this must be a pointer to QueryDataOcclusion, QueryDataTimestamp,
+    ///                        QueryDataPipelineStatistics, or QueryDataDuration structure.
+    ///                        An application may provide nullptr to only check the query status.
+    /// \param [in] DataSize - size of the data structure.
+    ///
+    /// \return     true if the query data is available and false otherwise.
+    ///
+    /// \remarks    The method never blocks and never flushes the context. The data becomes available 
+    ///             only after the commands that end the query have been submitted to the GPU
+    ///             (see IDeviceContext::Flush()) and executed.
+    ///             The method must be called from the thread that uses the immediate context.
+    virtual bool GetData(void* pData, Uint32 DataSize) = 0;
+};
+
+}
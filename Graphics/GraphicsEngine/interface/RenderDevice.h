@@ -41,6 +41,7 @@
 #include "BufferView.h"
 #include "PipelineState.h"
 #include "Fence.h"
+#include "Query.h"
 
 #include "DepthStencilState.h"
 #include "RasterizerState.h"
@@ -160,6 +161,19 @@ public:
                               IFence**         ppFence) = 0;
 
 
+    /// Creates a new query object
+
+    /// \param [in]  Desc    - Query description, see Diligent::QueryDesc for details.
+    /// \param [out] ppQuery - Address of the memory location where the pointer to the
+    ///                        query interface will be stored. 
+    ///                        The function calls AddRef(), so that the new object will contain 
+    ///                        one reference.
+    ///
+    /// \remarks Supported query types are reported by the device capabilities (see Diligent::DeviceCaps).
+    virtual void CreateQuery( const QueryDesc& Desc, 
+                              IQuery**         ppQuery) = 0;
+
+
     /// Gets the device capabilities, see Diligent::DeviceCaps for details
     virtual const DeviceCaps& GetDeviceCaps()const = 0;
 
@@ -63,6 +63,22 @@ enum SHADER_SOURCE_LANGUAGE : Uint32
     SHADER_SOURCE_LANGUAGE_GLSL
 };
 
+/// Describes the SPIRV optimization level applied when a shader is compiled for Vulkan
+enum SPIRV_OPTIMIZATION_LEVEL : Uint8
+{
+    /// SPIRV generated by the compiler is used as is
+    SPIRV_OPTIMIZATION_LEVEL_NONE = 0,
+
+    /// SPIRV is optimized for size (spirv-opt -Os)
+    SPIRV_OPTIMIZATION_LEVEL_SIZE,
+
+    /// SPIRV is optimized for performance (spirv-opt -O)
+    SPIRV_OPTIMIZATION_LEVEL_PERFORMANCE,
+
+    /// SPIRV is optimized by the passes listed in ShaderCreateInfo::SPIRVOptimizationPasses
+    SPIRV_OPTIMIZATION_LEVEL_CUSTOM
+};
+
 /// Shader description
 struct ShaderDesc : DeviceObjectAttribs
 {
@@ -143,6 +159,17 @@ struct ShaderCreateInfo
     /// Byte code size (in bytes) must be provided if ByteCode is not null
     size_t ByteCodeSize = 0;
 
+    /// Serialized shader resources produced by IShaderVk::SerializeResources()
+
+    /// If the data is provided together with ByteCode, the engine loads shader resources
+    /// from the data and does not reflect the byte code.
+    /// \note This option is only supported by Vulkan backend and is ignored by other backends.
+    ///       The data must have been serialized for exactly the same SPIRV byte code.
+    const void* SerializedResources = nullptr;
+
+    /// Size of the serialized shader resources data, in bytes
+    size_t SerializedResourcesSize = 0;
+
 	/// Shader entry point
 
     /// This member is ignored if ByteCode is not null
@@ -209,6 +236,20 @@ struct ShaderCreateInfo
     /// supported by the device.
     ShaderVersion GLESSLVersion = ShaderVersion{};
 
+    /// SPIRV optimization level, see Diligent::SPIRV_OPTIMIZATION_LEVEL.
+
+    /// The optimizer runs after the shader has been compiled and before resources are reflected, so
+    /// IShaderVk::GetSPIRV() and IShaderVk::SerializeResources() return the optimized byte code and 
+    /// matching resources that can be stored and later used to create the shader through ByteCode member.
+    /// \note This member is only used by Vulkan backend when the shader is compiled from source.
+    ///       It is ignored if ByteCode is not null.
+    SPIRV_OPTIMIZATION_LEVEL SPIRVOptimization = SPIRV_OPTIMIZATION_LEVEL_NONE;
+
+    /// Space-separated list of spirv-opt command line flags, e.g. "--eliminate-dead-code-aggressive --merge-blocks",
+    /// that define the passes to run when SPIRVOptimization is SPIRV_OPTIMIZATION_LEVEL_CUSTOM.
+    /// The member is ignored for other optimization levels.
+    const Char* SPIRVOptimizationPasses = nullptr;
+
 
     /// Memory address where pointer to the compiler messages data blob will be written
 
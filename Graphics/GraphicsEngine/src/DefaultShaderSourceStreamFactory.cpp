@@ -26,6 +26,8 @@
 #include "ObjectBase.h"
 #include "RefCntAutoPtr.h"
 #include "EngineMemory.h"
+#include "MemoryFileStream.h"
+#include "ShaderSourceFileCache.h"
 
 namespace Diligent
 {
@@ -73,27 +75,20 @@ DefaultShaderSourceStreamFactory::DefaultShaderSourceStreamFactory(IReferenceCou
 
 void DefaultShaderSourceStreamFactory::CreateInputStream( const Diligent::Char *Name, IFileStream **ppStream )
 {
-    bool bFileCreated = false;
-    Diligent::RefCntAutoPtr<BasicFileStream> pBasicFileStream;
+    // Files are read through the shared cache, so that the same source files and includes
+    // are not loaded from disk again when other shaders are created
+    RefCntAutoPtr<IDataBlob> pFileData;
     for (const auto &SearchDir : m_SearchDirectories)
     {
         String FullPath = SearchDir + ( (Name[0] == '\\' || Name[0] == '/') ? Name + 1 : Name);
-        if (!FileSystem::FileExists(FullPath.c_str()))
-            continue;
-        pBasicFileStream = MakeNewRCObj<BasicFileStream>()( FullPath.c_str(), EFileAccessMode::Read );
-        if (pBasicFileStream->IsValid())
-        {
-            bFileCreated = true;
+        pFileData = ShaderSourceFileCache::GetInstance().GetFile(FullPath.c_str());
+        if (pFileData)
             break;
-        }
-        else
-        {
-            pBasicFileStream.Release();
-        }
     }
-    if (bFileCreated)
+    if (pFileData)
     {
-        pBasicFileStream->QueryInterface( IID_FileStream, reinterpret_cast<IObject**>(ppStream) );
+        RefCntAutoPtr<MemoryFileStream> pMemStream( MakeNewRCObj<MemoryFileStream>()(pFileData) );
+        pMemStream->QueryInterface( IID_FileStream, reinterpret_cast<IObject**>(ppStream) );
     }
     else
     {
@@ -24,6 +24,7 @@
 #include "pch.h"
 #include "ResourceMappingImpl.h"
 #include "DeviceObjectBase.h"
+#include "StringInternPool.h"
 
 using namespace std;
 
@@ -45,6 +46,10 @@ namespace Diligent
         if( Name == nullptr || *Name == 0 )
             return;
 
+        // Resource names are shared with shader resources, so instead of making
+        // a copy of the string for every mapping, use the interned one
+        const auto* InternedName = StringInternPool::GetGlobalPool().Intern(Name);
+
         auto LockHelper = Lock();
         for(Uint32 Elem = 0; Elem < NumElements; ++Elem)
         {
@@ -53,7 +58,7 @@ namespace Diligent
             // Try to construct new element in place
             auto Elems = 
                 m_HashTable.emplace( 
-                                    make_pair( Diligent::ResMappingHashKey(Name, true, StartIndex+Elem), // Make a copy of the source string
+                                    make_pair( Diligent::ResMappingHashKey(InternedName, HashMapStringKey::InternedStringTag{}, StartIndex+Elem),
                                                Diligent::RefCntAutoPtr<IDeviceObject>(pObject) 
                                               ) 
                                     );
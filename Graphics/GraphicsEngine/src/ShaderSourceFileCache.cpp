@@ -0,0 +1,90 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+#include "ShaderSourceFileCache.h"
+#include "FileSystem.h"
+#include "BasicFileStream.h"
+#include "DataBlobImpl.h"
+
+namespace Diligent
+{
+
+ShaderSourceFileCache& ShaderSourceFileCache::GetInstance()
+{
+    static ShaderSourceFileCache TheCache;
+    return TheCache;
+}
+
+static RefCntAutoPtr<IDataBlob> ReadFile(const Char* Path)
+{
+    RefCntAutoPtr<BasicFileStream> pFileStream( MakeNewRCObj<BasicFileStream>()(Path, EFileAccessMode::Read) );
+    if (!pFileStream->IsValid())
+        return RefCntAutoPtr<IDataBlob>();
+
+    RefCntAutoPtr<IDataBlob> pFileData( MakeNewRCObj<DataBlobImpl>()(0) );
+    pFileStream->Read(pFileData);
+    return pFileData;
+}
+
+RefCntAutoPtr<IDataBlob> ShaderSourceFileCache::GetFile(const Char* Path)
+{
+    Uint64 ModificationTime = 0;
+    Uint64 Size             = 0;
+    if (!FileSystem::GetFileStamp(Path, ModificationTime, Size))
+    {
+        // The stamp is not available, so the file can't be validated and is not cached
+        if (!FileSystem::FileExists(Path))
+            return RefCntAutoPtr<IDataBlob>();
+        return ReadFile(Path);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mtx);
+        auto it = m_Files.find(Path);
+        if (it != m_Files.end() && it->second.ModificationTime == ModificationTime && it->second.Size == Size)
+            return it->second.pData;
+    }
+
+    // Read the file without holding the lock. If several threads read the
+    // same file simultaneously, the last one replaces the cached data.
+    auto pFileData = ReadFile(Path);
+    if (pFileData)
+    {
+        std::lock_guard<std::mutex> Lock(m_Mtx);
+        auto& File = m_Files[Path];
+        File.ModificationTime = ModificationTime;
+        File.Size             = Size;
+        File.pData            = pFileData;
+    }
+    return pFileData;
+}
+
+void ShaderSourceFileCache::Clear()
+{
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    m_Files.clear();
+}
+
+}
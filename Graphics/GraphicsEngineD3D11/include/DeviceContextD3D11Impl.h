@@ -76,6 +76,8 @@ public:
 
     virtual void SetBlendFactors(const float* pBlendFactors = nullptr)override final;
 
+    virtual void SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)override final;
+
     virtual void SetVertexBuffers(Uint32                         StartSlot,
                                   Uint32                         NumBuffersSet,
                                   IBuffer**                      ppBuffers,
@@ -164,10 +166,16 @@ public:
 
     virtual void ExecuteCommandList(class ICommandList* pCommandList)override final;
 
+    virtual void ExecuteCommandLists(Uint32 NumCommandLists, class ICommandList* const* ppCommandLists)override final;
+
     virtual void SignalFence(IFence* pFence, Uint64 Value)override final;
 
     virtual void WaitForFence(IFence* pFence, Uint64 Value, bool FlushContext)override final;
 
+    virtual void BeginQuery(IQuery* pQuery)override final;
+
+    virtual void EndQuery(IQuery* pQuery)override final;
+
     virtual void WaitForIdle()override final;
 
     virtual void Flush()override final;
@@ -59,6 +59,8 @@ public:
 
     virtual void CreateFence(const FenceDesc& Desc, IFence** ppFence)override final;
 
+    virtual void CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)override final;
+
     ID3D11Device* GetD3D11Device()override final{return m_pd3d11Device;}
 
     virtual void CreateBufferFromD3DResource(ID3D11Buffer* pd3d11Buffer, const BufferDesc& BuffDesc, RESOURCE_STATE InitialState, IBuffer** ppBuffer)override final;
@@ -38,6 +38,7 @@
 #include "CommandListD3D11Impl.h"
 #include "RenderDeviceD3D11Impl.h"
 #include "FenceD3D11Impl.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -620,6 +621,7 @@ namespace Diligent
 
     void DeviceContextD3D11Impl::CommitShaderResources(IShaderResourceBinding* pShaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode, bool bCheckUAVSRV)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D11Impl::CommitShaderResources");
         if (!DeviceContextBase::CommitShaderResources(pShaderResourceBinding, StateTransitionMode, 0 /*Dummy*/))
             return;
 
@@ -655,6 +657,14 @@ namespace Diligent
         }
     }
 
+    void DeviceContextD3D11Impl::SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)
+    {
+        if (TDeviceContextBase::SetPushConstants(pData, Offset, Size, 0))
+        {
+            LOG_ERROR_MESSAGE("Push constants are not supported in Direct3D11 backend");
+        }
+    }
+
     void DeviceContextD3D11Impl::CommitD3D11IndexBuffer(VALUE_TYPE IndexType)
     {
         if (!m_pIndexBuffer)
@@ -741,6 +751,7 @@ namespace Diligent
 
     void DeviceContextD3D11Impl::PrepareForDraw(DRAW_FLAGS Flags)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D11Impl::PrepareForDraw");
 #ifdef DEVELOPMENT
         if ((Flags & DRAW_FLAG_VERIFY_RENDER_TARGETS) != 0)
             DvpVerifyRenderTargets();
@@ -890,6 +901,7 @@ namespace Diligent
 
     void DeviceContextD3D11Impl::DispatchCompute(const DispatchComputeAttribs& Attribs)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D11Impl::DispatchCompute");
         if (!DvpVerifyDispatchArguments(Attribs))
             return;
 
@@ -997,6 +1009,7 @@ namespace Diligent
 
     void DeviceContextD3D11Impl::Flush()
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D11Impl::Flush");
         m_pd3d11DeviceContext->Flush();
     }
 
@@ -1817,6 +1830,13 @@ namespace Diligent
         }
 #endif
     }
+
+    void DeviceContextD3D11Impl::ExecuteCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists)
+    {
+        // D3D11 has no batched execution, every list is executed by the driver separately
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+            ExecuteCommandList(ppCommandLists[i]);
+    }
        
     
     static CComPtr<ID3D11Query> CreateD3D11QueryEvent(ID3D11Device* pd3d11Device)
@@ -1854,6 +1874,16 @@ namespace Diligent
         pFenceD3D11Impl->Wait(Value, FlushContext);
     }
 
+    void DeviceContextD3D11Impl::BeginQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D11 backend");
+    }
+
+    void DeviceContextD3D11Impl::EndQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D11 backend");
+    }
+
     void DeviceContextD3D11Impl::WaitForIdle()
     {
         VERIFY(!m_bIsDeferred, "Only immediate contexts can be idled");
@@ -36,6 +36,7 @@
 #include "ShaderResourceBindingD3D11Impl.h"
 #include "FenceD3D11Impl.h"
 #include "EngineMemory.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -51,6 +52,7 @@ RenderDeviceD3D11Impl :: RenderDeviceD3D11Impl(IReferenceCounters*          pRef
         pRefCounters,
         RawMemAllocator,
         pEngineFactory,
+        EngineAttribs,
         NumDeferredContexts,
         DeviceObjectSizes
         {
@@ -62,7 +64,8 @@ RenderDeviceD3D11Impl :: RenderDeviceD3D11Impl(IReferenceCounters*          pRef
             sizeof(SamplerD3D11Impl),
             sizeof(PipelineStateD3D11Impl),
             sizeof(ShaderResourceBindingD3D11Impl),
-            sizeof(FenceD3D11Impl)
+            sizeof(FenceD3D11Impl),
+            0 // Queries are not currently supported
         }
     },
     m_EngineAttribs{EngineAttribs},
@@ -162,6 +165,7 @@ void RenderDeviceD3D11Impl :: CreateBuffer(const BufferDesc& BuffDesc, const Buf
 
 void RenderDeviceD3D11Impl :: CreateShader(const ShaderCreateInfo& ShaderCI, IShader** ppShader)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceD3D11Impl::CreateShader");
     CreateDeviceObject( "shader", ShaderCI.Desc, ppShader, 
         [&]()
         {
@@ -288,6 +292,7 @@ void RenderDeviceD3D11Impl :: CreateSampler(const SamplerDesc& SamplerDesc, ISam
 
 void RenderDeviceD3D11Impl::CreatePipelineState(const PipelineStateDesc& PipelineDesc, IPipelineState** ppPipelineState)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceD3D11Impl::CreatePipelineState");
     CreateDeviceObject( "Pipeline state", PipelineDesc, ppPipelineState, 
         [&]()
         {
@@ -312,6 +317,12 @@ void RenderDeviceD3D11Impl::CreateFence(const FenceDesc& Desc, IFence** ppFence)
     );
 }
 
+void RenderDeviceD3D11Impl::CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)
+{
+    VERIFY(ppQuery != nullptr && *ppQuery == nullptr, "Null pointer provided or the pointer already points to a query");
+    LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D11 backend");
+}
+
 void RenderDeviceD3D11Impl::IdleGPU()
 {
     if (auto pImmediateCtx = m_wpImmediateContext.Lock())
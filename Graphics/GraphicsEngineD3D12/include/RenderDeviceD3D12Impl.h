@@ -70,6 +70,8 @@ public:
 
     virtual void CreateFence(const FenceDesc& Desc, IFence** ppFence)override final;
 
+    virtual void CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)override final;
+
     virtual ID3D12Device* GetD3D12Device()override final{return m_pd3d12Device;}
     
     virtual void CreateTextureFromD3DResource(ID3D12Resource* pd3d12Texture, RESOURCE_STATE InitialState, ITexture** ppTexture)override final;
@@ -36,6 +36,7 @@
 #include "D3D12DynamicHeap.h"
 #include "CommandListD3D12Impl.h"
 #include "DXGITypeConversions.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -249,6 +250,7 @@ namespace Diligent
 
     void DeviceContextD3D12Impl::CommitShaderResources(IShaderResourceBinding* pShaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode, bool bCheckUAVSRV)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D12Impl::CommitShaderResources");
         if (!DeviceContextBase::CommitShaderResources(pShaderResourceBinding, StateTransitionMode, 0 /*Dummy*/))
             return;
 
@@ -279,6 +281,14 @@ namespace Diligent
         }
     }
 
+    void DeviceContextD3D12Impl::SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)
+    {
+        if (TDeviceContextBase::SetPushConstants(pData, Offset, Size, 0))
+        {
+            LOG_ERROR_MESSAGE("Push constants are not supported in Direct3D12 backend");
+        }
+    }
+
     void DeviceContextD3D12Impl::CommitD3D12IndexBuffer(GraphicsContext& GraphCtx, VALUE_TYPE IndexType)
     {
         VERIFY( m_pIndexBuffer != nullptr, "Index buffer is not set up for indexed draw command" );
@@ -374,6 +384,7 @@ namespace Diligent
 
     void DeviceContextD3D12Impl::PrepareForDraw(GraphicsContext& GraphCtx, DRAW_FLAGS Flags)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D12Impl::PrepareForDraw");
 #ifdef DEVELOPMENT
         if ((Flags & DRAW_FLAG_VERIFY_RENDER_TARGETS) != 0)
             DvpVerifyRenderTargets();
@@ -558,6 +569,7 @@ namespace Diligent
 
     void DeviceContextD3D12Impl::DispatchCompute(const DispatchComputeAttribs& Attribs)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D12Impl::DispatchCompute");
         if (!DvpVerifyDispatchArguments(Attribs))
             return;
 
@@ -678,6 +690,7 @@ namespace Diligent
 
     void DeviceContextD3D12Impl::Flush(bool RequestNewCmdCtx)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextD3D12Impl::Flush");
         if( m_CurrCmdCtx )
         {
             VERIFY(!m_bIsDeferred, "Deferred contexts cannot execute command lists directly");
@@ -1662,6 +1675,12 @@ namespace Diligent
         pDeferredCtx->m_SubmittedBuffersCmdQueueMask |= Uint64{1} << m_CommandQueueId;
     }
 
+    void DeviceContextD3D12Impl::ExecuteCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists)
+    {
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+            ExecuteCommandList(ppCommandLists[i]);
+    }
+
     void DeviceContextD3D12Impl::SignalFence(IFence* pFence, Uint64 Value)
     {
         VERIFY(!m_bIsDeferred, "Fence can only be signaled from immediate context");
@@ -1677,6 +1696,16 @@ namespace Diligent
         pFenceD3D12->WaitForCompletion(Value);
     }
 
+    void DeviceContextD3D12Impl::BeginQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D12 backend");
+    }
+
+    void DeviceContextD3D12Impl::EndQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D12 backend");
+    }
+
     void DeviceContextD3D12Impl::WaitForIdle()
     {
         VERIFY(!m_bIsDeferred, "Only immediate contexts can be idled");
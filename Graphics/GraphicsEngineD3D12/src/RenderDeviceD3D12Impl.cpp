@@ -33,6 +33,7 @@
 #include "DeviceContextD3D12Impl.h"
 #include "FenceD3D12Impl.h"
 #include "EngineMemory.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -69,6 +70,7 @@ RenderDeviceD3D12Impl :: RenderDeviceD3D12Impl(IReferenceCounters*           pRe
         pEngineFactory,
         CommandQueueCount,
         ppCmdQueues,
+        EngineCI,
         EngineCI.NumDeferredContexts,
         DeviceObjectSizes
         {
@@ -80,7 +82,8 @@ RenderDeviceD3D12Impl :: RenderDeviceD3D12Impl(IReferenceCounters*           pRe
             sizeof(SamplerD3D12Impl),
             sizeof(PipelineStateD3D12Impl),
             sizeof(ShaderResourceBindingD3D12Impl),
-            sizeof(FenceD3D12Impl)
+            sizeof(FenceD3D12Impl),
+            0 // Queries are not currently supported
         }
     },
     m_pd3d12Device  {pd3d12Device},
@@ -333,6 +336,7 @@ IMPLEMENT_QUERY_INTERFACE( RenderDeviceD3D12Impl, IID_RenderDeviceD3D12, TRender
 
 void RenderDeviceD3D12Impl::CreatePipelineState(const PipelineStateDesc& PipelineDesc, IPipelineState** ppPipelineState)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceD3D12Impl::CreatePipelineState");
     CreateDeviceObject("Pipeline State", PipelineDesc, ppPipelineState, 
         [&]()
         {
@@ -372,6 +376,7 @@ void RenderDeviceD3D12Impl :: CreateBuffer(const BufferDesc& BuffDesc, const Buf
 
 void RenderDeviceD3D12Impl :: CreateShader(const ShaderCreateInfo& ShaderCI, IShader** ppShader)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceD3D12Impl::CreateShader");
     CreateDeviceObject( "shader", ShaderCI.Desc, ppShader, 
         [&]()
         {
@@ -454,6 +459,12 @@ void RenderDeviceD3D12Impl::CreateFence(const FenceDesc& Desc, IFence** ppFence)
     );
 }
 
+void RenderDeviceD3D12Impl::CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)
+{
+    VERIFY(ppQuery != nullptr && *ppQuery == nullptr, "Null pointer provided or the pointer already points to a query");
+    LOG_ERROR_MESSAGE("Queries are not currently supported in Direct3D12 backend");
+}
+
 DescriptorHeapAllocation RenderDeviceD3D12Impl :: AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE Type, UINT Count /*= 1*/)
 {
     VERIFY(Type >= D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV && Type < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES, "Invalid heap type");
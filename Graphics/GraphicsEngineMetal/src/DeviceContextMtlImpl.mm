@@ -97,6 +97,14 @@ namespace Diligent
         }
     }
 
+    void DeviceContextMtlImpl::SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)
+    {
+        if (TDeviceContextBase::SetPushConstants(pData, Offset, Size, 0))
+        {
+            LOG_ERROR_MESSAGE("Push constants are not supported in Metal backend");
+        }
+    }
+
     void DeviceContextMtlImpl::Draw(const DrawAttribs& Attribs)
     {
         if (!DvpVerifyDrawArguments(Attribs))
@@ -397,6 +405,12 @@ namespace Diligent
         (void)pCmdListMtl;
         LOG_ERROR_MESSAGE("DeviceContextMtlImpl::ExecuteCommandList() is not implemented");
     }
+
+    void DeviceContextMtlImpl::ExecuteCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists)
+    {
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+            ExecuteCommandList(ppCommandLists[i]);
+    }
        
     void DeviceContextMtlImpl::SignalFence(IFence* pFence, Uint64 Value)
     {
@@ -413,6 +427,16 @@ namespace Diligent
         LOG_ERROR_MESSAGE("DeviceContextMtlImpl::Wait() is not implemented");
     }
 
+    void DeviceContextMtlImpl::BeginQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Metal backend");
+    }
+
+    void DeviceContextMtlImpl::EndQuery(IQuery* pQuery)
+    {
+        LOG_ERROR_MESSAGE("Queries are not currently supported in Metal backend");
+    }
+
     void DeviceContextMtlImpl::WaitForIdle()
     {
         VERIFY(!m_bIsDeferred, "Only immediate contexts can be idled");
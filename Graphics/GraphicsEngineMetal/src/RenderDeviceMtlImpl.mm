@@ -47,6 +47,7 @@ RenderDeviceMtlImpl :: RenderDeviceMtlImpl(IReferenceCounters*        pRefCounte
         pRefCounters,
         RawMemAllocator,
         pEngineFactory,
+        EngineAttribs,
         EngineAttribs.NumDeferredContexts,
         DeviceObjectSizes
         {
@@ -58,7 +59,8 @@ RenderDeviceMtlImpl :: RenderDeviceMtlImpl(IReferenceCounters*        pRefCounte
             sizeof(SamplerMtlImpl),
             sizeof(PipelineStateMtlImpl),
             sizeof(ShaderResourceBindingMtlImpl),
-            sizeof(FenceMtlImpl)
+            sizeof(FenceMtlImpl),
+            0 // Queries are not currently supported
         }
     },
     m_EngineAttribs(EngineAttribs)
@@ -171,6 +173,12 @@ void RenderDeviceMtlImpl::CreateFence(const FenceDesc& Desc, IFence** ppFence)
     );
 }
 
+void RenderDeviceMtlImpl::CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)
+{
+    VERIFY(ppQuery != nullptr && *ppQuery == nullptr, "Null pointer provided or the pointer already points to a query");
+    LOG_ERROR_MESSAGE("Queries are not currently supported in Metal backend");
+}
+
 void RenderDeviceMtlImpl::IdleGPU()
 {
     LOG_ERROR_MESSAGE("RenderDeviceMtlImpl::IdleGPU() is not implemented");
@@ -32,6 +32,7 @@
 #include <atomic>
 #include "VariableSizeAllocationsManager.h"
 #include "RingBuffer.h"
+#include "../../../Common/interface/LockFreeBoundedQueue.h"
 
 namespace Diligent
 {
@@ -89,16 +90,31 @@ private:
 };
 
 
+// Master blocks of the page size are the most frequently allocated blocks. When such block is released,
+// it is put into the lock-free free page queue, and the next page allocation takes it from the queue
+// without locking the mutex. Pages are only returned to the allocations manager when it fails to
+// allocate a block, so that the space can be merged with adjacent free blocks.
 class MasterBlockListBasedManager
 {
 public:
     using OffsetType  = VariableSizeAllocationsManager::OffsetType;
     using MasterBlock = VariableSizeAllocationsManager::Allocation;
 
+    /// \param [in] Allocator     - allocator for internal data structures.
+    /// \param [in] Size          - total size of the managed space.
+    /// \param [in] PageSize      - size of the blocks that are recycled through the free page queue.
+    ///                             Zero disables the queue.
+    /// \param [in] PageAlignment - alignment of the page offsets.
     MasterBlockListBasedManager(IMemoryAllocator& Allocator, 
-                                Uint32            Size) : 
-        m_AllocationsMgr(Size, Allocator)
+                                Uint32            Size,
+                                Uint32            PageSize      = 0,
+                                Uint32            PageAlignment = 1) : 
+        m_AllocationsMgr(Size, Allocator),
+        m_PageSize      (PageSize),
+        m_PageAlignment (PageAlignment),
+        m_FreePages     (Allocator, GetFreePageQueueCapacity(Size, PageSize))
     {
+        VERIFY(IsPowerOfTwo(PageAlignment), "Page alignment (", PageAlignment, ") must be power of 2");
 #ifdef DEVELOPMENT
         m_MasterBlockCounter = 0;
 #endif
@@ -111,6 +127,7 @@ public:
 
     ~MasterBlockListBasedManager()
     {
+        ReleaseFreePages();
         DEV_CHECK_ERR(m_MasterBlockCounter == 0, m_MasterBlockCounter, " master block(s) have not been returned to the manager");
     }
 
@@ -144,10 +161,13 @@ public:
             {
                 if (Mgr != nullptr)
                 {
-                    std::lock_guard<std::mutex> Lock{Mgr->m_AllocationsMgrMtx};
 #ifdef DEVELOPMENT
                     --Mgr->m_MasterBlockCounter;
 #endif
+                    if (Mgr->IsPage(Block) && Mgr->m_FreePages.TryPush(std::move(Block)))
+                        return;
+
+                    std::lock_guard<std::mutex> Lock{Mgr->m_AllocationsMgrMtx};
                     Mgr->m_AllocationsMgr.Free(std::move(Block));
                 }
             }
@@ -160,7 +180,13 @@ public:
     }
 
     OffsetType GetSize()    const { return m_AllocationsMgr.GetMaxSize(); }
-    OffsetType GetUsedSize()const { return m_AllocationsMgr.GetUsedSize();}
+    OffsetType GetUsedSize()const
+    {
+        // Pages in the free page queue are not used, though the allocations manager does not know it
+        auto UsedSize      = m_AllocationsMgr.GetUsedSize();
+        auto FreePagesSize = m_FreePages.GetSizeApprox() * m_PageSize;
+        return UsedSize > FreePagesSize ? UsedSize - FreePagesSize : 0;
+    }
 
 #ifdef DEVELOPMENT
     int32_t GetMasterBlockCounter()const{return m_MasterBlockCounter;}
@@ -169,8 +195,23 @@ public:
 protected:
     MasterBlock AllocateMasterBlock(OffsetType SizeInBytes, OffsetType Alignment)
     {
-        std::lock_guard<std::mutex> Lock{m_AllocationsMgrMtx};
-        auto NewBlock = m_AllocationsMgr.Allocate(SizeInBytes, Alignment);
+        MasterBlock NewBlock;
+        if (SizeInBytes == m_PageSize && Alignment <= m_PageAlignment)
+        {
+            m_FreePages.TryPop([&NewBlock](MasterBlock&& Page) { NewBlock = std::move(Page); });
+        }
+
+        if (!NewBlock.IsValid())
+        {
+            std::lock_guard<std::mutex> Lock{m_AllocationsMgrMtx};
+            NewBlock = m_AllocationsMgr.Allocate(SizeInBytes, Alignment);
+            if (!NewBlock.IsValid() && m_FreePages.GetSizeApprox() > 0)
+            {
+                // The space may be taken by the free pages. Return them to the allocations manager and try again.
+                ReleaseFreePagesUnsafe();
+                NewBlock = m_AllocationsMgr.Allocate(SizeInBytes, Alignment);
+            }
+        }
 #ifdef DEVELOPMENT
         if (NewBlock.IsValid())
         {
@@ -181,9 +222,40 @@ protected:
     }
 
 private:
+    static size_t GetFreePageQueueCapacity(Uint32 Size, Uint32 PageSize)
+    {
+        size_t Capacity = 2;
+        const size_t MaxPages = PageSize != 0 ? Size / PageSize : 0;
+        while (Capacity < MaxPages)
+            Capacity *= 2;
+        return Capacity;
+    }
+
+    bool IsPage(const MasterBlock& Block)const
+    {
+        return m_PageSize != 0 && Block.Size == m_PageSize && (Block.UnalignedOffset & (m_PageAlignment - 1)) == 0;
+    }
+
+    void ReleaseFreePages()
+    {
+        std::lock_guard<std::mutex> Lock{m_AllocationsMgrMtx};
+        ReleaseFreePagesUnsafe();
+    }
+
+    // m_AllocationsMgrMtx must be locked
+    void ReleaseFreePagesUnsafe()
+    {
+        while (m_FreePages.TryPop([this](MasterBlock&& Page) { m_AllocationsMgr.Free(std::move(Page)); }))
+            ;
+    }
+
     std::mutex                      m_AllocationsMgrMtx;
     VariableSizeAllocationsManager  m_AllocationsMgr;
 
+    const OffsetType                  m_PageSize;
+    const OffsetType                  m_PageAlignment;
+    LockFreeBoundedQueue<MasterBlock> m_FreePages;
+
 #ifdef DEVELOPMENT
     std::atomic_int32_t             m_MasterBlockCounter;
 #endif
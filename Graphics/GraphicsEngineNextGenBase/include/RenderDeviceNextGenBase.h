@@ -52,9 +52,10 @@ public:
                             IEngineFactory*          pEngineFactory,
                             size_t                   CmdQueueCount,
                             CommandQueueType**       Queues,
+                            const EngineCreateInfo&  EngineCI,
                             Uint32                   NumDeferredContexts,
                             const DeviceObjectSizes& ObjectSizes) :
-        TBase           (pRefCounters, RawMemAllocator, pEngineFactory, NumDeferredContexts, ObjectSizes),
+        TBase           (pRefCounters, RawMemAllocator, pEngineFactory, EngineCI, NumDeferredContexts, ObjectSizes),
         m_CmdQueueCount (CmdQueueCount)
     {
         m_CommandQueues = ALLOCATE(this->m_RawMemAllocator, "Raw memory for the device command/release queues", CommandQueue, m_CmdQueueCount);
@@ -103,6 +104,17 @@ public:
             return;
 
         Atomics::Long NumReferences = PlatformMisc::CountOneBits(QueueMask);
+        if (NumReferences == 1)
+        {
+            // The object is only referenced by one queue, so the wrapper can be moved into the queue.
+            // Small objects are then kept inside the wrapper without allocating memory from the heap.
+            auto QueueIndex = PlatformMisc::GetLSB(QueueMask);
+            VERIFY_EXPR(QueueIndex < m_CmdQueueCount);
+            auto& Queue = m_CommandQueues[QueueIndex];
+            Queue.ReleaseQueue.SafeReleaseResource(DynamicStaleResourceWrapper::Create(std::move(Object), 1), Queue.NextCmdBufferNumber);
+            return;
+        }
+
         auto Wrapper = DynamicStaleResourceWrapper::Create(std::move(Object), NumReferences);
 
         while (QueueMask != 0)
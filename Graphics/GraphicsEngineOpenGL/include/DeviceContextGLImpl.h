@@ -66,6 +66,8 @@ public:
 
     virtual void SetBlendFactors(const float* pBlendFactors = nullptr)override final;
 
+    virtual void SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)override final;
+
     virtual void SetVertexBuffers(Uint32                         StartSlot,
                                   Uint32                         NumBuffersSet,
                                   IBuffer**                      ppBuffers,
@@ -153,10 +155,16 @@ public:
 
     virtual void ExecuteCommandList(class ICommandList* pCommandList)override final;
 
+    virtual void ExecuteCommandLists(Uint32 NumCommandLists, class ICommandList* const* ppCommandLists)override final;
+
     virtual void SignalFence(IFence* pFence, Uint64 Value)override final;
 
     virtual void WaitForFence(IFence* pFence, Uint64 Value, bool FlushContext)override final;
 
+    virtual void BeginQuery(IQuery* pQuery)override final;
+
+    virtual void EndQuery(IQuery* pQuery)override final;
+
     virtual void WaitForIdle()override final;
 
     virtual void Flush()override final;
@@ -182,12 +190,22 @@ private:
     __forceinline void PrepareForIndexedDraw(VALUE_TYPE IndexType, Uint32 FirstIndexLocation,  GLenum& GLIndexType, Uint32& FirstIndexByteOffset);
     __forceinline void PrepareForIndirectDraw(IBuffer* pAttribsBuffer);
     __forceinline void PostDraw();
+    __forceinline void CommitPushConstants();
     Uint32 m_CommitedResourcesTentativeBarriers;
 
     std::vector<class TextureBaseGL*> m_BoundWritableTextures;
     std::vector<class BufferGLImpl*>  m_BoundWritableBuffers;
 
     GLObjectWrappers::GLFrameBufferObj m_DefaultFBO;
+
+    // Push constants are emulated with a uniform buffer range that is sub-allocated from a ring buffer.
+    // When the ring buffer is exhausted, its storage is orphaned so that the data is never overwritten
+    // while it may still be in use by the GPU.
+    static constexpr Uint32            PushConstantsRingBufferSize = 64 << 10;
+    GLObjectWrappers::GLBufferObj      m_PushConstantsBuffer;
+    Uint32                             m_PushConstantsBufferOffset       = 0;
+    Uint32                             m_PushConstantsOffsetAlignment    = 0;
+    bool                               m_CommittedPushConstantsUpToDate  = false;
 };
 
 }
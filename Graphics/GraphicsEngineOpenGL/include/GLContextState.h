@@ -43,6 +43,7 @@ public:
     void SetActiveTexture  (Int32 Index);
     void BindTexture       (Int32 Index, GLenum BindTarget, const GLObjectWrappers::GLTextureObj& Tex);
     void BindUniformBuffer (Int32 Index,       const GLObjectWrappers::GLBufferObj& Buff);
+    void BindUniformBufferRange(Int32 Index,   const GLObjectWrappers::GLBufferObj& Buff, GLintptr Offset, GLsizeiptr Size);
     void BindBuffer        (GLenum BindTarget, const GLObjectWrappers::GLBufferObj& Buff, bool ResetVAO);
     void BindSampler       (Uint32 Index,      const GLObjectWrappers::GLSamplerObj& GLSampler);
     void BindImage         (Uint32 Index, class TextureViewGLImpl* pTexView, GLint MipLevel, GLboolean IsLayered, GLint Layer, GLenum Access, GLenum Format);
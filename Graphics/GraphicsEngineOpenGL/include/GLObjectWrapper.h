@@ -268,6 +268,16 @@ public:
     static const char *Name;
 };
 typedef GLObjWrapper<GLRBOCreateReleaseHelper> GLRenderBufferObj;
+
+
+class GLQueryCreateReleaseHelper
+{
+public:
+    void Create(GLuint &Query) { glGenQueries(1, &Query); }
+    void Release(GLuint Query) { glDeleteQueries(1, &Query); }
+    static const char *Name;
+};
+typedef GLObjWrapper<GLQueryCreateReleaseHelper> GLQueryObj;
     
 struct GLSyncObj
 {
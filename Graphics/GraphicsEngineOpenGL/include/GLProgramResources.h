@@ -62,7 +62,9 @@ namespace Diligent
                           Uint32&                               UniformBufferBinding,
                           Uint32&                               SamplerBinding,
                           Uint32&                               ImageBinding,
-                          Uint32&                               StorageBufferBinding);
+                          Uint32&                               StorageBufferBinding,
+                          const Char*                           PushConstantsBlockName = nullptr,
+                          Uint32                                PushConstantsBinding   = 0);
 
         struct GLResourceAttribs
         {
@@ -74,6 +74,9 @@ public:
     const GLPipelineResourceLayout& GetStaticResourceLayout()const {return m_StaticResourceLayout;}
     const GLProgramResourceCache&   GetStaticResourceCache()const {return m_StaticResourceCache;}
 
+    // Uniform buffer binding of the block that emulates push constants
+    Uint32 GetPushConstantsBinding()const {return m_PushConstantsBinding;}
+
 private:
     GLObjectWrappers::GLPipelineObj& GetGLProgramPipeline(GLContext::NativeGLContextType Context);
     void InitStaticSamplersInResourceCache(const GLPipelineResourceLayout& ResourceLayout, GLProgramResourceCache& Cache)const;
@@ -104,6 +107,7 @@ private:
     Uint32  m_TotalSamplerBindings       = 0;
     Uint32  m_TotalImageBindings         = 0;
     Uint32  m_TotalStorageBufferBindings = 0;
+    Uint32  m_PushConstantsBinding       = 0;
 
     std::vector<RefCntAutoPtr<ISampler>> m_StaticSamplers;
 };
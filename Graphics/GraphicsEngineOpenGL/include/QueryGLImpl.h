@@ -0,0 +1,67 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::QueryGLImpl class
+
+#include <vector>
+#include "QueryGL.h"
+#include "QueryBase.h"
+#include "GLObjectWrapper.h"
+#include "RenderDeviceGLImpl.h"
+
+namespace Diligent
+{
+
+class DeviceContextGLImpl;
+
+/// Implementation of the Diligent::IQueryGL interface
+class QueryGLImpl final : public QueryBase<IQueryGL, RenderDeviceGLImpl>
+{
+public:
+    using TQueryBase = QueryBase<IQueryGL, RenderDeviceGLImpl>;
+
+    QueryGLImpl(IReferenceCounters* pRefCounters,
+                RenderDeviceGLImpl* pDevice,
+                const QueryDesc&    Desc);
+    ~QueryGLImpl();
+
+    IMPLEMENT_QUERY_INTERFACE_IN_PLACE(IID_QueryGL, TQueryBase);
+
+    virtual bool GetData(void* pData, Uint32 DataSize)override final;
+
+    // Issues GL commands that begin and end the query. 
+    // The commands must be called from the thread that owns the immediate context.
+    void Begin();
+    void End();
+
+private:
+    // Occlusion and timestamp queries use one GL query object, duration queries use two
+    // timestamp queries, and pipeline statistics queries use one query per statistic
+    std::vector<GLObjectWrappers::GLQueryObj> m_GlQueries;
+};
+
+}
@@ -44,7 +44,9 @@
 #include "BufferViewGLImpl.h"
 #include "PipelineStateGLImpl.h"
 #include "FenceGLImpl.h"
+#include "QueryGLImpl.h"
 #include "ShaderResourceBindingGLImpl.h"
+#include "CpuProfiler.h"
 
 using namespace std;
 
@@ -59,7 +61,8 @@ namespace Diligent
         },
         m_ContextState                       {pDeviceGL},
         m_CommitedResourcesTentativeBarriers {0        },
-        m_DefaultFBO                         {false    }
+        m_DefaultFBO                         {false    },
+        m_PushConstantsBuffer                {false    }
     {
         m_BoundWritableTextures.reserve( 16 );
         m_BoundWritableBuffers.reserve( 16 );
@@ -75,6 +78,8 @@ namespace Diligent
             return;
 
         TDeviceContextBase::SetPipelineState(pPipelineStateGLImpl, 0 /*Dummy*/);
+        // Push constants binding is assigned by the pipeline
+        m_CommittedPushConstantsUpToDate = false;
 
         const auto& Desc = pPipelineStateGLImpl->GetDesc();
         if (Desc.IsComputePipeline)
@@ -145,6 +150,7 @@ namespace Diligent
 
     void DeviceContextGLImpl::CommitShaderResources(IShaderResourceBinding* pShaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode, bool bCheckUAVSRV)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextGLImpl::CommitShaderResources");
         if (!DeviceContextBase::CommitShaderResources(pShaderResourceBinding, StateTransitionMode, 0))
             return;
 
@@ -174,6 +180,54 @@ namespace Diligent
         }
     }
 
+    void DeviceContextGLImpl::SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)
+    {
+        if (TDeviceContextBase::SetPushConstants(pData, Offset, Size, 0))
+        {
+            // Push constants are uploaded by the next draw or dispatch command
+            m_CommittedPushConstantsUpToDate = false;
+        }
+    }
+
+    void DeviceContextGLImpl::CommitPushConstants()
+    {
+        const auto Size = m_pPipelineState->GetDesc().PushConstants.Size;
+        if (Size != 0)
+        {
+            if (!m_PushConstantsBuffer)
+            {
+                m_PushConstantsBuffer.Create();
+                m_ContextState.BindBuffer(GL_UNIFORM_BUFFER, m_PushConstantsBuffer, false);
+                glBufferData(GL_UNIFORM_BUFFER, PushConstantsRingBufferSize, nullptr, GL_STREAM_DRAW);
+                CHECK_GL_ERROR("Failed to initialize push constants buffer");
+
+                GLint Alignment = 0;
+                glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+                CHECK_GL_ERROR("Failed to get uniform buffer offset alignment");
+                m_PushConstantsOffsetAlignment = std::max(static_cast<Uint32>(Alignment), 4u);
+            }
+            else
+            {
+                m_ContextState.BindBuffer(GL_UNIFORM_BUFFER, m_PushConstantsBuffer, false);
+            }
+
+            auto Offset = (m_PushConstantsBufferOffset + m_PushConstantsOffsetAlignment - 1) / m_PushConstantsOffsetAlignment * m_PushConstantsOffsetAlignment;
+            if (Offset + Size > PushConstantsRingBufferSize)
+            {
+                // Orphan the storage to avoid synchronization with the GPU
+                glBufferData(GL_UNIFORM_BUFFER, PushConstantsRingBufferSize, nullptr, GL_STREAM_DRAW);
+                CHECK_GL_ERROR("Failed to orphan push constants buffer");
+                Offset = 0;
+            }
+            glBufferSubData(GL_UNIFORM_BUFFER, Offset, Size, m_PushConstants);
+            CHECK_GL_ERROR("Failed to update push constants");
+            m_PushConstantsBufferOffset = Offset + Size;
+
+            m_ContextState.BindUniformBufferRange(m_pPipelineState->GetPushConstantsBinding(), m_PushConstantsBuffer, Offset, Size);
+        }
+        m_CommittedPushConstantsUpToDate = true;
+    }
+
     void DeviceContextGLImpl::SetVertexBuffers(Uint32                         StartSlot,
                                                Uint32                         NumBuffersSet,
                                                IBuffer**                      ppBuffers,
@@ -192,6 +246,7 @@ namespace Diligent
         m_ContextState.Invalidate();
         m_BoundWritableTextures.clear();
         m_BoundWritableBuffers.clear();
+        m_CommittedPushConstantsUpToDate = false;
     }
 
     void DeviceContextGLImpl::SetIndexBuffer(IBuffer* pIndexBuffer, Uint32 ByteOffset, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode)
@@ -604,12 +659,15 @@ namespace Diligent
 
     void DeviceContextGLImpl::PrepareForDraw(DRAW_FLAGS Flags, bool IsIndexed, GLenum& GlTopology)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextGLImpl::PrepareForDraw");
 #ifdef DEVELOPMENT
         if ((Flags & DRAW_FLAG_VERIFY_RENDER_TARGETS) != 0)
             DvpVerifyRenderTargets();
 #endif
 
         m_pPipelineState->CommitProgram(m_ContextState);
+        if (!m_CommittedPushConstantsUpToDate)
+            CommitPushConstants();
 
         auto CurrNativeGLContext = m_pDevice->m_GLContext.GetCurrentNativeGLContext();
         const auto& PipelineDesc = m_pPipelineState->GetDesc().GraphicsPipeline;
@@ -825,11 +883,14 @@ namespace Diligent
 
     void DeviceContextGLImpl::DispatchCompute(const DispatchComputeAttribs& Attribs)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextGLImpl::DispatchCompute");
         if (!DvpVerifyDispatchArguments(Attribs))
             return;
 
 #if GL_ARB_compute_shader
         m_pPipelineState->CommitProgram(m_ContextState);
+        if (!m_CommittedPushConstantsUpToDate)
+            CommitPushConstants();
         glDispatchCompute(Attribs.ThreadGroupCountX, Attribs.ThreadGroupCountY, Attribs.ThreadGroupCountZ);
         CHECK_GL_ERROR("glDispatchCompute() failed");
 
@@ -846,6 +907,8 @@ namespace Diligent
 
 #if GL_ARB_compute_shader
         m_pPipelineState->CommitProgram(m_ContextState);
+        if (!m_CommittedPushConstantsUpToDate)
+            CommitPushConstants();
 
         auto* pBufferGL = ValidatedCast<BufferGLImpl>(pAttribsBuffer);
         pBufferGL->BufferMemoryBarrier(
@@ -981,6 +1044,7 @@ namespace Diligent
 
     void DeviceContextGLImpl::Flush()
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextGLImpl::Flush");
         glFlush();
     }
 
@@ -998,6 +1062,11 @@ namespace Diligent
         LOG_ERROR("Deferred contexts are not supported in OpenGL mode");
     }
 
+    void DeviceContextGLImpl::ExecuteCommandLists(Uint32 NumCommandLists, class ICommandList* const* ppCommandLists)
+    {
+        LOG_ERROR("Deferred contexts are not supported in OpenGL mode");
+    }
+
     void DeviceContextGLImpl::SignalFence(IFence* pFence, Uint64 Value)
     {
         VERIFY(!m_bIsDeferred, "Fence can only be signaled from immediate context");
@@ -1018,6 +1087,22 @@ namespace Diligent
         pFenceGLImpl->Wait(Value, FlushContext);
     }
 
+    void DeviceContextGLImpl::BeginQuery(IQuery* pQuery)
+    {
+        VERIFY(!m_bIsDeferred, "Queries are only supported in immediate context");
+        auto* pQueryGLImpl = ValidatedCast<QueryGLImpl>(pQuery);
+        if (pQueryGLImpl->OnBeginQuery(this))
+            pQueryGLImpl->Begin();
+    }
+
+    void DeviceContextGLImpl::EndQuery(IQuery* pQuery)
+    {
+        VERIFY(!m_bIsDeferred, "Queries are only supported in immediate context");
+        auto* pQueryGLImpl = ValidatedCast<QueryGLImpl>(pQuery);
+        if (pQueryGLImpl->OnEndQuery(this))
+            pQueryGLImpl->End();
+    }
+
     void DeviceContextGLImpl::WaitForIdle()
     {
         VERIFY(!m_bIsDeferred, "Only immediate contexts can be idled");
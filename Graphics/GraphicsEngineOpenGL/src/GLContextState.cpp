@@ -303,6 +303,20 @@ namespace Diligent
         }
     }
 
+    void GLContextState::BindUniformBufferRange( Int32 Index, const GLObjectWrappers::GLBufferObj &Buff, GLintptr Offset, GLsizeiptr Size)
+    {
+        VERIFY( 0 <= Index && Index < m_Caps.m_iMaxUniformBufferBindings, "Uniform buffer index is out of range" );
+
+        // The range changes every time the buffer is bound, so the binding is not tracked. Reset the cached
+        // buffer ID to make sure that the next call to BindUniformBuffer() for this slot is not skipped.
+        if( static_cast<size_t>(Index) >= m_BoundUniformBuffers.size() )
+            m_BoundUniformBuffers.resize( Index + 1, -1 );
+        m_BoundUniformBuffers[Index] = -1;
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, Index, Buff, Offset, Size);
+        DEV_CHECK_GL_ERROR("Failed to bind uniform buffer range to slot ", Index);
+    }
+
     void GLContextState::BindStorageBlock( Int32 Index, const GLObjectWrappers::GLBufferObj& Buff, GLintptr Offset, GLsizeiptr Size)
     {
 #if GL_ARB_shader_storage_buffer_object
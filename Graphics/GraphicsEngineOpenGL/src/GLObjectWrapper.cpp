@@ -35,4 +35,5 @@ namespace GLObjectWrappers
     const char *GLSamplerCreateReleaseHelper    :: Name = "sampler";
     const char *GLFBOCreateReleaseHelper        :: Name = "framebuffer";
     const char *GLRBOCreateReleaseHelper        :: Name = "renderbuffer";
+    const char *GLQueryCreateReleaseHelper      :: Name = "query";
 }
@@ -196,7 +196,9 @@ void GLProgramResources::LoadUniforms(SHADER_TYPE                           Shad
                                       Uint32&                               UniformBufferBinding,
                                       Uint32&                               SamplerBinding,
                                       Uint32&                               ImageBinding,
-                                      Uint32&                               StorageBufferBinding)
+                                      Uint32&                               StorageBufferBinding,
+                                      const Char*                           PushConstantsBlockName,
+                                      Uint32                                PushConstantsBinding)
 {
     // Load uniforms to temporary arrays. We will then pack all variables into a single chunk of memory.
     std::vector<UniformBufferInfo> UniformBlocks;
@@ -467,6 +469,15 @@ void GLProgramResources::LoadUniforms(SHADER_TYPE                           Shad
         // is equivalent to
         // glGetProgramResourceIndex( program, GL_UNIFORM_BLOCK, uniformBlockName );
 
+        if (PushConstantsBlockName != nullptr && strcmp(Name.data(), PushConstantsBlockName) == 0)
+        {
+            // Push constants block is not a shader resource. It is bound by the device context
+            // to the binding reserved by the pipeline state.
+            glUniformBlockBinding(GLProgram, UniformBlockIndex, PushConstantsBinding);
+            CHECK_GL_ERROR("glUniformBlockBinding() failed");
+            continue;
+        }
+
         bool IsNewBlock = true;
 
         GLint ArraySize = 1;
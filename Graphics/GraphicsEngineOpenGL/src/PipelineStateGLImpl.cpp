@@ -69,6 +69,11 @@ PipelineStateGLImpl::PipelineStateGLImpl(IReferenceCounters*      pRefCounters,
 
     {
         m_TotalUniformBufferBindings = 0;
+        if (m_Desc.PushConstants.Size != 0)
+        {
+            // Reserve the first uniform buffer binding for the block that emulates push constants
+            m_PushConstantsBinding = m_TotalUniformBufferBindings++;
+        }
         m_TotalSamplerBindings       = 0;
         m_TotalImageBindings         = 0;
         m_TotalStorageBufferBindings = 0;
@@ -89,7 +94,9 @@ PipelineStateGLImpl::PipelineStateGLImpl(IReferenceCounters*      pRefCounters,
                     m_TotalUniformBufferBindings,
                     m_TotalSamplerBindings,
                     m_TotalImageBindings,
-                    m_TotalStorageBufferBindings);
+                    m_TotalStorageBufferBindings,
+                    m_Desc.PushConstants.Name,
+                    m_PushConstantsBinding);
 
                 HashCombine(m_ShaderResourceLayoutHash, m_ProgramResources[i].GetHash());
             }
@@ -108,7 +115,9 @@ PipelineStateGLImpl::PipelineStateGLImpl(IReferenceCounters*      pRefCounters,
                     m_TotalUniformBufferBindings,
                     m_TotalSamplerBindings,
                     m_TotalImageBindings,
-                    m_TotalStorageBufferBindings);
+                    m_TotalStorageBufferBindings,
+                    m_Desc.PushConstants.Name,
+                    m_PushConstantsBinding);
 
             m_ShaderResourceLayoutHash = m_ProgramResources[0].GetHash();
         }
@@ -0,0 +1,245 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+
+#include "QueryGLImpl.h"
+#include "EngineMemory.h"
+
+namespace Diligent
+{
+
+#ifdef GL_VERTICES_SUBMITTED_ARB
+// GL_ARB_pipeline_statistics_query targets, in the order of the QueryDataPipelineStatistics members
+static const GLenum PipelineStatisticsTargets[] = 
+{
+    GL_VERTICES_SUBMITTED_ARB,
+    GL_PRIMITIVES_SUBMITTED_ARB,
+    GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED_ARB,
+    GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+    GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_GEOMETRY_SHADER_INVOCATIONS,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+    GL_TESS_CONTROL_SHADER_PATCHES_ARB,
+    GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB,
+    GL_COMPUTE_SHADER_INVOCATIONS_ARB
+};
+static_assert(sizeof(PipelineStatisticsTargets) / sizeof(PipelineStatisticsTargets[0]) == (sizeof(QueryDataPipelineStatistics) - offsetof(QueryDataPipelineStatistics, InputVertices)) / sizeof(Uint64),
+              "The number of pipeline statistics targets does not match the number of QueryDataPipelineStatistics members");
+#endif
+
+QueryGLImpl :: QueryGLImpl(IReferenceCounters* pRefCounters,
+                           RenderDeviceGLImpl* pDevice,
+                           const QueryDesc&    Desc) : 
+    TQueryBase
+    {
+        pRefCounters,
+        pDevice,
+        Desc
+    }
+{
+    size_t NumQueries = 0;
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (m_Desc.Type)
+    {
+        case QUERY_TYPE_OCCLUSION:
+        case QUERY_TYPE_TIMESTAMP:
+            NumQueries = 1;
+            break;
+
+        case QUERY_TYPE_DURATION:
+            NumQueries = 2;
+            break;
+
+        case QUERY_TYPE_PIPELINE_STATISTICS:
+#ifdef GL_VERTICES_SUBMITTED_ARB
+            NumQueries = _countof(PipelineStatisticsTargets);
+#endif
+            break;
+
+        default:
+            UNEXPECTED("Unexpected query type");
+    }
+
+    m_GlQueries.reserve(NumQueries);
+    for (size_t i = 0; i < NumQueries; ++i)
+        m_GlQueries.emplace_back(true);
+}
+
+QueryGLImpl :: ~QueryGLImpl()
+{
+}
+
+void QueryGLImpl::Begin()
+{
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (m_Desc.Type)
+    {
+        case QUERY_TYPE_OCCLUSION:
+#ifdef GL_SAMPLES_PASSED
+            glBeginQuery(GL_SAMPLES_PASSED, m_GlQueries[0]);
+            CHECK_GL_ERROR("Failed to begin occlusion query");
+#endif
+            break;
+
+        case QUERY_TYPE_DURATION:
+#ifdef GL_TIMESTAMP
+            glQueryCounter(m_GlQueries[0], GL_TIMESTAMP);
+            CHECK_GL_ERROR("Failed to write the beginning timestamp of a duration query");
+#endif
+            break;
+
+        case QUERY_TYPE_PIPELINE_STATISTICS:
+#ifdef GL_VERTICES_SUBMITTED_ARB
+            for (size_t i = 0; i < m_GlQueries.size(); ++i)
+                glBeginQuery(PipelineStatisticsTargets[i], m_GlQueries[i]);
+            CHECK_GL_ERROR("Failed to begin pipeline statistics query");
+#endif
+            break;
+
+        default:
+            UNEXPECTED("Unexpected query type");
+    }
+}
+
+void QueryGLImpl::End()
+{
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (m_Desc.Type)
+    {
+        case QUERY_TYPE_OCCLUSION:
+#ifdef GL_SAMPLES_PASSED
+            glEndQuery(GL_SAMPLES_PASSED);
+            CHECK_GL_ERROR("Failed to end occlusion query");
+#endif
+            break;
+
+        case QUERY_TYPE_TIMESTAMP:
+#ifdef GL_TIMESTAMP
+            glQueryCounter(m_GlQueries[0], GL_TIMESTAMP);
+            CHECK_GL_ERROR("Failed to write timestamp");
+#endif
+            break;
+
+        case QUERY_TYPE_DURATION:
+#ifdef GL_TIMESTAMP
+            glQueryCounter(m_GlQueries[1], GL_TIMESTAMP);
+            CHECK_GL_ERROR("Failed to write the ending timestamp of a duration query");
+#endif
+            break;
+
+        case QUERY_TYPE_PIPELINE_STATISTICS:
+#ifdef GL_VERTICES_SUBMITTED_ARB
+            for (size_t i = 0; i < m_GlQueries.size(); ++i)
+                glEndQuery(PipelineStatisticsTargets[i]);
+            CHECK_GL_ERROR("Failed to end pipeline statistics query");
+#endif
+            break;
+
+        default:
+            UNEXPECTED("Unexpected query type");
+    }
+}
+
+bool QueryGLImpl::GetData(void* pData, Uint32 DataSize)
+{
+    if (!CheckQueryDataPtr(pData, DataSize))
+        return false;
+
+    // GL_QUERY_RESULT_AVAILABLE does not block, while GL_QUERY_RESULT waits for the GPU
+    for (const auto& glQuery : m_GlQueries)
+    {
+        GLuint ResultAvailable = GL_FALSE;
+        glGetQueryObjectuiv(glQuery, GL_QUERY_RESULT_AVAILABLE, &ResultAvailable);
+        CHECK_GL_ERROR("Failed to get query result availability");
+        if (ResultAvailable == GL_FALSE)
+            return false;
+    }
+
+    if (pData == nullptr)
+        return true;
+
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (m_Desc.Type)
+    {
+        case QUERY_TYPE_OCCLUSION:
+        {
+            auto& QueryData = *reinterpret_cast<QueryDataOcclusion*>(pData);
+            GLuint NumSamples = 0;
+            glGetQueryObjectuiv(m_GlQueries[0], GL_QUERY_RESULT, &NumSamples);
+            QueryData.NumSamples = NumSamples;
+            break;
+        }
+
+        case QUERY_TYPE_TIMESTAMP:
+        {
+#ifdef GL_TIMESTAMP
+            auto& QueryData = *reinterpret_cast<QueryDataTimestamp*>(pData);
+            GLuint64 Counter = 0;
+            glGetQueryObjectui64v(m_GlQueries[0], GL_QUERY_RESULT, &Counter);
+            QueryData.Counter   = Counter;
+            // GL timestamps are in nanoseconds
+            QueryData.Frequency = 1000000000;
+#endif
+            break;
+        }
+
+        case QUERY_TYPE_DURATION:
+        {
+#ifdef GL_TIMESTAMP
+            auto& QueryData = *reinterpret_cast<QueryDataDuration*>(pData);
+            GLuint64 StartCounter = 0, EndCounter = 0;
+            glGetQueryObjectui64v(m_GlQueries[0], GL_QUERY_RESULT, &StartCounter);
+            glGetQueryObjectui64v(m_GlQueries[1], GL_QUERY_RESULT, &EndCounter);
+            QueryData.Duration  = EndCounter - StartCounter;
+            QueryData.Frequency = 1000000000;
+#endif
+            break;
+        }
+
+        case QUERY_TYPE_PIPELINE_STATISTICS:
+        {
+#ifdef GL_VERTICES_SUBMITTED_ARB
+            auto& QueryData = *reinterpret_cast<QueryDataPipelineStatistics*>(pData);
+            auto* pStatistics = &QueryData.InputVertices;
+            for (size_t i = 0; i < m_GlQueries.size(); ++i)
+            {
+                GLuint64 Value = 0;
+                glGetQueryObjectui64v(m_GlQueries[i], GL_QUERY_RESULT, &Value);
+                pStatistics[i] = Value;
+            }
+#endif
+            break;
+        }
+
+        default:
+            UNEXPECTED("Unexpected query type");
+    }
+    CHECK_GL_ERROR("Failed to get query data");
+
+    return true;
+}
+
+}
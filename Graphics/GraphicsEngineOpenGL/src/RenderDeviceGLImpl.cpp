@@ -41,8 +41,10 @@
 #include "PipelineStateGLImpl.h"
 #include "ShaderResourceBindingGLImpl.h"
 #include "FenceGLImpl.h"
+#include "QueryGLImpl.h"
 #include "EngineMemory.h"
 #include "StringTools.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -57,6 +59,7 @@ RenderDeviceGLImpl :: RenderDeviceGLImpl(IReferenceCounters*        pRefCounters
         pRefCounters,
         RawMemAllocator,
         pEngineFactory,
+        InitAttribs,
         0,
         DeviceObjectSizes
         {
@@ -68,7 +71,8 @@ RenderDeviceGLImpl :: RenderDeviceGLImpl(IReferenceCounters*        pRefCounters
             sizeof(SamplerGLImpl),
             sizeof(PipelineStateGLImpl),
             sizeof(ShaderResourceBindingGLImpl),
-            sizeof(FenceGLImpl)
+            sizeof(FenceGLImpl),
+            sizeof(QueryGLImpl)
         }
     },
     // Device caps must be filled in before the constructor of Pipeline Cache is called!
@@ -158,6 +162,7 @@ void RenderDeviceGLImpl :: CreateBufferFromGLHandle(Uint32 GLHandle, const Buffe
 
 void RenderDeviceGLImpl :: CreateShader(const ShaderCreateInfo& ShaderCreateInfo, IShader** ppShader, bool bIsDeviceInternal)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceGLImpl::CreateShader");
     CreateDeviceObject( "shader", ShaderCreateInfo.Desc, ppShader, 
         [&]()
         {
@@ -332,6 +337,7 @@ void RenderDeviceGLImpl::CreatePipelineState( const PipelineStateDesc& PipelineD
 
 void RenderDeviceGLImpl::CreatePipelineState(const PipelineStateDesc& PipelineDesc, IPipelineState **ppPipelineState, bool bIsDeviceInternal)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceGLImpl::CreatePipelineState");
     CreateDeviceObject( "Pipeline state", PipelineDesc, ppPipelineState, 
         [&]()
         {
@@ -356,6 +362,19 @@ void RenderDeviceGLImpl::CreateFence(const FenceDesc& Desc, IFence** ppFence)
     );
 }
 
+void RenderDeviceGLImpl::CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)
+{
+    CreateDeviceObject( "Query", Desc, ppQuery, 
+        [&]()
+        {
+            QueryGLImpl* pQueryOGL( NEW_RC_OBJ(m_QueryAllocator, "QueryGLImpl instance", QueryGLImpl)
+                                              (this, Desc) );
+            pQueryOGL->QueryInterface( IID_Query, reinterpret_cast<IObject**>(ppQuery) );
+            OnCreateDeviceObject( pQueryOGL );
+        }
+    );
+}
+
 bool RenderDeviceGLImpl::CheckExtension( const Char *ExtensionString )
 {
     return m_ExtensionStrings.find( ExtensionString ) != m_ExtensionStrings.end();
@@ -743,6 +762,21 @@ void RenderDeviceGLImpl :: QueryDeviceCaps()
         if( glGetError() != GL_NO_ERROR )
             m_DeviceCaps.bWireframeFillSupported = False;
     }
+
+    // Query targets that are not defined by the GL headers of the platform (e.g. GL_SAMPLES_PASSED
+    // and GL_TIMESTAMP in OpenGLES) are not supported
+    const bool IsGL33OrAbove = m_DeviceCaps.DevType == DeviceType::OpenGL &&
+        (m_DeviceCaps.MajorVersion > 3 || (m_DeviceCaps.MajorVersion == 3 && m_DeviceCaps.MinorVersion >= 3));
+    (void)IsGL33OrAbove;
+#ifdef GL_SAMPLES_PASSED
+    m_DeviceCaps.bOcclusionQueriesSupported = m_DeviceCaps.DevType == DeviceType::OpenGL;
+#endif
+#ifdef GL_TIMESTAMP
+    m_DeviceCaps.bTimestampQueriesSupported = IsGL33OrAbove || CheckExtension("GL_ARB_timer_query");
+#endif
+#ifdef GL_VERTICES_SUBMITTED_ARB
+    m_DeviceCaps.bPipelineStatisticsQueriesSupported = CheckExtension("GL_ARB_pipeline_statistics_query");
+#endif
 }
 
 
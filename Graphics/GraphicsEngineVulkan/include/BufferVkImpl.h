@@ -101,8 +101,20 @@ public:
         return (GetAccessFlags() & AccessFlags) == AccessFlags;
     }
 
+    // Static vertex, index and indirect-argument buffers are never written after initialization and 
+    // are not referenced by views or descriptor sets, so their memory can be moved by the defragmentation
+    bool IsMovable()const;
+
+    const VulkanUtilities::VulkanMemoryAllocation& GetMemoryAllocation()const{return m_MemoryAllocation;}
+
 private:
     friend class DeviceContextVkImpl;
+    friend class RenderDeviceVkImpl;
+
+    // Creates a new Vulkan buffer with the same properties and binds it to newly allocated memory
+    void CreateRelocationTarget(VulkanUtilities::BufferWrapper& NewBuffer, VulkanUtilities::VulkanMemoryAllocation& NewAllocation);
+    // Replaces the Vulkan buffer and its memory with the relocation target. The old buffer is released safely.
+    void CompleteRelocation(VulkanUtilities::BufferWrapper&& NewBuffer, VulkanUtilities::VulkanMemoryAllocation&& NewAllocation);
 
     virtual void CreateViewInternal(const struct BufferViewDesc& ViewDesc, IBufferView** ppView, bool bIsDefaultView)override;
 
@@ -113,6 +125,9 @@ private:
 
     VulkanUtilities::BufferWrapper          m_VulkanBuffer;
     VulkanUtilities::VulkanMemoryAllocation m_MemoryAllocation;
+
+    // Only accessed by the immediate context that performs defragmentation
+    bool m_IsBeingMoved = false;
 };
 
 }
@@ -30,7 +30,10 @@
 #include <deque>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <unordered_map>
 #include "VulkanUtilities/VulkanObjectWrappers.h"
+#include "HashUtils.h"
 
 namespace Diligent
 {
@@ -171,6 +174,7 @@ protected:
     std::deque< VulkanUtilities::DescriptorPoolWrapper > m_Pools;
 
 private:
+    friend class DynamicDescriptorSetAllocator;
     void FreePool(VulkanUtilities::DescriptorPoolWrapper&& Pool);
 
 #ifdef DEVELOPMENT
@@ -221,11 +225,58 @@ private:
 };
 
 
-// DynamicDescriptorSetAllocator manages dynamic descriptor sets. It first requests descriptor pool from
-// the global manager and allocates descriptor sets from this pool. When space in the pool is exhausted,
-// the class requests a new pool.
+// Identifies the contents of a dynamic descriptor set: the set layout, the unique ID of the pipeline
+// state and the unique IDs of the objects bound to the dynamic variables (buffers, buffer views,
+// texture views and samplers, including samplers assigned to texture views). Unique IDs are never
+// reused, so a cached set can't be matched by a new object that reuses a released object's Vulkan
+// handle. Cached sets are only reused within a frame.
+struct DynamicDescriptorSetKey
+{
+    VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+    std::vector<Uint64>   Data;
+    size_t                Hash   = 0;
+
+    void Reset(VkDescriptorSetLayout _Layout)
+    {
+        Layout = _Layout;
+        Data.clear();
+        Hash = 0;
+    }
+
+    void ComputeHash()
+    {
+        Hash = std::hash<VkDescriptorSetLayout>()(Layout);
+        for (auto Val : Data)
+            HashCombine(Hash, Val);
+    }
+
+    bool operator == (const DynamicDescriptorSetKey& rhs)const
+    {
+        return Hash   == rhs.Hash   &&
+               Layout == rhs.Layout &&
+               Data   == rhs.Data;
+    }
+
+    struct Hasher
+    {
+        size_t operator()(const DynamicDescriptorSetKey& Key)const
+        {
+            return Key.Hash;
+        }
+    };
+};
+
+// DynamicDescriptorSetAllocator manages dynamic descriptor sets. Every device context owns
+// its allocator that works as a descriptor pool arena. The allocator allocates descriptor sets from
+// its current pool. When space in the pool is exhausted, the allocator takes a pool from its
+// list of recycled pools, and only requests a new pool from the global manager if the list is empty.
 // The class is not thread-safe as device contexts must not be used in multiple threads simultaneously.
-// All allocated pools are recycled at the end of every frame.
+// All pools used during the frame are retired at the end of every frame as one batch. When the GPU
+// completes the frame, the pools are reset and returned to the allocator's recycled list without
+// locking the global manager.
+// The allocator also keeps the sets that have been written during the current frame, so that draw 
+// calls that bind identical dynamic resources can reuse the set instead of allocating and writing
+// a new one. The cache is cleared when the pools are recycled.
 //   ____________________________________________________________________________
 //  |                                                                            |
 //  |                           DynamicDescriptorSetAllocator                    |
@@ -247,24 +298,85 @@ class DynamicDescriptorSetAllocator
 public:
     DynamicDescriptorSetAllocator(DescriptorPoolManager& PoolMgr, std::string Name) : 
         m_GlobalPoolMgr{PoolMgr        },
-        m_Name         {std::move(Name)}
+        m_Name         {std::move(Name)},
+        m_Recycled     {std::make_shared<RecycledPools>()}
     {}
     ~DynamicDescriptorSetAllocator();
 
     VkDescriptorSet Allocate(VkDescriptorSetLayout SetLayout, const char* DebugName);
 
+    // Returns the set previously written with the same contents during the current frame,
+    // or VK_NULL_HANDLE if there is no such set. The key hash must have been computed.
+    VkDescriptorSet FindCachedSet(const DynamicDescriptorSetKey& Key);
+
+    // Adds the set that has been written with the contents identified by the key to the cache
+    void CacheSet(const DynamicDescriptorSetKey& Key, VkDescriptorSet Set);
+
     // Releases all allocated pools that are later returned to the global pool manager.
     // As global pool manager is hosted by the render device, the allocator can
     // be destroyed before the pools are actually returned to the global pool manager.
+    // All cached sets become invalid and are removed from the cache.
     void ReleasePools(Uint64 QueueMask);
 
     size_t GetAllocatedPoolCount()const{return m_AllocatedPools.size();}
 
+    struct ArenaStats
+    {
+        // The number of pools used by the current frame
+        Uint32 NumActivePools    = 0;
+        // The number of pools retired by previous frames that are still used by the GPU
+        Uint32 NumPendingPools   = 0;
+        // The number of reset pools ready for reuse
+        Uint32 NumRecycledPools  = 0;
+        // The maximum number of pools used by a single frame
+        Uint32 PeakPoolCount     = 0;
+        // The number of sets allocated during the current frame
+        Uint32 NumFrameSets      = 0;
+        // The total number of sets allocated by the arena
+        Uint64 TotalSets         = 0;
+        // The number of times the current pool was exhausted
+        Uint64 NumExhaustions    = 0;
+        // The number of pools requested from the global pool manager
+        Uint64 NumPoolsFromMgr   = 0;
+    };
+    ArenaStats GetArenaStats()const;
+
+    struct ReuseCacheStats
+    {
+        // The total number of cache lookups
+        Uint64 NumLookups = 0;
+        // The number of lookups that returned a cached set
+        Uint64 NumHits    = 0;
+    };
+    const ReuseCacheStats& GetReuseCacheStats()const{return m_ReuseCacheStats;}
+
 private:
+    VulkanUtilities::DescriptorPoolWrapper AcquirePool();
+
+    // Pools that are returned by the release queue. The structure is shared with
+    // the pool batches in the release queue that may outlive the allocator.
+    struct RecycledPools
+    {
+        std::mutex                                          Mtx;
+        std::vector<VulkanUtilities::DescriptorPoolWrapper> Pools;
+        Uint32                                              NumPending = 0;
+        // Set when the allocator is destroyed. Pools of pending batches are then returned to the global manager.
+        bool                                                Detached   = false;
+    };
+
     DescriptorPoolManager&                              m_GlobalPoolMgr;
     const std::string                                   m_Name;
     std::vector<VulkanUtilities::DescriptorPoolWrapper> m_AllocatedPools;
     size_t                                              m_PeakPoolCount = 0;
+    std::shared_ptr<RecycledPools>                      m_Recycled;
+
+    Uint32 m_NumFrameSets      = 0;
+    Uint64 m_TotalSets         = 0;
+    Uint64 m_NumExhaustions    = 0;
+    Uint64 m_NumPoolsFromMgr   = 0;
+
+    std::unordered_map<DynamicDescriptorSetKey, VkDescriptorSet, DynamicDescriptorSetKey::Hasher> m_CachedSets;
+    ReuseCacheStats                                     m_ReuseCacheStats;
 };
 
 }
@@ -40,6 +40,7 @@
 #include "BufferVkImpl.h"
 #include "TextureVkImpl.h"
 #include "PipelineStateVkImpl.h"
+#include "QueryVkImpl.h"
 #include "HashUtils.h"
 
 namespace Diligent
@@ -83,6 +84,8 @@ public:
 
     virtual void SetBlendFactors(const float* pBlendFactors = nullptr)override final;
 
+    virtual void SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)override final;
+
     virtual void SetVertexBuffers( Uint32                         StartSlot,
                                    Uint32                         NumBuffersSet,
                                    IBuffer**                      ppBuffers,
@@ -162,10 +165,16 @@ public:
 
     virtual void ExecuteCommandList(class ICommandList* pCommandList)override final;
 
+    virtual void ExecuteCommandLists(Uint32 NumCommandLists, class ICommandList* const* ppCommandLists)override final;
+
     virtual void SignalFence(IFence* pFence, Uint64 Value)override final;
 
     virtual void WaitForFence(IFence* pFence, Uint64 Value, bool FlushContext)override final;
 
+    virtual void BeginQuery(IQuery* pQuery)override final;
+
+    virtual void EndQuery(IQuery* pQuery)override final;
+
     virtual void WaitForIdle()override final;
 
     virtual void Flush()override final;
@@ -232,8 +241,16 @@ public:
 
     virtual void GenerateMips(ITextureView* pTexView)override final;
 
+    virtual void DefragmentMemory(Uint64 MaxBytesToMove)override final;
+
+    virtual void BeginSecondaryCommandList(Uint32 NumRenderTargets, ITextureView* ppRenderTargets[], ITextureView* pDepthStencil)override final;
+
+    virtual void ExecuteSecondaryCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists)override final;
+
     Uint32 GetContextId()const{return m_ContextId;}
 
+    Uint32 GetCommandQueueId()const{return m_CommandQueueId;}
+
     size_t GetNumCommandsInCtx()const { return m_State.NumCommands; }
 
     __forceinline VulkanUtilities::VulkanCommandBuffer& GetCommandBuffer()
@@ -253,6 +270,31 @@ public:
         return m_DynamicDescrSetAllocator.Allocate(SetLayout, DebugName);
     }
 
+    // Dynamic descriptor sets written during the current frame are cached and reused by
+    // the draw calls that bind identical dynamic resources
+    VkDescriptorSet FindCachedDynamicDescriptorSet(const DynamicDescriptorSetKey& Key)
+    {
+        return m_DynamicDescrSetAllocator.FindCachedSet(Key);
+    }
+
+    void CacheDynamicDescriptorSet(const DynamicDescriptorSetKey& Key, VkDescriptorSet Set)
+    {
+        m_DynamicDescrSetAllocator.CacheSet(Key, Set);
+    }
+
+    // The key object is reused by every commit to avoid memory allocations
+    DynamicDescriptorSetKey& GetDynamicDescriptorSetKey(){return m_DynamicDescrSetKey;}
+
+    const DynamicDescriptorSetAllocator::ReuseCacheStats& GetDynamicDescriptorSetReuseStats()const
+    {
+        return m_DynamicDescrSetAllocator.GetReuseCacheStats();
+    }
+
+    DynamicDescriptorSetAllocator::ArenaStats GetDescriptorPoolArenaStats()const
+    {
+        return m_DynamicDescrSetAllocator.GetArenaStats();
+    }
+
     VulkanDynamicAllocation AllocateDynamicSpace(Uint32 SizeInBytes, Uint32 Alignment);
 
     void ResetRenderTargets();
@@ -261,6 +303,9 @@ public:
     GenerateMipsVkHelper& GetGenerateMipsHelper(){return *m_GenerateMipsHelper;}
 
 private:
+    // Switches the buffers whose copies have been completed by the GPU to the new memory
+    void CompleteBufferMoves();
+
     void TransitionRenderTargets(RESOURCE_STATE_TRANSITION_MODE StateTransitionMode);
     __forceinline void CommitRenderPassAndFramebuffer(bool VerifyStates);
     void CommitVkVertexBuffers();
@@ -287,12 +332,26 @@ private:
         m_State.NumCommands = m_State.NumCommands != 0 ? m_State.NumCommands : 1;
         if (m_CommandBuffer.GetVkCmdBuffer() == VK_NULL_HANDLE)
         {
-            auto vkCmdBuff = m_CmdPool.GetCommandBuffer();
-            m_CommandBuffer.SetVkCmdBuffer(vkCmdBuff);
+            if (m_IsSecondaryCmdBuffer)
+            {
+                BeginSecondaryVkCmdBuffer();
+            }
+            else
+            {
+                auto vkCmdBuff = m_CmdPool.GetCommandBuffer();
+                m_CommandBuffer.SetVkCmdBuffer(vkCmdBuff);
+                if (!m_bIsDeferred)
+                    ResetStaleQueries();
+            }
         }
     }
+
+    // Records commands that reset queries returned to the query manager
+    void ResetStaleQueries();
     
-    inline void DisposeVkCmdBuffer(Uint32 CmdQueue, VkCommandBuffer vkCmdBuff, Uint64 FenceValue);
+    void BeginSecondaryVkCmdBuffer();
+
+    inline void DisposeVkCmdBuffer(Uint32 CmdQueue, VkCommandBuffer vkCmdBuff, Uint64 FenceValue, bool IsSecondary = false);
     inline void DisposeCurrentCmdBuffer(Uint32 CmdQueue, Uint64 FenceValue);
 
     struct BufferToTextureCopyInfo
@@ -331,6 +390,7 @@ private:
     __forceinline void PrepareForIndexedDraw(DRAW_FLAGS Flags, VALUE_TYPE IndexType);
     __forceinline BufferVkImpl* PrepareIndirectDrawAttribsBuffer(IBuffer* pAttribsBuffer, RESOURCE_STATE_TRANSITION_MODE TransitonMode);
     __forceinline void PrepareForDispatchCompute();
+    __forceinline void CommitPushConstants();
 
     void DvpLogRenderPass_PSOMismatch();
 
@@ -345,6 +405,9 @@ private:
         /// Flag indicating if currently committed index buffer is up to date
         bool CommittedIBUpToDate = false;
 
+        /// Flag indicating if push constants in the command buffer are up to date
+        bool CommittedPushConstantsUpToDate = false;
+
         Uint32 NumCommands = 0;
     }m_State;
 
@@ -369,6 +432,22 @@ private:
 
     std::unordered_map<BufferVkImpl*, VulkanUploadAllocation> m_UploadAllocations;
 
+    // Buffers that are being moved by the memory defragmentation
+    struct PendingBufferMove
+    {
+        // Fence value that is signaled when the copy is complete.
+        // Maximum value indicates that the copy has not been submitted yet.
+        Uint64                                  FenceValue = ~Uint64{0};
+        RefCntAutoPtr<BufferVkImpl>             pBuffer;
+        VulkanUtilities::BufferWrapper          NewBuffer;
+        VulkanUtilities::VulkanMemoryAllocation NewAllocation;
+    };
+    std::vector<PendingBufferMove> m_PendingBufferMoves;
+
+    // Queries that have been ended in the current command buffer. The fence value that
+    // indicates the availability of the query data is set when the context is flushed.
+    std::vector<RefCntAutoPtr<QueryVkImpl>> m_EndedQueries;
+
     struct MappedTextureKey
     {
         TextureVkImpl* const Texture;
@@ -397,13 +476,27 @@ private:
     std::unordered_map<MappedTextureKey, MappedTexture, MappedTextureKey::Hasher> m_MappedTextures;
 
     VulkanUtilities::VulkanCommandBufferPool m_CmdPool;
+
+    // Pool of secondary command buffers that is created by deferred contexts
+    // the first time BeginSecondaryCommandList() is called
+    std::unique_ptr<VulkanUtilities::VulkanCommandBufferPool> m_SecondaryCmdPool;
+    // Indicates that the deferred context records a secondary command buffer
+    bool m_IsSecondaryCmdBuffer = false;
+    // Secondary command buffers executed by the immediate context that are
+    // disposed when the primary command buffer is submitted
+    std::vector<std::pair<RefCntAutoPtr<DeviceContextVkImpl>, VkCommandBuffer>> m_PendingSecondaryCmdBuffers;
     VulkanUploadHeap                         m_UploadHeap;
     VulkanDynamicHeap                        m_DynamicHeap;
     DynamicDescriptorSetAllocator            m_DynamicDescrSetAllocator;
+    DynamicDescriptorSetKey                  m_DynamicDescrSetKey;
 
     PipelineLayout::DescriptorSetBindInfo m_DescrSetBindInfo;
     std::shared_ptr<GenerateMipsVkHelper> m_GenerateMipsHelper;
     RefCntAutoPtr<IShaderResourceBinding> m_GenerateMipsSRB;
+    // Null if the device does not support single-pass mip generation
+    RefCntAutoPtr<IShaderResourceBinding> m_GenerateMipsSinglePassSRB;
+    // Single-pass mip generation counters that are only used by this context
+    RefCntAutoPtr<IBuffer>                m_GenerateMipsSinglePassCounters;
 
     // In Vulkan we can't bind null vertex buffer, so we have to create a dummy VB
     RefCntAutoPtr<BufferVkImpl> m_DummyVB;
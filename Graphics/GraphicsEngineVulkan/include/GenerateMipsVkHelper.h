@@ -47,22 +47,41 @@ namespace Diligent
         GenerateMipsVkHelper& operator = (const GenerateMipsVkHelper&)  = delete;
         GenerateMipsVkHelper& operator = (      GenerateMipsVkHelper&&) = delete;
 
-        void GenerateMips(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB);
-        void CreateSRB(IShaderResourceBinding** ppSRB);
+        // pSinglePassSRB and pSinglePassCounters may be null if the device does not support single-pass mip generation
+        void GenerateMips(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, IShaderResourceBinding* pSinglePassSRB, IBuffer* pSinglePassCounters);
+        // *ppSinglePassSRB and *ppSinglePassCounters are set to null if single-pass mip generation is not supported.
+        // The counters are updated by every single-pass dispatch, so every device context must use its own
+        // counters buffer, which is bound to the single-pass SRB.
+        void CreateSRB(IShaderResourceBinding** ppSRB, IShaderResourceBinding** ppSinglePassSRB, IBuffer** ppSinglePassCounters);
         void WarmUpCache(TEXTURE_FORMAT Fmt);
 
+        // Maximum number of mip levels generated by one single-pass dispatch
+        static constexpr Uint32 MaxSinglePassMips = 12;
+
     private:
         std::array<RefCntAutoPtr<IPipelineState>, 4>  CreatePSOs(TEXTURE_FORMAT Fmt);
         std::array<RefCntAutoPtr<IPipelineState>, 4>& FindPSOs  (TEXTURE_FORMAT Fmt);
 
-        VkImageLayout GenerateMipsCS  (TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, VkImageSubresourceRange& SubresRange);
-        VkImageLayout GenerateMipsBlit(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, VkImageSubresourceRange& SubresRange)const;
+        RefCntAutoPtr<IPipelineState>  CreateSinglePassPSO(TEXTURE_FORMAT Fmt);
+        RefCntAutoPtr<IPipelineState>& FindSinglePassPSO  (TEXTURE_FORMAT Fmt);
+
+        bool CanGenerateMipsInSinglePass(const TextureViewVkImpl& TexView)const;
+
+        VkImageLayout GenerateMipsSinglePass(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, IBuffer& Counters, VkImageSubresourceRange& SubresRange);
+        VkImageLayout GenerateMipsCS        (TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, VkImageSubresourceRange& SubresRange);
+        VkImageLayout GenerateMipsBlit      (TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, VkImageSubresourceRange& SubresRange)const;
 
         RenderDeviceVkImpl& m_DeviceVkImpl;
 
         std::mutex m_PSOMutex;
 	    std::unordered_map< TEXTURE_FORMAT, std::array<RefCntAutoPtr<IPipelineState>, 4> > m_PSOHash;
+        std::unordered_map< TEXTURE_FORMAT, RefCntAutoPtr<IPipelineState> >                 m_SinglePassPSOHash;
         static void GetGlImageFormat(const TextureFormatAttribs& FmtAttribs, std::array<char, 16>& GlFmt);
         RefCntAutoPtr<IBuffer> m_ConstantsCB;
+
+        // Single-pass mip generation requires 256 threads per group and a buffer
+        // with one atomic counter per array slice
+        bool                   m_SinglePassSupported = false;
+        Uint32                 m_MaxSinglePassSlices = 0;
     };
 }
@@ -50,6 +50,11 @@ public:
     void Release(RenderDeviceVkImpl* pDeviceVkImpl, Uint64 CommandQueueMask);
     void Finalize(const VulkanUtilities::VulkanLogicalDevice& LogicalDevice);
 
+    // Push constant range must be set before the layout is finalized.
+    // ShaderStages is a combination of SHADER_TYPE flags.
+    void SetPushConstantRange(Uint32 ShaderStages, Uint32 Size);
+    const VkPushConstantRange& GetPushConstantRange()const{return m_LayoutMgr.GetPushConstantRange();}
+
     VkPipelineLayout GetVkPipelineLayout()const{return m_LayoutMgr.GetVkPipelineLayout();}
     std::array<Uint32, 2> GetDescriptorSetSizes(Uint32& NumSets)const;
     void InitResourceCache(RenderDeviceVkImpl*    pDeviceVkImpl,
@@ -193,6 +198,15 @@ private:
         size_t GetHash()const;
         VkPipelineLayout GetVkPipelineLayout()const{return m_VkPipelineLayout;}
 
+        void SetPushConstantRange(VkShaderStageFlags StageFlags, Uint32 Size)
+        {
+            VERIFY(m_VkPipelineLayout == VK_NULL_HANDLE, "Pipeline layout must not be finalized");
+            m_PushConstantRange.stageFlags = Size != 0 ? StageFlags : 0;
+            m_PushConstantRange.offset     = 0;
+            m_PushConstantRange.size       = Size;
+        }
+        const VkPushConstantRange& GetPushConstantRange()const{return m_PushConstantRange;}
+
         void AllocateResourceSlot(const SPIRVShaderResourceAttribs& ResAttribs,
                                   SHADER_RESOURCE_VARIABLE_TYPE     VariableType,
                                   VkSampler                         vkImmutableSampler,
@@ -206,6 +220,7 @@ private:
         VulkanUtilities::PipelineLayoutWrapper m_VkPipelineLayout;
         std::array<DescriptorSetLayout, 2> m_DescriptorSetLayouts;
         std::vector<VkDescriptorSetLayoutBinding, STDAllocatorRawMem<VkDescriptorSetLayoutBinding>> m_LayoutBindings;
+        VkPushConstantRange m_PushConstantRange = {};
         uint8_t m_ActiveSets = 0;
     };
 
@@ -138,7 +138,10 @@ private:
     // SRB memory allocator must be declared before m_pDefaultShaderResBinding
     SRBMemoryAllocator m_SRBMemAllocator;
     
-    std::array<VulkanUtilities::ShaderModuleWrapper, MaxShadersInPipeline> m_ShaderModules;
+    // Shader modules are owned by the device shader module cache
+    // Modules are returned to the cache when the references are destroyed, which also
+    // happens if the constructor throws after some of the modules have been acquired
+    std::array<ShaderModuleCache::ModuleRef, MaxShadersInPipeline> m_ShaderModules;
 
     VkRenderPass m_RenderPass = VK_NULL_HANDLE; // Render passes are managed by the render device
     VulkanUtilities::PipelineWrapper m_Pipeline;
@@ -0,0 +1,125 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::QueryManagerVk class
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "GraphicsTypes.h"
+#include "VulkanUtilities/VulkanObjectWrappers.h"
+#include "VulkanUtilities/VulkanCommandBuffer.h"
+
+namespace Diligent
+{
+
+class RenderDeviceVkImpl;
+
+// Query manager owns one Vulkan query pool for every query type and allocates queries from the pools.
+// A query that is no longer used is discarded through the release queue and is returned to the 
+// manager as stale when the GPU has completed all commands that may reference it.
+// Stale queries must be reset before they can be allocated again. The resets are recorded into
+// the command buffers of the immediate context by ResetStaleQueries().
+class QueryManagerVk
+{
+public:
+    QueryManagerVk(RenderDeviceVkImpl&       DeviceVkImpl,
+                   const EngineVkCreateInfo& EngineCI,
+                   uint32_t                  QueueFamilyIndex);
+    ~QueryManagerVk();
+
+    QueryManagerVk             (const QueryManagerVk&)  = delete;
+    QueryManagerVk             (      QueryManagerVk&&) = delete;
+    QueryManagerVk& operator = (const QueryManagerVk&)  = delete;
+    QueryManagerVk& operator = (      QueryManagerVk&&) = delete;
+
+    static constexpr Uint32 InvalidIndex = static_cast<Uint32>(-1);
+
+    // Returns the index of a query that has been reset and is ready to use,
+    // or InvalidIndex if there are no such queries in the pool.
+    Uint32 AllocateQuery(QUERY_TYPE Type);
+
+    // Returns the query to the manager when the GPU has completed all commands 
+    // that have been submitted to the queues indicated by QueueMask.
+    void DiscardQuery(QUERY_TYPE Type, Uint32 Index, Uint64 QueueMask);
+
+    // Records commands that reset all stale queries. Returns the number of queries that were reset.
+    // Render pass, if any, is ended by the command buffer.
+    Uint32 ResetStaleQueries(VulkanUtilities::VulkanCommandBuffer& CmdBuff);
+
+    bool HasStaleQueries()const
+    {
+        return m_NumStaleQueries.load() != 0;
+    }
+
+    // Returns VK_NULL_HANDLE if the query type is not supported by the device
+    VkQueryPool GetQueryPool(QUERY_TYPE Type)const
+    {
+        return m_Pools[Type].vkQueryPool;
+    }
+
+    VkQueryPipelineStatisticFlags GetPipelineStatisticsFlags()const { return m_PipelineStatisticsFlags; }
+    VkQueryControlFlags           GetOcclusionQueryFlags()    const { return m_OcclusionQueryFlags;     }
+
+    // Timestamp counter frequency, in ticks per second
+    Uint64 GetCounterFrequency()const { return m_CounterFrequency; }
+
+    // Mask of the timestamp bits that are written by the queue
+    Uint64 GetTimestampMask()const { return m_TimestampMask; }
+
+private:
+    class StaleQueryRecycler;
+    void RecycleStaleQuery(QUERY_TYPE Type, Uint32 Index);
+
+    struct QueryPoolInfo
+    {
+        VulkanUtilities::QueryPoolWrapper vkQueryPool;
+
+        // Queries that have been reset and can be allocated
+        std::vector<Uint32> AvailableQueries;
+
+        // Queries that must be reset before they can be allocated
+        std::vector<Uint32> StaleQueries;
+
+        Uint32 PoolSize            = 0;
+        Uint32 MaxAllocatedQueries = 0;
+    };
+
+    RenderDeviceVkImpl& m_DeviceVkImpl;
+
+    std::mutex                                      m_PoolsMtx;
+    std::array<QueryPoolInfo, QUERY_TYPE_NUM_TYPES> m_Pools;
+    std::atomic<Uint32>                             m_NumStaleQueries{0};
+
+    VkQueryPipelineStatisticFlags m_PipelineStatisticsFlags = 0;
+    VkQueryControlFlags           m_OcclusionQueryFlags     = 0;
+    Uint64                        m_CounterFrequency        = 0;
+    Uint64                        m_TimestampMask           = 0;
+};
+
+}
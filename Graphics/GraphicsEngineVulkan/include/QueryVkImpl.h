@@ -0,0 +1,97 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::QueryVkImpl class
+
+#include <array>
+#include "QueryVk.h"
+#include "QueryBase.h"
+#include "QueryManagerVk.h"
+#include "RenderDeviceVkImpl.h"
+
+namespace Diligent
+{
+
+class DeviceContextVkImpl;
+
+/// Implementation of the Diligent::IQueryVk interface
+class QueryVkImpl final : public QueryBase<IQueryVk, RenderDeviceVkImpl>
+{
+public:
+    using TQueryBase = QueryBase<IQueryVk, RenderDeviceVkImpl>;
+
+    QueryVkImpl(IReferenceCounters* pRefCounters,
+                RenderDeviceVkImpl* pRendeDeviceVkImpl,
+                const QueryDesc&    Desc,
+                bool                IsDeviceInternal = false);
+    ~QueryVkImpl();
+
+    IMPLEMENT_QUERY_INTERFACE_IN_PLACE(IID_QueryVk, TQueryBase);
+
+    virtual bool GetData(void* pData, Uint32 DataSize)override final;
+
+    // Allocates query pool slots. Returns false if the query must not be begun.
+    bool OnBeginQuery(DeviceContextVkImpl* pContext);
+    bool OnEndQuery(DeviceContextVkImpl* pContext);
+
+    // Sets the value of the command queue fence that is signaled when the
+    // command buffer containing the end of the query completes
+    void SetQueryEndFenceValue(Uint64 FenceValue)
+    {
+        m_QueryEndFenceValue = FenceValue;
+    }
+
+    Uint32 GetQueryPoolIndex(Uint32 Index)const
+    {
+        return m_QueryPoolIndex[Index];
+    }
+
+    // Queries begun inside a render pass must be ended in the same subpass
+    void SetBegunInsideRenderPass(bool BegunInsideRenderPass)
+    {
+        m_BegunInsideRenderPass = BegunInsideRenderPass;
+    }
+
+    bool IsBegunInsideRenderPass()const
+    {
+        return m_BegunInsideRenderPass;
+    }
+
+private:
+    bool AllocateQueries();
+    void DiscardQueries();
+
+    // Duration queries use two timestamps from the same pool
+    std::array<Uint32, 2> m_QueryPoolIndex = {QueryManagerVk::InvalidIndex, QueryManagerVk::InvalidIndex};
+
+    Uint32 m_CmdQueueId         = 0;
+    Uint64 m_QueryEndFenceValue = ~Uint64{0};
+
+    bool m_BegunInsideRenderPass = false;
+};
+
+}
@@ -26,6 +26,11 @@
 /// \file
 /// Declaration of Diligent::RenderDeviceVkImpl class
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <array>
+#include <unordered_map>
 
 #include "RenderDeviceVk.h"
 #include "RenderDeviceBase.h"
@@ -43,12 +48,16 @@
 #include "VulkanUploadHeap.h"
 #include "FramebufferCache.h"
 #include "RenderPassCache.h"
+#include "ShaderModuleCache.h"
 #include "CommandPoolManager.h"
 #include "VulkanDynamicHeap.h"
+#include "QueryManagerVk.h"
 
 namespace Diligent
 {
 
+class BufferVkImpl;
+
 /// Implementation of the Diligent::IRenderDeviceVk interface
 class RenderDeviceVkImpl final : public RenderDeviceNextGenBase<RenderDeviceBase<IRenderDeviceVk>, ICommandQueueVk>
 {
@@ -82,6 +91,8 @@ public:
 
     virtual void CreateFence(const FenceDesc& Desc, IFence** ppFence)override final;
 
+    virtual void CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)override final;
+
     virtual VkDevice GetVkDevice()override final{ return m_LogicalVkDevice->GetVkDevice();}
     
     virtual void CreateTextureFromVulkanImage(VkImage vkImage, const TextureDesc& TexDesc, RESOURCE_STATE InitialState, ITexture** ppTexture)override final;
@@ -111,16 +122,51 @@ public:
     const VulkanUtilities::VulkanLogicalDevice&            GetLogicalDevice ()      { return *m_LogicalVkDevice;}
     FramebufferCache&                                      GetFramebufferCache()    { return m_FramebufferCache;}
     RenderPassCache&                                       GetRenderPassCache()     { return m_RenderPassCache;}
+    ShaderModuleCache&                                     GetShaderModuleCache()   { return m_ShaderModuleCache;}
 
     VulkanUtilities::VulkanMemoryAllocation AllocateMemory(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProperties)
     {
         return m_MemoryMgr.Allocate(MemReqs, MemoryProperties);
     }
+    VulkanUtilities::VulkanMemoryAllocation AllocateBufferMemory(VkBuffer vkBuffer, const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProperties)
+    {
+        return m_MemoryMgr.AllocateForBuffer(vkBuffer, MemReqs, MemoryProperties);
+    }
+    VulkanUtilities::VulkanMemoryAllocation AllocateImageMemory(VkImage vkImage, const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProperties)
+    {
+        return m_MemoryMgr.AllocateForImage(vkImage, MemReqs, MemoryProperties);
+    }
     VulkanUtilities::VulkanMemoryManager& GetGlobalMemoryManager() { return m_MemoryMgr; }
 
     VulkanDynamicMemoryManager& GetDynamicMemoryManager() { return m_DynamicMemoryManager; }
+
+    QueryManagerVk& GetQueryManager() { return m_QueryMgr; }
     void FlushStaleResources(Uint32 CmdQueueIndex);
 
+    virtual void GetMemoryDefragmentationStats(MemoryDefragmentationStatsVk& Stats)override final;
+
+    virtual Uint32 GetMemoryHeapCount()override final;
+
+    virtual void GetMemoryHeapUsage(Uint32 HeapIndex, MemoryHeapUsageVk& HeapUsage)override final;
+
+    virtual void SetMemoryBudgetCallback(MemoryBudgetCallbackType Callback, void* pUserData, float HighWatermark, float CriticalWatermark)override final;
+
+    virtual void GetShaderModuleCacheStats(ShaderModuleCacheStatsVk& Stats)override final;
+
+    // Movable buffers are tracked by the device so that defragmentation can find 
+    // the buffers whose memory is located in sparse pages
+    void RegisterMovableBuffer  (BufferVkImpl& Buffer);
+    void UnregisterMovableBuffer(BufferVkImpl& Buffer);
+
+    // Selects buffers to move out of memory pages with low occupancy. The total size of the selected
+    // buffers does not exceed MaxBytesToMove, except that at least one buffer is selected if there is any.
+    void SelectBuffersToDefragment(Uint64 MaxBytesToMove, std::vector<RefCntAutoPtr<BufferVkImpl>>& Buffers);
+    void OnBufferMoved(Uint64 Size)
+    {
+        m_NumMovedBuffers.fetch_add(1);
+        m_MovedBytes.fetch_add(Size);
+    }
+
 private:
     virtual void TestTextureFormat( TEXTURE_FORMAT TexFormat )override final;
 
@@ -131,6 +177,11 @@ private:
     //      * SubmittedFenceValue    - fence value associated with the submitted command buffer
     void SubmitCommandBuffer(Uint32 QueueIndex, const VkSubmitInfo& SubmitInfo, Uint64& SubmittedCmdBuffNumber, Uint64& SubmittedFenceValue, std::vector<std::pair<Uint64, RefCntAutoPtr<IFence> > >* pFences);
 
+    // Fills in Budget and Usage of every heap, using VK_EXT_memory_budget if it is enabled
+    void QueryMemoryBudget(MemoryHeapUsageVk HeapUsage[], Uint32 HeapCount);
+    // Calls the memory budget callback for every heap whose pressure level has changed
+    void CheckMemoryBudget();
+
     std::shared_ptr<VulkanUtilities::VulkanInstance>        m_VulkanInstance;
     std::unique_ptr<VulkanUtilities::VulkanPhysicalDevice>  m_PhysicalDevice;
     std::shared_ptr<VulkanUtilities::VulkanLogicalDevice>   m_LogicalVkDevice;
@@ -139,6 +190,7 @@ private:
 
     FramebufferCache       m_FramebufferCache;
     RenderPassCache        m_RenderPassCache;
+    ShaderModuleCache      m_ShaderModuleCache;
     DescriptorSetAllocator m_DescriptorSetAllocator;
     DescriptorPoolManager  m_DynamicDescriptorPool;
 
@@ -150,6 +202,23 @@ private:
     VulkanUtilities::VulkanMemoryManager m_MemoryMgr;
 
     VulkanDynamicMemoryManager m_DynamicMemoryManager;
+
+    QueryManagerVk m_QueryMgr;
+
+    std::mutex                                                      m_MovableBuffersMtx;
+    std::unordered_map<BufferVkImpl*, RefCntWeakPtr<BufferVkImpl>> m_MovableBuffers;
+    std::atomic<Uint64> m_NumMovedBuffers{0};
+    std::atomic<Uint64> m_MovedBytes{0};
+
+    // Null if VK_EXT_memory_budget extension is not enabled
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR m_vkGetPhysicalDeviceMemoryProperties2 = nullptr;
+
+    std::mutex               m_MemoryBudgetMtx;
+    MemoryBudgetCallbackType m_MemoryBudgetCallback     = nullptr;
+    void*                    m_pMemoryBudgetUserData    = nullptr;
+    float                    m_MemoryHighWatermark      = 0.8f;
+    float                    m_MemoryCriticalWatermark  = 0.95f;
+    std::array<MEMORY_PRESSURE_LEVEL, VK_MAX_MEMORY_HEAPS> m_MemoryPressureLevels = {};
 };
 
 }
@@ -0,0 +1,157 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::ShaderModuleCache class
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include "BasicTypes.h"
+#include "VulkanUtilities/VulkanObjectWrappers.h"
+
+namespace Diligent
+{
+
+class RenderDeviceVkImpl;
+struct ShaderModuleCacheStatsVk;
+
+/// Device-wide cache of Vulkan shader modules. 
+
+/// Modules are keyed by the final SPIR-V byte code, i.e. after resource bindings have
+/// been remapped by the pipeline resource layout, so that pipelines that use the same
+/// shader with identical bindings share the module and skip the strip-reflection pass.
+/// Every module returned by GetShaderModule() is reference-counted and is returned to
+/// the cache when the ModuleRef is destroyed. The module is destroyed when the last reference is released.
+class ShaderModuleCache
+{
+public:
+    /// Move-only reference to a cached shader module
+    class ModuleRef
+    {
+    public:
+        ModuleRef()noexcept {}
+
+        ModuleRef(ShaderModuleCache& Cache, VkShaderModule vkModule, Uint64 QueueMask)noexcept :
+            m_pCache   {&Cache   },
+            m_vkModule {vkModule },
+            m_QueueMask{QueueMask}
+        {}
+
+        ModuleRef(ModuleRef&& rhs)noexcept :
+            m_pCache   {rhs.m_pCache   },
+            m_vkModule {rhs.m_vkModule },
+            m_QueueMask{rhs.m_QueueMask}
+        {
+            rhs.m_pCache   = nullptr;
+            rhs.m_vkModule = VK_NULL_HANDLE;
+        }
+
+        ModuleRef& operator = (ModuleRef&& rhs)noexcept
+        {
+            Release();
+            m_pCache       = rhs.m_pCache;
+            m_vkModule     = rhs.m_vkModule;
+            m_QueueMask    = rhs.m_QueueMask;
+            rhs.m_pCache   = nullptr;
+            rhs.m_vkModule = VK_NULL_HANDLE;
+            return *this;
+        }
+
+        ModuleRef             (const ModuleRef&) = delete;
+        ModuleRef& operator = (const ModuleRef&) = delete;
+
+        ~ModuleRef()
+        {
+            Release();
+        }
+
+        void Release()
+        {
+            if (m_pCache != nullptr && m_vkModule != VK_NULL_HANDLE)
+                m_pCache->ReleaseShaderModule(m_vkModule, m_QueueMask);
+            m_pCache   = nullptr;
+            m_vkModule = VK_NULL_HANDLE;
+        }
+
+        operator VkShaderModule()const{return m_vkModule;}
+
+    private:
+        ShaderModuleCache* m_pCache    = nullptr;
+        VkShaderModule     m_vkModule  = VK_NULL_HANDLE;
+        Uint64             m_QueueMask = 0;
+    };
+
+    ShaderModuleCache(RenderDeviceVkImpl& DeviceVk)noexcept : 
+        m_DeviceVkImpl(DeviceVk)
+    {}
+
+    ShaderModuleCache             (const ShaderModuleCache&) = delete;
+    ShaderModuleCache             (ShaderModuleCache&&)      = delete;
+    ShaderModuleCache& operator = (const ShaderModuleCache&) = delete;
+    ShaderModuleCache& operator = (ShaderModuleCache&&)      = delete;
+
+    ~ShaderModuleCache();
+
+    // QueueMask is the mask of the command queues that may use the module. It is used
+    // to safely release the module when the last reference is released.
+    ModuleRef GetShaderModule(const std::vector<uint32_t>& SPIRV, const char* DebugName, Uint64 QueueMask);
+
+    void GetStats(ShaderModuleCacheStatsVk& Stats);
+
+private:
+    void ReleaseShaderModule(VkShaderModule vkModule, Uint64 QueueMask);
+
+    struct CachedModule
+    {
+        CachedModule(std::vector<uint32_t> _SPIRV, VulkanUtilities::ShaderModuleWrapper&& _Module) :
+            SPIRV {std::move(_SPIRV) },
+            Module{std::move(_Module)}
+        {}
+
+        // Remapped SPIR-V the module was created from. It is compared on every lookup
+        // to rule out hash collisions.
+        std::vector<uint32_t>                SPIRV;
+        VulkanUtilities::ShaderModuleWrapper Module;
+        Uint32                               RefCount = 1;
+    };
+
+    using CacheType = std::unordered_multimap<size_t, CachedModule>;
+
+    CacheType::iterator Find(size_t Hash, const std::vector<uint32_t>& SPIRV);
+
+    RenderDeviceVkImpl& m_DeviceVkImpl;
+
+    std::mutex m_Mutex;
+    CacheType  m_Cache;
+    std::unordered_map<VkShaderModule, size_t> m_ModuleHashes;
+
+    Uint64 m_NumLookups      = 0;
+    Uint64 m_NumHits         = 0;
+    double m_TotalCreateTime = 0;
+    size_t m_SPIRVSize       = 0;
+};
+
+}
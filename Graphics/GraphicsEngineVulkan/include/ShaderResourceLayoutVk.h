@@ -282,6 +282,11 @@ public:
     void CommitDynamicResources(const ShaderResourceCacheVk& ResourceCache,
                                 VkDescriptorSet              vkDynamicDescriptorSet)const;
 
+    // Appends the unique IDs of all objects that CommitDynamicResources() would write to the 
+    // dynamic descriptor set. Two sets written with the same data have identical contents.
+    void GetDynamicResourceIDs(const ShaderResourceCacheVk& ResourceCache,
+                               std::vector<Uint64>&         IDs)const;
+
     const Char* GetShaderName()const
     {
         return m_pResources->GetShaderName();
@@ -60,6 +60,8 @@ public:
     {
         return m_SPIRV;
     }
+
+    virtual void SerializeResources(IDataBlob** ppData)const override final;
     
     const std::shared_ptr<const SPIRVShaderResources>& GetShaderResources()const{return m_pShaderResources;}
     const char* GetEntryPoint() const { return m_EntryPoint.c_str(); }
@@ -118,6 +118,7 @@ public:
     VulkanDynamicMemoryManager(IMemoryAllocator&         Allocator, 
                                class RenderDeviceVkImpl& DeviceVk, 
                                Uint32                    Size,
+                               Uint32                    PageSize,
                                Uint64                    CommandQueueMask);
     ~VulkanDynamicMemoryManager();
 
@@ -142,6 +143,9 @@ private:
     Uint8*                               m_CPUAddress;
     const VkDeviceSize                   m_DefaultAlignment;
     const Uint64                         m_CommandQueueMask;
+    // Memory type and size of the buffer memory that are reported in the heap statistics
+    uint32_t                             m_MemoryTypeIndex = 0;
+    VkDeviceSize                         m_MemorySize      = 0;
     OffsetType  m_TotalPeakSize    = 0;
 };
 
@@ -145,7 +145,11 @@ namespace VulkanUtilities
             vkCmdDispatchIndirect(m_VkCmdBuffer, Buffer, Offset);
         }
 
-        __forceinline void BeginRenderPass(VkRenderPass RenderPass, VkFramebuffer Framebuffer, uint32_t FramebufferWidth, uint32_t FramebufferHeight)
+        __forceinline void BeginRenderPass(VkRenderPass      RenderPass,
+                                           VkFramebuffer     Framebuffer,
+                                           uint32_t          FramebufferWidth,
+                                           uint32_t          FramebufferHeight,
+                                           VkSubpassContents Contents = VK_SUBPASS_CONTENTS_INLINE)
         {
             VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
             VERIFY(m_State.RenderPass == VK_NULL_HANDLE, "Current pass has not been ended");
@@ -167,11 +171,11 @@ namespace VulkanUtilities
                                                   // corresponding to cleared attachments are used. Other elements of pClearValues are 
                                                   // ignored (7.4)
 
-                vkCmdBeginRenderPass(m_VkCmdBuffer, &BeginInfo, 
-                    VK_SUBPASS_CONTENTS_INLINE // the contents of the subpass will be recorded inline in the 
-                                               // primary command buffer, and secondary command buffers must not 
-                                               // be executed within the subpass
-                );
+                // VK_SUBPASS_CONTENTS_INLINE specifies that the contents of the subpass will be recorded inline in the 
+                // primary command buffer, and secondary command buffers must not be executed within the subpass.
+                // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS specifies that the contents are recorded in secondary
+                // command buffers, and vkCmdExecuteCommands is the only valid command in the subpass (7.4)
+                vkCmdBeginRenderPass(m_VkCmdBuffer, &BeginInfo, Contents);
                 m_State.RenderPass = RenderPass;
                 m_State.Framebuffer = Framebuffer;
                 m_State.FramebufferWidth = FramebufferWidth;
@@ -179,11 +183,48 @@ namespace VulkanUtilities
             }
         }
 
+        // Secondary command buffers that continue the render pass begun by the primary
+        // command buffer start recording inside that pass
+        __forceinline void SetInheritedRenderPass(VkRenderPass RenderPass, VkFramebuffer Framebuffer, uint32_t FramebufferWidth, uint32_t FramebufferHeight)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            VERIFY(m_State.RenderPass == VK_NULL_HANDLE, "Render pass must be set before any command is recorded");
+            m_State.RenderPass            = RenderPass;
+            m_State.Framebuffer           = Framebuffer;
+            m_State.FramebufferWidth      = FramebufferWidth;
+            m_State.FramebufferHeight     = FramebufferHeight;
+            m_State.IsRenderPassInherited = true;
+        }
+
+        __forceinline void ExecuteCommands(uint32_t CommandBufferCount, const VkCommandBuffer* pCommandBuffers)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            VERIFY(m_State.RenderPass != VK_NULL_HANDLE, "Secondary command buffers that continue render pass must be executed inside render pass");
+            vkCmdExecuteCommands(m_VkCmdBuffer, CommandBufferCount, pCommandBuffers);
+            // All state bound in the primary command buffer is undefined after
+            // vkCmdExecuteCommands, except for the render pass and subpass
+            m_State.GraphicsPipeline  = VK_NULL_HANDLE;
+            m_State.ComputePipeline   = VK_NULL_HANDLE;
+            m_State.IndexBuffer       = VK_NULL_HANDLE;
+            m_State.IndexBufferOffset = 0;
+            m_State.IndexType         = VK_INDEX_TYPE_MAX_ENUM;
+        }
+
         __forceinline void EndRenderPass()
         {
             VERIFY(m_State.RenderPass != VK_NULL_HANDLE, "Render pass has not been started");
             VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            if (m_State.IsRenderPassInherited)
+            {
+                // Commands that require ending the render pass (copies, dispatches, layout transitions, etc.)
+                // must not be recorded into secondary command buffers
+                LOG_ERROR_MESSAGE("Render pass inherited by the secondary command buffer can't be ended. "
+                                  "Commands that require ending the render pass are not allowed in secondary command lists.");
+                return;
+            }
+            VERIFY(m_State.NumActiveRenderPassQueries == 0, "A query that is begun inside a render pass must be ended in the same subpass");
             vkCmdEndRenderPass(m_VkCmdBuffer);
+            m_State.NumActiveRenderPassQueries = 0;
             m_State.RenderPass  = VK_NULL_HANDLE;
             m_State.Framebuffer = VK_NULL_HANDLE;
             m_State.FramebufferWidth  = 0;
@@ -248,6 +289,12 @@ namespace VulkanUtilities
             vkCmdSetBlendConstants(m_VkCmdBuffer, BlendConstants);
         }
 
+        __forceinline void PushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            vkCmdPushConstants(m_VkCmdBuffer, layout, stageFlags, offset, size, pValues);
+        }
+
         __forceinline void BindIndexBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkIndexType IndexType)
         {
             VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
@@ -412,6 +459,65 @@ namespace VulkanUtilities
             vkCmdBlitImage(m_VkCmdBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
         }
 
+        __forceinline void ResetQueryPool(VkQueryPool queryPool,
+                                          uint32_t    firstQuery,
+                                          uint32_t    queryCount)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            if (m_State.RenderPass != VK_NULL_HANDLE)
+            {
+                // Query pool reset must be performed outside of render pass.
+                EndRenderPass();
+            }
+            vkCmdResetQueryPool(m_VkCmdBuffer, queryPool, firstQuery, queryCount);
+        }
+
+        __forceinline void BeginQuery(VkQueryPool         queryPool,
+                                      uint32_t            query,
+                                      VkQueryControlFlags flags)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            // Occlusion and pipeline statistics queries can be begun both inside and outside of render pass.
+            // A query that is begun inside a render pass must be ended in the same subpass, while
+            // queries begun outside of render pass may span multiple render pass instances.
+            if (m_State.RenderPass != VK_NULL_HANDLE)
+                ++m_State.NumActiveRenderPassQueries;
+            ++m_State.NumActiveQueries;
+            vkCmdBeginQuery(m_VkCmdBuffer, queryPool, query, flags);
+        }
+
+        __forceinline void EndQuery(VkQueryPool queryPool,
+                                    uint32_t    query,
+                                    bool        BegunInsideRenderPass)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            if (BegunInsideRenderPass)
+            {
+                VERIFY(m_State.RenderPass != VK_NULL_HANDLE && m_State.NumActiveRenderPassQueries > 0,
+                       "The query has been begun inside a render pass that has already been ended");
+                if (m_State.NumActiveRenderPassQueries > 0)
+                    --m_State.NumActiveRenderPassQueries;
+            }
+            else if (m_State.RenderPass != VK_NULL_HANDLE)
+            {
+                // The query has been begun outside of render pass and must be ended outside of it.
+                EndRenderPass();
+            }
+            VERIFY_EXPR(m_State.NumActiveQueries > 0);
+            if (m_State.NumActiveQueries > 0)
+                --m_State.NumActiveQueries;
+            vkCmdEndQuery(m_VkCmdBuffer, queryPool, query);
+        }
+
+        __forceinline void WriteTimestamp(VkPipelineStageFlagBits pipelineStage,
+                                          VkQueryPool             queryPool,
+                                          uint32_t                query)
+        {
+            VERIFY_EXPR(m_VkCmdBuffer != VK_NULL_HANDLE);
+            // Timestamps can be written both inside and outside of render pass
+            vkCmdWriteTimestamp(m_VkCmdBuffer, pipelineStage, queryPool, query);
+        }
+
         void FlushBarriers();
 
         __forceinline void SetVkCmdBuffer(VkCommandBuffer VkCmdBuffer)
@@ -431,6 +537,13 @@ namespace VulkanUtilities
             VkIndexType     IndexType           = VK_INDEX_TYPE_MAX_ENUM;
             uint32_t        FramebufferWidth    = 0;
             uint32_t        FramebufferHeight   = 0;
+            // True if this is a secondary command buffer that continues the render pass 
+            bool            IsRenderPassInherited = false;
+            // The number of queries begun inside the current render pass that have not been ended yet
+            uint32_t        NumActiveRenderPassQueries = 0;
+            // The total number of occlusion and pipeline statistics queries that are active,
+            // including those that have been begun outside of render pass
+            uint32_t        NumActiveQueries = 0;
         };
 
         const StateCache& GetState()const{return m_State;}
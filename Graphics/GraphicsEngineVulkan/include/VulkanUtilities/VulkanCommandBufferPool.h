@@ -38,7 +38,8 @@ namespace VulkanUtilities
     public:
         VulkanCommandBufferPool(std::shared_ptr<const VulkanLogicalDevice> LogicalDevice, 
                                 uint32_t                                   queueFamilyIndex, 
-                                VkCommandPoolCreateFlags                   flags);
+                                VkCommandPoolCreateFlags                   flags,
+                                VkCommandBufferLevel                       level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
         VulkanCommandBufferPool             (const VulkanCommandBufferPool&)  = delete;
         VulkanCommandBufferPool             (      VulkanCommandBufferPool&&) = delete;
@@ -47,7 +48,8 @@ namespace VulkanUtilities
 
         ~VulkanCommandBufferPool();
 
-        VkCommandBuffer GetCommandBuffer(const char* DebugName = "");
+        // pInheritanceInfo must only be provided by pools of secondary command buffers that continue a render pass
+        VkCommandBuffer GetCommandBuffer(const char* DebugName = "", const VkCommandBufferInheritanceInfo* pInheritanceInfo = nullptr);
         // The GPU must have finished with the command buffer being returned to the pool
         void FreeCommandBuffer(VkCommandBuffer&& CmdBuffer);
 
@@ -61,6 +63,7 @@ namespace VulkanUtilities
         // Shared point to logical device must be defined before the command pool
         std::shared_ptr<const VulkanLogicalDevice> m_LogicalDevice;
         CommandPoolWrapper m_CmdPool;
+        const VkCommandBufferLevel m_Level;
 
         std::mutex m_Mutex;
         std::deque< VkCommandBuffer > m_CmdBuffers;
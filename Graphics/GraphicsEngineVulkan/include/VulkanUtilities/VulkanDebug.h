@@ -87,6 +87,7 @@ namespace VulkanUtilities
 	void SetSemaphoreName           (VkDevice device, VkSemaphore           semaphore,           const char * name);
 	void SetFenceName               (VkDevice device, VkFence               fence,               const char * name);
 	void SetEventName               (VkDevice device, VkEvent               _event,              const char * name);
+	void SetQueryPoolName           (VkDevice device, VkQueryPool           queryPool,           const char * name);
 
     void SetVulkanObjectName(VkDevice device, VkCommandPool         cmdPool,             const char * name);
     void SetVulkanObjectName(VkDevice device, VkCommandBuffer       cmdBuffer,           const char * name);
@@ -108,6 +109,7 @@ namespace VulkanUtilities
     void SetVulkanObjectName(VkDevice device, VkSemaphore           semaphore,           const char * name);
     void SetVulkanObjectName(VkDevice device, VkFence               fence,               const char * name);
     void SetVulkanObjectName(VkDevice device, VkEvent               _event,              const char * name);
+    void SetVulkanObjectName(VkDevice device, VkQueryPool           queryPool,           const char * name);
 
     const char* VkResultToString       (VkResult         errorCode);
     const char* VkAccessFlagBitToString(VkAccessFlagBits Bit);
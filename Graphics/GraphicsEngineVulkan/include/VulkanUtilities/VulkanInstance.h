@@ -56,6 +56,7 @@ namespace VulkanUtilities
         bool IsLayerAvailable    (const char* LayerName)    const;
         bool IsExtensionAvailable(const char* ExtensionName)const;
         VkPhysicalDevice SelectPhysicalDevice()const;
+        bool IsPhysicalDeviceProperties2Enabled()const{return m_PhysicalDeviceProperties2Enabled;}
         VkAllocationCallbacks* GetVkAllocator()const{return m_pVkAllocator;}
         VkInstance             GetVkInstance() const{return m_VkInstance;}
 
@@ -66,6 +67,7 @@ namespace VulkanUtilities
                        VkAllocationCallbacks* pVkAllocator);
 
         bool m_DebugUtilsEnabled = false;
+        bool m_PhysicalDeviceProperties2Enabled = false;
         VkAllocationCallbacks* const m_pVkAllocator;
         VkInstance m_VkInstance = VK_NULL_HANDLE;
 
@@ -24,6 +24,8 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <string>
 #include "vulkan.h"
 
 namespace VulkanUtilities
@@ -47,6 +49,7 @@ namespace VulkanUtilities
     using DescriptorPoolWrapper = VulkanObjectWrapper<VkDescriptorPool>;
     using DescriptorSetLayoutWrapper = VulkanObjectWrapper<VkDescriptorSetLayout>;
     using SemaphoreWrapper      = VulkanObjectWrapper<VkSemaphore>;
+    using QueryPoolWrapper      = VulkanObjectWrapper<VkQueryPool>;
 
     class VulkanLogicalDevice : public std::enable_shared_from_this<VulkanLogicalDevice>
     {
@@ -98,6 +101,7 @@ namespace VulkanUtilities
         DescriptorPoolWrapper CreateDescriptorPool(const VkDescriptorPoolCreateInfo &DescrPoolCI,   const char* DebugName = "")const;
         DescriptorSetLayoutWrapper CreateDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo &LayoutCI, const char* DebugName = "")const;
         SemaphoreWrapper    CreateSemaphore(const VkSemaphoreCreateInfo &SemaphoreCI, const char* DebugName = "")const;
+        QueryPoolWrapper    CreateQueryPool(const VkQueryPoolCreateInfo &QueryPoolCI, const char* DebugName = "")const;
 
         VkCommandBuffer     AllocateVkCommandBuffer(const VkCommandBufferAllocateInfo &AllocInfo, const char* DebugName = "")const;
         VkDescriptorSet     AllocateVkDescriptorSet(const VkDescriptorSetAllocateInfo &AllocInfo, const char* DebugName = "")const;
@@ -118,6 +122,7 @@ namespace VulkanUtilities
         void ReleaseVulkanObject(DescriptorPoolWrapper&& DescriptorPool)const;
         void ReleaseVulkanObject(DescriptorSetLayoutWrapper&& DescriptorSetLayout)const;
         void ReleaseVulkanObject(SemaphoreWrapper&&     Semaphore)const;
+        void ReleaseVulkanObject(QueryPoolWrapper&&     QueryPool)const;
 
         void FreeDescriptorSet(VkDescriptorPool Pool, VkDescriptorSet Set)const;
 
@@ -151,8 +156,19 @@ namespace VulkanUtilities
         VkResult ResetDescriptorPool(VkDescriptorPool           descriptorPool,
                                      VkDescriptorPoolResetFlags flags = 0)const;
 
+        VkResult GetQueryPoolResults(VkQueryPool        queryPool,
+                                     uint32_t           firstQuery,
+                                     uint32_t           queryCount,
+                                     size_t             dataSize,
+                                     void*              pData,
+                                     VkDeviceSize       stride,
+                                     VkQueryResultFlags flags)const;
+
         VkPipelineStageFlags GetEnabledGraphicsShaderStages()const { return m_EnabledGraphicsShaderStages; }
 
+        // Returns true if the extension was enabled when the device was created
+        bool IsExtensionEnabled(const char* ExtensionName)const;
+
     private:
         VulkanLogicalDevice(VkPhysicalDevice vkPhysicalDevice, 
                             const VkDeviceCreateInfo &DeviceCI, 
@@ -167,5 +183,6 @@ namespace VulkanUtilities
         VkDevice m_VkDevice = VK_NULL_HANDLE;
         const VkAllocationCallbacks* const m_VkAllocator;
         VkPipelineStageFlags m_EnabledGraphicsShaderStages = 0;
+        std::vector<std::string> m_EnabledExtensions;
     };
 }
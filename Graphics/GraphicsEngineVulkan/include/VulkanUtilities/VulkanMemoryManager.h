@@ -25,15 +25,17 @@
 
 #include <mutex>
 #include <array>
-#include <unordered_map>
+#include <vector>
+#include <map>
+#include <memory>
 #include <atomic>
 #include <string>
+#include <ostream>
 #include "MemoryAllocator.h"
 #include "VariableSizeAllocationsManager.h"
 #include "VulkanUtilities/VulkanPhysicalDevice.h"
 #include "VulkanUtilities/VulkanLogicalDevice.h"
 #include "VulkanUtilities/VulkanObjectWrappers.h"
-#include "HashUtils.h"
 
 namespace VulkanUtilities
 {
@@ -41,6 +43,26 @@ namespace VulkanUtilities
 class VulkanMemoryPage;
 class VulkanMemoryManager;
 
+// Linear resources (buffers and linear-tiling images) and optimal-tiling images that are placed
+// in the same device memory object must be separated by bufferImageGranularity bytes (11.6)
+enum class VulkanMemoryResourceType : uint8_t
+{
+    Linear = 0,
+    Optimal,
+    NumTypes
+};
+
+// Category of the resource the memory is allocated for. Used sizes are tracked per category
+// and per memory heap for memory budget reporting.
+enum class VulkanMemoryCategory : uint8_t
+{
+    Buffer = 0,
+    Texture,
+    Staging,
+    Dynamic,
+    NumCategories
+};
+
 struct VulkanMemoryAllocation
 {
     VulkanMemoryAllocation()noexcept{}
@@ -57,7 +79,8 @@ struct VulkanMemoryAllocation
     VulkanMemoryAllocation(VulkanMemoryAllocation&& rhs)noexcept :
         Page           {rhs.Page           },
         UnalignedOffset{rhs.UnalignedOffset},
-        Size           {rhs.Size           }
+        Size           {rhs.Size           },
+        Category       {rhs.Category       }
     {
         rhs.Page            = nullptr;
         rhs.UnalignedOffset = 0;
@@ -69,6 +92,7 @@ struct VulkanMemoryAllocation
         Page            = rhs.Page;
         UnalignedOffset = rhs.UnalignedOffset;
         Size            = rhs.Size;
+        Category        = rhs.Category;
 
         rhs.Page            = nullptr;
         rhs.UnalignedOffset = 0;
@@ -84,53 +108,71 @@ struct VulkanMemoryAllocation
     VulkanMemoryPage* Page             = nullptr;	// Memory page that contains this allocation
 	VkDeviceSize      UnalignedOffset  = 0;         // Unaligned offset from the start of the memory
 	VkDeviceSize      Size             = 0;	        // Reserved size of this allocation
+    VulkanMemoryCategory Category      = VulkanMemoryCategory::Buffer;
 };
 
+// Memory page is a single VkDeviceMemory object that is suballocated by the memory manager.
+// Pages are owned by memory pools of the manager and are only accessed under the pool mutex.
 class VulkanMemoryPage
 {
 public:
+    // If DedicatedBuffer or DedicatedImage is not null, the page is allocated with
+    // VkMemoryDedicatedAllocateInfoKHR and may only be bound to this resource
     VulkanMemoryPage(VulkanMemoryManager& ParentMemoryMgr,
                      VkDeviceSize         PageSize, 
                      uint32_t             MemoryTypeIndex,
-                     bool                 IsHostVisible)noexcept;
+                     bool                 IsHostVisible,
+                     bool                 IsDedicated,
+                     VkBuffer             DedicatedBuffer = VK_NULL_HANDLE,
+                     VkImage              DedicatedImage  = VK_NULL_HANDLE);
     ~VulkanMemoryPage();
 
-    VulkanMemoryPage(VulkanMemoryPage&& rhs)noexcept :
-        m_ParentMemoryMgr {rhs.m_ParentMemoryMgr         },
-        m_AllocationMgr   {std::move(rhs.m_AllocationMgr)},
-        m_VkMemory        {std::move(rhs.m_VkMemory)     },
-        m_CPUMemory       {rhs.m_CPUMemory               }
-    {
-        rhs.m_CPUMemory = nullptr;
-    }
-
-    VulkanMemoryPage            (const VulkanMemoryPage&) = delete;
-    VulkanMemoryPage& operator= (VulkanMemoryPage&)       = delete;
-    VulkanMemoryPage& operator= (VulkanMemoryPage&& rhs)  = delete;
+    VulkanMemoryPage            (const VulkanMemoryPage&)  = delete;
+    VulkanMemoryPage            (VulkanMemoryPage&&)       = delete;
+    VulkanMemoryPage& operator= (const VulkanMemoryPage&)  = delete;
+    VulkanMemoryPage& operator= (VulkanMemoryPage&& rhs)   = delete;
 
     bool IsEmpty()const{return m_AllocationMgr.IsEmpty();}
     bool IsFull() const{return m_AllocationMgr.IsFull();}
+    bool IsDedicated()const{return m_IsDedicated;}
+    bool IsDefragmentationSource()const{return m_IsDefragmentationSource;}
     VkDeviceSize GetPageSize()const{return m_AllocationMgr.GetMaxSize();}
     VkDeviceSize GetUsedSize()const{return m_AllocationMgr.GetUsedSize();}
-
-    VulkanMemoryAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment);
+    VkDeviceSize GetMaxFreeBlockSize()const{return m_AllocationMgr.GetMaxFreeBlockSize();}
+    size_t       GetNumFreeBlocks()const{return m_AllocationMgr.GetNumFreeBlocks();}
 
     VkDeviceMemory GetVkMemory()const{return m_VkMemory;}
     void* GetCPUMemory()const{return m_CPUMemory;}
     
 private:
+    friend class VulkanMemoryManager;
     friend struct VulkanMemoryAllocation;
-    
+
+    // Both methods must be called while the pool mutex is locked
+    VulkanMemoryAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment);
     // Memory is reclaimed immediately. The application is responsible to ensure it is not in use by the GPU    
-    void Free(VulkanMemoryAllocation&& Allocation);
+    void Free(VulkanMemoryAllocation& Allocation);
 
     VulkanMemoryManager&                     m_ParentMemoryMgr;
-    std::mutex                               m_Mutex;
     Diligent::VariableSizeAllocationsManager m_AllocationMgr;
     VulkanUtilities::DeviceMemoryWrapper     m_VkMemory;
     void*                                    m_CPUMemory = nullptr;
+    const bool                               m_IsDedicated;
+    // New allocations are never placed in a page that is being defragmented,
+    // and the page is released as soon as its last allocation is freed
+    bool                                     m_IsDefragmentationSource = false;
+
+    // Index of the pool the page belongs to, and the position of the page in the pool
+    uint32_t                                                          m_PoolIdx = 0;
+    std::multimap<VkDeviceSize, std::unique_ptr<VulkanMemoryPage>>::iterator m_PoolIt;
 };
 
+// Memory manager keeps a separate pool of pages for every combination of memory type, host visibility
+// and resource type (if bufferImageGranularity requires linear and optimal resources to be separated). 
+// Every pool is protected by its own mutex and keeps the pages sorted by the size of their largest
+// free block, so that a page that can accommodate the request is found in logarithmic time.
+// Allocations that are larger than the dedicated allocation threshold get their own device memory object
+// that is released as soon as the allocation is freed.
 class VulkanMemoryManager
 {
 public:
@@ -141,16 +183,8 @@ public:
                         VkDeviceSize                 DeviceLocalPageSize,
                         VkDeviceSize                 HostVisiblePageSize,
                         VkDeviceSize                 DeviceLocalReserveSize,
-                        VkDeviceSize                 HostVisibleReserveSize) : 
-        m_MgrName               {std::move(MgrName)    },
-        m_LogicalDevice         {LogicalDevice         },
-        m_PhysicalDevice        {PhysicalDevice        },
-        m_Allocator             {Allocator             },
-        m_DeviceLocalPageSize   {DeviceLocalPageSize   },
-        m_HostVisiblePageSize   {HostVisiblePageSize   },
-        m_DeviceLocalReserveSize{DeviceLocalReserveSize},
-        m_HostVisibleReserveSize{HostVisibleReserveSize}
-    {}
+                        VkDeviceSize                 HostVisibleReserveSize,
+                        VkDeviceSize                 DedicatedAllocationThreshold = 0);
 
     // We have to write this constructor because on msvc default
     // constructor is not labeled with noexcept, which makes all
@@ -160,20 +194,31 @@ public:
         m_LogicalDevice   {rhs.m_LogicalDevice     },
         m_PhysicalDevice  {rhs.m_PhysicalDevice    },
         m_Allocator       {rhs.m_Allocator         },
-        m_Pages           {std::move(rhs.m_Pages)  },
+        m_Pools           {std::move(rhs.m_Pools)  },
     
         m_DeviceLocalPageSize    {rhs.m_DeviceLocalPageSize   },
         m_HostVisiblePageSize    {rhs.m_HostVisiblePageSize   },
         m_DeviceLocalReserveSize {rhs.m_DeviceLocalReserveSize},
         m_HostVisibleReserveSize {rhs.m_HostVisibleReserveSize},
-    
-        //m_CurrUsedSize      {rhs.m_CurrUsedSize},
-        m_PeakUsedSize      {rhs.m_PeakUsedSize     },
-        m_CurrAllocatedSize {rhs.m_CurrAllocatedSize},
-        m_PeakAllocatedSize {rhs.m_PeakAllocatedSize}
+        m_DedicatedAllocationThreshold{rhs.m_DedicatedAllocationThreshold},
+        m_UseDedicatedAllocationInfo  {rhs.m_UseDedicatedAllocationInfo  },
+        m_SeparateResourceTypes       {rhs.m_SeparateResourceTypes       },
+        m_NumDefragReleasedPages      {rhs.m_NumDefragReleasedPages.load()},
+        m_DefragReleasedSize          {rhs.m_DefragReleasedSize.load()    }
     {
+        for(size_t heap=0; heap < m_HeapAllocatedSize.size(); ++heap)
+        {
+            m_HeapAllocatedSize[heap].store(rhs.m_HeapAllocatedSize[heap].load());
+            for(size_t cat=0; cat < m_HeapUsedSize[heap].size(); ++cat)
+                m_HeapUsedSize[heap][cat].store(rhs.m_HeapUsedSize[heap][cat].load());
+        }
         for(size_t i=0; i < m_CurrUsedSize.size(); ++i)
+        {
             m_CurrUsedSize[i].store(rhs.m_CurrUsedSize[i].load());
+            m_PeakUsedSize[i].store(rhs.m_PeakUsedSize[i].load());
+            m_CurrAllocatedSize[i].store(rhs.m_CurrAllocatedSize[i].load());
+            m_PeakAllocatedSize[i].store(rhs.m_PeakAllocatedSize[i].load());
+        }
     }
 
     ~VulkanMemoryManager();
@@ -182,12 +227,54 @@ public:
     VulkanMemoryManager& operator= (const VulkanMemoryManager&) = delete;
     VulkanMemoryManager& operator= (VulkanMemoryManager&&)      = delete;
     
-    VulkanMemoryAllocation Allocate(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t MemoryTypeIndex, bool HostVisible);
-	VulkanMemoryAllocation Allocate(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps);
+    // If the category is not specified, host-visible allocations are counted as staging memory,
+    // and all other allocations as buffer memory
+    VulkanMemoryAllocation Allocate(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t MemoryTypeIndex, bool HostVisible,
+                                    VulkanMemoryResourceType ResType = VulkanMemoryResourceType::Linear);
+	VulkanMemoryAllocation Allocate(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps,
+                                    VulkanMemoryResourceType ResType = VulkanMemoryResourceType::Linear);
+
+    // Allocates memory for the buffer or optimal-tiling image. If the allocation gets dedicated memory object,
+    // the object is bound to the resource through VK_KHR_dedicated_allocation when the extension is enabled.
+    // Image memory is counted as texture memory.
+    VulkanMemoryAllocation AllocateForBuffer(VkBuffer vkBuffer, const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps);
+    VulkanMemoryAllocation AllocateForImage (VkImage  vkImage,  const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps);
+
     void ShrinkMemory();
 
+    // Marks the page as a defragmentation source if all of its allocations can be moved (MovableSize
+    // is equal to the used size), its occupancy does not exceed MaxOccupancy, and other pages of the pool 
+    // have enough free space to accommodate its allocations. Returns true if the page is a defragmentation
+    // source after the call.
+    bool BeginPageDefragmentation(VulkanMemoryPage& Page, VkDeviceSize MovableSize, float MaxOccupancy);
+
+    struct DefragmentationStats
+    {
+        uint32_t     NumReleasedPages = 0;
+        VkDeviceSize ReleasedSize     = 0;
+    };
+    DefragmentationStats GetDefragmentationStats()const;
+
+    // Accounts for device memory that is allocated outside of the manager (such as the dynamic heap)
+    // in the heap statistics. Size is negative when the memory is released.
+    void TrackExternalMemory(uint32_t MemoryTypeIndex, VulkanMemoryCategory Category, int64_t Size);
+
+    struct HeapStats
+    {
+        // The total size of device memory objects allocated in the heap
+        VkDeviceSize AllocatedSize = 0;
+        // The size of allocations of every category
+        std::array<VkDeviceSize, static_cast<size_t>(VulkanMemoryCategory::NumCategories)> UsedSize = {};
+    };
+    HeapStats GetHeapStats(uint32_t HeapIndex)const;
+
+    // Writes the state of every memory pool and page (sizes, the number of free blocks, the largest free block
+    // and fragmentation) to the stream in JSON format
+    void DumpStatsJSON(std::ostream& Stream);
+
 protected:
     friend class VulkanMemoryPage;
+    friend struct VulkanMemoryAllocation;
 
     virtual void OnNewPageCreated(VulkanMemoryPage& NewPage){}
     virtual void OnPageDestroy(VulkanMemoryPage& Page){}
@@ -199,46 +286,65 @@ protected:
 
     Diligent::IMemoryAllocator& m_Allocator;
 
-    std::mutex m_PagesMtx;
-    struct MemoryPageIndex
+    struct MemoryPool
     {
-        const uint32_t MemoryTypeIndex;
-        const bool     IsHostVisible;
-
-        MemoryPageIndex(uint32_t _MemoryTypeIndex,
-                        bool     _IsHostVisible) : 
-            MemoryTypeIndex(_MemoryTypeIndex),
-            IsHostVisible  (_IsHostVisible)
+        MemoryPool(uint32_t _MemoryTypeIndex, uint32_t _HeapIndex, bool _IsHostVisible, VulkanMemoryResourceType _ResType) :
+            MemoryTypeIndex{_MemoryTypeIndex},
+            HeapIndex      {_HeapIndex      },
+            IsHostVisible  {_IsHostVisible  },
+            ResType        {_ResType        }
         {}
 
-        bool operator == (const MemoryPageIndex& rhs)const
-        {
-            return MemoryTypeIndex == rhs.MemoryTypeIndex &&
-                   IsHostVisible   == rhs.IsHostVisible;
-        }
+        const uint32_t                 MemoryTypeIndex;
+        const uint32_t                 HeapIndex;
+        const bool                     IsHostVisible;
+        const VulkanMemoryResourceType ResType;
 
-        struct Hasher
-        {
-            size_t operator()(const MemoryPageIndex& PageIndex)const
-            {
-                return Diligent::ComputeHash(PageIndex.MemoryTypeIndex, PageIndex.IsHostVisible);
-            }
-        };
+        std::mutex Mtx;
+        // All pages of the pool sorted by the size of their largest free block.
+        // Dedicated pages are always full and are never selected for new allocations.
+        std::multimap<VkDeviceSize, std::unique_ptr<VulkanMemoryPage>> Pages;
     };
-    std::unordered_multimap<MemoryPageIndex, VulkanMemoryPage, MemoryPageIndex::Hasher> m_Pages;
-    
+    // Pools are indexed by ((MemoryTypeIndex * 2 + HostVisible) * NumTypes + ResType)
+    std::vector<std::unique_ptr<MemoryPool>> m_Pools;
+
+    uint32_t GetPoolIndex(uint32_t MemoryTypeIndex, bool HostVisible, VulkanMemoryResourceType ResType)const;
+    uint32_t GetMemoryTypeIndex(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps)const;
+
+    VulkanMemoryAllocation AllocateImpl(VkDeviceSize             Size,
+                                        VkDeviceSize             Alignment,
+                                        uint32_t                 MemoryTypeIndex,
+                                        bool                     HostVisible,
+                                        VulkanMemoryResourceType ResType,
+                                        VulkanMemoryCategory     Category,
+                                        VkBuffer                 DedicatedBuffer,
+                                        VkImage                  DedicatedImage);
+    void Free(VulkanMemoryAllocation& Allocation);
+
+    // Updates the position of the page in the pool after its largest free block has changed
+    static void UpdatePagePosition(MemoryPool& Pool, VulkanMemoryPage& Page);
+    void DestroyPage(MemoryPool& Pool, VulkanMemoryPage& Page);
+
     const VkDeviceSize m_DeviceLocalPageSize;
     const VkDeviceSize m_HostVisiblePageSize;
     const VkDeviceSize m_DeviceLocalReserveSize;
     const VkDeviceSize m_HostVisibleReserveSize;
+    const VkDeviceSize m_DedicatedAllocationThreshold;
+    const bool         m_UseDedicatedAllocationInfo;
+    const bool         m_SeparateResourceTypes;
     
-    void OnFreeAllocation(VkDeviceSize Size, bool IsHostVisble);
-
     // 0 == Device local, 1 == Host-visible
-    std::array<std::atomic_int64_t, 2> m_CurrUsedSize = {};
-    std::array<VkDeviceSize, 2> m_PeakUsedSize = {};
-    std::array<VkDeviceSize, 2> m_CurrAllocatedSize = {};
-    std::array<VkDeviceSize, 2> m_PeakAllocatedSize = {};
+    std::array<std::atomic_int64_t, 2> m_CurrUsedSize      = {};
+    std::array<std::atomic_int64_t, 2> m_PeakUsedSize      = {};
+    std::array<std::atomic_int64_t, 2> m_CurrAllocatedSize = {};
+    std::array<std::atomic_int64_t, 2> m_PeakAllocatedSize = {};
+
+    // Per-heap statistics that are reported by GetHeapStats()
+    std::array<std::atomic_int64_t, VK_MAX_MEMORY_HEAPS> m_HeapAllocatedSize = {};
+    std::array<std::array<std::atomic_int64_t, static_cast<size_t>(VulkanMemoryCategory::NumCategories)>, VK_MAX_MEMORY_HEAPS> m_HeapUsedSize = {};
+
+    std::atomic<uint32_t> m_NumDefragReleasedPages{0};
+    std::atomic<uint64_t> m_DefragReleasedSize{0};
 
     // If adding new member, do not forget to update move ctor
 };
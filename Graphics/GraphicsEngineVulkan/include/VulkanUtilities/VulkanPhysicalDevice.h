@@ -27,6 +27,20 @@
 #include <vector>
 #include "vulkan.h"
 
+// VK_EXT_memory_budget is not defined by older Vulkan headers
+#ifndef VK_EXT_memory_budget
+#define VK_EXT_memory_budget 1
+#define VK_EXT_MEMORY_BUDGET_SPEC_VERSION   1
+#define VK_EXT_MEMORY_BUDGET_EXTENSION_NAME "VK_EXT_memory_budget"
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT static_cast<VkStructureType>(1000237000)
+typedef struct VkPhysicalDeviceMemoryBudgetPropertiesEXT {
+    VkStructureType    sType;
+    void*              pNext;
+    VkDeviceSize       heapBudget[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize       heapUsage[VK_MAX_MEMORY_HEAPS];
+} VkPhysicalDeviceMemoryBudgetPropertiesEXT;
+#endif
+
 namespace VulkanUtilities
 {
     class VulkanPhysicalDevice
@@ -48,6 +62,8 @@ namespace VulkanUtilities
         uint32_t GetMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties)const;
         const VkPhysicalDeviceProperties& GetProperties() const {return m_Properties;}
         const VkPhysicalDeviceFeatures&   GetFeatures()   const {return m_Features;  }
+        const VkPhysicalDeviceMemoryProperties& GetMemoryProperties()const {return m_MemoryProperties;}
+        const std::vector<VkQueueFamilyProperties>& GetQueueFamilyProperties()const {return m_QueueFamilyProperties;}
         VkFormatProperties  GetPhysicalDeviceFormatProperties(VkFormat imageFormat)const;
 
     private:
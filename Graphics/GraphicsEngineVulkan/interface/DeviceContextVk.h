@@ -75,6 +75,61 @@ public:
 
     /// Unlocks the command queue that was previously locked by IDeviceContextVk::LockCommandQueue().
     virtual void UnlockCommandQueue() = 0;
+
+    /// Performs an incremental step of device memory defragmentation
+
+    /// \param [in] MaxBytesToMove - the maximum number of bytes the GPU may copy during this step.
+    ///                              If the budget is smaller than the size of the next buffer to move,
+    ///                              a single buffer is still moved.
+    ///
+    /// \remarks The method selects memory pages with low occupancy and records GPU copies that move
+    ///          their buffers to other pages. When the GPU has completed the copies, the buffers are switched
+    ///          to the new memory during one of the subsequent calls, and the pages are released as soon as
+    ///          they become empty. An application is expected to call the method once per frame.
+    ///
+    ///          Only static vertex, index and indirect-argument buffers are moved, as they are never written
+    ///          after initialization and are not referenced by views or descriptor sets. Moving a buffer 
+    ///          changes its native Vulkan handle.
+    ///
+    ///          Only immediate contexts can defragment memory. The method must not be called while other
+    ///          threads record commands that use the buffers that may be moved.
+    virtual void DefragmentMemory(Uint64 MaxBytesToMove) = 0;
+
+    /// Starts recording a secondary command list that continues a render pass
+
+    /// \param [in] NumRenderTargets - Number of render targets of the render pass.
+    /// \param [in] ppRenderTargets  - Array of pointers to render target views.
+    /// \param [in] pDepthStencil    - Pointer to the depth-stencil view.
+    ///
+    /// \remarks The method must be called on a deferred context that has no outstanding commands.
+    ///          The context records commands into a secondary Vulkan command buffer that inherits the render
+    ///          pass compatible with the given render targets. The command list is closed by 
+    ///          IDeviceContext::FinishCommandList() and must be executed by 
+    ///          IDeviceContextVk::ExecuteSecondaryCommandLists() while the same render targets are bound to
+    ///          the immediate context.
+    ///
+    ///          Secondary command lists can only contain draw commands and state changes. Commands that
+    ///          require ending the render pass (copies, dispatches, clears of other targets, etc.) are not allowed.
+    ///          All state transitions must be performed in advance on the immediate context: the context
+    ///          only accepts RESOURCE_STATE_TRANSITION_MODE_NONE and RESOURCE_STATE_TRANSITION_MODE_VERIFY.
+    virtual void BeginSecondaryCommandList(Uint32 NumRenderTargets, ITextureView* ppRenderTargets[], ITextureView* pDepthStencil) = 0;
+
+    /// Executes secondary command lists inside one render pass
+
+    /// \param [in] NumCommandLists - Number of command lists to execute.
+    /// \param [in] ppCommandLists  - Array of command lists recorded with IDeviceContextVk::BeginSecondaryCommandList().
+    ///
+    /// \remarks The method must be called on the immediate context. It begins the render pass for the 
+    ///          currently bound render targets, executes all command lists with a single vkCmdExecuteCommands
+    ///          call, and ends the render pass. The command lists may have been recorded in parallel by
+    ///          multiple deferred contexts.
+    ///
+    ///          The render targets must be the same as the ones the command lists were recorded for, and must
+    ///          be in the render target and depth-write states. Occlusion and pipeline statistics queries
+    ///          must not be active when the method is called.
+    ///          The pipeline state, shader resources, vertex and index buffers are not preserved
+    ///          and must be set again after the call.
+    virtual void ExecuteSecondaryCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists) = 0;
 };
 
 }
@@ -35,6 +35,103 @@ namespace Diligent
 static constexpr INTERFACE_ID IID_RenderDeviceVk =
 { 0xab8cf3a6, 0xd959, 0x41c1,{ 0xae, 0x0, 0xa5, 0x8a, 0xe9, 0x82, 0xe, 0x6a } };
 
+/// Device memory defragmentation statistics, see IDeviceContextVk::DefragmentMemory()
+struct MemoryDefragmentationStatsVk
+{
+    /// The number of buffers that have been moved to other memory pages
+    Uint64 NumMovedBuffers  = 0;
+
+    /// The total number of bytes copied by the GPU to move the buffers
+    Uint64 MovedBytes       = 0;
+
+    /// The number of device memory pages released after all allocations have been moved out of them
+    Uint32 NumReleasedPages = 0;
+
+    /// The total size of the released memory pages
+    Uint64 ReclaimedBytes   = 0;
+};
+
+/// Memory usage of a single device memory heap, see IRenderDeviceVk::GetMemoryHeapUsage()
+struct MemoryHeapUsageVk
+{
+    /// The total size of the heap
+    Uint64 HeapSize      = 0;
+
+    /// Memory budget of the heap. When VK_EXT_memory_budget extension is supported, this is
+    /// the budget reported by the driver. Otherwise, the budget is derived from 
+    /// EngineVkCreateInfo::DeviceLocalMemoryBudget or EngineVkCreateInfo::HostMemoryBudget.
+    Uint64 Budget        = 0;
+
+    /// Heap memory usage of the process as reported by VK_EXT_memory_budget extension. 
+    /// If the extension is not supported, this is the same as AllocatedSize.
+    Uint64 Usage         = 0;
+
+    /// The total size of device memory objects allocated by the engine in this heap
+    Uint64 AllocatedSize = 0;
+
+    /// The size of memory used by buffers
+    Uint64 BufferSize    = 0;
+
+    /// The size of memory used by textures
+    Uint64 TextureSize   = 0;
+
+    /// The size of memory used by staging buffers and upload heaps
+    Uint64 StagingSize   = 0;
+
+    /// The size of memory used by the dynamic heap
+    Uint64 DynamicSize   = 0;
+
+    /// Indicates if the heap is device-local
+    Bool IsDeviceLocal   = False;
+
+    /// Indicates if Budget and Usage are reported by the driver through VK_EXT_memory_budget extension
+    Bool IsBudgetReportedByDriver = False;
+};
+
+/// Shader module cache statistics, see IRenderDeviceVk::GetShaderModuleCacheStats()
+struct ShaderModuleCacheStatsVk
+{
+    /// The total number of shader module requests made by pipeline states
+    Uint64 NumLookups = 0;
+
+    /// The number of requests that were served by an existing shader module
+    Uint64 NumHits    = 0;
+
+    /// The number of shader modules currently in the cache
+    Uint32 NumModules = 0;
+
+    /// The total size of SPIR-V byte code held by the cache
+    size_t SPIRVSize  = 0;
+
+    /// The total time, in seconds, spent stripping SPIR-V and creating shader modules on cache misses
+    double TotalCreateTime    = 0;
+
+    /// Estimated time, in seconds, saved by cache hits. Computed as the number of hits
+    /// times the average time spent on a cache miss.
+    double EstimatedTimeSaved = 0;
+};
+
+/// Memory pressure level of a memory heap, see IRenderDeviceVk::SetMemoryBudgetCallback()
+enum MEMORY_PRESSURE_LEVEL : Uint8
+{
+    /// Heap usage is below the high watermark
+    MEMORY_PRESSURE_LEVEL_NORMAL = 0,
+
+    /// Heap usage has reached the high watermark
+    MEMORY_PRESSURE_LEVEL_HIGH,
+
+    /// Heap usage has reached the critical watermark
+    MEMORY_PRESSURE_LEVEL_CRITICAL
+};
+
+/// Memory budget callback function type
+
+/// \param [in] HeapIndex     - index of the memory heap whose pressure level has changed.
+/// \param [in] PressureLevel - the new pressure level of the heap.
+/// \param [in] HeapUsage     - current memory usage of the heap.
+/// \param [in] pUserData     - user data pointer that was given to IRenderDeviceVk::SetMemoryBudgetCallback().
+typedef void (*MemoryBudgetCallbackType)(Uint32 HeapIndex, MEMORY_PRESSURE_LEVEL PressureLevel, const MemoryHeapUsageVk& HeapUsage, void* pUserData);
+
 /// Interface to the render device object implemented in Vulkan
 class IRenderDeviceVk : public IRenderDevice
 {
@@ -90,6 +187,38 @@ public:
                                                 const BufferDesc& BuffDesc,
                                                 RESOURCE_STATE    InitialState,
                                                 IBuffer**         ppBuffer) = 0;
+
+    /// Returns device memory defragmentation statistics accumulated since the device was created
+    virtual void GetMemoryDefragmentationStats(MemoryDefragmentationStatsVk& Stats) = 0;
+
+    /// Returns the number of device memory heaps
+    virtual Uint32 GetMemoryHeapCount() = 0;
+
+    /// Returns memory budget and usage of the memory heap
+
+    /// \param [in]  HeapIndex - index of the memory heap, must be less than GetMemoryHeapCount().
+    /// \param [out] HeapUsage - memory budget and usage of the heap.
+    virtual void GetMemoryHeapUsage(Uint32 HeapIndex, MemoryHeapUsageVk& HeapUsage) = 0;
+
+    /// Sets the function that is called when memory pressure level of a heap changes
+
+    /// \param [in] Callback          - callback function. Null disables the callback.
+    /// \param [in] pUserData         - user data pointer that is passed to the callback.
+    /// \param [in] HighWatermark     - heap usage to budget ratio at which the pressure level becomes high, e.g. 0.8.
+    /// \param [in] CriticalWatermark - heap usage to budget ratio at which the pressure level becomes critical, e.g. 0.95.
+    ///
+    /// \remarks Memory usage is checked by IRenderDevice::ReleaseStaleResources(), which is automatically
+    ///          called by ISwapChain::Present(). The callback is called from the thread that performs the check
+    ///          for every heap whose pressure level has changed since the previous check.
+    ///          The callback must not call SetMemoryBudgetCallback().
+    virtual void SetMemoryBudgetCallback(MemoryBudgetCallbackType Callback, void* pUserData, float HighWatermark, float CriticalWatermark) = 0;
+
+    /// Returns shader module cache statistics accumulated since the device was created
+
+    /// \remarks Pipeline states that use the same shader with identical resource bindings share
+    ///          one Vulkan shader module. The module is created when the first such pipeline is created
+    ///          and is destroyed when the last one is released.
+    virtual void GetShaderModuleCacheStats(ShaderModuleCacheStatsVk& Stats) = 0;
 };
 
 }
@@ -43,6 +43,15 @@ public:
 
     /// Returns SPIRV bytecode
     virtual const std::vector<uint32_t>& GetSPIRV()const = 0;
+
+    /// Serializes shader resources
+
+    /// \param [out] ppData - Memory location where pointer to the data blob containing
+    ///                       serialized resources will be written. The data can be stored
+    ///                       alongside the SPIRV byte code and provided through
+    ///                       ShaderCreateInfo::SerializedResources to create the shader
+    ///                       without reflecting the byte code.
+    virtual void SerializeResources(IDataBlob** ppData)const = 0;
 };
 
 }
@@ -0,0 +1,246 @@
+"#ifndef CONVERT_TO_SRGB\n"
+"#define CONVERT_TO_SRGB 0\n"
+"#endif\n"
+"\n"
+"#ifndef IMG_FORMAT\n"
+"#define IMG_FORMAT rgba8\n"
+"#endif\n"
+"\n"
+"// The source mip level must be square and its size must be a power of two, so that every\n"
+"// 2x2 footprint of every level lies within the level.\n"
+"\n"
+"// Maximum number of mip levels generated by one dispatch\n"
+"#define MAX_MIPS 12\n"
+"\n"
+"// OutMips[i] is the view of mip level i+1 relative to the source mip\n"
+"layout(IMG_FORMAT) uniform coherent image2DArray OutMips[MAX_MIPS];\n"
+"\n"
+"uniform sampler2DArray SrcMip;\n"
+"\n"
+"// Every thread group increments the counter of its array slice when it has written\n"
+"// mip level 6. The last group of the slice generates the remaining mip levels and\n"
+"// resets the counter to zero for the next dispatch.\n"
+"layout(std430) buffer MipCounters\n"
+"{\n"
+"    uint Counters[];\n"
+"};\n"
+"\n"
+"uniform CB\n"
+"{\n"
+"    int  NumMipLevels;       // Number of mip levels to generate: [1, 12]\n"
+"    int  NumGroupsPerSlice;  // Number of thread groups that process one array slice\n"
+"    int  Dummy0;\n"
+"    int  Dummy1;\n"
+"    vec2 SrcTexelSize;       // 1.0 / SrcMip.Dimensions\n"
+"};\n"
+"\n"
+"// Every thread group downsamples a 64x64 tile of the source mip into\n"
+"// 32x32, 16x16, 8x8, 4x4, 2x2 and 1x1 tiles of mip levels 1 to 6.\n"
+"// The last group then downsamples mip level 6 (up to 64x64) into levels 7 to 12.\n"
+"// Every thread computes a 2x2 quad of the first level, and the remaining levels\n"
+"// are reduced through shared memory, which only holds 16x16 texels.\n"
+"#define GROUP_SIZE 256\n"
+"#define TILE_DIM   16\n"
+"\n"
+"// The reason for separating channels is to reduce bank conflicts in the\n"
+"// local data memory controller.\n"
+"shared float gs_R[GROUP_SIZE];\n"
+"shared float gs_G[GROUP_SIZE];\n"
+"shared float gs_B[GROUP_SIZE];\n"
+"shared float gs_A[GROUP_SIZE];\n"
+"shared bool  gs_IsLastGroup;\n"
+"\n"
+"void StoreColor(uint Index, vec4 Color)\n"
+"{\n"
+"    gs_R[Index] = Color.r;\n"
+"    gs_G[Index] = Color.g;\n"
+"    gs_B[Index] = Color.b;\n"
+"    gs_A[Index] = Color.a;\n"
+"}\n"
+"\n"
+"vec4 LoadColor(uint Index)\n"
+"{\n"
+"    return vec4(gs_R[Index], gs_G[Index], gs_B[Index], gs_A[Index]);\n"
+"}\n"
+"\n"
+"float LinearToSRGB(float x)\n"
+"{\n"
+"    // This is cheaper but nearly equivalent to the exact sRGB curve\n"
+"    return x < 0.0031308 ? 12.92 * x : 1.13005 * sqrt(abs(x - 0.00228)) - 0.13448 * x + 0.005719;\n"
+"}\n"
+"\n"
+"float SRGBToLinear(float x)\n"
+"{\n"
+"    return x <= 0.04045 ? x / 12.92 : pow((x + 0.055) / 1.055, 2.4);\n"
+"}\n"
+"\n"
+"// Filtering is always performed in linear space. Storage images can't have sRGB formats,\n"
+"// so sRGB values are converted manually when they are written to and read from the mips.\n"
+"vec4 PackColor(vec4 Linear)\n"
+"{\n"
+"#if CONVERT_TO_SRGB\n"
+"    return vec4(LinearToSRGB(Linear.r), LinearToSRGB(Linear.g), LinearToSRGB(Linear.b), Linear.a);\n"
+"#else\n"
+"    return Linear;\n"
+"#endif\n"
+"}\n"
+"\n"
+"vec4 UnpackColor(vec4 Packed)\n"
+"{\n"
+"#if CONVERT_TO_SRGB\n"
+"    return vec4(SRGBToLinear(Packed.r), SRGBToLinear(Packed.g), SRGBToLinear(Packed.b), Packed.a);\n"
+"#else\n"
+"    return Packed;\n"
+"#endif\n"
+"}\n"
+"\n"
+"void GroupMemoryBarrierWithGroupSync()\n"
+"{\n"
+"    groupMemoryBarrier();\n"
+"    memoryBarrierShared();\n"
+"    barrier();\n"
+"}\n"
+"\n"
+"ivec2 GetMipSize(ivec2 SrcSize, int Mip)\n"
+"{\n"
+"    return max(SrcSize >> Mip, ivec2(1, 1));\n"
+"}\n"
+"\n"
+"void StoreMip(int Mip, ivec2 SrcSize, ivec2 Coord, int Slice, vec4 Color)\n"
+"{\n"
+"    // Mip is relative to the source mip, and OutMips[0] is mip level 1.\n"
+"    // Unused elements of OutMips reference the last generated mip level.\n"
+"    ivec2 MipSize = GetMipSize(SrcSize, Mip);\n"
+"    if (Mip > NumMipLevels || Coord.x >= MipSize.x || Coord.y >= MipSize.y)\n"
+"        return;\n"
+"\n"
+"    // Indexing arrays of storage images with non-constant expressions requires\n"
+"    // shaderStorageImageArrayDynamicIndexing feature, so only constant indices are used\n"
+"    vec4 Packed = PackColor(Color);\n"
+"    switch (Mip)\n"
+"    {\n"
+"        case  1: imageStore(OutMips[ 0], ivec3(Coord, Slice), Packed); break;\n"
+"        case  2: imageStore(OutMips[ 1], ivec3(Coord, Slice), Packed); break;\n"
+"        case  3: imageStore(OutMips[ 2], ivec3(Coord, Slice), Packed); break;\n"
+"        case  4: imageStore(OutMips[ 3], ivec3(Coord, Slice), Packed); break;\n"
+"        case  5: imageStore(OutMips[ 4], ivec3(Coord, Slice), Packed); break;\n"
+"        case  6: imageStore(OutMips[ 5], ivec3(Coord, Slice), Packed); break;\n"
+"        case  7: imageStore(OutMips[ 6], ivec3(Coord, Slice), Packed); break;\n"
+"        case  8: imageStore(OutMips[ 7], ivec3(Coord, Slice), Packed); break;\n"
+"        case  9: imageStore(OutMips[ 8], ivec3(Coord, Slice), Packed); break;\n"
+"        case 10: imageStore(OutMips[ 9], ivec3(Coord, Slice), Packed); break;\n"
+"        case 11: imageStore(OutMips[10], ivec3(Coord, Slice), Packed); break;\n"
+"        case 12: imageStore(OutMips[11], ivec3(Coord, Slice), Packed); break;\n"
+"    }\n"
+"}\n"
+"\n"
+"// Returns the average of the 2x2 source texels of the given texel of mip level FirstMip + 1.\n"
+"// The source is SrcMip for the first pass and mip level 6 for the second pass.\n"
+"vec4 LoadSourceQuad(int FirstMip, ivec2 SrcSize, ivec2 Coord, int Slice)\n"
+"{\n"
+"    if (FirstMip == 0)\n"
+"    {\n"
+"        // Bilinear sample in the center of the 2x2 quad returns the average of the four texels.\n"
+"        // sRGB textures are converted to linear space by the sampler before filtering.\n"
+"        vec2 UV = (vec2(Coord) * 2.0 + vec2(1.0, 1.0)) * SrcTexelSize;\n"
+"        return textureLod(SrcMip, vec3(UV, float(Slice)), 0.0);\n"
+"    }\n"
+"    else\n"
+"    {\n"
+"        ivec2 Mip6Size = GetMipSize(SrcSize, 6);\n"
+"        ivec2 Max  = Mip6Size - ivec2(1, 1);\n"
+"        ivec2 Base = Coord * 2;\n"
+"        vec4 Src0 = UnpackColor(imageLoad(OutMips[5], ivec3(min(Base,               Max), Slice)));\n"
+"        vec4 Src1 = UnpackColor(imageLoad(OutMips[5], ivec3(min(Base + ivec2(1, 0), Max), Slice)));\n"
+"        vec4 Src2 = UnpackColor(imageLoad(OutMips[5], ivec3(min(Base + ivec2(0, 1), Max), Slice)));\n"
+"        vec4 Src3 = UnpackColor(imageLoad(OutMips[5], ivec3(min(Base + ivec2(1, 1), Max), Slice)));\n"
+"        return 0.25 * (Src0 + Src1 + Src2 + Src3);\n"
+"    }\n"
+"}\n"
+"\n"
+"// Generates mip levels [FirstMip + 1, FirstMip + 6] of the tile. TileOrigin is\n"
+"// the position of the tile in the mip level FirstMip + 2 (16x16 texels per tile).\n"
+"void DownsampleTile(int FirstMip, ivec2 SrcSize, ivec2 TileOrigin, int Slice)\n"
+"{\n"
+"    uint  LocalInd = gl_LocalInvocationIndex;\n"
+"    ivec2 LocalPos = ivec2(int(LocalInd % uint(TILE_DIM)), int(LocalInd / uint(TILE_DIM)));\n"
+"\n"
+"    // Every thread computes a 2x2 quad of mip level FirstMip + 1\n"
+"    ivec2 QuadPos = (TileOrigin + LocalPos) * 2;\n"
+"    vec4 Quad0 = LoadSourceQuad(FirstMip, SrcSize, QuadPos,               Slice);\n"
+"    vec4 Quad1 = LoadSourceQuad(FirstMip, SrcSize, QuadPos + ivec2(1, 0), Slice);\n"
+"    vec4 Quad2 = LoadSourceQuad(FirstMip, SrcSize, QuadPos + ivec2(0, 1), Slice);\n"
+"    vec4 Quad3 = LoadSourceQuad(FirstMip, SrcSize, QuadPos + ivec2(1, 1), Slice);\n"
+"    StoreMip(FirstMip + 1, SrcSize, QuadPos,               Slice, Quad0);\n"
+"    StoreMip(FirstMip + 1, SrcSize, QuadPos + ivec2(1, 0), Slice, Quad1);\n"
+"    StoreMip(FirstMip + 1, SrcSize, QuadPos + ivec2(0, 1), Slice, Quad2);\n"
+"    StoreMip(FirstMip + 1, SrcSize, QuadPos + ivec2(1, 1), Slice, Quad3);\n"
+"\n"
+"    // A scalar (constant) branch can exit all threads coherently.\n"
+"    if (FirstMip + 2 > NumMipLevels)\n"
+"        return;\n"
+"\n"
+"    vec4 Color = 0.25 * (Quad0 + Quad1 + Quad2 + Quad3);\n"
+"    StoreMip(FirstMip + 2, SrcSize, TileOrigin + LocalPos, Slice, Color);\n"
+"    StoreColor(LocalInd, Color);\n"
+"\n"
+"    for (int Level = 1; Level <= 4; ++Level)\n"
+"    {\n"
+"        int Mip = FirstMip + 2 + Level;\n"
+"        if (Mip > NumMipLevels)\n"
+"            break;\n"
+"\n"
+"        GroupMemoryBarrierWithGroupSync();\n"
+"\n"
+"        int LevelDim = TILE_DIM >> Level;\n"
+"        bool IsActive = LocalPos.x < LevelDim && LocalPos.y < LevelDim;\n"
+"        if (IsActive)\n"
+"        {\n"
+"            // Texels of the previous level are stored with the stride of TILE_DIM\n"
+"            uint Src = uint(LocalPos.y * 2 * TILE_DIM + LocalPos.x * 2);\n"
+"            Color = 0.25 * (LoadColor(Src) + LoadColor(Src + 1u) + LoadColor(Src + uint(TILE_DIM)) + LoadColor(Src + uint(TILE_DIM) + 1u));\n"
+"        }\n"
+"\n"
+"        // All threads must read the previous level before it is overwritten\n"
+"        GroupMemoryBarrierWithGroupSync();\n"
+"\n"
+"        if (IsActive)\n"
+"        {\n"
+"            StoreColor(uint(LocalPos.y * TILE_DIM + LocalPos.x), Color);\n"
+"            StoreMip(Mip, SrcSize, (TileOrigin >> Level) + LocalPos, Slice, Color);\n"
+"        }\n"
+"    }\n"
+"}\n"
+"\n"
+"layout (local_size_x = GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;\n"
+"void main()\n"
+"{\n"
+"    ivec2 SrcSize = textureSize(SrcMip, 0).xy; // SrcMip is the view of the source mip level\n"
+"    int   Slice   = int(gl_WorkGroupID.z);     // Array slices are relative to the view's first array slice\n"
+"\n"
+"    DownsampleTile(0, SrcSize, ivec2(gl_WorkGroupID.xy) * TILE_DIM, Slice);\n"
+"\n"
+"    if (NumMipLevels <= 6)\n"
+"        return;\n"
+"\n"
+"    // Make mip level 6 written by this group visible to other groups\n"
+"    memoryBarrierImage();\n"
+"    memoryBarrier();\n"
+"    barrier();\n"
+"\n"
+"    if (gl_LocalInvocationIndex == 0u)\n"
+"    {\n"
+"        uint NumFinishedGroups = atomicAdd(Counters[Slice], 1u);\n"
+"        gs_IsLastGroup = NumFinishedGroups == uint(NumGroupsPerSlice - 1);\n"
+"    }\n"
+"    GroupMemoryBarrierWithGroupSync();\n"
+"\n"
+"    if (!gs_IsLastGroup)\n"
+"        return;\n"
+"\n"
+"    if (gl_LocalInvocationIndex == 0u)\n"
+"        Counters[Slice] = 0u;\n"
+"\n"
+"    // Mip level 6 is at most 64x64 texels, so one group generates all remaining levels\n"
+"    DownsampleTile(6, SrcSize, ivec2(0, 0), Slice);\n"
+"}\n"
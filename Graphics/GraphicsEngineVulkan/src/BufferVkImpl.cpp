@@ -184,7 +184,7 @@ BufferVkImpl :: BufferVkImpl(IReferenceCounters*        pRefCounters,
             BufferMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
         VERIFY( IsPowerOfTwo(MemReqs.alignment), "Alignment is not power of 2!");
-        m_MemoryAllocation = pRenderDeviceVk->AllocateMemory(MemReqs, BufferMemoryFlags);
+        m_MemoryAllocation = pRenderDeviceVk->AllocateBufferMemory(m_VulkanBuffer, MemReqs, BufferMemoryFlags);
 
         auto AlignedOffset = Align(VkDeviceSize{m_MemoryAllocation.UnalignedOffset}, MemReqs.alignment);
         VERIFY(m_MemoryAllocation.Size >= MemReqs.size + (AlignedOffset - m_MemoryAllocation.UnalignedOffset), "Size of memory allocation is too small");
@@ -296,6 +296,9 @@ BufferVkImpl :: BufferVkImpl(IReferenceCounters*        pRefCounters,
 
 BufferVkImpl :: ~BufferVkImpl()
 {
+    // The buffer may have been registered as movable and then relocated to a dedicated allocation,
+    // so it is always unregistered. Erasing a buffer that is not registered is harmless.
+    m_pDevice->UnregisterMovableBuffer(*this);
     // Vk object can only be destroyed when it is no longer used by the GPU
     if(m_VulkanBuffer != VK_NULL_HANDLE)
         m_pDevice->SafeReleaseDeviceObject(std::move(m_VulkanBuffer), m_Desc.CommandQueueMask);
@@ -368,6 +371,59 @@ VulkanUtilities::BufferViewWrapper BufferVkImpl::CreateView(struct BufferViewDes
     return BuffView;
 }
 
+bool BufferVkImpl::IsMovable()const
+{
+    static constexpr Uint32 MovableBindFlags = BIND_VERTEX_BUFFER | BIND_INDEX_BUFFER | BIND_INDIRECT_DRAW_ARGS;
+    return m_Desc.Usage == USAGE_STATIC &&
+           (m_Desc.BindFlags & ~MovableBindFlags) == 0 &&
+           m_MemoryAllocation.Page != nullptr &&
+           !m_MemoryAllocation.Page->IsDedicated();
+}
+
+void BufferVkImpl::CreateRelocationTarget(VulkanUtilities::BufferWrapper& NewBuffer, VulkanUtilities::VulkanMemoryAllocation& NewAllocation)
+{
+    VERIFY_EXPR(IsMovable());
+    const auto& LogicalDevice = m_pDevice->GetLogicalDevice();
+
+    VkBufferCreateInfo VkBuffCI = {};
+    VkBuffCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    VkBuffCI.pNext = nullptr;
+    VkBuffCI.flags = 0;
+    VkBuffCI.size  = m_Desc.uiSizeInBytes;
+    VkBuffCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (m_Desc.BindFlags & BIND_VERTEX_BUFFER)
+        VkBuffCI.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    if (m_Desc.BindFlags & BIND_INDEX_BUFFER)
+        VkBuffCI.usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    if (m_Desc.BindFlags & BIND_INDIRECT_DRAW_ARGS)
+        VkBuffCI.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    VkBuffCI.sharingMode           = VK_SHARING_MODE_EXCLUSIVE;
+    VkBuffCI.queueFamilyIndexCount = 0;
+    VkBuffCI.pQueueFamilyIndices   = nullptr;
+
+    NewBuffer = LogicalDevice.CreateBuffer(VkBuffCI, m_Desc.Name);
+
+    VkMemoryRequirements MemReqs = LogicalDevice.GetBufferMemoryRequirements(NewBuffer);
+    // Memory manager never places new allocations in the pages that are being defragmented
+    NewAllocation = m_pDevice->AllocateBufferMemory(NewBuffer, MemReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    auto AlignedOffset = Align(VkDeviceSize{NewAllocation.UnalignedOffset}, MemReqs.alignment);
+    VERIFY(NewAllocation.Size >= MemReqs.size + (AlignedOffset - NewAllocation.UnalignedOffset), "Size of memory allocation is too small");
+    auto err = LogicalDevice.BindBufferMemory(NewBuffer, NewAllocation.Page->GetVkMemory(), AlignedOffset);
+    CHECK_VK_ERROR_AND_THROW(err, "Failed to bind buffer memory");
+}
+
+void BufferVkImpl::CompleteRelocation(VulkanUtilities::BufferWrapper&& NewBuffer, VulkanUtilities::VulkanMemoryAllocation&& NewAllocation)
+{
+    VERIFY_EXPR(m_IsBeingMoved);
+    // The old buffer may still be used by command buffers that have not been completed
+    m_pDevice->SafeReleaseDeviceObject(std::move(m_VulkanBuffer),     m_Desc.CommandQueueMask);
+    m_pDevice->SafeReleaseDeviceObject(std::move(m_MemoryAllocation), m_Desc.CommandQueueMask);
+    m_VulkanBuffer     = std::move(NewBuffer);
+    m_MemoryAllocation = std::move(NewAllocation);
+    m_IsBeingMoved     = false;
+}
+
 VkBuffer BufferVkImpl::GetVkBuffer()const
 {
     if (m_VulkanBuffer != VK_NULL_HANDLE)
@@ -239,6 +239,23 @@ void DescriptorSetAllocator::FreeDescriptorSet(VkDescriptorSet Set, VkDescriptor
 }
 
 
+VulkanUtilities::DescriptorPoolWrapper DynamicDescriptorSetAllocator::AcquirePool()
+{
+    {
+        // The mutex is only shared with the release queue, so it is practically never contended
+        std::lock_guard<std::mutex> Lock{m_Recycled->Mtx};
+        if (!m_Recycled->Pools.empty())
+        {
+            auto Pool = std::move(m_Recycled->Pools.back());
+            m_Recycled->Pools.pop_back();
+            return Pool;
+        }
+    }
+
+    ++m_NumPoolsFromMgr;
+    return m_GlobalPoolMgr.GetPool("Dynamic Descriptor Pool");
+}
+
 VkDescriptorSet DynamicDescriptorSetAllocator::Allocate(VkDescriptorSetLayout SetLayout, const char* DebugName)
 {
     VkDescriptorSet set = VK_NULL_HANDLE;
@@ -246,31 +263,147 @@ VkDescriptorSet DynamicDescriptorSetAllocator::Allocate(VkDescriptorSetLayout Se
     if (!m_AllocatedPools.empty())
     {
         set = AllocateDescriptorSet(LogicalDevice, m_AllocatedPools.back(), SetLayout, DebugName);
+        if (set == VK_NULL_HANDLE)
+            ++m_NumExhaustions;
     }
 
     if (set == VK_NULL_HANDLE)
     {
-        m_AllocatedPools.emplace_back(m_GlobalPoolMgr.GetPool("Dynamic Descriptor Pool"));
+        m_AllocatedPools.emplace_back(AcquirePool());
         set = AllocateDescriptorSet(LogicalDevice, m_AllocatedPools.back(), SetLayout, DebugName);
     }
     
+    if (set != VK_NULL_HANDLE)
+    {
+        ++m_NumFrameSets;
+        ++m_TotalSets;
+    }
     return set;
 }
 
+VkDescriptorSet DynamicDescriptorSetAllocator::FindCachedSet(const DynamicDescriptorSetKey& Key)
+{
+    VERIFY(Key.Hash != 0, "Key hash has not been computed");
+    ++m_ReuseCacheStats.NumLookups;
+    auto it = m_CachedSets.find(Key);
+    if (it == m_CachedSets.end())
+        return VK_NULL_HANDLE;
+
+    ++m_ReuseCacheStats.NumHits;
+    return it->second;
+}
+
+void DynamicDescriptorSetAllocator::CacheSet(const DynamicDescriptorSetKey& Key, VkDescriptorSet Set)
+{
+    VERIFY_EXPR(Set != VK_NULL_HANDLE);
+    m_CachedSets.emplace(Key, Set);
+}
+
 void DynamicDescriptorSetAllocator::ReleasePools(Uint64 QueueMask)
 {
-    for(auto& Pool : m_AllocatedPools)
+    // Sets are freed together with their pools
+    m_CachedSets.clear();
+    m_NumFrameSets = 0;
+    if (m_AllocatedPools.empty())
+        return;
+
+    // All pools of the frame are retired as one batch and are reset when the GPU
+    // completes the frame. The batch then returns the pools to the allocator.
+    class PoolBatchRecycler
     {
-        m_GlobalPoolMgr.DisposePool(std::move(Pool), QueueMask);
-    }
+    public:
+        PoolBatchRecycler(DescriptorPoolManager&                                 _PoolMgr,
+                          std::shared_ptr<RecycledPools>                         _Recycled,
+                          std::vector<VulkanUtilities::DescriptorPoolWrapper>&&  _Pools) noexcept : 
+            PoolMgr  (&_PoolMgr),
+            Recycled (std::move(_Recycled)),
+            Pools    (std::move(_Pools))
+        {}
+
+        PoolBatchRecycler             (const PoolBatchRecycler&) = delete;
+        PoolBatchRecycler& operator = (const PoolBatchRecycler&) = delete;
+        PoolBatchRecycler& operator = (      PoolBatchRecycler&&)= delete;
+
+        PoolBatchRecycler(PoolBatchRecycler&& rhs)noexcept : 
+            PoolMgr  (rhs.PoolMgr),
+            Recycled (std::move(rhs.Recycled)),
+            Pools    (std::move(rhs.Pools))
+        {
+            rhs.PoolMgr = nullptr;
+        }
+
+        ~PoolBatchRecycler()
+        {
+            if (PoolMgr == nullptr)
+                return;
+
+            const auto& LogicalDevice = PoolMgr->GetDeviceVkImpl().GetLogicalDevice();
+            for (auto& Pool : Pools)
+                LogicalDevice.ResetDescriptorPool(Pool);
+
+            std::lock_guard<std::mutex> Lock{Recycled->Mtx};
+            VERIFY_EXPR(Recycled->NumPending >= Pools.size());
+            Recycled->NumPending -= static_cast<Uint32>(Pools.size());
+            for (auto& Pool : Pools)
+            {
+                if (Recycled->Detached)
+                    PoolMgr->FreePool(std::move(Pool));
+                else
+                    Recycled->Pools.emplace_back(std::move(Pool));
+            }
+        }
+
+    private:
+        DescriptorPoolManager*                              PoolMgr;
+        std::shared_ptr<RecycledPools>                      Recycled;
+        std::vector<VulkanUtilities::DescriptorPoolWrapper> Pools;
+    };
+
     m_PeakPoolCount = std::max(m_PeakPoolCount, m_AllocatedPools.size());
-    m_AllocatedPools.clear();
+    {
+        std::lock_guard<std::mutex> Lock{m_Recycled->Mtx};
+        m_Recycled->NumPending += static_cast<Uint32>(m_AllocatedPools.size());
+    }
+    std::vector<VulkanUtilities::DescriptorPoolWrapper> Pools;
+    Pools.swap(m_AllocatedPools);
+    m_GlobalPoolMgr.GetDeviceVkImpl().SafeReleaseDeviceObject(PoolBatchRecycler{m_GlobalPoolMgr, m_Recycled, std::move(Pools)}, QueueMask);
+}
+
+DynamicDescriptorSetAllocator::ArenaStats DynamicDescriptorSetAllocator::GetArenaStats()const
+{
+    ArenaStats Stats;
+    Stats.NumActivePools  = static_cast<Uint32>(m_AllocatedPools.size());
+    Stats.PeakPoolCount   = static_cast<Uint32>(std::max(m_PeakPoolCount, m_AllocatedPools.size()));
+    Stats.NumFrameSets    = m_NumFrameSets;
+    Stats.TotalSets       = m_TotalSets;
+    Stats.NumExhaustions  = m_NumExhaustions;
+    Stats.NumPoolsFromMgr = m_NumPoolsFromMgr;
+    {
+        std::lock_guard<std::mutex> Lock{m_Recycled->Mtx};
+        Stats.NumPendingPools  = m_Recycled->NumPending;
+        Stats.NumRecycledPools = static_cast<Uint32>(m_Recycled->Pools.size());
+    }
+    return Stats;
 }
 
 DynamicDescriptorSetAllocator::~DynamicDescriptorSetAllocator()
 {
     DEV_CHECK_ERR(m_AllocatedPools.empty(), "All allocated pools must be returned to the parent descriptor pool manager");
-    LOG_INFO_MESSAGE(m_Name, " peak descriptor pool count: ", m_PeakPoolCount);
+    {
+        // Batches that are still in the release queue will return their pools directly to the global manager
+        std::lock_guard<std::mutex> Lock{m_Recycled->Mtx};
+        m_Recycled->Detached = true;
+        for (auto& Pool : m_Recycled->Pools)
+            m_GlobalPoolMgr.FreePool(std::move(Pool));
+        m_Recycled->Pools.clear();
+    }
+    LOG_INFO_MESSAGE(m_Name, " peak descriptor pool count: ", m_PeakPoolCount, ", pools requested from the global manager: ", m_NumPoolsFromMgr,
+                     ", total sets allocated: ", m_TotalSets, ", pool exhaustion events: ", m_NumExhaustions);
+    if (m_ReuseCacheStats.NumLookups != 0)
+    {
+        LOG_INFO_MESSAGE(m_Name, " descriptor set reuse rate: ", m_ReuseCacheStats.NumHits, '/', m_ReuseCacheStats.NumLookups,
+                         " (", std::fixed, std::setprecision(1), static_cast<double>(m_ReuseCacheStats.NumHits) / static_cast<double>(m_ReuseCacheStats.NumLookups) * 100.0, "%)");
+    }
 }
 
 }
@@ -33,6 +33,7 @@
 #include "CommandListVkImpl.h"
 #include "FenceVkImpl.h"
 #include "GraphicsAccessories.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -93,7 +94,7 @@ namespace Diligent
         },
         m_GenerateMipsHelper{std::move(GenerateMipsHelper)}
     {
-        m_GenerateMipsHelper->CreateSRB(&m_GenerateMipsSRB);
+        m_GenerateMipsHelper->CreateSRB(&m_GenerateMipsSRB, &m_GenerateMipsSinglePassSRB, &m_GenerateMipsSinglePassCounters);
 
         BufferDesc DummyVBDesc;
         DummyVBDesc.Name          = "Dummy vertex buffer";
@@ -126,6 +127,15 @@ namespace Diligent
             Flush();
         }
 
+        // Moves that have not been completed are abandoned: buffers keep their original memory
+        for (auto& Move : m_PendingBufferMoves)
+        {
+            Move.pBuffer->m_IsBeingMoved = false;
+            m_pDevice->SafeReleaseDeviceObject(std::move(Move.NewBuffer),     Uint64{1} << m_CommandQueueId);
+            m_pDevice->SafeReleaseDeviceObject(std::move(Move.NewAllocation), Uint64{1} << m_CommandQueueId);
+        }
+        m_PendingBufferMoves.clear();
+
         // For deferred contexts, m_SubmittedBuffersCmdQueueMask is reset to 0 after every call to FinishFrame().
         // In this case there are no resources to release, so there will be no issues.
         FinishFrame();
@@ -137,9 +147,18 @@ namespace Diligent
 
         auto VkCmdPool = m_CmdPool.Release();
         m_pDevice->SafeReleaseDeviceObject(std::move(VkCmdPool), ~Uint64{0});
+        if (m_SecondaryCmdPool)
+        {
+            auto VkSecondaryCmdPool = m_SecondaryCmdPool->Release();
+            m_pDevice->SafeReleaseDeviceObject(std::move(VkSecondaryCmdPool), ~Uint64{0});
+        }
         
         m_pDevice->SafeReleaseDeviceObject(std::move(m_GenerateMipsHelper), ~Uint64{0});
         m_pDevice->SafeReleaseDeviceObject(std::move(m_GenerateMipsSRB),    ~Uint64{0});
+        if (m_GenerateMipsSinglePassSRB)
+            m_pDevice->SafeReleaseDeviceObject(std::move(m_GenerateMipsSinglePassSRB), ~Uint64{0});
+        if (m_GenerateMipsSinglePassCounters)
+            m_pDevice->SafeReleaseDeviceObject(std::move(m_GenerateMipsSinglePassCounters), ~Uint64{0});
         m_pDevice->SafeReleaseDeviceObject(std::move(m_DummyVB),            ~Uint64{0});
 
         // The main reason we need to idle the GPU is because we need to make sure that all command buffers are returned to the
@@ -147,13 +166,15 @@ namespace Diligent
         // do not really need to wait for GPU to idle.
         m_pDevice->IdleGPU();
         DEV_CHECK_ERR(m_CmdPool.DvpGetBufferCounter() == 0, "All command buffers must have been returned to the pool");
+        DEV_CHECK_ERR(!m_SecondaryCmdPool || m_SecondaryCmdPool->DvpGetBufferCounter() == 0, "All secondary command buffers must have been returned to the pool");
     }
 
     IMPLEMENT_QUERY_INTERFACE( DeviceContextVkImpl, IID_DeviceContextVk, TDeviceContextBase )
 
-    void DeviceContextVkImpl::DisposeVkCmdBuffer(Uint32 CmdQueue, VkCommandBuffer vkCmdBuff, Uint64 FenceValue)
+    void DeviceContextVkImpl::DisposeVkCmdBuffer(Uint32 CmdQueue, VkCommandBuffer vkCmdBuff, Uint64 FenceValue, bool IsSecondary)
     {
         VERIFY_EXPR(vkCmdBuff != VK_NULL_HANDLE);
+        VERIFY(!IsSecondary || m_SecondaryCmdPool, "Secondary command buffer pool has not been created");
         class CmdBufferDeleter
         {
         public:
@@ -191,7 +212,8 @@ namespace Diligent
         };
 
         auto& ReleaseQueue = m_pDevice->GetReleaseQueue(CmdQueue);
-        ReleaseQueue.DiscardResource(CmdBufferDeleter{vkCmdBuff, m_CmdPool}, FenceValue);
+        auto& Pool = IsSecondary ? *m_SecondaryCmdPool : m_CmdPool;
+        ReleaseQueue.DiscardResource(CmdBufferDeleter{vkCmdBuff, Pool}, FenceValue);
     }
 
     inline void DeviceContextVkImpl::DisposeCurrentCmdBuffer(Uint32 CmdQueue, Uint64 FenceValue)
@@ -269,6 +291,8 @@ namespace Diligent
         }
 
         m_DescrSetBindInfo.Reset();
+        // Push constants must be recorded again with the layout of the new pipeline
+        m_State.CommittedPushConstantsUpToDate = false;
     }
 
     void DeviceContextVkImpl::TransitionShaderResources(IPipelineState *pPipelineState, IShaderResourceBinding *pShaderResourceBinding)
@@ -281,6 +305,7 @@ namespace Diligent
 
     void DeviceContextVkImpl::CommitShaderResources(IShaderResourceBinding *pShaderResourceBinding, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode, bool bCheckUAVSRV)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextVkImpl::CommitShaderResources");
         if (!DeviceContextBase::CommitShaderResources(pShaderResourceBinding, StateTransitionMode, 0 /*Dummy*/))
             return;
 
@@ -305,6 +330,26 @@ namespace Diligent
         }
     }
 
+    void DeviceContextVkImpl::SetPushConstants(const void* pData, Uint32 Offset, Uint32 Size)
+    {
+        if (TDeviceContextBase::SetPushConstants(pData, Offset, Size, 0))
+        {
+            // Push constants are recorded by the next draw or dispatch command, so that
+            // the application can set them before the pipeline state
+            m_State.CommittedPushConstantsUpToDate = false;
+        }
+    }
+
+    void DeviceContextVkImpl::CommitPushConstants()
+    {
+        const auto& Range = m_pPipelineState->GetPipelineLayout().GetPushConstantRange();
+        if (Range.size != 0)
+        {
+            m_CommandBuffer.PushConstants(m_pPipelineState->GetPipelineLayout().GetVkPipelineLayout(), Range.stageFlags, Range.offset, Range.size, m_PushConstants + Range.offset);
+        }
+        m_State.CommittedPushConstantsUpToDate = true;
+    }
+
     void DeviceContextVkImpl::CommitVkVertexBuffers()
     {
 #ifdef DEVELOPMENT
@@ -393,6 +438,7 @@ namespace Diligent
 
     void DeviceContextVkImpl::PrepareForDraw(DRAW_FLAGS Flags)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextVkImpl::PrepareForDraw");
 #ifdef DEVELOPMENT
         if ((Flags & DRAW_FLAG_VERIFY_RENDER_TARGETS) != 0)
             DvpVerifyRenderTargets();
@@ -405,6 +451,11 @@ namespace Diligent
             CommitVkVertexBuffers();
         }
 
+        if (!m_State.CommittedPushConstantsUpToDate)
+        {
+            CommitPushConstants();
+        }
+
 #ifdef DEVELOPMENT
         if ((Flags & DRAW_FLAG_VERIFY_STATES) != 0)
         {
@@ -541,6 +592,11 @@ namespace Diligent
         if (m_CommandBuffer.GetState().RenderPass != VK_NULL_HANDLE)
             m_CommandBuffer.EndRenderPass();
 
+        if (!m_State.CommittedPushConstantsUpToDate)
+        {
+            CommitPushConstants();
+        }
+
         if (m_DescrSetBindInfo.DynamicOffsetCount != 0)
         {
             if (!m_DescrSetBindInfo.DynamicDescriptorsBound || m_DescrSetBindInfo.DynamicBuffersPresent)
@@ -561,6 +617,7 @@ namespace Diligent
 
     void DeviceContextVkImpl::DispatchCompute(const DispatchComputeAttribs& Attribs)
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextVkImpl::DispatchCompute");
         if (!DvpVerifyDispatchArguments(Attribs))
             return;
 
@@ -873,6 +930,7 @@ namespace Diligent
 
     void DeviceContextVkImpl::Flush()
     {
+        DILIGENT_PROFILE_SCOPE("DeviceContextVkImpl::Flush");
         if (m_bIsDeferred)
         {
             LOG_ERROR_MESSAGE("Flush() should only be called for immediate contexts");
@@ -922,6 +980,25 @@ namespace Diligent
             DisposeCurrentCmdBuffer(m_CommandQueueId, SubmittedFenceValue);
         }
 
+        // Secondary command buffers were executed by the primary command buffer that has just been submitted
+        for (auto& SecondaryCmdBuff : m_PendingSecondaryCmdBuffers)
+        {
+            SecondaryCmdBuff.first->DisposeVkCmdBuffer(m_CommandQueueId, SecondaryCmdBuff.second, SubmittedFenceValue, true /*IsSecondary*/);
+        }
+        m_PendingSecondaryCmdBuffers.clear();
+
+        for (auto& Move : m_PendingBufferMoves)
+        {
+            if (Move.FenceValue == ~Uint64{0})
+                Move.FenceValue = SubmittedFenceValue;
+        }
+
+        for (auto& pQuery : m_EndedQueries)
+        {
+            pQuery->SetQueryEndFenceValue(SubmittedFenceValue);
+        }
+        m_EndedQueries.clear();
+
         m_State = ContextState{};
         m_DescrSetBindInfo.Reset();
         m_CommandBuffer.Reset();
@@ -1102,6 +1179,12 @@ namespace Diligent
                     TransitionRenderTargets(RESOURCE_STATE_TRANSITION_MODE_VERIFY);
                 }
 #endif
+                if (!m_bIsDeferred)
+                {
+                    // Queries can't be reset inside render pass, so make stale queries available
+                    // to the queries that may be begun in this pass
+                    ResetStaleQueries();
+                }
                 m_CommandBuffer.BeginRenderPass(m_RenderPass, m_Framebuffer, m_FramebufferWidth, m_FramebufferHeight);
             }
         }
@@ -1267,6 +1350,83 @@ namespace Diligent
         ++m_State.NumCommands;
     }
 
+    void DeviceContextVkImpl::DefragmentMemory(Uint64 MaxBytesToMove)
+    {
+        if (m_bIsDeferred)
+        {
+            LOG_ERROR_MESSAGE("Memory can only be defragmented by immediate contexts");
+            return;
+        }
+
+        CompleteBufferMoves();
+        if (MaxBytesToMove == 0)
+            return;
+
+        std::vector<RefCntAutoPtr<BufferVkImpl>> Buffers;
+        m_pDevice->SelectBuffersToDefragment(MaxBytesToMove, Buffers);
+        if (Buffers.empty())
+            return;
+
+        EnsureVkCmdBuffer();
+        // Static buffers are only read by the GPU, so the data in the new buffer must be
+        // made available to all read accesses the buffer may be used for
+        constexpr VkAccessFlags ReadAccessFlags = 
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+            VK_ACCESS_INDEX_READ_BIT            |
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+            VK_ACCESS_TRANSFER_READ_BIT;
+        for (auto& pBuffer : Buffers)
+        {
+            PendingBufferMove Move;
+            try
+            {
+                pBuffer->CreateRelocationTarget(Move.NewBuffer, Move.NewAllocation);
+            }
+            catch (const std::runtime_error&)
+            {
+                LOG_ERROR_MESSAGE("Failed to create relocation target for buffer '", pBuffer->GetDesc().Name, "'");
+                pBuffer->m_IsBeingMoved = false;
+                continue;
+            }
+
+            // Buffer state is not changed as the source buffer may be used by other commands recorded later 
+            m_CommandBuffer.BufferMemoryBarrier(pBuffer->GetVkBuffer(), pBuffer->GetAccessFlags(), VK_ACCESS_TRANSFER_READ_BIT);
+            m_CommandBuffer.BufferMemoryBarrier(Move.NewBuffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+            VkBufferCopy CopyRegion;
+            CopyRegion.srcOffset = 0;
+            CopyRegion.dstOffset = 0;
+            CopyRegion.size      = pBuffer->GetDesc().uiSizeInBytes;
+            m_CommandBuffer.CopyBuffer(pBuffer->GetVkBuffer(), Move.NewBuffer, 1, &CopyRegion);
+
+            m_CommandBuffer.BufferMemoryBarrier(Move.NewBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, ReadAccessFlags);
+            ++m_State.NumCommands;
+
+            Move.pBuffer = std::move(pBuffer);
+            m_PendingBufferMoves.emplace_back(std::move(Move));
+        }
+    }
+
+    void DeviceContextVkImpl::CompleteBufferMoves()
+    {
+        if (m_PendingBufferMoves.empty())
+            return;
+
+        auto CompletedFenceValue = m_pDevice->GetCompletedFenceValue(m_CommandQueueId);
+        auto it = m_PendingBufferMoves.begin();
+        while (it != m_PendingBufferMoves.end())
+        {
+            if (it->FenceValue <= CompletedFenceValue)
+            {
+                m_pDevice->OnBufferMoved(it->pBuffer->GetDesc().uiSizeInBytes);
+                it->pBuffer->CompleteRelocation(std::move(it->NewBuffer), std::move(it->NewAllocation));
+                it = m_PendingBufferMoves.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
     void DeviceContextVkImpl::MapBuffer(IBuffer* pBuffer, MAP_TYPE MapType, MAP_FLAGS MapFlags, PVoid& pMappedData)
     {
         TDeviceContextBase::MapBuffer(pBuffer, MapType, MapFlags, pMappedData);
@@ -1645,7 +1805,7 @@ namespace Diligent
     void DeviceContextVkImpl::GenerateMips(ITextureView* pTexView)
     {
         TDeviceContextBase::GenerateMips(pTexView);
-        m_GenerateMipsHelper->GenerateMips(*ValidatedCast<TextureViewVkImpl>(pTexView), *this, *m_GenerateMipsSRB);
+        m_GenerateMipsHelper->GenerateMips(*ValidatedCast<TextureViewVkImpl>(pTexView), *this, *m_GenerateMipsSRB, m_GenerateMipsSinglePassSRB, m_GenerateMipsSinglePassCounters);
     }
 
     static VkBufferImageCopy GetBufferImageCopyInfo(Uint32              BufferOffset,
@@ -1911,7 +2071,8 @@ namespace Diligent
 
     void DeviceContextVkImpl::FinishCommandList(class ICommandList **ppCommandList)
     {
-        if (m_CommandBuffer.GetState().RenderPass != VK_NULL_HANDLE)
+        // The render pass inherited by the secondary command buffer is ended by the primary command buffer
+        if (m_CommandBuffer.GetState().RenderPass != VK_NULL_HANDLE && !m_IsSecondaryCmdBuffer)
         {
             m_CommandBuffer.EndRenderPass();
         }
@@ -1920,10 +2081,14 @@ namespace Diligent
         auto err = vkEndCommandBuffer(vkCmdBuff);
         DEV_CHECK_ERR(err == VK_SUCCESS, "Failed to end command buffer"); (void)err;
 
+        const auto& CmdBuffState = m_CommandBuffer.GetState();
         CommandListVkImpl *pCmdListVk( NEW_RC_OBJ(m_CmdListAllocator, "CommandListVkImpl instance", CommandListVkImpl)
-                                                 (m_pDevice, this, vkCmdBuff) );
+                                                 (m_pDevice, this, vkCmdBuff,
+                                                  m_IsSecondaryCmdBuffer ? CmdBuffState.RenderPass  : VK_NULL_HANDLE,
+                                                  m_IsSecondaryCmdBuffer ? CmdBuffState.Framebuffer : VK_NULL_HANDLE) );
         pCmdListVk->QueryInterface( IID_CommandList, reinterpret_cast<IObject**>(ppCommandList) );
 
+        m_IsSecondaryCmdBuffer = false;
         m_CommandBuffer.Reset();
         m_State = ContextState{};
         m_DescrSetBindInfo.Reset();
@@ -1933,6 +2098,11 @@ namespace Diligent
     }
 
     void DeviceContextVkImpl::ExecuteCommandList(class ICommandList *pCommandList)
+    {
+        ExecuteCommandLists(1, &pCommandList);
+    }
+
+    void DeviceContextVkImpl::ExecuteCommandLists(Uint32 NumCommandLists, class ICommandList* const* ppCommandLists)
     {
         if (m_bIsDeferred)
         {
@@ -1940,29 +2110,198 @@ namespace Diligent
             return;
         }
 
+        if (NumCommandLists == 0)
+            return;
+        DEV_CHECK_ERR(ppCommandLists != nullptr, "ppCommandLists must not be null when NumCommandLists is not zero");
+
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+        {
+            if (ValidatedCast<CommandListVkImpl>(ppCommandLists[i])->IsSecondary())
+            {
+                LOG_ERROR_MESSAGE("Secondary command lists can only be executed by ExecuteSecondaryCommandLists()");
+                return;
+            }
+        }
+
         Flush();
 
         InvalidateState();
 
-        CommandListVkImpl* pCmdListVk = ValidatedCast<CommandListVkImpl>(pCommandList);
-        VkCommandBuffer vkCmdBuff = VK_NULL_HANDLE;
-        RefCntAutoPtr<IDeviceContext> pDeferredCtx;
-        pCmdListVk->Close(vkCmdBuff, pDeferredCtx);
-        VERIFY(vkCmdBuff != VK_NULL_HANDLE, "Trying to execute empty command buffer");
-        VERIFY_EXPR(pDeferredCtx);
+        std::vector<VkCommandBuffer>               vkCmdBuffs  (NumCommandLists);
+        std::vector<RefCntAutoPtr<IDeviceContext>> DeferredCtxs(NumCommandLists);
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+        {
+            CommandListVkImpl* pCmdListVk = ValidatedCast<CommandListVkImpl>(ppCommandLists[i]);
+            pCmdListVk->Close(vkCmdBuffs[i], DeferredCtxs[i]);
+            VERIFY(vkCmdBuffs[i] != VK_NULL_HANDLE, "Trying to execute empty command buffer");
+            VERIFY_EXPR(DeferredCtxs[i]);
+        }
+
+        // All command buffers are submitted by one vkQueueSubmit call and signal the same fence value
         VkSubmitInfo SubmitInfo = {};
         SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         SubmitInfo.pNext              = nullptr;
-        SubmitInfo.commandBufferCount = 1;
-        SubmitInfo.pCommandBuffers    = &vkCmdBuff;
+        SubmitInfo.commandBufferCount = NumCommandLists;
+        SubmitInfo.pCommandBuffers    = vkCmdBuffs.data();
         VERIFY_EXPR(m_PendingFences.empty());
-        auto pDeferredCtxVkImpl = pDeferredCtx.RawPtr<DeviceContextVkImpl>();
         auto SubmittedFenceValue = m_pDevice->ExecuteCommandBuffer(m_CommandQueueId, SubmitInfo, this, nullptr);
-        // Set the bit in the deferred context cmd queue mask corresponding to cmd queue of this context
-        pDeferredCtxVkImpl->m_SubmittedBuffersCmdQueueMask |= Uint64{1} << m_CommandQueueId;
-        // It is OK to dispose command buffer from another thread. We are not going to
-        // record any commands and only need to add the buffer to the queue
-        pDeferredCtxVkImpl->DisposeVkCmdBuffer(m_CommandQueueId, vkCmdBuff, SubmittedFenceValue);
+
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+        {
+            auto pDeferredCtxVkImpl = DeferredCtxs[i].RawPtr<DeviceContextVkImpl>();
+            // Set the bit in the deferred context cmd queue mask corresponding to cmd queue of this context
+            pDeferredCtxVkImpl->m_SubmittedBuffersCmdQueueMask |= Uint64{1} << m_CommandQueueId;
+            // It is OK to dispose command buffer from another thread. We are not going to
+            // record any commands and only need to add the buffer to the queue
+            pDeferredCtxVkImpl->DisposeVkCmdBuffer(m_CommandQueueId, vkCmdBuffs[i], SubmittedFenceValue);
+        }
+    }
+
+    void DeviceContextVkImpl::BeginSecondaryCommandList(Uint32 NumRenderTargets, ITextureView* ppRenderTargets[], ITextureView* pDepthStencil)
+    {
+        if (!m_bIsDeferred)
+        {
+            LOG_ERROR_MESSAGE("Secondary command lists can only be recorded by deferred contexts");
+            return;
+        }
+
+        if (m_CommandBuffer.GetVkCmdBuffer() != VK_NULL_HANDLE)
+        {
+            LOG_ERROR_MESSAGE("Secondary command list must be started before any command is recorded into the context. Call FinishCommandList() first.");
+            return;
+        }
+
+        // Render targets must already be in the required states, and no barriers
+        // are allowed inside the render pass
+        m_IsSecondaryCmdBuffer = true;
+        SetRenderTargets(NumRenderTargets, ppRenderTargets, pDepthStencil, RESOURCE_STATE_TRANSITION_MODE_NONE);
+        if (m_RenderPass == VK_NULL_HANDLE)
+        {
+            LOG_ERROR_MESSAGE("At least one render target or depth-stencil view must be provided to begin secondary command list");
+            m_IsSecondaryCmdBuffer = false;
+            return;
+        }
+
+        EnsureVkCmdBuffer();
+    }
+
+    void DeviceContextVkImpl::BeginSecondaryVkCmdBuffer()
+    {
+        VERIFY_EXPR(m_bIsDeferred && m_IsSecondaryCmdBuffer);
+        VERIFY(m_RenderPass != VK_NULL_HANDLE, "Render pass must be known when secondary command buffer is started");
+
+        if (!m_SecondaryCmdPool)
+        {
+            m_SecondaryCmdPool.reset(
+                new VulkanUtilities::VulkanCommandBufferPool
+                {
+                    m_pDevice->GetLogicalDevice().GetSharedPtr(),
+                    m_pDevice->GetCommandQueue(m_CommandQueueId).GetQueueFamilyIndex(),
+                    VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                    VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                }
+            );
+        }
+
+        VkCommandBufferInheritanceInfo InheritanceInfo = {};
+        InheritanceInfo.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        InheritanceInfo.pNext                = nullptr;
+        InheritanceInfo.renderPass           = m_RenderPass; // The command buffer can be executed within any compatible render pass
+        InheritanceInfo.subpass              = 0;
+        InheritanceInfo.framebuffer          = m_Framebuffer; // Optional, but may let the implementation generate better code
+        // Inherited queries are not enabled, so ExecuteSecondaryCommandLists() requires that no query be active
+        InheritanceInfo.occlusionQueryEnable = VK_FALSE;
+        InheritanceInfo.queryFlags           = 0;
+        InheritanceInfo.pipelineStatistics   = 0;
+
+        auto vkCmdBuff = m_SecondaryCmdPool->GetCommandBuffer("", &InheritanceInfo);
+        m_CommandBuffer.SetVkCmdBuffer(vkCmdBuff);
+        m_CommandBuffer.SetInheritedRenderPass(m_RenderPass, m_Framebuffer, m_FramebufferWidth, m_FramebufferHeight);
+    }
+
+    void DeviceContextVkImpl::ExecuteSecondaryCommandLists(Uint32 NumCommandLists, ICommandList* const* ppCommandLists)
+    {
+        if (m_bIsDeferred)
+        {
+            LOG_ERROR_MESSAGE("Only immediate context can execute secondary command lists");
+            return;
+        }
+
+        if (NumCommandLists == 0)
+            return;
+        DEV_CHECK_ERR(ppCommandLists != nullptr, "ppCommandLists must not be null when NumCommandLists is not zero");
+
+        if (m_Framebuffer == VK_NULL_HANDLE)
+        {
+            LOG_ERROR_MESSAGE("Render targets must be bound to execute secondary command lists");
+            return;
+        }
+
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+        {
+            const auto* pCmdListVk = ValidatedCast<CommandListVkImpl>(ppCommandLists[i]);
+            if (!pCmdListVk->IsSecondary())
+            {
+                LOG_ERROR_MESSAGE("Command list that was not recorded with BeginSecondaryCommandList() can't be executed inside render pass");
+                return;
+            }
+            // Render passes and framebuffers are cached by the device, so the same render targets always
+            // produce the same objects
+            if (pCmdListVk->GetInheritedRenderPass() != m_RenderPass || pCmdListVk->GetInheritedFramebuffer() != m_Framebuffer)
+            {
+                LOG_ERROR_MESSAGE("Secondary command list ", i, " was recorded for render targets that are different from the ones "
+                                  "currently bound to the context. The same render targets must be bound to execute the command list.");
+                return;
+            }
+        }
+
+        if (m_CommandBuffer.GetState().NumActiveQueries != 0)
+        {
+            LOG_ERROR_MESSAGE("Secondary command lists can't be executed while an occlusion or pipeline statistics query is active. "
+                              "End all such queries before calling ExecuteSecondaryCommandLists().");
+            return;
+        }
+
+        EnsureVkCmdBuffer();
+        if (m_CommandBuffer.GetState().RenderPass != VK_NULL_HANDLE)
+        {
+            m_CommandBuffer.EndRenderPass();
+        }
+#ifdef DEVELOPMENT
+        TransitionRenderTargets(RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+#endif
+        ResetStaleQueries();
+        m_CommandBuffer.FlushBarriers();
+        m_CommandBuffer.BeginRenderPass(m_RenderPass, m_Framebuffer, m_FramebufferWidth, m_FramebufferHeight, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        std::vector<VkCommandBuffer> vkCmdBuffs(NumCommandLists);
+        for (Uint32 i = 0; i < NumCommandLists; ++i)
+        {
+            CommandListVkImpl* pCmdListVk = ValidatedCast<CommandListVkImpl>(ppCommandLists[i]);
+            RefCntAutoPtr<IDeviceContext> pDeferredCtx;
+            pCmdListVk->Close(vkCmdBuffs[i], pDeferredCtx);
+            VERIFY(vkCmdBuffs[i] != VK_NULL_HANDLE, "Trying to execute empty command buffer");
+            VERIFY_EXPR(pDeferredCtx);
+
+            RefCntAutoPtr<DeviceContextVkImpl> pDeferredCtxVkImpl{pDeferredCtx.RawPtr<DeviceContextVkImpl>()};
+            // Set the bit in the deferred context cmd queue mask corresponding to cmd queue of this context
+            pDeferredCtxVkImpl->m_SubmittedBuffersCmdQueueMask |= Uint64{1} << m_CommandQueueId;
+            // The command buffer is returned to the pool of the deferred context after the
+            // primary command buffer is submitted by Flush()
+            m_PendingSecondaryCmdBuffers.emplace_back(std::move(pDeferredCtxVkImpl), vkCmdBuffs[i]);
+        }
+
+        m_CommandBuffer.ExecuteCommands(NumCommandLists, vkCmdBuffs.data());
+        m_CommandBuffer.EndRenderPass();
+
+        // Pipeline, descriptor sets, push constants, vertex and index buffers set in the primary command buffer
+        // are undefined after vkCmdExecuteCommands
+        m_State.CommittedVBsUpToDate           = false;
+        m_State.CommittedIBUpToDate            = false;
+        m_State.CommittedPushConstantsUpToDate = false;
+        m_DescrSetBindInfo.Reset();
+        m_pPipelineState = nullptr;
+        ++m_State.NumCommands;
     }
 
     void DeviceContextVkImpl::SignalFence(IFence* pFence, Uint64 Value)
@@ -1980,6 +2319,89 @@ namespace Diligent
         pFenceVk->Wait(Value);
     }
 
+    void DeviceContextVkImpl::ResetStaleQueries()
+    {
+        auto& QueryMgr = m_pDevice->GetQueryManager();
+        if (QueryMgr.HasStaleQueries())
+        {
+            QueryMgr.ResetStaleQueries(m_CommandBuffer);
+        }
+    }
+
+    void DeviceContextVkImpl::BeginQuery(IQuery* pQuery)
+    {
+        if (m_bIsDeferred)
+        {
+            LOG_ERROR_MESSAGE("Queries are only supported in immediate contexts");
+            return;
+        }
+
+        EnsureVkCmdBuffer();
+
+        // Stale queries must be reset before the query slots are allocated. Inside a render pass
+        // this has already been done when the pass was begun, as resetting queries would end it.
+        const bool InsideRenderPass = m_CommandBuffer.GetState().RenderPass != VK_NULL_HANDLE;
+        if (!InsideRenderPass)
+            ResetStaleQueries();
+
+        auto* pQueryVkImpl = ValidatedCast<QueryVkImpl>(pQuery);
+        if (!pQueryVkImpl->OnBeginQuery(this))
+            return;
+
+        const auto  QueryType   = pQueryVkImpl->GetDesc().Type;
+        const auto& QueryMgr    = m_pDevice->GetQueryManager();
+        const auto  vkQueryPool = QueryMgr.GetQueryPool(QueryType);
+        if (QueryType == QUERY_TYPE_DURATION)
+        {
+            m_CommandBuffer.WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, pQueryVkImpl->GetQueryPoolIndex(0));
+        }
+        else
+        {
+            const auto Flags = QueryType == QUERY_TYPE_OCCLUSION ? QueryMgr.GetOcclusionQueryFlags() : 0;
+            pQueryVkImpl->SetBegunInsideRenderPass(InsideRenderPass);
+            m_CommandBuffer.BeginQuery(vkQueryPool, pQueryVkImpl->GetQueryPoolIndex(0), Flags);
+        }
+        ++m_State.NumCommands;
+    }
+
+    void DeviceContextVkImpl::EndQuery(IQuery* pQuery)
+    {
+        if (m_bIsDeferred)
+        {
+            LOG_ERROR_MESSAGE("Queries are only supported in immediate contexts");
+            return;
+        }
+
+        EnsureVkCmdBuffer();
+
+        auto* pQueryVkImpl = ValidatedCast<QueryVkImpl>(pQuery);
+        // Timestamp query slots are allocated by OnEndQuery(), so reset stale queries first (see BeginQuery())
+        if (pQueryVkImpl->GetDesc().Type == QUERY_TYPE_TIMESTAMP && m_CommandBuffer.GetState().RenderPass == VK_NULL_HANDLE)
+            ResetStaleQueries();
+
+        if (!pQueryVkImpl->OnEndQuery(this))
+            return;
+
+        const auto QueryType   = pQueryVkImpl->GetDesc().Type;
+        const auto vkQueryPool = m_pDevice->GetQueryManager().GetQueryPool(QueryType);
+        switch (QueryType)
+        {
+            case QUERY_TYPE_TIMESTAMP:
+                m_CommandBuffer.WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, pQueryVkImpl->GetQueryPoolIndex(0));
+                break;
+
+            case QUERY_TYPE_DURATION:
+                m_CommandBuffer.WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkQueryPool, pQueryVkImpl->GetQueryPoolIndex(1));
+                break;
+
+            default:
+                m_CommandBuffer.EndQuery(vkQueryPool, pQueryVkImpl->GetQueryPoolIndex(0), pQueryVkImpl->IsBegunInsideRenderPass());
+        }
+        ++m_State.NumCommands;
+
+        m_EndedQueries.emplace_back(pQueryVkImpl);
+    }
+
     void DeviceContextVkImpl::WaitForIdle()
     {
         VERIFY(!m_bIsDeferred, "Only immediate contexts can be idled");
@@ -181,6 +181,8 @@ void EngineFactoryVkImpl::CreateDeviceAndContextsVk(const EngineVkCreateInfo& _E
         ENABLE_FEATURE(vertexPipelineStoresAndAtomics)
         ENABLE_FEATURE(fragmentStoresAndAtomics)
         ENABLE_FEATURE(shaderStorageImageExtendedFormats)
+        ENABLE_FEATURE(occlusionQueryPrecise)
+        ENABLE_FEATURE(pipelineStatisticsQuery)
 #undef ENABLE_FEATURE
 
         DeviceCreateInfo.pEnabledFeatures = &DeviceFeatures; // NULL or a pointer to a VkPhysicalDeviceFeatures structure that contains 
@@ -191,6 +193,19 @@ void EngineFactoryVkImpl::CreateDeviceAndContextsVk(const EngineVkCreateInfo& _E
             VK_KHR_SWAPCHAIN_EXTENSION_NAME, 
             VK_KHR_MAINTENANCE1_EXTENSION_NAME // To allow negative viewport height
         };
+        // Dedicated allocation extension lets the driver optimize memory that is used by a single resource
+        if (PhysicalDevice->IsExtensionSupported(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) &&
+            PhysicalDevice->IsExtensionSupported(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME))
+        {
+            DeviceExtensions.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
+            DeviceExtensions.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+        }
+        // Memory budget extension reports per-heap budget and usage of the process
+        if (Instance->IsPhysicalDeviceProperties2Enabled() &&
+            PhysicalDevice->IsExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+        {
+            DeviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
         DeviceCreateInfo.ppEnabledExtensionNames = DeviceExtensions.empty() ? nullptr : DeviceExtensions.data();
         DeviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(DeviceExtensions.size());
 
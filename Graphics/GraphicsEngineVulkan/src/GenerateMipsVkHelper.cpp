@@ -28,8 +28,10 @@
 #include "DeviceContextVkImpl.h"
 #include "TextureViewVkImpl.h"
 #include "TextureVkImpl.h"
+#include "BufferVkImpl.h"
 #include "MapHelper.h"
 #include "PlatformMisc.h"
+#include "Align.h"
 #include "VulkanTypeConversions.h"
 #include "../../GraphicsTools/include/ShaderMacroHelper.h"
 #include "../../GraphicsTools/include/CommonlyUsedStates.h"
@@ -40,6 +42,11 @@ static const char* g_GenerateMipsCSSource =
     #include "../shaders/GenerateMipsCS_inc.h"
 };
 
+static const char* g_GenerateMipsSinglePassCSSource = 
+{
+    #include "../shaders/GenerateMipsSinglePassCS_inc.h"
+};
+
 namespace Diligent
 {
     void GenerateMipsVkHelper::GetGlImageFormat(const TextureFormatAttribs& FmtAttribs, std::array<char, 16>& GlFmt)
@@ -163,6 +170,57 @@ namespace Diligent
         return PSOs;
     }
 
+    RefCntAutoPtr<IPipelineState> GenerateMipsVkHelper::CreateSinglePassPSO(TEXTURE_FORMAT Fmt)
+    {
+        ShaderCreateInfo CSCreateInfo;
+        CSCreateInfo.Source          = g_GenerateMipsSinglePassCSSource;
+        CSCreateInfo.EntryPoint      = "main";
+        CSCreateInfo.SourceLanguage  = SHADER_SOURCE_LANGUAGE_GLSL;
+        CSCreateInfo.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+
+        const auto& FmtAttribs = GetTextureFormatAttribs(Fmt);
+        bool IsGamma = FmtAttribs.ComponentType == COMPONENT_TYPE_UNORM_SRGB;
+        std::array<char, 16> GlFmt;
+        GetGlImageFormat(FmtAttribs, GlFmt);
+
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("CONVERT_TO_SRGB", IsGamma);
+        Macros.AddShaderMacro("IMG_FORMAT",      GlFmt.data());
+        Macros.Finalize();
+        CSCreateInfo.Macros = Macros;
+
+        std::stringstream name_ss;
+        name_ss << "Generate mips single pass " << GlFmt.data();
+        auto name = name_ss.str();
+        CSCreateInfo.Desc.Name = name.c_str();
+        RefCntAutoPtr<IShader> pCS;
+        m_DeviceVkImpl.CreateShader(CSCreateInfo, &pCS);
+
+        PipelineStateDesc PSODesc;
+        PSODesc.IsComputePipeline = true;
+        PSODesc.Name = name.c_str();
+        PSODesc.ComputePipeline.pCS = pCS;
+
+        PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC;
+        ShaderResourceVariableDesc VarDescs[] = 
+        {
+            {SHADER_TYPE_COMPUTE, "CB",          SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+            // Every context binds its own counters
+            {SHADER_TYPE_COMPUTE, "MipCounters", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+        };
+        PSODesc.ResourceLayout.Variables    = VarDescs;
+        PSODesc.ResourceLayout.NumVariables = _countof(VarDescs);
+
+        const StaticSamplerDesc StaticSampler(SHADER_TYPE_COMPUTE, "SrcMip", Sam_LinearClamp);
+        PSODesc.ResourceLayout.StaticSamplers    = &StaticSampler;
+        PSODesc.ResourceLayout.NumStaticSamplers = 1;
+
+        RefCntAutoPtr<IPipelineState> PSO;
+        m_DeviceVkImpl.CreatePipelineState(PSODesc, &PSO);
+        PSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "CB")->Set(m_ConstantsCB);
+        return PSO;
+    }
+
     GenerateMipsVkHelper::GenerateMipsVkHelper(RenderDeviceVkImpl& DeviceVkImpl) :
         m_DeviceVkImpl(DeviceVkImpl)
     {
@@ -174,15 +232,51 @@ namespace Diligent
         ConstantsCBDesc.uiSizeInBytes  = 32;
         DeviceVkImpl.CreateBuffer(ConstantsCBDesc, nullptr, &m_ConstantsCB);
 
-        FindPSOs(TEX_FORMAT_RGBA8_UNORM);
-        FindPSOs(TEX_FORMAT_BGRA8_UNORM);
+        const auto& Limits = DeviceVkImpl.GetPhysicalDevice().GetProperties().limits;
+        // The single-pass shader uses 256 threads per group and 4 KB of shared memory
+        m_SinglePassSupported = Limits.maxComputeWorkGroupInvocations >= 256 && 
+                                Limits.maxComputeWorkGroupSize[0]     >= 256 &&
+                                Limits.maxComputeSharedMemorySize     >= 4 * 1024 + 16;
+        if (m_SinglePassSupported)
+        {
+            m_MaxSinglePassSlices = std::min(Limits.maxImageArrayLayers, 2048u);
+        }
+        else
+        {
+            LOG_INFO_MESSAGE("The device does not support 256 threads per compute group. Single-pass mip generation is disabled.");
+        }
+
+        WarmUpCache(TEX_FORMAT_RGBA8_UNORM);
+        WarmUpCache(TEX_FORMAT_BGRA8_UNORM);
     }
 
-    void GenerateMipsVkHelper::CreateSRB(IShaderResourceBinding** ppSRB)
+    void GenerateMipsVkHelper::CreateSRB(IShaderResourceBinding** ppSRB, IShaderResourceBinding** ppSinglePassSRB, IBuffer** ppSinglePassCounters)
     {
         // All PSOs are compatible
         auto& PSO = FindPSOs(TEX_FORMAT_RGBA8_UNORM);
         PSO[0]->CreateShaderResourceBinding(ppSRB, true);
+
+        *ppSinglePassSRB      = nullptr;
+        *ppSinglePassCounters = nullptr;
+        if (m_SinglePassSupported)
+        {
+            FindSinglePassPSO(TEX_FORMAT_RGBA8_UNORM)->CreateShaderResourceBinding(ppSinglePassSRB, true);
+
+            // Counters must be zero before the first dispatch. Every dispatch resets them back to zero.
+            std::vector<Uint32> ZeroCounters(m_MaxSinglePassSlices);
+            BufferDesc CountersDesc;
+            CountersDesc.Name              = "Single-pass mip generation counters";
+            CountersDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+            CountersDesc.Usage             = USAGE_DEFAULT;
+            CountersDesc.Mode              = BUFFER_MODE_STRUCTURED;
+            CountersDesc.ElementByteStride = sizeof(Uint32);
+            CountersDesc.uiSizeInBytes     = static_cast<Uint32>(ZeroCounters.size() * sizeof(Uint32));
+            BufferData InitData;
+            InitData.pData    = ZeroCounters.data();
+            InitData.DataSize = CountersDesc.uiSizeInBytes;
+            m_DeviceVkImpl.CreateBuffer(CountersDesc, &InitData, ppSinglePassCounters);
+            (*ppSinglePassSRB)->GetVariableByName(SHADER_TYPE_COMPUTE, "MipCounters")->Set((*ppSinglePassCounters)->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        }
     }
 
     std::array<RefCntAutoPtr<IPipelineState>, 4>& GenerateMipsVkHelper::FindPSOs(TEXTURE_FORMAT Fmt)
@@ -194,12 +288,51 @@ namespace Diligent
         return it->second;
     }
 
+    RefCntAutoPtr<IPipelineState>& GenerateMipsVkHelper::FindSinglePassPSO(TEXTURE_FORMAT Fmt)
+    {
+        VERIFY_EXPR(m_SinglePassSupported);
+        std::lock_guard<std::mutex> Lock{m_PSOMutex};
+        auto it = m_SinglePassPSOHash.find(Fmt);
+        if(it == m_SinglePassPSOHash.end())
+            it = m_SinglePassPSOHash.emplace(Fmt, CreateSinglePassPSO(Fmt)).first;
+        return it->second;
+    }
+
     void GenerateMipsVkHelper::WarmUpCache(TEXTURE_FORMAT Fmt)
     {
         FindPSOs(Fmt);
+        if (m_SinglePassSupported)
+            FindSinglePassPSO(Fmt);
+    }
+
+    bool GenerateMipsVkHelper::CanGenerateMipsInSinglePass(const TextureViewVkImpl& TexView)const
+    {
+        if (!m_SinglePassSupported)
+            return false;
+
+        const auto& TexDesc  = TexView.GetTexture()->GetDesc();
+        const auto& ViewDesc = TexView.GetDesc();
+        if (ViewDesc.NumMipLevels - 1 > MaxSinglePassMips || ViewDesc.NumArraySlices > m_MaxSinglePassSlices)
+            return false;
+
+        // The shader averages 2x2 texels for every level, which is only exact for power-of-two
+        // dimensions. Odd dimensions require weighted sampling performed by the multi-pass shader.
+        // The dimensions must also be equal: once one dimension of a non-square texture reaches 1,
+        // the 2x2 footprint would include texels outside of the level.
+        const auto SrcWidth  = std::max(TexDesc.Width  >> ViewDesc.MostDetailedMip, 1u);
+        const auto SrcHeight = std::max(TexDesc.Height >> ViewDesc.MostDetailedMip, 1u);
+        if (!IsPowerOfTwo(SrcWidth) || SrcWidth != SrcHeight)
+            return false;
+
+        // Mip levels past the 6th are generated by one thread group that
+        // processes at most 64x64 texels of the 6th level
+        if (ViewDesc.NumMipLevels - 1 > 6 && SrcWidth > 64u << 6)
+            return false;
+
+        return true;
     }
         
-    void GenerateMipsVkHelper::GenerateMips(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB)
+    void GenerateMipsVkHelper::GenerateMips(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, IShaderResourceBinding* pSinglePassSRB, IBuffer* pSinglePassCounters)
     {
         auto* pTexVk = TexView.GetTexture<TextureVkImpl>();
         if (!pTexVk->IsInKnownState())
@@ -239,7 +372,10 @@ namespace Diligent
         VkImageLayout AffectedMipLevelLayout;
         if (TexView.HasMipLevelViews())
         {
-            AffectedMipLevelLayout = GenerateMipsCS(TexView, Ctx, SRB, SubresRange);
+            if (pSinglePassSRB != nullptr && pSinglePassCounters != nullptr && CanGenerateMipsInSinglePass(TexView))
+                AffectedMipLevelLayout = GenerateMipsSinglePass(TexView, Ctx, *pSinglePassSRB, *pSinglePassCounters, SubresRange);
+            else
+                AffectedMipLevelLayout = GenerateMipsCS(TexView, Ctx, SRB, SubresRange);
         }
         else
         {
@@ -270,6 +406,86 @@ namespace Diligent
         }
     }
 
+    VkImageLayout GenerateMipsVkHelper::GenerateMipsSinglePass(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, IBuffer& Counters, VkImageSubresourceRange& SubresRange)
+    {
+        auto* pTexVk = TexView.GetTexture<TextureVkImpl>();
+        const auto& TexDesc  = pTexVk->GetDesc();
+        const auto& ViewDesc = TexView.GetDesc();
+        VERIFY(TexDesc.Type == RESOURCE_DIM_TEX_2D || TexDesc.Type == RESOURCE_DIM_TEX_2D_ARRAY,
+               "CS-based mipmap generation is only supported for 2D textures and texture arrays");
+
+        // Note that mip levels are relative to the view's most detailed mip
+        const Uint32 NumMips = ViewDesc.NumMipLevels - 1;
+        VERIFY_EXPR(NumMips >= 1 && NumMips <= MaxSinglePassMips);
+
+        SRB.GetVariableByName(SHADER_TYPE_COMPUTE, "SrcMip")->Set(TexView.GetMipLevelSRV(0));
+        // All array elements must be valid. The shader never writes to the elements past NumMips.
+        IDeviceObject* pOutMips[MaxSinglePassMips];
+        for (Uint32 u = 0; u < MaxSinglePassMips; ++u)
+            pOutMips[u] = TexView.GetMipLevelUAV(std::min(u + 1, NumMips));
+        SRB.GetVariableByName(SHADER_TYPE_COMPUTE, "OutMips")->SetArray(pOutMips, 0, MaxSinglePassMips);
+
+        const auto OriginalState  = pTexVk->GetState();
+        const auto OriginalLayout = pTexVk->GetLayout();
+
+        // Transition the lowest mip level to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        SubresRange.baseMipLevel = ViewDesc.MostDetailedMip;
+        SubresRange.levelCount   = 1;
+        if (OriginalState != RESOURCE_STATE_SHADER_RESOURCE)
+            Ctx.TransitionTextureState(*pTexVk, OriginalState, RESOURCE_STATE_SHADER_RESOURCE, false /*UpdateTextureState*/, &SubresRange);
+        VERIFY_EXPR(ResourceStateToVkImageLayout(RESOURCE_STATE_SHADER_RESOURCE) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        // All other levels are written by the shader
+        SubresRange.baseMipLevel = ViewDesc.MostDetailedMip + 1;
+        SubresRange.levelCount   = NumMips;
+        if (OriginalLayout != VK_IMAGE_LAYOUT_GENERAL)
+            Ctx.TransitionImageLayout(*pTexVk, OriginalLayout, VK_IMAGE_LAYOUT_GENERAL, SubresRange);
+
+        const Uint32 SrcWidth  = std::max(TexDesc.Width  >> ViewDesc.MostDetailedMip, 1u);
+        const Uint32 SrcHeight = std::max(TexDesc.Height >> ViewDesc.MostDetailedMip, 1u);
+        // Every thread group processes 64x64 texels of the source mip
+        const Uint32 NumGroupsX = (SrcWidth  + 63) / 64;
+        const Uint32 NumGroupsY = (SrcHeight + 63) / 64;
+        {
+            struct CBData
+            {
+                Int32 NumMipLevels;
+                Int32 NumGroupsPerSlice;
+                Int32 Dummy0;
+                Int32 Dummy1;
+                float SrcTexelSize[2];
+            };
+            MapHelper<CBData> MappedData(&Ctx, m_ConstantsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+            *MappedData = 
+            {
+                static_cast<Int32>(NumMips),
+                static_cast<Int32>(NumGroupsX * NumGroupsY),
+                0, // Unused
+                0, // Unused
+                {1.0f / static_cast<float>(SrcWidth), 1.0f / static_cast<float>(SrcHeight)}
+            };
+        }
+
+        Ctx.SetPipelineState(FindSinglePassPSO(ViewDesc.Format));
+        Ctx.CommitShaderResources(&SRB, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+        // Counters are updated by every dispatch and initialized by a copy command. The barrier makes
+        // the previous dispatch of this context finish updating the counters.
+        auto vkCountersBuffer = ValidatedCast<BufferVkImpl>(&Counters)->GetVkBuffer();
+        Ctx.GetCommandBuffer().BufferMemoryBarrier(vkCountersBuffer, 
+                                                   VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                   VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                   VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        DispatchComputeAttribs DispatchAttrs(NumGroupsX, NumGroupsY, ViewDesc.NumArraySlices);
+        Ctx.DispatchCompute(DispatchAttrs);
+
+        Ctx.TransitionImageLayout(*pTexVk, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, SubresRange);
+
+        return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
     VkImageLayout GenerateMipsVkHelper::GenerateMipsCS(TextureViewVkImpl& TexView, DeviceContextVkImpl& Ctx, IShaderResourceBinding& SRB, VkImageSubresourceRange& SubresRange)
     {
         auto* pTexVk = TexView.GetTexture<TextureVkImpl>();
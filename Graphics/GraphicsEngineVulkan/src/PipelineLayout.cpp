@@ -270,8 +270,8 @@ void PipelineLayout::DescriptorSetLayoutManager::Finalize(const VulkanUtilities:
     PipelineLayoutCI.flags = 0; // reserved for future use
     PipelineLayoutCI.setLayoutCount = m_ActiveSets;
     PipelineLayoutCI.pSetLayouts = PipelineLayoutCI.setLayoutCount != 0 ? ActiveDescrSetLayouts.data() : nullptr;
-    PipelineLayoutCI.pushConstantRangeCount = 0;
-    PipelineLayoutCI.pPushConstantRanges = nullptr;
+    PipelineLayoutCI.pushConstantRangeCount = m_PushConstantRange.size != 0 ? 1 : 0;
+    PipelineLayoutCI.pPushConstantRanges = PipelineLayoutCI.pushConstantRangeCount != 0 ? &m_PushConstantRange : nullptr;
     m_VkPipelineLayout = LogicalDevice.CreatePipelineLayout(PipelineLayoutCI);
 
     VERIFY_EXPR(BindingOffset == TotalBindings);
@@ -299,6 +299,11 @@ bool PipelineLayout::DescriptorSetLayoutManager::operator == (const DescriptorSe
     if (m_ActiveSets != rhs.m_ActiveSets)
         return false;
 
+    if (m_PushConstantRange.stageFlags != rhs.m_PushConstantRange.stageFlags ||
+        m_PushConstantRange.offset     != rhs.m_PushConstantRange.offset     ||
+        m_PushConstantRange.size       != rhs.m_PushConstantRange.size)
+        return false;
+
     for (size_t i=0; i < m_DescriptorSetLayouts.size(); ++i)
         if (m_DescriptorSetLayouts[i] != rhs.m_DescriptorSetLayouts[i])
             return false;
@@ -308,7 +313,7 @@ bool PipelineLayout::DescriptorSetLayoutManager::operator == (const DescriptorSe
 
 size_t PipelineLayout::DescriptorSetLayoutManager::GetHash()const
 {
-    size_t Hash = 0;
+    size_t Hash = ComputeHash(m_PushConstantRange.stageFlags, m_PushConstantRange.size);
     for (const auto &SetLayout : m_DescriptorSetLayouts)
         HashCombine(Hash, SetLayout.GetHash());
 
@@ -382,6 +387,18 @@ void PipelineLayout::AllocateResourceSlot(const SPIRVShaderResourceAttribs& ResA
     SPIRV[ResAttribs.DescriptorSetDecorationOffset] = DescriptorSet;
 }
 
+void PipelineLayout::SetPushConstantRange(Uint32 ShaderStages, Uint32 Size)
+{
+    VkShaderStageFlags StageFlags = 0;
+    while (ShaderStages != 0)
+    {
+        auto ShaderType = static_cast<SHADER_TYPE>(ShaderStages & ~(ShaderStages - 1));
+        StageFlags |= ShaderTypeToVkShaderStageFlagBit(ShaderType);
+        ShaderStages &= ~static_cast<Uint32>(ShaderType);
+    }
+    m_LayoutMgr.SetPushConstantRange(StageFlags, Size);
+}
+
 void PipelineLayout::Finalize(const VulkanUtilities::VulkanLogicalDevice& LogicalDevice)
 {
     m_LayoutMgr.Finalize(LogicalDevice);
@@ -31,7 +31,6 @@
 #include "ShaderResourceBindingVkImpl.h"
 #include "EngineMemory.h"
 #include "StringTools.h"
-#include "spirv-tools/optimizer.hpp"
 
 namespace Diligent
 {
@@ -128,22 +127,6 @@ VkRenderPassCreateInfo PipelineStateVkImpl::GetRenderPassCreateInfo(
     return RenderPassCI;
 }
 
-static std::vector<uint32_t> StripReflection(const std::vector<uint32_t>& OriginalSPIRV)
-{
-    std::vector<uint32_t> StrippedSPIRV;
-    spvtools::Optimizer SpirvOptimizer(SPV_ENV_VULKAN_1_0);
-    // Decorations defined in SPV_GOOGLE_hlsl_functionality1 are the only instructions
-    // removed by strip-reflect-info pass. SPIRV offsets become INVALID after this operation.
-    SpirvOptimizer.RegisterPass(spvtools::CreateStripReflectInfoPass());
-    auto res = SpirvOptimizer.Run(OriginalSPIRV.data(), OriginalSPIRV.size(), &StrippedSPIRV);
-    if (!res)
-    {
-        // Optimized SPIRV may be invalid
-        StrippedSPIRV.clear();
-    }
-    return StrippedSPIRV;
-}
-
 PipelineStateVkImpl :: PipelineStateVkImpl(IReferenceCounters*      pRefCounters,
                                            RenderDeviceVkImpl*      pDeviceVk,
                                            const PipelineStateDesc& PipelineDesc) : 
@@ -172,12 +155,25 @@ PipelineStateVkImpl :: PipelineStateVkImpl(IReferenceCounters*      pRefCounters
 
         auto* pStaticResLayout = new (m_ShaderResourceLayouts + m_NumShaders + s) ShaderResourceLayoutVk(LogicalDevice);
         auto* pStaticResCache  = new (m_StaticResCaches + s) ShaderResourceCacheVk(ShaderResourceCacheVk::DbgCacheContentType::StaticShaderResources);
-        pStaticResLayout->InitializeStaticResourceLayout(ShaderResources[s], ShaderResLayoutAllocator, PipelineDesc.ResourceLayout, m_StaticResCaches[s]);
+        // Use the layout from m_Desc, where all names are interned
+        pStaticResLayout->InitializeStaticResourceLayout(ShaderResources[s], ShaderResLayoutAllocator, m_Desc.ResourceLayout, m_StaticResCaches[s]);
 
         new (m_StaticVarsMgrs + s) ShaderVariableManagerVk(*this, *pStaticResLayout, GetRawAllocator(), nullptr, 0, *pStaticResCache);
     }
     ShaderResourceLayoutVk::Initialize(pDeviceVk, m_NumShaders, m_ShaderResourceLayouts, ShaderResources.data(), GetRawAllocator(),
-                                       PipelineDesc.ResourceLayout, ShaderSPIRVs.data(), m_PipelineLayout);
+                                       m_Desc.ResourceLayout, ShaderSPIRVs.data(), m_PipelineLayout);
+
+    if (m_Desc.PushConstants.Size != 0)
+    {
+        const auto MaxPushConstantsSize = pDeviceVk->GetPhysicalDevice().GetProperties().limits.maxPushConstantsSize;
+        if (m_Desc.PushConstants.Size > MaxPushConstantsSize)
+            LOG_ERROR_AND_THROW("Push constants size (", m_Desc.PushConstants.Size, ") exceeds the device limit (", MaxPushConstantsSize, ")");
+
+        Uint32 ShaderStages = 0;
+        for (Uint32 s=0; s < m_NumShaders; ++s)
+            ShaderStages |= GetShader<const ShaderVkImpl>(s)->GetDesc().ShaderType;
+        m_PipelineLayout.SetPushConstantRange(ShaderStages, m_Desc.PushConstants.Size);
+    }
     m_PipelineLayout.Finalize(LogicalDevice);
 
     if (PipelineDesc.SRBAllocationGranularity > 1)
@@ -197,7 +193,8 @@ PipelineStateVkImpl :: PipelineStateVkImpl(IReferenceCounters*      pRefCounters
         m_SRBMemAllocator.Initialize(PipelineDesc.SRBAllocationGranularity, m_NumShaders, ShaderVariableDataSizes.data(), 1, &CacheMemorySize);
     }
 
-    // Create shader modules and initialize shader stages
+    // Get shader modules from the cache and initialize shader stages
+    auto& ShaderModuleCache = pDeviceVk->GetShaderModuleCache();
     std::array<VkPipelineShaderStageCreateInfo, MaxShadersInPipeline> ShaderStages = {};
     for (Uint32 s = 0; s < m_NumShaders; ++s)
     {
@@ -219,29 +216,9 @@ PipelineStateVkImpl :: PipelineStateVkImpl(IReferenceCounters*      pRefCounters
             default: UNEXPECTED("Unknown shader type");
         }
 
-        VkShaderModuleCreateInfo ShaderModuleCI = {};
-        ShaderModuleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        ShaderModuleCI.pNext = nullptr;
-        ShaderModuleCI.flags = 0;
-        const auto& SPIRV = ShaderSPIRVs[s];
-
-        // We have to strip reflection instructions to fix the follownig validation error:
-        //     SPIR-V module not valid: DecorateStringGOOGLE requires one of the following extensions: SPV_GOOGLE_decorate_string 
-        // Optimizer also performs validation and may catch problems with the byte code.
-        auto StrippedSPIRV = StripReflection(SPIRV);
-        if (!StrippedSPIRV.empty())
-        {
-            ShaderModuleCI.codeSize = StrippedSPIRV.size() * sizeof(uint32_t);
-            ShaderModuleCI.pCode    = StrippedSPIRV.data();
-        }
-        else
-        {
-            LOG_ERROR("Failed to strip reflection information from shader '", pShaderVk->GetDesc().Name, "'. This may indicate a problem with the byte code.");
-            ShaderModuleCI.codeSize = SPIRV.size() * sizeof(uint32_t);
-            ShaderModuleCI.pCode    = SPIRV.data();
-        }
-
-        m_ShaderModules[s] = LogicalDevice.CreateShaderModule(ShaderModuleCI, pShaderVk->GetDesc().Name);
+        // SPIR-V has been remapped by the resource layout, so pipelines that use the same
+        // shader with identical bindings get the same module
+        m_ShaderModules[s] = ShaderModuleCache.GetShaderModule(ShaderSPIRVs[s], pShaderVk->GetDesc().Name, m_Desc.CommandQueueMask);
 
         StageCI.module = m_ShaderModules[s];
         StageCI.pName  = pShaderVk->GetEntryPoint();
@@ -442,12 +419,7 @@ PipelineStateVkImpl::~PipelineStateVkImpl()
     m_PipelineLayout.Release(m_pDevice, m_Desc.CommandQueueMask);
 
     for (auto& ShaderModule : m_ShaderModules)
-    {
-        if (ShaderModule != VK_NULL_HANDLE)
-        {
-            m_pDevice->SafeReleaseDeviceObject(std::move(ShaderModule), m_Desc.CommandQueueMask);
-        }
-    }
+        ShaderModule.Release();
 
     auto& RawAllocator = GetRawAllocator();
     for (Uint32 s=0; s < m_NumShaders*2; ++s)
@@ -594,20 +566,38 @@ void PipelineStateVkImpl::CommitAndTransitionShaderResources(IShaderResourceBind
         auto DynamicDescriptorSetVkLayout = m_PipelineLayout.GetDynamicDescriptorSetVkLayout();
         if (DynamicDescriptorSetVkLayout != VK_NULL_HANDLE)
         {
-            const char* DynamicDescrSetName = "Dynamic Descriptor Set";
-#ifdef DEVELOPMENT
-            std::string _DynamicDescrSetName(m_Desc.Name);
-            _DynamicDescrSetName.append(" - dynamic set");
-            DynamicDescrSetName = _DynamicDescrSetName.c_str();
-#endif
-            // Allocate vulkan descriptor set for dynamic resources
-            DynamicDescrSet = pCtxVkImpl->AllocateDynamicDescriptorSet(DynamicDescriptorSetVkLayout, DynamicDescrSetName);
-            // Commit all dynamic resource descriptors
+            // Identical dynamic resources may have already been written to a set during this frame.
+            // The key includes the PSO's unique ID as set layout handles may be reused by new PSOs.
+            auto& DescrSetKey = pCtxVkImpl->GetDynamicDescriptorSetKey();
+            DescrSetKey.Reset(DynamicDescriptorSetVkLayout);
+            DescrSetKey.Data.push_back(GetUniqueID());
             for (Uint32 s=0; s < m_NumShaders; ++s)
             {
                 const auto& Layout = m_ShaderResourceLayouts[s];
                 if (Layout.GetResourceCount(SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC) != 0)
-                    Layout.CommitDynamicResources(ResourceCache, DynamicDescrSet);
+                    Layout.GetDynamicResourceIDs(ResourceCache, DescrSetKey.Data);
+            }
+            DescrSetKey.ComputeHash();
+
+            DynamicDescrSet = pCtxVkImpl->FindCachedDynamicDescriptorSet(DescrSetKey);
+            if (DynamicDescrSet == VK_NULL_HANDLE)
+            {
+                const char* DynamicDescrSetName = "Dynamic Descriptor Set";
+#ifdef DEVELOPMENT
+                std::string _DynamicDescrSetName(m_Desc.Name);
+                _DynamicDescrSetName.append(" - dynamic set");
+                DynamicDescrSetName = _DynamicDescrSetName.c_str();
+#endif
+                // Allocate vulkan descriptor set for dynamic resources
+                DynamicDescrSet = pCtxVkImpl->AllocateDynamicDescriptorSet(DynamicDescriptorSetVkLayout, DynamicDescrSetName);
+                // Commit all dynamic resource descriptors
+                for (Uint32 s=0; s < m_NumShaders; ++s)
+                {
+                    const auto& Layout = m_ShaderResourceLayouts[s];
+                    if (Layout.GetResourceCount(SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC) != 0)
+                        Layout.CommitDynamicResources(ResourceCache, DynamicDescrSet);
+                }
+                pCtxVkImpl->CacheDynamicDescriptorSet(DescrSetKey, DynamicDescrSet);
             }
         }
         // Prepare descriptor sets, and also bind them if there are no dynamic descriptors
@@ -0,0 +1,273 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+#include <algorithm>
+#include "QueryManagerVk.h"
+#include "RenderDeviceVkImpl.h"
+#include "GraphicsAccessories.h"
+
+namespace Diligent
+{
+
+static const char* GetQueryPoolName(QUERY_TYPE Type)
+{
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (Type)
+    {
+        case QUERY_TYPE_OCCLUSION:           return "Occlusion query pool";
+        case QUERY_TYPE_TIMESTAMP:           return "Timestamp query pool";
+        case QUERY_TYPE_PIPELINE_STATISTICS: return "Pipeline statistics query pool";
+        case QUERY_TYPE_DURATION:            return "Duration query pool";
+        default: return "Unknown query pool";
+    }
+}
+
+QueryManagerVk::QueryManagerVk(RenderDeviceVkImpl&       DeviceVkImpl,
+                               const EngineVkCreateInfo& EngineCI,
+                               uint32_t                  QueueFamilyIndex) :
+    m_DeviceVkImpl{DeviceVkImpl}
+{
+    const auto& PhysicalDevice = DeviceVkImpl.GetPhysicalDevice();
+    const auto& LogicalDevice  = DeviceVkImpl.GetLogicalDevice();
+    const auto& Limits         = PhysicalDevice.GetProperties().limits;
+
+    // Queues that do not support timestamps have zero valid bits
+    const auto& QueueFamilyProps = PhysicalDevice.GetQueueFamilyProperties();
+    VERIFY_EXPR(QueueFamilyIndex < QueueFamilyProps.size());
+    const auto TimestampValidBits = QueueFamilyProps[QueueFamilyIndex].timestampValidBits;
+    if (TimestampValidBits != 0)
+    {
+        m_TimestampMask = TimestampValidBits >= 64 ? ~Uint64{0} : ((Uint64{1} << TimestampValidBits) - 1);
+        // timestampPeriod is the number of nanoseconds required for a timestamp query to be incremented by 1
+        m_CounterFrequency = static_cast<Uint64>(1000000000.0 / static_cast<double>(Limits.timestampPeriod));
+    }
+
+    if (EngineCI.EnabledFeatures.occlusionQueryPrecise)
+        m_OcclusionQueryFlags = VK_QUERY_CONTROL_PRECISE_BIT;
+
+    if (EngineCI.EnabledFeatures.pipelineStatisticsQuery)
+    {
+        m_PipelineStatisticsFlags =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT                    |
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT                  |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT                  |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT                       |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT                        |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT                |
+            VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+        // Geometry and tessellation statistics must not be requested if the
+        // corresponding features are not enabled
+        if (EngineCI.EnabledFeatures.geometryShader)
+        {
+            m_PipelineStatisticsFlags |=
+                VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_PRIMITIVES_BIT;
+        }
+        if (EngineCI.EnabledFeatures.tessellationShader)
+        {
+            m_PipelineStatisticsFlags |=
+                VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
+        }
+    }
+
+    for (Uint32 QueryType = QUERY_TYPE_UNDEFINED + 1; QueryType < QUERY_TYPE_NUM_TYPES; ++QueryType)
+    {
+        const auto Type = static_cast<QUERY_TYPE>(QueryType);
+        auto& PoolInfo = m_Pools[Type];
+
+        VkQueryPoolCreateInfo QueryPoolCI = {};
+        QueryPoolCI.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        QueryPoolCI.pNext      = nullptr;
+        QueryPoolCI.flags      = 0;
+        QueryPoolCI.queryCount = EngineCI.QueryPoolSizes[Type];
+
+        static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+        switch (Type)
+        {
+            case QUERY_TYPE_OCCLUSION:
+                QueryPoolCI.queryType = VK_QUERY_TYPE_OCCLUSION;
+                break;
+
+            case QUERY_TYPE_TIMESTAMP:
+            case QUERY_TYPE_DURATION:
+                if (TimestampValidBits == 0)
+                    continue;
+                QueryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                break;
+
+            case QUERY_TYPE_PIPELINE_STATISTICS:
+                if (m_PipelineStatisticsFlags == 0)
+                    continue;
+                QueryPoolCI.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+                QueryPoolCI.pipelineStatistics = m_PipelineStatisticsFlags;
+                break;
+
+            default:
+                UNEXPECTED("Unexpected query type");
+                continue;
+        }
+
+        if (QueryPoolCI.queryCount == 0)
+            continue;
+
+        PoolInfo.vkQueryPool = LogicalDevice.CreateQueryPool(QueryPoolCI, GetQueryPoolName(Type));
+        PoolInfo.PoolSize    = QueryPoolCI.queryCount;
+
+        // Queries are in undefined state after the pool has been created, so all of them must be reset
+        PoolInfo.StaleQueries.resize(PoolInfo.PoolSize);
+        for (Uint32 i = 0; i < PoolInfo.PoolSize; ++i)
+            PoolInfo.StaleQueries[i] = i;
+        PoolInfo.AvailableQueries.reserve(PoolInfo.PoolSize);
+        m_NumStaleQueries += PoolInfo.PoolSize;
+    }
+}
+
+QueryManagerVk::~QueryManagerVk()
+{
+    std::stringstream QueryUsageSS;
+    QueryUsageSS << "Vulkan query manager peak usage:";
+    for (Uint32 QueryType = QUERY_TYPE_UNDEFINED + 1; QueryType < QUERY_TYPE_NUM_TYPES; ++QueryType)
+    {
+        const auto& PoolInfo = m_Pools[QueryType];
+        if (PoolInfo.PoolSize == 0)
+            continue;
+
+        const auto NumOutstandingQueries = PoolInfo.PoolSize - static_cast<Uint32>(PoolInfo.AvailableQueries.size() + PoolInfo.StaleQueries.size());
+        if (NumOutstandingQueries != 0)
+        {
+            LOG_ERROR_MESSAGE(NumOutstandingQueries, " query(s) of the ", GetQueryPoolName(static_cast<QUERY_TYPE>(QueryType)),
+                              " have not been returned to the manager");
+        }
+
+        QueryUsageSS << std::endl << std::setw(30) << std::left << GetQueryPoolName(static_cast<QUERY_TYPE>(QueryType)) << ": "
+                     << std::setw(4) << std::right << PoolInfo.MaxAllocatedQueries << '/' << std::setw(4) << PoolInfo.PoolSize;
+    }
+    LOG_INFO_MESSAGE(QueryUsageSS.str());
+}
+
+Uint32 QueryManagerVk::AllocateQuery(QUERY_TYPE Type)
+{
+    std::lock_guard<std::mutex> Lock{m_PoolsMtx};
+
+    auto& PoolInfo = m_Pools[Type];
+    if (PoolInfo.AvailableQueries.empty())
+        return InvalidIndex;
+
+    auto Index = PoolInfo.AvailableQueries.back();
+    PoolInfo.AvailableQueries.pop_back();
+
+    const auto NumAllocatedQueries = PoolInfo.PoolSize - static_cast<Uint32>(PoolInfo.AvailableQueries.size() + PoolInfo.StaleQueries.size());
+    PoolInfo.MaxAllocatedQueries = std::max(PoolInfo.MaxAllocatedQueries, NumAllocatedQueries);
+
+    return Index;
+}
+
+// The recycler is kept in the release queue until the GPU has completed all commands
+// that may reference the query, and then returns the query to the manager
+class QueryManagerVk::StaleQueryRecycler
+{
+public:
+    StaleQueryRecycler(QueryManagerVk& _QueryMgr, QUERY_TYPE _Type, Uint32 _Index)noexcept :
+        QueryMgr {&_QueryMgr},
+        Type     {_Type     },
+        Index    {_Index    }
+    {}
+
+    StaleQueryRecycler             (const StaleQueryRecycler&)  = delete;
+    StaleQueryRecycler& operator = (const StaleQueryRecycler&)  = delete;
+    StaleQueryRecycler& operator = (      StaleQueryRecycler&&) = delete;
+
+    StaleQueryRecycler(StaleQueryRecycler&& rhs)noexcept :
+        QueryMgr {rhs.QueryMgr},
+        Type     {rhs.Type    },
+        Index    {rhs.Index   }
+    {
+        rhs.QueryMgr = nullptr;
+    }
+
+    ~StaleQueryRecycler()
+    {
+        if (QueryMgr != nullptr)
+        {
+            QueryMgr->RecycleStaleQuery(Type, Index);
+        }
+    }
+
+private:
+    QueryManagerVk* QueryMgr;
+    QUERY_TYPE      Type;
+    Uint32          Index;
+};
+
+void QueryManagerVk::DiscardQuery(QUERY_TYPE Type, Uint32 Index, Uint64 QueueMask)
+{
+    VERIFY_EXPR(Index < m_Pools[Type].PoolSize);
+    m_DeviceVkImpl.SafeReleaseDeviceObject(StaleQueryRecycler{*this, Type, Index}, QueueMask);
+}
+
+void QueryManagerVk::RecycleStaleQuery(QUERY_TYPE Type, Uint32 Index)
+{
+    std::lock_guard<std::mutex> Lock{m_PoolsMtx};
+    m_Pools[Type].StaleQueries.push_back(Index);
+    ++m_NumStaleQueries;
+}
+
+Uint32 QueryManagerVk::ResetStaleQueries(VulkanUtilities::VulkanCommandBuffer& CmdBuff)
+{
+    std::lock_guard<std::mutex> Lock{m_PoolsMtx};
+
+    Uint32 NumQueriesReset = 0;
+    for (auto& PoolInfo : m_Pools)
+    {
+        auto& StaleQueries = PoolInfo.StaleQueries;
+        if (StaleQueries.empty())
+            continue;
+
+        // Reset every range of consecutive queries with a single command
+        std::sort(StaleQueries.begin(), StaleQueries.end());
+        size_t RangeStart = 0;
+        while (RangeStart < StaleQueries.size())
+        {
+            size_t RangeEnd = RangeStart + 1;
+            while (RangeEnd < StaleQueries.size() && StaleQueries[RangeEnd] == StaleQueries[RangeEnd - 1] + 1)
+                ++RangeEnd;
+            CmdBuff.ResetQueryPool(PoolInfo.vkQueryPool, StaleQueries[RangeStart], static_cast<uint32_t>(RangeEnd - RangeStart));
+            RangeStart = RangeEnd;
+        }
+
+        // Queries are allocated from the back of the list, so put the queries
+        // with the smallest indices there
+        PoolInfo.AvailableQueries.insert(PoolInfo.AvailableQueries.end(), StaleQueries.rbegin(), StaleQueries.rend());
+        NumQueriesReset += static_cast<Uint32>(StaleQueries.size());
+        StaleQueries.clear();
+    }
+    m_NumStaleQueries -= NumQueriesReset;
+
+    return NumQueriesReset;
+}
+
+}
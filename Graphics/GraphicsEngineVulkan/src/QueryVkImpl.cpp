@@ -0,0 +1,240 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+
+#include "QueryVkImpl.h"
+#include "RenderDeviceVkImpl.h"
+#include "DeviceContextVkImpl.h"
+#include "EngineMemory.h"
+#include "GraphicsAccessories.h"
+
+namespace Diligent
+{
+
+QueryVkImpl :: QueryVkImpl(IReferenceCounters* pRefCounters,
+                           RenderDeviceVkImpl* pRendeDeviceVkImpl,
+                           const QueryDesc&    Desc,
+                           bool                IsDeviceInternal) : 
+    TQueryBase
+    {
+        pRefCounters,
+        pRendeDeviceVkImpl,
+        Desc,
+        IsDeviceInternal
+    }
+{
+}
+
+QueryVkImpl :: ~QueryVkImpl()
+{
+    DiscardQueries();
+}
+
+bool QueryVkImpl::AllocateQueries()
+{
+    DiscardQueries();
+
+    auto& QueryMgr = m_pDevice->GetQueryManager();
+    const Uint32 NumQueries = m_Desc.Type == QUERY_TYPE_DURATION ? 2 : 1;
+    for (Uint32 i = 0; i < NumQueries; ++i)
+    {
+        m_QueryPoolIndex[i] = QueryMgr.AllocateQuery(m_Desc.Type);
+        if (m_QueryPoolIndex[i] == QueryManagerVk::InvalidIndex)
+        {
+            LOG_ERROR_MESSAGE("Failed to allocate Vulkan query for type ", GetQueryTypeString(m_Desc.Type),
+                              ". Increase the query pool size in EngineVkCreateInfo::QueryPoolSizes.");
+            DiscardQueries();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void QueryVkImpl::DiscardQueries()
+{
+    auto& QueryMgr = m_pDevice->GetQueryManager();
+    for (auto& Index : m_QueryPoolIndex)
+    {
+        if (Index != QueryManagerVk::InvalidIndex)
+        {
+            // The query may still be referenced by a command buffer that is being executed by the GPU
+            QueryMgr.DiscardQuery(m_Desc.Type, Index, Uint64{1} << m_CmdQueueId);
+            Index = QueryManagerVk::InvalidIndex;
+        }
+    }
+    m_QueryEndFenceValue = ~Uint64{0};
+}
+
+bool QueryVkImpl::OnBeginQuery(DeviceContextVkImpl* pContext)
+{
+    if (!TQueryBase::OnBeginQuery(pContext))
+        return false;
+
+    m_CmdQueueId = pContext->GetCommandQueueId();
+    if (!AllocateQueries())
+    {
+        m_State = QueryState::Inactive;
+        return false;
+    }
+
+    return true;
+}
+
+bool QueryVkImpl::OnEndQuery(DeviceContextVkImpl* pContext)
+{
+    if (!TQueryBase::OnEndQuery(pContext))
+        return false;
+
+    if (m_Desc.Type == QUERY_TYPE_TIMESTAMP)
+    {
+        // Timestamp queries are never begun, so the slot is allocated when the query is ended
+        m_CmdQueueId = pContext->GetCommandQueueId();
+        if (!AllocateQueries())
+        {
+            m_State = QueryState::Inactive;
+            return false;
+        }
+    }
+
+    if (m_QueryPoolIndex[0] == QueryManagerVk::InvalidIndex)
+    {
+        // The query slot could not be allocated when the query was begun
+        m_State = QueryState::Inactive;
+        return false;
+    }
+
+    // The fence value is set by the context when the command buffer is submitted
+    m_QueryEndFenceValue = ~Uint64{0};
+    return true;
+}
+
+bool QueryVkImpl::GetData(void* pData, Uint32 DataSize)
+{
+    if (!CheckQueryDataPtr(pData, DataSize))
+        return false;
+
+    // The commands that end the query have not been submitted yet or have not been completed by the GPU.
+    // Query results must not be requested before the commands are submitted, as vkGetQueryPoolResults
+    // would then return stale data for the reset query.
+    if (m_QueryEndFenceValue == ~Uint64{0} || m_pDevice->GetCompletedFenceValue(m_CmdQueueId) < m_QueryEndFenceValue)
+        return false;
+
+    const auto& QueryMgr      = m_pDevice->GetQueryManager();
+    const auto& LogicalDevice = m_pDevice->GetLogicalDevice();
+    const auto  vkQueryPool   = QueryMgr.GetQueryPool(m_Desc.Type);
+
+    // Pipeline statistics query returns up to 11 values
+    Uint64 Results[11] = {};
+    Uint32 NumResults  = 1;
+    Uint32 NumQueries  = 1;
+    if (m_Desc.Type == QUERY_TYPE_PIPELINE_STATISTICS)
+    {
+        NumResults = 0;
+        for (auto Flags = QueryMgr.GetPipelineStatisticsFlags(); Flags != 0; Flags &= Flags - 1)
+            ++NumResults;
+    }
+    else if (m_Desc.Type == QUERY_TYPE_DURATION)
+    {
+        NumQueries = 2;
+    }
+
+    // Duration query slots are not necessarily consecutive, so every query is read individually
+    for (Uint32 i = 0; i < NumQueries; ++i)
+    {
+        auto res = LogicalDevice.GetQueryPoolResults(vkQueryPool, m_QueryPoolIndex[i], 1, sizeof(Uint64) * NumResults,
+                                                     Results + i, sizeof(Uint64) * NumResults, VK_QUERY_RESULT_64_BIT);
+        if (res == VK_NOT_READY)
+            return false;
+        if (res != VK_SUCCESS)
+        {
+            LOG_ERROR_MESSAGE("Failed to get results of query '", m_Desc.Name, "'");
+            return false;
+        }
+    }
+
+    if (pData == nullptr)
+        return true;
+
+    static_assert(QUERY_TYPE_NUM_TYPES == 5, "Not all QUERY_TYPE enum values are handled below");
+    switch (m_Desc.Type)
+    {
+        case QUERY_TYPE_OCCLUSION:
+        {
+            auto& QueryData = *reinterpret_cast<QueryDataOcclusion*>(pData);
+            QueryData.NumSamples = Results[0];
+            break;
+        }
+
+        case QUERY_TYPE_TIMESTAMP:
+        {
+            auto& QueryData = *reinterpret_cast<QueryDataTimestamp*>(pData);
+            QueryData.Counter   = Results[0] & QueryMgr.GetTimestampMask();
+            QueryData.Frequency = QueryMgr.GetCounterFrequency();
+            break;
+        }
+
+        case QUERY_TYPE_DURATION:
+        {
+            auto& QueryData = *reinterpret_cast<QueryDataDuration*>(pData);
+            const auto Mask = QueryMgr.GetTimestampMask();
+            // The counter may wrap around between the two timestamps
+            QueryData.Duration  = ((Results[1] & Mask) - (Results[0] & Mask)) & Mask;
+            QueryData.Frequency = QueryMgr.GetCounterFrequency();
+            break;
+        }
+
+        case QUERY_TYPE_PIPELINE_STATISTICS:
+        {
+            auto& QueryData = *reinterpret_cast<QueryDataPipelineStatistics*>(pData);
+            // Vulkan writes the statistics in the order of the flag bits, skipping the bits that are not set
+            const auto Flags = QueryMgr.GetPipelineStatisticsFlags();
+            Uint32 Idx = 0;
+            auto GetStatistic = [&](VkQueryPipelineStatisticFlagBits Bit)
+            {
+                return (Flags & Bit) != 0 ? Results[Idx++] : Uint64{0};
+            };
+            QueryData.InputVertices       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT);
+            QueryData.InputPrimitives     = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT);
+            QueryData.VSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT);
+            QueryData.GSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT);
+            QueryData.GSPrimitives        = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_PRIMITIVES_BIT);
+            QueryData.ClippingInvocations = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT);
+            QueryData.ClippingPrimitives  = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT);
+            QueryData.PSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT);
+            QueryData.HSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT);
+            QueryData.DSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT);
+            QueryData.CSInvocations       = GetStatistic(VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT);
+            break;
+        }
+
+        default:
+            UNEXPECTED("Unexpected query type");
+    }
+
+    return true;
+}
+
+}
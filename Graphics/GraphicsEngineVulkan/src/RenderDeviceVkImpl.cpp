@@ -32,7 +32,9 @@
 #include "ShaderResourceBindingVkImpl.h"
 #include "DeviceContextVkImpl.h"
 #include "FenceVkImpl.h"
+#include "QueryVkImpl.h"
 #include "EngineMemory.h"
+#include "CpuProfiler.h"
 
 namespace Diligent
 {
@@ -53,6 +55,7 @@ RenderDeviceVkImpl :: RenderDeviceVkImpl(IReferenceCounters*
         pEngineFactory,
         CommandQueueCount,
         CmdQueues,
+        EngineCI,
         EngineCI.NumDeferredContexts,
         DeviceObjectSizes
         {
@@ -64,7 +67,8 @@ RenderDeviceVkImpl :: RenderDeviceVkImpl(IReferenceCounters*
             sizeof(SamplerVkImpl),
             sizeof(PipelineStateVkImpl),
             sizeof(ShaderResourceBindingVkImpl),
-            sizeof(FenceVkImpl)
+            sizeof(FenceVkImpl),
+            sizeof(QueryVkImpl)
         }
     },
     m_VulkanInstance    {Instance                 },
@@ -73,6 +77,7 @@ RenderDeviceVkImpl :: RenderDeviceVkImpl(IReferenceCounters*
     m_EngineAttribs     {EngineCI                 },
     m_FramebufferCache  {*this                    },
     m_RenderPassCache   {*this                    },
+    m_ShaderModuleCache {*this                    },
     m_DescriptorSetAllocator
     {
         *this,
@@ -129,14 +134,22 @@ RenderDeviceVkImpl :: RenderDeviceVkImpl(IReferenceCounters*
         EngineCI.DeviceLocalMemoryPageSize,
         EngineCI.HostVisibleMemoryPageSize,
         EngineCI.DeviceLocalMemoryReserveSize,
-        EngineCI.HostVisibleMemoryReserveSize
+        EngineCI.HostVisibleMemoryReserveSize,
+        EngineCI.DedicatedMemoryAllocationThreshold
     },
     m_DynamicMemoryManager
     {
         GetRawAllocator(),
         *this,
         EngineCI.DynamicHeapSize,
+        EngineCI.DynamicHeapPageSize,
         ~Uint64{0}
+    },
+    m_QueryMgr
+    {
+        *this,
+        EngineCI,
+        CmdQueues[0]->GetQueueFamilyIndex()
     }
 {
     m_DeviceCaps.DevType = DeviceType::Vulkan;
@@ -150,6 +163,19 @@ RenderDeviceVkImpl :: RenderDeviceVkImpl(IReferenceCounters*
     m_DeviceCaps.bGeometryShadersSupported = EngineCI.EnabledFeatures.geometryShader;
     m_DeviceCaps.bTessellationSupported    = EngineCI.EnabledFeatures.tessellationShader;
     m_DeviceCaps.bBindlessSupported        = True;
+
+    m_DeviceCaps.bOcclusionQueriesSupported          = m_QueryMgr.GetQueryPool(QUERY_TYPE_OCCLUSION) != VK_NULL_HANDLE;
+    m_DeviceCaps.bTimestampQueriesSupported          = m_QueryMgr.GetQueryPool(QUERY_TYPE_TIMESTAMP) != VK_NULL_HANDLE &&
+                                                       m_QueryMgr.GetQueryPool(QUERY_TYPE_DURATION)  != VK_NULL_HANDLE;
+    m_DeviceCaps.bPipelineStatisticsQueriesSupported = m_QueryMgr.GetQueryPool(QUERY_TYPE_PIPELINE_STATISTICS) != VK_NULL_HANDLE;
+
+    if (m_LogicalVkDevice->IsExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        m_vkGetPhysicalDeviceMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+            vkGetInstanceProcAddr(m_VulkanInstance->GetVkInstance(), "vkGetPhysicalDeviceMemoryProperties2KHR"));
+        if (m_vkGetPhysicalDeviceMemoryProperties2 == nullptr)
+            LOG_WARNING_MESSAGE("Failed to load vkGetPhysicalDeviceMemoryProperties2KHR. Memory budget will not be queried from the driver.");
+    }
 }
 
 RenderDeviceVkImpl::~RenderDeviceVkImpl()
@@ -311,10 +337,220 @@ void RenderDeviceVkImpl::FlushStaleResources(Uint32 CmdQueueIndex)
     TRenderDeviceBase::SubmitCommandBuffer(0, DummySumbitInfo, true);
 }
 
+void RenderDeviceVkImpl::RegisterMovableBuffer(BufferVkImpl& Buffer)
+{
+    std::lock_guard<std::mutex> Lock{m_MovableBuffersMtx};
+    m_MovableBuffers.emplace(&Buffer, RefCntWeakPtr<BufferVkImpl>{&Buffer});
+}
+
+void RenderDeviceVkImpl::UnregisterMovableBuffer(BufferVkImpl& Buffer)
+{
+    std::lock_guard<std::mutex> Lock{m_MovableBuffersMtx};
+    m_MovableBuffers.erase(&Buffer);
+}
+
+void RenderDeviceVkImpl::SelectBuffersToDefragment(Uint64 MaxBytesToMove, std::vector<RefCntAutoPtr<BufferVkImpl>>& Buffers)
+{
+    // Pages that are more than half full are not worth defragmenting
+    static constexpr float MaxPageOccupancy = 0.5f;
+
+    // Strong references must be released after the mutex is unlocked as the last 
+    // reference to the buffer may be released by this thread
+    std::vector<RefCntAutoPtr<BufferVkImpl>> MovableBuffers;
+    {
+        std::lock_guard<std::mutex> Lock{m_MovableBuffersMtx};
+        MovableBuffers.reserve(m_MovableBuffers.size());
+        for (auto& it : m_MovableBuffers)
+        {
+            auto pBuffer = it.second.Lock();
+            // The buffer may be in the process of destruction
+            if (pBuffer)
+                MovableBuffers.emplace_back(std::move(pBuffer));
+        }
+    }
+
+    struct PageInfo
+    {
+        VulkanUtilities::VulkanMemoryPage* pPage       = nullptr;
+        VkDeviceSize                       MovableSize = 0;
+        std::vector<BufferVkImpl*>         Buffers;
+    };
+    std::unordered_map<VulkanUtilities::VulkanMemoryPage*, PageInfo> Pages;
+    for (auto& pBuffer : MovableBuffers)
+    {
+        const auto& Allocation = pBuffer->GetMemoryAllocation();
+        auto& Info = Pages[Allocation.Page];
+        Info.pPage        = Allocation.Page;
+        // Buffers that are being moved still occupy the memory in the page
+        Info.MovableSize += Allocation.Size;
+        if (!pBuffer->m_IsBeingMoved)
+            Info.Buffers.push_back(pBuffer);
+    }
+
+    // Process the sparsest pages first
+    std::vector<PageInfo*> SortedPages;
+    SortedPages.reserve(Pages.size());
+    for (auto& it : Pages)
+    {
+        if (!it.second.Buffers.empty())
+            SortedPages.push_back(&it.second);
+    }
+    std::sort(SortedPages.begin(), SortedPages.end(), 
+        [](const PageInfo* lhs, const PageInfo* rhs)
+        {
+            return lhs->MovableSize < rhs->MovableSize;
+        });
+
+    Uint64 SelectedSize = 0;
+    for (auto* pInfo : SortedPages)
+    {
+        if (!m_MemoryMgr.BeginPageDefragmentation(*pInfo->pPage, pInfo->MovableSize, MaxPageOccupancy))
+            continue;
+
+        for (auto* pBuffer : pInfo->Buffers)
+        {
+            Uint64 Size = pBuffer->GetDesc().uiSizeInBytes;
+            if (SelectedSize + Size > MaxBytesToMove && !Buffers.empty())
+                return;
+
+            pBuffer->m_IsBeingMoved = true;
+            Buffers.emplace_back(pBuffer);
+            SelectedSize += Size;
+        }
+    }
+}
+
+void RenderDeviceVkImpl::GetMemoryDefragmentationStats(MemoryDefragmentationStatsVk& Stats)
+{
+    auto MgrStats = m_MemoryMgr.GetDefragmentationStats();
+    Stats.NumMovedBuffers  = m_NumMovedBuffers.load();
+    Stats.MovedBytes       = m_MovedBytes.load();
+    Stats.NumReleasedPages = MgrStats.NumReleasedPages;
+    Stats.ReclaimedBytes   = MgrStats.ReleasedSize;
+}
+
+void RenderDeviceVkImpl::GetShaderModuleCacheStats(ShaderModuleCacheStatsVk& Stats)
+{
+    m_ShaderModuleCache.GetStats(Stats);
+}
+
 void RenderDeviceVkImpl::ReleaseStaleResources(bool ForceRelease)
 {
     m_MemoryMgr.ShrinkMemory();
     PurgeReleaseQueues(ForceRelease);
+    CheckMemoryBudget();
+}
+
+Uint32 RenderDeviceVkImpl::GetMemoryHeapCount()
+{
+    return m_PhysicalDevice->GetMemoryProperties().memoryHeapCount;
+}
+
+void RenderDeviceVkImpl::QueryMemoryBudget(MemoryHeapUsageVk HeapUsage[], Uint32 HeapCount)
+{
+    const auto& MemoryProps = m_PhysicalDevice->GetMemoryProperties();
+    VERIFY_EXPR(HeapCount <= MemoryProps.memoryHeapCount);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT BudgetProps = {};
+    BudgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    bool BudgetReported = false;
+    if (m_vkGetPhysicalDeviceMemoryProperties2 != nullptr)
+    {
+        VkPhysicalDeviceMemoryProperties2KHR MemoryProps2 = {};
+        MemoryProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+        MemoryProps2.pNext = &BudgetProps;
+        m_vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice->GetVkDeviceHandle(), &MemoryProps2);
+        BudgetReported = true;
+    }
+
+    for (Uint32 heap = 0; heap < HeapCount; ++heap)
+    {
+        const auto& Heap  = MemoryProps.memoryHeaps[heap];
+        auto&       Usage = HeapUsage[heap];
+        auto        Stats = m_MemoryMgr.GetHeapStats(heap);
+
+        Usage.HeapSize      = Heap.size;
+        Usage.IsDeviceLocal = (Heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        Usage.AllocatedSize = Stats.AllocatedSize;
+        Usage.BufferSize    = Stats.UsedSize[static_cast<size_t>(VulkanUtilities::VulkanMemoryCategory::Buffer)];
+        Usage.TextureSize   = Stats.UsedSize[static_cast<size_t>(VulkanUtilities::VulkanMemoryCategory::Texture)];
+        Usage.StagingSize   = Stats.UsedSize[static_cast<size_t>(VulkanUtilities::VulkanMemoryCategory::Staging)];
+        Usage.DynamicSize   = Stats.UsedSize[static_cast<size_t>(VulkanUtilities::VulkanMemoryCategory::Dynamic)];
+        Usage.IsBudgetReportedByDriver = BudgetReported;
+        if (BudgetReported)
+        {
+            Usage.Budget = BudgetProps.heapBudget[heap];
+            Usage.Usage  = BudgetProps.heapUsage[heap];
+        }
+        else
+        {
+            auto ConfiguredBudget = Usage.IsDeviceLocal ? m_EngineAttribs.DeviceLocalMemoryBudget : m_EngineAttribs.HostMemoryBudget;
+            if (ConfiguredBudget != 0)
+                Usage.Budget = std::min(ConfiguredBudget, Usage.HeapSize);
+            else
+                Usage.Budget = Usage.IsDeviceLocal ? Usage.HeapSize / 5 * 4 : Usage.HeapSize / 2;
+            Usage.Usage = Usage.AllocatedSize;
+        }
+    }
+}
+
+void RenderDeviceVkImpl::GetMemoryHeapUsage(Uint32 HeapIndex, MemoryHeapUsageVk& HeapUsage)
+{
+    const auto HeapCount = GetMemoryHeapCount();
+    if (HeapIndex >= HeapCount)
+    {
+        LOG_ERROR_MESSAGE("Memory heap index (", HeapIndex, ") is out of range. The device has ", HeapCount, " heaps.");
+        HeapUsage = MemoryHeapUsageVk{};
+        return;
+    }
+
+    // The driver reports the budget of all heaps at once
+    MemoryHeapUsageVk AllHeapsUsage[VK_MAX_MEMORY_HEAPS];
+    QueryMemoryBudget(AllHeapsUsage, HeapIndex + 1);
+    HeapUsage = AllHeapsUsage[HeapIndex];
+}
+
+void RenderDeviceVkImpl::SetMemoryBudgetCallback(MemoryBudgetCallbackType Callback, void* pUserData, float HighWatermark, float CriticalWatermark)
+{
+    DEV_CHECK_ERR(HighWatermark > 0 && HighWatermark <= CriticalWatermark, "High watermark (", HighWatermark, ") must be positive and not greater than critical watermark (", CriticalWatermark, ")");
+
+    std::lock_guard<std::mutex> Lock{m_MemoryBudgetMtx};
+    m_MemoryBudgetCallback    = Callback;
+    m_pMemoryBudgetUserData   = pUserData;
+    m_MemoryHighWatermark     = HighWatermark;
+    m_MemoryCriticalWatermark = CriticalWatermark;
+    // Report the current level of every heap that is not normal on the next check
+    m_MemoryPressureLevels.fill(MEMORY_PRESSURE_LEVEL_NORMAL);
+}
+
+void RenderDeviceVkImpl::CheckMemoryBudget()
+{
+    std::lock_guard<std::mutex> Lock{m_MemoryBudgetMtx};
+    if (m_MemoryBudgetCallback == nullptr)
+        return;
+
+    const auto HeapCount = GetMemoryHeapCount();
+    MemoryHeapUsageVk HeapUsage[VK_MAX_MEMORY_HEAPS];
+    QueryMemoryBudget(HeapUsage, HeapCount);
+    for (Uint32 heap = 0; heap < HeapCount; ++heap)
+    {
+        const auto& Usage = HeapUsage[heap];
+        auto Level = MEMORY_PRESSURE_LEVEL_NORMAL;
+        if (Usage.Budget != 0)
+        {
+            auto Ratio = static_cast<double>(Usage.Usage) / static_cast<double>(Usage.Budget);
+            if (Ratio >= m_MemoryCriticalWatermark)
+                Level = MEMORY_PRESSURE_LEVEL_CRITICAL;
+            else if (Ratio >= m_MemoryHighWatermark)
+                Level = MEMORY_PRESSURE_LEVEL_HIGH;
+        }
+
+        if (Level != m_MemoryPressureLevels[heap])
+        {
+            m_MemoryPressureLevels[heap] = Level;
+            m_MemoryBudgetCallback(heap, Level, Usage, m_pMemoryBudgetUserData);
+        }
+    }
 }
 
 
@@ -412,6 +648,7 @@ IMPLEMENT_QUERY_INTERFACE( RenderDeviceVkImpl, IID_RenderDeviceVk, TRenderDevice
 
 void RenderDeviceVkImpl::CreatePipelineState(const PipelineStateDesc &PipelineDesc, IPipelineState **ppPipelineState)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceVkImpl::CreatePipelineState");
     CreateDeviceObject("Pipeline State", PipelineDesc, ppPipelineState, 
         [&]()
         {
@@ -445,6 +682,8 @@ void RenderDeviceVkImpl :: CreateBuffer(const BufferDesc& BuffDesc, const Buffer
             BufferVkImpl* pBufferVk( NEW_RC_OBJ(m_BufObjAllocator, "BufferVkImpl instance", BufferVkImpl)(m_BuffViewObjAllocator, this, BuffDesc, pBuffData ) );
             pBufferVk->QueryInterface( IID_Buffer, reinterpret_cast<IObject**>(ppBuffer) );
             pBufferVk->CreateDefaultViews();
+            if (pBufferVk->IsMovable())
+                RegisterMovableBuffer(*pBufferVk);
             OnCreateDeviceObject( pBufferVk );
         } 
     );
@@ -453,6 +692,7 @@ void RenderDeviceVkImpl :: CreateBuffer(const BufferDesc& BuffDesc, const Buffer
 
 void RenderDeviceVkImpl :: CreateShader(const ShaderCreateInfo& ShaderCI, IShader **ppShader)
 {
+    DILIGENT_PROFILE_SCOPE("RenderDeviceVkImpl::CreateShader");
     CreateDeviceObject( "shader", ShaderCI.Desc, ppShader, 
         [&]()
         {
@@ -536,4 +776,17 @@ void RenderDeviceVkImpl::CreateFence(const FenceDesc& Desc, IFence** ppFence)
     );
 }
 
+void RenderDeviceVkImpl::CreateQuery(const QueryDesc& Desc, IQuery** ppQuery)
+{
+    CreateDeviceObject( "Query", Desc, ppQuery, 
+        [&]()
+        {
+            QueryVkImpl* pQueryVk( NEW_RC_OBJ(m_QueryAllocator, "QueryVkImpl instance", QueryVkImpl)
+                                             (this, Desc) );
+            pQueryVk->QueryInterface( IID_Query, reinterpret_cast<IObject**>(ppQuery) );
+            OnCreateDeviceObject( pQueryVk );
+        }
+    );
+}
+
 }
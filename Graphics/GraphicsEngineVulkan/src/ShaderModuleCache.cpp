@@ -0,0 +1,184 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include "ShaderModuleCache.h"
+#include "RenderDeviceVkImpl.h"
+#include "HashUtils.h"
+#include "Timer.h"
+#include "spirv-tools/optimizer.hpp"
+
+namespace Diligent
+{
+
+static std::vector<uint32_t> StripReflection(const std::vector<uint32_t>& OriginalSPIRV)
+{
+    std::vector<uint32_t> StrippedSPIRV;
+    spvtools::Optimizer SpirvOptimizer(SPV_ENV_VULKAN_1_0);
+    // Decorations defined in SPV_GOOGLE_hlsl_functionality1 are the only instructions
+    // removed by strip-reflect-info pass. SPIRV offsets become INVALID after this operation.
+    SpirvOptimizer.RegisterPass(spvtools::CreateStripReflectInfoPass());
+    auto res = SpirvOptimizer.Run(OriginalSPIRV.data(), OriginalSPIRV.size(), &StrippedSPIRV);
+    if (!res)
+    {
+        // Optimized SPIRV may be invalid
+        StrippedSPIRV.clear();
+    }
+    return StrippedSPIRV;
+}
+
+static size_t ComputeSPIRVHash(const std::vector<uint32_t>& SPIRV)
+{
+    auto Hash = ComputeHash(SPIRV.size());
+    for (auto Word : SPIRV)
+        HashCombine(Hash, Word);
+    return Hash;
+}
+
+ShaderModuleCache::~ShaderModuleCache()
+{
+    DEV_CHECK_ERR(m_Cache.empty(), m_Cache.size(), " shader module(s) have not been released. All pipeline states must be released before the device is destroyed.");
+    if (m_NumLookups != 0)
+    {
+        const auto NumMisses = m_NumLookups - m_NumHits;
+        const auto AvgCreateTime = NumMisses != 0 ? m_TotalCreateTime / static_cast<double>(NumMisses) : 0.0;
+        LOG_INFO_MESSAGE("Shader module cache hits: ", m_NumHits, '/', m_NumLookups, ", time spent creating modules: ", m_TotalCreateTime * 1000.0,
+                         " ms, estimated time saved: ", AvgCreateTime * static_cast<double>(m_NumHits) * 1000.0, " ms");
+    }
+}
+
+ShaderModuleCache::CacheType::iterator ShaderModuleCache::Find(size_t Hash, const std::vector<uint32_t>& SPIRV)
+{
+    auto Range = m_Cache.equal_range(Hash);
+    for (auto it = Range.first; it != Range.second; ++it)
+    {
+        if (it->second.SPIRV == SPIRV)
+            return it;
+    }
+    return m_Cache.end();
+}
+
+ShaderModuleCache::ModuleRef ShaderModuleCache::GetShaderModule(const std::vector<uint32_t>& SPIRV, const char* DebugName, Uint64 QueueMask)
+{
+    const auto Hash = ComputeSPIRVHash(SPIRV);
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        ++m_NumLookups;
+        auto it = Find(Hash, SPIRV);
+        if (it != m_Cache.end())
+        {
+            ++m_NumHits;
+            ++it->second.RefCount;
+            return ModuleRef{*this, it->second.Module, QueueMask};
+        }
+    }
+
+    // Stripping reflection and creating the module are expensive, so do not hold the lock
+    Timer CreateTimer;
+
+    VkShaderModuleCreateInfo ShaderModuleCI = {};
+    ShaderModuleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    ShaderModuleCI.pNext = nullptr;
+    ShaderModuleCI.flags = 0;
+
+    // We have to strip reflection instructions to fix the follownig validation error:
+    //     SPIR-V module not valid: DecorateStringGOOGLE requires one of the following extensions: SPV_GOOGLE_decorate_string 
+    // Optimizer also performs validation and may catch problems with the byte code.
+    auto StrippedSPIRV = StripReflection(SPIRV);
+    if (!StrippedSPIRV.empty())
+    {
+        ShaderModuleCI.codeSize = StrippedSPIRV.size() * sizeof(uint32_t);
+        ShaderModuleCI.pCode    = StrippedSPIRV.data();
+    }
+    else
+    {
+        LOG_ERROR("Failed to strip reflection information from shader '", DebugName, "'. This may indicate a problem with the byte code.");
+        ShaderModuleCI.codeSize = SPIRV.size() * sizeof(uint32_t);
+        ShaderModuleCI.pCode    = SPIRV.data();
+    }
+
+    auto Module = m_DeviceVkImpl.GetLogicalDevice().CreateShaderModule(ShaderModuleCI, DebugName);
+    const auto CreateTime = CreateTimer.GetElapsedTime();
+
+    std::lock_guard<std::mutex> Lock{m_Mutex};
+    m_TotalCreateTime += CreateTime;
+    // Another thread may have created the same module while the lock was released.
+    // The new module has not been used yet, so it can be destroyed right away.
+    auto it = Find(Hash, SPIRV);
+    if (it != m_Cache.end())
+    {
+        ++it->second.RefCount;
+        return ModuleRef{*this, it->second.Module, QueueMask};
+    }
+
+    VkShaderModule vkModule = Module;
+    m_Cache.emplace(Hash, CachedModule{SPIRV, std::move(Module)});
+    m_ModuleHashes.emplace(vkModule, Hash);
+    m_SPIRVSize += SPIRV.size() * sizeof(uint32_t);
+    return ModuleRef{*this, vkModule, QueueMask};
+}
+
+void ShaderModuleCache::ReleaseShaderModule(VkShaderModule vkModule, Uint64 QueueMask)
+{
+    std::lock_guard<std::mutex> Lock{m_Mutex};
+    auto hash_it = m_ModuleHashes.find(vkModule);
+    if (hash_it == m_ModuleHashes.end())
+    {
+        UNEXPECTED("Shader module was not found in the cache");
+        return;
+    }
+
+    auto Range = m_Cache.equal_range(hash_it->second);
+    for (auto it = Range.first; it != Range.second; ++it)
+    {
+        auto& Cached = it->second;
+        if (Cached.Module != vkModule)
+            continue;
+
+        VERIFY_EXPR(Cached.RefCount > 0);
+        if (--Cached.RefCount == 0)
+        {
+            m_SPIRVSize -= Cached.SPIRV.size() * sizeof(uint32_t);
+            m_DeviceVkImpl.SafeReleaseDeviceObject(std::move(Cached.Module), QueueMask);
+            m_Cache.erase(it);
+            m_ModuleHashes.erase(hash_it);
+        }
+        return;
+    }
+    UNEXPECTED("Shader module was not found in the cache");
+}
+
+void ShaderModuleCache::GetStats(ShaderModuleCacheStatsVk& Stats)
+{
+    std::lock_guard<std::mutex> Lock{m_Mutex};
+    Stats.NumLookups      = m_NumLookups;
+    Stats.NumHits         = m_NumHits;
+    Stats.NumModules      = static_cast<Uint32>(m_Cache.size());
+    Stats.SPIRVSize       = m_SPIRVSize;
+    Stats.TotalCreateTime = m_TotalCreateTime;
+
+    const auto NumMisses = m_NumLookups - m_NumHits;
+    Stats.EstimatedTimeSaved = NumMisses != 0 ? m_TotalCreateTime / static_cast<double>(NumMisses) * static_cast<double>(m_NumHits) : 0.0;
+}
+
+}
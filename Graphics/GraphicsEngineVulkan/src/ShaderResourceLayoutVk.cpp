@@ -271,7 +271,8 @@ void ShaderResourceLayoutVk::dvpVerifyResourceLayoutDesc(Uint32
                 for (Uint32 res = 0; res < Resources.GetTotalResources() && !VariableFound; ++res)
                 {
                     const auto& ResAttribs = Resources.GetResource(res);
-                    VariableFound = (strcmp(ResAttribs.Name, VarDesc.Name) == 0);
+                    // Both names are interned
+                    VariableFound = (ResAttribs.Name == VarDesc.Name);
                 }
             }
         }
@@ -304,7 +305,7 @@ void ShaderResourceLayoutVk::dvpVerifyResourceLayoutDesc(Uint32
             for (Uint32 i = 0; i < Resources.GetNumSmpldImgs() && !SamplerFound; ++i)
             {
                 const auto& SmplImg = Resources.GetSmpldImg(i);
-                SamplerFound = (strcmp(SmplImg.Name, StSamDesc.SamplerOrTextureName) == 0);
+                SamplerFound = (SmplImg.Name == StSamDesc.SamplerOrTextureName);
             }
 
             if (!SamplerFound)
@@ -524,7 +525,7 @@ Uint32 ShaderResourceLayoutVk::FindAssignedSampler(const SPIRVShaderResourceAttr
         {
             const auto& Res = GetResource(ImgVarType, SamplerInd);
             if (Res.SpirvAttribs.Type == SPIRVShaderResourceAttribs::ResourceType::SeparateSampler && 
-                strcmp(Res.SpirvAttribs.Name, SepSampler.Name) == 0)
+                Res.SpirvAttribs.Name == SepSampler.Name) // Names are interned
             {
                 VERIFY(ImgVarType == Res.GetVariableType(),
                        "The type (", GetShaderVariableTypeLiteralName(ImgVarType),") of separate image variable '", SepImg.Name,
@@ -1203,4 +1204,71 @@ void ShaderResourceLayoutVk::CommitDynamicResources(const ShaderResourceCacheVk&
     }
 }
 
+void ShaderResourceLayoutVk::GetDynamicResourceIDs(const ShaderResourceCacheVk& ResourceCache,
+                                                   std::vector<Uint64>&         IDs)const
+{
+    // Neither Vulkan handles nor object pointers can be used here as both may be reused
+    // after an object is released, while the cached descriptor set still references the old one.
+    // All descriptor write infos (buffer ranges, image views) are immutable properties of the objects.
+    Uint32 NumDynamicResources = m_NumResources[SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC];
+    for (Uint32 r = 0; r < NumDynamicResources; ++r)
+    {
+        const auto& Res = GetResource(SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC, r);
+        const auto& SetResources = ResourceCache.GetDescriptorSet(Res.DescriptorSet);
+        for (Uint32 ArrElem = 0; ArrElem < Res.SpirvAttribs.ArraySize; ++ArrElem)
+        {
+            const auto& CachedRes = SetResources.GetResource(Res.CacheOffset + ArrElem);
+            switch (Res.SpirvAttribs.Type)
+            {
+                case SPIRVShaderResourceAttribs::ResourceType::UniformBuffer:
+                {
+                    const auto* pBufferVk = CachedRes.pObject.RawPtr<const BufferVkImpl>();
+                    IDs.push_back(pBufferVk != nullptr ? pBufferVk->GetUniqueID() : 0);
+                }
+                break;
+
+                case SPIRVShaderResourceAttribs::ResourceType::ROStorageBuffer:
+                case SPIRVShaderResourceAttribs::ResourceType::RWStorageBuffer:
+                case SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer:
+                case SPIRVShaderResourceAttribs::ResourceType::StorageTexelBuffer:
+                {
+                    const auto* pBufferViewVk = CachedRes.pObject.RawPtr<const BufferViewVkImpl>();
+                    IDs.push_back(pBufferViewVk != nullptr ? pBufferViewVk->GetUniqueID() : 0);
+                }
+                break;
+
+                case SPIRVShaderResourceAttribs::ResourceType::SeparateImage:
+                case SPIRVShaderResourceAttribs::ResourceType::StorageImage:
+                case SPIRVShaderResourceAttribs::ResourceType::SampledImage:
+                {
+                    const auto* pTexViewVk = CachedRes.pObject.RawPtr<const TextureViewVkImpl>();
+                    IDs.push_back(pTexViewVk != nullptr ? pTexViewVk->GetUniqueID() : 0);
+                    // Sampler assigned to the texture view may change
+                    if (Res.SpirvAttribs.Type == SPIRVShaderResourceAttribs::ResourceType::SampledImage && !Res.IsImmutableSamplerAssigned())
+                    {
+                        const auto* pSamplerVk = pTexViewVk != nullptr ? ValidatedCast<const SamplerVkImpl>(pTexViewVk->GetSampler()) : nullptr;
+                        IDs.push_back(pSamplerVk != nullptr ? pSamplerVk->GetUniqueID() : 0);
+                    }
+                }
+                break;
+
+                case SPIRVShaderResourceAttribs::ResourceType::AtomicCounter:
+                    // Do nothing
+                break;
+
+                case SPIRVShaderResourceAttribs::ResourceType::SeparateSampler:
+                    if (!Res.IsImmutableSamplerAssigned())
+                    {
+                        const auto* pSamplerVk = CachedRes.pObject.RawPtr<const SamplerVkImpl>();
+                        IDs.push_back(pSamplerVk != nullptr ? pSamplerVk->GetUniqueID() : 0);
+                    }
+                break;
+
+                default:
+                    UNEXPECTED("Unexpected resource type");
+            }
+        }
+    }
+}
+
 }
@@ -69,6 +69,15 @@ ShaderVkImpl::ShaderVkImpl(IReferenceCounters*     pRefCounters,
         {
             LOG_ERROR_AND_THROW("Failed to compile shader");
         }
+
+        if (CreationAttribs.SPIRVOptimization != SPIRV_OPTIMIZATION_LEVEL_NONE)
+        {
+            auto OptimizedSPIRV = OptimizeSPIRV(m_SPIRV, CreationAttribs.SPIRVOptimization, CreationAttribs.SPIRVOptimizationPasses);
+            if (!OptimizedSPIRV.empty())
+                m_SPIRV.swap(OptimizedSPIRV);
+            else
+                LOG_WARNING_MESSAGE("Failed to optimize SPIRV of shader '", m_Desc.Name, "'. Unoptimized byte code will be used.");
+        }
 #endif
     }
     else if (CreationAttribs.ByteCode != nullptr)
@@ -89,11 +98,31 @@ ShaderVkImpl::ShaderVkImpl(IReferenceCounters*     pRefCounters,
     // Load shader resources
     auto& Allocator = GetRawAllocator();
     auto* pRawMem = ALLOCATE(Allocator, "Allocator for ShaderResources", SPIRVShaderResources, 1);
-    bool IsHLSLVertexShader = CreationAttribs.SourceLanguage == SHADER_SOURCE_LANGUAGE_HLSL && m_Desc.ShaderType == SHADER_TYPE_VERTEX;
-    auto* pResources = new (pRawMem) SPIRVShaderResources(Allocator, pRenderDeviceVk, m_SPIRV, m_Desc, CreationAttribs.UseCombinedTextureSamplers ? CreationAttribs.CombinedSamplerSuffix : nullptr, IsHLSLVertexShader, m_EntryPoint);
+    SPIRVShaderResources* pResources = nullptr;
+    bool MapStageInputs = false;
+    try
+    {
+        if (CreationAttribs.ByteCode != nullptr && CreationAttribs.SerializedResources != nullptr)
+        {
+            // Serialized resources contain stage inputs only if they were loaded for HLSL vertex shader
+            pResources = new (pRawMem) SPIRVShaderResources(Allocator, m_SPIRV, CreationAttribs.SerializedResources, CreationAttribs.SerializedResourcesSize, m_Desc, m_EntryPoint);
+            MapStageInputs = pResources->GetNumShaderStageInputs() > 0;
+        }
+        else
+        {
+            bool IsHLSLVertexShader = CreationAttribs.SourceLanguage == SHADER_SOURCE_LANGUAGE_HLSL && m_Desc.ShaderType == SHADER_TYPE_VERTEX;
+            pResources = new (pRawMem) SPIRVShaderResources(Allocator, pRenderDeviceVk, m_SPIRV, m_Desc, CreationAttribs.UseCombinedTextureSamplers ? CreationAttribs.CombinedSamplerSuffix : nullptr, IsHLSLVertexShader, m_EntryPoint);
+            MapStageInputs = IsHLSLVertexShader;
+        }
+    }
+    catch(...)
+    {
+        Allocator.Free(pRawMem);
+        throw;
+    }
     m_pShaderResources.reset(pResources, STDDeleterRawMem<SPIRVShaderResources>(Allocator));
     
-    if (IsHLSLVertexShader)
+    if (MapStageInputs)
     {
         MapHLSLVertexShaderInputs();
     }
@@ -134,6 +163,18 @@ ShaderVkImpl::~ShaderVkImpl()
 {
 }
 
+void ShaderVkImpl::SerializeResources(IDataBlob** ppData)const
+{
+    DEV_CHECK_ERR(ppData != nullptr && *ppData == nullptr, "ppData must not be null and must point to null");
+
+    std::vector<Uint8> Data;
+    m_pShaderResources->Serialize(m_EntryPoint, m_SPIRV.size(), Data);
+
+    auto* pDataBlob = MakeNewRCObj<DataBlobImpl>()(Data.size());
+    memcpy(pDataBlob->GetDataPtr(), Data.data(), Data.size());
+    pDataBlob->QueryInterface(IID_DataBlob, reinterpret_cast<IObject**>(ppData));
+}
+
 ShaderResourceDesc ShaderVkImpl::GetResource(Uint32 Index)const
 {
     auto ResCount = GetResourceCount();
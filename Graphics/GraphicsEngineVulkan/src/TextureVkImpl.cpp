@@ -178,7 +178,7 @@ TextureVkImpl :: TextureVkImpl(IReferenceCounters*          pRefCounters,
             ImageMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
         VERIFY( IsPowerOfTwo(MemReqs.alignment), "Alignment is not power of 2!");
-        m_MemoryAllocation = pRenderDeviceVk->AllocateMemory(MemReqs, ImageMemoryFlags);
+        m_MemoryAllocation = pRenderDeviceVk->AllocateImageMemory(m_VulkanImage, MemReqs, ImageMemoryFlags);
         auto AlignedOffset = Align(m_MemoryAllocation.UnalignedOffset, MemReqs.alignment);
         VERIFY_EXPR(m_MemoryAllocation.Size >= MemReqs.size + (AlignedOffset - m_MemoryAllocation.UnalignedOffset));
         auto Memory = m_MemoryAllocation.Page->GetVkMemory();
@@ -429,7 +429,7 @@ TextureVkImpl :: TextureVkImpl(IReferenceCounters*          pRefCounters,
         VkMemoryRequirements StagingBufferMemReqs = LogicalDevice.GetBufferMemoryRequirements(m_StagingBuffer);
         VERIFY( IsPowerOfTwo(StagingBufferMemReqs.alignment), "Alignment is not power of 2!");
 
-        m_MemoryAllocation = pRenderDeviceVk->AllocateMemory(StagingBufferMemReqs, MemProperties);
+        m_MemoryAllocation = pRenderDeviceVk->AllocateBufferMemory(m_StagingBuffer, StagingBufferMemReqs, MemProperties);
         auto StagingBufferMemory = m_MemoryAllocation.Page->GetVkMemory();
         auto AlignedStagingMemOffset = Align(m_MemoryAllocation.UnalignedOffset, StagingBufferMemReqs.alignment);
         VERIFY_EXPR(m_MemoryAllocation.Size >= StagingBufferMemReqs.size + (AlignedStagingMemOffset - m_MemoryAllocation.UnalignedOffset));
@@ -40,8 +40,9 @@ static VkDeviceSize GetDefaultAlignment(const VulkanUtilities::VulkanPhysicalDev
 VulkanDynamicMemoryManager::VulkanDynamicMemoryManager(IMemoryAllocator&   Allocator, 
                                                        RenderDeviceVkImpl& DeviceVk, 
                                                        Uint32              Size,
+                                                       Uint32              PageSize,
                                                        Uint64              CommandQueueMask) :
-    TBase             {Allocator, Size},
+    TBase             {Allocator, Size, PageSize, MasterBlockAlignment},
     m_DeviceVk        {DeviceVk},
     m_DefaultAlignment{GetDefaultAlignment(DeviceVk.GetPhysicalDevice())},
     m_CommandQueueMask{CommandQueueMask}
@@ -86,6 +87,9 @@ VulkanDynamicMemoryManager::VulkanDynamicMemoryManager(IMemoryAllocator&   Alloc
            "and the VK_MEMORY_PROPERTY_HOST_COHERENT_BIT bit set(11.6)");
 
     m_BufferMemory = LogicalDevice.AllocateDeviceMemory(MemAlloc, "Host-visible memory for upload buffer");
+    m_MemoryTypeIndex = MemAlloc.memoryTypeIndex;
+    m_MemorySize      = MemAlloc.allocationSize;
+    DeviceVk.GetGlobalMemoryManager().TrackExternalMemory(m_MemoryTypeIndex, VulkanUtilities::VulkanMemoryCategory::Dynamic, static_cast<int64_t>(m_MemorySize));
 
     void *Data = nullptr;
     auto err = LogicalDevice.MapMemory(m_BufferMemory,
@@ -109,6 +113,7 @@ void VulkanDynamicMemoryManager::Destroy()
         m_DeviceVk.GetLogicalDevice().UnmapMemory(m_BufferMemory);
         m_DeviceVk.SafeReleaseDeviceObject(std::move(m_VkBuffer),     m_CommandQueueMask);
         m_DeviceVk.SafeReleaseDeviceObject(std::move(m_BufferMemory), m_CommandQueueMask);
+        m_DeviceVk.GetGlobalMemoryManager().TrackExternalMemory(m_MemoryTypeIndex, VulkanUtilities::VulkanMemoryCategory::Dynamic, -static_cast<int64_t>(m_MemorySize));
     }
     m_CPUAddress = nullptr;
 }
@@ -32,8 +32,10 @@ namespace VulkanUtilities
 {
     VulkanCommandBufferPool::VulkanCommandBufferPool(std::shared_ptr<const VulkanLogicalDevice> LogicalDevice,
                                                      uint32_t                                   queueFamilyIndex, 
-                                                     VkCommandPoolCreateFlags                   flags) :
-        m_LogicalDevice{std::move(LogicalDevice)}
+                                                     VkCommandPoolCreateFlags                   flags,
+                                                     VkCommandBufferLevel                       level) :
+        m_LogicalDevice{std::move(LogicalDevice)},
+        m_Level        {level}
     {
         VkCommandPoolCreateInfo CmdPoolCI = {};
         CmdPoolCI.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -53,8 +55,10 @@ namespace VulkanUtilities
         DEV_CHECK_ERR(m_BuffCounter == 0, m_BuffCounter, " command buffer(s) have not been returned to the pool. If there are outstanding references to these buffers in release queues, FreeCommandBuffer() will crash when attempting to return a buffer to the pool.");
     }
 
-    VkCommandBuffer VulkanCommandBufferPool::GetCommandBuffer(const char* DebugName)
+    VkCommandBuffer VulkanCommandBufferPool::GetCommandBuffer(const char* DebugName, const VkCommandBufferInheritanceInfo* pInheritanceInfo)
     {
+        VERIFY(pInheritanceInfo == nullptr || m_Level == VK_COMMAND_BUFFER_LEVEL_SECONDARY, "Inheritance info is only allowed for secondary command buffers");
+
         VkCommandBuffer CmdBuffer = VK_NULL_HANDLE;
 
         {
@@ -79,7 +83,7 @@ namespace VulkanUtilities
             BuffAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
             BuffAllocInfo.pNext              = nullptr;
             BuffAllocInfo.commandPool        = m_CmdPool;
-            BuffAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            BuffAllocInfo.level              = m_Level;
             BuffAllocInfo.commandBufferCount = 1;
 
             CmdBuffer = m_LogicalDevice->AllocateVkCommandBuffer(BuffAllocInfo);
@@ -92,7 +96,13 @@ namespace VulkanUtilities
         CmdBuffBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // Each recording of the command buffer will only be 
                                                                               // submitted once, and the command buffer will be reset 
                                                                               // and recorded again between each submission.
-        CmdBuffBeginInfo.pInheritanceInfo = nullptr; // Ignored for a primary command buffer
+        // Inheritance info is ignored for a primary command buffer
+        CmdBuffBeginInfo.pInheritanceInfo = pInheritanceInfo;
+        if (pInheritanceInfo != nullptr)
+        {
+            // The secondary command buffer is entirely inside the render pass
+            CmdBuffBeginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
         auto err = vkBeginCommandBuffer(CmdBuffer, &CmdBuffBeginInfo);
         DEV_CHECK_ERR(err == VK_SUCCESS, "Failed to begin command buffer"); (void)err;
 #ifdef DEVELOPMENT
@@ -379,6 +379,11 @@ namespace VulkanUtilities
         SetObjectName(device, (uint64_t)_event, VK_OBJECT_TYPE_EVENT, name);
     }
 
+    void SetQueryPoolName(VkDevice device, VkQueryPool queryPool, const char * name)
+    {
+        SetObjectName(device, (uint64_t)queryPool, VK_OBJECT_TYPE_QUERY_POOL, name);
+    }
+
 
 
 
@@ -481,6 +486,11 @@ namespace VulkanUtilities
     {
         SetEventName(device, _event, name);
     }
+
+    void SetVulkanObjectName(VkDevice device, VkQueryPool queryPool, const char * name)
+    {
+        SetQueryPoolName(device, queryPool, name);
+    }
     
 
 
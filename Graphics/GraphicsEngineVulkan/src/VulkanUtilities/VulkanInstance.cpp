@@ -128,6 +128,18 @@ namespace VulkanUtilities
                 LOG_ERROR_AND_THROW("Required extension ", ExtName, " is not available");
         }
 
+        // VK_KHR_get_physical_device_properties2 is required to query memory budget
+        // through VK_EXT_memory_budget device extension
+        m_PhysicalDeviceProperties2Enabled = IsExtensionAvailable(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (m_PhysicalDeviceProperties2Enabled)
+        {
+            bool AlreadyEnabled = false;
+            for(const auto* ExtName : GlobalExtensions)
+                AlreadyEnabled = AlreadyEnabled || strcmp(ExtName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0;
+            if (!AlreadyEnabled)
+                GlobalExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+
         if (EnableValidation)
         {
             m_DebugUtilsEnabled = IsExtensionAvailable(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
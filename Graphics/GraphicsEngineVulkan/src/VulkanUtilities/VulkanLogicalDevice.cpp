@@ -55,6 +55,18 @@ namespace VulkanUtilities
             m_EnabledGraphicsShaderStages = VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
         if (DeviceCI.pEnabledFeatures->tessellationShader)
             m_EnabledGraphicsShaderStages = VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT;
+
+        m_EnabledExtensions.reserve(DeviceCI.enabledExtensionCount);
+        for (uint32_t ext=0; ext < DeviceCI.enabledExtensionCount; ++ext)
+            m_EnabledExtensions.emplace_back(DeviceCI.ppEnabledExtensionNames[ext]);
+    }
+
+    bool VulkanLogicalDevice::IsExtensionEnabled(const char* ExtensionName)const
+    {
+        for (const auto& Extension : m_EnabledExtensions)
+            if (Extension == ExtensionName)
+                return true;
+        return false;
     }
 
     VkQueue VulkanLogicalDevice::GetQueue(uint32_t queueFamilyIndex, uint32_t queueIndex)
@@ -239,6 +251,12 @@ namespace VulkanUtilities
         return CreateVulkanObject<VkSemaphore>(vkCreateSemaphore, SemaphoreCI, DebugName, "semaphore");
     }
 
+    QueryPoolWrapper VulkanLogicalDevice::CreateQueryPool(const VkQueryPoolCreateInfo &QueryPoolCI, const char* DebugName)const
+    {
+        VERIFY_EXPR(QueryPoolCI.sType == VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO);
+        return CreateVulkanObject<VkQueryPool>(vkCreateQueryPool, QueryPoolCI, DebugName, "query pool");
+    }
+
     VkCommandBuffer VulkanLogicalDevice::AllocateVkCommandBuffer(const VkCommandBufferAllocateInfo& AllocInfo, const char* DebugName)const
     {
         VERIFY_EXPR(AllocInfo.sType == VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO);
@@ -371,6 +389,12 @@ namespace VulkanUtilities
         Semaphore.m_VkObject = VK_NULL_HANDLE;
     }
 
+    void VulkanLogicalDevice::ReleaseVulkanObject(QueryPoolWrapper&& QueryPool)const
+    {
+        vkDestroyQueryPool(m_VkDevice, QueryPool.m_VkObject, m_VkAllocator);
+        QueryPool.m_VkObject = VK_NULL_HANDLE;
+    }
+
 
     void VulkanLogicalDevice::FreeDescriptorSet(VkDescriptorPool Pool, VkDescriptorSet Set)const
     {
@@ -468,4 +492,15 @@ namespace VulkanUtilities
         DEV_CHECK_ERR(err == VK_SUCCESS, "Failed to reset descriptor pool");
         return err;
     }
+
+    VkResult VulkanLogicalDevice::GetQueryPoolResults(VkQueryPool        queryPool,
+                                                      uint32_t           firstQuery,
+                                                      uint32_t           queryCount,
+                                                      size_t             dataSize,
+                                                      void*              pData,
+                                                      VkDeviceSize       stride,
+                                                      VkQueryResultFlags flags)const
+    {
+        return vkGetQueryPoolResults(m_VkDevice, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+    }
 }
@@ -27,21 +27,32 @@
 
 namespace VulkanUtilities
 {
-    
+
+static void UpdatePeakValue(std::atomic_int64_t& Peak, int64_t Value)
+{
+    auto CurrPeak = Peak.load();
+    while (CurrPeak < Value && !Peak.compare_exchange_weak(CurrPeak, Value))
+    {}
+}
+
 VulkanMemoryAllocation::~VulkanMemoryAllocation()
 {
     if (Page != nullptr)
     {
-        Page->Free(std::move(*this));
+        Page->m_ParentMemoryMgr.Free(*this);
     }
 }
 
 VulkanMemoryPage::VulkanMemoryPage(VulkanMemoryManager& ParentMemoryMgr,
                                    VkDeviceSize         PageSize, 
                                    uint32_t             MemoryTypeIndex,
-                                   bool                 IsHostVisible)noexcept : 
+                                   bool                 IsHostVisible,
+                                   bool                 IsDedicated,
+                                   VkBuffer             DedicatedBuffer,
+                                   VkImage              DedicatedImage) : 
     m_ParentMemoryMgr{ParentMemoryMgr},
-    m_AllocationMgr  {PageSize, ParentMemoryMgr.m_Allocator}
+    m_AllocationMgr  {PageSize, ParentMemoryMgr.m_Allocator},
+    m_IsDedicated    {IsDedicated}
 {
     VkMemoryAllocateInfo MemAlloc = {};
     MemAlloc.pNext = nullptr;
@@ -49,7 +60,20 @@ VulkanMemoryPage::VulkanMemoryPage(VulkanMemoryManager& ParentMemoryMgr,
     MemAlloc.allocationSize = PageSize;
     MemAlloc.memoryTypeIndex = MemoryTypeIndex;
 
-    auto MemoryName = Diligent::FormatString("Device memory page. Size: ", Diligent::FormatMemorySize(PageSize, 2), ", type: ", MemoryTypeIndex);
+    VkMemoryDedicatedAllocateInfoKHR DedicatedAllocInfo = {};
+    if (DedicatedBuffer != VK_NULL_HANDLE || DedicatedImage != VK_NULL_HANDLE)
+    {
+        VERIFY_EXPR(IsDedicated);
+        VERIFY(DedicatedBuffer == VK_NULL_HANDLE || DedicatedImage == VK_NULL_HANDLE, "Dedicated memory can't be bound to a buffer and an image at the same time");
+        DedicatedAllocInfo.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+        DedicatedAllocInfo.pNext  = nullptr;
+        DedicatedAllocInfo.buffer = DedicatedBuffer;
+        DedicatedAllocInfo.image  = DedicatedImage;
+        MemAlloc.pNext = &DedicatedAllocInfo;
+    }
+
+    auto MemoryName = Diligent::FormatString(IsDedicated ? "Dedicated device memory. Size: " : "Device memory page. Size: ", 
+                                             Diligent::FormatMemorySize(PageSize, 2), ", type: ", MemoryTypeIndex);
     m_VkMemory = ParentMemoryMgr.m_LogicalDevice.AllocateDeviceMemory(MemAlloc, MemoryName.c_str());
 
     if (IsHostVisible)
@@ -76,7 +100,6 @@ VulkanMemoryPage::~VulkanMemoryPage()
 
 VulkanMemoryAllocation VulkanMemoryPage::Allocate(VkDeviceSize size, VkDeviceSize alignment)
 {
-    std::lock_guard<std::mutex> Lock{m_Mutex};
     auto Allocation = m_AllocationMgr.Allocate(size, alignment);
     if (Allocation.IsValid())
     {
@@ -91,15 +114,60 @@ VulkanMemoryAllocation VulkanMemoryPage::Allocate(VkDeviceSize size, VkDeviceSiz
     }
 }
 
-void VulkanMemoryPage::Free(VulkanMemoryAllocation&& Allocation)
+void VulkanMemoryPage::Free(VulkanMemoryAllocation& Allocation)
 {
-    m_ParentMemoryMgr.OnFreeAllocation(Allocation.Size, m_CPUMemory != nullptr);
-    std::lock_guard<std::mutex> Lock{m_Mutex};
+    VERIFY_EXPR(Allocation.Page == this);
     m_AllocationMgr.Free(Allocation.UnalignedOffset, Allocation.Size);
-    Allocation = VulkanMemoryAllocation{};
+    Allocation.Page            = nullptr;
+    Allocation.UnalignedOffset = 0;
+    Allocation.Size            = 0;
 }
 
-VulkanMemoryAllocation VulkanMemoryManager::Allocate(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps)
+
+VulkanMemoryManager::VulkanMemoryManager(std::string                  MgrName,
+                                         const VulkanLogicalDevice&   LogicalDevice, 
+                                         const VulkanPhysicalDevice&  PhysicalDevice, 
+                                         Diligent::IMemoryAllocator&  Allocator, 
+                                         VkDeviceSize                 DeviceLocalPageSize,
+                                         VkDeviceSize                 HostVisiblePageSize,
+                                         VkDeviceSize                 DeviceLocalReserveSize,
+                                         VkDeviceSize                 HostVisibleReserveSize,
+                                         VkDeviceSize                 DedicatedAllocationThreshold) : 
+    m_MgrName                     {std::move(MgrName)          },
+    m_LogicalDevice               {LogicalDevice               },
+    m_PhysicalDevice              {PhysicalDevice              },
+    m_Allocator                   {Allocator                   },
+    m_DeviceLocalPageSize         {DeviceLocalPageSize         },
+    m_HostVisiblePageSize         {HostVisiblePageSize         },
+    m_DeviceLocalReserveSize      {DeviceLocalReserveSize      },
+    m_HostVisibleReserveSize      {HostVisibleReserveSize      },
+    m_DedicatedAllocationThreshold{DedicatedAllocationThreshold},
+    m_UseDedicatedAllocationInfo  {LogicalDevice.IsExtensionEnabled(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME)},
+    // Granularity of 1 means that linear and optimal resources can be placed next to each other
+    m_SeparateResourceTypes       {PhysicalDevice.GetProperties().limits.bufferImageGranularity > 1}
+{
+    const auto& MemoryProps     = PhysicalDevice.GetMemoryProperties();
+    const auto  MemoryTypeCount = MemoryProps.memoryTypeCount;
+    m_Pools.reserve(MemoryTypeCount * 2 * static_cast<size_t>(VulkanMemoryResourceType::NumTypes));
+    for (uint32_t MemoryTypeIndex = 0; MemoryTypeIndex < MemoryTypeCount; ++MemoryTypeIndex)
+    {
+        for (int HostVisible = 0; HostVisible < 2; ++HostVisible)
+        {
+            for (int ResType = 0; ResType < static_cast<int>(VulkanMemoryResourceType::NumTypes); ++ResType)
+            {
+                VERIFY_EXPR(m_Pools.size() == GetPoolIndex(MemoryTypeIndex, HostVisible != 0, static_cast<VulkanMemoryResourceType>(ResType)));
+                m_Pools.emplace_back(new MemoryPool{MemoryTypeIndex, MemoryProps.memoryTypes[MemoryTypeIndex].heapIndex, HostVisible != 0, static_cast<VulkanMemoryResourceType>(ResType)});
+            }
+        }
+    }
+}
+
+uint32_t VulkanMemoryManager::GetPoolIndex(uint32_t MemoryTypeIndex, bool HostVisible, VulkanMemoryResourceType ResType)const
+{
+    return (MemoryTypeIndex * 2 + (HostVisible ? 1 : 0)) * static_cast<uint32_t>(VulkanMemoryResourceType::NumTypes) + static_cast<uint32_t>(ResType);
+}
+
+uint32_t VulkanMemoryManager::GetMemoryTypeIndex(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps)const
 {
     // memoryTypeBits is a bitmask and contains one bit set for every supported memory type for the resource. 
     // Bit i is set if and only if the memory type i in the VkPhysicalDeviceMemoryProperties structure for the 
@@ -126,14 +194,60 @@ VulkanMemoryAllocation VulkanMemoryManager::Allocate(const VkMemoryRequirements&
     {
         LOG_ERROR_AND_THROW("Failed to find suitable device memory type for a buffer");
     }
+    return MemoryTypeIndex;
+}
 
+VulkanMemoryAllocation VulkanMemoryManager::Allocate(const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps, VulkanMemoryResourceType ResType)
+{
+    auto MemoryTypeIndex = GetMemoryTypeIndex(MemReqs, MemoryProps);
     bool HostVisible = (MemoryProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
-    return Allocate(MemReqs.size, MemReqs.alignment, MemoryTypeIndex, HostVisible);
+    auto Category = HostVisible ? VulkanMemoryCategory::Staging : VulkanMemoryCategory::Buffer;
+    return AllocateImpl(MemReqs.size, MemReqs.alignment, MemoryTypeIndex, HostVisible, ResType, Category, VK_NULL_HANDLE, VK_NULL_HANDLE);
 }
 
-VulkanMemoryAllocation VulkanMemoryManager::Allocate(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t MemoryTypeIndex, bool HostVisible)
+VulkanMemoryAllocation VulkanMemoryManager::Allocate(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t MemoryTypeIndex, bool HostVisible, VulkanMemoryResourceType ResType)
 {
-    VulkanMemoryAllocation Allocation;
+    auto Category = HostVisible ? VulkanMemoryCategory::Staging : VulkanMemoryCategory::Buffer;
+    return AllocateImpl(Size, Alignment, MemoryTypeIndex, HostVisible, ResType, Category, VK_NULL_HANDLE, VK_NULL_HANDLE);
+}
+
+VulkanMemoryAllocation VulkanMemoryManager::AllocateForBuffer(VkBuffer vkBuffer, const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps)
+{
+    auto MemoryTypeIndex = GetMemoryTypeIndex(MemReqs, MemoryProps);
+    bool HostVisible = (MemoryProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    auto Category = HostVisible ? VulkanMemoryCategory::Staging : VulkanMemoryCategory::Buffer;
+    return AllocateImpl(MemReqs.size, MemReqs.alignment, MemoryTypeIndex, HostVisible, VulkanMemoryResourceType::Linear, Category, vkBuffer, VK_NULL_HANDLE);
+}
+
+VulkanMemoryAllocation VulkanMemoryManager::AllocateForImage(VkImage vkImage, const VkMemoryRequirements& MemReqs, VkMemoryPropertyFlags MemoryProps)
+{
+    auto MemoryTypeIndex = GetMemoryTypeIndex(MemReqs, MemoryProps);
+    bool HostVisible = (MemoryProps & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    return AllocateImpl(MemReqs.size, MemReqs.alignment, MemoryTypeIndex, HostVisible, VulkanMemoryResourceType::Optimal, VulkanMemoryCategory::Texture, VK_NULL_HANDLE, vkImage);
+}
+
+void VulkanMemoryManager::UpdatePagePosition(MemoryPool& Pool, VulkanMemoryPage& Page)
+{
+    auto MaxFreeBlockSize = Page.GetMaxFreeBlockSize();
+    if (Page.m_PoolIt->first == MaxFreeBlockSize)
+        return;
+
+    auto pPage = std::move(Page.m_PoolIt->second);
+    auto Hint = Pool.Pages.erase(Page.m_PoolIt);
+    Page.m_PoolIt = Pool.Pages.emplace_hint(Hint, MaxFreeBlockSize, std::move(pPage));
+}
+
+VulkanMemoryAllocation VulkanMemoryManager::AllocateImpl(VkDeviceSize             Size,
+                                                         VkDeviceSize             Alignment,
+                                                         uint32_t                 MemoryTypeIndex,
+                                                         bool                     HostVisible,
+                                                         VulkanMemoryResourceType ResType,
+                                                         VulkanMemoryCategory     Category,
+                                                         VkBuffer                 DedicatedBuffer,
+                                                         VkImage                  DedicatedImage)
+{
+    VERIFY(MemoryTypeIndex < m_PhysicalDevice.GetMemoryProperties().memoryTypeCount, "Memory type index (", MemoryTypeIndex, ") is out of range");
+    VERIFY(Diligent::IsPowerOfTwo(Alignment), "Alignment (", Alignment, ") is not power of 2");
 
     // On integrated GPUs, there is no difference between host-visible and GPU-only
     // memory, so MemoryTypeIndex is the same. As GPU-only pages do not have CPU address, 
@@ -142,33 +256,85 @@ VulkanMemoryAllocation VulkanMemoryManager::Allocate(VkDeviceSize Size, VkDevice
     // even though on integrated GPUs same pages can be used for both GPU-only and staging 
     // allocations. Staging allocations are short-living and will be released when upload is 
     // complete, while GPU-only allocations are expected to be long-living.
-    MemoryPageIndex PageIdx{MemoryTypeIndex, HostVisible};
-    std::lock_guard<std::mutex> Lock{m_PagesMtx};
-    auto range = m_Pages.equal_range(PageIdx);
-    for(auto page_it = range.first; page_it != range.second; ++page_it)
+    if (!m_SeparateResourceTypes)
+        ResType = VulkanMemoryResourceType::Linear;
+    auto PoolIdx = GetPoolIndex(MemoryTypeIndex, HostVisible, ResType);
+    auto& Pool = *m_Pools[PoolIdx];
+
+    const size_t stat_ind = HostVisible ? 1 : 0;
+    const bool IsDedicated = m_DedicatedAllocationThreshold != 0 && Size >= m_DedicatedAllocationThreshold;
+
+    VulkanMemoryAllocation Allocation;
+
+    std::lock_guard<std::mutex> Lock{Pool.Mtx};
+    if (!IsDedicated)
     {
-        Allocation = page_it->second.Allocate(Size, Alignment);
-        if (Allocation.Page != nullptr)
-            break;
+        // Pages are sorted by the size of their largest free block. All pages before the first page
+        // whose largest block is at least Size bytes can't accommodate the request. Usually the allocation
+        // succeeds in that page; alignment reserve may require checking subsequent pages.
+        const auto AlignedSize = Diligent::Align(Size, Alignment);
+        for (auto page_it = Pool.Pages.lower_bound(AlignedSize); page_it != Pool.Pages.end(); ++page_it)
+        {
+            auto& Page = *page_it->second;
+            if (Page.m_IsDefragmentationSource)
+                continue;
+
+            Allocation = Page.Allocate(Size, Alignment);
+            if (Allocation.Page != nullptr)
+            {
+                UpdatePagePosition(Pool, Page);
+                break;
+            }
+        }
     }
 
-    size_t stat_ind = HostVisible ? 1 : 0;
     if (Allocation.Page == nullptr)
     {
-        auto PageSize = HostVisible ? m_HostVisiblePageSize : m_DeviceLocalPageSize;
-        while (PageSize < Size)
-            PageSize *= 2;
+        VkDeviceSize PageSize = 0;
+        if (IsDedicated)
+        {
+            PageSize = Diligent::Align(Size, Alignment);
+            // allocationSize of the memory dedicated to a resource must be equal to the resource memory size
+            if (PageSize != Size)
+            {
+                DedicatedBuffer = VK_NULL_HANDLE;
+                DedicatedImage  = VK_NULL_HANDLE;
+            }
+        }
+        else
+        {
+            PageSize = HostVisible ? m_HostVisiblePageSize : m_DeviceLocalPageSize;
+            while (PageSize < Size)
+                PageSize *= 2;
+        }
+
+        std::unique_ptr<VulkanMemoryPage> pNewPage
+        {
+            new VulkanMemoryPage
+            {
+                *this, PageSize, MemoryTypeIndex, HostVisible, IsDedicated, 
+                m_UseDedicatedAllocationInfo ? DedicatedBuffer : VK_NULL_HANDLE,
+                m_UseDedicatedAllocationInfo ? DedicatedImage  : VK_NULL_HANDLE
+            }
+        };
+        auto& NewPage = *pNewPage;
+        NewPage.m_PoolIdx = PoolIdx;
+        NewPage.m_PoolIt  = Pool.Pages.emplace(NewPage.GetMaxFreeBlockSize(), std::move(pNewPage));
 
-        m_CurrAllocatedSize[stat_ind] += PageSize;
-        m_PeakAllocatedSize[stat_ind] = std::max(m_PeakAllocatedSize[stat_ind], m_CurrAllocatedSize[stat_ind]);
+        auto CurrAllocatedSize = m_CurrAllocatedSize[stat_ind].fetch_add(static_cast<int64_t>(PageSize)) + static_cast<int64_t>(PageSize);
+        UpdatePeakValue(m_PeakAllocatedSize[stat_ind], CurrAllocatedSize);
+        m_HeapAllocatedSize[Pool.HeapIndex].fetch_add(static_cast<int64_t>(PageSize));
 
-        auto it = m_Pages.emplace(PageIdx, VulkanMemoryPage{*this, PageSize, MemoryTypeIndex, HostVisible});
-        LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "': created new ", (HostVisible ? "host-visible" : "device-local"), 
-                         " page. (", Diligent::FormatMemorySize(PageSize, 2), ", type idx: ", MemoryTypeIndex, 
-                         "). Current allocated size: ", Diligent::FormatMemorySize(m_CurrAllocatedSize[stat_ind], 2));
-        OnNewPageCreated(it->second);
-        Allocation = it->second.Allocate(Size, Alignment);
+        if (!IsDedicated)
+        {
+            LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "': created new ", (HostVisible ? "host-visible" : "device-local"), 
+                             " page. (", Diligent::FormatMemorySize(PageSize, 2), ", type idx: ", MemoryTypeIndex, 
+                             "). Current allocated size: ", Diligent::FormatMemorySize(CurrAllocatedSize, 2));
+        }
+        OnNewPageCreated(NewPage);
+        Allocation = NewPage.Allocate(Size, Alignment);
         DEV_CHECK_ERR(Allocation.Page != nullptr, "Failed to allocate new memory page");
+        UpdatePagePosition(Pool, NewPage);
     }
 
     if (Allocation.Page != nullptr)
@@ -176,61 +342,252 @@ VulkanMemoryAllocation VulkanMemoryManager::Allocate(VkDeviceSize Size, VkDevice
         VERIFY_EXPR(Size + Diligent::Align(Allocation.UnalignedOffset, Alignment) - Allocation.UnalignedOffset <= Allocation.Size);
     }
 
-    m_CurrUsedSize[stat_ind].fetch_add(Allocation.Size);
-    m_PeakUsedSize[stat_ind] = std::max(m_PeakUsedSize[stat_ind], static_cast<VkDeviceSize>(m_CurrUsedSize[stat_ind].load()));
+    auto CurrUsedSize = m_CurrUsedSize[stat_ind].fetch_add(static_cast<int64_t>(Allocation.Size)) + static_cast<int64_t>(Allocation.Size);
+    UpdatePeakValue(m_PeakUsedSize[stat_ind], CurrUsedSize);
+    Allocation.Category = Category;
+    m_HeapUsedSize[Pool.HeapIndex][static_cast<size_t>(Category)].fetch_add(static_cast<int64_t>(Allocation.Size));
 
     return Allocation;
 }
 
-void VulkanMemoryManager::ShrinkMemory()
+void VulkanMemoryManager::DestroyPage(MemoryPool& Pool, VulkanMemoryPage& Page)
 {
-    std::lock_guard<std::mutex> Lock{m_PagesMtx};
-    if (m_CurrAllocatedSize[0] <= m_DeviceLocalReserveSize && m_CurrAllocatedSize[1] <= m_HostVisibleReserveSize)
-        return;
+    VERIFY_EXPR(Page.IsEmpty());
+    auto PageSize = Page.GetPageSize();
+    auto stat_ind = Pool.IsHostVisible ? 1 : 0;
+    m_CurrAllocatedSize[stat_ind].fetch_add(-static_cast<int64_t>(PageSize));
+    m_HeapAllocatedSize[Pool.HeapIndex].fetch_add(-static_cast<int64_t>(PageSize));
+    OnPageDestroy(Page);
+    // Destroys the page
+    Pool.Pages.erase(Page.m_PoolIt);
+}
+
+void VulkanMemoryManager::Free(VulkanMemoryAllocation& Allocation)
+{
+    auto& Page = *Allocation.Page;
+    VERIFY(&Page.m_ParentMemoryMgr == this, "The allocation does not belong to this memory manager");
+    auto& Pool = *m_Pools[Page.m_PoolIdx];
+    m_CurrUsedSize[Pool.IsHostVisible ? 1 : 0].fetch_add(-static_cast<int64_t>(Allocation.Size));
+    m_HeapUsedSize[Pool.HeapIndex][static_cast<size_t>(Allocation.Category)].fetch_add(-static_cast<int64_t>(Allocation.Size));
+
+    std::lock_guard<std::mutex> Lock{Pool.Mtx};
+    Page.Free(Allocation);
+    if (Page.IsDedicated())
+    {
+        // Dedicated memory is never reused
+        DestroyPage(Pool, Page);
+    }
+    else if (Page.m_IsDefragmentationSource && Page.IsEmpty())
+    {
+        auto PageSize = Page.GetPageSize();
+        DestroyPage(Pool, Page);
+        m_NumDefragReleasedPages.fetch_add(1);
+        m_DefragReleasedSize.fetch_add(PageSize);
+        LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "': released defragmented ", (Pool.IsHostVisible ? "host-visible" : "device-local"), 
+                         " page (", Diligent::FormatMemorySize(PageSize, 2), ")");
+    }
+    else
+    {
+        UpdatePagePosition(Pool, Page);
+    }
+}
+
+bool VulkanMemoryManager::BeginPageDefragmentation(VulkanMemoryPage& Page, VkDeviceSize MovableSize, float MaxOccupancy)
+{
+    VERIFY(&Page.m_ParentMemoryMgr == this, "The page does not belong to this memory manager");
+    auto& Pool = *m_Pools[Page.m_PoolIdx];
+
+    std::lock_guard<std::mutex> Lock{Pool.Mtx};
+    if (Page.m_IsDefragmentationSource)
+        return true;
+
+    if (Page.IsDedicated() || Page.IsEmpty())
+        return false;
+
+    // Allocations that can't be moved would keep the page alive
+    const auto UsedSize = Page.GetUsedSize();
+    if (MovableSize < UsedSize)
+        return false;
+
+    if (static_cast<float>(UsedSize) > static_cast<float>(Page.GetPageSize()) * MaxOccupancy)
+        return false;
+
+    // Do not start defragmentation that will only result in allocating new pages
+    VkDeviceSize AvailableSize = 0;
+    for (const auto& it : Pool.Pages)
+    {
+        const auto& OtherPage = *it.second;
+        if (&OtherPage != &Page && !OtherPage.IsDedicated() && !OtherPage.m_IsDefragmentationSource)
+            AvailableSize += OtherPage.GetPageSize() - OtherPage.GetUsedSize();
+    }
+    if (AvailableSize < UsedSize)
+        return false;
+
+    Page.m_IsDefragmentationSource = true;
+    return true;
+}
+
+VulkanMemoryManager::DefragmentationStats VulkanMemoryManager::GetDefragmentationStats()const
+{
+    DefragmentationStats Stats;
+    Stats.NumReleasedPages = m_NumDefragReleasedPages.load();
+    Stats.ReleasedSize     = m_DefragReleasedSize.load();
+    return Stats;
+}
 
-    auto it = m_Pages.begin();
-    while (it != m_Pages.end())
+void VulkanMemoryManager::TrackExternalMemory(uint32_t MemoryTypeIndex, VulkanMemoryCategory Category, int64_t Size)
+{
+    VERIFY(MemoryTypeIndex < m_PhysicalDevice.GetMemoryProperties().memoryTypeCount, "Memory type index (", MemoryTypeIndex, ") is out of range");
+    auto HeapIndex = m_PhysicalDevice.GetMemoryProperties().memoryTypes[MemoryTypeIndex].heapIndex;
+    m_HeapAllocatedSize[HeapIndex].fetch_add(Size);
+    m_HeapUsedSize[HeapIndex][static_cast<size_t>(Category)].fetch_add(Size);
+}
+
+VulkanMemoryManager::HeapStats VulkanMemoryManager::GetHeapStats(uint32_t HeapIndex)const
+{
+    VERIFY(HeapIndex < m_PhysicalDevice.GetMemoryProperties().memoryHeapCount, "Heap index (", HeapIndex, ") is out of range");
+    HeapStats Stats;
+    Stats.AllocatedSize = static_cast<VkDeviceSize>(m_HeapAllocatedSize[HeapIndex].load());
+    for (size_t cat = 0; cat < Stats.UsedSize.size(); ++cat)
+        Stats.UsedSize[cat] = static_cast<VkDeviceSize>(m_HeapUsedSize[HeapIndex][cat].load());
+    return Stats;
+}
+
+void VulkanMemoryManager::ShrinkMemory()
+{
+    for (auto& pPool : m_Pools)
     {
-        auto curr_it = it;
-        ++it;
-        auto& Page = curr_it->second;
-        bool IsHostVisible = Page.GetCPUMemory() != nullptr;
-        auto ReserveSize = IsHostVisible ? m_HostVisibleReserveSize : m_DeviceLocalReserveSize;
-        if (Page.IsEmpty() && m_CurrAllocatedSize[IsHostVisible ? 1 : 0] > ReserveSize)
+        auto& Pool = *pPool;
+        const auto stat_ind    = Pool.IsHostVisible ? 1 : 0;
+        const auto ReserveSize = static_cast<int64_t>(Pool.IsHostVisible ? m_HostVisibleReserveSize : m_DeviceLocalReserveSize);
+        if (m_CurrAllocatedSize[stat_ind].load() <= ReserveSize)
+            continue;
+
+        std::lock_guard<std::mutex> Lock{Pool.Mtx};
+        // Empty pages have the largest free blocks and are located at the end of the map
+        auto it = Pool.Pages.end();
+        while (it != Pool.Pages.begin())
         {
+            --it;
+            auto& Page = *it->second;
+            if (Page.GetMaxFreeBlockSize() != Page.GetPageSize())
+                continue; // Pages with smaller free blocks are not empty and may still be followed by empty ones
+
+            if (m_CurrAllocatedSize[stat_ind].load() <= ReserveSize)
+                break;
+
+            VERIFY_EXPR(Page.IsEmpty());
             auto PageSize = Page.GetPageSize();
-            m_CurrAllocatedSize[IsHostVisible ? 1 : 0] -= PageSize;
-            LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "': destroying ", (IsHostVisible ? "host-visible" : "device-local"), 
+            auto CurrAllocatedSize = m_CurrAllocatedSize[stat_ind].load() - static_cast<int64_t>(PageSize);
+            LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "': destroying ", (Pool.IsHostVisible ? "host-visible" : "device-local"), 
                              " page (", Diligent::FormatMemorySize(PageSize, 2), ")."
-                             " Current allocated size: ", Diligent::FormatMemorySize(m_CurrAllocatedSize[IsHostVisible ? 1 : 0], 2));
-            OnPageDestroy(Page);
-            m_Pages.erase(curr_it);
+                             " Current allocated size: ", Diligent::FormatMemorySize(CurrAllocatedSize, 2));
+            // Get the next element before the page is destroyed
+            auto next_it = std::next(it);
+            DestroyPage(Pool, Page);
+            it = next_it;
         }
     }
 }
 
-void VulkanMemoryManager::OnFreeAllocation(VkDeviceSize Size, bool IsHostVisble)
+void VulkanMemoryManager::DumpStatsJSON(std::ostream& Stream)
 {
-    m_CurrUsedSize[IsHostVisble ? 1 : 0].fetch_add( -static_cast<int64_t>(Size) );
+    static const char* const ResTypeNames[] = {"linear", "optimal"};
+    static_assert(_countof(ResTypeNames) == static_cast<size_t>(VulkanMemoryResourceType::NumTypes), "Please update the array");
+
+    // Fragmentation is the fraction of free memory that is not in the largest free block:
+    // 0 means that all free memory is contiguous
+    auto GetFragmentation = [](VkDeviceSize FreeSize, VkDeviceSize MaxFreeBlockSize)
+    {
+        return FreeSize > 0 ? 1.0 - static_cast<double>(MaxFreeBlockSize) / static_cast<double>(FreeSize) : 0.0;
+    };
+
+    Stream << "{\n"
+           << "  \"name\": \"" << m_MgrName << "\",\n";
+    for (size_t stat_ind = 0; stat_ind < 2; ++stat_ind)
+    {
+        Stream << "  \"" << (stat_ind == 0 ? "deviceLocal" : "hostVisible") << "\": {"
+               << "\"usedSize\": "          << m_CurrUsedSize[stat_ind].load()
+               << ", \"peakUsedSize\": "      << m_PeakUsedSize[stat_ind].load()
+               << ", \"allocatedSize\": "     << m_CurrAllocatedSize[stat_ind].load()
+               << ", \"peakAllocatedSize\": " << m_PeakAllocatedSize[stat_ind].load()
+               << "},\n";
+    }
+    Stream << "  \"defragmentation\": {\"releasedPages\": " << m_NumDefragReleasedPages.load()
+           << ", \"releasedSize\": " << m_DefragReleasedSize.load() << "},\n";
+    Stream << "  \"pools\": [";
+
+    bool FirstPool = true;
+    for (auto& pPool : m_Pools)
+    {
+        auto& Pool = *pPool;
+        std::lock_guard<std::mutex> Lock{Pool.Mtx};
+        if (Pool.Pages.empty())
+            continue;
+
+        VkDeviceSize TotalSize = 0, UsedSize = 0, MaxFreeBlockSize = 0;
+        for (const auto& it : Pool.Pages)
+        {
+            TotalSize       += it.second->GetPageSize();
+            UsedSize        += it.second->GetUsedSize();
+            MaxFreeBlockSize = std::max(MaxFreeBlockSize, it.second->GetMaxFreeBlockSize());
+        }
+
+        Stream << (FirstPool ? "\n" : ",\n")
+               << "    {\n"
+               << "      \"memoryTypeIndex\": "  << Pool.MemoryTypeIndex << ",\n"
+               << "      \"hostVisible\": "      << (Pool.IsHostVisible ? "true" : "false") << ",\n"
+               << "      \"resourceType\": \""   << ResTypeNames[static_cast<size_t>(Pool.ResType)] << "\",\n"
+               << "      \"numPages\": "         << Pool.Pages.size() << ",\n"
+               << "      \"totalSize\": "        << TotalSize << ",\n"
+               << "      \"usedSize\": "         << UsedSize << ",\n"
+               << "      \"maxFreeBlockSize\": " << MaxFreeBlockSize << ",\n"
+               << "      \"fragmentation\": "    << GetFragmentation(TotalSize - UsedSize, MaxFreeBlockSize) << ",\n"
+               << "      \"pages\": [";
+        bool FirstPage = true;
+        for (const auto& it : Pool.Pages)
+        {
+            const auto& Page = *it.second;
+            const auto FreeSize = Page.GetPageSize() - Page.GetUsedSize();
+            Stream << (FirstPage ? "\n" : ",\n")
+                   << "        {\"size\": "           << Page.GetPageSize()
+                   << ", \"usedSize\": "              << Page.GetUsedSize()
+                   << ", \"numFreeBlocks\": "         << Page.GetNumFreeBlocks()
+                   << ", \"maxFreeBlockSize\": "      << Page.GetMaxFreeBlockSize()
+                   << ", \"fragmentation\": "         << GetFragmentation(FreeSize, Page.GetMaxFreeBlockSize())
+                   << ", \"dedicated\": "             << (Page.IsDedicated() ? "true" : "false")
+                   << ", \"defragmenting\": "         << (Page.IsDefragmentationSource() ? "true" : "false")
+                   << "}";
+            FirstPage = false;
+        }
+        Stream << "\n      ]\n"
+               << "    }";
+        FirstPool = false;
+    }
+    Stream << "\n  ]\n"
+           << "}\n";
 }
 
 VulkanMemoryManager::~VulkanMemoryManager()
 {
-    auto PeakDeviceLocalPages  = m_PeakAllocatedSize[0] / m_DeviceLocalPageSize;
-    auto PeakHostVisisblePages = m_PeakAllocatedSize[1] / m_HostVisiblePageSize;
+    auto PeakDeviceLocalPages  = static_cast<VkDeviceSize>(m_PeakAllocatedSize[0].load()) / m_DeviceLocalPageSize;
+    auto PeakHostVisisblePages = static_cast<VkDeviceSize>(m_PeakAllocatedSize[1].load()) / m_HostVisiblePageSize;
     LOG_INFO_MESSAGE("VulkanMemoryManager '", m_MgrName, "' stats:\n"
                      "                       Peak used/allocated device-local memory size: ", 
-                     Diligent::FormatMemorySize(m_PeakUsedSize[0],      2, m_PeakAllocatedSize[0]), " / ",
-                     Diligent::FormatMemorySize(m_PeakAllocatedSize[0], 2, m_PeakAllocatedSize[0]),
+                     Diligent::FormatMemorySize(m_PeakUsedSize[0].load(),      2, m_PeakAllocatedSize[0].load()), " / ",
+                     Diligent::FormatMemorySize(m_PeakAllocatedSize[0].load(), 2, m_PeakAllocatedSize[0].load()),
                      " (", PeakDeviceLocalPages, (PeakDeviceLocalPages == 1 ? " page)" : " pages)"),
                      "\n                       Peak used/allocated host-visible memory size: ", 
-                     Diligent::FormatMemorySize(m_PeakUsedSize[1],      2, m_PeakAllocatedSize[1]), " / ",
-                     Diligent::FormatMemorySize(m_PeakAllocatedSize[1], 2, m_PeakAllocatedSize[1]),
+                     Diligent::FormatMemorySize(m_PeakUsedSize[1].load(),      2, m_PeakAllocatedSize[1].load()), " / ",
+                     Diligent::FormatMemorySize(m_PeakAllocatedSize[1].load(), 2, m_PeakAllocatedSize[1].load()),
                      " (", PeakHostVisisblePages, (PeakHostVisisblePages == 1 ? " page)" : " pages)")
         );
     
-    for(auto it=m_Pages.begin(); it != m_Pages.end(); ++it )
-        VERIFY(it->second.IsEmpty(), "The page contains outstanding allocations");
+    for (auto& pPool : m_Pools)
+    {
+        for (auto& it : pPool->Pages)
+            VERIFY(it.second->IsEmpty(), "The page contains outstanding allocations");
+    }
     VERIFY(m_CurrUsedSize[0] == 0 && m_CurrUsedSize[1] == 0, "Not all allocations have been released");
 }
 
@@ -0,0 +1,194 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::ShaderBundle and Diligent::ShaderBundleWriter classes
+
+#include <vector>
+#include <unordered_map>
+
+#include "../../GraphicsEngine/interface/RenderDevice.h"
+#include "../../GraphicsEngine/interface/Shader.h"
+#include "../../../Common/interface/RefCntAutoPtr.h"
+
+namespace Diligent
+{
+
+/// Shader bundle file layout. All offsets are in bytes from the beginning of the bundle.
+///
+/// | Header | Entries sorted by KeyHash | String pool | Blobs (SPIRV, serialized resources, GLSL) |
+///
+/// Every entry is a single permutation (a set of macros) of a named shader.
+/// Identical blobs are stored once and are shared by the entries.
+struct ShaderBundleHeader
+{
+    static constexpr Uint32 Magic   = 0x4C425344; // 'DSBL'
+    static constexpr Uint32 Version = 1;
+
+    Uint32 MagicNumber      = 0;
+    Uint32 FormatVersion    = 0;
+    Uint32 NumEntries       = 0;
+    Uint32 StringPoolOffset = 0;
+    Uint32 StringPoolSize   = 0;
+    Uint32 TotalSize        = 0;
+};
+
+struct ShaderBundleEntry
+{
+    static constexpr Uint32 InvalidOffset = static_cast<Uint32>(-1);
+
+    /// Hash of the name and the macros, see ShaderBundle::ComputeKeyHash()
+    Uint64 KeyHash          = 0;
+
+    /// Offsets in the string pool
+    Uint32 NameOffset       = 0;
+    Uint32 EntryPointOffset = 0;
+    /// InvalidOffset if the shader does not use combined texture samplers
+    Uint32 CombinedSamplerSuffixOffset = InvalidOffset;
+    /// Macros are stored as NumMacros pairs of null-terminated name and definition strings sorted by name
+    Uint32 MacrosOffset     = 0;
+    Uint32 NumMacros        = 0;
+
+    Uint32 ShaderType       = 0;
+    Uint32 SourceLanguage   = 0;
+
+    /// SPIRV byte code and serialized SPIRV resources (see IShaderVk::SerializeResources()).
+    /// Offsets are InvalidOffset if the bundle was built without SPIRV.
+    Uint32 SPIRVOffset      = InvalidOffset;
+    Uint32 SPIRVSize        = 0;
+    Uint32 ResourcesOffset  = InvalidOffset;
+    Uint32 ResourcesSize    = 0;
+
+    /// Null-terminated GLSL source for OpenGL and OpenGLES backends. HLSL shaders are stored converted to GLSL.
+    /// Macros are not applied and are added by the backend when the shader is created.
+    /// The offset is InvalidOffset if the bundle was built without GLSL.
+    Uint32 GLSLOffset       = InvalidOffset;
+    Uint32 GLSLSize         = 0;
+};
+static_assert(sizeof(ShaderBundleEntry) == 64, "Unexpected size of ShaderBundleEntry struct");
+
+
+/// Read-only view of a shader bundle
+
+/// The bundle data is never copied and only the header and the entry table are validated,
+/// so the bundle can be used directly from a memory-mapped file. Shaders are created from the entries
+/// without compiling or reflecting them: Vulkan shaders are created from SPIRV and
+/// serialized resources, OpenGL shaders from precompiled GLSL.
+class ShaderBundle
+{
+public:
+    static constexpr Uint32 InvalidEntry = static_cast<Uint32>(-1);
+
+    /// Creates the bundle from the memory owned by the application (e.g. memory-mapped file).
+    /// The memory must stay valid while the bundle is in use. Throws an exception if the data is not a valid bundle.
+    ShaderBundle(const void* pData, size_t DataSize);
+
+    /// Creates the bundle from the data blob and keeps strong reference to it
+    explicit ShaderBundle(IDataBlob* pDataBlob);
+
+    /// Loads the bundle from the file
+    explicit ShaderBundle(const Char* FilePath);
+
+    Uint32 GetNumEntries()const { return m_pHeader->NumEntries; }
+
+    const ShaderBundleEntry& GetEntry(Uint32 Index)const;
+    const Char*              GetEntryName(Uint32 Index)const { return GetString(GetEntry(Index).NameOffset); }
+    
+    /// Returns the macros of the entry. The array is terminated by {nullptr, nullptr}.
+    std::vector<ShaderMacro> GetEntryMacros(Uint32 Index)const;
+
+    /// Finds the permutation of the named shader. Macros must be terminated by {nullptr, nullptr}
+    /// and may be given in any order. Returns InvalidEntry if the permutation is not in the bundle.
+    Uint32 FindEntry(const Char* Name, const ShaderMacro* Macros)const;
+
+    /// Creates the shader from the bundle entry. Vulkan, OpenGL and OpenGLES devices are supported.
+    /// If the entry does not contain the data for the device type, an error is logged and *ppShader is null.
+    void CreateShader(IRenderDevice* pDevice, Uint32 Index, IShader** ppShader)const;
+
+    void CreateShader(IRenderDevice* pDevice, const Char* Name, const ShaderMacro* Macros, IShader** ppShader)const;
+
+    /// Returns the hash of the shader name and the macros sorted by name
+    static Uint64 ComputeKeyHash(const Char* Name, const ShaderMacro* Macros);
+
+private:
+    void Initialize();
+
+    const Char* GetString(Uint32 Offset)const
+    {
+        VERIFY_EXPR(Offset < m_pHeader->StringPoolSize);
+        return m_pStringPool + Offset;
+    }
+    
+    RefCntAutoPtr<IDataBlob>  m_pDataBlob;
+    const Uint8*              m_pData    = nullptr;
+    size_t                    m_DataSize = 0;
+    const ShaderBundleHeader* m_pHeader  = nullptr;
+    const ShaderBundleEntry*  m_pEntries = nullptr;
+    const Char*               m_pStringPool = nullptr;
+};
+
+
+/// Builds the shader bundle
+class ShaderBundleWriter
+{
+public:
+    struct EntryData
+    {
+        const Char*            Name                    = nullptr;
+        /// Macros terminated by {nullptr, nullptr}
+        const ShaderMacro*     Macros                  = nullptr;
+        SHADER_TYPE            ShaderType              = SHADER_TYPE_UNKNOWN;
+        SHADER_SOURCE_LANGUAGE SourceLanguage          = SHADER_SOURCE_LANGUAGE_DEFAULT;
+        const Char*            EntryPoint              = "main";
+        /// Null if combined texture samplers are not used
+        const Char*            CombinedSamplerSuffix   = nullptr;
+
+        const void*            SPIRV                   = nullptr;
+        size_t                 SPIRVSize               = 0;
+        const void*            SerializedResources     = nullptr;
+        size_t                 SerializedResourcesSize = 0;
+        const Char*            GLSLSource              = nullptr;
+        size_t                 GLSLSourceLength        = 0;
+    };
+
+    /// Adds the entry to the bundle. All data is copied.
+    /// Returns false if the entry with the same name and macros has already been added.
+    bool AddEntry(const EntryData& Data);
+
+    /// Writes the bundle to Data
+    void Write(std::vector<Uint8>& Data)const;
+
+private:
+    Uint32 AddString(const Char* Str);
+    Uint32 AddBlob(const void* pData, size_t Size, bool NullTerminate);
+
+    std::vector<ShaderBundleEntry> m_Entries;
+    std::vector<Char>              m_StringPool;
+    std::vector<Uint8>             m_Blobs;
+    // Blob hash -> offset in m_Blobs and size of every blob with this hash
+    std::unordered_multimap<Uint64, std::pair<Uint32, Uint32>> m_BlobOffsets;
+};
+
+}
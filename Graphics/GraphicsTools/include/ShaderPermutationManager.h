@@ -0,0 +1,213 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::ShaderPermutationManager class
+
+#include <vector>
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+#include "../../GraphicsEngine/interface/RenderDevice.h"
+#include "../../GraphicsEngine/interface/Shader.h"
+#include "../../../Common/interface/RefCntAutoPtr.h"
+#include "../../../Common/interface/JobSystem.h"
+
+namespace Diligent
+{
+
+/// Compiles and caches permutations of a shader template
+
+/// The permutation space is defined by a set of macro dimensions, and every permutation
+/// selects one value in every dimension. Permutations are compiled lazily, when the shader is
+/// first requested, and may be compiled asynchronously by the job system.
+///
+/// Before a permutation is compiled, the template is preprocessed with the permutation macros:
+/// includes are expanded, conditional blocks whose conditions only depend on known macros are
+/// evaluated, and the macros referenced by the remaining code are collected. Permutations that produce
+/// the same code and reference the same macro values are compiled once and share the shader.
+/// Conditions that depend on macros defined by the engine or on anything the preprocessor does not
+/// evaluate are treated conservatively: both branches are kept, so such permutations are never merged incorrectly.
+///
+/// Compiled shaders are kept in an LRU cache. When MaxCacheSize is exceeded, the least recently
+/// used shaders are released and are compiled again on the next request.
+class ShaderPermutationManager
+{
+public:
+    /// Macro dimension of the permutation space
+    struct MacroDimension
+    {
+        /// Macro name
+        const Char*        Name      = nullptr;
+
+        /// Macro values. Null value means that the macro is not defined in the permutation.
+        const Char* const* Values    = nullptr;
+
+        /// The number of values in Values array
+        Uint32             NumValues = 0;
+    };
+
+    struct CreateInfo
+    {
+        IRenderDevice*        pDevice       = nullptr;
+
+        /// Shader template. The shader must be created from Source or FilePath.
+        /// Macros of the template are defined in every permutation. All strings are copied.
+        /// ppConversionStream and ppCompilerOutput members are ignored.
+        ShaderCreateInfo      ShaderCI;
+
+        const MacroDimension* Dimensions    = nullptr;
+        Uint32                NumDimensions = 0;
+
+        /// Maximum total size, in bytes, of compiled shaders kept in the cache. 0 means no limit.
+        /// The size of a Vulkan shader is the size of its SPIRV, the size of other shaders is
+        /// estimated as the size of the preprocessed source.
+        size_t                MaxCacheSize  = 0;
+
+        /// Job system that compiles shaders requested by CompileAsync(). If null, or if the device
+        /// does not support multithreaded resource creation, CompileAsync() compiles the shader immediately.
+        JobSystem*            pJobSystem    = nullptr;
+    };
+
+    struct Stats
+    {
+        /// The total number of GetShader() calls
+        Uint64 NumRequests         = 0;
+
+        /// The number of requests served by a compiled shader from the cache
+        Uint64 NumCacheHits        = 0;
+
+        /// The number of permutations that have been preprocessed
+        Uint32 NumResolved         = 0;
+
+        /// The number of preprocessed permutations that turned out to be equivalent to another permutation
+        Uint32 NumDeduplicated     = 0;
+
+        /// The number of distinct shader variants found so far
+        Uint32 NumVariants         = 0;
+
+        /// The total number of shader compilations, including recompilations of evicted shaders
+        Uint32 NumCompilations     = 0;
+
+        /// The number of variants that failed to compile
+        Uint32 NumFailed           = 0;
+
+        /// The number of shaders released from the cache to stay within MaxCacheSize
+        Uint32 NumEvictions        = 0;
+
+        /// The number of compiled shaders currently in the cache
+        Uint32 NumCachedShaders    = 0;
+
+        /// The total size of compiled shaders currently in the cache, see CreateInfo::MaxCacheSize
+        size_t CacheSize           = 0;
+    };
+
+    /// Throws an exception if the create info is invalid
+    explicit ShaderPermutationManager(const CreateInfo& CI);
+    ~ShaderPermutationManager();
+
+    ShaderPermutationManager             (const ShaderPermutationManager&) = delete;
+    ShaderPermutationManager             (ShaderPermutationManager&&)      = delete;
+    ShaderPermutationManager& operator = (const ShaderPermutationManager&) = delete;
+    ShaderPermutationManager& operator = (ShaderPermutationManager&&)      = delete;
+
+    Uint32 GetNumPermutations()const { return static_cast<Uint32>(m_Permutations.size()); }
+
+    /// Returns the index of the permutation that selects ValueIndices[d]-th value in d-th dimension
+    Uint32 GetPermutationIndex(const Uint32* ValueIndices)const;
+
+    /// Returns the shader of the permutation, compiling it if necessary. If the permutation is being compiled
+    /// asynchronously, waits for the compilation to finish. *ppShader is null if the shader failed to compile.
+    /// The method is thread-safe.
+    ///
+    /// \note  Compilation failures are not retried: once a variant fails to compile, GetShader() returns null
+    ///        for all permutations that share the variant for the lifetime of the manager, and CompileAsync()
+    ///        does nothing for them. To recompile the shader, e.g. after its source files have been fixed,
+    ///        create a new manager.
+    void GetShader(Uint32 Permutation, IShader** ppShader);
+
+    /// Starts compiling the permutation in the job system. Does nothing if the shader is already compiled.
+    void CompileAsync(Uint32 Permutation);
+
+    /// Returns true if the shader of the permutation is compiled and is in the cache
+    bool IsShaderReady(Uint32 Permutation);
+
+    void GetStats(Stats& PermutationStats);
+
+private:
+    struct Variant;
+
+    Uint32 ResolveVariant(Uint32 Permutation);
+    void   CompileVariant(Uint32 VariantIdx, IShader** ppShader);
+    // Macros are terminated by {nullptr, nullptr}. Names of the dimension macros that are not
+    // defined in the permutation are written to pUndefinedMacros.
+    void   GetPermutationMacros(Uint32 Permutation, std::vector<ShaderMacro>& Macros, std::vector<const Char*>* pUndefinedMacros = nullptr)const;
+    const Char* CopyString(const Char* Str);
+    void   EvictShaders();
+
+    RefCntAutoPtr<IRenderDevice>                   m_pDevice;
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> m_pSourceFactory;
+    JobSystem*                                     m_pJobSystem   = nullptr;
+    const size_t                                   m_MaxCacheSize = 0;
+
+    // Shader template with all strings pointing to m_Strings
+    ShaderCreateInfo                 m_ShaderCI;
+    std::vector<ShaderMacro>         m_TemplateMacros;
+    std::list<std::string>           m_Strings;
+    std::string                      m_TemplateSource;
+
+    struct Dimension
+    {
+        std::string              Name;
+        std::vector<std::string> Values;
+        std::vector<bool>        IsDefined;
+        Uint32                   Stride = 0;
+    };
+    std::vector<Dimension> m_Dimensions;
+
+    struct Permutation
+    {
+        static constexpr Uint32 InvalidVariant = static_cast<Uint32>(-1);
+
+        Uint32                VariantIdx = InvalidVariant;
+        JobSystem::TaskHandle pTask;
+    };
+
+    std::mutex                               m_Mtx;
+    std::condition_variable                  m_CompiledCondVar;
+    std::vector<Permutation>                 m_Permutations;
+    std::vector<std::unique_ptr<Variant>>    m_Variants;
+    std::unordered_map<std::string, Uint32>  m_VariantKeys;
+    // Compiled variants, most recently used first
+    std::list<Uint32>                        m_LRU;
+    size_t                                   m_CacheSize = 0;
+    Stats                                    m_Stats;
+};
+
+}
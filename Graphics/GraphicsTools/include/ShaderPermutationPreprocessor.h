@@ -0,0 +1,148 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Declaration of Diligent::ShaderPermutationPreprocessor class
+
+#include <vector>
+#include <string>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../GraphicsEngine/interface/Shader.h"
+
+namespace Diligent
+{
+
+/// Conservative preprocessor that computes the key of the code a shader permutation compiles to
+
+/// The preprocessor does not expand macros. Instead, the key contains the remaining code and the values
+/// of all application-defined macros referenced by it. Conditions are evaluated only if they depend on
+/// macros with known values, otherwise both branches are kept and macros defined there become unknown.
+/// The class is used by ShaderPermutationManager.
+class ShaderPermutationPreprocessor
+{
+public:
+    /// Macros is terminated by a macro with null name and may be null. UndefinedMacros
+    /// are the application macros that are known not to be defined.
+    ShaderPermutationPreprocessor(IShaderSourceInputStreamFactory* pSourceFactory,
+                                  const ShaderMacro*               Macros,
+                                  const std::vector<const Char*>&  UndefinedMacros);
+
+    /// Returns false if the source cannot be analyzed
+    bool Process(const Char* Source, size_t Length, const Char* FileName);
+
+    /// Returns the key of the processed code. Sources that produce the same key compile to the same shader.
+    std::string GetKey()const;
+
+    /// Returns the size of the code that remains after preprocessing
+    size_t GetTextSize()const { return m_TextSize; }
+
+private:
+    enum class Region : Uint8
+    {
+        Active,
+        // The code may or may not be compiled depending on the values unknown to the preprocessor
+        Unknown,
+        Inactive
+    };
+
+    enum class MacroState : Uint8
+    {
+        Defined,
+        FunctionLike,
+        Undefined,
+        Unknown
+    };
+
+    struct MacroInfo
+    {
+        MacroInfo() {}
+        MacroInfo(MacroState _State, std::string _Value) :
+            State{_State},
+            Value{std::move(_Value)}
+        {}
+
+        MacroState  State = MacroState::Unknown;
+        std::string Value;
+    };
+
+    struct Conditional
+    {
+        Region Parent     = Region::Active;
+        Region Current    = Region::Active;
+        // One of the branches has been taken for certain
+        bool   Taken      = false;
+        // One of the previous conditions could not be evaluated
+        bool   HadUnknown = false;
+    };
+
+    enum class CondResult : Uint8
+    {
+        False,
+        True,
+        Unknown
+    };
+
+    using LineArray = std::vector<std::pair<const Char*, const Char*>>;
+
+    static Region CombineRegions(Region Parent, CondResult Result);
+    // Removes comments and joins continued lines
+    static std::string StripComments(const Char* Src, size_t Length);
+    static void Trim(const Char*& Begin, const Char*& End);
+    static std::string GetDirective(const Char* Begin, const Char* End, const Char** pArgsBegin = nullptr);
+    static bool IsIncludeGuard(const LineArray& Lines, size_t IfndefLine, const std::string& Name);
+
+    void AddText(const Char* Begin, const Char* End);
+    void RecordReferences(const Char* Begin, const Char* End);
+    void ReferenceMacro(const std::string& Name);
+
+    bool ProcessFile(const Char* Source, size_t Length, const std::string& FileName, Region BaseRegion);
+    bool Include(const std::string& FileName, Region CurrRegion);
+    void Define(const Char* Begin, const Char* End, Region CurrRegion);
+    void Undef(const Char* Begin, const Char* End, Region CurrRegion);
+
+    CondResult EvaluateCondition(const Char* Begin, const Char* End)const;
+    CondResult IsDefined(const std::string& Name)const;
+
+    class ExpressionParser;
+
+    IShaderSourceInputStreamFactory* const m_pSourceFactory;
+
+    std::unordered_map<std::string, MacroInfo> m_Macros;
+    // Macros given by the application. Null value means that the macro is not defined.
+    std::unordered_map<std::string, const Char*> m_GivenMacros;
+    // Given macros referenced by the code, sorted to make the key independent of the order
+    std::set<std::string> m_ReferencedMacros;
+    std::unordered_set<std::string> m_PragmaOnceFiles;
+
+    Uint64 m_Hash         = 0;
+    size_t m_TextSize     = 0;
+    Uint32 m_IncludeDepth = 0;
+};
+
+}
@@ -0,0 +1,433 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "ShaderBundle.h"
+#include "DataBlobImpl.h"
+#include "FileWrapper.h"
+#include "Align.h"
+#include "HashUtils.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// FNV-1a hash is used instead of std::hash, because the hashes are stored
+// in the bundle and must not depend on the platform or the standard library
+Uint64 HashString(const Char* Str, Uint64 Hash)
+{
+    // Hash the null terminator too, so that "ab" + "c" and "a" + "bc" are different
+    return ComputeFNV1aHash(Str, strlen(Str) + 1, Hash);
+}
+
+std::vector<const ShaderMacro*> GetSortedMacros(const ShaderMacro* Macros)
+{
+    std::vector<const ShaderMacro*> SortedMacros;
+    if (Macros != nullptr)
+    {
+        for (auto* pMacro = Macros; pMacro->Name != nullptr && pMacro->Definition != nullptr; ++pMacro)
+            SortedMacros.push_back(pMacro);
+    }
+    std::sort(SortedMacros.begin(), SortedMacros.end(),
+        [](const ShaderMacro* lhs, const ShaderMacro* rhs)
+        {
+            return strcmp(lhs->Name, rhs->Name) < 0;
+        });
+    return SortedMacros;
+}
+
+}
+
+Uint64 ShaderBundle::ComputeKeyHash(const Char* Name, const ShaderMacro* Macros)
+{
+    auto Hash = HashString(Name, FNV1aOffsetBasis);
+    for (const auto* pMacro : GetSortedMacros(Macros))
+    {
+        Hash = HashString(pMacro->Name,       Hash);
+        Hash = HashString(pMacro->Definition, Hash);
+    }
+    return Hash;
+}
+
+
+ShaderBundle::ShaderBundle(const void* pData, size_t DataSize) :
+    m_pData   (reinterpret_cast<const Uint8*>(pData)),
+    m_DataSize(DataSize)
+{
+    Initialize();
+}
+
+ShaderBundle::ShaderBundle(IDataBlob* pDataBlob) :
+    m_pDataBlob(pDataBlob)
+{
+    if (pDataBlob == nullptr)
+        LOG_ERROR_AND_THROW("Shader bundle data blob must not be null");
+    m_pData    = reinterpret_cast<const Uint8*>(pDataBlob->GetDataPtr());
+    m_DataSize = pDataBlob->GetSize();
+    Initialize();
+}
+
+ShaderBundle::ShaderBundle(const Char* FilePath)
+{
+    if (!FileSystem::FileExists(FilePath))
+        LOG_ERROR_AND_THROW("Shader bundle file '", FilePath, "' does not exist");
+
+    FileWrapper File(FilePath, EFileAccessMode::Read);
+    if (!File)
+        LOG_ERROR_AND_THROW("Failed to open shader bundle file '", FilePath, "'");
+
+    m_pDataBlob = MakeNewRCObj<DataBlobImpl>()(0);
+    File->Read(m_pDataBlob);
+    m_pData    = reinterpret_cast<const Uint8*>(m_pDataBlob->GetDataPtr());
+    m_DataSize = m_pDataBlob->GetSize();
+    Initialize();
+}
+
+void ShaderBundle::Initialize()
+{
+    if (m_pData == nullptr || m_DataSize < sizeof(ShaderBundleHeader))
+        LOG_ERROR_AND_THROW("Shader bundle data is too small");
+
+    if (reinterpret_cast<size_t>(m_pData) % alignof(ShaderBundleEntry) != 0)
+        LOG_ERROR_AND_THROW("Shader bundle data must be aligned by ", alignof(ShaderBundleEntry), " bytes");
+
+    m_pHeader = reinterpret_cast<const ShaderBundleHeader*>(m_pData);
+    if (m_pHeader->MagicNumber != ShaderBundleHeader::Magic || m_pHeader->FormatVersion != ShaderBundleHeader::Version)
+        LOG_ERROR_AND_THROW("Shader bundle has invalid or unsupported format");
+
+    if (m_pHeader->TotalSize != m_DataSize)
+        LOG_ERROR_AND_THROW("Shader bundle size (", m_DataSize, ") does not match the size in the header (", m_pHeader->TotalSize, ")");
+
+    const size_t EntriesOffset = Align(sizeof(ShaderBundleHeader), alignof(ShaderBundleEntry));
+    if (EntriesOffset + size_t{m_pHeader->NumEntries} * sizeof(ShaderBundleEntry) > m_DataSize)
+        LOG_ERROR_AND_THROW("Shader bundle entry table is out of range");
+    m_pEntries = reinterpret_cast<const ShaderBundleEntry*>(m_pData + EntriesOffset);
+
+    if (m_pHeader->StringPoolSize == 0 ||
+        size_t{m_pHeader->StringPoolOffset} + m_pHeader->StringPoolSize > m_DataSize ||
+        m_pData[m_pHeader->StringPoolOffset + m_pHeader->StringPoolSize - 1] != 0)
+        LOG_ERROR_AND_THROW("Shader bundle string pool is invalid");
+    m_pStringPool = reinterpret_cast<const Char*>(m_pData + m_pHeader->StringPoolOffset);
+
+    // Validate the entry table once, so that entries can be used without checks later
+    auto IsValidBlob = [this](Uint32 Offset, Uint32 Size)
+    {
+        return Offset == ShaderBundleEntry::InvalidOffset || size_t{Offset} + Size <= m_DataSize;
+    };
+    for (Uint32 i = 0; i < m_pHeader->NumEntries; ++i)
+    {
+        const auto& Entry = m_pEntries[i];
+        bool IsValid =
+            Entry.NameOffset       < m_pHeader->StringPoolSize &&
+            Entry.EntryPointOffset < m_pHeader->StringPoolSize &&
+            (Entry.CombinedSamplerSuffixOffset == ShaderBundleEntry::InvalidOffset || Entry.CombinedSamplerSuffixOffset < m_pHeader->StringPoolSize) &&
+            IsValidBlob(Entry.SPIRVOffset,     Entry.SPIRVSize)     &&
+            IsValidBlob(Entry.ResourcesOffset, Entry.ResourcesSize) &&
+            IsValidBlob(Entry.GLSLOffset,      Entry.GLSLSize + 1)  &&
+            (Entry.GLSLOffset == ShaderBundleEntry::InvalidOffset || m_pData[Entry.GLSLOffset + Entry.GLSLSize] == 0) &&
+            (i == 0 || m_pEntries[i - 1].KeyHash <= Entry.KeyHash);
+
+        // Every macro takes at least two bytes (two empty strings)
+        IsValid = IsValid && Entry.MacrosOffset < m_pHeader->StringPoolSize &&
+                  size_t{Entry.MacrosOffset} + size_t{Entry.NumMacros} * 2 <= m_pHeader->StringPoolSize;
+        if (IsValid)
+        {
+            auto Offset = Entry.MacrosOffset;
+            for (Uint32 m = 0; m < Entry.NumMacros * 2 && IsValid; ++m)
+            {
+                IsValid = Offset < m_pHeader->StringPoolSize;
+                if (IsValid)
+                    Offset += static_cast<Uint32>(strlen(m_pStringPool + Offset)) + 1;
+            }
+        }
+
+        if (!IsValid)
+            LOG_ERROR_AND_THROW("Shader bundle entry ", i, " is corrupted");
+    }
+}
+
+const ShaderBundleEntry& ShaderBundle::GetEntry(Uint32 Index)const
+{
+    VERIFY(Index < m_pHeader->NumEntries, "Entry index (", Index, ") is out of range. Total entry count: ", m_pHeader->NumEntries);
+    return m_pEntries[Index];
+}
+
+std::vector<ShaderMacro> ShaderBundle::GetEntryMacros(Uint32 Index)const
+{
+    const auto& Entry = GetEntry(Index);
+    std::vector<ShaderMacro> Macros;
+    Macros.reserve(Entry.NumMacros + 1);
+    const auto* Str = GetString(Entry.MacrosOffset);
+    for (Uint32 m = 0; m < Entry.NumMacros; ++m)
+    {
+        const auto* Name = Str;
+        Str += strlen(Str) + 1;
+        const auto* Definition = Str;
+        Str += strlen(Str) + 1;
+        Macros.emplace_back(Name, Definition);
+    }
+    Macros.emplace_back(nullptr, nullptr);
+    return Macros;
+}
+
+Uint32 ShaderBundle::FindEntry(const Char* Name, const ShaderMacro* Macros)const
+{
+    VERIFY_EXPR(Name != nullptr);
+    const auto KeyHash = ComputeKeyHash(Name, Macros);
+    const auto* EntriesEnd = m_pEntries + m_pHeader->NumEntries;
+    auto* pEntry = std::lower_bound(m_pEntries, EntriesEnd, KeyHash,
+        [](const ShaderBundleEntry& Entry, Uint64 Hash)
+        {
+            return Entry.KeyHash < Hash;
+        });
+
+    // Compare names and macros to resolve hash collisions
+    const auto SortedMacros = GetSortedMacros(Macros);
+    for (; pEntry != EntriesEnd && pEntry->KeyHash == KeyHash; ++pEntry)
+    {
+        if (strcmp(GetString(pEntry->NameOffset), Name) != 0 || pEntry->NumMacros != SortedMacros.size())
+            continue;
+
+        bool MacrosMatch = true;
+        const auto* Str = GetString(pEntry->MacrosOffset);
+        for (const auto* pMacro : SortedMacros)
+        {
+            const auto* EntryName = Str;
+            Str += strlen(Str) + 1;
+            const auto* EntryDefinition = Str;
+            Str += strlen(Str) + 1;
+            if (strcmp(EntryName, pMacro->Name) != 0 || strcmp(EntryDefinition, pMacro->Definition) != 0)
+            {
+                MacrosMatch = false;
+                break;
+            }
+        }
+        if (MacrosMatch)
+            return static_cast<Uint32>(pEntry - m_pEntries);
+    }
+
+    return InvalidEntry;
+}
+
+void ShaderBundle::CreateShader(IRenderDevice* pDevice, Uint32 Index, IShader** ppShader)const
+{
+    VERIFY_EXPR(pDevice != nullptr && ppShader != nullptr);
+    const auto& Entry = GetEntry(Index);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.Desc.Name       = GetString(Entry.NameOffset);
+    ShaderCI.Desc.ShaderType = static_cast<SHADER_TYPE>(Entry.ShaderType);
+    ShaderCI.EntryPoint      = GetString(Entry.EntryPointOffset);
+    ShaderCI.UseCombinedTextureSamplers = Entry.CombinedSamplerSuffixOffset != ShaderBundleEntry::InvalidOffset;
+    if (ShaderCI.UseCombinedTextureSamplers)
+        ShaderCI.CombinedSamplerSuffix = GetString(Entry.CombinedSamplerSuffixOffset);
+
+    std::vector<ShaderMacro> Macros;
+    const auto DevType = pDevice->GetDeviceCaps().DevType;
+    switch (DevType)
+    {
+        case DeviceType::Vulkan:
+            if (Entry.SPIRVOffset == ShaderBundleEntry::InvalidOffset)
+            {
+                LOG_ERROR_MESSAGE("Shader bundle entry '", ShaderCI.Desc.Name, "' does not contain SPIRV byte code");
+                return;
+            }
+            ShaderCI.SourceLanguage = static_cast<SHADER_SOURCE_LANGUAGE>(Entry.SourceLanguage);
+            ShaderCI.ByteCode       = m_pData + Entry.SPIRVOffset;
+            ShaderCI.ByteCodeSize   = Entry.SPIRVSize;
+            if (Entry.ResourcesOffset != ShaderBundleEntry::InvalidOffset)
+            {
+                ShaderCI.SerializedResources     = m_pData + Entry.ResourcesOffset;
+                ShaderCI.SerializedResourcesSize = Entry.ResourcesSize;
+            }
+        break;
+
+        case DeviceType::OpenGL:
+        case DeviceType::OpenGLES:
+            if (Entry.GLSLOffset == ShaderBundleEntry::InvalidOffset)
+            {
+                LOG_ERROR_MESSAGE("Shader bundle entry '", ShaderCI.Desc.Name, "' does not contain GLSL source");
+                return;
+            }
+            // GLSL is shared by all permutations of the shader, so the macros are added by the backend
+            Macros = GetEntryMacros(Index);
+            ShaderCI.SourceLanguage = SHADER_SOURCE_LANGUAGE_GLSL;
+            ShaderCI.Source         = reinterpret_cast<const Char*>(m_pData + Entry.GLSLOffset);
+            ShaderCI.Macros         = Macros.data();
+        break;
+
+        default:
+            LOG_ERROR_MESSAGE("Shader bundles are only supported by Vulkan, OpenGL and OpenGLES devices");
+            return;
+    }
+
+    pDevice->CreateShader(ShaderCI, ppShader);
+}
+
+void ShaderBundle::CreateShader(IRenderDevice* pDevice, const Char* Name, const ShaderMacro* Macros, IShader** ppShader)const
+{
+    auto Index = FindEntry(Name, Macros);
+    if (Index == InvalidEntry)
+    {
+        LOG_ERROR_MESSAGE("Shader '", Name, "' with the given macros is not found in the bundle");
+        return;
+    }
+    CreateShader(pDevice, Index, ppShader);
+}
+
+
+Uint32 ShaderBundleWriter::AddString(const Char* Str)
+{
+    auto Offset = static_cast<Uint32>(m_StringPool.size());
+    m_StringPool.insert(m_StringPool.end(), Str, Str + strlen(Str) + 1);
+    return Offset;
+}
+
+Uint32 ShaderBundleWriter::AddBlob(const void* pData, size_t Size, bool NullTerminate)
+{
+    if (pData == nullptr)
+        return ShaderBundleEntry::InvalidOffset;
+
+    // Null-terminated blobs use different hash seed, so that they are never shared with other blobs
+    const auto Hash = ComputeFNV1aHash(pData, Size, NullTerminate ? ~FNV1aOffsetBasis : FNV1aOffsetBasis);
+    auto Range = m_BlobOffsets.equal_range(Hash);
+    for (auto it = Range.first; it != Range.second; ++it)
+    {
+        if (it->second.second == Size && memcmp(m_Blobs.data() + it->second.first, pData, Size) == 0)
+            return it->second.first;
+    }
+
+    // Blobs are aligned, so that SPIRV words can be accessed directly in a memory-mapped bundle
+    m_Blobs.resize(Align(m_Blobs.size(), size_t{4}));
+    auto Offset = static_cast<Uint32>(m_Blobs.size());
+    const auto* pBytes = reinterpret_cast<const Uint8*>(pData);
+    m_Blobs.insert(m_Blobs.end(), pBytes, pBytes + Size);
+    if (NullTerminate)
+        m_Blobs.push_back(0);
+    m_BlobOffsets.emplace(Hash, std::make_pair(Offset, static_cast<Uint32>(Size)));
+    return Offset;
+}
+
+bool ShaderBundleWriter::AddEntry(const EntryData& Data)
+{
+    VERIFY_EXPR(Data.Name != nullptr && Data.EntryPoint != nullptr);
+    ShaderBundleEntry Entry;
+    Entry.KeyHash = ShaderBundle::ComputeKeyHash(Data.Name, Data.Macros);
+
+    // Key hash collisions are not expected, so entries are compared by name and macros only when hashes are equal
+    const auto SortedMacros = GetSortedMacros(Data.Macros);
+    for (const auto& OtherEntry : m_Entries)
+    {
+        if (OtherEntry.KeyHash != Entry.KeyHash || strcmp(m_StringPool.data() + OtherEntry.NameOffset, Data.Name) != 0 || OtherEntry.NumMacros != SortedMacros.size())
+            continue;
+
+        bool MacrosMatch = true;
+        const auto* Str = m_StringPool.data() + OtherEntry.MacrosOffset;
+        for (const auto* pMacro : SortedMacros)
+        {
+            MacrosMatch = MacrosMatch && strcmp(Str, pMacro->Name) == 0;
+            Str += strlen(Str) + 1;
+            MacrosMatch = MacrosMatch && strcmp(Str, pMacro->Definition) == 0;
+            Str += strlen(Str) + 1;
+        }
+        if (MacrosMatch)
+            return false;
+    }
+
+    Entry.NameOffset       = AddString(Data.Name);
+    Entry.EntryPointOffset = AddString(Data.EntryPoint);
+    if (Data.CombinedSamplerSuffix != nullptr)
+        Entry.CombinedSamplerSuffixOffset = AddString(Data.CombinedSamplerSuffix);
+    Entry.MacrosOffset = SortedMacros.empty() ? 0 : static_cast<Uint32>(m_StringPool.size());
+    Entry.NumMacros    = static_cast<Uint32>(SortedMacros.size());
+    for (const auto* pMacro : SortedMacros)
+    {
+        AddString(pMacro->Name);
+        AddString(pMacro->Definition);
+    }
+    Entry.ShaderType     = static_cast<Uint32>(Data.ShaderType);
+    Entry.SourceLanguage = static_cast<Uint32>(Data.SourceLanguage);
+
+    Entry.SPIRVOffset     = AddBlob(Data.SPIRV, Data.SPIRVSize, false);
+    Entry.SPIRVSize       = static_cast<Uint32>(Data.SPIRVSize);
+    Entry.ResourcesOffset = AddBlob(Data.SerializedResources, Data.SerializedResourcesSize, false);
+    Entry.ResourcesSize   = static_cast<Uint32>(Data.SerializedResourcesSize);
+    Entry.GLSLOffset      = AddBlob(Data.GLSLSource, Data.GLSLSourceLength, true);
+    Entry.GLSLSize        = static_cast<Uint32>(Data.GLSLSourceLength);
+
+    m_Entries.push_back(Entry);
+    return true;
+}
+
+void ShaderBundleWriter::Write(std::vector<Uint8>& Data)const
+{
+    std::vector<ShaderBundleEntry> Entries = m_Entries;
+    std::stable_sort(Entries.begin(), Entries.end(),
+        [](const ShaderBundleEntry& lhs, const ShaderBundleEntry& rhs)
+        {
+            return lhs.KeyHash < rhs.KeyHash;
+        });
+
+    const size_t EntriesOffset    = Align(sizeof(ShaderBundleHeader), alignof(ShaderBundleEntry));
+    const size_t StringPoolOffset = EntriesOffset + Entries.size() * sizeof(ShaderBundleEntry);
+    // The string pool always contains at least one string, so it is never empty
+    const auto   StringPool       = m_StringPool.empty() ? std::vector<Char>(1, 0) : m_StringPool;
+    const size_t BlobsOffset      = Align(StringPoolOffset + StringPool.size(), size_t{8});
+    const size_t TotalSize        = BlobsOffset + m_Blobs.size();
+    if (TotalSize > std::numeric_limits<Uint32>::max())
+        LOG_ERROR_AND_THROW("Shader bundle size (", TotalSize, ") exceeds 4GB");
+
+    for (auto& Entry : Entries)
+    {
+        for (auto* pOffset : {&Entry.SPIRVOffset, &Entry.ResourcesOffset, &Entry.GLSLOffset})
+        {
+            if (*pOffset != ShaderBundleEntry::InvalidOffset)
+                *pOffset += static_cast<Uint32>(BlobsOffset);
+        }
+    }
+
+    ShaderBundleHeader Header;
+    Header.MagicNumber      = ShaderBundleHeader::Magic;
+    Header.FormatVersion    = ShaderBundleHeader::Version;
+    Header.NumEntries       = static_cast<Uint32>(Entries.size());
+    Header.StringPoolOffset = static_cast<Uint32>(StringPoolOffset);
+    Header.StringPoolSize   = static_cast<Uint32>(StringPool.size());
+    Header.TotalSize        = static_cast<Uint32>(TotalSize);
+
+    Data.assign(TotalSize, 0);
+    memcpy(Data.data(), &Header, sizeof(Header));
+    if (!Entries.empty())
+        memcpy(Data.data() + EntriesOffset, Entries.data(), Entries.size() * sizeof(ShaderBundleEntry));
+    memcpy(Data.data() + StringPoolOffset, StringPool.data(), StringPool.size());
+    if (!m_Blobs.empty())
+        memcpy(Data.data() + BlobsOffset, m_Blobs.data(), m_Blobs.size());
+}
+
+}
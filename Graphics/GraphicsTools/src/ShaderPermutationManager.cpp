@@ -0,0 +1,404 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+
+#include <limits>
+
+#include "ShaderPermutationManager.h"
+#include "ShaderPermutationPreprocessor.h"
+#include "DataBlobImpl.h"
+#include "DebugUtilities.h"
+
+#if VULKAN_SUPPORTED
+#   include "../../GraphicsEngineVulkan/interface/ShaderVk.h"
+#endif
+
+namespace Diligent
+{
+
+struct ShaderPermutationManager::Variant
+{
+    enum class State : Uint8
+    {
+        NotCompiled,
+        Compiling,
+        Compiled,
+        Failed
+    };
+
+    explicit Variant(Uint32 _FirstPermutation, size_t _SourceSize) :
+        FirstPermutation{_FirstPermutation},
+        SourceSize      {_SourceSize      }
+    {}
+
+    // The variant is compiled with the macros of this permutation
+    const Uint32 FirstPermutation;
+    // Size of the preprocessed source, used to estimate the size of the shader
+    const size_t SourceSize;
+
+    State                       CompileState = State::NotCompiled;
+    RefCntAutoPtr<IShader>      pShader;
+    size_t                      Size = 0;
+    std::list<Uint32>::iterator LRUIt;
+};
+
+
+ShaderPermutationManager::ShaderPermutationManager(const CreateInfo& CI) :
+    m_pDevice       {CI.pDevice                            },
+    m_pSourceFactory{CI.ShaderCI.pShaderSourceStreamFactory},
+    m_pJobSystem    {CI.pJobSystem                         },
+    m_MaxCacheSize  {CI.MaxCacheSize                       }
+{
+    if (m_pDevice == nullptr)
+        LOG_ERROR_AND_THROW("Device must not be null");
+
+    const auto& TemplateCI = CI.ShaderCI;
+    if (TemplateCI.Source == nullptr && TemplateCI.FilePath == nullptr)
+        LOG_ERROR_AND_THROW("Shader template must be created from Source or FilePath");
+    if (TemplateCI.Source == nullptr && m_pSourceFactory == nullptr)
+        LOG_ERROR_AND_THROW("Shader source stream factory must be provided when the template is loaded from a file");
+
+    if (m_pJobSystem != nullptr && !m_pDevice->GetDeviceCaps().bMultithreadedResourceCreationSupported)
+    {
+        LOG_INFO_MESSAGE("The device does not support multithreaded resource creation. Shader permutations of '",
+                         (TemplateCI.Desc.Name != nullptr ? TemplateCI.Desc.Name : ""), "' will be compiled synchronously.");
+        m_pJobSystem = nullptr;
+    }
+
+    // Copy the template
+    m_ShaderCI = TemplateCI;
+    m_ShaderCI.pShaderSourceStreamFactory = m_pSourceFactory;
+    m_ShaderCI.ppConversionStream      = nullptr;
+    m_ShaderCI.ppCompilerOutput        = nullptr;
+    m_ShaderCI.ByteCode                = nullptr;
+    m_ShaderCI.ByteCodeSize            = 0;
+    m_ShaderCI.SerializedResources     = nullptr;
+    m_ShaderCI.SerializedResourcesSize = 0;
+    m_ShaderCI.FilePath                = CopyString(TemplateCI.FilePath);
+    m_ShaderCI.EntryPoint              = CopyString(TemplateCI.EntryPoint);
+    m_ShaderCI.CombinedSamplerSuffix   = CopyString(TemplateCI.CombinedSamplerSuffix);
+    m_ShaderCI.SPIRVOptimizationPasses = CopyString(TemplateCI.SPIRVOptimizationPasses);
+    m_ShaderCI.Desc.Name               = CopyString(TemplateCI.Desc.Name);
+    m_ShaderCI.Macros                  = nullptr;
+    for (auto* pMacro = TemplateCI.Macros; pMacro != nullptr && pMacro->Name != nullptr; ++pMacro)
+        m_TemplateMacros.emplace_back(CopyString(pMacro->Name), CopyString(pMacro->Definition));
+
+    if (TemplateCI.Source != nullptr)
+    {
+        m_TemplateSource  = TemplateCI.Source;
+        m_ShaderCI.Source = m_TemplateSource.c_str();
+    }
+    else
+    {
+        RefCntAutoPtr<IFileStream> pSourceStream;
+        m_pSourceFactory->CreateInputStream(TemplateCI.FilePath, &pSourceStream);
+        if (pSourceStream == nullptr)
+            LOG_ERROR_AND_THROW("Failed to open shader source file '", TemplateCI.FilePath, "'");
+
+        RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
+        pSourceStream->Read(pFileData);
+        m_TemplateSource.assign(reinterpret_cast<const Char*>(pFileData->GetDataPtr()), pFileData->GetSize());
+    }
+
+    Uint64 NumPermutations = 1;
+    m_Dimensions.resize(CI.NumDimensions);
+    for (Uint32 d = 0; d < CI.NumDimensions; ++d)
+    {
+        const auto& SrcDim = CI.Dimensions[d];
+        if (SrcDim.Name == nullptr || SrcDim.NumValues == 0)
+            LOG_ERROR_AND_THROW("Permutation dimension ", d, " must have a name and at least one value");
+
+        auto& Dim = m_Dimensions[d];
+        Dim.Name   = SrcDim.Name;
+        Dim.Stride = static_cast<Uint32>(NumPermutations);
+        for (Uint32 v = 0; v < SrcDim.NumValues; ++v)
+        {
+            Dim.Values.emplace_back(SrcDim.Values[v] != nullptr ? SrcDim.Values[v] : "");
+            Dim.IsDefined.push_back(SrcDim.Values[v] != nullptr);
+        }
+
+        NumPermutations *= SrcDim.NumValues;
+        if (NumPermutations > std::numeric_limits<Uint32>::max())
+            LOG_ERROR_AND_THROW("The number of shader permutations exceeds 2^32");
+    }
+    m_Permutations.resize(static_cast<size_t>(NumPermutations));
+}
+
+ShaderPermutationManager::~ShaderPermutationManager()
+{
+    // Tasks reference the manager, so wait until all of them finish
+    if (m_pJobSystem != nullptr)
+    {
+        for (auto& Perm : m_Permutations)
+        {
+            if (Perm.pTask)
+                m_pJobSystem->Wait(Perm.pTask);
+        }
+    }
+}
+
+const Char* ShaderPermutationManager::CopyString(const Char* Str)
+{
+    if (Str == nullptr)
+        return nullptr;
+    m_Strings.emplace_back(Str);
+    return m_Strings.back().c_str();
+}
+
+Uint32 ShaderPermutationManager::GetPermutationIndex(const Uint32* ValueIndices)const
+{
+    Uint32 Permutation = 0;
+    for (size_t d = 0; d < m_Dimensions.size(); ++d)
+    {
+        const auto& Dim = m_Dimensions[d];
+        DEV_CHECK_ERR(ValueIndices[d] < Dim.Values.size(), "Value index ", ValueIndices[d], " is out of range for dimension '", Dim.Name, "'");
+        Permutation += ValueIndices[d] * Dim.Stride;
+    }
+    return Permutation;
+}
+
+void ShaderPermutationManager::GetPermutationMacros(Uint32 Permutation, std::vector<ShaderMacro>& Macros, std::vector<const Char*>* pUndefinedMacros)const
+{
+    Macros = m_TemplateMacros;
+    for (const auto& Dim : m_Dimensions)
+    {
+        auto ValueIdx = (Permutation / Dim.Stride) % static_cast<Uint32>(Dim.Values.size());
+        if (Dim.IsDefined[ValueIdx])
+            Macros.emplace_back(Dim.Name.c_str(), Dim.Values[ValueIdx].c_str());
+        else if (pUndefinedMacros != nullptr)
+            pUndefinedMacros->push_back(Dim.Name.c_str());
+    }
+    Macros.emplace_back(nullptr, nullptr);
+}
+
+Uint32 ShaderPermutationManager::ResolveVariant(Uint32 Permutation)
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        auto VariantIdx = m_Permutations[Permutation].VariantIdx;
+        if (VariantIdx != Permutation::InvalidVariant)
+            return VariantIdx;
+    }
+
+    // Preprocessing is done without holding the lock
+    std::vector<ShaderMacro> Macros;
+    std::vector<const Char*> UndefinedMacros;
+    GetPermutationMacros(Permutation, Macros, &UndefinedMacros);
+
+    std::string Key;
+    size_t      SourceSize = 0;
+    ShaderPermutationPreprocessor Preprocessor{m_pSourceFactory, Macros.data(), UndefinedMacros};
+    if (Preprocessor.Process(m_TemplateSource.c_str(), m_TemplateSource.length(), m_ShaderCI.FilePath))
+    {
+        Key        = Preprocessor.GetKey();
+        SourceSize = Preprocessor.GetTextSize();
+    }
+    else
+    {
+        // The source cannot be analyzed, so the permutation is never merged with other permutations
+        Key        = "#" + std::to_string(Permutation);
+        SourceSize = m_TemplateSource.length();
+    }
+
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    auto& Perm = m_Permutations[Permutation];
+    if (Perm.VariantIdx != Permutation::InvalidVariant)
+        return Perm.VariantIdx; // Resolved by another thread
+
+    ++m_Stats.NumResolved;
+    auto it = m_VariantKeys.find(Key);
+    if (it != m_VariantKeys.end())
+    {
+        ++m_Stats.NumDeduplicated;
+        Perm.VariantIdx = it->second;
+    }
+    else
+    {
+        Perm.VariantIdx = static_cast<Uint32>(m_Variants.size());
+        m_Variants.emplace_back(new Variant{Permutation, SourceSize});
+        m_VariantKeys.emplace(std::move(Key), Perm.VariantIdx);
+        ++m_Stats.NumVariants;
+    }
+    return Perm.VariantIdx;
+}
+
+void ShaderPermutationManager::CompileVariant(Uint32 VariantIdx, IShader** ppShader)
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    auto& Var = *m_Variants[VariantIdx];
+    while (Var.CompileState == Variant::State::Compiling)
+        m_CompiledCondVar.wait(Lock);
+
+    if (Var.CompileState == Variant::State::Compiled)
+    {
+        m_LRU.splice(m_LRU.begin(), m_LRU, Var.LRUIt);
+        if (ppShader != nullptr)
+        {
+            ++m_Stats.NumCacheHits;
+            *ppShader = Var.pShader;
+            (*ppShader)->AddRef();
+        }
+        return;
+    }
+
+    if (Var.CompileState == Variant::State::Failed)
+        return;
+
+    Var.CompileState = Variant::State::Compiling;
+    Lock.unlock();
+
+    std::vector<ShaderMacro> Macros;
+    GetPermutationMacros(Var.FirstPermutation, Macros);
+    auto ShaderCI   = m_ShaderCI;
+    ShaderCI.Macros = Macros.data();
+    RefCntAutoPtr<IShader> pShader;
+    m_pDevice->CreateShader(ShaderCI, &pShader);
+
+    auto Size = Var.SourceSize;
+#if VULKAN_SUPPORTED
+    RefCntAutoPtr<IShaderVk> pShaderVk{pShader, IID_ShaderVk};
+    if (pShaderVk)
+        Size = pShaderVk->GetSPIRV().size() * sizeof(uint32_t);
+#endif
+
+    Lock.lock();
+    ++m_Stats.NumCompilations;
+    if (pShader)
+    {
+        Var.pShader      = std::move(pShader);
+        Var.Size         = Size;
+        Var.CompileState = Variant::State::Compiled;
+        m_LRU.push_front(VariantIdx);
+        Var.LRUIt = m_LRU.begin();
+        m_CacheSize += Size;
+        if (ppShader != nullptr)
+        {
+            *ppShader = Var.pShader;
+            (*ppShader)->AddRef();
+        }
+        EvictShaders();
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Failed to compile permutation ", Var.FirstPermutation, " of shader '", (m_ShaderCI.Desc.Name != nullptr ? m_ShaderCI.Desc.Name : ""), "'");
+        Var.CompileState = Variant::State::Failed;
+        ++m_Stats.NumFailed;
+    }
+    m_CompiledCondVar.notify_all();
+}
+
+void ShaderPermutationManager::EvictShaders()
+{
+    // The most recently used shader is never evicted
+    while (m_MaxCacheSize != 0 && m_CacheSize > m_MaxCacheSize && m_LRU.size() > 1)
+    {
+        auto& Var = *m_Variants[m_LRU.back()];
+        m_LRU.pop_back();
+        VERIFY_EXPR(m_CacheSize >= Var.Size);
+        m_CacheSize -= Var.Size;
+        Var.pShader.Release();
+        Var.Size         = 0;
+        Var.CompileState = Variant::State::NotCompiled;
+        ++m_Stats.NumEvictions;
+    }
+}
+
+void ShaderPermutationManager::GetShader(Uint32 Permutation, IShader** ppShader)
+{
+    DEV_CHECK_ERR(ppShader != nullptr && *ppShader == nullptr, "ppShader must not be null and must point to null");
+    DEV_CHECK_ERR(Permutation < m_Permutations.size(), "Permutation index ", Permutation, " is out of range");
+    if (Permutation >= m_Permutations.size())
+        return;
+
+    JobSystem::TaskHandle pTask;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        ++m_Stats.NumRequests;
+        pTask = m_Permutations[Permutation].pTask;
+    }
+    if (pTask)
+    {
+        // While waiting, the thread executes other tasks, including possibly this one
+        m_pJobSystem->Wait(pTask);
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (m_Permutations[Permutation].pTask == pTask)
+            m_Permutations[Permutation].pTask.reset();
+    }
+
+    auto VariantIdx = ResolveVariant(Permutation);
+    CompileVariant(VariantIdx, ppShader);
+}
+
+void ShaderPermutationManager::CompileAsync(Uint32 Permutation)
+{
+    DEV_CHECK_ERR(Permutation < m_Permutations.size(), "Permutation index ", Permutation, " is out of range");
+    if (Permutation >= m_Permutations.size())
+        return;
+
+    if (m_pJobSystem == nullptr)
+    {
+        CompileVariant(ResolveVariant(Permutation), nullptr);
+        return;
+    }
+
+    JobSystem::TaskHandle pTask;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        auto& Perm = m_Permutations[Permutation];
+        if (Perm.pTask && !Perm.pTask->IsComplete())
+            return;
+        if (Perm.VariantIdx != Permutation::InvalidVariant && m_Variants[Perm.VariantIdx]->CompileState != Variant::State::NotCompiled)
+            return;
+
+        pTask = m_pJobSystem->CreateTask(
+            [this, Permutation]()
+            {
+                CompileVariant(ResolveVariant(Permutation), nullptr);
+            });
+        Perm.pTask = pTask;
+    }
+    // Submit the task outside of the lock as it may be executed immediately by this thread
+    m_pJobSystem->Submit(pTask);
+}
+
+bool ShaderPermutationManager::IsShaderReady(Uint32 Permutation)
+{
+    DEV_CHECK_ERR(Permutation < m_Permutations.size(), "Permutation index ", Permutation, " is out of range");
+    if (Permutation >= m_Permutations.size())
+        return false;
+
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    auto VariantIdx = m_Permutations[Permutation].VariantIdx;
+    return VariantIdx != Permutation::InvalidVariant && m_Variants[VariantIdx]->CompileState == Variant::State::Compiled;
+}
+
+void ShaderPermutationManager::GetStats(Stats& PermutationStats)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    PermutationStats                  = m_Stats;
+    PermutationStats.NumCachedShaders = static_cast<Uint32>(m_LRU.size());
+    PermutationStats.CacheSize        = m_CacheSize;
+}
+
+}
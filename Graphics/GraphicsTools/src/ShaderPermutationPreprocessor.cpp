@@ -0,0 +1,760 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+
+#include "ShaderPermutationPreprocessor.h"
+#include "DataBlobImpl.h"
+#include "RefCntAutoPtr.h"
+#include "DebugUtilities.h"
+#include "HashUtils.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+inline bool IsIdentifierStart(Char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool IsIdentifierChar(Char c)
+{
+    return IsIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+inline bool IsSpace(Char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+} // namespace
+
+ShaderPermutationPreprocessor::ShaderPermutationPreprocessor(IShaderSourceInputStreamFactory* pSourceFactory,
+                                                             const ShaderMacro*               Macros,
+                                                             const std::vector<const Char*>&  UndefinedMacros) :
+    m_pSourceFactory{pSourceFactory},
+    m_Hash          {FNV1aOffsetBasis}
+{
+    for (auto* pMacro = Macros; pMacro != nullptr && pMacro->Name != nullptr; ++pMacro)
+    {
+        const auto* Definition = pMacro->Definition != nullptr ? pMacro->Definition : "";
+        m_GivenMacros[pMacro->Name] = Definition;
+        m_Macros[pMacro->Name]      = MacroInfo{MacroState::Defined, Definition};
+    }
+    for (auto* Name : UndefinedMacros)
+    {
+        m_GivenMacros[Name] = nullptr;
+        m_Macros[Name]      = MacroInfo{MacroState::Undefined, ""};
+    }
+}
+
+bool ShaderPermutationPreprocessor::Process(const Char* Source, size_t Length, const Char* FileName)
+{
+    return ProcessFile(Source, Length, FileName != nullptr ? FileName : "", Region::Active);
+}
+
+std::string ShaderPermutationPreprocessor::GetKey()const
+{
+    std::string Key = std::to_string(m_Hash);
+    Key += ':';
+    Key += std::to_string(m_TextSize);
+    for (const auto& Name : m_ReferencedMacros)
+    {
+        auto it = m_GivenMacros.find(Name);
+        VERIFY_EXPR(it != m_GivenMacros.end());
+        Key += '\n';
+        Key += Name;
+        if (it->second != nullptr)
+        {
+            Key += '=';
+            Key += it->second;
+        }
+    }
+    return Key;
+}
+
+ShaderPermutationPreprocessor::Region ShaderPermutationPreprocessor::CombineRegions(Region Parent, CondResult Result)
+{
+    if (Parent == Region::Inactive || Result == CondResult::False)
+        return Region::Inactive;
+    if (Parent == Region::Unknown || Result == CondResult::Unknown)
+        return Region::Unknown;
+    return Region::Active;
+}
+
+std::string ShaderPermutationPreprocessor::StripComments(const Char* Src, size_t Length)
+{
+    std::string Out;
+    Out.reserve(Length);
+    const auto* c   = Src;
+    const auto* End = Src + Length;
+    while (c < End)
+    {
+        if (*c == '\\' && c + 1 < End && (c[1] == '\n' || (c[1] == '\r' && c + 2 < End && c[2] == '\n')))
+        {
+            c += c[1] == '\n' ? 2 : 3;
+        }
+        else if (*c == '/' && c + 1 < End && c[1] == '/')
+        {
+            while (c < End && *c != '\n')
+                ++c;
+        }
+        else if (*c == '/' && c + 1 < End && c[1] == '*')
+        {
+            c += 2;
+            while (c + 1 < End && !(c[0] == '*' && c[1] == '/'))
+                ++c;
+            c = c + 1 < End ? c + 2 : End;
+            Out.push_back(' ');
+        }
+        else if (*c == '"')
+        {
+            Out.push_back(*c++);
+            while (c < End && *c != '"' && *c != '\n')
+            {
+                if (*c == '\\' && c + 1 < End)
+                    Out.push_back(*c++);
+                Out.push_back(*c++);
+            }
+            if (c < End && *c == '"')
+                Out.push_back(*c++);
+        }
+        else
+        {
+            Out.push_back(*c++);
+        }
+    }
+    return Out;
+}
+
+void ShaderPermutationPreprocessor::Trim(const Char*& Begin, const Char*& End)
+{
+    while (Begin < End && IsSpace(*Begin))
+        ++Begin;
+    while (End > Begin && IsSpace(End[-1]))
+        --End;
+}
+
+std::string ShaderPermutationPreprocessor::GetDirective(const Char* Begin, const Char* End, const Char** pArgsBegin)
+{
+    if (Begin == End || *Begin != '#')
+        return "";
+
+    const auto* c = Begin + 1;
+    while (c < End && IsSpace(*c))
+        ++c;
+    const auto* NameStart = c;
+    while (c < End && IsIdentifierChar(*c))
+        ++c;
+    if (pArgsBegin != nullptr)
+        *pArgsBegin = c;
+    return std::string{NameStart, c};
+}
+
+bool ShaderPermutationPreprocessor::IsIncludeGuard(const LineArray& Lines, size_t IfndefLine, const std::string& Name)
+{
+    // An include guard is '#ifndef X' and '#define X' with no value at the beginning of the
+    // file and the matching '#endif' at the end of it. '#ifndef X' followed by '#define X 1'
+    // in other places supplies a default value that may also be defined by the engine.
+    if (IfndefLine != 0 || Lines.size() < 3)
+        return false;
+
+    const Char* ArgsBegin = nullptr;
+    if (GetDirective(Lines[1].first, Lines[1].second, &ArgsBegin) != "define")
+        return false;
+    const Char* ArgsEnd = Lines[1].second;
+    Trim(ArgsBegin, ArgsEnd);
+    if (std::string{ArgsBegin, ArgsEnd} != Name)
+        return false;
+
+    Uint32 Depth = 0;
+    for (size_t l = IfndefLine; l < Lines.size(); ++l)
+    {
+        auto Directive = GetDirective(Lines[l].first, Lines[l].second);
+        if (Directive == "if" || Directive == "ifdef" || Directive == "ifndef")
+        {
+            ++Depth;
+        }
+        else if (Directive == "endif")
+        {
+            if (Depth == 0)
+                return false;
+            if (--Depth == 0)
+                return l + 1 == Lines.size();
+        }
+    }
+    return false;
+}
+
+void ShaderPermutationPreprocessor::AddText(const Char* Begin, const Char* End)
+{
+    static const Char NewLine = '\n';
+    m_Hash = ComputeFNV1aHash(Begin, End - Begin, m_Hash);
+    m_Hash = ComputeFNV1aHash(&NewLine, 1, m_Hash);
+    m_TextSize += (End - Begin) + 1;
+
+    RecordReferences(Begin, End);
+}
+
+void ShaderPermutationPreprocessor::RecordReferences(const Char* Begin, const Char* End)
+{
+    const auto* c = Begin;
+    while (c < End)
+    {
+        if (IsIdentifierStart(*c))
+        {
+            const auto* IdStart = c;
+            while (c < End && IsIdentifierChar(*c))
+                ++c;
+            ReferenceMacro(std::string{IdStart, c});
+        }
+        else if (*c >= '0' && *c <= '9')
+        {
+            // Skip numbers such as 0x1F or 1e5f
+            while (c < End && (IsIdentifierChar(*c) || *c == '.'))
+                ++c;
+        }
+        else
+        {
+            ++c;
+        }
+    }
+}
+
+void ShaderPermutationPreprocessor::ReferenceMacro(const std::string& Name)
+{
+    auto it = m_GivenMacros.find(Name);
+    if (it == m_GivenMacros.end())
+        return;
+    if (!m_ReferencedMacros.insert(Name).second)
+        return;
+    // The value may reference other macros
+    if (it->second != nullptr)
+        RecordReferences(it->second, it->second + strlen(it->second));
+}
+
+// Evaluates integer constant expressions of #if and #elif directives. Any identifier whose
+// value is not known makes the result unknown.
+class ShaderPermutationPreprocessor::ExpressionParser
+{
+public:
+    ExpressionParser(const ShaderPermutationPreprocessor& PP, const Char* Begin, const Char* End, Uint32 Depth) :
+        m_PP   {PP   },
+        m_Curr {Begin},
+        m_End  {End  },
+        m_Depth{Depth}
+    {}
+
+    CondResult Evaluate()
+    {
+        auto Value = ParseTernary();
+        SkipSpaces();
+        if (m_Curr != m_End)
+            m_Unknown = true;
+        if (m_Unknown)
+            return CondResult::Unknown;
+        return Value != 0 ? CondResult::True : CondResult::False;
+    }
+
+    bool IsUnknown()const { return m_Unknown; }
+
+private:
+    static constexpr Uint32 MaxDepth = 16;
+
+    void SkipSpaces()
+    {
+        while (m_Curr < m_End && IsSpace(*m_Curr))
+            ++m_Curr;
+    }
+
+    bool Accept(const Char* Op)
+    {
+        SkipSpaces();
+        auto Len = strlen(Op);
+        if (static_cast<size_t>(m_End - m_Curr) < Len || strncmp(m_Curr, Op, Len) != 0)
+            return false;
+        // Do not accept '<' in '<<', '&' in '&&', etc.
+        if (Len == 1 && m_Curr + 1 < m_End)
+        {
+            auto Next = m_Curr[1];
+            if ((Op[0] == '<' && (Next == '<' || Next == '=')) ||
+                (Op[0] == '>' && (Next == '>' || Next == '=')) ||
+                (Op[0] == '&' && Next == '&') ||
+                (Op[0] == '|' && Next == '|') ||
+                (Op[0] == '!' && Next == '='))
+                return false;
+        }
+        m_Curr += Len;
+        return true;
+    }
+
+    Int64 ParseTernary()
+    {
+        auto Cond = ParseBinary(0);
+        if (!Accept("?"))
+            return Cond;
+        auto TrueVal = ParseTernary();
+        if (!Accept(":"))
+        {
+            m_Unknown = true;
+            return 0;
+        }
+        auto FalseVal = ParseTernary();
+        return Cond != 0 ? TrueVal : FalseVal;
+    }
+
+    // Binary operators from the lowest to the highest precedence
+    Int64 ParseBinary(int Level)
+    {
+        static const Char* const Operators[][4] =
+        {
+            {"||"},
+            {"&&"},
+            {"|"},
+            {"^"},
+            {"&"},
+            {"==", "!="},
+            {"<=", ">=", "<", ">"},
+            {"<<", ">>"},
+            {"+", "-"},
+            {"*", "/", "%"}
+        };
+        constexpr int NumLevels = _countof(Operators);
+        if (Level == NumLevels)
+            return ParseUnary();
+
+        auto Lhs = ParseBinary(Level + 1);
+        for (;;)
+        {
+            const Char* Op = nullptr;
+            for (auto* Candidate : Operators[Level])
+            {
+                if (Candidate != nullptr && Accept(Candidate))
+                {
+                    Op = Candidate;
+                    break;
+                }
+            }
+            if (Op == nullptr || m_Unknown)
+                return Lhs;
+
+            auto Rhs = ParseBinary(Level + 1);
+            if      (strcmp(Op, "||") == 0) Lhs = (Lhs != 0 || Rhs != 0) ? 1 : 0;
+            else if (strcmp(Op, "&&") == 0) Lhs = (Lhs != 0 && Rhs != 0) ? 1 : 0;
+            else if (strcmp(Op, "|")  == 0) Lhs = Lhs | Rhs;
+            else if (strcmp(Op, "^")  == 0) Lhs = Lhs ^ Rhs;
+            else if (strcmp(Op, "&")  == 0) Lhs = Lhs & Rhs;
+            else if (strcmp(Op, "==") == 0) Lhs = Lhs == Rhs ? 1 : 0;
+            else if (strcmp(Op, "!=") == 0) Lhs = Lhs != Rhs ? 1 : 0;
+            else if (strcmp(Op, "<=") == 0) Lhs = Lhs <= Rhs ? 1 : 0;
+            else if (strcmp(Op, ">=") == 0) Lhs = Lhs >= Rhs ? 1 : 0;
+            else if (strcmp(Op, "<")  == 0) Lhs = Lhs <  Rhs ? 1 : 0;
+            else if (strcmp(Op, ">")  == 0) Lhs = Lhs >  Rhs ? 1 : 0;
+            else if (strcmp(Op, "<<") == 0) Lhs = (Rhs >= 0 && Rhs < 64) ? static_cast<Int64>(static_cast<Uint64>(Lhs) << Rhs) : (m_Unknown = true, 0);
+            else if (strcmp(Op, ">>") == 0) Lhs = (Rhs >= 0 && Rhs < 64) ? (Lhs >> Rhs) : (m_Unknown = true, 0);
+            else if (strcmp(Op, "+")  == 0) Lhs = static_cast<Int64>(static_cast<Uint64>(Lhs) + static_cast<Uint64>(Rhs));
+            else if (strcmp(Op, "-")  == 0) Lhs = static_cast<Int64>(static_cast<Uint64>(Lhs) - static_cast<Uint64>(Rhs));
+            else if (strcmp(Op, "*")  == 0) Lhs = static_cast<Int64>(static_cast<Uint64>(Lhs) * static_cast<Uint64>(Rhs));
+            else
+            {
+                if (Rhs == 0 || (Lhs == std::numeric_limits<Int64>::min() && Rhs == -1))
+                {
+                    m_Unknown = true;
+                    return 0;
+                }
+                Lhs = strcmp(Op, "/") == 0 ? Lhs / Rhs : Lhs % Rhs;
+            }
+        }
+    }
+
+    Int64 ParseUnary()
+    {
+        if (Accept("!"))
+            return ParseUnary() == 0 ? 1 : 0;
+        if (Accept("~"))
+            return ~ParseUnary();
+        if (Accept("-"))
+            return static_cast<Int64>(0 - static_cast<Uint64>(ParseUnary()));
+        if (Accept("+"))
+            return ParseUnary();
+        return ParsePrimary();
+    }
+
+    Int64 ParsePrimary()
+    {
+        SkipSpaces();
+        if (m_Unknown || m_Curr == m_End)
+        {
+            m_Unknown = true;
+            return 0;
+        }
+
+        if (Accept("("))
+        {
+            auto Value = ParseTernary();
+            if (!Accept(")"))
+                m_Unknown = true;
+            return Value;
+        }
+
+        if (*m_Curr >= '0' && *m_Curr <= '9')
+        {
+            Char* NumEnd = nullptr;
+            auto  Value  = strtoull(m_Curr, &NumEnd, 0);
+            m_Curr = NumEnd;
+            while (m_Curr < m_End && (*m_Curr == 'u' || *m_Curr == 'U' || *m_Curr == 'l' || *m_Curr == 'L'))
+                ++m_Curr;
+            // Floating-point numbers are not allowed in preprocessor expressions
+            if (m_Curr < m_End && (IsIdentifierChar(*m_Curr) || *m_Curr == '.'))
+                m_Unknown = true;
+            return static_cast<Int64>(Value);
+        }
+
+        if (!IsIdentifierStart(*m_Curr))
+        {
+            m_Unknown = true;
+            return 0;
+        }
+
+        const auto* IdStart = m_Curr;
+        while (m_Curr < m_End && IsIdentifierChar(*m_Curr))
+            ++m_Curr;
+        std::string Name{IdStart, m_Curr};
+
+        if (Name == "defined")
+        {
+            bool Parens = Accept("(");
+            SkipSpaces();
+            const auto* ArgStart = m_Curr;
+            while (m_Curr < m_End && IsIdentifierChar(*m_Curr))
+                ++m_Curr;
+            std::string Arg{ArgStart, m_Curr};
+            if (Arg.empty() || (Parens && !Accept(")")))
+            {
+                m_Unknown = true;
+                return 0;
+            }
+            auto Res = m_PP.IsDefined(Arg);
+            if (Res == CondResult::Unknown)
+                m_Unknown = true;
+            return Res == CondResult::True ? 1 : 0;
+        }
+
+        auto it = m_PP.m_Macros.find(Name);
+        if (it == m_PP.m_Macros.end())
+        {
+            // The macro may be defined by the engine
+            m_Unknown = true;
+            return 0;
+        }
+
+        const auto& Macro = it->second;
+        switch (Macro.State)
+        {
+            case MacroState::Undefined:
+                return 0;
+
+            case MacroState::Defined:
+            {
+                if (m_Depth >= MaxDepth)
+                {
+                    m_Unknown = true;
+                    return 0;
+                }
+                ExpressionParser ValueParser{m_PP, Macro.Value.c_str(), Macro.Value.c_str() + Macro.Value.length(), m_Depth + 1};
+                auto Value = ValueParser.ParseTernary();
+                ValueParser.SkipSpaces();
+                if (ValueParser.m_Unknown || ValueParser.m_Curr != ValueParser.m_End)
+                    m_Unknown = true;
+                return Value;
+            }
+
+            default:
+                m_Unknown = true;
+                return 0;
+        }
+    }
+
+    const ShaderPermutationPreprocessor& m_PP;
+    const Char*                    m_Curr;
+    const Char* const              m_End;
+    const Uint32                   m_Depth;
+    bool                           m_Unknown = false;
+};
+
+
+ShaderPermutationPreprocessor::CondResult ShaderPermutationPreprocessor::IsDefined(const std::string& Name)const
+{
+    auto it = m_Macros.find(Name);
+    if (it == m_Macros.end())
+        return CondResult::Unknown;
+
+    switch (it->second.State)
+    {
+        case MacroState::Defined:
+        case MacroState::FunctionLike:
+            return CondResult::True;
+
+        case MacroState::Undefined:
+            return CondResult::False;
+
+        default:
+            return CondResult::Unknown;
+    }
+}
+
+ShaderPermutationPreprocessor::CondResult ShaderPermutationPreprocessor::EvaluateCondition(const Char* Begin, const Char* End)const
+{
+    ExpressionParser Parser{*this, Begin, End, 0};
+    return Parser.Evaluate();
+}
+
+void ShaderPermutationPreprocessor::Define(const Char* Begin, const Char* End, Region CurrRegion)
+{
+    const auto* c = Begin;
+    while (c < End && IsIdentifierChar(*c))
+        ++c;
+    std::string Name{Begin, c};
+    if (Name.empty())
+        return;
+
+    auto& Macro = m_Macros[Name];
+    if (CurrRegion == Region::Unknown)
+    {
+        // The definition may or may not take effect
+        Macro = MacroInfo{MacroState::Unknown, ""};
+    }
+    else if (c < End && *c == '(')
+    {
+        Macro = MacroInfo{MacroState::FunctionLike, ""};
+    }
+    else
+    {
+        while (c < End && IsSpace(*c))
+            ++c;
+        Macro = MacroInfo{MacroState::Defined, std::string{c, End}};
+    }
+}
+
+void ShaderPermutationPreprocessor::Undef(const Char* Begin, const Char* End, Region CurrRegion)
+{
+    const auto* c = Begin;
+    while (c < End && IsIdentifierChar(*c))
+        ++c;
+    std::string Name{Begin, c};
+    if (Name.empty())
+        return;
+
+    m_Macros[Name] = MacroInfo{CurrRegion == Region::Unknown ? MacroState::Unknown : MacroState::Undefined, ""};
+}
+
+bool ShaderPermutationPreprocessor::Include(const std::string& FileName, Region CurrRegion)
+{
+    static constexpr Uint32 MaxIncludeDepth = 32;
+    if (m_pSourceFactory == nullptr || m_IncludeDepth >= MaxIncludeDepth)
+        return false;
+
+    if (m_PragmaOnceFiles.find(FileName) != m_PragmaOnceFiles.end())
+        return true;
+
+    RefCntAutoPtr<IFileStream> pStream;
+    m_pSourceFactory->CreateInputStream(FileName.c_str(), &pStream);
+    if (pStream == nullptr)
+        return false;
+
+    RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
+    pStream->Read(pFileData);
+
+    ++m_IncludeDepth;
+    auto Res = ProcessFile(reinterpret_cast<const Char*>(pFileData->GetDataPtr()), pFileData->GetSize(), FileName, CurrRegion);
+    --m_IncludeDepth;
+    return Res;
+}
+
+bool ShaderPermutationPreprocessor::ProcessFile(const Char* Source, size_t Length, const std::string& FileName, Region BaseRegion)
+{
+    auto Text = StripComments(Source, Length);
+    // Token pasting may form names of the application macros that the key would miss
+    if (Text.find("##") != std::string::npos)
+        return false;
+
+    LineArray Lines;
+    {
+        const auto* c   = Text.c_str();
+        const auto* End = c + Text.length();
+        while (c < End)
+        {
+            const auto* LineEnd = c;
+            while (LineEnd < End && *LineEnd != '\n')
+                ++LineEnd;
+            const auto* Begin = c;
+            const auto* TrimmedEnd = LineEnd;
+            Trim(Begin, TrimmedEnd);
+            if (Begin < TrimmedEnd)
+                Lines.emplace_back(Begin, TrimmedEnd);
+            c = LineEnd + 1;
+        }
+    }
+
+    std::vector<Conditional> CondStack;
+    for (size_t l = 0; l < Lines.size(); ++l)
+    {
+        const auto* Begin = Lines[l].first;
+        const auto* End   = Lines[l].second;
+        const auto CurrRegion = CondStack.empty() ? BaseRegion : CondStack.back().Current;
+
+        if (*Begin != '#')
+        {
+            if (CurrRegion != Region::Inactive)
+                AddText(Begin, End);
+            continue;
+        }
+
+        const Char* ArgsBegin = nullptr;
+        const auto  Directive = GetDirective(Begin, End, &ArgsBegin);
+        const auto* ArgsEnd   = End;
+        Trim(ArgsBegin, ArgsEnd);
+
+        if (Directive == "if" || Directive == "ifdef" || Directive == "ifndef")
+        {
+            Conditional Cond;
+            Cond.Parent = CurrRegion;
+            if (CurrRegion == Region::Inactive)
+            {
+                Cond.Current = Region::Inactive;
+                Cond.Taken   = true;
+            }
+            else
+            {
+                CondResult Res;
+                if (Directive == "if")
+                {
+                    Res = EvaluateCondition(ArgsBegin, ArgsEnd);
+                }
+                else
+                {
+                    const auto* ArgEnd = ArgsBegin;
+                    while (ArgEnd < ArgsEnd && IsIdentifierChar(*ArgEnd))
+                        ++ArgEnd;
+                    std::string Arg{ArgsBegin, ArgEnd};
+                    Res = IsDefined(Arg);
+                    if (Directive == "ifndef")
+                    {
+                        // Include guards are assumed not to be defined by the engine
+                        if (Res == CondResult::Unknown && m_Macros.find(Arg) == m_Macros.end() && IsIncludeGuard(Lines, l, Arg))
+                            Res = CondResult::False;
+                        if (Res != CondResult::Unknown)
+                            Res = Res == CondResult::True ? CondResult::False : CondResult::True;
+                    }
+                }
+                Cond.Current    = CombineRegions(CurrRegion, Res);
+                Cond.Taken      = Res == CondResult::True;
+                Cond.HadUnknown = Res == CondResult::Unknown;
+                if (Res == CondResult::Unknown)
+                    AddText(Begin, End);
+            }
+            CondStack.push_back(Cond);
+        }
+        else if (Directive == "elif" || Directive == "else")
+        {
+            if (CondStack.empty())
+                return false;
+            auto& Cond = CondStack.back();
+            if (Cond.Parent == Region::Inactive)
+                continue;
+
+            if (Cond.Taken)
+            {
+                Cond.Current = Region::Inactive;
+            }
+            else
+            {
+                auto Res = Directive == "else" ? CondResult::True : EvaluateCondition(ArgsBegin, ArgsEnd);
+                if (Res == CondResult::Unknown || Cond.HadUnknown)
+                    AddText(Begin, End);
+                if (Res == CondResult::True)
+                {
+                    // If one of the previous conditions is unknown, this branch may not be taken
+                    Cond.Current = CombineRegions(Cond.Parent, Cond.HadUnknown ? CondResult::Unknown : CondResult::True);
+                    Cond.Taken   = true;
+                }
+                else
+                {
+                    Cond.Current    = CombineRegions(Cond.Parent, Res);
+                    Cond.HadUnknown = Cond.HadUnknown || Res == CondResult::Unknown;
+                }
+            }
+        }
+        else if (Directive == "endif")
+        {
+            if (CondStack.empty())
+                return false;
+            const auto& Cond = CondStack.back();
+            if (Cond.Parent != Region::Inactive && Cond.HadUnknown)
+                AddText(Begin, End);
+            CondStack.pop_back();
+        }
+        else if (CurrRegion == Region::Inactive)
+        {
+            continue;
+        }
+        else if (Directive == "include")
+        {
+            if (ArgsEnd - ArgsBegin < 2)
+                return false;
+            auto Close = *ArgsBegin == '<' ? '>' : '"';
+            if (*ArgsBegin != '<' && *ArgsBegin != '"')
+                return false;
+            const auto* NameEnd = ArgsBegin + 1;
+            while (NameEnd < ArgsEnd && *NameEnd != Close)
+                ++NameEnd;
+            if (NameEnd == ArgsEnd)
+                return false;
+            if (!Include(std::string{ArgsBegin + 1, NameEnd}, CurrRegion))
+                return false;
+        }
+        else if (Directive == "pragma" && std::string{ArgsBegin, ArgsEnd} == "once")
+        {
+            m_PragmaOnceFiles.insert(FileName);
+        }
+        else
+        {
+            AddText(Begin, End);
+            if (Directive == "define")
+                Define(ArgsBegin, ArgsEnd, CurrRegion);
+            else if (Directive == "undef")
+                Undef(ArgsBegin, ArgsEnd, CurrRegion);
+        }
+    }
+
+    return CondStack.empty();
+}
+
+}
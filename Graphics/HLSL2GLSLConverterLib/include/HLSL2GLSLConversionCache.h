@@ -0,0 +1,149 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Defines Diligent::HLSL2GLSLConversionCache class
+
+#include <mutex>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "HLSL2GLSLConverter.h"
+
+namespace Diligent
+{
+
+/// Thread-safe bounded cache of HLSL->GLSL conversion results
+
+/// Conversion results are identified by two independent 64-bit hashes of the HLSL source with
+/// all includes expanded, combined with the conversion attributes that affect the output.
+/// Entries kept in memory also hold the expanded source, which is compared with the source
+/// being looked up, so sources with the same hashes are never confused. Least recently used
+/// entries are evicted when the total size of the cached GLSL and HLSL source exceeds the limit.
+/// If a persistent cache directory is set, converted sources are also stored in that directory
+/// and are loaded from it when they are not found in memory. Files are matched by both hashes
+/// and the source length.
+class HLSL2GLSLConversionCache
+{
+public:
+    /// Conversion cache key
+    struct Key
+    {
+        Key(const String& ExpandedSource,
+            const Char*   EntryPoint,
+            SHADER_TYPE   ShaderType,
+            bool          IncludeDefinitions,
+            const Char*   SamplerSuffix,
+            bool          UseInOutLocationQualifiers);
+
+        bool operator == (const Key& rhs)const
+        {
+            return Hash == rhs.Hash && SecondaryHash == rhs.SecondaryHash && SourceLength == rhs.SourceLength;
+        }
+
+        struct Hasher
+        {
+            size_t operator()(const Key& key)const
+            {
+                return static_cast<size_t>(key.Hash);
+            }
+        };
+
+        // The hashes are stable across sessions and platforms. FNV-1a hash is used to name
+        // files in the persistent cache directory, MurmurHash64A hash is stored in the file.
+        Uint64 Hash          = 0;
+        Uint64 SecondaryHash = 0;
+        Uint64 SourceLength  = 0;
+    };
+
+    /// Default limit of the total size of the sources kept in memory
+    static constexpr size_t DefaultMaxSize = 16 << 20;
+
+    /// \param [in] ConverterHash - hash that identifies the converter version. Files in the persistent
+    ///                             directory that were produced by a different version are ignored.
+    explicit HLSL2GLSLConversionCache(Uint64 ConverterHash);
+
+    HLSL2GLSLConversionCache             (const HLSL2GLSLConversionCache&) = delete;
+    HLSL2GLSLConversionCache             (HLSL2GLSLConversionCache&&)      = delete;
+    HLSL2GLSLConversionCache& operator = (const HLSL2GLSLConversionCache&) = delete;
+    HLSL2GLSLConversionCache& operator = (HLSL2GLSLConversionCache&&)      = delete;
+
+    /// Sets the cache parameters. Entries that exceed the new size limit are evicted.
+    /// MaxSize equal to zero disables the cache. PersistentDir can be null.
+    void SetParams(size_t MaxSize, const Char* PersistentDir);
+
+    /// Returns false if the cache is disabled
+    bool IsEnabled()const;
+
+    /// Looks up the converted source in memory and then in the persistent directory.
+    /// ExpandedSource must be the source the key was created from. Returns null if it is not found.
+    std::shared_ptr<const String> Find(const Key& key, const String& ExpandedSource);
+
+    /// Adds the converted source to the cache and stores it in the persistent directory.
+    /// ExpandedSource must be the source the key was created from.
+    void Add(const Key& key, String ExpandedSource, const String& GLSLSource);
+
+    /// Releases all entries kept in memory. Files in the persistent directory are not deleted.
+    void Clear();
+
+    void GetStats(HLSL2GLSLConversionCacheStats& Stats)const;
+
+private:
+    struct Entry
+    {
+        Key                           EntryKey;
+        // HLSL source with all includes expanded
+        String                        ExpandedSource;
+        std::shared_ptr<const String> pGLSLSource;
+
+        size_t GetSize()const { return ExpandedSource.length() + pGLSLSource->length(); }
+    };
+    using EntryListType = std::list<Entry>;
+
+    // The methods must be called while m_Mtx is locked
+    void AddEntry(const Key& key, String&& ExpandedSource, std::shared_ptr<const String> pGLSLSource);
+    void EvictEntries(size_t MaxSize);
+
+    static String GetFilePath(const String& PersistentDir, const Key& key);
+    std::shared_ptr<const String> LoadFromDisk(const String& PersistentDir, const Key& key)const;
+    void StoreToDisk(const String& PersistentDir, const Key& key, const String& GLSLSource)const;
+
+    const Uint64 m_ConverterHash;
+
+    mutable std::mutex m_Mtx;
+
+    // Most recently used entries are at the front of the list
+    EntryListType                                                m_Entries;
+    std::unordered_map<Key, EntryListType::iterator, Key::Hasher> m_EntryMap;
+
+    size_t m_MaxSize = DefaultMaxSize;
+    String m_PersistentDir;
+
+    HLSL2GLSLConversionCacheStats m_Stats;
+};
+
+}
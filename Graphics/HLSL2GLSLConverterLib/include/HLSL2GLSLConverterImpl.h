@@ -33,7 +33,8 @@
 #include "HLSLKeywords.h"
 #include "Shader.h"
 #include "HashUtils.h"
-#include "HLSLKeywords.h"
+#include "HLSLTokenStorage.h"
+#include "HLSL2GLSLConversionCache.h"
 
 namespace Diligent
 {
@@ -153,6 +154,10 @@ namespace Diligent
                           size_t                           NumSymbols, 
                           IHLSL2GLSLConversionStream**     ppStream)const;
 
+        /// Returns the cache of conversion results that is used by Convert()
+        /// when the conversion stream is not requested
+        HLSL2GLSLConversionCache& GetConversionCache()const { return m_ConversionCache; }
+
     private:
         HLSL2GLSLConverterImpl();
 
@@ -229,9 +234,9 @@ namespace Diligent
 
         struct TokenInfo
         {
-            TokenType Type;
-            String Literal;
-            String Delimiter;
+            TokenType   Type;
+            TokenString Literal;
+            TokenString Delimiter;
             bool IsBuiltInType()const
             {
                 static_assert( static_cast<int>(TokenType::kw_bool) == 1 && static_cast<int>(TokenType::kw_void) == 191, 
@@ -244,15 +249,15 @@ namespace Diligent
                                 "If you updated control flow keywords, double check that all keywords are defined between break and while");
                 return Type >= TokenType::kw_break && Type <= TokenType::kw_while;
             }
-            TokenInfo( TokenType _Type = TokenType :: Undefined,
-                        const Char* _Literal = "",
-                        const Char* _Delimiter = "" ) : 
+            TokenInfo( TokenType   _Type      = TokenType :: Undefined,
+                       TokenString _Literal   = TokenString(),
+                       TokenString _Delimiter = TokenString() ) : 
                 Type( _Type ),
                 Literal( _Literal ),
                 Delimiter(_Delimiter)
             {}
         };
-        typedef std::list<TokenInfo> TokenListType;
+        typedef std::list<TokenInfo, TokenNodeAllocator<TokenInfo>> TokenListType;
 
         
         class ConversionStream : public ObjectBase<IHLSL2GLSLConversionStream>
@@ -283,6 +288,21 @@ namespace Diligent
                              size_t                           NumSymbols,
                              bool                             bPreserveTokens);
 
+            /// Creates the stream from the source whose includes have already been expanded
+            /// by LoadSource().
+            ConversionStream(IReferenceCounters*              pRefCounters, 
+                             const HLSL2GLSLConverterImpl&    Converter, 
+                             const char*                      InputFileName,
+                             String&&                         ExpandedSource,
+                             bool                             bPreserveTokens);
+
+            /// Loads the shader source and expands all includes. Parameters have the same meaning
+            /// as the parameters of the constructor. Throws an exception in case of an error.
+            static String LoadSource(const char*                      InputFileName,
+                                     IShaderSourceInputStreamFactory* pInputStreamFactory, 
+                                     const Char*                      HLSLSource, 
+                                     size_t                           NumSymbols);
+
             String Convert(const Char* EntryPoint,
                            SHADER_TYPE ShaderType,
                            bool        IncludeDefintions,
@@ -300,12 +320,11 @@ namespace Diligent
 
             const String& GetInputFileName()const{ return m_InputFileName; }
         private:
-            void InsertIncludes(String &GLSLSource, IShaderSourceInputStreamFactory* pSourceStreamFactory);
             void Tokenize(const String &Source);
 
             typedef std::unordered_map<String, bool> SamplerHashType;
 
-            const HLSLObjectInfo *FindHLSLObject(const String& Name);
+            const HLSLObjectInfo *FindHLSLObject(const TokenString& Name);
 
             void ProcessShaderDeclaration(TokenListType::iterator EntryPointToken, SHADER_TYPE ShaderType);
 
@@ -480,6 +499,13 @@ namespace Diligent
 
             String BuildGLSLSource();
 
+            // Token list nodes and token strings. Strings of the original tokens occupy a single
+            // block at the beginning of the arena. Strings created during conversion are allocated
+            // after that block and are released when the conversion is complete.
+            TokenNodePool          m_TokenNodePool;
+            TokenStringArena       m_StringArena;
+            TokenStringArena::Mark m_TokenizedSourceMark;
+
             // Tokenized source code
             TokenListType m_Tokens;
 
@@ -514,6 +540,8 @@ namespace Diligent
         // Set of all HLSL atomic operations (InterlockedAdd, InterlockedOr, ...)
         std::unordered_set<HashMapStringKey, HashMapStringKey::Hasher> m_AtomicOperations;
 
+        mutable HLSL2GLSLConversionCache m_ConversionCache;
+
         // HLSL semantic -> glsl variable, for every shader stage and input/output type (in == 0, out == 1)
         // Example: [vertex, output] SV_Position -> gl_Position
         //          [fragment, input] SV_Position -> gl_FragCoord
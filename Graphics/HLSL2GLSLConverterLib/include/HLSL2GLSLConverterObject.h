@@ -46,6 +46,12 @@ public:
                               const Char* HLSLSource, 
                               size_t NumSymbols, 
                               IHLSL2GLSLConversionStream **ppStream)const override;
+
+    virtual void SetConversionCacheParams(size_t MaxSizeInBytes, const Char* PersistentCacheDir)override;
+
+    virtual void GetConversionCacheStats(HLSL2GLSLConversionCacheStats& Stats)const override;
+
+    virtual void ClearConversionCache()override;
 };
 
 }
@@ -0,0 +1,358 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Token storage used by the HLSL to GLSL converter
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+#include "BasicTypes.h"
+#include "DebugUtilities.h"
+
+namespace Diligent
+{
+    /// Immutable view of a token string.
+
+    /// The string is not owned by the view. It references either the memory of TokenStringArena or
+    /// a string literal, and is always null-terminated once the token is added to the token list.
+    /// Modifying a token string means creating a new string in the arena, so copies of the
+    /// token list never affect each other.
+    class TokenString
+    {
+    public:
+        TokenString()noexcept :
+            m_Str   (""),
+            m_Length(0)
+        {}
+
+        TokenString(const Char* Str, size_t Length)noexcept :
+            m_Str   (Str),
+            m_Length(Length)
+        {}
+
+        // String literals have static storage duration and can be referenced directly.
+        // Note that local character arrays must not be used to initialize token strings.
+        template<size_t N>
+        TokenString(const Char (&Literal)[N])noexcept :
+            m_Str   (Literal),
+            m_Length(N - 1)
+        {}
+
+        const Char* data()const { return m_Str; }
+
+        const Char* c_str()const
+        {
+            VERIFY(m_Str[m_Length] == 0, "Token string is not null-terminated");
+            return m_Str;
+        }
+
+        size_t length()const { return m_Length; }
+        size_t size()  const { return m_Length; }
+        bool   empty() const { return m_Length == 0; }
+
+        const Char* begin()const { return m_Str; }
+        const Char* end()  const { return m_Str + m_Length; }
+
+        Char operator[](size_t i)const
+        {
+            VERIFY_EXPR(i < m_Length);
+            return m_Str[i];
+        }
+
+        Char back()const
+        {
+            VERIFY_EXPR(m_Length > 0);
+            return m_Str[m_Length-1];
+        }
+
+        String str()const { return String(m_Str, m_Length); }
+
+        bool operator == (const TokenString& rhs)const
+        {
+            return m_Length == rhs.m_Length && memcmp(m_Str, rhs.m_Str, m_Length) == 0;
+        }
+        bool operator == (const Char* rhs)const
+        {
+            return strncmp(m_Str, rhs, m_Length) == 0 && rhs[m_Length] == 0;
+        }
+        bool operator == (const String& rhs)const
+        {
+            return m_Length == rhs.length() && memcmp(m_Str, rhs.data(), m_Length) == 0;
+        }
+
+        template<typename T>
+        bool operator != (const T& rhs)const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        const Char* m_Str;
+        size_t      m_Length;
+    };
+
+    inline std::ostream& operator << (std::ostream& os, const TokenString& Str)
+    {
+        return os.write(Str.data(), Str.length());
+    }
+
+    inline String& operator += (String& lhs, const TokenString& rhs)
+    {
+        return lhs.append(rhs.data(), rhs.length());
+    }
+
+    inline String operator + (String lhs, const TokenString& rhs)
+    {
+        return std::move(lhs += rhs);
+    }
+
+    inline String operator + (const TokenString& lhs, const Char* rhs)
+    {
+        return lhs.str().append(rhs);
+    }
+
+
+    /// Linear allocator for token strings.
+
+    /// Strings are allocated from large pages that are never reallocated, so
+    /// token strings remain valid until the arena is rewound or destroyed.
+    class TokenStringArena
+    {
+    public:
+        struct Mark
+        {
+            size_t Page   = 0;
+            size_t Offset = 0;
+        };
+
+        explicit TokenStringArena(size_t PageSize = 16 << 10) :
+            m_DefaultPageSize(PageSize)
+        {}
+
+        TokenStringArena             (const TokenStringArena&) = delete;
+        TokenStringArena& operator = (const TokenStringArena&) = delete;
+
+        /// Makes sure that the next Size bytes are allocated from the same page
+        void Reserve(size_t Size)
+        {
+            FindPage(Size);
+        }
+
+        TokenString Copy(const Char* Str, size_t Length)
+        {
+            auto* pDst = Allocate(Length + 1);
+            memcpy(pDst, Str, Length);
+            pDst[Length] = 0;
+            return TokenString(pDst, Length);
+        }
+
+        TokenString Copy(const Char* Str)
+        {
+            return Copy(Str, strlen(Str));
+        }
+
+        TokenString Copy(const String& Str)
+        {
+            return Copy(Str.c_str(), Str.length());
+        }
+
+        TokenString Concat(const TokenString& Str1, const TokenString& Str2)
+        {
+            auto* pDst = Allocate(Str1.length() + Str2.length() + 1);
+            memcpy(pDst, Str1.data(), Str1.length());
+            memcpy(pDst + Str1.length(), Str2.data(), Str2.length());
+            pDst[Str1.length() + Str2.length()] = 0;
+            return TokenString(pDst, Str1.length() + Str2.length());
+        }
+
+        Mark GetMark()const
+        {
+            Mark CurrMark;
+            CurrMark.Page   = m_CurrPage;
+            CurrMark.Offset = m_CurrOffset;
+            return CurrMark;
+        }
+
+        /// Releases all strings allocated after the mark was taken. The memory is not
+        /// returned to the system and is reused by subsequent allocations.
+        void Rewind(const Mark& ArenaMark)
+        {
+            VERIFY(ArenaMark.Page < m_CurrPage || (ArenaMark.Page == m_CurrPage && ArenaMark.Offset <= m_CurrOffset), "Invalid arena mark");
+            m_CurrPage   = ArenaMark.Page;
+            m_CurrOffset = ArenaMark.Offset;
+        }
+
+    private:
+        void FindPage(size_t Size)
+        {
+            while (m_CurrPage < m_Pages.size())
+            {
+                if (m_CurrOffset + Size <= m_Pages[m_CurrPage].Size)
+                    return;
+                ++m_CurrPage;
+                m_CurrOffset = 0;
+            }
+
+            Page NewPage;
+            NewPage.Size = std::max(Size, m_DefaultPageSize);
+            NewPage.pData.reset(new Char[NewPage.Size]);
+            m_Pages.emplace_back(std::move(NewPage));
+            m_CurrPage   = m_Pages.size() - 1;
+            m_CurrOffset = 0;
+        }
+
+        Char* Allocate(size_t Size)
+        {
+            FindPage(Size);
+            auto* pMem = m_Pages[m_CurrPage].pData.get() + m_CurrOffset;
+            m_CurrOffset += Size;
+            return pMem;
+        }
+
+        struct Page
+        {
+            std::unique_ptr<Char[]> pData;
+            size_t                  Size = 0;
+        };
+        std::vector<Page> m_Pages;
+        size_t            m_CurrPage   = 0;
+        size_t            m_CurrOffset = 0;
+        const size_t      m_DefaultPageSize;
+    };
+
+
+    /// Pool of fixed-size blocks used to allocate token list nodes.
+
+    /// The block size is defined by the first allocation. Nodes are carved from
+    /// contiguous pages, and released nodes are kept in the free list for reuse.
+    /// The pool is not thread-safe.
+    class TokenNodePool
+    {
+    public:
+        explicit TokenNodePool(size_t NumBlocksInPage = 1024) :
+            m_NumBlocksInPage(NumBlocksInPage)
+        {}
+
+        TokenNodePool             (const TokenNodePool&) = delete;
+        TokenNodePool& operator = (const TokenNodePool&) = delete;
+
+        void* Allocate(size_t Size)
+        {
+            if (m_BlockSize == 0)
+                m_BlockSize = std::max((Size + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*), sizeof(void*));
+
+            if (Size > m_BlockSize)
+                return new Uint8[Size];
+
+            if (m_pFreeList != nullptr)
+            {
+                auto* pBlock = m_pFreeList;
+                m_pFreeList = *reinterpret_cast<void**>(m_pFreeList);
+                return pBlock;
+            }
+
+            if (m_NumUnusedBlocks == 0)
+            {
+                m_Pages.emplace_back(new void*[m_BlockSize / sizeof(void*) * m_NumBlocksInPage]);
+                m_pNextUnusedBlock = reinterpret_cast<Uint8*>(m_Pages.back().get());
+                m_NumUnusedBlocks  = m_NumBlocksInPage;
+            }
+
+            auto* pBlock = m_pNextUnusedBlock;
+            m_pNextUnusedBlock += m_BlockSize;
+            --m_NumUnusedBlocks;
+            return pBlock;
+        }
+
+        void Free(void* pBlock, size_t Size)
+        {
+            if (Size > m_BlockSize)
+            {
+                delete[] reinterpret_cast<Uint8*>(pBlock);
+                return;
+            }
+            *reinterpret_cast<void**>(pBlock) = m_pFreeList;
+            m_pFreeList = pBlock;
+        }
+
+    private:
+        std::vector<std::unique_ptr<void*[]>> m_Pages;
+        const size_t m_NumBlocksInPage;
+        size_t       m_BlockSize        = 0;
+        Uint8*       m_pNextUnusedBlock = nullptr;
+        size_t       m_NumUnusedBlocks  = 0;
+        void*        m_pFreeList        = nullptr;
+    };
+
+    /// STL allocator that allocates list nodes from the TokenNodePool
+    template<typename T>
+    struct TokenNodeAllocator
+    {
+        using value_type = T;
+
+        explicit TokenNodeAllocator(TokenNodePool& Pool)noexcept :
+            m_pPool(&Pool)
+        {}
+
+        template<typename U>
+        TokenNodeAllocator(const TokenNodeAllocator<U>& other)noexcept :
+            m_pPool(other.m_pPool)
+        {}
+
+        T* allocate(size_t Count)
+        {
+            return reinterpret_cast<T*>(m_pPool->Allocate(sizeof(T) * Count));
+        }
+
+        void deallocate(T* p, size_t Count)
+        {
+            m_pPool->Free(p, sizeof(T) * Count);
+        }
+
+        template<typename U> struct rebind
+        {
+            using other = TokenNodeAllocator<U>;
+        };
+
+        TokenNodePool* m_pPool;
+    };
+
+    template<typename T, typename U>
+    bool operator == (const TokenNodeAllocator<T>& lhs, const TokenNodeAllocator<U>& rhs)
+    {
+        return lhs.m_pPool == rhs.m_pPool;
+    }
+
+    template<typename T, typename U>
+    bool operator != (const TokenNodeAllocator<T>& lhs, const TokenNodeAllocator<U>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+}
@@ -48,6 +48,30 @@ public:
 };
 
 
+/// HLSL to GLSL conversion cache statistics
+struct HLSL2GLSLConversionCacheStats
+{
+    /// The number of conversions whose result was found in the cache,
+    /// including the results loaded from the persistent cache directory
+    Uint64 NumHits      = 0;
+
+    /// The number of conversion results loaded from the persistent cache directory
+    Uint64 NumDiskHits  = 0;
+
+    /// The number of conversions whose result was not found in the cache
+    Uint64 NumMisses    = 0;
+
+    /// The number of entries evicted from the cache to stay within the size limit
+    Uint64 NumEvictions = 0;
+
+    /// The number of entries currently kept in memory
+    Uint64 NumEntries   = 0;
+
+    /// The total size of the GLSL source and of the expanded HLSL source it was
+    /// converted from currently kept in memory, in bytes
+    Uint64 CachedBytes  = 0;
+};
+
 // {44A21160-77E0-4DDC-A57E-B8B8B65B5342}
 static constexpr INTERFACE_ID IID_HLSL2GLSLConverter =
 { 0x44a21160, 0x77e0, 0x4ddc, { 0xa5, 0x7e, 0xb8, 0xb8, 0xb6, 0x5b, 0x53, 0x42 } };
@@ -61,6 +85,22 @@ public:
                               const Char*                       HLSLSource, 
                               size_t                            NumSymbols, 
                               IHLSL2GLSLConversionStream**      ppStream)const = 0;
+
+    /// Sets the parameters of the conversion cache shared by all conversions in the process
+
+    /// \param [in] MaxSizeInBytes     - Maximum total size of the GLSL source and of the expanded
+    ///                                  HLSL source it was converted from kept in memory.
+    ///                                  Least recently used results are evicted when the limit is exceeded.
+    ///                                  Zero disables the cache.
+    /// \param [in] PersistentCacheDir - Optional existing directory where converted sources are
+    ///                                  stored between sessions. Can be null.
+    virtual void SetConversionCacheParams(size_t MaxSizeInBytes, const Char* PersistentCacheDir) = 0;
+
+    /// Returns the conversion cache statistics
+    virtual void GetConversionCacheStats(HLSL2GLSLConversionCacheStats& Stats)const = 0;
+
+    /// Releases all conversion results kept in memory
+    virtual void ClearConversionCache() = 0;
 };
 
 }
@@ -0,0 +1,287 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+#include <cstdio>
+#include <cstring>
+
+#include "HLSL2GLSLConversionCache.h"
+#include "FileSystem.h"
+#include "FileWrapper.h"
+#include "DebugUtilities.h"
+#include "HashUtils.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Header of the file in the persistent cache directory
+struct CacheFileHeader
+{
+    static constexpr Uint32 MagicNumber   = 0x43473248; // 'H2GC'
+    static constexpr Uint32 FormatVersion = 2;
+
+    Uint32 Magic            = MagicNumber;
+    Uint32 Version          = FormatVersion;
+    Uint64 ConverterHash    = 0;
+    Uint64 KeyHash          = 0;
+    Uint64 KeySecondaryHash = 0;
+    Uint64 SourceLength     = 0;
+    Uint64 GLSLLength       = 0;
+};
+
+}
+
+HLSL2GLSLConversionCache::Key::Key(const String& ExpandedSource,
+                                   const Char*   EntryPoint,
+                                   SHADER_TYPE   ShaderType,
+                                   bool          IncludeDefinitions,
+                                   const Char*   SamplerSuffix,
+                                   bool          UseInOutLocationQualifiers) :
+    SourceLength(ExpandedSource.length())
+{
+    const Uint32 Flags[] = 
+    {
+        static_cast<Uint32>(ShaderType),
+        IncludeDefinitions         ? 1u : 0u,
+        UseInOutLocationQualifiers ? 1u : 0u
+    };
+
+    // Both hashes are computed from the same data
+    auto ComputeKeyHash = [&](Uint64 (*HashFunc)(const void*, size_t, Uint64), Uint64 Hash)
+    {
+        auto HashString = [&](const Char* Str, Uint64 PrevHash)
+        {
+            if (Str == nullptr)
+                Str = "";
+            // Include the terminating zero to separate adjacent strings
+            return HashFunc(Str, strlen(Str) + 1, PrevHash);
+        };
+
+        Hash = HashFunc(ExpandedSource.data(), ExpandedSource.length(), Hash);
+        Hash = HashString(EntryPoint, Hash);
+        Hash = HashString(SamplerSuffix, Hash);
+        return HashFunc(Flags, sizeof(Flags), Hash);
+    };
+    Hash          = ComputeKeyHash(ComputeFNV1aHash, FNV1aOffsetBasis);
+    SecondaryHash = ComputeKeyHash(ComputeMurmurHash64A, 0);
+}
+
+HLSL2GLSLConversionCache::HLSL2GLSLConversionCache(Uint64 ConverterHash) :
+    m_ConverterHash(ConverterHash)
+{
+}
+
+void HLSL2GLSLConversionCache::SetParams(size_t MaxSize, const Char* PersistentDir)
+{
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    m_MaxSize = MaxSize;
+    m_PersistentDir = PersistentDir != nullptr ? PersistentDir : "";
+    if (!m_PersistentDir.empty())
+    {
+        auto LastChar = m_PersistentDir.back();
+        if (LastChar != '/' && LastChar != '\\')
+            m_PersistentDir.push_back(FileSystem::GetSlashSymbol());
+    }
+    EvictEntries(m_MaxSize);
+}
+
+bool HLSL2GLSLConversionCache::IsEnabled()const
+{
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    return m_MaxSize != 0;
+}
+
+std::shared_ptr<const String> HLSL2GLSLConversionCache::Find(const Key& key, const String& ExpandedSource)
+{
+    VERIFY_EXPR(key.SourceLength == ExpandedSource.length());
+    String PersistentDir;
+    {
+        std::lock_guard<std::mutex> Lock(m_Mtx);
+        auto it = m_EntryMap.find(key);
+        // The hashes of different sources may collide, so the source itself is compared
+        if (it != m_EntryMap.end() && it->second->ExpandedSource == ExpandedSource)
+        {
+            // Move the entry to the front of the LRU list
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            ++m_Stats.NumHits;
+            return it->second->pGLSLSource;
+        }
+        PersistentDir = m_PersistentDir;
+    }
+
+    // Read the file without holding the lock
+    std::shared_ptr<const String> pGLSLSource;
+    if (!PersistentDir.empty())
+        pGLSLSource = LoadFromDisk(PersistentDir, key);
+
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    if (pGLSLSource)
+    {
+        ++m_Stats.NumHits;
+        ++m_Stats.NumDiskHits;
+        AddEntry(key, String{ExpandedSource}, pGLSLSource);
+    }
+    else
+        ++m_Stats.NumMisses;
+
+    return pGLSLSource;
+}
+
+void HLSL2GLSLConversionCache::Add(const Key& key, String ExpandedSource, const String& GLSLSource)
+{
+    VERIFY_EXPR(key.SourceLength == ExpandedSource.length());
+    String PersistentDir;
+    {
+        auto pGLSLSource = std::make_shared<const String>(GLSLSource);
+        std::lock_guard<std::mutex> Lock(m_Mtx);
+        AddEntry(key, std::move(ExpandedSource), std::move(pGLSLSource));
+        PersistentDir = m_PersistentDir;
+    }
+
+    if (!PersistentDir.empty())
+        StoreToDisk(PersistentDir, key, GLSLSource);
+}
+
+void HLSL2GLSLConversionCache::AddEntry(const Key& key, String&& ExpandedSource, std::shared_ptr<const String> pGLSLSource)
+{
+    // Entries that are larger than the whole cache are not kept
+    if (ExpandedSource.length() + pGLSLSource->length() > m_MaxSize)
+        return;
+
+    auto it = m_EntryMap.find(key);
+    if (it != m_EntryMap.end())
+    {
+        // The entry may have been added by another thread that converted the same source.
+        // If the entry belongs to a different source with the same hashes, it is replaced.
+        auto& Entry = *it->second;
+        m_Stats.CachedBytes -= Entry.GetSize();
+        Entry.ExpandedSource = std::move(ExpandedSource);
+        Entry.pGLSLSource    = std::move(pGLSLSource);
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    }
+    else
+    {
+        m_Entries.emplace_front(Entry{key, std::move(ExpandedSource), std::move(pGLSLSource)});
+        m_EntryMap.emplace(key, m_Entries.begin());
+    }
+    m_Stats.CachedBytes += m_Entries.front().GetSize();
+    m_Stats.NumEntries = m_EntryMap.size();
+
+    EvictEntries(m_MaxSize);
+}
+
+void HLSL2GLSLConversionCache::EvictEntries(size_t MaxSize)
+{
+    while (m_Stats.CachedBytes > MaxSize && !m_Entries.empty())
+    {
+        const auto& LastEntry = m_Entries.back();
+        m_Stats.CachedBytes -= LastEntry.GetSize();
+        m_EntryMap.erase(LastEntry.EntryKey);
+        m_Entries.pop_back();
+        ++m_Stats.NumEvictions;
+    }
+    m_Stats.NumEntries = m_EntryMap.size();
+}
+
+void HLSL2GLSLConversionCache::Clear()
+{
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    m_EntryMap.clear();
+    m_Entries.clear();
+    m_Stats.CachedBytes = 0;
+    m_Stats.NumEntries  = 0;
+}
+
+void HLSL2GLSLConversionCache::GetStats(HLSL2GLSLConversionCacheStats& Stats)const
+{
+    std::lock_guard<std::mutex> Lock(m_Mtx);
+    Stats = m_Stats;
+}
+
+String HLSL2GLSLConversionCache::GetFilePath(const String& PersistentDir, const Key& key)
+{
+    char FileName[32];
+    snprintf(FileName, sizeof(FileName), "%016llx.glsl", static_cast<unsigned long long>(key.Hash));
+    return PersistentDir + FileName;
+}
+
+std::shared_ptr<const String> HLSL2GLSLConversionCache::LoadFromDisk(const String& PersistentDir, const Key& key)const
+{
+    auto FilePath = GetFilePath(PersistentDir, key);
+    if (!FileSystem::FileExists(FilePath.c_str()))
+        return nullptr;
+
+    FileWrapper File(FilePath.c_str(), EFileAccessMode::Read);
+    if (!File)
+        return nullptr;
+
+    CacheFileHeader Header;
+    if (File->GetSize() < sizeof(Header) || !File->Read(&Header, sizeof(Header)))
+        return nullptr;
+
+    // The file may have been produced by another version of the converter, or may belong
+    // to a different source with the same file name hash, or may be incomplete
+    if (Header.Magic            != CacheFileHeader::MagicNumber   ||
+        Header.Version          != CacheFileHeader::FormatVersion ||
+        Header.ConverterHash    != m_ConverterHash                ||
+        Header.KeyHash          != key.Hash                       ||
+        Header.KeySecondaryHash != key.SecondaryHash              ||
+        Header.SourceLength     != key.SourceLength               ||
+        File->GetSize()         != sizeof(Header) + Header.GLSLLength)
+        return nullptr;
+
+    String GLSLSource(static_cast<size_t>(Header.GLSLLength), '\0');
+    if (!GLSLSource.empty() && !File->Read(&GLSLSource[0], GLSLSource.length()))
+        return nullptr;
+
+    return std::make_shared<const String>(std::move(GLSLSource));
+}
+
+void HLSL2GLSLConversionCache::StoreToDisk(const String& PersistentDir, const Key& key, const String& GLSLSource)const
+{
+    auto FilePath = GetFilePath(PersistentDir, key);
+    FileWrapper File(FilePath.c_str(), EFileAccessMode::Overwrite);
+    if (!File)
+    {
+        LOG_WARNING_MESSAGE("Failed to open file '", FilePath, "' to store converted GLSL source");
+        return;
+    }
+
+    CacheFileHeader Header;
+    Header.ConverterHash = m_ConverterHash;
+    Header.KeyHash          = key.Hash;
+    Header.KeySecondaryHash = key.SecondaryHash;
+    Header.SourceLength     = key.SourceLength;
+    Header.GLSLLength       = GLSLSource.length();
+    if (!File->Write(&Header, sizeof(Header)) || !File->Write(GLSLSource.data(), GLSLSource.length()))
+    {
+        // Incomplete file will be rejected when it is loaded because of the size mismatch
+        LOG_WARNING_MESSAGE("Failed to write converted GLSL source to file '", FilePath, "'");
+    }
+}
+
+}
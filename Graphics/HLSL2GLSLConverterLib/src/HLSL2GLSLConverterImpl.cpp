@@ -358,6 +358,8 @@
 #include "DataBlobImpl.h"
 #include "StringDataBlobImpl.h"
 #include "StringTools.h"
+#include "CpuProfiler.h"
+#include "HashUtils.h"
 
 namespace Diligent
 {
@@ -501,13 +503,24 @@ inline bool SkipIdentifier(const String &Input, String::const_iterator &SrcChar
 }
 
 
+// Version of the conversion logic. Must be incremented whenever the converter
+// output changes to invalidate results stored in persistent conversion caches.
+static constexpr Uint32 ConverterVersion = 1;
+
+static Uint64 ComputeConverterHash()
+{
+    auto Hash = ComputeFNV1aHash(&ConverterVersion, sizeof(ConverterVersion));
+    return ComputeFNV1aHash(g_GLSLDefinitions, strlen(g_GLSLDefinitions), Hash);
+}
+
 const HLSL2GLSLConverterImpl& HLSL2GLSLConverterImpl::GetInstance()
 {
     static HLSL2GLSLConverterImpl Converter;
     return Converter;
 }
 
-HLSL2GLSLConverterImpl::HLSL2GLSLConverterImpl()
+HLSL2GLSLConverterImpl::HLSL2GLSLConverterImpl() : 
+    m_ConversionCache(ComputeConverterHash())
 {
     // Populate HLSL keywords hash map
 #define DEFINE_KEYWORD(keyword)m_HLSLKeywords.insert( std::make_pair( #keyword, TokenInfo( TokenType::kw_##keyword, #keyword ) ) );
@@ -750,7 +763,7 @@ HLSL2GLSLConverterImpl::HLSL2GLSLConverterImpl()
 #undef DEFINE_VARIABLE
 }
 
-String CompressNewLines( const String& Str )
+String CompressNewLines( const TokenString& Str )
 {
     String Out;
     auto Char = Str.begin();
@@ -776,7 +789,7 @@ String CompressNewLines( const String& Str )
     return Out;
 }
 
-static Int32 CountNewLines(const String& Str)
+static Int32 CountNewLines(const TokenString& Str)
 {
     Int32 NumNewLines = 0;
     auto Char = Str.begin();
@@ -855,7 +868,7 @@ String HLSL2GLSLConverterImpl::ConversionStream::PrintTokenContext( IteratorType
     for( ; Token != CurrLineStartToken; ++Token )
     {
         Ctx.append( CompressNewLines(Token->Delimiter) );
-        Ctx.append(Token->Literal);
+        Ctx += Token->Literal;
     }
 
     //\n  if ( x != 0 )
@@ -887,7 +900,7 @@ String HLSL2GLSLConverterImpl::ConversionStream::PrintTokenContext( IteratorType
             Spaces.append( Token->Literal.length(), ' ' );
 
         Ctx.append( CompressNewLines(Token->Delimiter) );
-        Ctx.append(Token->Literal);
+        Ctx += Token->Literal;
         ++Token;
         
         if( Token == m_Tokens.end() )
@@ -905,7 +918,7 @@ String HLSL2GLSLConverterImpl::ConversionStream::PrintTokenContext( IteratorType
     while( Token != m_Tokens.end() && NumLinesBelow <= NumAdjacentLines )
     {
         Ctx.append( CompressNewLines(Token->Delimiter) );
-        Ctx.append(Token->Literal);
+        Ctx += Token->Literal;
         ++Token;
 
         if( Token == m_Tokens.end() )
@@ -947,63 +960,56 @@ bool SkipPrefix(const Char* RefStr, IterType &begin, IterType end)
     return false;
 }
 
-// The method scans the source code and replaces 
-// all #include directives with the contents of the 
-// file. It maintains a set of already parsed includes
-// to avoid double inclusion
-void HLSL2GLSLConverterImpl::ConversionStream::InsertIncludes( String &GLSLSource, IShaderSourceInputStreamFactory* pSourceStreamFactory )
+// The function copies the source code to the output and replaces all
+// #include directives with the contents of the file. Included text is 
+// expanded recursively when the directive is found, so that the source 
+// is processed in a single pass. The function maintains a set of already 
+// parsed includes to avoid double inclusion
+static void ExpandIncludes( const String&                    Source,
+                            IShaderSourceInputStreamFactory* pSourceStreamFactory,
+                            std::unordered_set<String>&      ProcessedIncludes,
+                            String&                          Output )
 {
-    // Put all the includes into the set to avoid multiple inclusion
-    std::unordered_set<String> ProcessedIncludes;
-
-    do
+    // Beginning of the text that has not been copied to the output yet
+    auto ChunkStart = Source.begin();
+    auto Pos = Source.begin();
+    while( Pos != Source.end() )
     {
-        // Find the first #include statement
-        auto Pos = GLSLSource.begin();
-        auto IncludeStartPos = GLSLSource.end();
-        while( Pos != GLSLSource.end() )
+        // Find the next #include statement
+        // #   include "TestFile.fxh"
+        if( SkipDelimetersAndComments( Source, Pos ) )
+            break;
+        if( *Pos != '#' )
         {
-            // #   include "TestFile.fxh"
-            if( SkipDelimetersAndComments( GLSLSource, Pos ) )
-                break;
-            if( *Pos == '#' )
-            {
-                IncludeStartPos = Pos;
-                // #   include "TestFile.fxh"
-                // ^
-                ++Pos;
-                // #   include "TestFile.fxh"
-                //  ^
-                if( SkipDelimetersAndComments( GLSLSource, Pos ) )
-                {
-                    // End of the file reached - break
-                    break;
-                }
-                // #   include "TestFile.fxh"
-                //     ^
-                if( SkipPrefix( "include", Pos, GLSLSource.end() ) )
-                {
-                    // #   include "TestFile.fxh"
-                    //            ^
-                    break;
-                }
-                else
-                {
-                    // This is not an #include directive:
-                    // #define MACRO
-                    // Continue search through the file
-                }
-            }
-            else
-                ++Pos;
+            ++Pos;
+            continue;
         }
 
-        // No more #include found
-        if( Pos == GLSLSource.end() )
+        auto IncludeStartPos = Pos;
+        // #   include "TestFile.fxh"
+        // ^
+        ++Pos;
+        // #   include "TestFile.fxh"
+        //  ^
+        if( SkipDelimetersAndComments( Source, Pos ) )
+        {
+            // End of the file reached - break
             break;
+        }
+        // #   include "TestFile.fxh"
+        //     ^
+        if( !SkipPrefix( "include", Pos, Source.end() ) )
+        {
+            // This is not an #include directive:
+            // #define MACRO
+            // Continue search through the file
+            continue;
+        }
+        // #   include "TestFile.fxh"
+        //            ^
 
         // Find open quotes
-        if( SkipDelimetersAndComments( GLSLSource, Pos ) )
+        if( SkipDelimetersAndComments( Source, Pos ) )
             LOG_ERROR_AND_THROW( "Unexpected EOF after #include directive" );
         // #   include "TestFile.fxh"
         //             ^
@@ -1014,10 +1020,10 @@ void HLSL2GLSLConverterImpl::ConversionStream::InsertIncludes( String &GLSLSourc
         //              ^
         auto IncludeNameStartPos = Pos;
         // Find closing quotes
-        while( Pos != GLSLSource.end() && *Pos != '\"' && *Pos != '>' )++Pos;
+        while( Pos != Source.end() && *Pos != '\"' && *Pos != '>' )++Pos;
         // #   include "TestFile.fxh"
         //                          ^
-        if( Pos == GLSLSource.end() )
+        if( Pos == Source.end() )
             LOG_ERROR_AND_THROW( "Missing closing quotes or \'>\' after #include directive" );
 
         // Get the name of the include file
@@ -1026,16 +1032,21 @@ void HLSL2GLSLConverterImpl::ConversionStream::InsertIncludes( String &GLSLSourc
         // #   include "TestFile.fxh"
         // ^                         ^
         // IncludeStartPos           Pos
-        GLSLSource.erase( IncludeStartPos, Pos );
+
+        // Copy the text preceding the directive to the output and skip the directive
+        Output.append( ChunkStart, IncludeStartPos );
+        ChunkStart = Pos;
 
         // Convert the name to lower case
         String IncludeFileLowercase = StrToLower(IncludeName);
         // Insert the lower-case name into the set
         auto It = ProcessedIncludes.insert( IncludeFileLowercase );
         // If the name was actually inserted, which means the include encountered for the first time,
-        // replace the text with the file content
+        // write the expanded file content to the output
         if( It.second )
         {
+            if( pSourceStreamFactory == nullptr )
+                LOG_ERROR_AND_THROW( "Input stream factory must not be null to load include file ", IncludeName );
             RefCntAutoPtr<IFileStream> pIncludeDataStream;
             pSourceStreamFactory->CreateInputStream( IncludeName.c_str(), &pIncludeDataStream );
             if( !pIncludeDataStream )
@@ -1044,54 +1055,102 @@ void HLSL2GLSLConverterImpl::ConversionStream::InsertIncludes( String &GLSLSourc
             pIncludeDataStream->Read( pIncludeData );
 
             // Get include text
-            auto IncludeText = reinterpret_cast<const Char*> (pIncludeData->GetDataPtr());
-            size_t NumSymbols = pIncludeData->GetSize();
-
-            // Insert the text into source
-            GLSLSource.insert( IncludeStartPos-GLSLSource.begin(), IncludeText, NumSymbols );
+            String IncludeText( reinterpret_cast<const Char*>(pIncludeData->GetDataPtr()), pIncludeData->GetSize() );
+            ExpandIncludes( IncludeText, pSourceStreamFactory, ProcessedIncludes, Output );
         }
-    } while( true );
+    }
+
+    Output.append( ChunkStart, Source.end() );
+}
+
+String HLSL2GLSLConverterImpl::ConversionStream::LoadSource(const char*                      InputFileName,
+                                                            IShaderSourceInputStreamFactory* pInputStreamFactory, 
+                                                            const Char*                      HLSLSource, 
+                                                            size_t                           NumSymbols)
+{
+    RefCntAutoPtr<IDataBlob> pFileData;
+    if (HLSLSource == nullptr)
+    {
+        if (InputFileName == nullptr)
+            LOG_ERROR_AND_THROW("Input file name must not be null when HLSL source code is not provided");
+
+        if (pInputStreamFactory == nullptr)
+            LOG_ERROR_AND_THROW("Input stream factory must not be null when HLSL source code is not provided");
+        
+        RefCntAutoPtr<IFileStream> pSourceStream;
+        pInputStreamFactory->CreateInputStream(InputFileName, &pSourceStream);
+        if (pSourceStream == nullptr)
+            LOG_ERROR_AND_THROW("Failed to open shader source file ", InputFileName);
+
+        pFileData = MakeNewRCObj<DataBlobImpl>()(0);
+        pSourceStream->Read(pFileData);
+        HLSLSource = reinterpret_cast<char*>(pFileData->GetDataPtr());
+        NumSymbols = pFileData->GetSize();
+    }
+
+    // Put all the includes into the set to avoid multiple inclusion
+    std::unordered_set<String> ProcessedIncludes;
+
+    String Source(HLSLSource, NumSymbols);
+    String Output;
+    Output.reserve( Source.length() );
+    ExpandIncludes( Source, pInputStreamFactory, ProcessedIncludes, Output );
+    return Output;
 }
 
 
-void ReadNumericConstant(const String &Source, String::const_iterator &Pos, String &Output)
+void SkipNumericConstant(const String &Source, String::const_iterator &Pos)
 {
-#define COPY_SYMBOL(){ Output.push_back( *(Pos++) ); if( Pos == Source.end() )return; }
+#define SKIP_SYMBOL(){ ++Pos; if( Pos == Source.end() )return; }
 
     while( Pos != Source.end() && *Pos >= '0' && *Pos <= '9' )
-        COPY_SYMBOL()
+        SKIP_SYMBOL()
 
     if( *Pos == '.' )
     {
-        COPY_SYMBOL()
-        // Copy all numbers
+        SKIP_SYMBOL()
+        // Skip all numbers
         while( Pos != Source.end() && *Pos >= '0' && *Pos <= '9' )
-            COPY_SYMBOL()
+            SKIP_SYMBOL()
     }
     
     // Scientific notation
     // e+1242, E-234
     if( *Pos == 'e' || *Pos == 'E' )
     {
-        COPY_SYMBOL()
+        SKIP_SYMBOL()
 
         if( *Pos == '+' || *Pos == '-' )
-            COPY_SYMBOL()
+            SKIP_SYMBOL()
 
         // Skip all numbers
         while( Pos != Source.end() && *Pos >= '0' && *Pos <= '9' )
-            COPY_SYMBOL()
+            SKIP_SYMBOL()
     }
 
     if( *Pos == 'f' || *Pos == 'F' )
-        COPY_SYMBOL()
-#undef COPY_SYMBOL
+        SKIP_SYMBOL()
+#undef SKIP_SYMBOL
 }
 
 
 // The function convertes source code into a token list
 void HLSL2GLSLConverterImpl::ConversionStream::Tokenize(const String &Source)
 {
+    // While the source is being tokenized, token strings reference the source directly.
+    // They are copied into the arena when all tokens are found.
+    auto SourceView = [&Source](String::const_iterator Start, String::const_iterator End)
+    {
+        return TokenString(Source.data() + (Start - Source.begin()), End - Start);
+    };
+    // Appends the next source symbol to the token literal
+    auto ExtendLiteral = [&Source](TokenInfo& Token, String::const_iterator& Pos)
+    {
+        VERIFY(Token.Literal.end() == Source.data() + (Pos - Source.begin()), "Token literal must end at the current source position");
+        Token.Literal = TokenString(Token.Literal.data(), Token.Literal.length() + 1);
+        ++Pos;
+    };
+
 #define CHECK_END(...) \
 do{                                     \
     if( SrcPos == Source.end() )        \
@@ -1123,9 +1182,7 @@ do{                                     \
         SkipDelimetersAndComments( Source, SrcPos );
         if( DelimStart != SrcPos )
         {
-            auto DelimSize = SrcPos - DelimStart;
-            NewToken.Delimiter.reserve(DelimSize);
-            NewToken.Delimiter.append(DelimStart, SrcPos);
+            NewToken.Delimiter = SourceView(DelimStart, SrcPos);
         }
         if( SrcPos == Source.end() )
             break;
@@ -1140,19 +1197,18 @@ do{                                     \
                 SkipDelimetersAndComments( Source, SrcPos );
                 CHECK_END( "Missing preprocessor directive" );
                 SkipIdentifier( Source, SrcPos );
-                auto DirectiveSize = SrcPos - DirectiveStart;
-                NewToken.Literal.reserve(DirectiveSize);
-                NewToken.Literal.append(DirectiveStart, SrcPos);
+                NewToken.Literal = SourceView(DirectiveStart, SrcPos);
             }
             break;
 
             case ';':
                 NewToken.Type = TokenType::Semicolon;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case '=':
-                if( m_Tokens.size() > 0 && NewToken.Delimiter == "" )
+                if( m_Tokens.size() > 0 && NewToken.Delimiter.empty() )
                 { 
                     auto &LastToken = m_Tokens.back();
                     // +=, -=, *=, /=, %=, <<=, >>=, &=, |=, ^=
@@ -1168,7 +1224,7 @@ do{                                     \
                         LastToken.Literal == "^")
                     {
                         LastToken.Type = TokenType::Assignment;
-                        LastToken.Literal.push_back( *(SrcPos++) );
+                        ExtendLiteral( LastToken, SrcPos );
                         continue;
                     }
                     else if( LastToken.Literal == "<" || 
@@ -1177,38 +1233,40 @@ do{                                     \
                              LastToken.Literal == "!" )
                     {
                         LastToken.Type = TokenType::ComparisonOp;
-                        LastToken.Literal.push_back( *(SrcPos++) );
+                        ExtendLiteral( LastToken, SrcPos );
                         continue;
                     }
                 }
                 
                 NewToken.Type = TokenType::Assignment;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case '|':
             case '&':
-                if( m_Tokens.size() > 0 && NewToken.Delimiter == "" && 
+                if( m_Tokens.size() > 0 && NewToken.Delimiter.empty() && 
                     m_Tokens.back().Literal.length() == 1 && m_Tokens.back().Literal[0] == *SrcPos )
                 {
                     m_Tokens.back().Type = TokenType::BooleanOp;
-                    m_Tokens.back().Literal.push_back( *(SrcPos++) );
+                    ExtendLiteral( m_Tokens.back(), SrcPos );
                     continue;
                 }
                 else
                 {
                     NewToken.Type = TokenType::BitwiseOp;
-                    NewToken.Literal.push_back( *(SrcPos++) );
+                    NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                    ++SrcPos;
                 }
             break;
 
             case '<':
             case '>':
-                if( m_Tokens.size() > 0 && NewToken.Delimiter == "" && 
+                if( m_Tokens.size() > 0 && NewToken.Delimiter.empty() && 
                     m_Tokens.back().Literal.length() == 1 && m_Tokens.back().Literal[0] == *SrcPos )
                 {
                     m_Tokens.back().Type = TokenType::BitwiseOp;
-                    m_Tokens.back().Literal.push_back( *(SrcPos++) );
+                    ExtendLiteral( m_Tokens.back(), SrcPos );
                     continue;
                 }
                 else
@@ -1217,48 +1275,54 @@ do{                                     \
                     // and template arguments like in Texture2D<float> at this
                     // point. This will be clarified when textures are processed.
                     NewToken.Type = TokenType::ComparisonOp;
-                    NewToken.Literal.push_back( *(SrcPos++) );
+                    NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                    ++SrcPos;
                 }
             break;
 
             case '+':
             case '-':
-                if( m_Tokens.size() > 0 && NewToken.Delimiter == "" && 
+                if( m_Tokens.size() > 0 && NewToken.Delimiter.empty() && 
                     m_Tokens.back().Literal.length() == 1 && m_Tokens.back().Literal[0] == *SrcPos )
                 {
                     m_Tokens.back().Type = TokenType::IncDecOp;
-                    m_Tokens.back().Literal.push_back( *(SrcPos++) );
+                    ExtendLiteral( m_Tokens.back(), SrcPos );
                     continue;
                 }
                 else
                 {
                     // We do not currently distinguish between math operator a + b,
                     // unary operator -a and numerical constant -1:
-                    NewToken.Literal.push_back( *(SrcPos++) );
+                    NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                    ++SrcPos;
                 }
             break;
             
             case '~':
             case '^':
                 NewToken.Type = TokenType::BitwiseOp;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case '*':
             case '/':
             case '%':
                 NewToken.Type = TokenType::MathOp;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case '!':
                 NewToken.Type = TokenType::BooleanOp;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case ',':
                 NewToken.Type = TokenType::Comma;
-                NewToken.Literal.push_back( *(SrcPos++) );
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                ++SrcPos;
             break;
 
             case '"':
@@ -1268,8 +1332,12 @@ do{                                     \
                 ++SrcPos;
                 //[domain("quad")]
                 //         ^
-                while( SrcPos != Source.end() && *SrcPos != '"')
-                    NewToken.Literal.push_back(*(SrcPos++));
+                {
+                    auto StringStart = SrcPos;
+                    while( SrcPos != Source.end() && *SrcPos != '"')
+                        ++SrcPos;
+                    NewToken.Literal = SourceView( StringStart, SrcPos );
+                }
                 //[domain("quad")]
                 //             ^
                 if(SrcPos != Source.end())
@@ -1281,7 +1349,8 @@ do{                                     \
 #define BRACKET_CASE(Symbol, TokenType, Action)\
             case Symbol:                                    \
                 NewToken.Type = TokenType;                  \
-                NewToken.Literal.push_back( *(SrcPos++) );  \
+                NewToken.Literal = SourceView( SrcPos, SrcPos + 1 ); \
+                ++SrcPos;                                   \
                 Action;                                     \
             break;
             BRACKET_CASE( '(', TokenType::OpenBracket,    ++OpenBracketCount );
@@ -1299,19 +1368,9 @@ do{                                     \
                 SkipIdentifier( Source, SrcPos );
                 if( IdentifierStartPos != SrcPos )
                 {
-                    auto IDSize = SrcPos - IdentifierStartPos;
-                    NewToken.Literal.reserve( IDSize );
-                    NewToken.Literal.append( IdentifierStartPos, SrcPos );
-                    auto KeywordIt = m_Converter.m_HLSLKeywords.find(NewToken.Literal.c_str());
-                    if( KeywordIt != m_Converter.m_HLSLKeywords.end() )
-                    {
-                        NewToken.Type = KeywordIt->second.Type;
-                        VERIFY( NewToken.Literal == KeywordIt->second.Literal, "Inconsistent literal" );
-                    }
-                    else
-                    {
-                        NewToken.Type = TokenType::Identifier;
-                    }
+                    NewToken.Literal = SourceView( IdentifierStartPos, SrcPos );
+                    // Keywords are identified when token strings are copied into the arena
+                    NewToken.Type = TokenType::Identifier;
                 }
 
                 if( NewToken.Type == TokenType::Undefined )
@@ -1324,14 +1383,17 @@ do{                                     \
                     }
                     if( bIsNumericalCostant )
                     {
-                        ReadNumericConstant(Source, SrcPos, NewToken.Literal);
+                        auto NumberStartPos = SrcPos;
+                        SkipNumericConstant(Source, SrcPos);
+                        NewToken.Literal = SourceView( NumberStartPos, SrcPos );
                         NewToken.Type = TokenType::NumericConstant;
                     }
                 }
 
                 if( NewToken.Type == TokenType::Undefined )
                 {
-                    NewToken.Literal.push_back( *(SrcPos++) );
+                    NewToken.Literal = SourceView( SrcPos, SrcPos + 1 );
+                    ++SrcPos;
                 }
                 // Operators
                 // https://msdn.microsoft.com/en-us/library/windows/desktop/bb509631(v=vs.85).aspx
@@ -1341,6 +1403,30 @@ do{                                     \
         
         m_Tokens.push_back( NewToken );
     }
+
+    // Copy all token strings into a single block of the arena
+    size_t TotalSize = 0;
+    for( const auto& Token : m_Tokens )
+        TotalSize += Token.Delimiter.length() + Token.Literal.length() + 2;
+    m_StringArena.Reserve(TotalSize);
+    for( auto& Token : m_Tokens )
+    {
+        if( !Token.Delimiter.empty() )
+            Token.Delimiter = m_StringArena.Copy( Token.Delimiter.data(), Token.Delimiter.length() );
+        if( !Token.Literal.empty() )
+            Token.Literal = m_StringArena.Copy( Token.Literal.data(), Token.Literal.length() );
+
+        if( Token.Type == TokenType::Identifier )
+        {
+            auto KeywordIt = m_Converter.m_HLSLKeywords.find(Token.Literal.c_str());
+            if( KeywordIt != m_Converter.m_HLSLKeywords.end() )
+            {
+                Token.Type = KeywordIt->second.Type;
+                VERIFY( Token.Literal == KeywordIt->second.Literal, "Inconsistent literal" );
+            }
+        }
+    }
+    m_TokenizedSourceMark = m_StringArena.GetMark();
 #undef CHECK_END
 }
 
@@ -1432,7 +1518,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessStructuredBuffer(TokenList
     {
         std::stringstream ss;
         ss << "layout(std140, binding=" << ShaderStorageBlockBinding << ") buffer";
-        Token->Literal = ss.str();
+        Token->Literal = m_StringArena.Copy(ss.str());
         ++ShaderStorageBlockBinding;
     }
     else
@@ -1472,7 +1558,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessStructuredBuffer(TokenList
     if(Token->Delimiter.empty())
         Token->Delimiter=" ";
 
-    m_Tokens.insert(OpenBraceToken, TokenInfo(TokenType::Identifier, Token->Literal.c_str(), " "));
+    m_Tokens.insert(OpenBraceToken, TokenInfo(TokenType::Identifier, Token->Literal, " "));
     //          OpenBraceToken
     //              V
     // buffer g_Data{DataType g_Data;
@@ -1493,9 +1579,12 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessStructuredBuffer(TokenList
     //                                 ^
     ++Token;
     String NameRedefine("#define ");
-    NameRedefine += GlobalVarNameToken->Literal + ' ' + GlobalVarNameToken->Literal + "_data\r\n";
-    m_Tokens.insert(Token, TokenInfo(TokenType::TextBlock, NameRedefine.c_str(), "\r\n"));
-    GlobalVarNameToken->Literal.append("_data");
+    NameRedefine += GlobalVarNameToken->Literal;
+    NameRedefine += ' ';
+    NameRedefine += GlobalVarNameToken->Literal;
+    NameRedefine += "_data\r\n";
+    m_Tokens.insert(Token, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(NameRedefine), "\r\n"));
+    GlobalVarNameToken->Literal = m_StringArena.Concat(GlobalVarNameToken->Literal, "_data");
     // buffer g_Data{DataType g_Data_data[]};
     // #define g_Data g_Data_data
     //                           ^
@@ -1616,7 +1705,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ParseSamplers( TokenListType::ite
                 const auto &SamplerName = Token->Literal;
 
                 // Add sampler state into the hash map
-                SamplersHash.insert( std::make_pair( SamplerName, bIsComparison ) );
+                SamplersHash.insert( std::make_pair( SamplerName.str(), bIsComparison ) );
 
                 ++Token;
                 // SamplerState LinearClamp ;
@@ -1842,13 +1931,13 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessTextureDeclaration(TokenLi
         {
             // RWTexture2D<float /* format = r32f */ >
             //                                       ^
-            ParseImageFormat( Token->Delimiter, ImgFormat );
+            ParseImageFormat( Token->Delimiter.str(), ImgFormat );
             if( ImgFormat.length() == 0 )
             {
                 // RWTexture2D</* format = r32f */ float >
                 //                                 ^
                 //                            TexFmtToken
-                ParseImageFormat( TexFmtToken->Delimiter, ImgFormat );
+                ParseImageFormat( TexFmtToken->Delimiter.str(), ImgFormat );
             }
 
             if( ImgFormat.length() != 0 )
@@ -1950,23 +2039,24 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessTextureDeclaration(TokenLi
         // |
         // Texture2D TexName ;
         //           ^
-        TexDeclToken->Literal = "";
+        String TexDecl;
         if( IsGlobalScope )
         {
             // Use layout qualifier for global variables only, not for function arguments
-            TexDeclToken->Literal.append( LayoutQualifier );
+            TexDecl.append( LayoutQualifier );
             // Samplers and images in global scope must be declared uniform.
             // Function arguments must not be declared uniform
-            TexDeclToken->Literal.append( "uniform " );
+            TexDecl.append( "uniform " );
             // From GLES 3.1 spec:
             //    Except for image variables qualified with the format qualifiers r32f, r32i, and r32ui,
             //    image variables must specify either memory qualifier readonly or the memory qualifier writeonly.
             // So on GLES we have to assume that an image is a writeonly variable
             if(IsRWTexture && ImgFormat != "r32f" && ImgFormat != "r32i" && ImgFormat != "r32ui")
-                TexDeclToken->Literal.append( "IMAGE_WRITEONLY " ); // defined as 'writeonly' on GLES and as '' on desktop in GLSLDefinitions.h
+                TexDecl.append( "IMAGE_WRITEONLY " ); // defined as 'writeonly' on GLES and as '' on desktop in GLSLDefinitions.h
         }
-        TexDeclToken->Literal.append( CompleteGLSLSampler );
-        Objects.m.insert( std::make_pair( HashMapStringKey(TextureName), HLSLObjectInfo(CompleteGLSLSampler, NumComponents) ) );
+        TexDecl.append( CompleteGLSLSampler );
+        TexDeclToken->Literal = m_StringArena.Copy( TexDecl );
+        Objects.m.insert( std::make_pair( HashMapStringKey(TextureName.c_str(), true), HLSLObjectInfo(CompleteGLSLSampler, NumComponents) ) );
 
         // In global sceop, multiple variables can be declared in the same statement
         if( IsGlobalScope )
@@ -2014,7 +2104,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessTextureDeclaration(TokenLi
 
 
 // Finds an HLSL object with the given name in object stack
-const HLSL2GLSLConverterImpl::HLSLObjectInfo *HLSL2GLSLConverterImpl::ConversionStream::FindHLSLObject( const String &Name )
+const HLSL2GLSLConverterImpl::HLSLObjectInfo *HLSL2GLSLConverterImpl::ConversionStream::FindHLSLObject( const TokenString &Name )
 {
     for( auto ScopeIt = m_Objects.rbegin(); ScopeIt != m_Objects.rend(); ++ScopeIt )
     {
@@ -2139,7 +2229,7 @@ bool HLSL2GLSLConverterImpl::ConversionStream::ProcessObjectMethod(TokenListType
     // ^    
     // IdentifierToken
 
-    m_Tokens.insert( IdentifierToken, TokenInfo( TokenType::Identifier, StubIt->second.Name.c_str(), IdentifierToken->Delimiter.c_str()) );
+    m_Tokens.insert( IdentifierToken, TokenInfo( TokenType::Identifier, m_StringArena.Copy(StubIt->second.Name), IdentifierToken->Delimiter) );
     IdentifierToken->Delimiter = " ";
     // FunctionStub TestTextArr[2], TestTextArr_sampler, ... 
     //              ^    
@@ -2169,8 +2259,9 @@ bool HLSL2GLSLConverterImpl::ConversionStream::ProcessObjectMethod(TokenListType
         //                                                            ^    
         //                                                     ArgsListEndToken
 
-        auto SwizzleToken = m_Tokens.insert( ArgsListEndToken, TokenInfo(TokenType::TextBlock, StubIt->second.Swizzle.c_str(), "") );
-        SwizzleToken->Literal.push_back( static_cast<Char>('0' + pObjectInfo->NumComponents) );
+        auto Swizzle = StubIt->second.Swizzle;
+        Swizzle.push_back( static_cast<Char>('0' + pObjectInfo->NumComponents) );
+        m_Tokens.insert( ArgsListEndToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(Swizzle), "") );
         // FunctionStub( TestTextArr[2], TestTextArr_sampler, ...    )_SWIZZLE4;
         //                                                                     ^    
         //                                                            ArgsListEndToken
@@ -2292,7 +2383,7 @@ bool HLSL2GLSLConverterImpl::ConversionStream::ProcessRWTextureStore( TokenListT
     // ^                                             ^
     // Token                                    SemicolonToken
 
-    m_Tokens.insert( Token, TokenInfo(TokenType::Identifier, "imageStore", Token->Delimiter.c_str()) );
+    m_Tokens.insert( Token, TokenInfo(TokenType::Identifier, "imageStore", Token->Delimiter) );
     m_Tokens.insert( Token, TokenInfo(TokenType::OpenBracket, "(", "" ) );
     Token->Delimiter = " ";
     // imageStore( RWTex[Location.x] = float4(0.0, 0.0, 0.0, 1.0);
@@ -2468,7 +2559,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessAtomics(const TokenListTyp
                 // InterlockedAdd(Tex2D,GTid.xy, 1, iOldVal);
                 //                     ^
 
-                OperationToken->Literal = StubIt->second.Name;
+                OperationToken->Literal = m_StringArena.Copy(StubIt->second.Name);
                 // InterlockedAddImage_3(Tex2D,GTid.xy, 1, iOldVal);
             }
             else
@@ -2477,7 +2568,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessAtomics(const TokenListTyp
                 //                ^
                 auto StubIt = m_Converter.m_GLSLStubs.find( FunctionStubHashKey("shared_var", OperationToken->Literal.c_str(), NumArguments) );
                 VERIFY_PARSER_STATE(OperationToken, StubIt != m_Converter.m_GLSLStubs.end(), "Unable to find function stub for funciton ", OperationToken->Literal, " with ", NumArguments, " arguments"  );
-                OperationToken->Literal = StubIt->second.Name;
+                OperationToken->Literal = m_StringArena.Copy(StubIt->second.Name);
                 // InterlockedAddSharedVar_3(g_i4SharedArray[GTid.x].x, 1, iOldVal);
             }
             Token = ArgsListEndToken;
@@ -2494,14 +2585,14 @@ void HLSL2GLSLConverterImpl::ConversionStream::ParseShaderParameter(TokenListTyp
     VERIFY_PARSER_STATE( Token, Token->IsBuiltInType() || Token->Type == TokenType::Identifier, 
                             "Missing argument type" );
     auto TypeToken = Token;
-    ParamInfo.Type = Token->Literal;
+    ParamInfo.Type = Token->Literal.str();
 
     ++Token;
     //          out float4 Color : SV_Target,
     //                     ^
     VERIFY_PARSER_STATE( Token, Token != m_Tokens.end(), "Unexpected EOF while parsing argument list" );
     VERIFY_PARSER_STATE( Token, Token->Type == TokenType::Identifier, "Missing argument name after ", ParamInfo.Type );
-    ParamInfo.Name = Token->Literal;
+    ParamInfo.Name = Token->Literal.str();
 
     ++Token;
     VERIFY_PARSER_STATE( Token, Token != m_Tokens.end(), "Unexpected EOF" );
@@ -2513,8 +2604,8 @@ void HLSL2GLSLConverterImpl::ConversionStream::ParseShaderParameter(TokenListTyp
         ProcessScope(Token, m_Tokens.end(), TokenType::OpenStaple, TokenType::ClosingStaple, 
             [&](TokenListType::iterator &tkn, int)
             {
-                ParamInfo.ArraySize.append(tkn->Delimiter);
-                ParamInfo.ArraySize.append(tkn->Literal);
+                ParamInfo.ArraySize += tkn->Delimiter;
+                ParamInfo.ArraySize += tkn->Literal;
                 ++tkn;
             }
         );
@@ -2542,7 +2633,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ParseShaderParameter(TokenListTyp
             VERIFY_PARSER_STATE( Token, Token != m_Tokens.end(), "Unexpected end of file while looking for semantic for argument \"", ParamInfo.Name, '\"' );
             VERIFY_PARSER_STATE( Token, Token->Type == TokenType::Identifier, "Missing semantic for argument \"", ParamInfo.Name, '\"' );
             // Transform to lower case -  semantics are case-insensitive
-            ParamInfo.Semantic = StrToLower(Token->Literal);
+            ParamInfo.Semantic = StrToLower(Token->Literal.str());
             
             ++Token;
             //          out float4 Color : SV_Target,
@@ -2606,8 +2697,8 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessFunctionParameters( TokenL
     if (!bIsVoid)
     {
         ShaderParameterInfo RetParam;
-        RetParam.Type = TypeToken->Literal;
-        RetParam.Name = FuncNameToken->Literal;
+        RetParam.Type = TypeToken->Literal.str();
+        RetParam.Name = FuncNameToken->Literal.str();
         RetParam.storageQualifier = ShaderParameterInfo::StorageQualifier::Ret;
         Params.push_back(RetParam);
     }
@@ -2781,7 +2872,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessFunctionParameters( TokenL
                     //                                   ^
                     VERIFY_PARSER_STATE( TmpToken, TmpToken != m_Tokens.end() && TmpToken->Type == TokenType::NumericConstant, "Numeric constant expected" );
                                 
-                    ParamInfo.ArraySize = TmpToken->Literal;
+                    ParamInfo.ArraySize = TmpToken->Literal.str();
                     auto NumCtrlPointsToken = TmpToken;
                     ++TmpToken;
                     VERIFY_PARSER_STATE( TmpToken, TmpToken != m_Tokens.end() && TmpToken->Literal == ">", "Angle bracket expected" );
@@ -2831,7 +2922,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessFunctionParameters( TokenL
             VERIFY_PARSER_STATE( SemanticToken, SemanticToken != m_Tokens.end(), "Unexpected EOF" );
             VERIFY_PARSER_STATE( SemanticToken, SemanticToken->Type == TokenType::Identifier, "Exepcted semantic for the return argument ");
             // Transform to lower case -  semantics are case-insensitive
-            RetParam.Semantic = StrToLower(SemanticToken->Literal);
+            RetParam.Semantic = StrToLower(SemanticToken->Literal.str());
             ++SemanticToken;
             // float4 TestPS  ( in VSOutput In ) : SV_Target
             // {
@@ -3438,7 +3529,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessHullShaderConstantFunction
                 Argument.push_back('[');
                 Argument.append(TopLevelParam.ArraySize);
                 Argument.push_back(']');
-                m_Tokens.insert(ArgsListEndToken, TokenInfo(TokenType::TextBlock, Argument.c_str()));
+                m_Tokens.insert(ArgsListEndToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(Argument)));
             }
             else
             {
@@ -3477,7 +3568,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessHullShaderConstantFunction
         }
     }
     ReturnHandlerSS << "return;}\n";
-    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, ReturnHandlerSS.str().c_str(), TypeToken->Delimiter.c_str()));
+    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(ReturnHandlerSS.str()), TypeToken->Delimiter));
     TypeToken->Delimiter = "\n";
 
     String Prologue = PrologueSS.str();
@@ -3495,7 +3586,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessHullShaderConstantFunction
     VERIFY_PARSER_STATE(FirstStatementToken, FirstStatementToken != m_Tokens.end(), "Unexpected end of file while looking for the body of \"", EntryPoint, "\"." );
     
     // Insert prologue before the first token
-    m_Tokens.insert(FirstStatementToken, TokenInfo(TokenType::TextBlock, Prologue.c_str(), "\n"));
+    m_Tokens.insert(FirstStatementToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(Prologue), "\n"));
 
     ProcessReturnStatements( Token, bIsVoid, EntryPoint, ReturnMacroName );
 }
@@ -3527,8 +3618,8 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessShaderAttributes(TokenList
         VERIFY_PARSER_STATE( TmpToken, TmpToken != m_Tokens.end() && TmpToken->Type == TokenType::Identifier, "Identifier expected");
         // [domain("quad")]
         //  ^
-        auto &Attrib = TmpToken->Literal;
-        StrToLowerInPlace(Attrib);
+        auto Attrib = StrToLower(TmpToken->Literal.str());
+        TmpToken->Literal = m_StringArena.Copy(Attrib);
 
         ++TmpToken;
         VERIFY_PARSER_STATE( TmpToken, TmpToken != m_Tokens.end() && TmpToken->Type == TokenType::OpenBracket, "\'(\' expected");
@@ -3536,8 +3627,8 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessShaderAttributes(TokenList
         ProcessScope(TmpToken, m_Tokens.end(), TokenType::OpenBracket, TokenType::ClosingBracket, 
             [&](TokenListType::iterator &tkn, int)
             {
-               AttribValue.append(tkn->Delimiter);
-               AttribValue.append(tkn->Literal);
+               AttribValue += tkn->Delimiter;
+               AttribValue += tkn->Literal;
                ++tkn;
             }
         );
@@ -3841,7 +3932,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessDomainShaderArguments( Tok
     // ^
     
     std::unordered_map<HashMapStringKey, String, HashMapStringKey::Hasher> Attributes;
-    ParseAttributesInComment(TypeToken->Delimiter, Attributes);
+    ParseAttributesInComment(TypeToken->Delimiter.str(), Attributes);
     ProcessShaderAttributes(Token, Attributes);
 
     stringstream GlobalsSS;
@@ -4000,7 +4091,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessReturnStatements( TokenLis
                 //if( x < 0.5 ) return float4(0.0, 0.0, 0.0, 1.0);
                 //              ^
                 Token->Type = TokenType::Identifier;
-                Token->Literal = MacroName;
+                Token->Literal = m_StringArena.Copy(MacroName);
                 //if( x < 0.5 ) _RETURN_ float4(0.0, 0.0, 0.0, 1.0);
                 //              ^
 
@@ -4058,7 +4149,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessReturnStatements( TokenLis
     if(IsVoid)
     {
         // Insert return handler before the closing brace
-        m_Tokens.insert(Token, TokenInfo(TokenType::TextBlock, MacroName, Token->Delimiter.c_str()));
+        m_Tokens.insert(Token, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(MacroName), Token->Delimiter));
         Token->Delimiter = "\n";
         // void main ()
         // {
@@ -4096,14 +4187,14 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessGSOutStreamOperations( Tok
             VERIFY_PARSER_STATE( Token, Token != m_Tokens.end(), "Unexpected EOF");
             VERIFY_PARSER_STATE( Token, Token->Literal == ".", "\'.\' expected");
             Token->Literal = "_";
-            Token->Delimiter.clear();
+            Token->Delimiter = TokenString();
             // triStream_Append( Out );
             //          ^
             ++Token;
             // triStream_Append( Out );
             //           ^
             VERIFY_PARSER_STATE( Token, Token != m_Tokens.end(), "Unexpected EOF");
-            Token->Delimiter.clear();
+            Token->Delimiter = TokenString();
             ++Token;
         }
         else
@@ -4176,8 +4267,8 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessShaderDeclaration( TokenLi
     // TypeToken
 
     // Insert global variables & return handler before the function
-    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, GlobalVariables.c_str(), TypeToken->Delimiter.c_str()));
-    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, ReturnHandlerSS.str().c_str(), "\n"));
+    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(GlobalVariables), TypeToken->Delimiter));
+    m_Tokens.insert(TypeToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(ReturnHandlerSS.str()), "\n"));
     TypeToken->Delimiter = "\n";
     auto BodyStartToken = ArgsListEndToken;
     while( BodyStartToken != m_Tokens.end() && BodyStartToken->Type != TokenType::OpenBrace )
@@ -4195,7 +4286,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::ProcessShaderDeclaration( TokenLi
     VERIFY_PARSER_STATE(FirstStatementToken, FirstStatementToken != m_Tokens.end(), "Unexpected end of file while looking for the body of shader entry point \"", EntryPoint, "\"." );
     
     // Insert prologue before the first token
-    m_Tokens.insert(FirstStatementToken, TokenInfo(TokenType::TextBlock, Prologue.c_str(), "\n"));
+    m_Tokens.insert(FirstStatementToken, TokenInfo(TokenType::TextBlock, m_StringArena.Copy(Prologue), "\n"));
 
     auto BodyEndToken = BodyStartToken;
     if (ShaderType == SHADER_TYPE_VERTEX || ShaderType == SHADER_TYPE_HULL || ShaderType == SHADER_TYPE_DOMAIN || ShaderType == SHADER_TYPE_PIXEL)
@@ -4375,7 +4466,7 @@ void HLSL2GLSLConverterImpl::ConversionStream::RemoveSpecialShaderAttributes()
                 // void CS(uint3 ThreadId  : SV_DispatchThreadID)
                 // ^
                 if( Token != m_Tokens.end() )
-                    Token->Delimiter = OpenStaple->Delimiter + Token->Delimiter;
+                    Token->Delimiter = m_StringArena.Concat(OpenStaple->Delimiter, Token->Delimiter);
                 m_Tokens.erase( OpenStaple, Token );
             }
             else
@@ -4389,8 +4480,8 @@ String HLSL2GLSLConverterImpl::ConversionStream::BuildGLSLSource()
     String Output;
     for( const auto& Token : m_Tokens )
     {
-        Output.append( Token.Delimiter );
-        Output.append( Token.Literal );
+        Output += Token.Delimiter;
+        Output += Token.Literal;
     }
     return Output;
 }
@@ -4402,47 +4493,50 @@ HLSL2GLSLConverterImpl::ConversionStream::ConversionStream(IReferenceCounters*
                                                            const Char*                      HLSLSource, 
                                                            size_t                           NumSymbols,
                                                            bool                             bPreserveTokens) :
+    ConversionStream(pRefCounters, Converter, InputFileName, LoadSource(InputFileName, pInputStreamFactory, HLSLSource, NumSymbols), bPreserveTokens)
+{
+}
+
+HLSL2GLSLConverterImpl::ConversionStream::ConversionStream(IReferenceCounters*              pRefCounters, 
+                                                           const HLSL2GLSLConverterImpl&    Converter, 
+                                                           const char*                      InputFileName,
+                                                           String&&                         ExpandedSource,
+                                                           bool                             bPreserveTokens) :
     TBase                         (pRefCounters),
+    m_Tokens                      (TokenNodeAllocator<TokenInfo>(m_TokenNodePool)),
     m_bPreserveTokens             (bPreserveTokens),
     m_Converter                   (Converter),
     m_InputFileName               (InputFileName != nullptr ? InputFileName : "<Unknown>")
 {
-    RefCntAutoPtr<IDataBlob> pFileData;
-    if (HLSLSource == nullptr)
-    {
-        if (InputFileName == nullptr)
-            LOG_ERROR_AND_THROW("Input file name must not be null when HLSL source code is not provided");
-
-        if (pInputStreamFactory == nullptr)
-            LOG_ERROR_AND_THROW("Input stream factory must not be null when HLSL source code is not provided");
-        
-        RefCntAutoPtr<IFileStream> pSourceStream;
-        pInputStreamFactory->CreateInputStream(InputFileName, &pSourceStream);
-        if (pSourceStream == nullptr)
-            LOG_ERROR_AND_THROW("Failed to open shader source file ", InputFileName);
-
-        pFileData = MakeNewRCObj<DataBlobImpl>()(0);
-        pSourceStream->Read(pFileData);
-        HLSLSource = reinterpret_cast<char*>(pFileData->GetDataPtr());
-        NumSymbols = pFileData->GetSize();
-    }
-
-    String Source(HLSLSource, NumSymbols);
-
-    InsertIncludes( Source, pInputStreamFactory );
-
-    Tokenize(Source);
+    Tokenize(ExpandedSource);
 }
 
 
 String HLSL2GLSLConverterImpl::Convert(ConversionAttribs& Attribs)const
 {
+    DILIGENT_PROFILE_SCOPE("HLSL2GLSLConverterImpl::Convert");
     if (Attribs.ppConversionStream == nullptr)
     {
         try
         {
-            ConversionStream Stream(nullptr, *this, Attribs.InputFileName, Attribs.pSourceStreamFactory, Attribs.HLSLSource, Attribs.NumSymbols, false);
-            return Stream.Convert(Attribs.EntryPoint, Attribs.ShaderType, Attribs.IncludeDefinitions, Attribs.SamplerSuffix, Attribs.UseInOutLocationQualifiers);
+            auto Source = ConversionStream::LoadSource(Attribs.InputFileName, Attribs.pSourceStreamFactory, Attribs.HLSLSource, Attribs.NumSymbols);
+            if (!m_ConversionCache.IsEnabled())
+            {
+                ConversionStream Stream(nullptr, *this, Attribs.InputFileName, std::move(Source), false);
+                return Stream.Convert(Attribs.EntryPoint, Attribs.ShaderType, Attribs.IncludeDefinitions, Attribs.SamplerSuffix, Attribs.UseInOutLocationQualifiers);
+            }
+
+            // Identical sources are often converted many times, for instance when
+            // different shader permutations define the same macros
+            HLSL2GLSLConversionCache::Key CacheKey(Source, Attribs.EntryPoint, Attribs.ShaderType, Attribs.IncludeDefinitions, Attribs.SamplerSuffix, Attribs.UseInOutLocationQualifiers);
+            if (auto pCachedGLSL = m_ConversionCache.Find(CacheKey, Source))
+                return *pCachedGLSL;
+
+            // The cache keeps the source to compare it with the sources that are looked up later
+            ConversionStream Stream(nullptr, *this, Attribs.InputFileName, String{Source}, false);
+            auto GLSLSource = Stream.Convert(Attribs.EntryPoint, Attribs.ShaderType, Attribs.IncludeDefinitions, Attribs.SamplerSuffix, Attribs.UseInOutLocationQualifiers);
+            m_ConversionCache.Add(CacheKey, std::move(Source), GLSLSource);
+            return GLSLSource;
         }
         catch(std::runtime_error&)
         {
@@ -4517,7 +4611,29 @@ String HLSL2GLSLConverterImpl::ConversionStream::Convert(const Char* EntryPoint,
                                                          bool        UseInOutLocationQualifiers )
 {
     m_bUseInOutLocationQualifiers = UseInOutLocationQualifiers;
-    TokenListType TokensCopy(m_bPreserveTokens ? m_Tokens : TokenListType());
+    TokenListType TokensCopy(m_bPreserveTokens ? m_Tokens : TokenListType(m_Tokens.get_allocator()));
+
+    // Restores the original tokens and releases all token strings created during
+    // the conversion when the conversion is complete or fails
+    struct PreservedTokensGuard
+    {
+        PreservedTokensGuard(ConversionStream& _Stream, TokenListType& _TokensCopy) :
+            Stream    (_Stream),
+            TokensCopy(_TokensCopy)
+        {}
+        ~PreservedTokensGuard()
+        {
+            if (!Stream.m_bPreserveTokens)
+                return;
+            Stream.m_Tokens.swap(TokensCopy);
+            TokensCopy.clear();
+            Stream.m_StructDefinitions.clear();
+            Stream.m_Objects.clear();
+            Stream.m_StringArena.Rewind(Stream.m_TokenizedSourceMark);
+        }
+        ConversionStream& Stream;
+        TokenListType&    TokensCopy;
+    }TokensGuard(*this, TokensCopy);
 
     Uint32 ShaderStorageBlockBinding = 0;
     Uint32 ImageBinding              = 0;
@@ -4549,7 +4665,7 @@ String HLSL2GLSLConverterImpl::ConversionStream::Convert(const Char* EntryPoint,
                 // WARNING: 0:259: Only GLSL version > 110 allows postfix "F" or "f" for float
                 // even when compiling for GL 4.3 AND the code IS UNDER #if 0
                 if( Token->Literal.back() == 'f' || Token->Literal.back() == 'F' )
-                    Token->Literal.pop_back();
+                    Token->Literal = m_StringArena.Copy(Token->Literal.data(), Token->Literal.length() - 1);
                 ++Token;
             break;
 
@@ -4735,13 +4851,6 @@ String HLSL2GLSLConverterImpl::ConversionStream::Convert(const Char* EntryPoint,
 
     auto GLSLSource = BuildGLSLSource();
 
-    if(m_bPreserveTokens)
-    {
-        m_Tokens.swap(TokensCopy);
-        m_StructDefinitions.clear();
-        m_Objects.clear();
-    }
-
     if(IncludeDefintions)
         GLSLSource.insert(0, g_GLSLDefinitions);
 
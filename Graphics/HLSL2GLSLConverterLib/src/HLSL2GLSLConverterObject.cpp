@@ -37,4 +37,19 @@ namespace Diligent
         const auto& Converter = HLSL2GLSLConverterImpl::GetInstance();
         Converter.CreateStream(InputFileName, pSourceStreamFactory, HLSLSource, NumSymbols, ppStream);
     }
+
+    void HLSL2GLSLConverterObject::SetConversionCacheParams(size_t MaxSizeInBytes, const Char* PersistentCacheDir)
+    {
+        HLSL2GLSLConverterImpl::GetInstance().GetConversionCache().SetParams(MaxSizeInBytes, PersistentCacheDir);
+    }
+
+    void HLSL2GLSLConverterObject::GetConversionCacheStats(HLSL2GLSLConversionCacheStats& Stats)const
+    {
+        HLSL2GLSLConverterImpl::GetInstance().GetConversionCache().GetStats(Stats);
+    }
+
+    void HLSL2GLSLConverterObject::ClearConversionCache()
+    {
+        HLSL2GLSLConverterImpl::GetInstance().GetConversionCache().Clear();
+    }
 }
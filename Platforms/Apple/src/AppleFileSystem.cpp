@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <cstdio>
 #include <CoreFoundation/CoreFoundation.h>
 
@@ -114,6 +115,22 @@ bool AppleFileSystem::FileExists( const Diligent::Char *strFilePath )
     return res == 0;
 }
 
+bool AppleFileSystem::GetFileStamp( const Diligent::Char *strFilePath, Diligent::Uint64 &ModificationTime, Diligent::Uint64 &Size )
+{
+    std::string path(strFilePath);
+    CorrectSlashes(path, AppleFileSystem::GetSlashSymbol());
+    auto resource_path = FindResource(path);
+    if(!resource_path.empty())
+        path = resource_path;
+
+    struct stat FileStat;
+    if( stat( path.c_str(), &FileStat ) != 0 || !S_ISREG( FileStat.st_mode ) )
+        return false;
+    ModificationTime = static_cast<Diligent::Uint64>(FileStat.st_mtimespec.tv_sec) * 1000000000ull + static_cast<Diligent::Uint64>(FileStat.st_mtimespec.tv_nsec);
+    Size             = static_cast<Diligent::Uint64>(FileStat.st_size);
+    return true;
+}
+
 bool AppleFileSystem::PathExists( const Diligent::Char *strPath )
 {
     UNSUPPORTED( "Not implemented" );
@@ -85,6 +85,11 @@ public:
 
     static bool FileExists( const Diligent::Char *strFilePath );
 
+    /// Retrieves the last modification time and the size of the file. 
+    /// Returns false if the file does not exist or the information is not
+    /// available on the platform.
+    static bool GetFileStamp( const Diligent::Char *strFilePath, Diligent::Uint64 &ModificationTime, Diligent::Uint64 &Size );
+
     static void SetWorkingDirectory( const Diligent::Char *strWorkingDir ){ m_strWorkingDirectory = strWorkingDir; }
     static const Diligent::String &GetWorkingDirectory(){ return m_strWorkingDirectory; }
 
@@ -86,6 +86,11 @@ bool BasicFileSystem::FileExists( const Diligent::Char *strFilePath )
     return false;
 }
 
+bool BasicFileSystem::GetFileStamp( const Diligent::Char *strFilePath, Diligent::Uint64 &ModificationTime, Diligent::Uint64 &Size )
+{
+    return false;
+}
+
 Diligent::Char BasicFileSystem::GetSlashSymbol()
 {
     UNSUPPORTED( "Unsupported" );
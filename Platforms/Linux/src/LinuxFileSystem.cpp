@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <cstdio>
 
 #include "LinuxFileSystem.h"
@@ -57,6 +58,20 @@ bool LinuxFileSystem::FileExists( const Diligent::Char *strFilePath )
     return Exists;
 }
 
+bool LinuxFileSystem::GetFileStamp( const Diligent::Char *strFilePath, Diligent::Uint64 &ModificationTime, Diligent::Uint64 &Size )
+{
+    FileOpenAttribs OpenAttribs;
+    OpenAttribs.strFilePath = strFilePath;
+    BasicFile DummyFile( OpenAttribs, LinuxFileSystem::GetSlashSymbol() );
+    const auto& Path = DummyFile.GetPath(); // This is necessary to correct slashes
+    struct stat FileStat;
+    if( stat( Path.c_str(), &FileStat ) != 0 || !S_ISREG( FileStat.st_mode ) )
+        return false;
+    ModificationTime = static_cast<Diligent::Uint64>(FileStat.st_mtim.tv_sec) * 1000000000ull + static_cast<Diligent::Uint64>(FileStat.st_mtim.tv_nsec);
+    Size             = static_cast<Diligent::Uint64>(FileStat.st_size);
+    return true;
+}
+
 bool LinuxFileSystem::PathExists( const Diligent::Char *strPath )
 {
     UNSUPPORTED( "Not implemented" );
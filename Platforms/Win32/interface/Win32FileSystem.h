@@ -41,6 +41,7 @@ public:
     static inline Diligent::Char GetSlashSymbol(){ return '\\'; }
 
     static bool FileExists( const Diligent::Char *strFilePath );
+    static bool GetFileStamp( const Diligent::Char *strFilePath, Diligent::Uint64 &ModificationTime, Diligent::Uint64 &Size );
     static bool PathExists( const Diligent::Char *strPath );
     
     static bool CreateDirectory( const Diligent::Char *strPath );
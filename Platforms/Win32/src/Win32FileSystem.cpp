@@ -121,6 +121,22 @@ bool WindowsFileSystem::FileExists( const Char* strFilePath )
     return Exists;
 }
 
+bool WindowsFileSystem::GetFileStamp( const Char* strFilePath, Uint64& ModificationTime, Uint64& Size )
+{
+    FileOpenAttribs OpenAttribs;
+    OpenAttribs.strFilePath = strFilePath;
+    BasicFile DummyFile( OpenAttribs, WindowsFileSystem::GetSlashSymbol() );
+    const auto& Path = DummyFile.GetPath(); // This is necessary to correct slashes
+    auto UTF16FilePath = UTF8ToUTF16(Path.c_str());
+    WIN32_FILE_ATTRIBUTE_DATA FileAttribs;
+    if( !GetFileAttributesExW( UTF16FilePath.data(), GetFileExInfoStandard, &FileAttribs ) ||
+        (FileAttribs.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 )
+        return false;
+    ModificationTime = (static_cast<Uint64>(FileAttribs.ftLastWriteTime.dwHighDateTime) << 32) | static_cast<Uint64>(FileAttribs.ftLastWriteTime.dwLowDateTime);
+    Size             = (static_cast<Uint64>(FileAttribs.nFileSizeHigh) << 32) | static_cast<Uint64>(FileAttribs.nFileSizeLow);
+    return true;
+}
+
 static bool CreateDirectoryImpl( const Char* strPath )
 {
     // Test all parent directories 
@@ -0,0 +1,58 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Defines Diligent::IThreadPool interface
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Base interface for an application-provided thread pool
+
+/// An application may implement this interface to make the engine run its internal
+/// jobs on the application's own threads instead of creating dedicated worker threads.
+/// \sa EngineCreateInfo::pThreadPool
+class IThreadPool
+{
+public:
+    /// Type of the function that is executed by the pool
+    typedef void (*TaskFunctionType)(void* pUserData);
+
+    /// Returns the number of threads in the pool
+    virtual Uint32 GetNumThreads()const = 0;
+
+    /// Schedules the function to be asynchronously executed by one of the pool threads
+
+    /// \param [in] TaskFunction - function to execute.
+    /// \param [in] pUserData    - user data that is passed to the function.
+    ///
+    /// \remarks The method may be called simultaneously from multiple threads.
+    ///          The function must be executed exactly once.
+    virtual void EnqueueTask(TaskFunctionType TaskFunction, void* pUserData) = 0;
+};
+
+}
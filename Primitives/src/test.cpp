@@ -29,3 +29,4 @@
 #include "FormatString.h"
 #include "FileStream.h"
 #include "DataBlob.h"
+#include "ThreadPool.h"
@@ -0,0 +1,323 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <thread>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <stdexcept>
+
+#include "JobSystem.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Simple thread pool that plays the role of the application-provided pool
+class TestThreadPool final : public IThreadPool
+{
+public:
+    explicit TestThreadPool(Uint32 NumThreads)
+    {
+        for (Uint32 i = 0; i < NumThreads; ++i)
+            m_Threads.emplace_back(&TestThreadPool::ThreadProc, this);
+    }
+
+    ~TestThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            m_Stop = true;
+        }
+        m_CondVar.notify_all();
+        for (auto& Thread : m_Threads)
+            Thread.join();
+    }
+
+    virtual Uint32 GetNumThreads()const override final
+    {
+        return static_cast<Uint32>(m_Threads.size());
+    }
+
+    virtual void EnqueueTask(TaskFunctionType TaskFunction, void* pUserData) override final
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            m_Tasks.emplace_back(TaskFunction, pUserData);
+            ++m_NumEnqueuedTasks;
+        }
+        m_CondVar.notify_one();
+    }
+
+    Uint32 GetNumEnqueuedTasks()const { return m_NumEnqueuedTasks.load(); }
+
+private:
+    void ThreadProc()
+    {
+        for (;;)
+        {
+            std::pair<TaskFunctionType, void*> Task;
+            {
+                std::unique_lock<std::mutex> Lock{m_Mtx};
+                m_CondVar.wait(Lock, [this] { return m_Stop || !m_Tasks.empty(); });
+                if (m_Tasks.empty())
+                    break;
+                Task = m_Tasks.front();
+                m_Tasks.pop_front();
+            }
+            Task.first(Task.second);
+        }
+    }
+
+    std::vector<std::thread>                       m_Threads;
+    std::deque<std::pair<TaskFunctionType, void*>> m_Tasks;
+    std::mutex                                     m_Mtx;
+    std::condition_variable                        m_CondVar;
+    bool                                           m_Stop = false;
+    std::atomic<Uint32>                            m_NumEnqueuedTasks{0};
+};
+
+// Runs the test for a job system without threads, with worker threads, and with an external pool
+template<typename TestFuncType>
+void ForEachConfiguration(TestFuncType TestFunc)
+{
+    {
+        JobSystem Jobs{0};
+        TestFunc(Jobs);
+    }
+    {
+        JobSystem Jobs{4};
+        TestFunc(Jobs);
+    }
+    {
+        TestThreadPool Pool{4};
+        JobSystem      Jobs{0, &Pool};
+        TestFunc(Jobs);
+    }
+}
+
+TEST(JobSystem, Dependencies)
+{
+    ForEachConfiguration(
+        [](JobSystem& Jobs)
+        {
+            std::atomic<int> A{0}, B{0};
+            std::atomic<bool> PrerequisitesComplete{false};
+
+            auto TaskA = Jobs.CreateTask([&]() { std::this_thread::sleep_for(std::chrono::milliseconds{5}); A = 1; });
+            auto TaskB = Jobs.CreateTask([&]() { B = 2; });
+            auto TaskC = Jobs.CreateTask([&]() { PrerequisitesComplete = A == 1 && B == 2; });
+            Jobs.AddDependency(TaskC, TaskA);
+            Jobs.AddDependency(TaskC, TaskB);
+
+            // The dependent task is submitted first, but must not run before its prerequisites
+            Jobs.Submit(TaskC);
+            EXPECT_FALSE(TaskC->IsComplete());
+            Jobs.Submit(TaskB);
+            Jobs.Submit(TaskA);
+
+            Jobs.Wait(TaskC);
+            EXPECT_TRUE(TaskA->IsComplete());
+            EXPECT_TRUE(TaskB->IsComplete());
+            EXPECT_TRUE(PrerequisitesComplete);
+        });
+}
+
+TEST(JobSystem, Continuations)
+{
+    ForEachConfiguration(
+        [](JobSystem& Jobs)
+        {
+            // A chain of continuations must execute in order
+            std::vector<int> Order;
+            std::mutex       OrderMtx;
+            auto AddToOrder = [&](int Val) {
+                std::lock_guard<std::mutex> Lock{OrderMtx};
+                Order.push_back(Val);
+            };
+
+            auto pTask = Jobs.Run([&]() { AddToOrder(0); });
+            for (int i = 1; i < 10; ++i)
+                pTask = Jobs.ContinueWith(pTask, [&AddToOrder, i]() { AddToOrder(i); });
+            Jobs.Wait(pTask);
+            EXPECT_EQ(Order, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+            // Continuation of a task that has already completed runs immediately after submission
+            auto pCompleted = Jobs.Run([]() {});
+            Jobs.Wait(pCompleted);
+            std::atomic<bool> ContinuationExecuted{false};
+            Jobs.Wait(Jobs.ContinueWith(pCompleted, [&]() { ContinuationExecuted = true; }));
+            EXPECT_TRUE(ContinuationExecuted);
+        });
+}
+
+TEST(JobSystem, ParallelFor)
+{
+    ForEachConfiguration(
+        [](JobSystem& Jobs)
+        {
+            constexpr Uint32 Count = 10007;
+            for (Uint32 GrainSize : {0u, 1u, 64u, Count})
+            {
+                std::vector<std::atomic<Uint32>> Visited(Count);
+                for (auto& V : Visited)
+                    V.store(0);
+                Jobs.ParallelFor(0, Count, GrainSize,
+                    [&](Uint32 Begin, Uint32 End)
+                    {
+                        EXPECT_LT(Begin, End);
+                        if (GrainSize != 0)
+                            EXPECT_LE(End - Begin, GrainSize);
+                        for (Uint32 i = Begin; i < End; ++i)
+                            ++Visited[i];
+                    });
+                Uint32 NumMismatches = 0;
+                for (auto& V : Visited)
+                {
+                    if (V.load() != 1)
+                        ++NumMismatches;
+                }
+                EXPECT_EQ(NumMismatches, 0u) << "GrainSize: " << GrainSize;
+            }
+
+            // Empty range
+            bool Called = false;
+            Jobs.ParallelFor(5, 5, 0, [&](Uint32, Uint32) { Called = true; });
+            EXPECT_FALSE(Called);
+        });
+}
+
+TEST(JobSystem, StealingCounters)
+{
+    constexpr Uint32 NumWorkers  = 4;
+    constexpr Uint32 NumSubtasks = 64;
+
+    JobSystem Jobs{NumWorkers};
+    EXPECT_EQ(Jobs.GetNumThreads(), NumWorkers);
+    EXPECT_EQ(Jobs.GetNumQueues(), NumWorkers);
+
+    // Tasks spawned by a worker go to the worker's own queue, so the idle workers can only get them by stealing
+    auto pRoot = Jobs.Run(
+        [&]()
+        {
+            std::vector<JobSystem::TaskHandle> Subtasks;
+            for (Uint32 i = 0; i < NumSubtasks; ++i)
+                Subtasks.emplace_back(Jobs.Run([]() { std::this_thread::sleep_for(std::chrono::milliseconds{1}); }));
+            for (const auto& pTask : Subtasks)
+                Jobs.Wait(pTask);
+        });
+    Jobs.Wait(pRoot);
+
+    const auto Stats = Jobs.GetTotalStats();
+    EXPECT_EQ(Stats.NumTasksExecuted, NumSubtasks + 1);
+    EXPECT_GT(Stats.NumSteals, 0u);
+    EXPECT_EQ(Stats.QueueDepth, 0u);
+
+    Uint64 NumSteals = 0;
+    Uint64 NumTasks  = 0;
+    for (Uint32 q = 0; q < Jobs.GetNumQueues(); ++q)
+    {
+        const auto QueueStats = Jobs.GetQueueStats(q);
+        NumSteals += QueueStats.NumSteals;
+        NumTasks  += QueueStats.NumTasksExecuted;
+    }
+    EXPECT_EQ(NumSteals, Stats.NumSteals);
+    EXPECT_EQ(NumTasks, Stats.NumTasksExecuted);
+}
+
+TEST(JobSystem, ExternalPool)
+{
+    TestThreadPool Pool{3};
+    std::atomic<Uint32> NumExecuted{0};
+    {
+        JobSystem Jobs{8, &Pool};
+        // Worker thread count is ignored when the pool is given
+        EXPECT_EQ(Jobs.GetNumThreads(), 3u);
+
+        std::vector<JobSystem::TaskHandle> Tasks;
+        for (Uint32 i = 0; i < 100; ++i)
+            Tasks.emplace_back(Jobs.Run([&]() { ++NumExecuted; }));
+        for (const auto& pTask : Tasks)
+            Jobs.Wait(pTask);
+        EXPECT_EQ(NumExecuted.load(), 100u);
+        EXPECT_EQ(Pool.GetNumEnqueuedTasks(), 100u);
+
+        // The job system must execute the tasks that are still queued when it is destroyed, and
+        // wait until the pool has processed all callbacks that reference the job system
+        for (Uint32 i = 0; i < 100; ++i)
+            Jobs.Run([&]() { ++NumExecuted; });
+    }
+    EXPECT_EQ(NumExecuted.load(), 200u);
+    EXPECT_EQ(Pool.GetNumEnqueuedTasks(), 200u);
+}
+
+TEST(JobSystem, Exceptions)
+{
+    ForEachConfiguration(
+        [](JobSystem& Jobs)
+        {
+            std::atomic<bool> ContinuationExecuted{false};
+            auto pFailed       = Jobs.Run([]() { throw std::runtime_error{"Task failed"}; });
+            auto pContinuation = Jobs.ContinueWith(pFailed, [&]() { ContinuationExecuted = true; });
+
+            EXPECT_THROW(Jobs.Wait(pFailed), std::runtime_error);
+            EXPECT_TRUE(pFailed->IsComplete());
+            EXPECT_TRUE(pFailed->GetException() != nullptr);
+
+            // The continuation of the failed task must still run
+            EXPECT_NO_THROW(Jobs.Wait(pContinuation));
+            EXPECT_TRUE(ContinuationExecuted);
+            EXPECT_TRUE(pContinuation->GetException() == nullptr);
+
+            // The threads must survive the exception and keep executing tasks
+            std::atomic<Uint32> NumExecuted{0};
+            std::vector<JobSystem::TaskHandle> Tasks;
+            for (Uint32 i = 0; i < 32; ++i)
+                Tasks.emplace_back(Jobs.Run([&]() { ++NumExecuted; }));
+            for (const auto& pTask : Tasks)
+                Jobs.Wait(pTask);
+            EXPECT_EQ(NumExecuted.load(), 32u);
+
+            // ParallelFor rethrows the exception only after all chunks have been processed
+            std::atomic<Uint32> NumProcessed{0};
+            EXPECT_THROW(
+                Jobs.ParallelFor(0, 64, 1,
+                    [&](Uint32 Begin, Uint32)
+                    {
+                        ++NumProcessed;
+                        if (Begin % 16 == 0)
+                            throw std::runtime_error{"Chunk failed"};
+                    }),
+                std::runtime_error);
+            EXPECT_EQ(NumProcessed.load(), 64u);
+        });
+}
+
+} // namespace
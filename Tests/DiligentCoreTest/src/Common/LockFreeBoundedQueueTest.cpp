@@ -0,0 +1,185 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "LockFreeBoundedQueue.h"
+#include "DefaultRawMemoryAllocator.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(LockFreeBoundedQueue, FIFOOrder)
+{
+    LockFreeBoundedQueue<int> Queue{DefaultRawMemoryAllocator::GetAllocator(), 8};
+    EXPECT_EQ(Queue.GetCapacity(), 8u);
+    EXPECT_FALSE(Queue.TryPop([](int&&){}));
+
+    for (int i = 0; i < 5; ++i)
+        EXPECT_TRUE(Queue.TryPush(int{i}));
+    EXPECT_EQ(Queue.GetSizeApprox(), 5u);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        int Item = -1;
+        EXPECT_TRUE(Queue.TryPop([&](int&& Val){ Item = Val; }));
+        EXPECT_EQ(Item, i);
+    }
+    EXPECT_EQ(Queue.GetSizeApprox(), 0u);
+    EXPECT_FALSE(Queue.TryPop([](int&&){}));
+}
+
+TEST(LockFreeBoundedQueue, FullQueue)
+{
+    LockFreeBoundedQueue<std::unique_ptr<int>> Queue{DefaultRawMemoryAllocator::GetAllocator(), 4};
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(Queue.TryPush(std::unique_ptr<int>{new int{i}}));
+
+    // The item must be left untouched when the queue is full
+    std::unique_ptr<int> Item{new int{4}};
+    EXPECT_FALSE(Queue.TryPush(std::move(Item)));
+    ASSERT_TRUE(Item);
+    EXPECT_EQ(*Item, 4);
+
+    // Removing one item makes room for one more
+    EXPECT_TRUE(Queue.TryPop([](std::unique_ptr<int>&& Val){ EXPECT_EQ(*Val, 0); }));
+    EXPECT_TRUE(Queue.TryPush(std::move(Item)));
+    EXPECT_FALSE(Queue.TryPush(std::unique_ptr<int>{new int{5}}));
+
+    for (int i = 1; i <= 4; ++i)
+        EXPECT_TRUE(Queue.TryPop([&](std::unique_ptr<int>&& Val){ EXPECT_EQ(*Val, i); }));
+    EXPECT_FALSE(Queue.TryPop([](std::unique_ptr<int>&&){}));
+}
+
+TEST(LockFreeBoundedQueue, WrapAround)
+{
+    // Push and pop many more items than the capacity, so that the positions
+    // wrap around the cell array many times
+    LockFreeBoundedQueue<size_t> Queue{DefaultRawMemoryAllocator::GetAllocator(), 4};
+    size_t NextPush = 0;
+    size_t NextPop  = 0;
+    for (size_t Lap = 0; Lap < 1000; ++Lap)
+    {
+        // Fill the queue up to a varying level, including completely, and then
+        // remove all items but zero or one, so that the fill offset keeps shifting
+        const size_t FillLevel = 1 + Lap % 4;
+        while (NextPush - NextPop < FillLevel)
+            ASSERT_TRUE(Queue.TryPush(size_t{NextPush++}));
+        if (FillLevel == Queue.GetCapacity())
+            EXPECT_FALSE(Queue.TryPush(size_t{NextPush}));
+        while (NextPush - NextPop > Lap % 2)
+            ASSERT_TRUE(Queue.TryPop([&](size_t&& Val){ EXPECT_EQ(Val, NextPop); ++NextPop; }));
+    }
+    while (Queue.TryPop([&](size_t&& Val){ EXPECT_EQ(Val, NextPop); ++NextPop; }))
+        ;
+    EXPECT_EQ(NextPop, NextPush);
+}
+
+TEST(LockFreeBoundedQueue, DestroysRemainingItems)
+{
+    auto Counter = std::make_shared<int>(0);
+    {
+        LockFreeBoundedQueue<std::shared_ptr<int>> Queue{DefaultRawMemoryAllocator::GetAllocator(), 8};
+        for (int i = 0; i < 5; ++i)
+            EXPECT_TRUE(Queue.TryPush(std::shared_ptr<int>{Counter}));
+        EXPECT_TRUE(Queue.TryPop([](std::shared_ptr<int>&&){}));
+        EXPECT_EQ(Counter.use_count(), 5);
+    }
+    EXPECT_EQ(Counter.use_count(), 1);
+}
+
+TEST(LockFreeBoundedQueue, ConcurrentPushPop)
+{
+    constexpr size_t NumProducers     = 4;
+    constexpr size_t NumConsumers     = 4;
+    constexpr size_t ItemsPerProducer = 100000;
+
+    // The queue is small, so producers frequently find it full and consumers find it empty
+    LockFreeBoundedQueue<size_t> Queue{DefaultRawMemoryAllocator::GetAllocator(), 64};
+
+    std::vector<std::atomic<Uint32>> ReceivedCount(NumProducers * ItemsPerProducer);
+    for (auto& Count : ReceivedCount)
+        Count.store(0);
+    std::atomic<size_t> NumPopped{0};
+
+    std::vector<std::thread> Threads;
+    for (size_t p = 0; p < NumProducers; ++p)
+    {
+        Threads.emplace_back(
+            [&, p]()
+            {
+                for (size_t i = 0; i < ItemsPerProducer; ++i)
+                {
+                    const size_t Item = p * ItemsPerProducer + i;
+                    while (!Queue.TryPush(size_t{Item}))
+                        std::this_thread::yield();
+                }
+            });
+    }
+    for (size_t c = 0; c < NumConsumers; ++c)
+    {
+        Threads.emplace_back(
+            [&]()
+            {
+                // Items from the same producer must be received in the order they were pushed
+                std::vector<size_t> LastItem(NumProducers, ~size_t{0});
+                while (NumPopped.load() < NumProducers * ItemsPerProducer)
+                {
+                    const bool Popped = Queue.TryPop(
+                        [&](size_t&& Item)
+                        {
+                            ++ReceivedCount[Item];
+                            auto& Last = LastItem[Item / ItemsPerProducer];
+                            EXPECT_TRUE(Last == ~size_t{0} || Last < Item);
+                            Last = Item;
+                        });
+                    if (Popped)
+                        ++NumPopped;
+                    else
+                        std::this_thread::yield();
+                }
+            });
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+
+    EXPECT_EQ(NumPopped.load(), NumProducers * ItemsPerProducer);
+    EXPECT_EQ(Queue.GetSizeApprox(), 0u);
+    size_t NumMismatches = 0;
+    for (const auto& Count : ReceivedCount)
+    {
+        if (Count.load() != 1)
+            ++NumMismatches;
+    }
+    EXPECT_EQ(NumMismatches, 0u);
+}
+
+} // namespace
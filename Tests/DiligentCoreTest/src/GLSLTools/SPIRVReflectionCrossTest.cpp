@@ -0,0 +1,322 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// Differential test: SPIRVReflection must report the same resources as spirv_cross
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include "SPIRVReflection.h"
+#include "SPIRVUtils.h"
+#include "spirv_cross.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+const char* const GLSLFragmentShader = R"(
+#version 450
+
+layout(set = 0, binding = 0) uniform Constants
+{
+    vec4 g_Scale;
+};
+layout(std430, set = 0, binding = 1) readonly buffer ReadOnlyData
+{
+    vec4 g_ReadOnlyData[];
+};
+layout(std430, set = 1, binding = 0) buffer Data
+{
+    vec4 g_Data[];
+} g_RWData;
+
+layout(set = 1, binding = 1, rgba8) uniform image2D g_RWImage;
+layout(set = 1, binding = 2, r32f) uniform imageBuffer g_RWTexelBuffer;
+
+layout(set = 2, binding = 0) uniform sampler2D g_CombinedSamplers[2][3];
+layout(set = 2, binding = 1) uniform texture2D g_Textures[4];
+layout(set = 2, binding = 2) uniform sampler   g_Sampler;
+layout(set = 2, binding = 3) uniform textureBuffer g_TexelBuffer;
+
+layout(location = 0) in vec2 in_UV;
+layout(location = 3) flat in int in_Index;
+
+layout(location = 0) out vec4 out_Color;
+
+void main()
+{
+    vec4 Color = texture(g_CombinedSamplers[1][in_Index], in_UV);
+    Color += texture(sampler2D(g_Textures[in_Index], g_Sampler), in_UV);
+    Color += texelFetch(g_TexelBuffer, in_Index);
+    Color += imageLoad(g_RWImage, ivec2(in_UV)) + imageLoad(g_RWTexelBuffer, in_Index);
+    Color += g_ReadOnlyData[in_Index] * g_Scale;
+    g_RWData.g_Data[in_Index] = Color;
+    out_Color = Color * gl_FragCoord;
+}
+)";
+
+const char* const GLSLComputeShader = R"(
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0) uniform texture2D g_BindlessTextures[];
+layout(set = 0, binding = 1) uniform sampler   g_Samplers[2];
+layout(set = 1, binding = 0, rgba32f) uniform writeonly image2D g_Output;
+
+void main()
+{
+    ivec2 Coord = ivec2(gl_GlobalInvocationID.xy);
+    vec4  Color = textureLod(sampler2D(g_BindlessTextures[Coord.x], g_Samplers[1]), vec2(0.5), 0.0);
+    imageStore(g_Output, Coord, Color);
+}
+)";
+
+const char* const HLSLPixelShader = R"(
+Texture2D              g_Texture;
+Texture2D              g_TextureArr[3];
+SamplerState           g_Texture_sampler;
+RWTexture2D<float4>    g_RWTexture;
+Buffer<float4>         g_Buffer;
+RWBuffer<float4>       g_RWBuffer;
+StructuredBuffer<float4>   g_StructBuff;
+RWStructuredBuffer<float4> g_RWStructBuff;
+ByteAddressBuffer      g_RawBuff;
+
+cbuffer Constants
+{
+    float4 g_Scale;
+};
+
+struct PSInput
+{
+    float4 Pos   : SV_Position;
+    float2 UV    : TEXCOORD0;
+    uint   Index : INDEX;
+};
+
+float4 main(in PSInput In) : SV_Target
+{
+    float4 Color = g_Texture.Sample(g_Texture_sampler, In.UV) * g_Scale;
+    Color += g_TextureArr[In.Index].Sample(g_Texture_sampler, In.UV);
+    Color += g_RWTexture[uint2(In.UV)] + g_Buffer.Load(In.Index) + g_RWBuffer[In.Index];
+    Color += g_StructBuff[In.Index] + asfloat(g_RawBuff.Load4(In.Index * 16));
+    g_RWStructBuff[In.Index] = Color;
+    return Color;
+}
+)";
+
+struct ResourceAttribs
+{
+    Uint32      Id                    = 0;
+    Uint32      TypeId                = 0;
+    std::string Name;
+    std::string TypeName;
+    std::string Semantic;
+    Uint32      ArraySize             = 0;
+    Uint32      BindingOffset         = 0;
+    Uint32      DescriptorSetOffset   = 0;
+    Uint32      LocationOffset        = 0;
+    bool        IsReadOnly            = false;
+    bool        IsTexelBuffer         = false;
+
+    bool operator == (const ResourceAttribs& Res) const
+    {
+        return Id                  == Res.Id                  &&
+               TypeId              == Res.TypeId              &&
+               Name                == Res.Name                &&
+               TypeName            == Res.TypeName            &&
+               Semantic            == Res.Semantic            &&
+               ArraySize           == Res.ArraySize           &&
+               BindingOffset       == Res.BindingOffset       &&
+               DescriptorSetOffset == Res.DescriptorSetOffset &&
+               LocationOffset      == Res.LocationOffset      &&
+               IsReadOnly          == Res.IsReadOnly          &&
+               IsTexelBuffer       == Res.IsTexelBuffer;
+    }
+};
+
+std::ostream& operator << (std::ostream& os, const ResourceAttribs& Res)
+{
+    return os << "{Id: " << Res.Id << ", TypeId: " << Res.TypeId << ", Name: '" << Res.Name << "', TypeName: '" << Res.TypeName
+              << "', Semantic: '" << Res.Semantic << "', ArraySize: " << Res.ArraySize << ", Binding: " << Res.BindingOffset
+              << ", Set: " << Res.DescriptorSetOffset << ", Location: " << Res.LocationOffset
+              << ", ReadOnly: " << Res.IsReadOnly << ", TexelBuffer: " << Res.IsTexelBuffer << "}";
+}
+
+Uint32 GetDecorationOffset(const spirv_cross::Compiler& Compiler, Uint32 Id, spv::Decoration Decoration)
+{
+    uint32_t Offset = 0;
+    return Compiler.get_binary_offset_for_decoration(Id, Decoration, Offset) ? Offset : 0;
+}
+
+using ResourceList = decltype(spirv_cross::ShaderResources::uniform_buffers);
+
+std::vector<ResourceAttribs> GetReferenceResources(const spirv_cross::Compiler& Compiler,
+                                                   const ResourceList&          Resources,
+                                                   bool                         IsStorageBuffer)
+{
+    std::vector<ResourceAttribs> Attribs;
+    for (const auto& Res : Resources)
+    {
+        ResourceAttribs Attr;
+        Attr.Id                  = Res.id;
+        Attr.TypeId              = Res.base_type_id;
+        Attr.Name                = Compiler.get_name(Res.id);
+        Attr.TypeName            = Compiler.get_name(Res.base_type_id);
+        Attr.Semantic            = Compiler.get_decoration_string(Res.id, spv::DecorationHlslSemanticGOOGLE);
+        const auto& Type         = Compiler.get_type(Res.type_id);
+        Attr.ArraySize           = Type.array.empty() ? 1 : Type.array[0];
+        Attr.BindingOffset       = GetDecorationOffset(Compiler, Res.id, spv::DecorationBinding);
+        Attr.DescriptorSetOffset = GetDecorationOffset(Compiler, Res.id, spv::DecorationDescriptorSet);
+        Attr.LocationOffset      = GetDecorationOffset(Compiler, Res.id, spv::DecorationLocation);
+        Attr.IsReadOnly          = IsStorageBuffer && Compiler.get_buffer_block_flags(Res.id).get(spv::DecorationNonWritable);
+        const auto& BaseType     = Compiler.get_type(Res.base_type_id);
+        Attr.IsTexelBuffer       = BaseType.basetype == spirv_cross::SPIRType::Image && BaseType.image.dim == spv::DimBuffer;
+        Attribs.emplace_back(std::move(Attr));
+    }
+    return Attribs;
+}
+
+std::vector<ResourceAttribs> GetReflectedResources(const SPIRVReflection& Reflection, SPIRVReflection::RESOURCE_CATEGORY Category)
+{
+    std::vector<ResourceAttribs> Attribs;
+    Reflection.ProcessResources(Category,
+        [&](const SPIRVReflection::ResourceInfo& Res)
+        {
+            ResourceAttribs Attr;
+            Attr.Id                  = Res.Id;
+            Attr.TypeId              = Res.TypeId;
+            Attr.Name                = Res.Name;
+            Attr.TypeName            = Res.TypeName;
+            Attr.Semantic            = Res.Semantic != nullptr ? Res.Semantic : "";
+            Attr.ArraySize           = Res.ArraySize;
+            Attr.BindingOffset       = Res.BindingDecorationOffset;
+            Attr.DescriptorSetOffset = Res.DescriptorSetDecorationOffset;
+            Attr.LocationOffset      = Res.LocationDecorationOffset;
+            Attr.IsReadOnly          = Res.IsReadOnly;
+            Attr.IsTexelBuffer       = Res.IsTexelBuffer;
+            Attribs.emplace_back(std::move(Attr));
+        });
+    return Attribs;
+}
+
+// spirv_cross enumerates resources in the order of ids, while SPIRVReflection
+// enumerates them in the order of declaration
+void SortById(std::vector<ResourceAttribs>& Attribs)
+{
+    std::sort(Attribs.begin(), Attribs.end(),
+              [](const ResourceAttribs& lhs, const ResourceAttribs& rhs)
+              {
+                  return lhs.Id < rhs.Id;
+              });
+}
+
+void CompareWithSPIRVCross(const std::vector<unsigned int>& SPIRV)
+{
+    ASSERT_FALSE(SPIRV.empty());
+
+    SPIRVReflection       Reflection{SPIRV};
+    spirv_cross::Compiler Compiler{SPIRV};
+
+    const auto EntryPoints = Compiler.get_entry_points_and_stages();
+    ASSERT_EQ(Reflection.GetNumEntryPoints(), static_cast<Uint32>(EntryPoints.size()));
+    for (Uint32 i = 0; i < Reflection.GetNumEntryPoints(); ++i)
+    {
+        const auto& EntryPoint = EntryPoints[i];
+        EXPECT_EQ(EntryPoint.name, Reflection.GetEntryPointName(i));
+
+        Compiler.set_entry_point(EntryPoint.name, EntryPoint.execution_model);
+        Reflection.SetEntryPoint(i);
+
+        const auto Resources = Compiler.get_shader_resources();
+
+        const struct
+        {
+            SPIRVReflection::RESOURCE_CATEGORY Category;
+            const ResourceList&                RefResources;
+            const char*                        Name;
+        } Categories[] =
+        {
+            {SPIRVReflection::RESOURCE_CATEGORY_UNIFORM_BUFFER,   Resources.uniform_buffers,    "uniform buffers"},
+            {SPIRVReflection::RESOURCE_CATEGORY_STORAGE_BUFFER,   Resources.storage_buffers,    "storage buffers"},
+            {SPIRVReflection::RESOURCE_CATEGORY_STORAGE_IMAGE,    Resources.storage_images,     "storage images"},
+            {SPIRVReflection::RESOURCE_CATEGORY_SAMPLED_IMAGE,    Resources.sampled_images,     "sampled images"},
+            {SPIRVReflection::RESOURCE_CATEGORY_ATOMIC_COUNTER,   Resources.atomic_counters,    "atomic counters"},
+            {SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_SAMPLER, Resources.separate_samplers,  "separate samplers"},
+            {SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_IMAGE,   Resources.separate_images,    "separate images"},
+            {SPIRVReflection::RESOURCE_CATEGORY_STAGE_INPUT,      Resources.stage_inputs,       "stage inputs"},
+        };
+        for (const auto& Cat : Categories)
+        {
+            auto RefAttribs = GetReferenceResources(Compiler, Cat.RefResources, Cat.Category == SPIRVReflection::RESOURCE_CATEGORY_STORAGE_BUFFER);
+            auto Attribs    = GetReflectedResources(Reflection, Cat.Category);
+            EXPECT_EQ(Reflection.GetNumResources(Cat.Category), static_cast<Uint32>(Attribs.size())) << Cat.Name;
+            SortById(RefAttribs);
+            SortById(Attribs);
+            EXPECT_EQ(Attribs, RefAttribs) << "Entry point '" << EntryPoint.name << "': " << Cat.Name << " do not match";
+        }
+    }
+}
+
+class SPIRVReflectionCrossTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        InitializeGlslang();
+    }
+
+    static void TearDownTestCase()
+    {
+        FinalizeGlslang();
+    }
+};
+
+TEST_F(SPIRVReflectionCrossTest, GLSLFragmentShader)
+{
+    CompareWithSPIRVCross(GLSLtoSPIRV(SHADER_TYPE_PIXEL, GLSLFragmentShader, static_cast<int>(strlen(GLSLFragmentShader)), nullptr));
+}
+
+TEST_F(SPIRVReflectionCrossTest, GLSLComputeShader)
+{
+    CompareWithSPIRVCross(GLSLtoSPIRV(SHADER_TYPE_COMPUTE, GLSLComputeShader, static_cast<int>(strlen(GLSLComputeShader)), nullptr));
+}
+
+TEST_F(SPIRVReflectionCrossTest, HLSLPixelShader)
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.Source          = HLSLPixelShader;
+    ShaderCI.EntryPoint      = "main";
+    ShaderCI.SourceLanguage  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+    CompareWithSPIRVCross(HLSLtoSPIRV(ShaderCI, nullptr));
+}
+
+} // namespace
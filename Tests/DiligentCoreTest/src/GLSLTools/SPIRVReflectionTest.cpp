@@ -0,0 +1,472 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <initializer_list>
+
+#include "PlatformDefinitions.h"
+#include "DefaultRawMemoryAllocator.h"
+#include "SPIRVReflection.h"
+#include "SPIRVShaderResources.h"
+#include "spirv/unified1/spirv.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Assembles SPIR-V modules for the tests
+class SPIRVAssembler
+{
+public:
+    SPIRVAssembler()
+    {
+        // Magic number, version 1.0, generator, bound (set by GetSPIRV()), schema
+        m_Words = {spv::MagicNumber, 0x10000, 0, 0, 0};
+    }
+
+    // TrailingOperands follow the literal string, e.g. the interface ids of OpEntryPoint
+    void Emit(spv::Op OpCode, std::initializer_list<uint32_t> Operands, const char* String = nullptr, std::initializer_list<uint32_t> TrailingOperands = {})
+    {
+        std::vector<uint32_t> Instruction{0};
+        Instruction.insert(Instruction.end(), Operands.begin(), Operands.end());
+        if (String != nullptr)
+        {
+            // Literal strings are null-terminated and padded with zeros to the word boundary
+            const auto Len = strlen(String) + 1;
+            std::vector<uint32_t> StringWords((Len + 3) / 4, 0);
+            memcpy(StringWords.data(), String, Len);
+            Instruction.insert(Instruction.end(), StringWords.begin(), StringWords.end());
+        }
+        Instruction.insert(Instruction.end(), TrailingOperands.begin(), TrailingOperands.end());
+        Instruction[0] = (static_cast<uint32_t>(Instruction.size()) << spv::WordCountShift) | OpCode;
+        m_Words.insert(m_Words.end(), Instruction.begin(), Instruction.end());
+    }
+
+    uint32_t NewId() { return m_Bound++; }
+
+    const std::vector<uint32_t>& GetSPIRV()
+    {
+        m_Words[3] = m_Bound;
+        return m_Words;
+    }
+
+private:
+    std::vector<uint32_t> m_Words;
+    uint32_t              m_Bound = 1;
+};
+
+std::vector<std::string> GetResourceNames(const SPIRVReflection& Reflection, SPIRVReflection::RESOURCE_CATEGORY Category)
+{
+    std::vector<std::string> Names;
+    Reflection.ProcessResources(Category,
+        [&](const SPIRVReflection::ResourceInfo& Res)
+        {
+            Names.emplace_back(Res.Name);
+        });
+    return Names;
+}
+
+TEST(SPIRVReflectionTest, ImageCategories)
+{
+    SPIRVAssembler Asm;
+    const auto Float = Asm.NewId();
+    Asm.Emit(spv::OpTypeFloat, {Float, 32});
+
+    // Sampled operand: 0 - known at run time, 1 - used with a sampler, 2 - storage image
+    const char* const Names[] = {"g_RuntimeSampled", "g_Texture", "g_RWTexture", "g_TexelBuffer", "g_SubpassInput"};
+    const uint32_t    Dims[]    = {spv::Dim2D, spv::Dim2D, spv::Dim2D, spv::DimBuffer, spv::DimSubpassData};
+    const uint32_t    Sampled[] = {0, 1, 2, 1, 2};
+    for (size_t i = 0; i < _countof(Names); ++i)
+    {
+        const auto ImageType = Asm.NewId();
+        const auto PtrType   = Asm.NewId();
+        const auto Var       = Asm.NewId();
+        Asm.Emit(spv::OpName, {Var}, Names[i]);
+        Asm.Emit(spv::OpTypeImage, {ImageType, Float, Dims[i], 0, 0, 0, Sampled[i], 0});
+        Asm.Emit(spv::OpTypePointer, {PtrType, spv::StorageClassUniformConstant, ImageType});
+        Asm.Emit(spv::OpVariable, {PtrType, Var, spv::StorageClassUniformConstant});
+    }
+
+    SPIRVReflection Reflection{Asm.GetSPIRV()};
+    EXPECT_EQ(GetResourceNames(Reflection, SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_IMAGE),
+              (std::vector<std::string>{"g_RuntimeSampled", "g_Texture", "g_TexelBuffer"}));
+    EXPECT_EQ(GetResourceNames(Reflection, SPIRVReflection::RESOURCE_CATEGORY_STORAGE_IMAGE),
+              (std::vector<std::string>{"g_RWTexture"}));
+
+    Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_IMAGE,
+        [](const SPIRVReflection::ResourceInfo& Res)
+        {
+            EXPECT_EQ(Res.IsTexelBuffer, strcmp(Res.Name, "g_TexelBuffer") == 0) << Res.Name;
+        });
+}
+
+TEST(SPIRVReflectionTest, ArraySize)
+{
+    SPIRVAssembler Asm;
+    const auto Uint     = Asm.NewId();
+    const auto Len2     = Asm.NewId();
+    const auto Len3     = Asm.NewId();
+    const auto Sampler  = Asm.NewId();
+    const auto Array3   = Asm.NewId();
+    const auto Array2x3 = Asm.NewId();
+    const auto RTArray  = Asm.NewId();
+    const auto Ptr2x3   = Asm.NewId();
+    const auto PtrRT    = Asm.NewId();
+    const auto Var2x3   = Asm.NewId();
+    const auto VarRT    = Asm.NewId();
+    Asm.Emit(spv::OpName, {Var2x3}, "g_Samplers");
+    Asm.Emit(spv::OpName, {VarRT}, "g_BindlessSamplers");
+    Asm.Emit(spv::OpTypeInt, {Uint, 32, 0});
+    Asm.Emit(spv::OpConstant, {Uint, Len2, 2});
+    Asm.Emit(spv::OpConstant, {Uint, Len3, 3});
+    Asm.Emit(spv::OpTypeSampler, {Sampler});
+    Asm.Emit(spv::OpTypeArray, {Array3, Sampler, Len3});
+    Asm.Emit(spv::OpTypeArray, {Array2x3, Array3, Len2});
+    Asm.Emit(spv::OpTypeRuntimeArray, {RTArray, Sampler});
+    Asm.Emit(spv::OpTypePointer, {Ptr2x3, spv::StorageClassUniformConstant, Array2x3});
+    Asm.Emit(spv::OpTypePointer, {PtrRT, spv::StorageClassUniformConstant, RTArray});
+    Asm.Emit(spv::OpVariable, {Ptr2x3, Var2x3, spv::StorageClassUniformConstant});
+    Asm.Emit(spv::OpVariable, {PtrRT, VarRT, spv::StorageClassUniformConstant});
+
+    SPIRVReflection Reflection{Asm.GetSPIRV()};
+    std::vector<std::pair<std::string, Uint32>> Samplers;
+    Reflection.ProcessResources(SPIRVReflection::RESOURCE_CATEGORY_SEPARATE_SAMPLER,
+        [&](const SPIRVReflection::ResourceInfo& Res)
+        {
+            EXPECT_EQ(Res.TypeId, Sampler);
+            Samplers.emplace_back(Res.Name, Res.ArraySize);
+        });
+    // The size of the innermost dimension is reported, runtime arrays have zero size
+    EXPECT_EQ(Samplers, (std::vector<std::pair<std::string, Uint32>>{{"g_Samplers", 3}, {"g_BindlessSamplers", 0}}));
+}
+
+TEST(SPIRVReflectionTest, CyclicTypes)
+{
+    // The pointer type points to itself
+    {
+        SPIRVAssembler Asm;
+        const auto PtrType = Asm.NewId();
+        const auto Var     = Asm.NewId();
+        Asm.Emit(spv::OpTypePointer, {PtrType, spv::StorageClassUniformConstant, PtrType});
+        Asm.Emit(spv::OpVariable, {PtrType, Var, spv::StorageClassUniformConstant});
+        EXPECT_THROW(SPIRVReflection{Asm.GetSPIRV()}, std::runtime_error);
+    }
+
+    // Two array types reference each other
+    {
+        SPIRVAssembler Asm;
+        const auto Uint    = Asm.NewId();
+        const auto Len     = Asm.NewId();
+        const auto Array0  = Asm.NewId();
+        const auto Array1  = Asm.NewId();
+        const auto PtrType = Asm.NewId();
+        const auto Var     = Asm.NewId();
+        Asm.Emit(spv::OpTypeInt, {Uint, 32, 0});
+        Asm.Emit(spv::OpConstant, {Uint, Len, 4});
+        Asm.Emit(spv::OpTypeArray, {Array0, Array1, Len});
+        Asm.Emit(spv::OpTypeArray, {Array1, Array0, Len});
+        Asm.Emit(spv::OpTypePointer, {PtrType, spv::StorageClassUniformConstant, Array0});
+        Asm.Emit(spv::OpVariable, {PtrType, Var, spv::StorageClassUniformConstant});
+        EXPECT_THROW(SPIRVReflection{Asm.GetSPIRV()}, std::runtime_error);
+    }
+}
+
+TEST(SPIRVReflectionTest, InvalidBinary)
+{
+    EXPECT_THROW(SPIRVReflection{std::vector<uint32_t>{}}, std::runtime_error);
+    EXPECT_THROW(SPIRVReflection{std::vector<uint32_t>(5, 0)}, std::runtime_error);
+
+    // The instruction extends past the end of the binary
+    SPIRVAssembler Asm;
+    const auto Float = Asm.NewId();
+    Asm.Emit(spv::OpTypeFloat, {Float, 32});
+    auto SPIRV = Asm.GetSPIRV();
+    SPIRV.pop_back();
+    EXPECT_THROW(SPIRVReflection{SPIRV}, std::runtime_error);
+}
+
+// Builds a pixel shader module that declares resources of every type and two stage inputs.
+// Every resource has binding and descriptor set decorations, as serialized resources require.
+std::vector<uint32_t> BuildResourceModule()
+{
+    SPIRVAssembler Asm;
+    const auto Main = Asm.NewId();
+
+    struct Resource
+    {
+        const char* Name;
+        uint32_t    Var;
+    };
+    std::vector<Resource> Resources;
+    auto AddResource = [&](const char* Name)
+    {
+        Resources.push_back({Name, Asm.NewId()});
+        return Resources.back().Var;
+    };
+    const auto VarUB         = AddResource(nullptr); // glslang does not name the instance of the HLSL cbuffer
+    const auto VarROBuffer   = AddResource("g_ROBuffer");
+    const auto VarRWBuffer   = AddResource("g_RWBuffer");
+    const auto VarRWTexture  = AddResource("g_RWTexture");
+    const auto VarRWTexelBuf = AddResource("g_RWTexelBuffer");
+    const auto VarCombined   = AddResource("g_CombinedTexture");
+    const auto VarCounter    = AddResource("g_Counter");
+    const auto VarSampler    = AddResource("g_Texture_sampler");
+    const auto VarTexture    = AddResource("g_Texture");
+    const auto VarTexelBuf   = AddResource("g_TexelBuffer");
+
+    const auto VarPos = Asm.NewId();
+    const auto VarUV  = Asm.NewId();
+
+    Asm.Emit(spv::OpCapability, {spv::CapabilityShader});
+    Asm.Emit(spv::OpExtension, {}, "SPV_GOOGLE_hlsl_functionality1");
+    Asm.Emit(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+    Asm.Emit(spv::OpEntryPoint, {spv::ExecutionModelFragment, Main}, "main", {VarPos, VarUV});
+    Asm.Emit(spv::OpSource, {spv::SourceLanguageHLSL, 500});
+
+    const auto Float       = Asm.NewId();
+    const auto Uint        = Asm.NewId();
+    const auto Len4        = Asm.NewId();
+    const auto Float4      = Asm.NewId();
+    const auto UBType      = Asm.NewId();
+    const auto ROBufType   = Asm.NewId();
+    const auto RWBufType   = Asm.NewId();
+    const auto RTArray     = Asm.NewId();
+    const auto Tex2D       = Asm.NewId();
+    const auto RWTex2D     = Asm.NewId();
+    const auto TexBuf      = Asm.NewId();
+    const auto RWTexBuf    = Asm.NewId();
+    const auto SmplImg     = Asm.NewId();
+    const auto Sampler     = Asm.NewId();
+    const auto Tex2DArray4 = Asm.NewId();
+
+    Asm.Emit(spv::OpName, {UBType}, "Constants");
+    for (const auto& Res : Resources)
+    {
+        if (Res.Name != nullptr)
+            Asm.Emit(spv::OpName, {Res.Var}, Res.Name);
+    }
+    Asm.Emit(spv::OpName, {VarPos}, "in.var.ATTRIB0");
+    Asm.Emit(spv::OpName, {VarUV}, "in.var.TEXCOORD");
+
+    for (size_t i = 0; i < Resources.size(); ++i)
+    {
+        Asm.Emit(spv::OpDecorate, {Resources[i].Var, spv::DecorationDescriptorSet, static_cast<uint32_t>(i % 2)});
+        Asm.Emit(spv::OpDecorate, {Resources[i].Var, spv::DecorationBinding, static_cast<uint32_t>(i)});
+    }
+    Asm.Emit(spv::OpDecorate, {VarPos, spv::DecorationLocation, 0});
+    Asm.Emit(spv::OpDecorate, {VarUV, spv::DecorationLocation, 1});
+    Asm.Emit(spv::OpDecorateStringGOOGLE, {VarPos, spv::DecorationHlslSemanticGOOGLE}, "ATTRIB0");
+    Asm.Emit(spv::OpDecorateStringGOOGLE, {VarUV, spv::DecorationHlslSemanticGOOGLE}, "TEXCOORD");
+    Asm.Emit(spv::OpDecorate, {UBType, spv::DecorationBlock});
+    Asm.Emit(spv::OpDecorate, {ROBufType, spv::DecorationBufferBlock});
+    Asm.Emit(spv::OpMemberDecorate, {ROBufType, 0, spv::DecorationNonWritable});
+    Asm.Emit(spv::OpDecorate, {RWBufType, spv::DecorationBufferBlock});
+
+    Asm.Emit(spv::OpTypeFloat, {Float, 32});
+    Asm.Emit(spv::OpTypeInt, {Uint, 32, 0});
+    Asm.Emit(spv::OpConstant, {Uint, Len4, 4});
+    Asm.Emit(spv::OpTypeVector, {Float4, Float, 4});
+    Asm.Emit(spv::OpTypeStruct, {UBType, Float4});
+    Asm.Emit(spv::OpTypeRuntimeArray, {RTArray, Float4});
+    Asm.Emit(spv::OpTypeStruct, {ROBufType, RTArray});
+    Asm.Emit(spv::OpTypeStruct, {RWBufType, RTArray});
+    Asm.Emit(spv::OpTypeImage, {Tex2D, Float, spv::Dim2D, 0, 0, 0, 1, 0});
+    Asm.Emit(spv::OpTypeImage, {RWTex2D, Float, spv::Dim2D, 0, 0, 0, 2, 0});
+    Asm.Emit(spv::OpTypeImage, {TexBuf, Float, spv::DimBuffer, 0, 0, 0, 1, 0});
+    Asm.Emit(spv::OpTypeImage, {RWTexBuf, Float, spv::DimBuffer, 0, 0, 0, 2, 0});
+    Asm.Emit(spv::OpTypeSampledImage, {SmplImg, Tex2D});
+    Asm.Emit(spv::OpTypeSampler, {Sampler});
+    Asm.Emit(spv::OpTypeArray, {Tex2DArray4, Tex2D, Len4});
+
+    auto DeclareVariable = [&](uint32_t Var, uint32_t Type, spv::StorageClass StorageClass)
+    {
+        const auto PtrType = Asm.NewId();
+        Asm.Emit(spv::OpTypePointer, {PtrType, StorageClass, Type});
+        Asm.Emit(spv::OpVariable, {PtrType, Var, StorageClass});
+    };
+    DeclareVariable(VarUB,         UBType,      spv::StorageClassUniform);
+    DeclareVariable(VarROBuffer,   ROBufType,   spv::StorageClassUniform);
+    DeclareVariable(VarRWBuffer,   RWBufType,   spv::StorageClassUniform);
+    DeclareVariable(VarRWTexture,  RWTex2D,     spv::StorageClassUniformConstant);
+    DeclareVariable(VarRWTexelBuf, RWTexBuf,    spv::StorageClassUniformConstant);
+    DeclareVariable(VarCombined,   SmplImg,     spv::StorageClassUniformConstant);
+    DeclareVariable(VarCounter,    Uint,        spv::StorageClassAtomicCounter);
+    DeclareVariable(VarSampler,    Sampler,     spv::StorageClassUniformConstant);
+    DeclareVariable(VarTexture,    Tex2DArray4, spv::StorageClassUniformConstant);
+    DeclareVariable(VarTexelBuf,   TexBuf,      spv::StorageClassUniformConstant);
+    DeclareVariable(VarPos,        Float4,      spv::StorageClassInput);
+    DeclareVariable(VarUV,         Float4,      spv::StorageClassInput);
+
+    return Asm.GetSPIRV();
+}
+
+void CompareResources(const SPIRVShaderResources& Ref, const SPIRVShaderResources& Loaded)
+{
+    EXPECT_EQ(Loaded.GetNumUBs(),       Ref.GetNumUBs());
+    EXPECT_EQ(Loaded.GetNumSBs(),       Ref.GetNumSBs());
+    EXPECT_EQ(Loaded.GetNumImgs(),      Ref.GetNumImgs());
+    EXPECT_EQ(Loaded.GetNumSmpldImgs(), Ref.GetNumSmpldImgs());
+    EXPECT_EQ(Loaded.GetNumACs(),       Ref.GetNumACs());
+    EXPECT_EQ(Loaded.GetNumSepSmplrs(), Ref.GetNumSepSmplrs());
+    EXPECT_EQ(Loaded.GetNumSepImgs(),   Ref.GetNumSepImgs());
+    ASSERT_EQ(Loaded.GetTotalResources(), Ref.GetTotalResources());
+    for (Uint32 n = 0; n < Ref.GetTotalResources(); ++n)
+    {
+        const auto& RefRes    = Ref.GetResource(n);
+        const auto& LoadedRes = Loaded.GetResource(n);
+        // Names are interned, so they must be the same pointers
+        EXPECT_EQ(LoadedRes.Name, RefRes.Name) << RefRes.Name;
+        EXPECT_EQ(LoadedRes.ArraySize, RefRes.ArraySize) << RefRes.Name;
+        EXPECT_EQ(LoadedRes.Type, RefRes.Type) << RefRes.Name;
+        EXPECT_EQ(LoadedRes.GetSepSmplrOrImgInd(), RefRes.GetSepSmplrOrImgInd()) << RefRes.Name;
+        EXPECT_EQ(LoadedRes.BindingDecorationOffset, RefRes.BindingDecorationOffset) << RefRes.Name;
+        EXPECT_EQ(LoadedRes.DescriptorSetDecorationOffset, RefRes.DescriptorSetDecorationOffset) << RefRes.Name;
+    }
+
+    ASSERT_EQ(Loaded.GetNumShaderStageInputs(), Ref.GetNumShaderStageInputs());
+    for (Uint32 i = 0; i < Ref.GetNumShaderStageInputs(); ++i)
+    {
+        const auto& RefInput    = Ref.GetShaderStageInputAttribs(i);
+        const auto& LoadedInput = Loaded.GetShaderStageInputAttribs(i);
+        EXPECT_STREQ(LoadedInput.Semantic, RefInput.Semantic);
+        EXPECT_EQ(LoadedInput.LocationDecorationOffset, RefInput.LocationDecorationOffset);
+    }
+
+    EXPECT_EQ(Loaded.GetShaderType(), Ref.GetShaderType());
+    EXPECT_STREQ(Loaded.GetShaderName(), Ref.GetShaderName());
+    ASSERT_EQ(Loaded.IsUsingCombinedSamplers(), Ref.IsUsingCombinedSamplers());
+    if (Ref.IsUsingCombinedSamplers())
+    {
+        EXPECT_STREQ(Loaded.GetCombinedSamplerSuffix(), Ref.GetCombinedSamplerSuffix());
+    }
+    EXPECT_TRUE(Loaded.IsCompatibleWith(Ref));
+}
+
+TEST(SPIRVShaderResourcesTest, SerializationRoundTrip)
+{
+    const auto SPIRV     = BuildResourceModule();
+    auto&      Allocator = DefaultRawMemoryAllocator::GetAllocator();
+
+    ShaderDesc Desc;
+    Desc.Name       = "Round trip test shader";
+    Desc.ShaderType = SHADER_TYPE_PIXEL;
+
+    for (const char* CombinedSamplerSuffix : {"_sampler", static_cast<const char*>(nullptr)})
+    {
+        std::string EntryPoint;
+        const SPIRVShaderResources Resources{Allocator, nullptr, SPIRV, Desc, CombinedSamplerSuffix, true, EntryPoint};
+        EXPECT_EQ(EntryPoint, "main");
+
+        // Every section must be populated for the test to be meaningful
+        EXPECT_EQ(Resources.GetNumUBs(),       1u);
+        EXPECT_EQ(Resources.GetNumSBs(),       2u);
+        EXPECT_EQ(Resources.GetNumImgs(),      2u);
+        EXPECT_EQ(Resources.GetNumSmpldImgs(), 1u);
+        EXPECT_EQ(Resources.GetNumACs(),       1u);
+        EXPECT_EQ(Resources.GetNumSepSmplrs(), 1u);
+        EXPECT_EQ(Resources.GetNumSepImgs(),   2u);
+        EXPECT_EQ(Resources.GetNumShaderStageInputs(), 2u);
+        EXPECT_STREQ(Resources.GetUB(0).Name, "Constants");
+        EXPECT_EQ(Resources.GetSB(0).Type, SPIRVShaderResourceAttribs::ResourceType::ROStorageBuffer);
+        EXPECT_EQ(Resources.GetSB(1).Type, SPIRVShaderResourceAttribs::ResourceType::RWStorageBuffer);
+        EXPECT_EQ(Resources.GetImg(1).Type, SPIRVShaderResourceAttribs::ResourceType::StorageTexelBuffer);
+        EXPECT_EQ(Resources.GetSepImg(0).ArraySize, 4u);
+        EXPECT_EQ(Resources.GetSepImg(1).Type, SPIRVShaderResourceAttribs::ResourceType::UniformTexelBuffer);
+        if (CombinedSamplerSuffix != nullptr)
+        {
+            EXPECT_EQ(Resources.GetSepImg(0).GetAssignedSepSamplerInd(), 0u);
+        }
+
+        std::vector<Uint8> Data;
+        Resources.Serialize(EntryPoint, SPIRV.size(), Data);
+
+        std::string LoadedEntryPoint;
+        SPIRVShaderResources LoadedResources{Allocator, SPIRV, Data.data(), Data.size(), Desc, LoadedEntryPoint};
+        EXPECT_EQ(LoadedEntryPoint, EntryPoint);
+        CompareResources(Resources, LoadedResources);
+    }
+}
+
+TEST(SPIRVShaderResourcesTest, RejectResourceInWrongSection)
+{
+    const auto SPIRV     = BuildResourceModule();
+    auto&      Allocator = DefaultRawMemoryAllocator::GetAllocator();
+
+    ShaderDesc Desc;
+    Desc.Name       = "Invalid serialized resources test shader";
+    Desc.ShaderType = SHADER_TYPE_PIXEL;
+
+    std::string EntryPoint;
+    const SPIRVShaderResources Resources{Allocator, nullptr, SPIRV, Desc, "_sampler", true, EntryPoint};
+    std::vector<Uint8> Data;
+    Resources.Serialize(EntryPoint, SPIRV.size(), Data);
+
+    // The serialized data starts with 44-byte header followed by 20-byte resource attributes.
+    // The type is the byte at offset 6 in the attributes.
+    auto SetResourceType = [&](std::vector<Uint8>& ModifiedData, Uint32 n, SPIRVShaderResourceAttribs::ResourceType Type)
+    {
+        ModifiedData[44 + n * 20 + 6] = static_cast<Uint8>(Type);
+    };
+
+    auto GetIndex = [&](const SPIRVShaderResourceAttribs& Res)
+    {
+        return static_cast<Uint32>(&Res - &Resources.GetResource(0));
+    };
+    const auto SBInd     = GetIndex(Resources.GetSB(1));
+    const auto SepImgInd = GetIndex(Resources.GetSepImg(0));
+    const auto TexBufInd = GetIndex(Resources.GetSepImg(1));
+
+    const struct
+    {
+        Uint32                                   Index;
+        SPIRVShaderResourceAttribs::ResourceType Type;
+    } Modifications[] =
+    {
+        {0,         SPIRVShaderResourceAttribs::ResourceType::SeparateImage},
+        {SBInd,     SPIRVShaderResourceAttribs::ResourceType::UniformBuffer},
+        {SepImgInd, SPIRVShaderResourceAttribs::ResourceType::SeparateSampler},
+        {TexBufInd, SPIRVShaderResourceAttribs::ResourceType::StorageTexelBuffer}
+    };
+    for (const auto& Modification : Modifications)
+    {
+        auto ModifiedData = Data;
+        SetResourceType(ModifiedData, Modification.Index, Modification.Type);
+        std::string LoadedEntryPoint;
+        EXPECT_THROW(SPIRVShaderResources(Allocator, SPIRV, ModifiedData.data(), ModifiedData.size(), Desc, LoadedEntryPoint), std::runtime_error)
+            << "Resource " << Modification.Index << ", type " << static_cast<int>(Modification.Type);
+    }
+
+    // The unmodified data must load
+    std::string LoadedEntryPoint;
+    SPIRVShaderResources LoadedResources{Allocator, SPIRV, Data.data(), Data.size(), Desc, LoadedEntryPoint};
+    CompareResources(Resources, LoadedResources);
+}
+
+} // namespace
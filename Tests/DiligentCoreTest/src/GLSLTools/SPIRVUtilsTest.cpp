@@ -0,0 +1,206 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#include "SPIRVUtils.h"
+#include "SPIRVReflection.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+const char* const GLSLSource = R"(
+#version 450
+layout(local_size_x = 64) in;
+layout(std430, binding = 0) buffer Data
+{
+    float Values[];
+};
+void main()
+{
+    Values[gl_GlobalInvocationID.x] *= 2.0;
+}
+)";
+
+const char* const HLSLSource = R"(
+Texture2D    g_Texture;
+SamplerState g_Texture_sampler;
+cbuffer Constants
+{
+    float4 g_Scale;
+};
+float4 main(in float4 Pos : SV_Position, in float2 UV : TEXCOORD) : SV_Target
+{
+    return g_Texture.Sample(g_Texture_sampler, UV) * g_Scale;
+}
+)";
+
+std::vector<unsigned int> CompileGLSL()
+{
+    return GLSLtoSPIRV(SHADER_TYPE_COMPUTE, GLSLSource, static_cast<int>(strlen(GLSLSource)), nullptr);
+}
+
+std::vector<unsigned int> CompileHLSL()
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.Source          = HLSLSource;
+    ShaderCI.EntryPoint      = "main";
+    ShaderCI.SourceLanguage  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+    return HLSLtoSPIRV(ShaderCI, nullptr);
+}
+
+constexpr size_t NumThreads           = 8;
+constexpr size_t NumCompilesPerThread = 16;
+
+// Compiles the shaders from several threads and verifies that every thread gets
+// the same byte code as the single-threaded compilation
+void RunConcurrentCompilation(bool InitializePerThread)
+{
+    InitializeGlslang();
+    const auto RefGLSL = CompileGLSL();
+    const auto RefHLSL = CompileHLSL();
+    ASSERT_FALSE(RefGLSL.empty());
+    ASSERT_FALSE(RefHLSL.empty());
+    if (InitializePerThread)
+        FinalizeGlslang();
+
+    std::atomic<Uint32> NumMismatches{0};
+    std::vector<std::thread> Threads;
+    for (size_t t = 0; t < NumThreads; ++t)
+    {
+        Threads.emplace_back(
+            [&, t]()
+            {
+                for (size_t i = 0; i < NumCompilesPerThread; ++i)
+                {
+                    // With per-thread initialization, the last thread to finalize shuts glslang
+                    // down and the next one to initialize starts it again
+                    if (InitializePerThread)
+                        InitializeGlslang();
+
+                    const bool UseHLSL = (t + i) % 2 != 0;
+                    const auto SPIRV   = UseHLSL ? CompileHLSL() : CompileGLSL();
+                    if (SPIRV != (UseHLSL ? RefHLSL : RefGLSL))
+                        ++NumMismatches;
+
+                    if (InitializePerThread)
+                        FinalizeGlslang();
+                }
+            });
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+
+    if (!InitializePerThread)
+        FinalizeGlslang();
+
+    EXPECT_EQ(NumMismatches.load(), 0u);
+}
+
+TEST(SPIRVUtilsTest, ConcurrentCompilation)
+{
+    RunConcurrentCompilation(false);
+}
+
+TEST(SPIRVUtilsTest, ConcurrentInitializeAndFinalize)
+{
+    RunConcurrentCompilation(true);
+}
+
+// Returns a string that lists the name, array size, descriptor set and binding of every resource
+// in the module, one resource per line
+std::string DescribeResources(const std::vector<unsigned int>& SPIRV)
+{
+    SPIRVReflection Reflection{SPIRV};
+
+    std::string Description;
+    for (Uint32 Category = SPIRVReflection::RESOURCE_CATEGORY_UNIFORM_BUFFER; Category < SPIRVReflection::RESOURCE_CATEGORY_STAGE_INPUT; ++Category)
+    {
+        Reflection.ProcessResources(static_cast<SPIRVReflection::RESOURCE_CATEGORY>(Category),
+            [&](const SPIRVReflection::ResourceInfo& Res)
+            {
+                const auto Set     = Res.DescriptorSetDecorationOffset != 0 ? static_cast<int>(SPIRV[Res.DescriptorSetDecorationOffset]) : -1;
+                const auto Binding = Res.BindingDecorationOffset       != 0 ? static_cast<int>(SPIRV[Res.BindingDecorationOffset])       : -1;
+                Description += std::to_string(Category) + ' ' + Res.Name + '[' + std::to_string(Res.ArraySize) + "] set=" +
+                               std::to_string(Set) + " binding=" + std::to_string(Binding) + '\n';
+            });
+    }
+    return Description;
+}
+
+// Checks that the optimizer keeps the names and binding decorations that are used to
+// match shader resources with the pipeline resource layout
+TEST(SPIRVUtilsTest, OptimizationKeepsResources)
+{
+    InitializeGlslang();
+    const std::vector<unsigned int> Modules[] = {CompileGLSL(), CompileHLSL()};
+    FinalizeGlslang();
+
+    const std::pair<SPIRV_OPTIMIZATION_LEVEL, const char*> Levels[] =
+    {
+        {SPIRV_OPTIMIZATION_LEVEL_NONE,        nullptr},
+        {SPIRV_OPTIMIZATION_LEVEL_SIZE,        nullptr},
+        {SPIRV_OPTIMIZATION_LEVEL_PERFORMANCE, nullptr},
+        {SPIRV_OPTIMIZATION_LEVEL_CUSTOM,      "--eliminate-dead-code-aggressive --merge-blocks"}
+    };
+
+    for (const auto& SPIRV : Modules)
+    {
+        ASSERT_FALSE(SPIRV.empty());
+        const auto RefResources = DescribeResources(SPIRV);
+        EXPECT_FALSE(RefResources.empty());
+        for (const auto& Level : Levels)
+        {
+            const auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, Level.first, Level.second);
+            ASSERT_FALSE(OptimizedSPIRV.empty()) << "Optimization level " << static_cast<int>(Level.first);
+            EXPECT_EQ(DescribeResources(OptimizedSPIRV), RefResources) << "Optimization level " << static_cast<int>(Level.first);
+        }
+    }
+}
+
+TEST(SPIRVUtilsTest, NestedInitialization)
+{
+    InitializeGlslang();
+    InitializeGlslang();
+    FinalizeGlslang();
+    // glslang must still be initialized by the first call
+    EXPECT_FALSE(CompileGLSL().empty());
+    FinalizeGlslang();
+
+    // Initialize glslang again after it has been finalized
+    InitializeGlslang();
+    EXPECT_FALSE(CompileHLSL().empty());
+    FinalizeGlslang();
+}
+
+} // namespace
@@ -0,0 +1,260 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "ResourceReleaseQueue.h"
+#include "DefaultRawMemoryAllocator.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+using TestReleaseQueue = ResourceReleaseQueue<DynamicStaleResourceWrapper>;
+
+// Resource that counts how many times it has been destroyed and moved
+template<size_t PayloadSize>
+class TestResource
+{
+public:
+    struct Counters
+    {
+        std::atomic<int> NumDestroyed{0};
+        std::atomic<int> NumMoved    {0};
+    };
+
+    explicit TestResource(Counters& Cnt) noexcept :
+        m_pCounters{&Cnt}
+    {}
+
+    TestResource(TestResource&& rhs) noexcept :
+        m_pCounters{rhs.m_pCounters}
+    {
+        rhs.m_pCounters = nullptr;
+        ++m_pCounters->NumMoved;
+    }
+
+    TestResource             (const TestResource&) = delete;
+    TestResource& operator = (const TestResource&) = delete;
+    TestResource& operator = (TestResource&&)      = delete;
+
+    ~TestResource()
+    {
+        // Moved-from objects do not own the resource
+        if (m_pCounters != nullptr)
+            ++m_pCounters->NumDestroyed;
+    }
+
+private:
+    Counters* m_pCounters;
+    Uint8     m_Payload[PayloadSize] = {};
+};
+
+// Fits into the inline storage of the wrapper
+using SmallResource = TestResource<2 * sizeof(void*)>;
+// Does not fit into the inline storage and is allocated from the heap
+using LargeResource = TestResource<DynamicStaleResourceWrapper::InlineStorageSize>;
+
+TEST(DynamicStaleResourceWrapper, DestroyInline)
+{
+    SmallResource::Counters Cnt;
+    {
+        auto Wrapper = DynamicStaleResourceWrapper::Create(SmallResource{Cnt}, 1);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+    }
+    EXPECT_EQ(Cnt.NumDestroyed, 1);
+}
+
+TEST(DynamicStaleResourceWrapper, DestroyHeap)
+{
+    LargeResource::Counters Cnt;
+    {
+        auto Wrapper = DynamicStaleResourceWrapper::Create(LargeResource{Cnt}, 1);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+    }
+    EXPECT_EQ(Cnt.NumDestroyed, 1);
+}
+
+TEST(DynamicStaleResourceWrapper, MoveInline)
+{
+    SmallResource::Counters Cnt;
+    {
+        auto Wrapper0   = DynamicStaleResourceWrapper::Create(SmallResource{Cnt}, 1);
+        const int Moves = Cnt.NumMoved;
+
+        // The resource lives in the inline storage, so moving the wrapper moves the resource
+        DynamicStaleResourceWrapper Wrapper1{std::move(Wrapper0)};
+        EXPECT_EQ(Cnt.NumMoved, Moves + 1);
+        DynamicStaleResourceWrapper Wrapper2{std::move(Wrapper1)};
+        EXPECT_EQ(Cnt.NumMoved, Moves + 2);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+    }
+    // Moved-from wrappers must not destroy the resource
+    EXPECT_EQ(Cnt.NumDestroyed, 1);
+}
+
+TEST(DynamicStaleResourceWrapper, MoveHeap)
+{
+    LargeResource::Counters Cnt;
+    {
+        auto Wrapper0   = DynamicStaleResourceWrapper::Create(LargeResource{Cnt}, 1);
+        const int Moves = Cnt.NumMoved;
+
+        // Only the pointer is moved
+        DynamicStaleResourceWrapper Wrapper1{std::move(Wrapper0)};
+        EXPECT_EQ(Cnt.NumMoved, Moves);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+    }
+    EXPECT_EQ(Cnt.NumDestroyed, 1);
+}
+
+TEST(DynamicStaleResourceWrapper, SharedBetweenQueues)
+{
+    // The resource is released into two queues, the same way RenderDeviceNextGenBase::SafeReleaseDeviceObject()
+    // releases objects whose queue mask has more than one bit set. Small resources must not be kept
+    // inline in this case, and the resource must only be destroyed when both queues have released it.
+    for (int i = 0; i < 2; ++i)
+    {
+        SmallResource::Counters Cnt;
+        TestReleaseQueue Queue0{DefaultRawMemoryAllocator::GetAllocator()};
+        TestReleaseQueue Queue1{DefaultRawMemoryAllocator::GetAllocator()};
+        {
+            auto Wrapper = DynamicStaleResourceWrapper::Create(SmallResource{Cnt}, 2);
+            Queue0.SafeReleaseResource(Wrapper, 1);
+            Queue1.SafeReleaseResource(Wrapper, 1);
+            Wrapper.GiveUpOwnership();
+        }
+        EXPECT_EQ(Queue0.GetStaleResourceCount(), 1u);
+        EXPECT_EQ(Queue1.GetStaleResourceCount(), 1u);
+
+        auto& FirstQueue  = i == 0 ? Queue0 : Queue1;
+        auto& SecondQueue = i == 0 ? Queue1 : Queue0;
+
+        FirstQueue.DiscardStaleResources(1, 10);
+        FirstQueue.Purge(10);
+        EXPECT_EQ(FirstQueue.GetPendingReleaseResourceCount(), 0u);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+
+        SecondQueue.DiscardStaleResources(1, 20);
+        SecondQueue.Purge(19);
+        EXPECT_EQ(Cnt.NumDestroyed, 0);
+        SecondQueue.Purge(20);
+        EXPECT_EQ(Cnt.NumDestroyed, 1);
+    }
+}
+
+TEST(ResourceReleaseQueue, StaleResources)
+{
+    SmallResource::Counters SmallCnt;
+    LargeResource::Counters LargeCnt;
+    TestReleaseQueue Queue{DefaultRawMemoryAllocator::GetAllocator()};
+
+    Queue.SafeReleaseResource(SmallResource{SmallCnt}, 1);
+    Queue.SafeReleaseResource(LargeResource{LargeCnt}, 2);
+    EXPECT_EQ(Queue.GetStaleResourceCount(), 2u);
+
+    // Only resources released before command buffer 1 was submitted are moved to the release queue
+    Queue.DiscardStaleResources(1, 100);
+    EXPECT_EQ(Queue.GetStaleResourceCount(), 1u);
+    EXPECT_EQ(Queue.GetPendingReleaseResourceCount(), 1u);
+
+    Queue.DiscardStaleResources(2, 200);
+    EXPECT_EQ(Queue.GetStaleResourceCount(), 0u);
+    EXPECT_EQ(Queue.GetPendingReleaseResourceCount(), 2u);
+
+    Queue.Purge(99);
+    EXPECT_EQ(SmallCnt.NumDestroyed + LargeCnt.NumDestroyed, 0);
+    Queue.Purge(100);
+    EXPECT_EQ(SmallCnt.NumDestroyed, 1);
+    EXPECT_EQ(LargeCnt.NumDestroyed, 0);
+    Queue.Purge(200);
+    EXPECT_EQ(LargeCnt.NumDestroyed, 1);
+    EXPECT_EQ(Queue.GetPendingReleaseResourceCount(), 0u);
+}
+
+TEST(ResourceReleaseQueue, StagingQueueOverflow)
+{
+    // When the staging queue is full, resources are added to the locked list.
+    // The order of release must not matter for the fence semantics.
+    SmallResource::Counters Cnt;
+    TestReleaseQueue Queue{DefaultRawMemoryAllocator::GetAllocator(), 4};
+    for (int i = 0; i < 10; ++i)
+        Queue.DiscardResource(SmallResource{Cnt}, 1 + i % 2);
+    EXPECT_EQ(Queue.GetPendingReleaseResourceCount(), 10u);
+
+    Queue.Purge(0);
+    EXPECT_EQ(Cnt.NumDestroyed, 0);
+    Queue.Purge(2);
+    EXPECT_EQ(Cnt.NumDestroyed, 10);
+}
+
+TEST(ResourceReleaseQueue, ConcurrentRelease)
+{
+    constexpr size_t NumThreads        = 4;
+    constexpr size_t ReleasesPerThread = 20000;
+
+    SmallResource::Counters SmallCnt;
+    LargeResource::Counters LargeCnt;
+    TestReleaseQueue Queue{DefaultRawMemoryAllocator::GetAllocator(), 256};
+
+    std::atomic<size_t> NumFinished{0};
+    std::vector<std::thread> Threads;
+    for (size_t t = 0; t < NumThreads; ++t)
+    {
+        Threads.emplace_back(
+            [&, t]()
+            {
+                for (size_t i = 0; i < ReleasesPerThread; ++i)
+                {
+                    if ((t + i) % 2 == 0)
+                        Queue.SafeReleaseResource(SmallResource{SmallCnt}, 1);
+                    else
+                        Queue.DiscardResource(LargeResource{LargeCnt}, 1);
+                }
+                ++NumFinished;
+            });
+    }
+
+    // Drain the queues while the producers are running
+    while (NumFinished.load() != NumThreads)
+    {
+        Queue.DiscardStaleResources(1, 1);
+        Queue.Purge(1);
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+    Queue.DiscardStaleResources(1, 1);
+    Queue.Purge(1);
+
+    EXPECT_EQ(SmallCnt.NumDestroyed + LargeCnt.NumDestroyed, static_cast<int>(NumThreads * ReleasesPerThread));
+    EXPECT_EQ(Queue.GetStaleResourceCount(), 0u);
+    EXPECT_EQ(Queue.GetPendingReleaseResourceCount(), 0u);
+}
+
+} // namespace
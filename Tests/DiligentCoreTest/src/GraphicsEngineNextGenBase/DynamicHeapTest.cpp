@@ -0,0 +1,255 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <random>
+#include <chrono>
+
+#include "DynamicHeap.h"
+#include "ResourceReleaseQueue.h"
+#include "DefaultRawMemoryAllocator.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+class TestMasterBlockManager : public DynamicHeap::MasterBlockListBasedManager
+{
+public:
+    using TBase = DynamicHeap::MasterBlockListBasedManager;
+
+    TestMasterBlockManager(Uint32 Size, Uint32 PageSize, Uint32 PageAlignment) :
+        TBase{DefaultRawMemoryAllocator::GetAllocator(), Size, PageSize, PageAlignment}
+    {}
+
+    using TBase::AllocateMasterBlock;
+};
+
+using TestReleaseQueue = ResourceReleaseQueue<DynamicStaleResourceWrapper>;
+
+// Plays the role of the render device in MasterBlockListBasedManager::ReleaseMasterBlocks():
+// stale blocks are kept in the release queue until the fence value of the submission completes.
+struct TestReleaser
+{
+    TestReleaseQueue& ReleaseQueue;
+    const Uint64      FenceValue;
+
+    template<typename ObjectType>
+    void SafeReleaseDeviceObject(ObjectType&& Object, Uint64 /*QueueMask*/)
+    {
+        ReleaseQueue.DiscardResource(std::move(Object), FenceValue);
+    }
+};
+
+constexpr Uint32 PageSize      = 16 << 10;
+constexpr Uint32 PageAlignment = 1024;
+
+TEST(DynamicHeap_MasterBlockListBasedManager, RecyclesPages)
+{
+    TestReleaseQueue       ReleaseQueue{DefaultRawMemoryAllocator::GetAllocator()};
+    TestMasterBlockManager Mgr{PageSize * 8, PageSize, PageAlignment};
+
+    std::vector<TestMasterBlockManager::MasterBlock> Blocks;
+    Blocks.emplace_back(Mgr.AllocateMasterBlock(PageSize, PageAlignment));
+    ASSERT_TRUE(Blocks.back().IsValid());
+    const auto Offset = Blocks.back().UnalignedOffset;
+
+    TestReleaser Releaser{ReleaseQueue, 1};
+    Mgr.ReleaseMasterBlocks(Blocks, Releaser, 1);
+    Blocks.clear();
+
+    // The block must not be returned before the fence completes
+    ReleaseQueue.Purge(0);
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{PageSize});
+    ReleaseQueue.Purge(1);
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{0});
+
+    // The page is taken from the free page queue
+    Blocks.emplace_back(Mgr.AllocateMasterBlock(PageSize, 256));
+    ASSERT_TRUE(Blocks.back().IsValid());
+    EXPECT_EQ(Blocks.back().UnalignedOffset, Offset);
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{PageSize});
+
+    TestReleaser Releaser2{ReleaseQueue, 2};
+    Mgr.ReleaseMasterBlocks(Blocks, Releaser2, 1);
+    ReleaseQueue.Purge(2);
+}
+
+TEST(DynamicHeap_MasterBlockListBasedManager, ReturnsFreePagesToAllocator)
+{
+    constexpr Uint32 NumPages = 8;
+
+    TestReleaseQueue       ReleaseQueue{DefaultRawMemoryAllocator::GetAllocator()};
+    TestMasterBlockManager Mgr{PageSize * NumPages, PageSize, PageAlignment};
+
+    std::vector<TestMasterBlockManager::MasterBlock> Blocks;
+    for (Uint32 i = 0; i < NumPages; ++i)
+    {
+        Blocks.emplace_back(Mgr.AllocateMasterBlock(PageSize, PageAlignment));
+        ASSERT_TRUE(Blocks.back().IsValid());
+    }
+    EXPECT_FALSE(Mgr.AllocateMasterBlock(PageSize, PageAlignment).IsValid());
+
+    TestReleaser Releaser{ReleaseQueue, 1};
+    Mgr.ReleaseMasterBlocks(Blocks, Releaser, 1);
+    Blocks.clear();
+    ReleaseQueue.Purge(1);
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{0});
+
+    // All pages are in the free page queue. The allocation of the whole
+    // heap must return them to the allocator and merge the space.
+    Blocks.emplace_back(Mgr.AllocateMasterBlock(PageSize * NumPages, PageAlignment));
+    ASSERT_TRUE(Blocks.back().IsValid());
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{PageSize * NumPages});
+
+    TestReleaser Releaser2{ReleaseQueue, 2};
+    Mgr.ReleaseMasterBlocks(Blocks, Releaser2, 1);
+    ReleaseQueue.Purge(2);
+}
+
+// Several contexts allocate master blocks and release them at the end of every frame while
+// the "GPU" thread completes fences. Every 64-byte unit of the heap records its state, which
+// verifies that no block is handed out twice and that released blocks are not reused before
+// the fence of the submission that used them has completed.
+TEST(DynamicHeap_MasterBlockListBasedManager, MultithreadedFenceReclamation)
+{
+    constexpr Uint32 NumPages    = 256;
+    constexpr Uint32 HeapSize    = PageSize * NumPages;
+    constexpr Uint32 UnitSize    = 64;
+    constexpr Uint32 NumContexts = 8;
+    constexpr Uint32 NumFrames   = 500;
+
+    constexpr Uint64 PendingBit = Uint64{1} << 63;
+
+    TestReleaseQueue       ReleaseQueue{DefaultRawMemoryAllocator::GetAllocator()};
+    TestMasterBlockManager Mgr{HeapSize, PageSize, PageAlignment};
+
+    // 0 - free, PendingBit | FenceValue - released, other values - owned by the context
+    std::vector<std::atomic<Uint64>> Units(HeapSize / UnitSize);
+    for (auto& Unit : Units)
+        Unit.store(0);
+
+    std::atomic<Uint64> NextFenceValue{1};
+    std::atomic<Uint64> CompletedFenceValue{0};
+    std::atomic<bool>   Done{false};
+    std::atomic<Uint32> NumErrors{0};
+    std::atomic<Uint32> NumAllocations{0};
+
+    std::thread GPUThread{
+        [&]()
+        {
+            while (!Done.load())
+            {
+                // Complete all submissions made before the previous iteration
+                auto LastSubmitted = NextFenceValue.load() - 1;
+                std::this_thread::sleep_for(std::chrono::microseconds{200});
+                CompletedFenceValue.store(LastSubmitted);
+                ReleaseQueue.Purge(LastSubmitted);
+            }
+        }
+    };
+
+    std::vector<std::thread> Contexts;
+    for (Uint32 ctx = 0; ctx < NumContexts; ++ctx)
+    {
+        Contexts.emplace_back(
+            [&, ctx]()
+            {
+                const Uint64 OwnerTag = ctx + 1;
+                std::mt19937 Rnd{ctx};
+                std::vector<TestMasterBlockManager::MasterBlock> Blocks;
+                for (Uint32 frame = 0; frame < NumFrames; ++frame)
+                {
+                    const auto NumBlocks = 1 + Rnd() % 4;
+                    for (Uint32 b = 0; b < NumBlocks; ++b)
+                    {
+                        // Mostly pages, sometimes large blocks similar to VulkanDynamicHeap::Allocate()
+                        const bool   IsPage    = Rnd() % 4 != 0;
+                        const Uint32 Size      = IsPage ? PageSize : PageSize / 2 + UnitSize * (1 + Rnd() % 256);
+                        const Uint32 Alignment = IsPage ? PageAlignment : 256;
+
+                        TestMasterBlockManager::MasterBlock Block;
+                        for (Uint32 Attempt = 0; Attempt < 10000 && !Block.IsValid(); ++Attempt)
+                        {
+                            Block = Mgr.AllocateMasterBlock(Size, Alignment);
+                            if (!Block.IsValid())
+                                std::this_thread::yield();
+                        }
+                        if (!Block.IsValid())
+                        {
+                            ++NumErrors;
+                            continue;
+                        }
+                        ++NumAllocations;
+
+                        EXPECT_EQ(Block.UnalignedOffset % UnitSize, size_t{0});
+                        EXPECT_GE(Block.Size, size_t{Size});
+                        const auto Completed = CompletedFenceValue.load();
+                        for (auto u = Block.UnalignedOffset / UnitSize; u < (Block.UnalignedOffset + Block.Size) / UnitSize; ++u)
+                        {
+                            auto State = Units[u].load();
+                            const bool IsAvailable = State == 0 || ((State & PendingBit) != 0 && (State & ~PendingBit) <= Completed);
+                            if (!IsAvailable || !Units[u].compare_exchange_strong(State, OwnerTag))
+                            {
+                                ++NumErrors;
+                                break;
+                            }
+                        }
+                        Blocks.emplace_back(Block);
+                    }
+
+                    // Submit the frame and release the blocks
+                    const auto FenceValue = NextFenceValue.fetch_add(1);
+                    for (const auto& Block : Blocks)
+                    {
+                        for (auto u = Block.UnalignedOffset / UnitSize; u < (Block.UnalignedOffset + Block.Size) / UnitSize; ++u)
+                            Units[u].store(PendingBit | FenceValue);
+                    }
+                    TestReleaser Releaser{ReleaseQueue, FenceValue};
+                    Mgr.ReleaseMasterBlocks(Blocks, Releaser, 1);
+                    Blocks.clear();
+                }
+            }
+        );
+    }
+
+    for (auto& Context : Contexts)
+        Context.join();
+    Done.store(true);
+    GPUThread.join();
+
+    ReleaseQueue.Purge(NextFenceValue.load());
+    EXPECT_EQ(NumErrors.load(), Uint32{0});
+    EXPECT_GT(NumAllocations.load(), Uint32{0});
+    EXPECT_EQ(Mgr.GetUsedSize(), size_t{0});
+#ifdef DEVELOPMENT
+    EXPECT_EQ(Mgr.GetMasterBlockCounter(), 0);
+#endif
+}
+
+} // namespace
@@ -0,0 +1,214 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <string>
+
+#include "ShaderPermutationPreprocessor.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Returns the key of the source preprocessed with the given macros. Macros with null
+// definitions are passed to the preprocessor as known to be undefined.
+std::string GetKey(const Char* Source, std::vector<ShaderMacro> Macros = {})
+{
+    std::vector<ShaderMacro>  DefinedMacros;
+    std::vector<const Char*> UndefinedMacros;
+    for (const auto& Macro : Macros)
+    {
+        if (Macro.Definition != nullptr)
+            DefinedMacros.push_back(Macro);
+        else
+            UndefinedMacros.push_back(Macro.Name);
+    }
+    DefinedMacros.emplace_back(nullptr, nullptr);
+
+    ShaderPermutationPreprocessor Preprocessor{nullptr, DefinedMacros.data(), UndefinedMacros};
+    EXPECT_TRUE(Preprocessor.Process(Source, strlen(Source), "Test.fx")) << Source;
+    return Preprocessor.GetKey();
+}
+
+bool CanProcess(const Char* Source)
+{
+    const ShaderMacro Macros[] = {{nullptr, nullptr}};
+    ShaderPermutationPreprocessor Preprocessor{nullptr, Macros, {}};
+    return Preprocessor.Process(Source, strlen(Source), "Test.fx");
+}
+
+TEST(ShaderPermutationPreprocessorTest, KnownConditionChain)
+{
+    const Char* Source = R"(
+#if MODE == 0
+    float4 Color = float4(1.0, 0.0, 0.0, 1.0);
+#elif MODE == 1
+    float4 Color = float4(0.0, 1.0, 0.0, 1.0);
+#else
+    float4 Color = float4(0.0, 0.0, 1.0, 1.0);
+#endif
+)";
+
+    const auto Key0 = GetKey(Source, {{"MODE", "0"}});
+    const auto Key1 = GetKey(Source, {{"MODE", "1"}});
+    const auto Key2 = GetKey(Source, {{"MODE", "2"}});
+    const auto Key3 = GetKey(Source, {{"MODE", "3"}});
+    EXPECT_NE(Key0, Key1);
+    EXPECT_NE(Key0, Key2);
+    EXPECT_NE(Key1, Key2);
+    // Both permutations take the #else branch and do not reference MODE
+    EXPECT_EQ(Key2, Key3);
+
+    // Undefined macros evaluate to zero
+    EXPECT_EQ(GetKey(Source, {{"MODE", nullptr}}), Key0);
+}
+
+TEST(ShaderPermutationPreprocessorTest, DefinedOperator)
+{
+    const Char* Source = R"(
+#if defined(USE_FOG) && FOG_MODE > 1
+    float Fog = ComputeExpFog();
+#elif defined USE_FOG
+    float Fog = ComputeLinearFog();
+#else
+    float Fog = 0.0;
+#endif
+)";
+
+    const auto KeyNoFog = GetKey(Source, {{"USE_FOG", nullptr}, {"FOG_MODE", "2"}});
+    EXPECT_EQ(KeyNoFog, GetKey(Source, {{"USE_FOG", nullptr}, {"FOG_MODE", "0"}}));
+
+    const auto KeyLinear = GetKey(Source, {{"USE_FOG", ""}, {"FOG_MODE", "0"}});
+    EXPECT_EQ(KeyLinear, GetKey(Source, {{"USE_FOG", ""}, {"FOG_MODE", "1"}}));
+    EXPECT_NE(KeyLinear, KeyNoFog);
+    EXPECT_NE(KeyLinear, GetKey(Source, {{"USE_FOG", ""}, {"FOG_MODE", "2"}}));
+}
+
+TEST(ShaderPermutationPreprocessorTest, UnknownConditionChain)
+{
+    // ENGINE_FLAG may be defined by the engine, so both branches must be kept
+    const Char* Source = R"(
+#if ENGINE_FLAG
+    float Scale = SCALE;
+#elif MODE == 1
+    float Scale = 1.0;
+#else
+    float Scale = 2.0;
+#endif
+)";
+
+    // Macros referenced by the branch that may be compiled are part of the key
+    EXPECT_NE(GetKey(Source, {{"SCALE", "1.0"}, {"MODE", "0"}}), GetKey(Source, {{"SCALE", "2.0"}, {"MODE", "0"}}));
+    // #elif after an unknown condition may or may not be taken
+    EXPECT_NE(GetKey(Source, {{"SCALE", "1.0"}, {"MODE", "0"}}), GetKey(Source, {{"SCALE", "1.0"}, {"MODE", "1"}}));
+    // Macros that are not referenced do not affect the key
+    EXPECT_EQ(GetKey(Source, {{"SCALE", "1.0"}, {"MODE", "0"}, {"UNUSED", "0"}}),
+              GetKey(Source, {{"SCALE", "1.0"}, {"MODE", "0"}, {"UNUSED", "1"}}));
+}
+
+TEST(ShaderPermutationPreprocessorTest, KnownConditionInsideUnknown)
+{
+    const Char* Source = R"(
+#ifdef ENGINE_FLAG
+#   if MODE == 0
+        float Value = 0.0;
+#   else
+        float Value = 1.0;
+#   endif
+#endif
+)";
+
+    EXPECT_NE(GetKey(Source, {{"MODE", "0"}}), GetKey(Source, {{"MODE", "1"}}));
+    EXPECT_EQ(GetKey(Source, {{"MODE", "1"}}), GetKey(Source, {{"MODE", "2"}}));
+}
+
+TEST(ShaderPermutationPreprocessorTest, DefineReferencingPermutationMacro)
+{
+    const Char* Source = R"(
+#define HALF_SCALE (SCALE / 2)
+float Scale = HALF_SCALE;
+)";
+    EXPECT_NE(GetKey(Source, {{"SCALE", "2"}}), GetKey(Source, {{"SCALE", "4"}}));
+
+    // The value of the local macro is evaluated with the value of the permutation macro
+    const Char* CondSource = R"(
+#define LEVEL (QUALITY * 2)
+#if LEVEL > 2
+    float Value = HighQuality();
+#else
+    float Value = LowQuality();
+#endif
+)";
+    EXPECT_NE(GetKey(CondSource, {{"QUALITY", "1"}}), GetKey(CondSource, {{"QUALITY", "2"}}));
+    EXPECT_EQ(GetKey(CondSource, {{"QUALITY", "1"}, {"UNUSED", "0"}}), GetKey(CondSource, {{"QUALITY", "1"}, {"UNUSED", "1"}}));
+}
+
+TEST(ShaderPermutationPreprocessorTest, FunctionLikeMacros)
+{
+    // The body of a function-like macro references SCALE
+    const Char* Source = R"(
+#define SCALED(x) ((x) * SCALE)
+float Value = SCALED(1.0);
+)";
+    EXPECT_NE(GetKey(Source, {{"SCALE", "1"}}), GetKey(Source, {{"SCALE", "2"}}));
+
+    // Function-like macros are not expanded in conditions, so the condition is unknown
+    const Char* CondSource = R"(
+#define SQR(x) ((x) * (x))
+#if defined(SQR) && SQR(MODE) > 3
+    float Value = 1.0;
+#else
+    float Value = 0.0;
+#endif
+)";
+    EXPECT_NE(GetKey(CondSource, {{"MODE", "1"}}), GetKey(CondSource, {{"MODE", "2"}}));
+}
+
+TEST(ShaderPermutationPreprocessorTest, IncludeGuard)
+{
+    // A real include guard is assumed not to be defined by the engine
+    EXPECT_EQ(GetKey("#ifndef _COMMON_FXH_\n#define _COMMON_FXH_\nfloat Value = 1.0;\n#endif\n"),
+              GetKey("#define _COMMON_FXH_\nfloat Value = 1.0;\n"));
+
+    // #ifndef/#define that supplies a default value is not an include guard: PI may have been defined by the engine
+    EXPECT_NE(GetKey("#ifndef PI\n#define PI 3.14159\n#endif\nfloat Value = PI;\n"),
+              GetKey("#define PI 3.14159\nfloat Value = PI;\n"));
+
+    // Neither is a guard that does not enclose the whole file
+    EXPECT_NE(GetKey("#ifndef USE_DEFAULT\n#define USE_DEFAULT\n#endif\nfloat Value = 1.0;\n"),
+              GetKey("#define USE_DEFAULT\nfloat Value = 1.0;\n"));
+}
+
+TEST(ShaderPermutationPreprocessorTest, UnsupportedSource)
+{
+    EXPECT_FALSE(CanProcess("#define CONCAT(a, b) a##b\n"));
+    EXPECT_FALSE(CanProcess("#if 1\nfloat Value = 1.0;\n"));
+    EXPECT_FALSE(CanProcess("float Value = 1.0;\n#endif\n"));
+    EXPECT_TRUE(CanProcess("#if 1\nfloat Value = 1.0;\n#endif\n"));
+}
+
+} // namespace
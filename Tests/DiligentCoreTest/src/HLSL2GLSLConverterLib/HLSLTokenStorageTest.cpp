@@ -0,0 +1,218 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+
+#include "HLSLTokenStorage.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(TokenStringArena, CopyAndConcat)
+{
+    TokenStringArena Arena;
+
+    const auto Str1 = Arena.Copy("float4");
+    const auto Str2 = Arena.Copy(String{"x"});
+    const auto Str3 = Arena.Copy("Color.rgb", 5);
+    const auto Str4 = Arena.Concat(Str1, Str2);
+
+    EXPECT_STREQ(Str1.c_str(), "float4");
+    EXPECT_STREQ(Str2.c_str(), "x");
+    EXPECT_STREQ(Str3.c_str(), "Color");
+    EXPECT_STREQ(Str4.c_str(), "float4x");
+    EXPECT_EQ(Str4.length(), 7u);
+    EXPECT_TRUE(Str4 == "float4x");
+    EXPECT_TRUE(Str3 != "Color.rgb");
+}
+
+TEST(TokenStringArena, PageOverflow)
+{
+    // Every page holds 16 bytes, so most strings go to a new page
+    TokenStringArena Arena{16};
+
+    std::vector<TokenString> Strings;
+    std::vector<String>      RefStrings;
+    for (int i = 0; i < 100; ++i)
+    {
+        RefStrings.emplace_back("Token" + std::to_string(i));
+        Strings.emplace_back(Arena.Copy(RefStrings.back()));
+    }
+    // A string that is larger than the page size gets a page of its own
+    RefStrings.emplace_back(64, 'a');
+    Strings.emplace_back(Arena.Copy(RefStrings.back()));
+    Strings.emplace_back(Arena.Concat(Strings[0], Strings[1]));
+    RefStrings.emplace_back(RefStrings[0] + RefStrings[1]);
+
+    // Allocating new pages must not move the strings that have already been allocated
+    for (size_t i = 0; i < Strings.size(); ++i)
+        EXPECT_STREQ(Strings[i].c_str(), RefStrings[i].c_str());
+
+    // Strings must not overlap
+    for (size_t i = 1; i < Strings.size(); ++i)
+    {
+        const auto* pPrevEnd = Strings[i-1].data() + Strings[i-1].length() + 1;
+        EXPECT_TRUE(Strings[i].data() >= pPrevEnd || Strings[i].data() + Strings[i].length() + 1 <= Strings[i-1].data());
+    }
+}
+
+TEST(TokenStringArena, Reserve)
+{
+    TokenStringArena Arena{16};
+    Arena.Copy("0123456789");
+
+    // The remaining 5 bytes are not enough for two strings, so Reserve must switch to a new page
+    Arena.Reserve(8);
+    const auto Str1 = Arena.Copy("abc");
+    const auto Str2 = Arena.Copy("def");
+    EXPECT_EQ(Str2.data(), Str1.data() + 4);
+    EXPECT_STREQ(Str1.c_str(), "abc");
+    EXPECT_STREQ(Str2.c_str(), "def");
+}
+
+TEST(TokenStringArena, Rewind)
+{
+    TokenStringArena Arena{32};
+
+    const auto Persistent = Arena.Copy("Persistent");
+    const auto Mark       = Arena.GetMark();
+
+    // Allocate enough strings to span several pages, then rewind and allocate them again.
+    // The second pass must reuse exactly the same memory.
+    std::vector<const Char*> Pointers;
+    for (int i = 0; i < 20; ++i)
+        Pointers.push_back(Arena.Copy("Temporary" + std::to_string(i)).data());
+    Arena.Rewind(Mark);
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto Str = Arena.Copy("Temporary" + std::to_string(i));
+        EXPECT_EQ(Str.data(), Pointers[i]);
+    }
+
+    // Strings allocated before the mark must not be affected
+    Arena.Rewind(Mark);
+    for (int i = 0; i < 20; ++i)
+        Arena.Copy("Overwritten" + std::to_string(i));
+    EXPECT_STREQ(Persistent.c_str(), "Persistent");
+
+    // Rewinding to the initial mark releases all strings
+    TokenStringArena::Mark InitialMark;
+    Arena.Rewind(InitialMark);
+    EXPECT_EQ(Arena.Copy("Persistent").data(), Persistent.data());
+}
+
+TEST(TokenNodePool, AllocateAndFree)
+{
+    constexpr size_t BlockSize = 24;
+    TokenNodePool Pool{16};
+
+    // Allocate several pages of blocks
+    std::vector<void*> Blocks;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        auto* pBlock = Pool.Allocate(BlockSize);
+        ASSERT_NE(pBlock, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(pBlock) % sizeof(void*), 0u);
+        memset(pBlock, static_cast<int>(i), BlockSize);
+        Blocks.push_back(pBlock);
+    }
+
+    // Blocks must be distinct and must not overlap
+    std::unordered_set<void*> UniqueBlocks{Blocks.begin(), Blocks.end()};
+    EXPECT_EQ(UniqueBlocks.size(), Blocks.size());
+    for (size_t i = 0; i < Blocks.size(); ++i)
+    {
+        const auto* pBytes = reinterpret_cast<const Uint8*>(Blocks[i]);
+        for (size_t b = 0; b < BlockSize; ++b)
+            EXPECT_EQ(pBytes[b], static_cast<Uint8>(i));
+    }
+
+    // Released blocks are reused in the reverse order
+    Pool.Free(Blocks[10], BlockSize);
+    Pool.Free(Blocks[20], BlockSize);
+    EXPECT_EQ(Pool.Allocate(BlockSize), Blocks[20]);
+    EXPECT_EQ(Pool.Allocate(BlockSize), Blocks[10]);
+
+    // Blocks that are larger than the block size are allocated from the heap
+    auto* pLargeBlock = Pool.Allocate(BlockSize * 2);
+    EXPECT_EQ(UniqueBlocks.count(pLargeBlock), 0u);
+    Pool.Free(pLargeBlock, BlockSize * 2);
+
+    for (auto* pBlock : Blocks)
+        Pool.Free(pBlock, BlockSize);
+}
+
+TEST(TokenNodePool, ListAllocator)
+{
+    TokenNodePool Pool{8};
+
+    using ListType = std::list<String, TokenNodeAllocator<String>>;
+    ListType List{TokenNodeAllocator<String>{Pool}};
+    std::list<String> RefList;
+    for (int i = 0; i < 100; ++i)
+    {
+        List.push_back(std::to_string(i));
+        RefList.push_back(std::to_string(i));
+    }
+
+    // Erase every third node and insert new nodes in the middle, which reuses freed nodes
+    auto It    = List.begin();
+    auto RefIt = RefList.begin();
+    for (int i = 0; It != List.end(); ++i)
+    {
+        if (i % 3 == 0)
+        {
+            It    = List.erase(It);
+            RefIt = RefList.erase(RefIt);
+        }
+        else
+        {
+            List.insert(It, "New" + std::to_string(i));
+            RefList.insert(RefIt, "New" + std::to_string(i));
+            ++It;
+            ++RefIt;
+        }
+    }
+    ASSERT_EQ(List.size(), RefList.size());
+    EXPECT_TRUE(std::equal(List.begin(), List.end(), RefList.begin()));
+
+    // A copy of the list shares the pool
+    ListType Copy{List};
+    EXPECT_TRUE(Copy.get_allocator() == List.get_allocator());
+    List.clear();
+    ASSERT_EQ(Copy.size(), RefList.size());
+    EXPECT_TRUE(std::equal(Copy.begin(), Copy.end(), RefList.begin()));
+}
+
+} // namespace
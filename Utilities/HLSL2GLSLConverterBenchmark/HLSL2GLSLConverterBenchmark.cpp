@@ -0,0 +1,214 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// HLSL2GLSLConverterBenchmark measures the time it takes to convert HLSL shaders to GLSL. It converts
+// the mipmap generation shaders of Direct3D12 backend and a generated pixel shader with many functions,
+// and reports two times for every shader:
+// - Full conversion: loading the source, expanding includes, tokenizing and converting, which is
+//   what HLSL2GLSLConverterImpl::Convert() does when no conversion stream is given
+// - Reused stream: converting the tokens of an existing conversion stream
+// The conversion cache is disabled, so every iteration converts the shader.
+//
+// Usage: HLSL2GLSLConverterBenchmark [-n <Iterations>] [-g <GeneratedFunctions>]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "DefaultShaderSourceStreamFactory.h"
+#include "HLSL2GLSLConverterImpl.h"
+#include "RefCntAutoPtr.h"
+#include "Timer.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Generates a pixel shader that chains NumFunctions functions, each of which samples
+// a texture and accesses constant buffer members
+std::string GenerateShader(Uint32 NumFunctions)
+{
+    std::string Source =
+        "Texture2D    g_Texture;\n"
+        "SamplerState g_Texture_sampler;\n"
+        "cbuffer Constants\n"
+        "{\n"
+        "    float4 g_Scale;\n"
+        "};\n"
+        "struct PSInput\n"
+        "{\n"
+        "    float4 Pos : SV_Position;\n"
+        "    float2 UV  : TEXCOORD;\n"
+        "};\n";
+
+    for (Uint32 i = 0; i < NumFunctions; ++i)
+    {
+        const auto Idx = std::to_string(i);
+        Source +=
+            "float4 Func" + Idx + "(float4 Color, float2 UV)\n"
+            "{\n"
+            "    float4 Sample = g_Texture.Sample(g_Texture_sampler, UV + float2(" + Idx + ".0, 0.5) * g_Scale.xy);\n"
+            "    float  Luma   = dot(Sample.rgb, float3(0.299, 0.587, 0.114));\n"
+            "    if (Luma > 0.5)\n"
+            "        Color.rgb = lerp(Color.rgb, Sample.rgb, g_Scale.z);\n"
+            "    else\n"
+            "        Color.rgb *= saturate(Luma + g_Scale.w);\n"
+            "    return Color;\n"
+            "}\n";
+    }
+
+    Source +=
+        "void main(in PSInput PSIn, out float4 Color : SV_Target)\n"
+        "{\n"
+        "    Color = float4(0.0, 0.0, 0.0, 1.0);\n";
+    for (Uint32 i = 0; i < NumFunctions; ++i)
+        Source += "    Color = Func" + std::to_string(i) + "(Color, PSIn.UV);\n";
+    Source += "}\n";
+
+    return Source;
+}
+
+struct ShaderInfo
+{
+    const char*        Name;
+    SHADER_TYPE        Type;
+    const std::string* pSource; // Null if the shader is loaded from file
+};
+
+// Converts the shader NumIterations times and returns the average time, in seconds, of the full
+// conversion and the conversion that reuses the stream, or false if the conversion failed
+bool RunBenchmark(const ShaderInfo& Shader, IShaderSourceInputStreamFactory* pFactory, Uint32 NumIterations,
+                  double& FullTime, double& StreamTime, size_t& GLSLSize)
+{
+    const auto& Converter = HLSL2GLSLConverterImpl::GetInstance();
+
+    HLSL2GLSLConverterImpl::ConversionAttribs Attribs;
+    Attribs.pSourceStreamFactory = pFactory;
+    Attribs.HLSLSource           = Shader.pSource != nullptr ? Shader.pSource->c_str() : nullptr;
+    Attribs.NumSymbols           = Shader.pSource != nullptr ? Shader.pSource->length() : 0;
+    Attribs.InputFileName        = Shader.Name;
+    Attribs.EntryPoint           = "main";
+    Attribs.ShaderType           = Shader.Type;
+    Attribs.IncludeDefinitions   = true;
+
+    Timer FullTimer;
+    for (Uint32 i = 0; i < NumIterations; ++i)
+    {
+        const auto GLSL = Converter.Convert(Attribs);
+        if (GLSL.empty())
+            return false;
+        GLSLSize = GLSL.length();
+    }
+    FullTime = FullTimer.GetElapsedTime() / NumIterations;
+
+    RefCntAutoPtr<IHLSL2GLSLConversionStream> pStream;
+    Converter.CreateStream(Attribs.InputFileName, pFactory, Attribs.HLSLSource, Attribs.NumSymbols, &pStream);
+    if (!pStream)
+        return false;
+
+    Timer StreamTimer;
+    for (Uint32 i = 0; i < NumIterations; ++i)
+    {
+        RefCntAutoPtr<IDataBlob> pGLSL;
+        pStream->Convert(Attribs.EntryPoint, Attribs.ShaderType, Attribs.IncludeDefinitions, Attribs.SamplerSuffix, Attribs.UseInOutLocationQualifiers, &pGLSL);
+        if (!pGLSL)
+            return false;
+    }
+    StreamTime = StreamTimer.GetElapsedTime() / NumIterations;
+
+    return true;
+}
+
+void PrintUsage()
+{
+    printf("Usage: HLSL2GLSLConverterBenchmark [-n <Iterations>] [-g <GeneratedFunctions>]\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Uint32 NumIterations = 20;
+    Uint32 NumFunctions  = 1000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            NumIterations = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-g") == 0)
+            NumFunctions = static_cast<Uint32>(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (NumIterations == 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    HLSL2GLSLConverterImpl::GetInstance().GetConversionCache().SetParams(0, nullptr);
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pFactory;
+    CreateDefaultShaderSourceStreamFactory(SHADER_DIR, &pFactory);
+
+    const auto GeneratedSource = GenerateShader(NumFunctions);
+
+    std::vector<ShaderInfo> Shaders =
+    {
+        {"GenerateMipsLinearCS.hlsl",      SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsLinearOddCS.hlsl",   SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsLinearOddXCS.hlsl",  SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsLinearOddYCS.hlsl",  SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsGammaCS.hlsl",       SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsGammaOddCS.hlsl",    SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsGammaOddXCS.hlsl",   SHADER_TYPE_COMPUTE, nullptr},
+        {"GenerateMipsGammaOddYCS.hlsl",   SHADER_TYPE_COMPUTE, nullptr}
+    };
+    if (NumFunctions != 0)
+        Shaders.push_back({"Generated shader", SHADER_TYPE_PIXEL, &GeneratedSource});
+
+    printf("Iterations: %u\n", NumIterations);
+    printf("Shader                          GLSL (bytes)   Full (ms)   Reused stream (ms)\n");
+    for (const auto& Shader : Shaders)
+    {
+        double FullTime   = 0;
+        double StreamTime = 0;
+        size_t GLSLSize   = 0;
+        // Warm up the allocator and the file cache
+        if (!RunBenchmark(Shader, pFactory, 1, FullTime, StreamTime, GLSLSize) ||
+            !RunBenchmark(Shader, pFactory, NumIterations, FullTime, StreamTime, GLSLSize))
+        {
+            printf("Failed to convert %s\n", Shader.Name);
+            return -1;
+        }
+        printf("%-30s %14u %11.3f %20.3f\n", Shader.Name, static_cast<Uint32>(GLSLSize), FullTime * 1000.0, StreamTime * 1000.0);
+    }
+
+    return 0;
+}
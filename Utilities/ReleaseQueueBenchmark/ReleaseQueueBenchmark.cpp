@@ -0,0 +1,262 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// ReleaseQueueBenchmark measures the throughput of ResourceReleaseQueue when resources are released
+// from multiple threads, the way the render device releases Vulkan objects. Producer threads release
+// resources while a separate thread moves stale resources to the release queue and purges it, as
+// the immediate context does at the end of every command buffer. The benchmark reports the number
+// of releases per second and the number of heap allocations per release for 1, 2, 4, ... producers:
+//   * with small resources that are kept inline in DynamicStaleResourceWrapper and large resources
+//     that are allocated from the heap;
+//   * with the default staging queue capacity and with a minimal one, when almost every release
+//     falls back to the locked list.
+// It also reports the size of the wrapper and the memory that the staging queues preallocate.
+//
+// Usage: ReleaseQueueBenchmark [-j <MaxThreads>] [-n <ReleasesPerThread>]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <new>
+
+#include "ResourceReleaseQueue.h"
+#include "DefaultRawMemoryAllocator.h"
+#include "Timer.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+std::atomic<size_t> g_NumHeapAllocations{0};
+
+}
+
+// Count all heap allocations, including those made by the wrappers
+void* operator new(size_t Size)
+{
+    g_NumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* Ptr = malloc(Size != 0 ? Size : 1))
+        return Ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* Ptr) noexcept
+{
+    free(Ptr);
+}
+
+namespace
+{
+
+// Allocator that counts the number of bytes it has allocated
+class CountingAllocator final : public IMemoryAllocator
+{
+public:
+    virtual void* Allocate(size_t Size, const Char* dbgDescription, const char* dbgFileName, const Int32 dbgLineNumber)override final
+    {
+        m_AllocatedBytes += Size;
+        return DefaultRawMemoryAllocator::GetAllocator().Allocate(Size, dbgDescription, dbgFileName, dbgLineNumber);
+    }
+
+    virtual void Free(void* Ptr)override final
+    {
+        DefaultRawMemoryAllocator::GetAllocator().Free(Ptr);
+    }
+
+    size_t GetAllocatedBytes()const { return m_AllocatedBytes.load(); }
+
+private:
+    std::atomic<size_t> m_AllocatedBytes{0};
+};
+
+// Resource of the same size as a Vulkan object wrapper (shared pointer to the logical device and the handle)
+struct SmallResource
+{
+    SmallResource() noexcept {}
+    SmallResource(SmallResource&& rhs) noexcept :
+        pDevice      {rhs.pDevice      },
+        pControlBlock{rhs.pControlBlock},
+        Handle       {rhs.Handle       }
+    {
+        rhs.pDevice       = nullptr;
+        rhs.pControlBlock = nullptr;
+        rhs.Handle        = 0;
+    }
+
+    void*  pDevice       = nullptr;
+    void*  pControlBlock = nullptr;
+    Uint64 Handle        = 0;
+};
+
+// Resource that does not fit into the inline storage of the wrapper
+struct LargeResource
+{
+    LargeResource() noexcept {}
+    LargeResource(LargeResource&&) noexcept {}
+
+    Uint8 Data[DynamicStaleResourceWrapper::InlineStorageSize] = {};
+};
+
+using ReleaseQueueType = ResourceReleaseQueue<DynamicStaleResourceWrapper>;
+
+struct BenchmarkResult
+{
+    double Time;
+    size_t NumHeapAllocations;
+};
+
+// Releases ReleasesPerThread resources from each of NumThreads threads
+template<typename ResourceType>
+BenchmarkResult RunBenchmark(Uint32 NumThreads, Uint32 ReleasesPerThread, size_t StagingQueueCapacity)
+{
+    ReleaseQueueType ReleaseQueue{DefaultRawMemoryAllocator::GetAllocator(), StagingQueueCapacity};
+
+    std::atomic<Uint32> NumReady{0};
+    std::atomic<Uint32> NumFinished{0};
+    std::atomic<bool>   Start{false};
+    std::atomic<Uint64> NextCmdBufferNumber{1};
+
+    std::vector<std::thread> Threads;
+    for (Uint32 t = 0; t < NumThreads; ++t)
+    {
+        Threads.emplace_back(
+            [&]()
+            {
+                ++NumReady;
+                while (!Start.load())
+                    std::this_thread::yield();
+
+                for (Uint32 i = 0; i < ReleasesPerThread; ++i)
+                    ReleaseQueue.SafeReleaseResource(ResourceType{}, NextCmdBufferNumber.load(std::memory_order_relaxed));
+                ++NumFinished;
+            });
+    }
+
+    // Do not count thread creation time
+    while (NumReady.load() != NumThreads)
+        std::this_thread::yield();
+    const auto NumAllocationsBefore = g_NumHeapAllocations.load();
+    Timer BenchmarkTimer;
+    Start.store(true);
+
+    // Plays the role of the immediate context that submits command buffers. The GPU is
+    // assumed to complete every command buffer immediately.
+    while (NumFinished.load() != NumThreads)
+    {
+        const auto CmdBufferNumber = NextCmdBufferNumber.fetch_add(1);
+        ReleaseQueue.DiscardStaleResources(CmdBufferNumber, CmdBufferNumber);
+        ReleaseQueue.Purge(CmdBufferNumber);
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+    const auto CmdBufferNumber = NextCmdBufferNumber.load();
+    ReleaseQueue.DiscardStaleResources(CmdBufferNumber, CmdBufferNumber);
+    ReleaseQueue.Purge(CmdBufferNumber);
+
+    BenchmarkResult Result;
+    Result.Time               = BenchmarkTimer.GetElapsedTime();
+    Result.NumHeapAllocations = g_NumHeapAllocations.load() - NumAllocationsBefore;
+    return Result;
+}
+
+template<typename ResourceType>
+void RunBenchmarks(const char* Name, const std::vector<Uint32>& ThreadCounts, Uint32 ReleasesPerThread, size_t StagingQueueCapacity)
+{
+    printf("\n%s, staging queue capacity %u\n", Name, static_cast<Uint32>(StagingQueueCapacity));
+    printf("Threads   Releases   Time (s)   Releases/s   Speedup   Heap allocations/release\n");
+
+    // Warm up the allocator
+    RunBenchmark<ResourceType>(1, ReleasesPerThread, StagingQueueCapacity);
+
+    double SingleThreadRate = 0;
+    for (auto NumThreads : ThreadCounts)
+    {
+        const auto Result      = RunBenchmark<ResourceType>(NumThreads, ReleasesPerThread, StagingQueueCapacity);
+        const auto NumReleases = NumThreads * ReleasesPerThread;
+        const auto Rate        = static_cast<double>(NumReleases) / Result.Time;
+        if (NumThreads == 1)
+            SingleThreadRate = Rate;
+        printf("%7u %10u %10.3f %12.0f %8.2fx %26.2f\n", NumThreads, NumReleases, Result.Time, Rate, Rate / SingleThreadRate,
+               static_cast<double>(Result.NumHeapAllocations) / static_cast<double>(NumReleases));
+    }
+}
+
+void PrintUsage()
+{
+    printf("Usage: ReleaseQueueBenchmark [-j <MaxThreads>] [-n <ReleasesPerThread>]\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Uint32 MaxThreads        = std::max(std::thread::hardware_concurrency(), 1u);
+    Uint32 ReleasesPerThread = 200000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            MaxThreads = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            ReleasesPerThread = static_cast<Uint32>(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (MaxThreads == 0 || ReleasesPerThread == 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    // Memory that every release queue preallocates for its two staging queues
+    size_t StagingQueueMemory = 0;
+    {
+        CountingAllocator Allocator;
+        ReleaseQueueType  ReleaseQueue{Allocator};
+        StagingQueueMemory = Allocator.GetAllocatedBytes();
+    }
+    printf("sizeof(DynamicStaleResourceWrapper): %u bytes (%u bytes of inline storage)\n",
+           static_cast<Uint32>(sizeof(DynamicStaleResourceWrapper)), static_cast<Uint32>(DynamicStaleResourceWrapper::InlineStorageSize));
+    printf("Staging queues of one release queue: 2 x %u cells, %u bytes preallocated\n",
+           static_cast<Uint32>(ReleaseQueueType::DefaultStagingQueueCapacity), static_cast<Uint32>(StagingQueueMemory));
+
+    // 1, 2, 4, ... threads and MaxThreads
+    std::vector<Uint32> ThreadCounts;
+    for (Uint32 NumThreads = 1; NumThreads < MaxThreads; NumThreads *= 2)
+        ThreadCounts.push_back(NumThreads);
+    ThreadCounts.push_back(MaxThreads);
+
+    RunBenchmarks<SmallResource>("Small (inline) resources", ThreadCounts, ReleasesPerThread, ReleaseQueueType::DefaultStagingQueueCapacity);
+    RunBenchmarks<LargeResource>("Large (heap) resources",   ThreadCounts, ReleasesPerThread, ReleaseQueueType::DefaultStagingQueueCapacity);
+    RunBenchmarks<SmallResource>("Small (inline) resources", ThreadCounts, ReleasesPerThread, 2);
+
+    return 0;
+}
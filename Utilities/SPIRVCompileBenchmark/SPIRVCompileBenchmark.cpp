@@ -0,0 +1,217 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// SPIRVCompileBenchmark measures how the throughput of glslang compilation scales with the
+// number of threads. Every thread compiles the same HLSL and GLSL shaders in a loop, and the
+// benchmark reports the number of shaders compiled per second for 1, 2, 4, ... threads.
+//
+// Usage: SPIRVCompileBenchmark [-j <MaxThreads>] [-n <CompilesPerThread>]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "SPIRVUtils.h"
+#include "Timer.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+const char* const HLSLSource = R"(
+Texture2D    g_Albedo;
+SamplerState g_Albedo_sampler;
+Texture2D    g_Normal;
+SamplerState g_Normal_sampler;
+
+cbuffer Constants
+{
+    float4x4 g_WorldViewProj;
+    float4   g_LightDir;
+    float4   g_LightColor;
+};
+
+struct PSInput
+{
+    float4 Pos    : SV_Position;
+    float3 Normal : NORMAL;
+    float2 UV     : TEXCOORD;
+};
+
+float4 main(in PSInput PSIn) : SV_Target
+{
+    float4 Albedo = g_Albedo.Sample(g_Albedo_sampler, PSIn.UV);
+    float3 N      = normalize(PSIn.Normal + g_Normal.Sample(g_Normal_sampler, PSIn.UV).xyz * 2.0 - 1.0);
+    float  NdotL  = saturate(dot(N, -g_LightDir.xyz));
+    float3 Color  = Albedo.rgb * (0.1 + NdotL * g_LightColor.rgb);
+    for (int i = 0; i < 4; ++i)
+        Color = lerp(Color, Color * Color, 0.25);
+    return float4(Color, Albedo.a);
+}
+)";
+
+const char* const GLSLSource = R"(
+#version 450
+layout(local_size_x = 64) in;
+layout(std430, binding = 0) buffer Data
+{
+    vec4 Values[];
+};
+layout(binding = 1) uniform Constants
+{
+    vec4 Scale;
+    uint NumValues;
+};
+shared vec4 Tile[64];
+void main()
+{
+    uint Idx = gl_GlobalInvocationID.x;
+    Tile[gl_LocalInvocationIndex] = Idx < NumValues ? Values[Idx] : vec4(0.0);
+    barrier();
+    vec4 Sum = vec4(0.0);
+    for (uint i = 0; i < 64; ++i)
+        Sum += Tile[i];
+    if (Idx < NumValues)
+        Values[Idx] = Sum * Scale;
+}
+)";
+
+bool CompileShader(bool UseHLSL)
+{
+    if (UseHLSL)
+    {
+        ShaderCreateInfo ShaderCI;
+        ShaderCI.Source          = HLSLSource;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.SourceLanguage  = SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        return !HLSLtoSPIRV(ShaderCI, nullptr).empty();
+    }
+    else
+    {
+        return !GLSLtoSPIRV(SHADER_TYPE_COMPUTE, GLSLSource, static_cast<int>(strlen(GLSLSource)), nullptr).empty();
+    }
+}
+
+// Returns the time, in seconds, it takes NumThreads threads to compile CompilesPerThread shaders each
+double RunBenchmark(Uint32 NumThreads, Uint32 CompilesPerThread, std::atomic<Uint32>& NumFailures)
+{
+    std::atomic<Uint32> NumReady{0};
+    std::atomic<bool>   Start{false};
+
+    std::vector<std::thread> Threads;
+    for (Uint32 t = 0; t < NumThreads; ++t)
+    {
+        Threads.emplace_back(
+            [&, t]()
+            {
+                ++NumReady;
+                while (!Start.load())
+                    std::this_thread::yield();
+
+                for (Uint32 i = 0; i < CompilesPerThread; ++i)
+                {
+                    if (!CompileShader((t + i) % 2 == 0))
+                        ++NumFailures;
+                }
+            });
+    }
+
+    // Do not count thread creation time
+    while (NumReady.load() != NumThreads)
+        std::this_thread::yield();
+    Timer BenchmarkTimer;
+    Start.store(true);
+    for (auto& Thread : Threads)
+        Thread.join();
+    return BenchmarkTimer.GetElapsedTime();
+}
+
+void PrintUsage()
+{
+    printf("Usage: SPIRVCompileBenchmark [-j <MaxThreads>] [-n <CompilesPerThread>]\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Uint32 MaxThreads        = std::max(std::thread::hardware_concurrency(), 1u);
+    Uint32 CompilesPerThread = 32;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            MaxThreads = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            CompilesPerThread = static_cast<Uint32>(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (MaxThreads == 0 || CompilesPerThread == 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    InitializeGlslang();
+
+    std::atomic<Uint32> NumFailures{0};
+    // Warm up glslang and the allocator
+    RunBenchmark(1, 2, NumFailures);
+
+    // 1, 2, 4, ... threads and MaxThreads
+    std::vector<Uint32> ThreadCounts;
+    for (Uint32 NumThreads = 1; NumThreads < MaxThreads; NumThreads *= 2)
+        ThreadCounts.push_back(NumThreads);
+    ThreadCounts.push_back(MaxThreads);
+
+    printf("Threads   Shaders   Time (s)   Shaders/s   Speedup\n");
+    double SingleThreadRate = 0;
+    for (auto NumThreads : ThreadCounts)
+    {
+        const auto Time = RunBenchmark(NumThreads, CompilesPerThread, NumFailures);
+        const auto NumShaders = NumThreads * CompilesPerThread;
+        const auto Rate = static_cast<double>(NumShaders) / Time;
+        if (NumThreads == 1)
+            SingleThreadRate = Rate;
+        printf("%7u %9u %10.3f %11.1f %8.2fx\n", NumThreads, NumShaders, Time, Rate, Rate / SingleThreadRate);
+    }
+
+    FinalizeGlslang();
+
+    if (NumFailures.load() != 0)
+    {
+        printf("%u shader(s) failed to compile\n", NumFailures.load());
+        return -1;
+    }
+    return 0;
+}
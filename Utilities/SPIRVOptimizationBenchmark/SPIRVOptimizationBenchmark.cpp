@@ -0,0 +1,305 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// SPIRVOptimizationBenchmark measures how SPIR-V optimization levels affect the byte code size and the
+// time it takes to create a Vulkan pipeline. For every level, the benchmark compiles a vertex and a pixel
+// shader from HLSL source with ShaderCreateInfo::SPIRVOptimization set to that level, and reports the
+// compilation time (which includes the optimizer), the total SPIR-V size, the time to create the first
+// pipeline and the average time to create a pipeline from the same shaders.
+// Drivers may cache compiled pipelines on disk. Disable the cache (e.g. MESA_SHADER_CACHE_DISABLE=true)
+// to measure the cold pipeline creation time.
+//
+// Usage: SPIRVOptimizationBenchmark [-n <PipelinesPerLevel>] [-p "<spirv-opt flags>"]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+#include "vulkan.h"
+#include "EngineFactoryVk.h"
+#include "ShaderVk.h"
+#include "PlatformDefinitions.h"
+#include "RefCntAutoPtr.h"
+#include "Timer.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+const char* const VSSource = R"(
+cbuffer cbCameraAttribs
+{
+    float4x4 g_WorldViewProj;
+    float4x4 g_World;
+};
+
+struct VSInput
+{
+    float3 Pos    : ATTRIB0;
+    float3 Normal : ATTRIB1;
+    float2 UV     : ATTRIB2;
+};
+
+struct PSInput
+{
+    float4 Pos      : SV_Position;
+    float3 WorldPos : WORLD_POS;
+    float3 Normal   : NORMAL;
+    float2 UV       : TEXCOORD;
+};
+
+void main(in VSInput VSIn, out PSInput PSIn)
+{
+    PSIn.Pos      = mul(float4(VSIn.Pos, 1.0), g_WorldViewProj);
+    PSIn.WorldPos = mul(float4(VSIn.Pos, 1.0), g_World).xyz;
+    PSIn.Normal   = normalize(mul(float4(VSIn.Normal, 0.0), g_World).xyz);
+    PSIn.UV       = VSIn.UV;
+}
+)";
+
+const char* const PSSource = R"(
+#define NUM_LIGHTS 8
+
+Texture2D    g_Albedo;
+SamplerState g_Albedo_sampler;
+Texture2D    g_NormalMap;
+SamplerState g_NormalMap_sampler;
+
+struct LightAttribs
+{
+    float4 Position;
+    float4 Color;
+};
+
+cbuffer cbLights
+{
+    LightAttribs g_Lights[NUM_LIGHTS];
+    float4       g_CameraPos;
+    float4       g_Ambient;
+};
+
+struct PSInput
+{
+    float4 Pos      : SV_Position;
+    float3 WorldPos : WORLD_POS;
+    float3 Normal   : NORMAL;
+    float2 UV       : TEXCOORD;
+};
+
+float3 EvaluateLight(LightAttribs Light, float3 WorldPos, float3 N, float3 V, float3 Albedo)
+{
+    float3 L      = Light.Position.xyz - WorldPos;
+    float  Dist   = length(L);
+    L /= max(Dist, 1e-4);
+    float3 H      = normalize(L + V);
+    float  NdotL  = saturate(dot(N, L));
+    float  NdotH  = saturate(dot(N, H));
+    float  Atten  = 1.0 / (1.0 + Light.Position.w * Dist * Dist);
+    return (Albedo * NdotL + pow(NdotH, 32.0)) * Light.Color.rgb * Atten;
+}
+
+float4 main(in PSInput PSIn) : SV_Target
+{
+    float4 Albedo = g_Albedo.Sample(g_Albedo_sampler, PSIn.UV);
+    float3 N      = normalize(PSIn.Normal + g_NormalMap.Sample(g_NormalMap_sampler, PSIn.UV).xyz * 2.0 - 1.0);
+    float3 V      = normalize(g_CameraPos.xyz - PSIn.WorldPos);
+    float3 Color  = Albedo.rgb * g_Ambient.rgb;
+    for (int i = 0; i < NUM_LIGHTS; ++i)
+        Color += EvaluateLight(g_Lights[i], PSIn.WorldPos, N, V, Albedo.rgb);
+    return float4(Color, Albedo.a);
+}
+)";
+
+struct LevelResults
+{
+    double CompileTime       = 0;
+    size_t SPIRVSize         = 0;
+    double FirstPipelineTime = 0;
+    double PipelineTime      = 0;
+};
+
+class Benchmark
+{
+public:
+    bool Initialize()
+    {
+        EngineVkCreateInfo EngineCI;
+        IDeviceContext*    pContext = nullptr;
+        GetEngineFactoryVk()->CreateDeviceAndContextsVk(EngineCI, &m_pDevice, &pContext);
+        if (!m_pDevice)
+            return false;
+        m_pContext.Attach(pContext);
+        return true;
+    }
+
+    bool Run(SPIRV_OPTIMIZATION_LEVEL Level, const char* CustomPasses, Uint32 NumPipelines, LevelResults& Results)
+    {
+        ShaderCreateInfo ShaderCI;
+        ShaderCI.SourceLanguage          = SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.EntryPoint              = "main";
+        ShaderCI.SPIRVOptimization       = Level;
+        ShaderCI.SPIRVOptimizationPasses = CustomPasses;
+
+        Timer CompileTimer;
+        RefCntAutoPtr<IShader> pVS;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.Desc.Name       = "Benchmark VS";
+        ShaderCI.Source          = VSSource;
+        m_pDevice->CreateShader(ShaderCI, &pVS);
+
+        RefCntAutoPtr<IShader> pPS;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.Desc.Name       = "Benchmark PS";
+        ShaderCI.Source          = PSSource;
+        m_pDevice->CreateShader(ShaderCI, &pPS);
+        Results.CompileTime = CompileTimer.GetElapsedTime();
+        if (!pVS || !pPS)
+            return false;
+
+        Results.SPIRVSize = 0;
+        for (IShader* pShader : {pVS.RawPtr(), pPS.RawPtr()})
+        {
+            RefCntAutoPtr<IShaderVk> pShaderVk{pShader, IID_ShaderVk};
+            Results.SPIRVSize += pShaderVk->GetSPIRV().size() * sizeof(uint32_t);
+        }
+
+        LayoutElement LayoutElems[] =
+        {
+            LayoutElement{0, 0, 3, VT_FLOAT32, False},
+            LayoutElement{1, 0, 3, VT_FLOAT32, False},
+            LayoutElement{2, 0, 2, VT_FLOAT32, False}
+        };
+
+        PipelineStateDesc PSODesc;
+        PSODesc.Name                                          = "Benchmark PSO";
+        PSODesc.GraphicsPipeline.pVS                          = pVS;
+        PSODesc.GraphicsPipeline.pPS                          = pPS;
+        PSODesc.GraphicsPipeline.InputLayout.LayoutElements   = LayoutElems;
+        PSODesc.GraphicsPipeline.InputLayout.NumElements      = _countof(LayoutElems);
+        PSODesc.GraphicsPipeline.NumRenderTargets             = 1;
+        PSODesc.GraphicsPipeline.RTVFormats[0]                = TEX_FORMAT_RGBA8_UNORM;
+        PSODesc.GraphicsPipeline.DSVFormat                    = TEX_FORMAT_D32_FLOAT;
+
+        // Shader modules are cached by the device, so every pipeline after the first one only
+        // measures the time the driver spends compiling the pipeline
+        Results.PipelineTime = 0;
+        for (Uint32 i = 0; i < NumPipelines; ++i)
+        {
+            Timer PipelineTimer;
+            RefCntAutoPtr<IPipelineState> pPSO;
+            m_pDevice->CreatePipelineState(PSODesc, &pPSO);
+            const auto Time = PipelineTimer.GetElapsedTime();
+            if (!pPSO)
+                return false;
+
+            if (i == 0)
+                Results.FirstPipelineTime = Time;
+            Results.PipelineTime += Time;
+        }
+        Results.PipelineTime /= NumPipelines;
+
+        // Release the pipelines and shader modules before the next level
+        m_pContext->FinishFrame();
+        m_pContext->WaitForIdle();
+        return true;
+    }
+
+private:
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IDeviceContext> m_pContext;
+};
+
+void PrintUsage()
+{
+    printf("Usage: SPIRVOptimizationBenchmark [-n <PipelinesPerLevel>] [-p \"<spirv-opt flags>\"]\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Uint32      NumPipelines = 16;
+    const char* CustomPasses = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+            NumPipelines = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+            CustomPasses = argv[++i];
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (NumPipelines == 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    Benchmark Bench;
+    if (!Bench.Initialize())
+    {
+        printf("Failed to initialize the benchmark\n");
+        return -1;
+    }
+
+    struct
+    {
+        SPIRV_OPTIMIZATION_LEVEL Level;
+        const char*              Name;
+    } Levels[] =
+    {
+        {SPIRV_OPTIMIZATION_LEVEL_NONE,        "None"},
+        {SPIRV_OPTIMIZATION_LEVEL_SIZE,        "Size"},
+        {SPIRV_OPTIMIZATION_LEVEL_PERFORMANCE, "Performance"},
+        {SPIRV_OPTIMIZATION_LEVEL_CUSTOM,      "Custom"}
+    };
+
+    // Warm up glslang, the optimizer and the driver
+    LevelResults Results;
+    Bench.Run(SPIRV_OPTIMIZATION_LEVEL_NONE, nullptr, 1, Results);
+
+    printf("Pipelines per level: %u\n", NumPipelines);
+    printf("Level         Compile (ms)   SPIR-V (bytes)   First pipeline (ms)   Pipeline (ms)\n");
+    for (const auto& Level : Levels)
+    {
+        // The custom level is only measured when the passes are given
+        if (Level.Level == SPIRV_OPTIMIZATION_LEVEL_CUSTOM && CustomPasses == nullptr)
+            continue;
+
+        if (!Bench.Run(Level.Level, CustomPasses, NumPipelines, Results))
+        {
+            printf("%-11s failed\n", Level.Name);
+            return -1;
+        }
+        printf("%-11s %14.3f %16u %21.3f %15.3f\n", Level.Name, Results.CompileTime * 1000.0,
+               static_cast<Uint32>(Results.SPIRVSize), Results.FirstPipelineTime * 1000.0, Results.PipelineTime * 1000.0);
+    }
+
+    return 0;
+}
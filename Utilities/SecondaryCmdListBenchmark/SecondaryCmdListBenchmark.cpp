@@ -0,0 +1,335 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+// SecondaryCmdListBenchmark measures how the CPU time of recording draw commands scales with the
+// number of threads. Every frame, the draws are split evenly between the threads. Each thread records
+// its share into a secondary command list of its own deferred context, and the immediate context
+// executes all lists inside one render pass. The benchmark reports the recording time per frame
+// for 1, 2, 4, ... threads, as well as the time the immediate context spends executing the lists.
+//
+// Usage: SecondaryCmdListBenchmark [-j <MaxThreads>] [-d <DrawsPerFrame>] [-f <NumFrames>]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "vulkan.h"
+#include "EngineFactoryVk.h"
+#include "DeviceContextVk.h"
+#include "RefCntAutoPtr.h"
+#include "Timer.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+const char* const VSSource = R"(
+PUSH_CONSTANTS cbuffer cbDrawAttribs
+{
+    float4 g_OffsetScale;
+    float4 g_Color;
+};
+
+struct PSInput
+{
+    float4 Pos   : SV_Position;
+    float4 Color : COLOR;
+};
+
+void main(in uint VertId : SV_VertexID, out PSInput PSIn)
+{
+    float2 Pos[3] = {float2(-1.0, -1.0), float2(0.0, 1.0), float2(1.0, -1.0)};
+    PSIn.Pos   = float4(Pos[VertId] * g_OffsetScale.zw + g_OffsetScale.xy, 0.0, 1.0);
+    PSIn.Color = g_Color;
+}
+)";
+
+const char* const PSSource = R"(
+struct PSInput
+{
+    float4 Pos   : SV_Position;
+    float4 Color : COLOR;
+};
+
+float4 main(in PSInput PSIn) : SV_Target
+{
+    return PSIn.Color;
+}
+)";
+
+struct DrawConstants
+{
+    float OffsetScale[4];
+    float Color[4];
+};
+
+constexpr Uint32 RenderTargetSize = 1024;
+
+class Benchmark
+{
+public:
+    bool Initialize(Uint32 MaxThreads)
+    {
+        EngineVkCreateInfo EngineCI;
+        EngineCI.NumDeferredContexts = MaxThreads;
+
+        std::vector<IDeviceContext*> ppContexts(1 + MaxThreads);
+        GetEngineFactoryVk()->CreateDeviceAndContextsVk(EngineCI, &m_pDevice, ppContexts.data());
+        if (!m_pDevice)
+            return false;
+        RefCntAutoPtr<IDeviceContext> pImmediateCtx;
+        pImmediateCtx.Attach(ppContexts[0]);
+        m_pImmediateCtx = RefCntAutoPtr<IDeviceContextVk>{pImmediateCtx, IID_DeviceContextVk};
+        for (Uint32 i = 0; i < MaxThreads; ++i)
+        {
+            RefCntAutoPtr<IDeviceContext> pDeferredCtx;
+            pDeferredCtx.Attach(ppContexts[1 + i]);
+            m_DeferredCtxs.emplace_back(pDeferredCtx, IID_DeviceContextVk);
+        }
+
+        TextureDesc TexDesc;
+        TexDesc.Name      = "Benchmark render target";
+        TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+        TexDesc.Width     = RenderTargetSize;
+        TexDesc.Height    = RenderTargetSize;
+        TexDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
+        TexDesc.BindFlags = BIND_RENDER_TARGET;
+        m_pDevice->CreateTexture(TexDesc, nullptr, &m_pRenderTarget);
+
+        TexDesc.Name      = "Benchmark depth buffer";
+        TexDesc.Format    = TEX_FORMAT_D32_FLOAT;
+        TexDesc.BindFlags = BIND_DEPTH_STENCIL;
+        m_pDevice->CreateTexture(TexDesc, nullptr, &m_pDepthBuffer);
+        if (!m_pRenderTarget || !m_pDepthBuffer)
+            return false;
+
+        ShaderCreateInfo ShaderCI;
+        ShaderCI.SourceLanguage = SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.EntryPoint     = "main";
+
+        RefCntAutoPtr<IShader> pVS;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.Desc.Name       = "Benchmark VS";
+        ShaderCI.Source          = VSSource;
+        m_pDevice->CreateShader(ShaderCI, &pVS);
+
+        RefCntAutoPtr<IShader> pPS;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.Desc.Name       = "Benchmark PS";
+        ShaderCI.Source          = PSSource;
+        m_pDevice->CreateShader(ShaderCI, &pPS);
+        if (!pVS || !pPS)
+            return false;
+
+        PipelineStateDesc PSODesc;
+        PSODesc.Name                                     = "Benchmark PSO";
+        PSODesc.PushConstants.Name                       = "cbDrawAttribs";
+        PSODesc.PushConstants.Size                       = sizeof(DrawConstants);
+        PSODesc.GraphicsPipeline.pVS                     = pVS;
+        PSODesc.GraphicsPipeline.pPS                     = pPS;
+        PSODesc.GraphicsPipeline.NumRenderTargets        = 1;
+        PSODesc.GraphicsPipeline.RTVFormats[0]           = TEX_FORMAT_RGBA8_UNORM;
+        PSODesc.GraphicsPipeline.DSVFormat               = TEX_FORMAT_D32_FLOAT;
+        PSODesc.GraphicsPipeline.RasterizerDesc.CullMode = CULL_MODE_NONE;
+        m_pDevice->CreatePipelineState(PSODesc, &m_pPSO);
+        if (!m_pPSO)
+            return false;
+
+        // Secondary command lists require that the render targets be in the required states in advance
+        ITextureView* pRTV = m_pRenderTarget->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        m_pImmediateCtx->SetRenderTargets(1, &pRTV, m_pDepthBuffer->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pImmediateCtx->Flush();
+        return true;
+    }
+
+    // Renders one frame with NumThreads threads and returns the time, in seconds, the threads spend recording the draws
+    double RenderFrame(Uint32 NumThreads, Uint32 DrawsPerFrame, double& ExecutionTime)
+    {
+        std::vector<RefCntAutoPtr<ICommandList>> CmdLists(NumThreads);
+        std::atomic<Uint32> NumReady{0};
+        std::atomic<bool>   Start{false};
+
+        std::vector<std::thread> Threads;
+        for (Uint32 t = 0; t < NumThreads; ++t)
+        {
+            Threads.emplace_back(
+                [&, t]()
+                {
+                    ++NumReady;
+                    while (!Start.load())
+                        std::this_thread::yield();
+
+                    const Uint32 FirstDraw = DrawsPerFrame * t / NumThreads;
+                    const Uint32 EndDraw   = DrawsPerFrame * (t + 1) / NumThreads;
+                    RecordDraws(m_DeferredCtxs[t], FirstDraw, EndDraw, DrawsPerFrame, &CmdLists[t]);
+                });
+        }
+
+        // Do not count thread creation time
+        while (NumReady.load() != NumThreads)
+            std::this_thread::yield();
+        Timer RecordingTimer;
+        Start.store(true);
+        for (auto& Thread : Threads)
+            Thread.join();
+        const auto RecordingTime = RecordingTimer.GetElapsedTime();
+
+        Timer ExecutionTimer;
+        std::vector<ICommandList*> ppCmdLists(NumThreads);
+        for (Uint32 t = 0; t < NumThreads; ++t)
+            ppCmdLists[t] = CmdLists[t];
+        ITextureView* pRTV = m_pRenderTarget->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        m_pImmediateCtx->SetRenderTargets(1, &pRTV, m_pDepthBuffer->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL), RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+        m_pImmediateCtx->ExecuteSecondaryCommandLists(NumThreads, ppCmdLists.data());
+        m_pImmediateCtx->Flush();
+        ExecutionTime = ExecutionTimer.GetElapsedTime();
+
+        CmdLists.clear();
+        for (Uint32 t = 0; t < NumThreads; ++t)
+            m_DeferredCtxs[t]->FinishFrame();
+        m_pImmediateCtx->FinishFrame();
+
+        return RecordingTime;
+    }
+
+    void WaitForIdle()
+    {
+        m_pImmediateCtx->WaitForIdle();
+    }
+
+private:
+    void RecordDraws(IDeviceContextVk* pCtx, Uint32 FirstDraw, Uint32 EndDraw, Uint32 TotalDraws, ICommandList** ppCmdList)
+    {
+        ITextureView* pRTV = m_pRenderTarget->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        pCtx->BeginSecondaryCommandList(1, &pRTV, m_pDepthBuffer->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL));
+        pCtx->SetPipelineState(m_pPSO);
+
+        // Draw small triangles in a grid, each with its own push constants
+        const Uint32 GridSize = static_cast<Uint32>(std::ceil(std::sqrt(static_cast<float>(TotalDraws))));
+        const float  CellSize = 2.f / static_cast<float>(GridSize);
+        for (Uint32 i = FirstDraw; i < EndDraw; ++i)
+        {
+            DrawConstants Constants;
+            Constants.OffsetScale[0] = -1.f + (static_cast<float>(i % GridSize) + 0.5f) * CellSize;
+            Constants.OffsetScale[1] = -1.f + (static_cast<float>(i / GridSize) + 0.5f) * CellSize;
+            Constants.OffsetScale[2] = CellSize * 0.5f;
+            Constants.OffsetScale[3] = CellSize * 0.5f;
+            Constants.Color[0]       = static_cast<float>(i % 7) / 6.f;
+            Constants.Color[1]       = static_cast<float>(i % 11) / 10.f;
+            Constants.Color[2]       = static_cast<float>(i % 13) / 12.f;
+            Constants.Color[3]       = 1.f;
+            pCtx->SetPushConstants(&Constants, 0, sizeof(Constants));
+            pCtx->Draw(DrawAttribs{3, DRAW_FLAG_NONE});
+        }
+        pCtx->FinishCommandList(ppCmdList);
+    }
+
+    RefCntAutoPtr<IRenderDevice>                  m_pDevice;
+    RefCntAutoPtr<IDeviceContextVk>               m_pImmediateCtx;
+    std::vector<RefCntAutoPtr<IDeviceContextVk>>  m_DeferredCtxs;
+    RefCntAutoPtr<ITexture>                       m_pRenderTarget;
+    RefCntAutoPtr<ITexture>                       m_pDepthBuffer;
+    RefCntAutoPtr<IPipelineState>                 m_pPSO;
+};
+
+void PrintUsage()
+{
+    printf("Usage: SecondaryCmdListBenchmark [-j <MaxThreads>] [-d <DrawsPerFrame>] [-f <NumFrames>]\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Uint32 MaxThreads    = std::max(std::thread::hardware_concurrency(), 1u);
+    Uint32 DrawsPerFrame = 10000;
+    Uint32 NumFrames     = 50;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-j") == 0)
+            MaxThreads = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-d") == 0)
+            DrawsPerFrame = static_cast<Uint32>(atoi(argv[++i]));
+        else if (i + 1 < argc && strcmp(argv[i], "-f") == 0)
+            NumFrames = static_cast<Uint32>(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (MaxThreads == 0 || DrawsPerFrame == 0 || NumFrames == 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    Benchmark Bench;
+    if (!Bench.Initialize(MaxThreads))
+    {
+        printf("Failed to initialize the benchmark\n");
+        return -1;
+    }
+
+    // 1, 2, 4, ... threads and MaxThreads
+    std::vector<Uint32> ThreadCounts;
+    for (Uint32 NumThreads = 1; NumThreads < MaxThreads; NumThreads *= 2)
+        ThreadCounts.push_back(NumThreads);
+    ThreadCounts.push_back(MaxThreads);
+
+    printf("Draws per frame: %u, frames: %u\n", DrawsPerFrame, NumFrames);
+    printf("Threads   Recording (ms/frame)   Draws/ms   Speedup   Execution (ms/frame)\n");
+    double SingleThreadTime = 0;
+    for (auto NumThreads : ThreadCounts)
+    {
+        double ExecutionTime = 0;
+        // Warm up command pools and dynamic heaps
+        Bench.RenderFrame(NumThreads, DrawsPerFrame, ExecutionTime);
+        Bench.WaitForIdle();
+
+        double TotalRecordingTime = 0;
+        double TotalExecutionTime = 0;
+        for (Uint32 f = 0; f < NumFrames; ++f)
+        {
+            TotalRecordingTime += Bench.RenderFrame(NumThreads, DrawsPerFrame, ExecutionTime);
+            TotalExecutionTime += ExecutionTime;
+        }
+        Bench.WaitForIdle();
+
+        const auto RecordingTime = TotalRecordingTime / NumFrames;
+        if (NumThreads == 1)
+            SingleThreadTime = RecordingTime;
+        printf("%7u %22.3f %10.1f %8.2fx %22.3f\n", NumThreads, RecordingTime * 1000.0,
+               static_cast<double>(DrawsPerFrame) / (RecordingTime * 1000.0),
+               SingleThreadTime / RecordingTime, TotalExecutionTime / NumFrames * 1000.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,541 @@
+/*     Copyright 2019 Diligent Graphics LLC
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+// ShaderBundleCompiler compiles all permutations of the shaders listed in the manifest
+// and writes them to a single shader bundle that is loaded with Diligent::ShaderBundle.
+//
+// Manifest format:
+//
+//   # Comment
+//   shader <Name> <vs|ps|gs|hs|ds|cs> <hlsl|glsl> <FilePath> [entry=<EntryPoint>] [sampler_suffix=<Suffix>] [separate_samplers]
+//   permutation [<Macro>=<Definition> ...]
+//   permutation [<Macro>=<Definition> ...]
+//
+// Every permutation line adds a permutation to the preceding shader. A shader
+// without permutations is compiled once without macros.
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <thread>
+
+#include "FileSystem.h"
+#include "FileWrapper.h"
+#include "DataBlobImpl.h"
+#include "RefCntAutoPtr.h"
+#include "JobSystem.h"
+#include "DefaultRawMemoryAllocator.h"
+#include "DefaultShaderSourceStreamFactory.h"
+#include "GLSLSourceBuilder.h"
+#include "SPIRVUtils.h"
+#include "SPIRVShaderResources.h"
+#include "HLSL2GLSLConverterImpl.h"
+#include "ShaderBundle.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct CompilerOptions
+{
+    std::string              ManifestPath;
+    std::string              OutputPath;
+    std::string              SearchDirectories;
+    SPIRV_OPTIMIZATION_LEVEL Optimization     = SPIRV_OPTIMIZATION_LEVEL_NONE;
+    // spirv-opt flags used by SPIRV_OPTIMIZATION_LEVEL_CUSTOM
+    std::string              OptimizationPasses;
+    Uint32                   NumThreads       = 0;
+    bool                     CompileSPIRV     = true;
+    bool                     ConvertToGLSL    = true;
+    // Separate shader objects allow in/out location qualifiers in GLSL
+    bool                     InOutLocations   = true;
+};
+
+struct ShaderPermutation
+{
+    std::vector<std::pair<std::string, std::string>> Macros;
+
+    std::vector<uint32_t> SPIRV;
+    std::vector<Uint8>    SerializedResources;
+    bool                  Succeeded = false;
+
+    std::vector<ShaderMacro> GetMacros()const
+    {
+        std::vector<ShaderMacro> ShaderMacros;
+        for (const auto& Macro : Macros)
+            ShaderMacros.emplace_back(Macro.first.c_str(), Macro.second.c_str());
+        ShaderMacros.emplace_back(nullptr, nullptr);
+        return ShaderMacros;
+    }
+};
+
+struct ShaderSource
+{
+    std::string            Name;
+    SHADER_TYPE            ShaderType           = SHADER_TYPE_UNKNOWN;
+    SHADER_SOURCE_LANGUAGE SourceLanguage       = SHADER_SOURCE_LANGUAGE_DEFAULT;
+    std::string            FilePath;
+    std::string            EntryPoint           = "main";
+    std::string            SamplerSuffix        = "_sampler";
+    bool                   UseCombinedSamplers  = true;
+
+    std::vector<ShaderPermutation> Permutations;
+
+    // GLSL does not depend on the macros and is shared by all permutations
+    std::string GLSL;
+    bool        GLSLSucceeded = false;
+
+    ShaderCreateInfo GetCreateInfo(IShaderSourceInputStreamFactory* pFactory, const ShaderMacro* Macros)const
+    {
+        ShaderCreateInfo ShaderCI;
+        ShaderCI.FilePath                   = FilePath.c_str();
+        ShaderCI.pShaderSourceStreamFactory = pFactory;
+        ShaderCI.EntryPoint                 = EntryPoint.c_str();
+        ShaderCI.Macros                     = Macros;
+        ShaderCI.UseCombinedTextureSamplers = UseCombinedSamplers;
+        ShaderCI.CombinedSamplerSuffix      = SamplerSuffix.c_str();
+        ShaderCI.Desc.Name                  = Name.c_str();
+        ShaderCI.Desc.ShaderType            = ShaderType;
+        ShaderCI.SourceLanguage             = SourceLanguage;
+        return ShaderCI;
+    }
+};
+
+SHADER_TYPE ParseShaderType(const std::string& Type)
+{
+    if (Type == "vs") return SHADER_TYPE_VERTEX;
+    if (Type == "ps") return SHADER_TYPE_PIXEL;
+    if (Type == "gs") return SHADER_TYPE_GEOMETRY;
+    if (Type == "hs") return SHADER_TYPE_HULL;
+    if (Type == "ds") return SHADER_TYPE_DOMAIN;
+    if (Type == "cs") return SHADER_TYPE_COMPUTE;
+    return SHADER_TYPE_UNKNOWN;
+}
+
+bool ParseManifest(const std::string& Path, std::vector<ShaderSource>& Shaders)
+{
+    std::ifstream Manifest(Path);
+    if (!Manifest)
+    {
+        printf("Failed to open manifest %s\n", Path.c_str());
+        return false;
+    }
+
+    std::string Line;
+    int LineNum = 0;
+    while (std::getline(Manifest, Line))
+    {
+        ++LineNum;
+        auto CommentPos = Line.find('#');
+        if (CommentPos != std::string::npos)
+            Line.erase(CommentPos);
+
+        std::istringstream LineStream(Line);
+        std::string Keyword;
+        if (!(LineStream >> Keyword))
+            continue;
+
+        if (Keyword == "shader")
+        {
+            ShaderSource Shader;
+            std::string Type, Language;
+            if (!(LineStream >> Shader.Name >> Type >> Language >> Shader.FilePath))
+            {
+                printf("%s(%d): expected shader name, type, language and file path\n", Path.c_str(), LineNum);
+                return false;
+            }
+
+            Shader.ShaderType = ParseShaderType(Type);
+            if (Shader.ShaderType == SHADER_TYPE_UNKNOWN)
+            {
+                printf("%s(%d): unknown shader type '%s'\n", Path.c_str(), LineNum, Type.c_str());
+                return false;
+            }
+
+            if (Language == "hlsl")
+                Shader.SourceLanguage = SHADER_SOURCE_LANGUAGE_HLSL;
+            else if (Language == "glsl")
+                Shader.SourceLanguage = SHADER_SOURCE_LANGUAGE_GLSL;
+            else
+            {
+                printf("%s(%d): unknown source language '%s'\n", Path.c_str(), LineNum, Language.c_str());
+                return false;
+            }
+
+            std::string Option;
+            while (LineStream >> Option)
+            {
+                if (Option.compare(0, 6, "entry=") == 0)
+                    Shader.EntryPoint = Option.substr(6);
+                else if (Option.compare(0, 15, "sampler_suffix=") == 0)
+                    Shader.SamplerSuffix = Option.substr(15);
+                else if (Option == "separate_samplers")
+                    Shader.UseCombinedSamplers = false;
+                else
+                {
+                    printf("%s(%d): unknown shader option '%s'\n", Path.c_str(), LineNum, Option.c_str());
+                    return false;
+                }
+            }
+            Shaders.emplace_back(std::move(Shader));
+        }
+        else if (Keyword == "permutation")
+        {
+            if (Shaders.empty())
+            {
+                printf("%s(%d): permutation must follow shader declaration\n", Path.c_str(), LineNum);
+                return false;
+            }
+
+            ShaderPermutation Permutation;
+            std::string Macro;
+            while (LineStream >> Macro)
+            {
+                auto EqPos = Macro.find('=');
+                if (EqPos == std::string::npos || EqPos == 0)
+                {
+                    printf("%s(%d): macro '%s' must have <Name>=<Definition> format\n", Path.c_str(), LineNum, Macro.c_str());
+                    return false;
+                }
+                Permutation.Macros.emplace_back(Macro.substr(0, EqPos), Macro.substr(EqPos + 1));
+            }
+            Shaders.back().Permutations.emplace_back(std::move(Permutation));
+        }
+        else
+        {
+            printf("%s(%d): unexpected keyword '%s'\n", Path.c_str(), LineNum, Keyword.c_str());
+            return false;
+        }
+    }
+
+    for (auto& Shader : Shaders)
+    {
+        if (Shader.Permutations.empty())
+            Shader.Permutations.emplace_back();
+    }
+    return true;
+}
+
+void CompileSPIRV(const CompilerOptions& Options, IShaderSourceInputStreamFactory* pFactory, const ShaderSource& Shader, ShaderPermutation& Permutation)
+{
+    const auto Macros   = Permutation.GetMacros();
+    const auto ShaderCI = Shader.GetCreateInfo(pFactory, Macros.data());
+
+    std::vector<uint32_t> SPIRV;
+    if (Shader.SourceLanguage == SHADER_SOURCE_LANGUAGE_HLSL)
+    {
+        SPIRV = HLSLtoSPIRV(ShaderCI, nullptr);
+    }
+    else
+    {
+        DeviceCaps VulkanCaps;
+        VulkanCaps.DevType = DeviceType::Vulkan;
+        auto GLSLSource = BuildGLSLSourceString(ShaderCI, VulkanCaps, TargetGLSLCompiler::glslang, "#define TARGET_API_VULKAN 1\n");
+        SPIRV = GLSLtoSPIRV(Shader.ShaderType, GLSLSource.c_str(), static_cast<int>(GLSLSource.length()), nullptr);
+    }
+    if (SPIRV.empty())
+        return;
+
+    if (Options.Optimization != SPIRV_OPTIMIZATION_LEVEL_NONE)
+    {
+        auto OptimizedSPIRV = OptimizeSPIRV(SPIRV, Options.Optimization, Options.OptimizationPasses.c_str());
+        if (!OptimizedSPIRV.empty())
+            SPIRV.swap(OptimizedSPIRV);
+        else
+            LOG_WARNING_MESSAGE("Failed to optimize SPIRV of shader '", Shader.Name, "'. Unoptimized byte code will be used.");
+    }
+
+    // Stage inputs are only loaded for HLSL vertex shaders, see ShaderVkImpl
+    bool        IsHLSLVertexShader = Shader.SourceLanguage == SHADER_SOURCE_LANGUAGE_HLSL && Shader.ShaderType == SHADER_TYPE_VERTEX;
+    std::string EntryPoint;
+    SPIRVShaderResources Resources(DefaultRawMemoryAllocator::GetAllocator(), nullptr, SPIRV, ShaderCI.Desc,
+                                   Shader.UseCombinedSamplers ? Shader.SamplerSuffix.c_str() : nullptr,
+                                   IsHLSLVertexShader, EntryPoint);
+    Resources.Serialize(EntryPoint, SPIRV.size(), Permutation.SerializedResources);
+
+    Permutation.SPIRV.swap(SPIRV);
+    Permutation.Succeeded = true;
+}
+
+void ConvertToGLSL(const CompilerOptions& Options, IShaderSourceInputStreamFactory* pFactory, ShaderSource& Shader)
+{
+    if (Shader.SourceLanguage == SHADER_SOURCE_LANGUAGE_HLSL)
+    {
+        if (!Shader.UseCombinedSamplers)
+        {
+            LOG_WARNING_MESSAGE("Shader '", Shader.Name, "' does not use combined texture samplers and can't be converted to GLSL");
+            return;
+        }
+
+        HLSL2GLSLConverterImpl::ConversionAttribs Attribs;
+        Attribs.pSourceStreamFactory       = pFactory;
+        Attribs.EntryPoint                 = Shader.EntryPoint.c_str();
+        Attribs.ShaderType                 = Shader.ShaderType;
+        Attribs.IncludeDefinitions         = true;
+        Attribs.InputFileName              = Shader.FilePath.c_str();
+        Attribs.SamplerSuffix              = Shader.SamplerSuffix.c_str();
+        Attribs.UseInOutLocationQualifiers = Options.InOutLocations;
+        Shader.GLSL = HLSL2GLSLConverterImpl::GetInstance().Convert(Attribs);
+    }
+    else
+    {
+        RefCntAutoPtr<IFileStream> pSourceStream;
+        pFactory->CreateInputStream(Shader.FilePath.c_str(), &pSourceStream);
+        if (!pSourceStream)
+            LOG_ERROR_AND_THROW("Failed to open shader source file '", Shader.FilePath, "'");
+
+        RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
+        pSourceStream->Read(pFileData);
+        Shader.GLSL.assign(reinterpret_cast<const char*>(pFileData->GetDataPtr()), pFileData->GetSize());
+    }
+    Shader.GLSLSucceeded = true;
+}
+
+void PrintUsage()
+{
+    printf("Usage: ShaderBundleCompiler -m <manifest> -o <bundle> [options]\n"
+           "Options:\n"
+           "  -I <dirs>          Semicolon-separated list of shader search directories\n"
+           "  -O0                Do not optimize SPIRV (default)\n"
+           "  -O                 Optimize SPIRV for performance\n"
+           "  -Os                Optimize SPIRV for size\n"
+           "  --spirv-passes <flags> Optimize SPIRV with the given space-separated spirv-opt flags\n"
+           "  -j <N>             Number of compiler threads (default: number of CPU cores)\n"
+           "  --no-spirv         Do not compile SPIRV for Vulkan backend\n"
+           "  --no-glsl          Do not generate GLSL for OpenGL backend\n"
+           "  --no-inout-locations Do not use in/out location qualifiers in GLSL converted from HLSL\n");
+}
+
+bool ParseCommandLine(int argc, char* argv[], CompilerOptions& Options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* Arg = argv[i];
+        auto HasValue = [&]()
+        {
+            if (i + 1 < argc)
+                return true;
+            printf("Missing value of %s argument\n", Arg);
+            return false;
+        };
+
+        if (strcmp(Arg, "-m") == 0)
+        {
+            if (!HasValue()) return false;
+            Options.ManifestPath = argv[++i];
+        }
+        else if (strcmp(Arg, "-o") == 0)
+        {
+            if (!HasValue()) return false;
+            Options.OutputPath = argv[++i];
+        }
+        else if (strcmp(Arg, "-I") == 0)
+        {
+            if (!HasValue()) return false;
+            if (!Options.SearchDirectories.empty())
+                Options.SearchDirectories += ';';
+            Options.SearchDirectories += argv[++i];
+        }
+        else if (strcmp(Arg, "-j") == 0)
+        {
+            if (!HasValue()) return false;
+            Options.NumThreads = static_cast<Uint32>(atoi(argv[++i]));
+        }
+        else if (strcmp(Arg, "-O0") == 0)
+            Options.Optimization = SPIRV_OPTIMIZATION_LEVEL_NONE;
+        else if (strcmp(Arg, "-O") == 0)
+            Options.Optimization = SPIRV_OPTIMIZATION_LEVEL_PERFORMANCE;
+        else if (strcmp(Arg, "-Os") == 0)
+            Options.Optimization = SPIRV_OPTIMIZATION_LEVEL_SIZE;
+        else if (strcmp(Arg, "--spirv-passes") == 0)
+        {
+            if (!HasValue()) return false;
+            Options.Optimization       = SPIRV_OPTIMIZATION_LEVEL_CUSTOM;
+            Options.OptimizationPasses = argv[++i];
+        }
+        else if (strcmp(Arg, "--no-spirv") == 0)
+            Options.CompileSPIRV = false;
+        else if (strcmp(Arg, "--no-glsl") == 0)
+            Options.ConvertToGLSL = false;
+        else if (strcmp(Arg, "--no-inout-locations") == 0)
+            Options.InOutLocations = false;
+        else
+        {
+            printf("Unknown argument %s\n", Arg);
+            return false;
+        }
+    }
+
+    if (Options.ManifestPath.empty() || Options.OutputPath.empty())
+        return false;
+    if (!Options.CompileSPIRV && !Options.ConvertToGLSL)
+    {
+        printf("--no-spirv and --no-glsl options can't be used together\n");
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    CompilerOptions Options;
+    if (!ParseCommandLine(argc, argv, Options))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    std::vector<ShaderSource> Shaders;
+    if (!ParseManifest(Options.ManifestPath, Shaders))
+        return -1;
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pFactory;
+    CreateDefaultShaderSourceStreamFactory(Options.SearchDirectories.c_str(), &pFactory);
+
+    // Every job compiles one permutation to SPIRV or converts one shader to GLSL
+    struct Job
+    {
+        ShaderSource*      pShader;
+        ShaderPermutation* pPermutation;
+    };
+    std::vector<Job> Jobs;
+    for (auto& Shader : Shaders)
+    {
+        if (Options.ConvertToGLSL)
+            Jobs.push_back(Job{&Shader, nullptr});
+        if (Options.CompileSPIRV)
+        {
+            for (auto& Permutation : Shader.Permutations)
+                Jobs.push_back(Job{&Shader, &Permutation});
+        }
+    }
+
+    if (Options.CompileSPIRV)
+        InitializeGlslang();
+
+    {
+        auto NumThreads = Options.NumThreads != 0 ? Options.NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+        // The calling thread also executes the jobs while it waits for ParallelFor to complete
+        JobSystem Scheduler(NumThreads - 1);
+        Scheduler.ParallelFor(0, static_cast<Uint32>(Jobs.size()), 1,
+            [&](Uint32 Begin, Uint32 End)
+            {
+                for (auto j = Begin; j < End; ++j)
+                {
+                    auto& CurrJob = Jobs[j];
+                    try
+                    {
+                        if (CurrJob.pPermutation != nullptr)
+                            CompileSPIRV(Options, pFactory, *CurrJob.pShader, *CurrJob.pPermutation);
+                        else
+                            ConvertToGLSL(Options, pFactory, *CurrJob.pShader);
+                    }
+                    catch (const std::exception&)
+                    {
+                        // The error has already been logged
+                    }
+                }
+            });
+    }
+
+    if (Options.CompileSPIRV)
+        FinalizeGlslang();
+
+    ShaderBundleWriter Writer;
+    Uint32 NumFailed = 0;
+    Uint32 NumEntries = 0;
+    for (const auto& Shader : Shaders)
+    {
+        if (Options.ConvertToGLSL && !Shader.GLSLSucceeded)
+        {
+            printf("Failed to generate GLSL for shader %s\n", Shader.Name.c_str());
+            ++NumFailed;
+        }
+
+        for (const auto& Permutation : Shader.Permutations)
+        {
+            if (Options.CompileSPIRV && !Permutation.Succeeded)
+            {
+                printf("Failed to compile permutation %u of shader %s\n", static_cast<Uint32>(&Permutation - Shader.Permutations.data()), Shader.Name.c_str());
+                ++NumFailed;
+                continue;
+            }
+
+            const auto Macros = Permutation.GetMacros();
+
+            ShaderBundleWriter::EntryData Entry;
+            Entry.Name                  = Shader.Name.c_str();
+            Entry.Macros                = Macros.data();
+            Entry.ShaderType            = Shader.ShaderType;
+            Entry.SourceLanguage        = Shader.SourceLanguage;
+            Entry.EntryPoint            = Shader.EntryPoint.c_str();
+            Entry.CombinedSamplerSuffix = Shader.UseCombinedSamplers ? Shader.SamplerSuffix.c_str() : nullptr;
+            if (Options.CompileSPIRV)
+            {
+                Entry.SPIRV                   = Permutation.SPIRV.data();
+                Entry.SPIRVSize               = Permutation.SPIRV.size() * sizeof(uint32_t);
+                Entry.SerializedResources     = Permutation.SerializedResources.data();
+                Entry.SerializedResourcesSize = Permutation.SerializedResources.size();
+            }
+            if (Shader.GLSLSucceeded)
+            {
+                Entry.GLSLSource       = Shader.GLSL.c_str();
+                Entry.GLSLSourceLength = Shader.GLSL.length();
+            }
+
+            if (Writer.AddEntry(Entry))
+                ++NumEntries;
+            else
+                printf("Shader %s has duplicate permutation %u, which is ignored\n", Shader.Name.c_str(), static_cast<Uint32>(&Permutation - Shader.Permutations.data()));
+        }
+    }
+
+    if (NumFailed != 0)
+    {
+        printf("ShaderBundleCompiler: %u shaders or permutations failed to compile\n", NumFailed);
+        return -1;
+    }
+
+    std::vector<Uint8> BundleData;
+    Writer.Write(BundleData);
+
+    FileWrapper OutputFile(Options.OutputPath.c_str(), EFileAccessMode::Overwrite);
+    if (!OutputFile || !OutputFile->Write(BundleData.data(), BundleData.size()))
+    {
+        printf("Failed to write shader bundle %s\n", Options.OutputPath.c_str());
+        return -1;
+    }
+
+    printf("ShaderBundleCompiler: successfully compiled %u shader permutations to %s (%u bytes)\n", NumEntries, Options.OutputPath.c_str(), static_cast<Uint32>(BundleData.size()));
+    return 0;
+}